@@ -117,6 +117,147 @@ processDelayed(UA_EventLoopPOSIX *el) {
     }
 }
 
+/************/
+/* Reactors */
+/************/
+
+#if defined(UA_HAVE_REACTORS)
+
+/* The reactor EventLoop is only ever run and stopped from its own thread. So
+ * its poll set is never torn down while the thread waits for events. */
+static void *
+reactorThread(void *context) {
+    UA_Reactor *r = (UA_Reactor*)context;
+    UA_EventLoop *rel = r->el;
+    while(!__atomic_load_n(&r->stopping, __ATOMIC_ACQUIRE))
+        rel->run(rel, 100);
+    rel->stop(rel);
+    while(rel->state != UA_EVENTLOOPSTATE_STOPPED)
+        rel->run(rel, 100);
+    __atomic_store_n(&r->stopped, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/* Create, start and run the reactors. The TCP ConnectionManager of a reactor
+ * gets the parameters of the first TCP ConnectionManager in this EventLoop. */
+static UA_StatusCode
+startReactors(UA_EventLoopPOSIX *el) {
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    const UA_UInt16 *reactors = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(&el->eventLoop.params,
+                                 UA_QUALIFIEDNAME(0, "reactors"),
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    if(!reactors || *reactors == 0)
+        return UA_STATUSCODE_GOOD;
+
+    el->reactors = (UA_Reactor*)UA_calloc(*reactors, sizeof(UA_Reactor));
+    if(!el->reactors)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    const UA_String tcpString = UA_STRING("tcp");
+    UA_ConnectionManager *tcp = NULL;
+    for(UA_EventSource *es = el->eventLoop.eventSources; es; es = es->next) {
+        if(es->eventSourceType != UA_EVENTSOURCETYPE_CONNECTIONMANAGER)
+            continue;
+        if(UA_String_equal(&((UA_ConnectionManager*)es)->protocol, &tcpString)) {
+            tcp = (UA_ConnectionManager*)es;
+            break;
+        }
+    }
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(UA_UInt16 i = 0; i < *reactors; i++) {
+        UA_Reactor *r = &el->reactors[i];
+        r->el = UA_EventLoop_new_POSIX(el->eventLoop.logger);
+        if(!r->el) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        el->reactorsSize++;
+
+        /* Same clock sources, but no nested reactors */
+        res = UA_KeyValueMap_copy(&el->eventLoop.params, &r->el->params);
+        UA_KeyValueMap_remove(&r->el->params, UA_QUALIFIEDNAME(0, "reactors"));
+
+        r->tcp = UA_ConnectionManager_new_POSIX_TCP(tcpString);
+        if(!r->tcp) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        if(tcp)
+            res |= UA_KeyValueMap_copy(&tcp->eventSource.params,
+                                       &r->tcp->eventSource.params);
+        if(res == UA_STATUSCODE_GOOD)
+            res = r->el->registerEventSource(r->el, &r->tcp->eventSource);
+        if(res != UA_STATUSCODE_GOOD) {
+            r->tcp->eventSource.free(&r->tcp->eventSource);
+            r->tcp = NULL;
+            break;
+        }
+
+        res = r->el->start(r->el);
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+
+        if(pthread_create(&r->thread, NULL, reactorThread, r) != 0) {
+            res = UA_STATUSCODE_BADINTERNALERROR;
+            break;
+        }
+        r->running = true;
+    }
+
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                     "Could not start the reactors");
+        return res;
+    }
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                "Started %u reactor threads", (unsigned)el->reactorsSize);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+stopReactors(UA_EventLoopPOSIX *el) {
+    for(size_t i = 0; i < el->reactorsSize; i++)
+        __atomic_store_n(&el->reactors[i].stopping, true, __ATOMIC_RELEASE);
+}
+
+static UA_Boolean
+reactorsStopped(UA_EventLoopPOSIX *el) {
+    for(size_t i = 0; i < el->reactorsSize; i++) {
+        if(el->reactors[i].running &&
+           !__atomic_load_n(&el->reactors[i].stopped, __ATOMIC_ACQUIRE))
+            return false;
+    }
+    return true;
+}
+
+/* Join the threads and free the reactors. Reactors without a running thread
+ * are stopped in the current thread. */
+static void
+clearReactors(UA_EventLoopPOSIX *el) {
+    for(size_t i = 0; i < el->reactorsSize; i++) {
+        UA_Reactor *r = &el->reactors[i];
+        if(r->running) {
+            pthread_join(r->thread, NULL);
+        } else {
+            if(r->el->state == UA_EVENTLOOPSTATE_STARTED)
+                r->el->stop(r->el);
+            while(r->el->state != UA_EVENTLOOPSTATE_STOPPED &&
+                  r->el->state != UA_EVENTLOOPSTATE_FRESH)
+                r->el->run(r->el, 100);
+        }
+        r->el->free(r->el); /* Also frees the TCP ConnectionManager */
+    }
+    UA_free(el->reactors);
+    el->reactors = NULL;
+    el->reactorsSize = 0;
+}
+
+#endif /* UA_HAVE_REACTORS */
+
 /***********************/
 /* EventLoop Lifecycle */
 /***********************/
@@ -162,7 +303,12 @@ UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
     }
 #endif
 
-#ifdef UA_HAVE_EPOLL
+#if defined(UA_HAVE_IO_URING)
+    if(UA_EventLoopPOSIX_initIoUring(el) != UA_STATUSCODE_GOOD) {
+        UA_UNLOCK(&el->elMutex);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+#elif defined(UA_HAVE_EPOLL)
     el->epollfd = epoll_create1(0);
     if(el->epollfd == -1) {
         UA_LOG_SOCKET_ERRNO_WRAP(
@@ -174,6 +320,15 @@ UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
     }
 #endif
 
+#if defined(UA_HAVE_REACTORS)
+    if(startReactors(el) != UA_STATUSCODE_GOOD) {
+        stopReactors(el);
+        clearReactors(el);
+        UA_UNLOCK(&el->elMutex);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+#endif
+
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_EventSource *es = el->eventLoop.eventSources;
     while(es) {
@@ -206,12 +361,22 @@ checkClosed(UA_EventLoopPOSIX *el) {
     if(el->delayedCallbacks != NULL)
         return;
 
+#if defined(UA_HAVE_REACTORS)
+    /* Wait for the reactors to stop. Then join the threads. */
+    if(!reactorsStopped(el))
+        return;
+    clearReactors(el);
+#endif
+
     /* Dirty-write the state that is const "from the outside" */
     *(UA_EventLoopState*)(uintptr_t)&el->eventLoop.state =
         UA_EVENTLOOPSTATE_STOPPED;
 
-    /* Close the epoll/IOCP socket once all EventSources have shut down */
-#ifdef UA_HAVE_EPOLL
+    /* Close the io_uring/epoll/IOCP socket once all EventSources have shut
+     * down */
+#if defined(UA_HAVE_IO_URING)
+    UA_EventLoopPOSIX_clearIoUring(el);
+#elif defined(UA_HAVE_EPOLL)
     close(el->epollfd);
 #endif
 
@@ -248,6 +413,10 @@ UA_EventLoopPOSIX_stop(UA_EventLoopPOSIX *el) {
         }
     }
 
+#if defined(UA_HAVE_REACTORS)
+    stopReactors(el);
+#endif
+
     /* Set to STOPPED if all EventSources are STOPPED */
     checkClosed(el);
 
@@ -469,6 +638,11 @@ UA_EventLoopPOSIX_free(UA_EventLoopPOSIX *el) {
 
     UA_KeyValueMap_clear(&el->eventLoop.params);
 
+#if defined(UA_HAVE_IO_URING)
+    /* The send buffers outlive the ring */
+    UA_free(el->sendBufs.data);
+#endif
+
     /* Clean up */
     UA_UNLOCK(&el->elMutex);
     UA_LOCK_DESTROY(&el->elMutex);
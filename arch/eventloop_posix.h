@@ -25,12 +25,27 @@
 #include "../deps/mp_printf.h"
 #include "../deps/open62541_queue.h"
 
-/* epoll_pwait returns bogus data with the tc compiler */
-#if defined(__linux__) && !defined(__TINYC__)
+/* io_uring is opt-in. Otherwise epoll is used on Linux. epoll_pwait returns
+ * bogus data with the tc compiler. */
+#if defined(__linux__) && defined(UA_ENABLE_IO_URING)
+# define UA_HAVE_IO_URING
+# include <linux/io_uring.h>
+# include <time.h>
+#elif defined(__linux__) && !defined(__TINYC__)
 # define UA_HAVE_EPOLL
 # include <sys/epoll.h>
 #endif
 
+/* The InterruptManager uses signalfd with the Linux backends */
+#if defined(UA_HAVE_IO_URING) || defined(UA_HAVE_EPOLL)
+# define UA_HAVE_SIGNALFD
+#endif
+
+/* Reactor threads need the pthread-based locking */
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+# define UA_HAVE_REACTORS
+#endif
+
 #define UA_MAXBACKLOG 100
 #define UA_MAXHOSTNAME_LENGTH 256
 #define UA_MAXPORTSTR_LENGTH 6
@@ -64,6 +79,13 @@ typedef struct UA_RegisteredFD UA_RegisteredFD;
 
 typedef void (*UA_FDCallback)(UA_EventSource *es, UA_RegisteredFD *rfd, short event);
 
+#if defined(UA_HAVE_IO_URING)
+/* Called with the data that was received into a buffer of the EventLoop. The
+ * buffer is reused after the callback returns. */
+typedef void (*UA_FDRecvCallback)(UA_EventSource *es, UA_RegisteredFD *rfd,
+                                  UA_ByteString msg);
+#endif
+
 struct UA_RegisteredFD {
     UA_DelayedCallback dc; /* Used for async closing. Must be the first member
                             * because the rfd is freed by the delayed callback
@@ -75,6 +97,13 @@ struct UA_RegisteredFD {
 
     UA_EventSource *es; /* Backpointer to the EventSource */
     UA_FDCallback eventSourceCB;
+
+#if defined(UA_HAVE_IO_URING)
+    /* Optional. If set, io_uring receives the data when the fd listens for
+     * UA_FDEVENT_IN only. Instead of signaling the readiness. A closed
+     * connection or an error is still signaled with UA_FDEVENT_ERR. */
+    UA_FDRecvCallback recvCB;
+#endif
 };
 
 enum ZIP_CMP cmpFD(const UA_FD *a, const UA_FD *b);
@@ -96,6 +125,123 @@ typedef struct {
     UA_FDTree fds;
 } UA_POSIXConnectionManager;
 
+#if defined(UA_HAVE_IO_URING)
+/* A send that is queued in io_uring. The sends of an fd are processed one
+ * after the other to keep their order. The request owns the buffer until its
+ * completion. */
+typedef struct UA_IoUringSend {
+    LIST_ENTRY(UA_IoUringSend) pointers; /* All requests of the ring */
+    TAILQ_ENTRY(UA_IoUringSend) inflightPointers; /* Ordered by deadline */
+    struct UA_IoUringSend *next; /* Next send of the same fd */
+    UA_FD fd;
+    UA_Boolean orphaned; /* The fd was deregistered with the send pending.
+                          * Then the fd is a duplicate owned by the sends. */
+    UA_Boolean completed; /* Completion seen in the queue but not processed */
+    UA_Boolean inflight; /* Submitted, the result is pending */
+    UA_Boolean retired; /* Done, but the kernel still reads from the buffer */
+    UA_Boolean zeroCopy; /* Submitted as a zero-copy send */
+    size_t notifs; /* Pending notifications of zero-copy sends. Until then
+                    * the kernel can still read from the buffer. */
+    UA_ByteString buf;
+    size_t written;
+    UA_DateTime deadline; /* Monotonic time when the send is canceled */
+} UA_IoUringSend;
+
+/* The registered fds are looked up by the fd number. The generation is
+ * increased for every (re-)registration. Completions of requests from an
+ * earlier generation are ignored. So the completion of a request for a closed
+ * (and possibly reused) fd never touches a freed UA_RegisteredFD. */
+typedef struct {
+    UA_RegisteredFD *rfd;
+    UA_UInt32 generation;
+    UA_UInt64 armed; /* user_data of the pending poll or recv request */
+    UA_IoUringSend *sendFirst; /* In flight */
+    UA_IoUringSend *sendLast;
+} UA_IoUringFD;
+
+/* The send buffers are taken from a pool. They are handed out to the
+ * EventSources and passed to the ring without a copy. The pool memory is
+ * registered with the ring (fixed buffers) for zero-copy sends. The pool is
+ * kept until the EventLoop is deleted, as the application can still hold
+ * buffers when the EventLoop restarts. */
+#define UA_IO_URING_SENDBUFFERS 64
+#define UA_IO_URING_SENDBUFSIZE 65536
+
+typedef struct {
+    UA_Byte *data; /* NULL until the EventLoop is started the first time */
+    unsigned short freeList[UA_IO_URING_SENDBUFFERS];
+    size_t freeSize;
+} UA_IoUringSendBuffers;
+
+typedef struct {
+    UA_FD ringfd;
+
+    /* Submission queue. Requests are queued and submitted in a batch together
+     * with waiting for completions. */
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned sqTailLocal; /* Not yet visible to the kernel */
+    unsigned sqMask;
+    unsigned sqEntries;
+    struct io_uring_sqe *sqes;
+
+    /* Completion queue */
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe *cqes;
+
+    /* Mapped memory */
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing; /* Can be the same as sqRing */
+    size_t cqRingSize;
+    size_t sqesSize;
+
+    /* Receive buffers that are registered with the kernel. The kernel picks a
+     * free buffer when data arrives. NULL if the kernel does not support
+     * buffer rings (before Linux 5.19). Then the readiness is polled. */
+    struct io_uring_buf_ring *bufRing;
+    size_t bufRingSize;
+    UA_Byte *bufs;
+    unsigned short bufTail;
+    UA_Boolean noMultishot; /* Multishot recv requires Linux 6.0 */
+
+    /* The send buffers are registered with the ring. Zero-copy sends require
+     * Linux 6.0 and a socket type that supports them. */
+    UA_Boolean sendBufsRegistered;
+    UA_Boolean noZeroCopy;
+
+    UA_IoUringFD *fds;
+    size_t fdsSize;
+
+    /* All queued sends. The submitted sends are also in the inflight queue.
+     * They have the same timeout. So the queue is ordered by the deadline. */
+    LIST_HEAD(, UA_IoUringSend) sends;
+    TAILQ_HEAD(, UA_IoUringSend) inflight;
+
+    /* Requests from within the event dispatch are submitted in a batch with
+     * the next wait. Otherwise they are submitted right away. */
+    UA_Boolean dispatching;
+    UA_Boolean sendQueued; /* Sends were queued during the dispatch */
+    UA_Boolean draining; /* Waiting for the remaining completions */
+    size_t requests; /* Queued requests without a completion */
+} UA_IoUring;
+#endif
+
+#if defined(UA_HAVE_REACTORS)
+/* A reactor is an internal EventLoop that is run in its own thread. The listen
+ * sockets of the TCP ConnectionManager are opened in every reactor. */
+typedef struct {
+    UA_EventLoop *el;
+    UA_ConnectionManager *tcp;
+    pthread_t thread;
+    UA_Boolean running;  /* The thread was created */
+    UA_Boolean stopping; /* Atomic. Request the thread to stop the reactor. */
+    UA_Boolean stopped;  /* Atomic. The reactor has stopped in its thread. */
+} UA_Reactor;
+#endif
+
 typedef struct {
     UA_EventLoop eventLoop;
 
@@ -115,22 +261,55 @@ typedef struct {
     UA_Int32 clockSourceMonotonic;
 #endif
 
-#if defined(UA_HAVE_EPOLL)
+#if defined(UA_HAVE_IO_URING)
+    UA_IoUring ring;
+    UA_IoUringSendBuffers sendBufs;
+#elif defined(UA_HAVE_EPOLL)
     UA_FD epollfd;
 #else
     UA_RegisteredFD **fds;
     size_t fdsSize;
 #endif
 
+#if defined(UA_HAVE_REACTORS)
+    UA_Reactor *reactors;
+    size_t reactorsSize;
+#endif
+
 #if UA_MULTITHREADING >= 100
     UA_Lock elMutex;
 #endif
 } UA_EventLoopPOSIX;
 
 /*
- * The following functions differ between epoll and normal select
+ * The following functions differ between io_uring, epoll and normal select
  */
 
+#if defined(UA_HAVE_IO_URING)
+/* Set up and tear down the rings when the EventLoop starts and stops */
+UA_StatusCode
+UA_EventLoopPOSIX_initIoUring(UA_EventLoopPOSIX *el);
+
+void
+UA_EventLoopPOSIX_clearIoUring(UA_EventLoopPOSIX *el);
+
+/* Queue a send in the ring. The buffer is taken over and freed after the
+ * completion. It must come from UA_EventLoopPOSIX_allocSendBuffer. The sends of
+ * an fd are completed in the order they were queued. A send that does not
+ * complete within the timeout closes the connection. */
+UA_StatusCode
+UA_EventLoopPOSIX_sendFD(UA_EventLoopPOSIX *el, UA_FD fd, UA_ByteString *buf);
+
+/* Take a buffer from the pool of send buffers. Falls back to the heap if the
+ * pool is empty or the buffer is too large. Requires the EventLoop lock. */
+UA_StatusCode
+UA_EventLoopPOSIX_allocSendBuffer(UA_EventLoopPOSIX *el, UA_ByteString *buf,
+                                  size_t bufSize);
+
+void
+UA_EventLoopPOSIX_freeSendBuffer(UA_EventLoopPOSIX *el, UA_ByteString *buf);
+#endif
+
 /* Register to start receiving events */
 UA_StatusCode
 UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd);
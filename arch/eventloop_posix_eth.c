@@ -17,6 +17,7 @@
 #include <net/ethernet.h> /* ETH_P_*/
 #include <linux/if_packet.h>
 #include <linux/net_tstamp.h> /* txtime */
+#include <sys/mman.h> /* PACKET_MMAP rings */
 
 /* Configuration parameters */
 
@@ -27,7 +28,7 @@ static UA_KeyValueRestriction ethManagerParams[ETH_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
 };
 
-#define ETH_PARAMETERSSIZE 15
+#define ETH_PARAMETERSSIZE 19
 #define ETH_PARAMINDEX_ADDR 0
 #define ETH_PARAMINDEX_LISTEN 1
 #define ETH_PARAMINDEX_IFACE 2
@@ -43,6 +44,10 @@ static UA_KeyValueRestriction ethManagerParams[ETH_MANAGERPARAMS] = {
 #define ETH_PARAMINDEX_TXTIME_PICO 12
 #define ETH_PARAMINDEX_TXTIME_DROP 13
 #define ETH_PARAMINDEX_VALIDATE 14
+#define ETH_PARAMINDEX_RING 15
+#define ETH_PARAMINDEX_RING_BLOCKSIZE 16
+#define ETH_PARAMINDEX_RING_BLOCKS 17
+#define ETH_PARAMINDEX_RING_TIMEOUT 18
 
 static UA_KeyValueRestriction ethConnectionParams[ETH_PARAMETERSSIZE+1] = {
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], false, true, false},
@@ -60,12 +65,24 @@ static UA_KeyValueRestriction ethConnectionParams[ETH_PARAMETERSSIZE+1] = {
     {{0, UA_STRING_STATIC("txtime-pico")}, &UA_TYPES[UA_TYPES_UINT16], false, true, false},
     {{0, UA_STRING_STATIC("txtime-drop-late")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
     {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("ring")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("ring-blocksize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("ring-blocks")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("ring-timeout")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
     /* Duplicated address parameter with a scalar value required. For the send-socket case. */
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], true, true, false},
 };
 
 #define UA_ETH_MAXHEADERLENGTH (2*ETHER_ADDR_LEN)+4+2+2
 
+/* PACKET_MMAP ring defaults. The frames of the TX ring have a fixed size. The
+ * payload starts after the (aligned) tpacket3_hdr. */
+#define ETH_RING_BLOCKSIZE (1u << 16)
+#define ETH_RING_BLOCKS 8u
+#define ETH_RING_TIMEOUT 1u /* ms */
+#define ETH_RING_FRAMESIZE 2048u
+#define ETH_RING_TXDATAOFFSET TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+
 typedef struct {
     UA_RegisteredFD rfd;
 
@@ -85,6 +102,17 @@ typedef struct {
     unsigned char lengthOffset; /* No length field if zero */
 
     UA_Boolean txtimeEnabled;
+
+    /* PACKET_MMAP ring (TPACKET_V3) shared with the kernel. Received frames
+     * are parsed in place from the ring blocks. Frames for sending are
+     * allocated in the ring slots and submitted without a copy. */
+    UA_Byte *ring;
+    size_t ringSize;
+    size_t ringBlockSize;
+    size_t ringBlocks;   /* RX ring */
+    size_t ringFrames;   /* TX ring */
+    size_t ringPos;      /* Next block (RX) or frame (TX) */
+    size_t ringReserved; /* Allocated TX frames that are not yet submitted */
 } ETH_FD;
 
 /* The format of a Ethernet address is six groups of hexadecimal digits,
@@ -207,23 +235,87 @@ setETHHeader(unsigned char *buf,
     return (unsigned char)pos;
 }
 
+static UA_Boolean
+ETH_isRingFrame(const ETH_FD *conn, const UA_Byte *data) {
+    return (conn->ringFrames > 0 && data >= conn->ring &&
+            data < conn->ring + conn->ringSize);
+}
+
+static struct tpacket3_hdr *
+ETH_ringFrameHeader(const ETH_FD *conn, const UA_Byte *data) {
+    size_t frame = (size_t)(data - conn->ring) / ETH_RING_FRAMESIZE;
+    return (struct tpacket3_hdr*)(conn->ring + (frame * ETH_RING_FRAMESIZE));
+}
+
+/* Reserve the next frame of the TX ring. Returns false if the ring is full or
+ * the message does not fit into a frame. */
+static UA_Boolean
+ETH_allocRingFrame(ETH_FD *conn, UA_ByteString *buf, size_t bufSize) {
+    if(conn->headerSize + bufSize > ETH_RING_FRAMESIZE - ETH_RING_TXDATAOFFSET ||
+       conn->ringReserved >= conn->ringFrames)
+        return false;
+    struct tpacket3_hdr *hdr = (struct tpacket3_hdr*)
+        (conn->ring + (conn->ringPos * ETH_RING_FRAMESIZE));
+    UA_UInt32 status = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE);
+    if(status != TP_STATUS_AVAILABLE && status != TP_STATUS_WRONG_FORMAT)
+        return false; /* Not yet sent out by the kernel */
+    conn->ringPos = (conn->ringPos + 1) % conn->ringFrames;
+    conn->ringReserved++;
+    buf->data = (UA_Byte*)hdr + ETH_RING_TXDATAOFFSET;
+    buf->length = conn->headerSize + bufSize;
+    return true;
+}
+
+/* Give back an allocated but unsent frame. The last reserved frame is reused
+ * right away. Otherwise the frame is submitted with an invalid header. The
+ * kernel skips such frames with PACKET_LOSS enabled. */
+static void
+ETH_releaseRingFrame(ETH_FD *conn, struct tpacket3_hdr *hdr) {
+    UA_assert(conn->ringReserved > 0);
+    conn->ringReserved--;
+    size_t last = (conn->ringPos + conn->ringFrames - 1) % conn->ringFrames;
+    if((UA_Byte*)hdr == conn->ring + (last * ETH_RING_FRAMESIZE)) {
+        conn->ringPos = last;
+        return;
+    }
+    hdr->tp_len = 0;
+    hdr->tp_next_offset = 1;
+    __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+}
+
 static UA_StatusCode
 ETH_allocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
                        UA_ByteString *buf, size_t bufSize) {
     /* Get the ETH_FD */
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    (void)el;
     UA_FD fd = (UA_FD)connectionId;
+    UA_LOCK(&el->elMutex);
     ETH_FD *erfd = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
-    if(!erfd)
+    if(!erfd) {
+        UA_UNLOCK(&el->elMutex);
         return UA_STATUSCODE_BADCONNECTIONREJECTED;
+    }
+
+    /* Write the frame directly into the TX ring. Fall back to a normal buffer
+     * if the ring is full. */
+    if(erfd->ringFrames > 0 && ETH_allocRingFrame(erfd, buf, bufSize)) {
+        UA_UNLOCK(&el->elMutex);
+        buf->data   += erfd->headerSize;
+        buf->length -= erfd->headerSize;
+        return UA_STATUSCODE_GOOD;
+    }
+    size_t headerSize = erfd->headerSize;
+    UA_UNLOCK(&el->elMutex);
 
     /* Allocate the buffer with the hidden Ethernet header in front */
     UA_StatusCode res =
         UA_EventLoopPOSIX_allocNetworkBuffer(cm, connectionId, buf,
-                                             bufSize + erfd->headerSize);
+                                             bufSize + headerSize);
     if(UA_LIKELY(res == UA_STATUSCODE_GOOD)) {
-        buf->data   += erfd->headerSize;
-        buf->length -= erfd->headerSize;
+        buf->data   += headerSize;
+        buf->length -= headerSize;
     }
     return res;
 }
@@ -233,14 +325,28 @@ ETH_freeNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
                       UA_ByteString *buf) {
     /* Get the ETH_FD */
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    (void)el;
     UA_FD fd = (UA_FD)connectionId;
+    UA_LOCK(&el->elMutex);
     ETH_FD *erfd = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
-    if(!erfd)
+    if(!erfd) {
+        UA_UNLOCK(&el->elMutex);
         return;
+    }
+
+    /* Release the TX ring frame */
+    if(ETH_isRingFrame(erfd, buf->data)) {
+        ETH_releaseRingFrame(erfd, ETH_ringFrameHeader(erfd, buf->data));
+        UA_UNLOCK(&el->elMutex);
+        UA_ByteString_init(buf);
+        return;
+    }
 
     /* Unhide the Ethernet header and free */
     buf->data   -= erfd->headerSize;
     buf->length += erfd->headerSize;
+    UA_UNLOCK(&el->elMutex);
     UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
 }
 
@@ -285,6 +391,12 @@ ETH_close(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
                         &UA_KEYVALUEMAP_NULL, UA_BYTESTRING_NULL);
     UA_LOCK(&el->elMutex);
 
+    /* Unmap the ring */
+    if(conn->ring) {
+        munmap(conn->ring, conn->ringSize);
+        conn->ring = NULL;
+    }
+
     /* Close the socket */
     int ret = UA_close(conn->rfd.fd);
     if(ret == 0) {
@@ -319,6 +431,103 @@ ETH_delayedClose(void *application, void *context) {
     UA_free(conn);
 }
 
+/* Parse the Ethernet header and forward the frame to the application */
+static void
+ETH_deliverFrame(UA_ConnectionManager *cm, ETH_FD *conn, UA_ByteString frame) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    (void)el;
+
+    /* Parse the Ethernet header */
+    unsigned char destAddr[ETHER_ADDR_LEN];
+    unsigned char sourceAddr[ETHER_ADDR_LEN];
+    UA_UInt16 etherType = 0;
+    UA_UInt16 vid = 0;
+    UA_Byte pcp = 0;
+    UA_Boolean dei = 0;
+    size_t headerSize = parseETHHeader(&frame, destAddr, sourceAddr,
+                                       &etherType, &vid, &pcp, &dei);
+    if(headerSize == 0)
+        return;
+
+    /* Set up the parameter arguments passed to the application */
+    unsigned char destAddrBytes[18];
+    unsigned char sourceAddrBytes[18];
+    setAddrString(destAddrBytes, destAddr);
+    setAddrString(sourceAddrBytes, sourceAddr);
+    UA_String destAddrStr = {17, destAddrBytes};
+    UA_String sourceAddrStr = {17, sourceAddrBytes};
+
+    size_t paramsSize = 2;
+    UA_KeyValuePair params[6];
+    params[0].key = UA_QUALIFIEDNAME(0, "destination-address");
+    UA_Variant_setScalar(&params[0].value, &destAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "source-address");
+    UA_Variant_setScalar(&params[1].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+
+    if(etherType > 0) {
+        params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
+        UA_Variant_setScalar(&params[2].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+        paramsSize++;
+    }
+
+    if(vid > 0) {
+        params[paramsSize].key = UA_QUALIFIEDNAME(0, "vid");
+        UA_Variant_setScalar(&params[paramsSize].value, &vid, &UA_TYPES[UA_TYPES_UINT16]);
+        params[paramsSize+1].key = UA_QUALIFIEDNAME(0, "pcp");
+        UA_Variant_setScalar(&params[paramsSize+1].value, &pcp, &UA_TYPES[UA_TYPES_BYTE]);
+        params[paramsSize+2].key = UA_QUALIFIEDNAME(0, "dei");
+        UA_Variant_setScalar(&params[paramsSize+2].value, &dei, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        paramsSize += 3;
+    }
+
+    /* Callback to the application layer with the Ethernet header hidden */
+    UA_KeyValueMap map = {paramsSize, params};
+    frame.data += headerSize;
+    frame.length -= headerSize;
+    UA_UNLOCK(&el->elMutex);
+    conn->applicationCB(cm, (uintptr_t)conn->rfd.fd, conn->application,
+                        &conn->context, UA_CONNECTIONSTATE_ESTABLISHED, &map, frame);
+    UA_LOCK(&el->elMutex);
+}
+
+/* Process the blocks of the RX ring that were retired by the kernel. The
+ * frames are forwarded from the ring memory without a copy. Afterwards the
+ * blocks are handed back to the kernel. */
+static void
+ETH_receiveRing(UA_ConnectionManager *cm, ETH_FD *conn) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    for(size_t i = 0; i < conn->ringBlocks; i++) {
+        struct tpacket_block_desc *block = (struct tpacket_block_desc*)
+            (conn->ring + (conn->ringPos * conn->ringBlockSize));
+        if(!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+             TP_STATUS_USER))
+            return;
+
+        UA_UInt32 pkts = block->hdr.bh1.num_pkts;
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH %u\t| Received a ring block with %u frames",
+                     (unsigned)conn->rfd.fd, (unsigned)pkts);
+
+        struct tpacket3_hdr *ppd = (struct tpacket3_hdr*)
+            ((UA_Byte*)block + block->hdr.bh1.offset_to_first_pkt);
+        for(UA_UInt32 j = 0; j < pkts; j++) {
+            UA_ByteString frame = {ppd->tp_snaplen, (UA_Byte*)ppd + ppd->tp_mac};
+            ETH_deliverFrame(cm, conn, frame);
+            /* The connection was closed in the callback */
+            if(conn->rfd.dc.callback)
+                break;
+            ppd = (struct tpacket3_hdr*)((UA_Byte*)ppd + ppd->tp_next_offset);
+        }
+
+        /* Return the block to the kernel */
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                         __ATOMIC_RELEASE);
+        conn->ringPos = (conn->ringPos + 1) % conn->ringBlocks;
+        if(conn->rfd.dc.callback)
+            return;
+    }
+}
+
 /* Gets called when a socket receives data or closes */
 static void
 ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
@@ -338,8 +547,14 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
         return;
     }
 
+    /* Parse the frames in place from the RX ring */
+    if(conn->ringBlocks > 0) {
+        ETH_receiveRing(cm, conn);
+        return;
+    }
+
     /* Use the already allocated receive-buffer */
-    UA_ByteString response = pcm->rxBuffer;;
+    UA_ByteString response = pcm->rxBuffer;
 
     /* Receive */
 #ifndef _WIN32
@@ -372,60 +587,7 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
                  (unsigned)rfd->fd, (unsigned)ret);
 
     response.length = (size_t)ret;
-
-    /* Parse the Ethernet header */
-    unsigned char destAddr[ETHER_ADDR_LEN];
-    unsigned char sourceAddr[ETHER_ADDR_LEN];
-    UA_UInt16 etherType = 0;
-    UA_UInt16 vid = 0;
-    UA_Byte pcp = 0;
-    UA_Boolean dei = 0;
-    size_t headerSize = parseETHHeader(&response, destAddr, sourceAddr,
-                                       &etherType, &vid, &pcp, &dei);
-    if(headerSize == 0)
-        return;
-
-    /* Set up the parameter arguments passed to the application */
-    unsigned char destAddrBytes[18];
-    unsigned char sourceAddrBytes[18];
-    setAddrString(destAddrBytes, destAddr);
-    setAddrString(sourceAddrBytes, sourceAddr);
-    UA_String destAddrStr = {17, destAddrBytes};
-    UA_String sourceAddrStr = {17, sourceAddrBytes};
-
-    size_t paramsSize = 2;
-    UA_KeyValuePair params[6];
-    params[0].key = UA_QUALIFIEDNAME(0, "destination-address");
-    UA_Variant_setScalar(&params[0].value, &destAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-    params[1].key = UA_QUALIFIEDNAME(0, "source-address");
-    UA_Variant_setScalar(&params[1].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-
-    if(etherType > 0) {
-        params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
-        UA_Variant_setScalar(&params[1].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
-        paramsSize++;
-    }
-
-    if(vid > 0) {
-        params[paramsSize].key = UA_QUALIFIEDNAME(0, "vid");
-        UA_Variant_setScalar(&params[paramsSize].value, &vid, &UA_TYPES[UA_TYPES_UINT16]);
-        params[paramsSize+1].key = UA_QUALIFIEDNAME(0, "pcp");
-        UA_Variant_setScalar(&params[paramsSize+1].value, &pcp, &UA_TYPES[UA_TYPES_BYTE]);
-        params[paramsSize+2].key = UA_QUALIFIEDNAME(0, "dei");
-        UA_Variant_setScalar(&params[paramsSize+2].value, &dei, &UA_TYPES[UA_TYPES_BOOLEAN]);
-        paramsSize += 3;
-    }
-
-    /* Callback to the application layer with the Ethernet header hidden */
-    UA_KeyValueMap map = {paramsSize, params};
-    response.data += headerSize;
-    response.length -= headerSize;
-    UA_UNLOCK(&el->elMutex);
-    conn->applicationCB(cm, (uintptr_t)rfd->fd, conn->application, &conn->context,
-                        UA_CONNECTIONSTATE_ESTABLISHED, &map, response);
-    UA_LOCK(&el->elMutex);
-    response.data -= headerSize;
-    response.length += headerSize;
+    ETH_deliverFrame(cm, conn, response);
 }
 
 static UA_StatusCode
@@ -620,6 +782,92 @@ ETH_openSendConnection(UA_EventLoopPOSIX *el, ETH_FD *conn, const UA_KeyValueMap
     return UA_STATUSCODE_GOOD;
 }
 
+/* Map a PACKET_MMAP ring (TPACKET_V3) into the memory. Listen connections get
+ * an RX ring, send connections a TX ring. */
+static UA_StatusCode
+ETH_setupRing(UA_EventLoopPOSIX *el, ETH_FD *conn, const UA_KeyValueMap *params,
+              UA_Boolean listen) {
+    UA_UInt32 blockSize = ETH_RING_BLOCKSIZE;
+    const UA_UInt32 *blockSizeParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_RING_BLOCKSIZE].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(blockSizeParam)
+        blockSize = *blockSizeParam;
+
+    UA_UInt32 blocks = ETH_RING_BLOCKS;
+    const UA_UInt32 *blocksParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_RING_BLOCKS].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(blocksParam)
+        blocks = *blocksParam;
+
+    UA_UInt32 timeout = ETH_RING_TIMEOUT;
+    const UA_UInt32 *timeoutParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_RING_TIMEOUT].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(timeoutParam)
+        timeout = *timeoutParam;
+
+    int version = TPACKET_V3;
+    int res = setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_VERSION,
+                         &version, sizeof(version));
+    if(res < 0)
+        goto error;
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(struct tpacket_req3));
+    req.tp_block_size = blockSize;
+    req.tp_block_nr = blocks;
+    req.tp_frame_size = ETH_RING_FRAMESIZE;
+    req.tp_frame_nr = (blockSize / ETH_RING_FRAMESIZE) * blocks;
+    int ringType = PACKET_TX_RING;
+    if(listen) {
+        /* Retire partially filled blocks after the timeout */
+        req.tp_retire_blk_tov = timeout;
+        ringType = PACKET_RX_RING;
+    } else {
+        /* Skip released frames (with an invalid header) instead of stopping
+         * the transmission */
+        int loss = 1;
+        res = setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_LOSS, &loss, sizeof(loss));
+        if(res < 0)
+            goto error;
+    }
+    res = setsockopt(conn->rfd.fd, SOL_PACKET, ringType, &req, sizeof(req));
+    if(res < 0)
+        goto error;
+
+    size_t ringSize = (size_t)blockSize * blocks;
+    void *ring = mmap(NULL, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      conn->rfd.fd, 0);
+    if(ring == MAP_FAILED)
+        goto error;
+
+    conn->ring = (UA_Byte*)ring;
+    conn->ringSize = ringSize;
+    conn->ringBlockSize = blockSize;
+    if(listen)
+        conn->ringBlocks = blocks;
+    else
+        conn->ringFrames = req.tp_frame_nr;
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                "ETH %u\t| Mapped a %s ring with %u blocks of %u bytes",
+                (unsigned)conn->rfd.fd, (listen) ? "RX" : "TX",
+                (unsigned)blocks, (unsigned)blockSize);
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                    "ETH %u\t| Could not set up the PACKET_MMAP ring (%s)",
+                    (unsigned)conn->rfd.fd, errno_str));
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
+
 static UA_StatusCode
 ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
                    void *application, void *context,
@@ -744,6 +992,17 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     if(validate || res != UA_STATUSCODE_GOOD)
         goto cleanup;
 
+    /* Set up the PACKET_MMAP ring */
+    const UA_Boolean *ring = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_RING].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(ring && *ring) {
+        res = ETH_setupRing(el, conn, params, (listen && *listen));
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+
     /* Register in the EventLoop */
     res = UA_EventLoopPOSIX_registerFD(el, &conn->rfd);
     if(res != UA_STATUSCODE_GOOD)
@@ -761,6 +1020,8 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     return UA_STATUSCODE_GOOD;
 
  cleanup:
+    if(conn && conn->ring)
+        munmap(conn->ring, conn->ringSize);
     UA_close(sockfd);
     UA_free(conn);
     UA_UNLOCK(&el->elMutex);
@@ -885,11 +1146,51 @@ send_txtime(UA_EventLoopPOSIX *el, ETH_FD *conn, const UA_KeyValueMap *params,
 }
 #endif
 
+/* Free the send buffer (with the Ethernet header uncovered) */
+static void
+ETH_freeSendBuffer(UA_ConnectionManager *cm, ETH_FD *conn, UA_ByteString *buf) {
+    if(ETH_isRingFrame(conn, buf->data)) {
+        ETH_releaseRingFrame(conn, ETH_ringFrameHeader(conn, buf->data));
+        UA_ByteString_init(buf);
+        return;
+    }
+    UA_EventLoopPOSIX_freeNetworkBuffer(cm, (uintptr_t)conn->rfd.fd, buf);
+}
+
+/* Hand the frame over to the kernel and trigger the transmission. Frames that
+ * cannot go out right away remain in the ring and are sent with the next
+ * trigger. */
+static UA_StatusCode
+ETH_submitRingFrame(UA_POSIXConnectionManager *pcm, ETH_FD *conn,
+                    UA_ByteString *buf) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    struct tpacket3_hdr *hdr = ETH_ringFrameHeader(conn, buf->data);
+    hdr->tp_len = (__u32)buf->length;
+    hdr->tp_next_offset = 0;
+    __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+    conn->ringReserved--;
+    UA_ByteString_init(buf);
+
+    ssize_t n = UA_sendto(conn->rfd.fd, NULL, 0, MSG_DONTWAIT | MSG_NOSIGNAL,
+                          (struct sockaddr*)&conn->sll, sizeof(conn->sll));
+    if(n < 0 && UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_WOULDBLOCK &&
+       UA_ERRNO != UA_AGAIN && UA_ERRNO != ENOBUFS) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH %u\t| Send failed with error %s",
+                        (unsigned)conn->rfd.fd, errno_str));
+        ETH_shutdown(pcm, conn);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params, UA_ByteString *buf) {
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_StatusCode res;
 
     UA_LOCK(&el->elMutex);
 
@@ -919,11 +1220,19 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
         UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                      "ETH %u\t| txtime was not configured for the connection",
                      (unsigned)connectionId);
+        ETH_freeSendBuffer(cm, conn, buf);
         UA_UNLOCK(&el->elMutex);
-        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* Submit the frame from the TX ring without a copy. With a txtime the
+     * frame is sent with sendmsg from the ring memory below. */
+    if(!txtime && ETH_isRingFrame(conn, buf->data)) {
+        res = ETH_submitRingFrame(pcm, conn, buf);
+        UA_UNLOCK(&el->elMutex);
+        return res;
+    }
+
     /* Prevent OS signals when sending to a closed socket */
     int flags = MSG_NOSIGNAL;
 
@@ -960,8 +1269,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                     "ETH %u\t| Send failed with error %s",
                                     (unsigned)connectionId, errno_str));
                     ETH_shutdown(pcm, conn);
+                    ETH_freeSendBuffer(cm, conn, buf);
                     UA_UNLOCK(&el->elMutex);
-                    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
                     return UA_STATUSCODE_BADCONNECTIONCLOSED;
                 }
 
@@ -976,8 +1285,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                         "ETH %u\t| Send failed with error %s",
                                         (unsigned)connectionId, errno_str));
                         ETH_shutdown(pcm, conn);
+                        ETH_freeSendBuffer(cm, conn, buf);
                         UA_UNLOCK(&el->elMutex);
-                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
                         return UA_STATUSCODE_BADCONNECTIONCLOSED;
                     }
                 } while(poll_ret <= 0);
@@ -987,8 +1296,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
     } while(nWritten < buf->length);
 
     /* Free the buffer */
+    ETH_freeSendBuffer(cm, conn, buf);
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
     return UA_STATUSCODE_GOOD;
 }
 
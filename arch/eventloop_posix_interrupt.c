@@ -13,12 +13,12 @@
  * - Other: Use the self-pipe trick (http://cr.yp.to/docs/selfpipe.html) */
 
 typedef struct UA_RegisteredSignal {
-#ifdef UA_HAVE_EPOLL
-    /* With epoll, register each signal with a socket.
+#ifdef UA_HAVE_SIGNALFD
+    /* With signalfd, register each signal with a socket.
      * This has to be the first element of the struct to allow casting. */
     UA_RegisteredFD rfd;
 #else
-    /* Without epoll, we add the rfd to a tailq and self-pipe to trigger the
+    /* Without signalfd, we add the rfd to a tailq and self-pipe to trigger the
      * traversal of the tailq */
     TAILQ_ENTRY(UA_RegisteredSignal) triggeredEntry;
 #endif
@@ -40,23 +40,23 @@ typedef struct {
     size_t signalsSize;
     LIST_HEAD(, UA_RegisteredSignal) signals;
 
-#ifndef UA_HAVE_EPOLL
+#ifndef UA_HAVE_SIGNALFD
     UA_RegisteredFD readFD;
     UA_FD writeFD;
     TAILQ_HEAD(, UA_RegisteredSignal) triggered;
 #endif
 } UA_POSIXInterruptManager;
 
-#ifndef UA_HAVE_EPOLL
+#ifndef UA_HAVE_SIGNALFD
 /* On non-linux systems we can have at most one interrupt manager */
 static UA_POSIXInterruptManager *singletonIM = NULL;
 #endif
 
-/* The following methods have to be implemented for epoll/self-pipe each. */
+/* The following methods have to be implemented for signalfd/self-pipe each. */
 static void activateSignal(UA_RegisteredSignal *rs);
 static void deactivateSignal(UA_RegisteredSignal *rs);
 
-#ifdef UA_HAVE_EPOLL
+#ifdef UA_HAVE_SIGNALFD
 #include <sys/signalfd.h>
 
 static void
@@ -160,7 +160,7 @@ deactivateSignal(UA_RegisteredSignal *rs) {
     UA_close(rs->rfd.fd);
 }
 
-#else /* !UA_HAVE_EPOLL */
+#else /* !UA_HAVE_SIGNALFD */
 
 static void
 triggerPOSIXInterruptEvent(int sig) {
@@ -275,7 +275,7 @@ executeTriggeredPOSIXInterrupts(UA_EventSource *es, UA_RegisteredFD *rfd, short
     }
 }
 
-#endif /* !UA_HAVE_EPOLL */
+#endif /* !UA_HAVE_SIGNALFD */
 
 static UA_StatusCode
 registerPOSIXInterrupt(UA_InterruptManager *im, uintptr_t interruptHandle,
@@ -314,7 +314,7 @@ registerPOSIXInterrupt(UA_InterruptManager *im, uintptr_t interruptHandle,
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-#ifdef UA_HAVE_EPOLL
+#ifdef UA_HAVE_SIGNALFD
     rs->rfd.es = &im->eventSource;
 #endif
     rs->signal = (int)interruptHandle;
@@ -401,7 +401,7 @@ startPOSIXInterruptManager(UA_EventSource *es) {
     UA_LOG_DEBUG(es->eventLoop->logger, UA_LOGCATEGORY_EVENTLOOP,
                  "Interrupt\t| Starting the InterruptManager");
 
-#ifndef UA_HAVE_EPOLL
+#ifndef UA_HAVE_SIGNALFD
     /* Create pipe for self-signaling */
     UA_FD pipefd[2];
 #ifdef _WIN32
@@ -489,7 +489,7 @@ stopPOSIXInterruptManager(UA_EventSource *es) {
         deactivateSignal(rs);
     }
 
-#ifndef UA_HAVE_EPOLL
+#ifndef UA_HAVE_SIGNALFD
     /* Close the FD for the self-pipe trick */
     UA_EventLoopPOSIX_deregisterFD(el, &pim->readFD);
     UA_close(pim->readFD.fd);
@@ -527,7 +527,7 @@ freePOSIXInterruptmanager(UA_EventSource *es) {
     UA_String_clear(&es->name);
     UA_free(es);
 
-#ifndef UA_HAVE_EPOLL
+#ifndef UA_HAVE_SIGNALFD
     singletonIM = NULL; /* Reset the global singleton pointer */
 #endif
 
@@ -536,8 +536,8 @@ freePOSIXInterruptmanager(UA_EventSource *es) {
 
 UA_InterruptManager *
 UA_InterruptManager_new_POSIX(const UA_String eventSourceName) {
-#ifndef UA_HAVE_EPOLL
-    /* There can be only one InterruptManager if epoll is not present */
+#ifndef UA_HAVE_SIGNALFD
+    /* There can be only one InterruptManager if signalfd is not present */
     if(singletonIM)
         return NULL;
 #endif
@@ -549,7 +549,7 @@ UA_InterruptManager_new_POSIX(const UA_String eventSourceName) {
 
     LIST_INIT(&pim->signals);
 
-#ifndef UA_HAVE_EPOLL
+#ifndef UA_HAVE_SIGNALFD
     TAILQ_INIT(&pim->triggered);
     singletonIM = pim; /* Register the singleton singleton pointer */
 #endif
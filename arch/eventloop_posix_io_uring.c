@@ -0,0 +1,1069 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "eventloop_posix.h"
+
+#if defined(UA_HAVE_IO_URING)
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+/* The fds are served with completion-based requests in io_uring:
+ *
+ * - Receive: An fd with a recvCB that listens for UA_FDEVENT_IN has a
+ *   multishot recv request pending. The kernel picks one of the receive
+ *   buffers that are registered with the ring (buffer ring) whenever data
+ *   arrives. The data is handed to the recvCB and the buffer is given back to
+ *   the ring afterwards.
+ *   If all buffers are in use, or for fds without a recvCB, a one-shot poll
+ *   request signals the readiness instead. Then the EventSource does its own
+ *   recv/accept. Provide at least as many buffers as messages are expected to
+ *   arrive within one EventLoop iteration.
+ * - Send: The sends are queued in the ring. A send is canceled if the peer
+ *   does not accept the data in time. The deadlines are checked in every
+ *   EventLoop iteration instead of linking a timeout request to every send.
+ *   That would arm (and cancel) a timer in the kernel for every send. The
+ *   sends of an fd are submitted one after the other to keep their order.
+ *   The EventSources write into buffers from a pool that is registered with
+ *   the ring. These are sent without a copy in userspace. Large sends from
+ *   the pool use zero-copy sends. Then the buffer is returned to the pool
+ *   only after the kernel notifies that it no longer reads from it.
+ *
+ * The other requests are one-shot and re-armed after every completion. The requests
+ * that are queued during the dispatch of the completions are submitted in a
+ * batch. If sends were queued, the batch is submitted right after the
+ * dispatch. Otherwise together with the next wait for completions. So there
+ * are at most two syscalls per EventLoop iteration, independent of the number
+ * of fds. The wait uses a timespec timeout with sub-millisecond precision.
+ *
+ * The user_data of every request encodes the type of the request in the lowest
+ * two bits. For poll and recv requests, the fd and the generation of the
+ * registration are encoded in the remaining bits. Completions for an outdated
+ * generation are ignored. For sends, the remaining bits are the pointer to the
+ * UA_IoUringSend request. */
+
+#define UA_IO_URING_SQ_ENTRIES 1024
+#define UA_IO_URING_CQ_ENTRIES 8192
+
+#define UA_IO_URING_BUFFERS 4096 /* Must be a power of two */
+#define UA_IO_URING_BUFSIZE 2048
+#define UA_IO_URING_BUFGROUP 0
+
+#define UA_IO_URING_SENDTIMEOUT 10 /* seconds */
+
+/* Smaller sends are copied into the socket buffer. Zero-copy pins the pages
+ * and costs an additional notification. That pays off only for large sends. */
+#define UA_IO_URING_ZEROCOPY_MIN 16384
+
+#define UA_IO_URING_OP_POLL 0
+#define UA_IO_URING_OP_RECV 1
+#define UA_IO_URING_OP_SEND 2
+#define UA_IO_URING_OP_IGNORE 3 /* Cancellations */
+#define UA_IO_URING_OP_MASK 3
+
+/* Not defined in the headers before Linux 6.0 */
+#ifndef IORING_RECV_MULTISHOT
+# define IORING_RECV_MULTISHOT (1U << 1)
+#endif
+#ifndef IORING_RECVSEND_FIXED_BUF
+# define IORING_RECVSEND_FIXED_BUF (1U << 2)
+# define IORING_CQE_F_NOTIF (1U << 3)
+# define IORING_OP_SEND_ZC 47
+#endif
+
+static int
+io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete,
+               unsigned flags, void *arg, size_t argSize) {
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+                        flags, arg, argSize);
+}
+
+static int
+io_uring_register(int fd, unsigned opcode, void *arg, unsigned nrArgs) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+static UA_UInt64
+userData(UA_FD fd, UA_UInt32 generation, UA_UInt64 op) {
+    return ((UA_UInt64)generation << 32) | ((UA_UInt64)(UA_UInt32)fd << 2) | op;
+}
+
+static UA_UInt64
+sendUserData(UA_IoUringSend *req) {
+    UA_assert(((uintptr_t)req & UA_IO_URING_OP_MASK) == 0);
+    return (UA_UInt64)(uintptr_t)req | UA_IO_URING_OP_SEND;
+}
+
+/*********************/
+/* Submission Queue  */
+/*********************/
+
+static unsigned
+pendingSubmissions(UA_IoUring *ring) {
+    return ring->sqTailLocal - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+}
+
+/* Make the queued entries visible to the kernel */
+static void
+publishSQEs(UA_IoUring *ring) {
+    __atomic_store_n(ring->sqTail, ring->sqTailLocal, __ATOMIC_RELEASE);
+}
+
+/* Submit the queued requests without waiting for completions */
+static void
+submit(UA_EventLoopPOSIX *el) {
+    UA_IoUring *ring = &el->ring;
+    publishSQEs(ring);
+    unsigned pending = pendingSubmissions(ring);
+    while(pending > 0) {
+        int res = io_uring_enter(ring->ringfd, pending, 0, 0, NULL, 0);
+        if(res < 0) {
+            if(errno == EINTR)
+                continue;
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                              "io_uring\t| Could not submit requests (%s)",
+                              errno_str));
+            return;
+        }
+        pending = pendingSubmissions(ring);
+    }
+}
+
+/* Ensure that n entries are free in the submission queue. Flushes the queue if
+ * it is full. Linked requests must be queued without a flush in-between. */
+static UA_Boolean
+reserveSQEs(UA_EventLoopPOSIX *el, unsigned n) {
+    UA_IoUring *ring = &el->ring;
+    if(ring->sqEntries - pendingSubmissions(ring) >= n)
+        return true;
+    submit(el);
+    return (ring->sqEntries - pendingSubmissions(ring) >= n);
+}
+
+/* Get the next submission queue entry. Call reserveSQEs before. */
+static struct io_uring_sqe *
+nextSQE(UA_IoUring *ring) {
+    struct io_uring_sqe *sqe = &ring->sqes[ring->sqTailLocal & ring->sqMask];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sqTailLocal++;
+    ring->requests++;
+    return sqe;
+}
+
+/* Submit right away if not called from within the dispatch of completions */
+static void
+flushSQEs(UA_EventLoopPOSIX *el) {
+    if(el->ring.dispatching)
+        publishSQEs(&el->ring);
+    else
+        submit(el);
+}
+
+/*******************/
+/* Receive Buffers */
+/*******************/
+
+static void
+recycleBuffer(UA_IoUring *ring, unsigned short bid) {
+    struct io_uring_buf *b =
+        &ring->bufRing->bufs[ring->bufTail & (UA_IO_URING_BUFFERS - 1)];
+    b->addr = (UA_UInt64)(uintptr_t)&ring->bufs[(size_t)bid * UA_IO_URING_BUFSIZE];
+    b->len = UA_IO_URING_BUFSIZE;
+    b->bid = bid;
+    ring->bufTail++;
+    __atomic_store_n(&ring->bufRing->tail, ring->bufTail, __ATOMIC_RELEASE);
+}
+
+/* Register the receive buffers with the kernel. Without them, the readiness of
+ * all fds is polled. */
+static void
+setupBuffers(UA_EventLoopPOSIX *el) {
+    UA_IoUring *ring = &el->ring;
+    ring->bufRingSize = UA_IO_URING_BUFFERS * sizeof(struct io_uring_buf);
+    void *bufRing = mmap(NULL, ring->bufRingSize, PROT_READ | PROT_WRITE,
+                         MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if(bufRing == MAP_FAILED)
+        return;
+    ring->bufs = (UA_Byte*)
+        UA_malloc((size_t)UA_IO_URING_BUFFERS * UA_IO_URING_BUFSIZE);
+    if(!ring->bufs) {
+        munmap(bufRing, ring->bufRingSize);
+        return;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+    reg.ring_addr = (UA_UInt64)(uintptr_t)bufRing;
+    reg.ring_entries = UA_IO_URING_BUFFERS;
+    reg.bgid = UA_IO_URING_BUFGROUP;
+    if(io_uring_register(ring->ringfd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "io_uring\t| Could not register the receive buffers, "
+                       "polling for readiness instead (%s)", errno_str));
+        munmap(bufRing, ring->bufRingSize);
+        UA_free(ring->bufs);
+        ring->bufs = NULL;
+        return;
+    }
+
+    ring->bufRing = (struct io_uring_buf_ring*)bufRing;
+    for(unsigned short i = 0; i < UA_IO_URING_BUFFERS; i++)
+        recycleBuffer(ring, i);
+}
+
+/****************/
+/* Send Buffers */
+/****************/
+
+/* Returns the index in the pool or -1 */
+static int
+sendBufferIndex(UA_EventLoopPOSIX *el, const UA_Byte *data) {
+    UA_Byte *pool = el->sendBufs.data;
+    if(!pool || data < pool ||
+       data >= pool + (size_t)UA_IO_URING_SENDBUFFERS * UA_IO_URING_SENDBUFSIZE)
+        return -1;
+    return (int)((size_t)(data - pool) / UA_IO_URING_SENDBUFSIZE);
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_allocSendBuffer(UA_EventLoopPOSIX *el, UA_ByteString *buf,
+                                  size_t bufSize) {
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+    UA_IoUringSendBuffers *sb = &el->sendBufs;
+    if(!sb->data || sb->freeSize == 0 ||
+       bufSize == 0 || bufSize > UA_IO_URING_SENDBUFSIZE)
+        return UA_ByteString_allocBuffer(buf, bufSize);
+    unsigned short idx = sb->freeList[--sb->freeSize];
+    buf->data = &sb->data[(size_t)idx * UA_IO_URING_SENDBUFSIZE];
+    buf->length = bufSize;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_EventLoopPOSIX_freeSendBuffer(UA_EventLoopPOSIX *el, UA_ByteString *buf) {
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+    int idx = sendBufferIndex(el, buf->data);
+    if(idx < 0) {
+        UA_ByteString_clear(buf);
+        return;
+    }
+    UA_IoUringSendBuffers *sb = &el->sendBufs;
+    UA_assert(sb->freeSize < UA_IO_URING_SENDBUFFERS);
+    sb->freeList[sb->freeSize++] = (unsigned short)idx;
+    UA_ByteString_init(buf);
+}
+
+/* Allocate the pool when the EventLoop starts the first time. Register it with
+ * the ring for zero-copy sends. Without the registration the buffers are still
+ * sent without a copy in userspace. */
+static void
+setupSendBuffers(UA_EventLoopPOSIX *el) {
+    UA_IoUringSendBuffers *sb = &el->sendBufs;
+    if(!sb->data) {
+        sb->data = (UA_Byte*)
+            UA_malloc((size_t)UA_IO_URING_SENDBUFFERS * UA_IO_URING_SENDBUFSIZE);
+        if(!sb->data)
+            return;
+        for(unsigned short i = 0; i < UA_IO_URING_SENDBUFFERS; i++)
+            sb->freeList[i] = (unsigned short)(UA_IO_URING_SENDBUFFERS - 1 - i);
+        sb->freeSize = UA_IO_URING_SENDBUFFERS;
+    }
+
+    struct iovec iov;
+    iov.iov_base = sb->data;
+    iov.iov_len = (size_t)UA_IO_URING_SENDBUFFERS * UA_IO_URING_SENDBUFSIZE;
+    if(io_uring_register(el->ring.ringfd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "io_uring\t| Could not register the send buffers, "
+                       "no zero-copy sends (%s)", errno_str));
+        return;
+    }
+    el->ring.sendBufsRegistered = true;
+}
+
+/************/
+/* Requests */
+/************/
+
+static UA_StatusCode
+queuePollAdd(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd, UA_UInt32 generation) {
+    UA_IoUring *ring = &el->ring;
+    if(!reserveSQEs(el, 1))
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_UInt32 events = 0;
+    if(rfd->listenEvents & UA_FDEVENT_IN)
+        events |= POLLIN;
+    if(rfd->listenEvents & UA_FDEVENT_OUT)
+        events |= POLLOUT;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    events = (events << 16) | (events >> 16); /* Halfwords are swapped */
+#endif
+    struct io_uring_sqe *sqe = nextSQE(ring);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = rfd->fd;
+    sqe->poll32_events = events;
+    sqe->user_data = userData(rfd->fd, generation, UA_IO_URING_OP_POLL);
+    ring->fds[rfd->fd].armed = sqe->user_data;
+    flushSQEs(el);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+queueRecv(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd, UA_UInt32 generation) {
+    UA_IoUring *ring = &el->ring;
+    if(!reserveSQEs(el, 1))
+        return UA_STATUSCODE_BADINTERNALERROR;
+    struct io_uring_sqe *sqe = nextSQE(ring);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->ioprio = (ring->noMultishot) ? 0 : IORING_RECV_MULTISHOT;
+    sqe->fd = rfd->fd;
+    sqe->len = UA_IO_URING_BUFSIZE;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = UA_IO_URING_BUFGROUP;
+    sqe->user_data = userData(rfd->fd, generation, UA_IO_URING_OP_RECV);
+    ring->fds[rfd->fd].armed = sqe->user_data;
+    flushSQEs(el);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Receive into the registered buffers if possible. Otherwise poll. */
+static UA_StatusCode
+armFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd, UA_UInt32 generation) {
+    if(rfd->recvCB && rfd->listenEvents == UA_FDEVENT_IN && el->ring.bufRing)
+        return queueRecv(el, rfd, generation);
+    return queuePollAdd(el, rfd, generation);
+}
+
+static void
+queueCancel(UA_EventLoopPOSIX *el, UA_UInt64 target) {
+    UA_IoUring *ring = &el->ring;
+    if(!reserveSQEs(el, 1))
+        return;
+    struct io_uring_sqe *sqe = nextSQE(ring);
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = UA_IO_URING_OP_IGNORE;
+    flushSQEs(el);
+}
+
+static void
+removeInflight(UA_IoUring *ring, UA_IoUringSend *req) {
+    if(!req->inflight)
+        return;
+    TAILQ_REMOVE(&ring->inflight, req, inflightPointers);
+    req->inflight = false;
+}
+
+/* Queue the (remaining) buffer. The deadline restarts with every submission. */
+static UA_StatusCode
+queueSend(UA_EventLoopPOSIX *el, UA_IoUringSend *req) {
+    UA_IoUring *ring = &el->ring;
+    if(ring->draining || !reserveSQEs(el, 1))
+        return UA_STATUSCODE_BADINTERNALERROR;
+    size_t len = req->buf.length - req->written;
+    if(len > UA_UINT32_MAX)
+        len = UA_UINT32_MAX;
+    struct io_uring_sqe *sqe = nextSQE(ring);
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = req->fd;
+    sqe->addr = (UA_UInt64)(uintptr_t)&req->buf.data[req->written];
+    sqe->len = (UA_UInt32)len;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = sendUserData(req);
+
+    /* Large sends from the registered pool are zero-copy. The pool is
+     * registered as a single fixed buffer. */
+    req->zeroCopy = (ring->sendBufsRegistered && !ring->noZeroCopy &&
+                     len >= UA_IO_URING_ZEROCOPY_MIN &&
+                     sendBufferIndex(el, req->buf.data) >= 0);
+    if(req->zeroCopy) {
+        sqe->opcode = IORING_OP_SEND_ZC;
+        sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+        sqe->buf_index = 0;
+    }
+
+    removeInflight(ring, req);
+    req->deadline = el->eventLoop.dateTime_nowMonotonic(&el->eventLoop) +
+        (UA_IO_URING_SENDTIMEOUT * UA_DATETIME_SEC);
+    TAILQ_INSERT_TAIL(&ring->inflight, req, inflightPointers);
+    req->inflight = true;
+    ring->sendQueued = true;
+    flushSQEs(el);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The buffer of a zero-copy send is released after the last notification */
+static void
+freeSend(UA_EventLoopPOSIX *el, UA_IoUringSend *req) {
+    if(req->notifs > 0) {
+        req->retired = true;
+        return;
+    }
+    removeInflight(&el->ring, req);
+    LIST_REMOVE(req, pointers);
+    UA_EventLoopPOSIX_freeSendBuffer(el, &req->buf);
+    UA_free(req);
+}
+
+static void
+freeSendChain(UA_EventLoopPOSIX *el, UA_IoUringSend *req) {
+    while(req) {
+        UA_IoUringSend *next = req->next;
+        freeSend(el, req);
+        req = next;
+    }
+}
+
+/* The kernel no longer reads from the buffer of a zero-copy send */
+static void
+processSendNotif(UA_EventLoopPOSIX *el, UA_IoUringSend *req) {
+    UA_assert(req->notifs > 0);
+    req->notifs--;
+    if(req->notifs == 0 && req->retired)
+        freeSend(el, req);
+}
+
+/* Process the completion of a send. Continue with a short send or with the
+ * next send of the fd. Returns whether the EventSource was called. */
+static UA_Boolean
+processSend(UA_EventLoopPOSIX *el, UA_IoUringSend *req, UA_Int32 res) {
+    UA_IoUring *ring = &el->ring;
+
+    removeInflight(ring, req);
+
+    /* Already retired from the queue of the fd */
+    if(req->completed) {
+        freeSend(el, req);
+        return false;
+    }
+
+    /* Zero-copy is not supported by the kernel (before Linux 6.0) or for the
+     * socket type. Resubmit as a normal send. */
+    if(req->zeroCopy && (res == -EOPNOTSUPP || res == -EINVAL) &&
+       !ring->noZeroCopy) {
+        ring->noZeroCopy = true;
+        res = -EAGAIN;
+    }
+
+    /* Continue a short send. The requests of a thread are canceled when the
+     * thread exits. Resubmit unless the send was canceled after its
+     * deadline. */
+    if(res > 0)
+        req->written += (size_t)res;
+    if((res > 0 && req->written < req->buf.length) ||
+       res == -EINTR || res == -EAGAIN ||
+       (res == -ECANCELED &&
+        el->eventLoop.dateTime_nowMonotonic(&el->eventLoop) < req->deadline)) {
+        if(queueSend(el, req) == UA_STATUSCODE_GOOD)
+            return false;
+        res = -EIO;
+    }
+
+    UA_Boolean failed = (req->written < req->buf.length);
+    if(failed && !ring->draining) {
+        errno = (res == -ECANCELED) ? ETIMEDOUT : -res;
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                          "io_uring %u\t| Send failed (%s)",
+                          (unsigned)req->fd, errno_str));
+    }
+
+    /* The fd was deregistered. The remaining sends use a duplicate of the fd
+     * that is closed after the last send. */
+    UA_IoUringSend *next = req->next;
+    if(req->orphaned) {
+        UA_FD fd = req->fd;
+        freeSend(el, req);
+        if(!failed && next && queueSend(el, next) == UA_STATUSCODE_GOOD)
+            return false;
+        freeSendChain(el, next);
+        if(fd != UA_INVALID_FD)
+            UA_close(fd);
+        return false;
+    }
+
+    UA_IoUringFD *entry = &ring->fds[req->fd];
+    UA_assert(entry->sendFirst == req);
+    entry->sendFirst = next;
+    if(!next)
+        entry->sendLast = NULL;
+    freeSend(el, req);
+    if(!failed && (!next || queueSend(el, next) == UA_STATUSCODE_GOOD))
+        return false;
+
+    /* Drop the remaining sends and signal the error */
+    freeSendChain(el, entry->sendFirst);
+    entry->sendFirst = NULL;
+    entry->sendLast = NULL;
+    UA_RegisteredFD *rfd = entry->rfd;
+    if(rfd->dc.callback)
+        return false;
+    rfd->eventSourceCB(rfd->es, rfd, UA_FDEVENT_ERR);
+    return true;
+}
+
+/* Cancel the sends whose deadline has passed. Returns the next deadline. */
+static UA_DateTime
+cancelOverdueSends(UA_EventLoopPOSIX *el, UA_DateTime now) {
+    UA_IoUring *ring = &el->ring;
+    UA_IoUringSend *req;
+    while((req = TAILQ_FIRST(&ring->inflight))) {
+        if(req->deadline > now)
+            return req->deadline;
+        removeInflight(ring, req);
+        queueCancel(el, sendUserData(req));
+    }
+    return UA_INT64_MAX;
+}
+
+/* Look for the successful completion of the send among the completions that
+ * have not been processed yet. Skip the notifications of zero-copy sends. */
+static UA_Boolean
+sendCompleted(UA_IoUring *ring, UA_IoUringSend *req) {
+    UA_UInt64 ud = sendUserData(req);
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    for(unsigned head = *ring->cqHead; head != tail; head++) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+        if(cqe->user_data == ud && !(cqe->flags & IORING_CQE_F_NOTIF))
+            return (cqe->res > 0 &&
+                    req->written + (size_t)cqe->res == req->buf.length);
+    }
+    return false;
+}
+
+/* Process the completion of a poll or recv request. Returns whether the
+ * EventSource was called. */
+static UA_Boolean
+processFD(UA_EventLoopPOSIX *el, UA_UInt64 ud, UA_Int32 res, UA_UInt32 flags) {
+    UA_IoUring *ring = &el->ring;
+    UA_Boolean hasBuffer = ((flags & IORING_CQE_F_BUFFER) != 0);
+    unsigned short bid = (unsigned short)(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    /* Outdated generation or deregistered in the meantime */
+    size_t fd = (size_t)((UA_UInt32)ud >> 2);
+    UA_UInt32 generation = (UA_UInt32)(ud >> 32);
+    UA_IoUringFD *entry = (fd < ring->fdsSize) ? &ring->fds[fd] : NULL;
+    UA_RegisteredFD *rfd = (entry) ? entry->rfd : NULL;
+    if(!rfd || entry->generation != generation || entry->armed != ud)
+        goto recycle;
+
+    /* A multishot recv remains armed as long as IORING_CQE_F_MORE is set */
+    if(!(flags & IORING_CQE_F_MORE))
+        entry->armed = 0;
+
+    /* The rfd is already registered for removal. Don't process incoming
+     * events any longer. */
+    if(rfd->dc.callback)
+        goto recycle;
+
+    /* The requests of a thread are canceled when the thread exits. Then the
+     * EventLoop is run from another thread. Re-arm the request. All buffers in
+     * use -> Poll for the readiness instead. The recv is re-armed after the
+     * EventSource has received the data. */
+    if(res == -ECANCELED || res == -EINTR || res == -EAGAIN) {
+        armFD(el, rfd, generation);
+        goto recycle;
+    }
+    if(res == -ENOBUFS) {
+        queuePollAdd(el, rfd, generation);
+        return false;
+    }
+
+    /* Multishot recv is not supported before Linux 6.0 */
+    if(res == -EINVAL && (ud & UA_IO_URING_OP_MASK) == UA_IO_URING_OP_RECV &&
+       !ring->noMultishot) {
+        ring->noMultishot = true;
+        armFD(el, rfd, generation);
+        goto recycle;
+    }
+
+    /* Call the EventSource callback */
+    if((ud & UA_IO_URING_OP_MASK) == UA_IO_URING_OP_RECV) {
+        if(res > 0 && hasBuffer) {
+            UA_ByteString msg;
+            msg.data = &ring->bufs[(size_t)bid * UA_IO_URING_BUFSIZE];
+            msg.length = (size_t)res;
+            rfd->recvCB(rfd->es, rfd, msg);
+        } else {
+            /* Closed (res == 0) or error */
+            rfd->eventSourceCB(rfd->es, rfd, UA_FDEVENT_ERR);
+        }
+    } else {
+        short revent = 0;
+        if(res < 0) {
+            revent = UA_FDEVENT_ERR;
+        } else if((res & POLLIN) == POLLIN) {
+            revent = UA_FDEVENT_IN;
+        } else if((res & POLLOUT) == POLLOUT) {
+            revent = UA_FDEVENT_OUT;
+        } else {
+            revent = UA_FDEVENT_ERR;
+        }
+        rfd->eventSourceCB(rfd->es, rfd, revent);
+    }
+
+    /* Re-arm a completed request if the registration is unchanged. The table
+     * might have been reallocated in the callback. */
+    entry = &ring->fds[fd];
+    if(entry->rfd == rfd && entry->generation == generation &&
+       !entry->armed && !rfd->dc.callback)
+        armFD(el, rfd, generation);
+    if(hasBuffer)
+        recycleBuffer(ring, bid);
+    return true;
+
+ recycle:
+    if(hasBuffer)
+        recycleBuffer(ring, bid);
+    return false;
+}
+
+/* Process the completions up to the current tail. Returns the number of
+ * completions. The calls into the EventSources are counted in events. */
+static size_t
+processCompletions(UA_EventLoopPOSIX *el, size_t *events) {
+    UA_IoUring *ring = &el->ring;
+    size_t completions = 0;
+    unsigned head = *ring->cqHead;
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    while(head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & ring->cqMask];
+        UA_UInt64 ud = cqe->user_data;
+        UA_Int32 res = cqe->res;
+        UA_UInt32 flags = cqe->flags;
+        head++;
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+        completions++;
+        if(!(flags & IORING_CQE_F_MORE))
+            ring->requests--;
+
+        switch(ud & UA_IO_URING_OP_MASK) {
+        case UA_IO_URING_OP_IGNORE:
+            break;
+        case UA_IO_URING_OP_SEND: {
+            /* A zero-copy send has a second completion (notification) once
+             * the kernel no longer reads from the buffer */
+            UA_IoUringSend *req = (UA_IoUringSend*)(uintptr_t)
+                (ud & ~(UA_UInt64)UA_IO_URING_OP_MASK);
+            if(flags & IORING_CQE_F_NOTIF) {
+                processSendNotif(el, req);
+                break;
+            }
+            if(flags & IORING_CQE_F_MORE)
+                req->notifs++;
+            *events += processSend(el, req, res);
+            break;
+        }
+        default:
+            if(ring->draining) {
+                if(flags & IORING_CQE_F_BUFFER)
+                    recycleBuffer(ring, (unsigned short)
+                                  (flags >> IORING_CQE_BUFFER_SHIFT));
+                break;
+            }
+            *events += processFD(el, ud, res, flags);
+            break;
+        }
+    }
+    return completions;
+}
+
+/* Cancel the remaining requests and wait until the kernel no longer accesses
+ * the buffers */
+static void
+drainRing(UA_EventLoopPOSIX *el) {
+    UA_IoUring *ring = &el->ring;
+    ring->draining = true;
+    UA_IoUringSend *req;
+    LIST_FOREACH(req, &ring->sends, pointers) {
+        queueCancel(el, sendUserData(req));
+    }
+    submit(el);
+
+    struct __kernel_timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 10 * 1000 * 1000;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(struct io_uring_getevents_arg));
+    arg.ts = (UA_UInt64)(uintptr_t)&ts;
+    for(size_t i = 0; i < 100 && ring->requests > 0; i++) {
+        io_uring_enter(ring->ringfd, 0, 1,
+                       IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                       &arg, sizeof(struct io_uring_getevents_arg));
+        size_t events = 0;
+        processCompletions(el, &events);
+    }
+
+    /* Free what was not completed. Close the duplicate fds at the end of the
+     * chains of orphaned sends. */
+    UA_IoUringSend *tmp;
+    LIST_FOREACH_SAFE(req, &ring->sends, pointers, tmp) {
+        if(req->orphaned && !req->next && req->fd != UA_INVALID_FD &&
+           !req->retired)
+            UA_close(req->fd);
+    }
+    while(!LIST_EMPTY(&ring->sends)) {
+        req = LIST_FIRST(&ring->sends);
+        req->notifs = 0;
+        freeSend(el, req);
+    }
+}
+
+/*****************/
+/* Setup / Clear */
+/*****************/
+
+UA_StatusCode
+UA_EventLoopPOSIX_initIoUring(UA_EventLoopPOSIX *el) {
+    UA_IoUring *ring = &el->ring;
+    memset(ring, 0, sizeof(UA_IoUring));
+    LIST_INIT(&ring->sends);
+    TAILQ_INIT(&ring->inflight);
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(struct io_uring_params));
+    /* No IORING_SETUP_COOP_TASKRUN. The completion work of a request runs in
+     * the thread that submitted it. Sends are also submitted from outside the
+     * EventLoop thread. That thread might not enter the ring again. */
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = UA_IO_URING_CQ_ENTRIES;
+    ring->ringfd = io_uring_setup(UA_IO_URING_SQ_ENTRIES, &p);
+    if(ring->ringfd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                        "io_uring\t| Could not set up the ring (%s)",
+                        errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Required for the wait with a timeout */
+    if(!(p.features & IORING_FEAT_EXT_ARG)) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                     "io_uring\t| The kernel does not support waiting "
+                     "with a timeout (Linux 5.11 or later required)");
+        close(ring->ringfd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Map the rings */
+    ring->sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        if(ring->cqRingSize > ring->sqRingSize)
+            ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->ringfd, IORING_OFF_SQ_RING);
+    if(ring->sqRing == MAP_FAILED)
+        goto mmap_error;
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cqRing = ring->sqRing;
+    } else {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->ringfd,
+                            IORING_OFF_CQ_RING);
+        if(ring->cqRing == MAP_FAILED)
+            goto mmap_error;
+    }
+    ring->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)
+        mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring->ringfd, IORING_OFF_SQES);
+    if(ring->sqes == MAP_FAILED)
+        goto mmap_error;
+
+    UA_Byte *sq = (UA_Byte*)ring->sqRing;
+    ring->sqHead = (unsigned*)(sq + p.sq_off.head);
+    ring->sqTail = (unsigned*)(sq + p.sq_off.tail);
+    ring->sqMask = *(unsigned*)(sq + p.sq_off.ring_mask);
+    ring->sqEntries = p.sq_entries;
+    ring->sqTailLocal = *ring->sqTail;
+
+    /* Every slot of the submission queue uses the sqe with the same index */
+    unsigned *sqArray = (unsigned*)(sq + p.sq_off.array);
+    for(unsigned i = 0; i < p.sq_entries; i++)
+        sqArray[i] = i;
+
+    UA_Byte *cq = (UA_Byte*)ring->cqRing;
+    ring->cqHead = (unsigned*)(cq + p.cq_off.head);
+    ring->cqTail = (unsigned*)(cq + p.cq_off.tail);
+    ring->cqMask = *(unsigned*)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+    setupBuffers(el);
+    setupSendBuffers(el);
+    return UA_STATUSCODE_GOOD;
+
+ mmap_error:
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                    "io_uring\t| Could not map the rings (%s)", errno_str));
+    UA_EventLoopPOSIX_clearIoUring(el);
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
+
+void
+UA_EventLoopPOSIX_clearIoUring(UA_EventLoopPOSIX *el) {
+    UA_IoUring *ring = &el->ring;
+    if(ring->sqes && ring->sqes != MAP_FAILED && ring->cqes)
+        drainRing(el);
+    if(ring->sqes && ring->sqes != MAP_FAILED)
+        munmap(ring->sqes, ring->sqesSize);
+    if(ring->cqRing && ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if(ring->sqRing && ring->sqRing != MAP_FAILED)
+        munmap(ring->sqRing, ring->sqRingSize);
+    close(ring->ringfd);
+    if(ring->bufRing)
+        munmap(ring->bufRing, ring->bufRingSize);
+    UA_free(ring->bufs);
+    UA_free(ring->fds);
+    memset(ring, 0, sizeof(UA_IoUring));
+    ring->ringfd = UA_INVALID_FD;
+}
+
+/*******************/
+/* FD Registration */
+/*******************/
+
+UA_StatusCode
+UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_IoUring *ring = &el->ring;
+    if(rfd->fd < 0 || rfd->fd >= (1 << 30)) /* Must fit into the user_data */
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Grow the lookup table */
+    size_t fd = (size_t)rfd->fd;
+    if(fd >= ring->fdsSize) {
+        size_t newSize = (ring->fdsSize > 0) ? ring->fdsSize : 64;
+        while(newSize <= fd)
+            newSize *= 2;
+        UA_IoUringFD *fds = (UA_IoUringFD*)
+            UA_realloc(ring->fds, newSize * sizeof(UA_IoUringFD));
+        if(!fds)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        memset(&fds[ring->fdsSize], 0,
+               (newSize - ring->fdsSize) * sizeof(UA_IoUringFD));
+        ring->fds = fds;
+        ring->fdsSize = newSize;
+    }
+
+    UA_IoUringFD *entry = &ring->fds[fd];
+    entry->rfd = rfd;
+    entry->generation++;
+    UA_StatusCode res = armFD(el, rfd, entry->generation);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "io_uring %u\t| Could not register the fd",
+                       (unsigned)rfd->fd);
+        entry->rfd = NULL;
+    }
+    return res;
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_modifyFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_IoUring *ring = &el->ring;
+    size_t fd = (size_t)rfd->fd;
+    if(fd >= ring->fdsSize || ring->fds[fd].rfd != rfd)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Replace the pending request */
+    UA_IoUringFD *entry = &ring->fds[fd];
+    if(entry->armed)
+        queueCancel(el, entry->armed);
+    entry->armed = 0;
+    entry->generation++;
+    UA_StatusCode res = armFD(el, rfd, entry->generation);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "io_uring %u\t| Could not modify the fd",
+                       (unsigned)rfd->fd);
+    }
+    return res;
+}
+
+void
+UA_EventLoopPOSIX_deregisterFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
+    UA_IoUring *ring = &el->ring;
+    size_t fd = (size_t)rfd->fd;
+    if(fd >= ring->fdsSize || ring->fds[fd].rfd != rfd) {
+        UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                       "io_uring %u\t| Could not deregister the fd",
+                       (unsigned)rfd->fd);
+        return;
+    }
+
+    UA_IoUringFD *entry = &ring->fds[fd];
+    if(entry->armed)
+        queueCancel(el, entry->armed);
+    entry->armed = 0;
+
+    /* The queued sends are still completed after the fd is closed. They take
+     * over a duplicate of the fd. */
+    if(entry->sendFirst) {
+        UA_FD dupfd = dup(rfd->fd);
+        if(dupfd < 0) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                              "io_uring %u\t| Dropping the queued sends (%s)",
+                              (unsigned)rfd->fd, errno_str));
+            dupfd = UA_INVALID_FD;
+            queueCancel(el, sendUserData(entry->sendFirst));
+            freeSendChain(el, entry->sendFirst->next);
+            entry->sendFirst->next = NULL;
+        }
+        for(UA_IoUringSend *req = entry->sendFirst; req; req = req->next) {
+            req->orphaned = true;
+            req->fd = dupfd;
+        }
+        entry->sendFirst = NULL;
+        entry->sendLast = NULL;
+    }
+
+    entry->rfd = NULL;
+    entry->generation++;
+
+    /* The fd is closed after this. Submit the queued requests that still
+     * refer to the fd number right away. */
+    submit(el);
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_sendFD(UA_EventLoopPOSIX *el, UA_FD fd, UA_ByteString *buf) {
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+    UA_IoUring *ring = &el->ring;
+
+    /* Not registered or already closing. The sends that were queued before
+     * the connection started to close are still completed. */
+    if(fd < 0 || (size_t)fd >= ring->fdsSize || !ring->fds[fd].rfd ||
+       ring->fds[fd].rfd->dc.callback) {
+        UA_EventLoopPOSIX_freeSendBuffer(el, buf);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+
+    UA_IoUringSend *req = (UA_IoUringSend*)UA_calloc(1, sizeof(UA_IoUringSend));
+    if(!req) {
+        UA_EventLoopPOSIX_freeSendBuffer(el, buf);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    req->fd = fd;
+    req->buf = *buf;
+    UA_ByteString_init(buf);
+    LIST_INSERT_HEAD(&ring->sends, req, pointers);
+
+    /* Wait for the completion of the previous send. Unless its completion is
+     * already in the queue. Otherwise the send is delayed until the EventLoop
+     * runs the next time. */
+    UA_IoUringFD *entry = &ring->fds[fd];
+    if(entry->sendFirst && !entry->sendFirst->next &&
+       sendCompleted(ring, entry->sendFirst)) {
+        entry->sendFirst->completed = true;
+        entry->sendFirst = NULL;
+        entry->sendLast = NULL;
+    }
+    if(entry->sendLast) {
+        entry->sendLast->next = req;
+        entry->sendLast = req;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    entry->sendFirst = req;
+    entry->sendLast = req;
+    UA_StatusCode res = queueSend(el, req);
+    if(res != UA_STATUSCODE_GOOD) {
+        entry->sendFirst = NULL;
+        entry->sendLast = NULL;
+        freeSend(el, req);
+    }
+    return res;
+}
+
+UA_StatusCode
+UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
+    UA_assert(listenTimeout >= 0);
+    UA_IoUring *ring = &el->ring;
+    UA_DateTime maxDate =
+        el->eventLoop.dateTime_nowMonotonic(&el->eventLoop) + listenTimeout;
+
+    /* The completions of sends and cancellations are processed internally.
+     * Wait again if there was no event for the EventSources. The kernel does
+     * not look for more completions (e.g. of recv) if enough are already
+     * available. So always look again after internal completions. */
+    size_t events = 0;
+    size_t completions = 0;
+    do {
+        /* Wake up for the next deadline of a send */
+        UA_DateTime now = el->eventLoop.dateTime_nowMonotonic(&el->eventLoop);
+        UA_DateTime nextDeadline = cancelOverdueSends(el, now);
+        if(nextDeadline - now < listenTimeout)
+            listenTimeout = nextDeadline - now;
+
+        /* Submit the queued requests and wait for the first completion */
+        struct __kernel_timespec ts;
+        ts.tv_sec = listenTimeout / UA_DATETIME_SEC;
+        ts.tv_nsec = (listenTimeout % UA_DATETIME_SEC) * 100;
+        struct io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(struct io_uring_getevents_arg));
+        arg.ts = (UA_UInt64)(uintptr_t)&ts;
+        publishSQEs(ring);
+        unsigned pending = pendingSubmissions(ring);
+        UA_FD ringfd = ring->ringfd;
+        UA_UNLOCK(&el->elMutex);
+        int res = io_uring_enter(ringfd, pending, 1,
+                                 IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                 &arg, sizeof(struct io_uring_getevents_arg));
+        int err = errno;
+        UA_LOCK(&el->elMutex);
+
+        /* Handle error conditions. The timeout (ETIME) is reported as an
+         * error when there are no completions. */
+        if(res < 0 && err != ETIME && err != EINTR &&
+           err != EBUSY && err != EAGAIN) {
+            errno = err;
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                              "io_uring\t| Waiting for completions failed (%s)",
+                              errno_str));
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+
+        /* Process the completions up to the current tail. Completions that
+         * arrive in the meantime are processed in the next iteration. The
+         * re-arm requests are collected in the submission queue until the next
+         * wait. */
+        ring->dispatching = true;
+        ring->sendQueued = false;
+        completions = processCompletions(el, &events);
+        ring->dispatching = false;
+
+        /* Don't hold back the sends until the next wait. Submit them (together
+         * with the re-arm requests) in a batch after the dispatch. */
+        if(ring->sendQueued)
+            submit(el);
+
+        if(res < 0 && err == ETIME)
+            break;
+        listenTimeout = maxDate - el->eventLoop.dateTime_nowMonotonic(&el->eventLoop);
+        if(listenTimeout < 0)
+            listenTimeout = 0;
+    } while(events == 0 && (listenTimeout > 0 || completions > 0));
+
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* defined(UA_HAVE_IO_URING) */
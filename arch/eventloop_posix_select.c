@@ -7,7 +7,7 @@
 
 #include "eventloop_posix.h"
 
-#if !defined(UA_HAVE_EPOLL)
+#if !defined(UA_HAVE_EPOLL) && !defined(UA_HAVE_IO_URING)
 
 UA_StatusCode
 UA_EventLoopPOSIX_registerFD(UA_EventLoopPOSIX *el, UA_RegisteredFD *rfd) {
@@ -170,4 +170,4 @@ UA_EventLoopPOSIX_pollFDs(UA_EventLoopPOSIX *el, UA_DateTime listenTimeout) {
     return UA_STATUSCODE_GOOD;
 }
 
-#endif /* !defined(UA_HAVE_EPOLL) */
+#endif /* !defined(UA_HAVE_EPOLL) && !defined(UA_HAVE_IO_URING) */
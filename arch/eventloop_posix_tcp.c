@@ -228,6 +228,28 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
     UA_LOCK(&el->elMutex);
 }
 
+#if defined(UA_HAVE_IO_URING)
+/* Gets called with the data that io_uring has received for the connection */
+static void
+TCP_connectionRecvCallback(UA_ConnectionManager *cm, TCP_FD *conn,
+                           UA_ByteString msg) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "TCP %u\t| Received message of size %u",
+                 (unsigned)conn->rfd.fd, (unsigned)msg.length);
+
+    /* Callback to the application layer */
+    UA_UNLOCK(&el->elMutex);
+    conn->applicationCB(cm, (uintptr_t)conn->rfd.fd,
+                        conn->application, &conn->context,
+                        UA_CONNECTIONSTATE_ESTABLISHED,
+                        &UA_KEYVALUEMAP_NULL, msg);
+    UA_LOCK(&el->elMutex);
+}
+#endif
+
 /* Gets called when a new connection opens or if the listenSocket is closed */
 static void
 TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
@@ -304,6 +326,9 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
     newConn->rfd.listenEvents = UA_FDEVENT_IN;
     newConn->rfd.es = &cm->eventSource;
     newConn->rfd.eventSourceCB = (UA_FDCallback)TCP_connectionSocketCallback;
+#if defined(UA_HAVE_IO_URING)
+    newConn->rfd.recvCB = (UA_FDRecvCallback)TCP_connectionRecvCallback;
+#endif
     newConn->applicationCB = conn->applicationCB;
     newConn->application = conn->application;
     newConn->context = conn->context;
@@ -584,7 +609,13 @@ TCP_shutdown(UA_ConnectionManager *cm, TCP_FD *conn) {
     }
 
     /* Shutdown the socket to cancel the current select/epoll */
+#if defined(UA_HAVE_IO_URING)
+    /* Sends can still be queued in io_uring. They are completed before the
+     * socket is closed. So only shut down the receiving side. */
+    shutdown(conn->rfd.fd, SHUT_RD);
+#else
     shutdown(conn->rfd.fd, UA_SHUT_RDWR);
+#endif
 
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "TCP %u\t| Shutdown triggered",
@@ -624,9 +655,48 @@ TCP_shutdownConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
     return UA_STATUSCODE_GOOD;
 }
 
+#if defined(UA_HAVE_IO_URING)
+/* The buffer is used until the send completes in the ring. So the static send
+ * buffer cannot be used. Take the buffers from the pool of the EventLoop. They
+ * are passed to the ring without a copy. */
+static UA_StatusCode
+TCP_allocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                       UA_ByteString *buf, size_t bufSize) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    if(!el)
+        return UA_ByteString_allocBuffer(buf, bufSize);
+    UA_LOCK(&el->elMutex);
+    UA_StatusCode res = UA_EventLoopPOSIX_allocSendBuffer(el, buf, bufSize);
+    UA_UNLOCK(&el->elMutex);
+    return res;
+}
+
+static void
+TCP_freeNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                      UA_ByteString *buf) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    if(!el) {
+        UA_ByteString_clear(buf);
+        return;
+    }
+    UA_LOCK(&el->elMutex);
+    UA_EventLoopPOSIX_freeSendBuffer(el, buf);
+    UA_UNLOCK(&el->elMutex);
+}
+#endif
+
 static UA_StatusCode
 TCP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params, UA_ByteString *buf) {
+#if defined(UA_HAVE_IO_URING)
+    /* Queue the send in the ring of the EventLoop. This takes the EventLoop
+     * lock. The buffer is taken over until the send completes. */
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK(&el->elMutex);
+    UA_StatusCode res = UA_EventLoopPOSIX_sendFD(el, (UA_FD)connectionId, buf);
+    UA_UNLOCK(&el->elMutex);
+    return res;
+#else
     /* Don't have a lock and don't take a lock. As the connectionId is the fd,
      * no need to to a lookup and access internal data strucures. */
     UA_LOCK_ASSERT(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex, 0);
@@ -681,7 +751,34 @@ TCP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
     TCP_shutdownConnection(cm, connectionId);
     UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
     return UA_STATUSCODE_BADCONNECTIONCLOSED;
+#endif
+}
+
+#if defined(UA_HAVE_REACTORS)
+/* Open the listen-sockets in every reactor instead. With SO_REUSEPORT the
+ * kernel distributes the incoming connections between the reactors. Succeeds
+ * if at least one reactor listens. */
+static UA_StatusCode
+TCP_openReactorConnections(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *params,
+                           void *application, void *context,
+                           UA_ConnectionManager_connectionCallback connectionCallback) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                "TCP\t| Listening in %u reactors", (unsigned)el->reactorsSize);
+
+    UA_StatusCode total_result = UA_INT32_MAX;
+    for(size_t i = 0; i < el->reactorsSize; i++) {
+        UA_ConnectionManager *rcm = el->reactors[i].tcp;
+        UA_UNLOCK(&el->elMutex);
+        total_result &= rcm->openConnection(rcm, params, application,
+                                            context, connectionCallback);
+        UA_LOCK(&el->elMutex);
+    }
+    return total_result;
 }
+#endif
 
 /* Create a listen-socket that waits for incoming connections */
 static UA_StatusCode
@@ -692,6 +789,12 @@ TCP_openPassiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
     UA_LOCK_ASSERT(&el->elMutex, 1);
 
+#if defined(UA_HAVE_REACTORS)
+    if(el->reactorsSize > 0 && !validate)
+        return TCP_openReactorConnections(pcm, params, application,
+                                          context, connectionCallback);
+#endif
+
     /* Get the port parameter */
     const UA_UInt16 *port = (const UA_UInt16*)
         UA_KeyValueMap_getScalar(params, tcpConnectionParams[TCP_PARAMINDEX_PORT].name,
@@ -853,6 +956,9 @@ TCP_openActiveConnection(UA_POSIXConnectionManager *pcm, const UA_KeyValueMap *p
     newConn->rfd.fd = newSock;
     newConn->rfd.es = &pcm->cm.eventSource;
     newConn->rfd.eventSourceCB = (UA_FDCallback)TCP_connectionSocketCallback;
+#if defined(UA_HAVE_IO_URING)
+    newConn->rfd.recvCB = (UA_FDRecvCallback)TCP_connectionRecvCallback;
+#endif
     newConn->rfd.listenEvents = UA_FDEVENT_OUT; /* Switched to _IN once the
                                                  * connection is open */
     newConn->applicationCB = connectionCallback;
@@ -1047,8 +1153,13 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName) {
     cm->cm.eventSource.free = (UA_StatusCode (*)(UA_EventSource *))TCP_eventSourceDelete;
     cm->cm.protocol = UA_STRING((char*)(uintptr_t)tcpName);
     cm->cm.openConnection = TCP_openConnection;
+#if defined(UA_HAVE_IO_URING)
+    cm->cm.allocNetworkBuffer = TCP_allocNetworkBuffer;
+    cm->cm.freeNetworkBuffer = TCP_freeNetworkBuffer;
+#else
     cm->cm.allocNetworkBuffer = UA_EventLoopPOSIX_allocNetworkBuffer;
     cm->cm.freeNetworkBuffer = UA_EventLoopPOSIX_freeNetworkBuffer;
+#endif
     cm->cm.sendWithConnection = TCP_sendWithConnection;
     cm->cm.closeConnection = TCP_shutdownConnection;
     return &cm->cm;
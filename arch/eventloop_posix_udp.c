@@ -18,11 +18,15 @@
 
 /* Configuration parameters */
 
-#define UDP_MANAGERPARAMS 2
+#define UDP_MANAGERPARAMS 4
+#define UDP_MANAGERPARAMINDEX_RECVBATCHSIZE 2
+#define UDP_MANAGERPARAMINDEX_SENDBATCHSIZE 3
 
 static UA_KeyValueRestriction udpManagerParams[UDP_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("recv-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
-    {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
+    {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("recv-batchsize")}, &UA_TYPES[UA_TYPES_UINT16], false, true, false},
+    {{0, UA_STRING_STATIC("send-batchsize")}, &UA_TYPES[UA_TYPES_UINT16], false, true, false}
 };
 
 #define UDP_PARAMETERSSIZE 9
@@ -48,6 +52,54 @@ static UA_KeyValueRestriction udpConnectionParams[UDP_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false}
 };
 
+/* Batched receive and send with a single syscall for several datagrams. struct
+ * mmsghdr and the libc wrappers are only declared with _GNU_SOURCE. So the
+ * syscalls are used directly with the same struct layout. */
+#if defined(__linux__)
+# include <sys/syscall.h>
+# if defined(__NR_recvmmsg) && defined(__NR_sendmmsg)
+#  define UA_HAVE_MMSG
+# endif
+#endif
+
+#ifdef UA_HAVE_MMSG
+typedef struct {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+} UDP_mmsghdr;
+
+static int
+UDP_recvmmsg(UA_FD fd, UDP_mmsghdr *msgs, unsigned int vlen, int flags) {
+    return (int)syscall(__NR_recvmmsg, fd, msgs, vlen, flags, NULL);
+}
+
+static int
+UDP_sendmmsg(UA_FD fd, UDP_mmsghdr *msgs, unsigned int vlen, int flags) {
+    return (int)syscall(__NR_sendmmsg, fd, msgs, vlen, flags);
+}
+
+/* Message headers for a batch of datagrams */
+typedef struct {
+    UDP_mmsghdr *msgs;
+    struct iovec *iovs;
+    struct sockaddr_storage *addrs; /* Source addresses when receiving */
+    size_t size;
+} UDP_Batch;
+#endif
+
+typedef struct {
+    UA_POSIXConnectionManager pcm;
+
+    /* Number of datagrams per recvmmsg/sendmmsg. The rx buffer is split into
+     * recvBatchSize slots. */
+    UA_UInt16 recvBatchSize;
+    UA_UInt16 sendBatchSize;
+#ifdef UA_HAVE_MMSG
+    UDP_Batch rxBatch;
+    UDP_Batch txBatch;
+#endif
+} UDP_ConnectionManager;
+
 /* A registered file descriptor with an additional method pointer */
 typedef struct {
     UA_RegisteredFD rfd;
@@ -62,6 +114,11 @@ typedef struct {
 #else
     socklen_t sendAddrLength;
 #endif
+
+    /* Messages sent with the "more" parameter wait here for a batched send.
+     * Allocated with sendBatchSize entries on first use. */
+    UA_ByteString *sendQueue;
+    size_t sendQueueSize;
 } UDP_FD;
 
 typedef union {
@@ -529,6 +586,11 @@ UDP_close(UA_POSIXConnectionManager *pcm, UDP_FD *conn) {
                           (unsigned)conn->rfd.fd, errno_str));
     }
 
+    /* Drop the messages that still wait for a batched send */
+    for(size_t i = 0; i < conn->sendQueueSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(&pcm->cm, (uintptr_t)conn->rfd.fd,
+                                            &conn->sendQueue[i]);
+    UA_free(conn->sendQueue);
     UA_free(conn);
 
     /* Stop if the ucm is stopping and this was the last open socket */
@@ -548,6 +610,118 @@ UDP_delayedClose(void *application, void *context) {
     UA_UNLOCK(&el->elMutex);
 }
 
+/* Forward a received message to the application */
+static void
+UDP_deliverMessage(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
+                   const struct sockaddr_storage *source,
+                   const UA_ByteString msg) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    /* Extract message source and port */
+    char sourceAddr[64];
+    UA_UInt16 sourcePort;
+    switch(source->ss_family) {
+        case AF_INET:
+            inet_ntop(AF_INET, &((const struct sockaddr_in *)source)->sin_addr,
+                    sourceAddr, 64);
+            sourcePort = htons(((const struct sockaddr_in *)source)->sin_port);
+            break;
+        case AF_INET6:
+            inet_ntop(AF_INET6, &(((const struct sockaddr_in6 *)source)->sin6_addr),
+                    sourceAddr, 64);
+            sourcePort = htons(((const struct sockaddr_in6 *)source)->sin6_port);
+            break;
+        default:
+            sourceAddr[0] = 0;
+            sourcePort = 0;
+    }
+
+    UA_String sourceAddrStr = UA_STRING(sourceAddr);
+    UA_KeyValuePair kvp[2];
+    kvp[0].key = UA_QUALIFIEDNAME(0, "remote-address");
+    UA_Variant_setScalar(&kvp[0].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+    kvp[1].key = UA_QUALIFIEDNAME(0, "remote-port");
+    UA_Variant_setScalar(&kvp[1].value, &sourcePort, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_KeyValueMap kvm = {2, kvp};
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "UDP %u\t| Received message of size %u from %s on port %u",
+                 (unsigned)conn->rfd.fd, (unsigned)msg.length,
+                 sourceAddr, sourcePort);
+
+    /* Callback to the application layer */
+    UA_UNLOCK(&el->elMutex);
+    conn->applicationCB(&pcm->cm, (uintptr_t)conn->rfd.fd,
+                        conn->application, &conn->context,
+                        UA_CONNECTIONSTATE_ESTABLISHED,
+                        &kvm, msg);
+    UA_LOCK(&el->elMutex);
+}
+
+#ifdef UA_HAVE_MMSG
+/* Receive up to recvBatchSize datagrams with a single syscall. Every datagram
+ * gets its own slot in the rx buffer. All received messages are forwarded to
+ * the application before the next poll. */
+static void
+UDP_receiveBatch(UDP_ConnectionManager *ucm, UDP_FD *conn) {
+    UA_POSIXConnectionManager *pcm = &ucm->pcm;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UDP_Batch *batch = &ucm->rxBatch;
+
+    size_t slotSize = pcm->rxBuffer.length / batch->size;
+    for(size_t i = 0; i < batch->size; i++) {
+        batch->iovs[i].iov_base = pcm->rxBuffer.data + (i * slotSize);
+        batch->iovs[i].iov_len = slotSize;
+        memset(&batch->msgs[i], 0, sizeof(UDP_mmsghdr));
+        batch->msgs[i].msg_hdr.msg_iov = &batch->iovs[i];
+        batch->msgs[i].msg_hdr.msg_iovlen = 1;
+        batch->msgs[i].msg_hdr.msg_name = &batch->addrs[i];
+        batch->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    int ret = UDP_recvmmsg(conn->rfd.fd, batch->msgs,
+                           (unsigned int)batch->size, MSG_DONTWAIT);
+    if(ret == 0)
+        return; /* No datagram received, errno is not set */
+    if(ret < 0) {
+        if(UA_ERRNO == UA_INTERRUPTED || UA_ERRNO == UA_AGAIN)
+            return;
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "UDP %u\t| recv signaled the socket was shutdown (%s)",
+                        (unsigned)conn->rfd.fd, errno_str));
+        UDP_close(pcm, conn);
+        return;
+    }
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "UDP %u\t| Received a batch of %u messages",
+                 (unsigned)conn->rfd.fd, (unsigned)ret);
+
+    for(int i = 0; i < ret; i++) {
+        /* The datagram did not fit into the rx buffer slot */
+        if(batch->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "UDP %u\t| Dropping a truncated message. The "
+                           "recv-bufsize of %u bytes is too small",
+                           (unsigned)conn->rfd.fd, (unsigned)slotSize);
+            continue;
+        }
+
+        UA_ByteString msg;
+        msg.data = (UA_Byte*)batch->iovs[i].iov_base;
+        msg.length = batch->msgs[i].msg_len;
+        UDP_deliverMessage(pcm, conn, &batch->addrs[i], msg);
+
+        /* The connection was closed from the callback. Drop the remaining
+         * messages. */
+        if(conn->rfd.dc.callback)
+            break;
+    }
+}
+#endif
+
 /* Gets called when a socket receives data or closes */
 static void
 UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
@@ -568,6 +742,14 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
         return;
     }
 
+#ifdef UA_HAVE_MMSG
+    UDP_ConnectionManager *ucm = (UDP_ConnectionManager*)pcm;
+    if(ucm->recvBatchSize > 1) {
+        UDP_receiveBatch(ucm, conn);
+        return;
+    }
+#endif
+
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "UDP %u\t| Allocate receive buffer", (unsigned)conn->rfd.fd);
 
@@ -603,46 +785,7 @@ UDP_connectionSocketCallback(UA_POSIXConnectionManager *pcm, UDP_FD *conn,
     }
 
     response.length = (size_t)ret; /* Set the length of the received buffer */
-
-    /* Extract message source and port */
-    char sourceAddr[64];
-    UA_UInt16 sourcePort;
-    switch(source.ss_family) {
-        case AF_INET:
-            inet_ntop(AF_INET, &((struct sockaddr_in *)&source)->sin_addr,
-                    sourceAddr, 64);
-            sourcePort = htons(((struct sockaddr_in *)&source)->sin_port);
-            break;
-        case AF_INET6:
-            inet_ntop(AF_INET6, &(((struct sockaddr_in6 *)&source)->sin6_addr),
-                    sourceAddr, 64);
-            sourcePort = htons(((struct sockaddr_in6 *)&source)->sin6_port);
-            break;
-        default:
-            sourceAddr[0] = 0;
-            sourcePort = 0;
-    }
-
-    UA_String sourceAddrStr = UA_STRING(sourceAddr);
-    UA_KeyValuePair kvp[2];
-    kvp[0].key = UA_QUALIFIEDNAME(0, "remote-address");
-    UA_Variant_setScalar(&kvp[0].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-    kvp[1].key = UA_QUALIFIEDNAME(0, "remote-port");
-    UA_Variant_setScalar(&kvp[1].value, &sourcePort, &UA_TYPES[UA_TYPES_UINT16]);
-    UA_KeyValueMap kvm = {2, kvp};
-
-    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                 "UDP %u\t| Received message of size %u from %s on port %u",
-                 (unsigned)conn->rfd.fd, (unsigned)ret,
-                 sourceAddr, sourcePort);
-
-    /* Callback to the application layer */
-    UA_UNLOCK(&el->elMutex);
-    conn->applicationCB(&pcm->cm, (uintptr_t)conn->rfd.fd,
-                        conn->application, &conn->context,
-                        UA_CONNECTIONSTATE_ESTABLISHED,
-                        &kvm, response);
-    UA_LOCK(&el->elMutex);
+    UDP_deliverMessage(pcm, conn, &source, response);
 }
 
 static UA_StatusCode
@@ -890,12 +1033,105 @@ UDP_shutdownConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Send the messages in order. More than one message is sent with sendmmsg if
+ * available. Retry (blocking) when the socket resources are exhausted. */
+static UA_StatusCode
+UDP_sendMessages(UDP_ConnectionManager *ucm, UDP_FD *conn,
+                 const UA_ByteString *bufs, size_t bufsSize) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)ucm->pcm.cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    size_t sent = 0;
+    while(sent < bufsSize) {
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "UDP %u\t| Attempting to send", (unsigned)conn->rfd.fd);
+
+        /* Prevent OS signals when sending to a closed socket */
+        int flags = MSG_NOSIGNAL;
+#ifdef UA_HAVE_MMSG
+        size_t batchSize = bufsSize - sent;
+        if(batchSize > 1) {
+            UDP_Batch *batch = &ucm->txBatch;
+            UA_assert(batchSize <= batch->size);
+            for(size_t i = 0; i < batchSize; i++) {
+                batch->iovs[i].iov_base = bufs[sent + i].data;
+                batch->iovs[i].iov_len = bufs[sent + i].length;
+                memset(&batch->msgs[i], 0, sizeof(UDP_mmsghdr));
+                batch->msgs[i].msg_hdr.msg_iov = &batch->iovs[i];
+                batch->msgs[i].msg_hdr.msg_iovlen = 1;
+                batch->msgs[i].msg_hdr.msg_name = &conn->sendAddr;
+                batch->msgs[i].msg_hdr.msg_namelen = conn->sendAddrLength;
+            }
+            int n = UDP_sendmmsg(conn->rfd.fd, batch->msgs,
+                                 (unsigned int)batchSize, flags);
+            if(n > 0) {
+                sent += (size_t)n; /* Can be a partial batch */
+                continue;
+            }
+        } else
+#endif
+        {
+            ssize_t n = UA_sendto(conn->rfd.fd, (const char*)bufs[sent].data,
+                                  bufs[sent].length, flags,
+                                  (struct sockaddr*)&conn->sendAddr,
+                                  conn->sendAddrLength);
+            if(n >= 0) {
+                sent++;
+                continue;
+            }
+        }
+
+        /* An error we cannot recover from? */
+        if(UA_ERRNO != UA_INTERRUPTED &&
+           UA_ERRNO != UA_WOULDBLOCK &&
+           UA_ERRNO != UA_AGAIN) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                            "UDP %u\t| Send failed with error %s",
+                            (unsigned)conn->rfd.fd, errno_str));
+            return UA_STATUSCODE_BADCONNECTIONCLOSED;
+        }
+
+        /* Poll for the socket resources to become available and retry
+         * (blocking) */
+        int poll_ret;
+        struct pollfd tmp_poll_fd;
+        tmp_poll_fd.fd = conn->rfd.fd;
+        tmp_poll_fd.events = UA_POLLOUT;
+        do {
+            poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
+            if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED) {
+                UA_LOG_SOCKET_ERRNO_WRAP(
+                   UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                                "UDP %u\t| Send failed with error %s",
+                                (unsigned)conn->rfd.fd, errno_str));
+                return UA_STATUSCODE_BADCONNECTIONCLOSED;
+            }
+        } while(poll_ret <= 0);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Send and release the messages waiting for a batched send */
+static UA_StatusCode
+UDP_flushSendQueue(UDP_ConnectionManager *ucm, UDP_FD *conn) {
+    UA_StatusCode res =
+        UDP_sendMessages(ucm, conn, conn->sendQueue, conn->sendQueueSize);
+    for(size_t i = 0; i < conn->sendQueueSize; i++)
+        UA_EventLoopPOSIX_freeNetworkBuffer(&ucm->pcm.cm, (uintptr_t)conn->rfd.fd,
+                                            &conn->sendQueue[i]);
+    conn->sendQueueSize = 0;
+    return res;
+}
+
 static UA_StatusCode
 UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                        const UA_KeyValueMap *params,
                        UA_ByteString *buf) {
-    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UDP_ConnectionManager *ucm = (UDP_ConnectionManager*)cm;
+    UA_POSIXConnectionManager *pcm = &ucm->pcm;
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    (void)el;
 
     UA_LOCK(&el->elMutex);
 
@@ -908,64 +1144,61 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    /* Send the full buffer. This may require several calls to send */
-    size_t nWritten = 0;
-    do {
-        ssize_t n = 0;
-        do {
-            UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                         "UDP %u\t| Attempting to send", (unsigned)connectionId);
-
-            /* Prevent OS signals when sending to a closed socket */
-            int flags = MSG_NOSIGNAL;
-            size_t bytes_to_send = buf->length - nWritten;
-            n = UA_sendto((UA_FD)connectionId, (const char*)buf->data + nWritten,
-                          bytes_to_send, flags, (struct sockaddr*)&conn->sendAddr,
-                          conn->sendAddrLength);
-            if(n < 0) {
-                /* An error we cannot recover from? */
-                if(UA_ERRNO != UA_INTERRUPTED &&
-                   UA_ERRNO != UA_WOULDBLOCK &&
-                   UA_ERRNO != UA_AGAIN) {
-                    UA_LOG_SOCKET_ERRNO_WRAP(
-                       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                                    "UDP %u\t| Send failed with error %s",
-                                    (unsigned)connectionId, errno_str));
-                    UA_UNLOCK(&el->elMutex);
-                    UDP_shutdownConnection(cm, connectionId);
-                    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
-                    return UA_STATUSCODE_BADCONNECTIONCLOSED;
-                }
-
-                /* Poll for the socket resources to become available and retry
-                 * (blocking) */
-                int poll_ret;
-                struct pollfd tmp_poll_fd;
-                tmp_poll_fd.fd = (UA_FD)connectionId;
-                tmp_poll_fd.events = UA_POLLOUT;
-                do {
-                    poll_ret = UA_poll(&tmp_poll_fd, 1, 100);
-                    if(poll_ret < 0 && UA_ERRNO != UA_INTERRUPTED) {
-                        UA_LOG_SOCKET_ERRNO_WRAP(
-                           UA_LOG_ERROR(el->eventLoop.logger,
-                                        UA_LOGCATEGORY_NETWORK,
-                                        "UDP %u\t| Send failed with error %s",
-                                        (unsigned)connectionId, errno_str));
-                        UDP_shutdownConnection(cm, connectionId);
-                        UA_UNLOCK(&el->elMutex);
-                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
-                        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-                    }
-                } while(poll_ret <= 0);
+    const UA_Boolean *more = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "more"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    const UA_Boolean *flush = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "flush"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    /* Only send out the queued messages. The buffer is not sent. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(flush && *flush) {
+        if(conn->sendQueueSize > 0)
+            res = UDP_flushSendQueue(ucm, conn);
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        UA_UNLOCK(&el->elMutex);
+        if(res != UA_STATUSCODE_GOOD)
+            UDP_shutdownConnection(cm, connectionId);
+        return res;
+    }
+
+    /* Queue the message for a batched send. The statically allocated send
+     * buffer is reused for the next message and cannot wait in the queue. */
+    if(ucm->sendBatchSize > 1 && buf->data != pcm->txBuffer.data &&
+       ((more && *more) || conn->sendQueueSize > 0)) {
+        if(!conn->sendQueue) {
+            conn->sendQueue = (UA_ByteString*)
+                UA_calloc(ucm->sendBatchSize, sizeof(UA_ByteString));
+            if(!conn->sendQueue) {
+                UA_UNLOCK(&el->elMutex);
+                UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                return UA_STATUSCODE_BADOUTOFMEMORY;
             }
-        } while(n < 0);
-        nWritten += (size_t)n;
-    } while(nWritten < buf->length);
+        }
+        conn->sendQueue[conn->sendQueueSize++] = *buf;
+        UA_ByteString_init(buf);
+
+        /* Send once the last message of the batch is added or the queue is
+         * full */
+        if(more && *more && conn->sendQueueSize < ucm->sendBatchSize) {
+            UA_UNLOCK(&el->elMutex);
+            return UA_STATUSCODE_GOOD;
+        }
+        res = UDP_flushSendQueue(ucm, conn);
+    } else {
+        /* Send the queued messages first to keep the order */
+        if(conn->sendQueueSize > 0)
+            res = UDP_flushSendQueue(ucm, conn);
+        if(res == UA_STATUSCODE_GOOD)
+            res = UDP_sendMessages(ucm, conn, buf, 1);
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    }
 
-    /* Free the buffer */
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
-    return UA_STATUSCODE_GOOD;
+    if(res != UA_STATUSCODE_GOOD)
+        UDP_shutdownConnection(cm, connectionId);
+    return res;
 }
 
 static UA_StatusCode
@@ -1226,6 +1459,74 @@ UDP_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     return res;
 }
 
+#ifdef UA_HAVE_MMSG
+static void
+UDP_Batch_clear(UDP_Batch *batch) {
+    UA_free(batch->msgs);
+    UA_free(batch->iovs);
+    UA_free(batch->addrs);
+    memset(batch, 0, sizeof(UDP_Batch));
+}
+
+static UA_StatusCode
+UDP_Batch_init(UDP_Batch *batch, size_t size, UA_Boolean withAddrs) {
+    UDP_Batch_clear(batch);
+    batch->msgs = (UDP_mmsghdr*)UA_calloc(size, sizeof(UDP_mmsghdr));
+    batch->iovs = (struct iovec*)UA_calloc(size, sizeof(struct iovec));
+    if(withAddrs)
+        batch->addrs = (struct sockaddr_storage*)
+            UA_calloc(size, sizeof(struct sockaddr_storage));
+    if(!batch->msgs || !batch->iovs || (withAddrs && !batch->addrs)) {
+        UDP_Batch_clear(batch);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    batch->size = size;
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
+/* Set up the batched receive and send. Without recvmmsg/sendmmsg every
+ * datagram is received and sent individually. */
+static UA_StatusCode
+UDP_configureBatches(UDP_ConnectionManager *ucm) {
+    ucm->recvBatchSize = 1;
+    ucm->sendBatchSize = 1;
+#ifdef UA_HAVE_MMSG
+    const UA_KeyValueMap *params = &ucm->pcm.cm.eventSource.params;
+    const UA_UInt16 *recvBatchSize = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(params,
+                                 udpManagerParams[UDP_MANAGERPARAMINDEX_RECVBATCHSIZE].name,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    const UA_UInt16 *sendBatchSize = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(params,
+                                 udpManagerParams[UDP_MANAGERPARAMINDEX_SENDBATCHSIZE].name,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+
+    UA_StatusCode res;
+    if(recvBatchSize && *recvBatchSize > 1) {
+        /* Enlarge the rx buffer to one slot of recv-bufsize per datagram */
+        size_t slotSize = ucm->pcm.rxBuffer.length;
+        UA_ByteString_clear(&ucm->pcm.rxBuffer);
+        res = UA_ByteString_allocBuffer(&ucm->pcm.rxBuffer,
+                                        slotSize * *recvBatchSize);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        res = UDP_Batch_init(&ucm->rxBatch, *recvBatchSize, true);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        ucm->recvBatchSize = *recvBatchSize;
+    }
+
+    if(sendBatchSize && *sendBatchSize > 1) {
+        res = UDP_Batch_init(&ucm->txBatch, *sendBatchSize, false);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        ucm->sendBatchSize = *sendBatchSize;
+    }
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 UDP_eventSourceStart(UA_ConnectionManager *cm) {
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
@@ -1257,6 +1558,11 @@ UDP_eventSourceStart(UA_ConnectionManager *cm) {
     if(res != UA_STATUSCODE_GOOD)
         goto finish;
 
+    /* Allocate the batches for recvmmsg/sendmmsg */
+    res = UDP_configureBatches((UDP_ConnectionManager*)cm);
+    if(res != UA_STATUSCODE_GOOD)
+        goto finish;
+
     /* Set the EventSource to the started state */
     cm->eventSource.state = UA_EVENTSOURCESTATE_STARTED;
 
@@ -1306,6 +1612,11 @@ UDP_eventSourceDelete(UA_ConnectionManager *cm) {
 
     UA_ByteString_clear(&pcm->rxBuffer);
     UA_ByteString_clear(&pcm->txBuffer);
+#ifdef UA_HAVE_MMSG
+    UDP_ConnectionManager *ucm = (UDP_ConnectionManager*)cm;
+    UDP_Batch_clear(&ucm->rxBatch);
+    UDP_Batch_clear(&ucm->txBatch);
+#endif
     UA_KeyValueMap_clear(&cm->eventSource.params);
     UA_String_clear(&cm->eventSource.name);
     UA_free(cm);
@@ -1317,10 +1628,14 @@ static const char *udpName = "udp";
 
 UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName) {
-    UA_POSIXConnectionManager *cm = (UA_POSIXConnectionManager*)
-        UA_calloc(1, sizeof(UA_POSIXConnectionManager));
-    if(!cm)
+    UDP_ConnectionManager *ucm = (UDP_ConnectionManager*)
+        UA_calloc(1, sizeof(UDP_ConnectionManager));
+    if(!ucm)
         return NULL;
+    ucm->recvBatchSize = 1;
+    ucm->sendBatchSize = 1;
+
+    UA_POSIXConnectionManager *cm = &ucm->pcm;
 
     cm->cm.eventSource.eventSourceType = UA_EVENTSOURCETYPE_CONNECTIONMANAGER;
     UA_String_copy(&eventSourceName, &cm->cm.eventSource.name);
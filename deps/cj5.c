@@ -74,6 +74,8 @@ typedef struct {
     unsigned int max_tokens;
 
     bool stop_early;
+    cj5_grow_tokens grow_tokens;
+    void *grow_tokens_context;
 } cj5__parser;
 
 static CJ5_INLINE bool
@@ -88,6 +90,16 @@ cj5__isrange(char ch, char from, char to) {
 static cj5_token *
 cj5__alloc_token(cj5__parser *parser) {
     cj5_token* token = NULL;
+
+    // Try to grow the token array. Don't try again after an overflow.
+    if(parser->token_count >= parser->max_tokens &&
+       parser->grow_tokens && parser->error != CJ5_ERROR_OVERFLOW) {
+        cj5_token *grown = parser->grow_tokens(parser->grow_tokens_context,
+                                               parser->tokens, &parser->max_tokens);
+        if(grown)
+            parser->tokens = grown;
+    }
+
     if(parser->token_count < parser->max_tokens) {
         token = &parser->tokens[parser->token_count];
         memset(token, 0x0, sizeof(cj5_token));
@@ -351,8 +363,11 @@ cj5_parse(const char *json5, unsigned int len,
     parser.tokens = tokens;
     parser.max_tokens = max_tokens;
 
-    if(options)
+    if(options) {
         parser.stop_early = options->stop_early;
+        parser.grow_tokens = options->grow_tokens;
+        parser.grow_tokens_context = options->grow_tokens_context;
+    }
 
     unsigned short depth = 0; // Nesting depth zero means "outside the root object"
     char nesting[CJ5_MAX_NESTING]; // Contains either '\0', '{' or '[' for the
@@ -366,7 +381,10 @@ cj5_parse(const char *json5, unsigned int len,
                     // restarted.
     nesting[0] = 0; // Becomes '{' if there is a virtual root object
 
-    cj5_token *token = NULL; // The current token
+    cj5_token *token = NULL; // The current token. Always points to
+                             // parser.tokens[parser.curr_tok_idx] if set. Is
+                             // reset after a token was allocated, as the token
+                             // array may have been grown and moved.
 
  start_parsing:
     for(; parser.pos < len; parser.pos++) {
@@ -447,7 +465,7 @@ cj5_parse(const char *json5, unsigned int len,
                 // token).
                 if(parser.curr_tok_idx != token->parent_id) {
                     parser.curr_tok_idx = token->parent_id;
-                    token = &tokens[token->parent_id];
+                    token = &parser.tokens[token->parent_id];
                     token->size++;
                 }
             }
@@ -484,6 +502,8 @@ cj5_parse(const char *json5, unsigned int len,
         default: // Value or key
             if(next[depth] == 'v') {
                 cj5__parse_primitive(&parser); // Parse primitive value
+                if(token)
+                    token = &parser.tokens[parser.curr_tok_idx];
                 if(nesting[depth] != 0) {
                     // Parent is object or array
                     if(token)
@@ -501,8 +521,10 @@ cj5_parse(const char *json5, unsigned int len,
                 }
             } else if(next[depth] == 'k') {
                 cj5__parse_key(&parser);
-                if(token)
+                if(token) {
+                    token = &parser.tokens[parser.curr_tok_idx];
                     token->size++; // Keys count towards the length
+                }
                 next[depth] = ':';
             } else {
                 parser.error = CJ5_ERROR_INVALID;
@@ -526,7 +548,7 @@ cj5_parse(const char *json5, unsigned int len,
         // Check the we end after a complete key-value pair (or dangling comma)
         if(next[0] != 'k' && next[0] != ',')
             parser.error = CJ5_ERROR_INVALID;
-        tokens[0].end = parser.pos - 1;
+        parser.tokens[0].end = parser.pos - 1;
     }
 
  finish:
@@ -566,7 +588,7 @@ cj5_parse(const char *json5, unsigned int len,
 
     // Set the tokens and original string only if successfully parsed
     if(r.error == CJ5_ERROR_NONE) {
-        r.tokens = tokens;
+        r.tokens = parser.tokens;
         r.json5 = json5;
     }
 
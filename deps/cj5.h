@@ -65,6 +65,10 @@
 //          printf("Error: line: %d, col: %d\n", r.error_line, r.error_code);    
 //      }
 //  }
+//
+//  Instead of reparsing, the token array can also be grown during the parsing
+//  with the `grow_tokens` callback in the options. Then the input is processed
+//  only once. The returned cj5_result.tokens points to the final token array.
 
 #ifndef __CJ5_H_
 #define __CJ5_H_
@@ -127,10 +131,19 @@ typedef struct cj5_result {
     const char* json5;
 } cj5_result;
 
+// Called when the token array is full. Returns a larger token array with the
+// existing tokens copied over and updates max_tokens. Parsing then resumes in
+// the new array. If NULL is returned, the parser continues only to count the
+// required tokens and eventually returns CJ5_ERROR_OVERFLOW.
+typedef cj5_token *
+(*cj5_grow_tokens)(void *context, cj5_token *tokens, unsigned int *max_tokens);
+
 typedef struct cj5_options {
     bool stop_early; /* Return when the first element was parsed. Otherwise an
                       * error is returned if the input was not fully
                       * processed. (default: false) */
+    cj5_grow_tokens grow_tokens; /* Optional (default: NULL) */
+    void *grow_tokens_context;
 } cj5_options;
 
 /* Options can be NULL */
@@ -26,7 +26,15 @@ typedef struct UA_AccessControl UA_AccessControl;
  *
  * The ``sessionId`` and ``sessionContext`` can be both NULL. This is the case
  * when, for example, a MonitoredItem (the underlying Subscription) is detached
- * from its Session but continues to run. */
+ * from its Session but continues to run.
+ *
+ * The callbacks are called from the thread that processes the service request.
+ * If the server config option ``parallelAccessControl`` is set, the
+ * ``getUserAccessLevel`` and ``allowBrowseNode`` callbacks are also called
+ * from the worker threads of the parallel service operations, concurrently
+ * for different nodes. The server remains locked by the calling thread in the
+ * meantime. So these callbacks then have to be thread-safe and must not call
+ * the server API. */
 
 struct UA_AccessControl {
     void *context;
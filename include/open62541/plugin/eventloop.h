@@ -442,7 +442,21 @@ struct UA_InterruptManager {
  *     non-monotonic source can be used as well. But expect accordingly longer
  *     sleep-times for timed events when the clock is set to the past. See the
  *     man-page of "clock_gettime" on how to get a clock source id for a
- *     character-device such as /dev/ptp0. (default: CLOCK_MONOTONIC_RAW)*/
+ *     character-device such as /dev/ptp0. (default: CLOCK_MONOTONIC_RAW)
+ * - 0:reactors [uint16]: Number of reactor threads (default: 0, only POSIX
+ *     with UA_MULTITHREADING >= 100). Every reactor is an internal EventLoop
+ *     with its own thread, poll set, timer and TCP ConnectionManager. Listen
+ *     sockets opened with the TCP ConnectionManager of this EventLoop are
+ *     opened once in every reactor instead. With SO_REUSEPORT the kernel
+ *     distributes the incoming connections between the reactors. The
+ *     connection callbacks of these connections are then called from the
+ *     reactor threads, concurrently with the thread running the EventLoop.
+ *     The application has to be thread-safe accordingly. The reactors are
+ *     started and stopped together with the EventLoop. The server removes
+ *     this parameter before starting the EventLoop if one of its
+ *     SecurityPolicies is not thread-safe (e.g. the mbedTLS policies). If the
+ *     EventLoop is already running with reactors, the server refuses to
+ *     start instead. */
 
 UA_EXPORT UA_EventLoop *
 UA_EventLoop_new_POSIX(const UA_Logger *logger);
@@ -512,6 +526,14 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  *       sending messages. This then becomes an upper bound for the message
  *       size. If undefined a fresh buffer is allocated for every
  *       `allocNetworkBuffer` (default: no buffer).
+ * - 0:recv-batchsize [uint16]: Maximum number of datagrams that are received
+ *       with a single syscall (recvmmsg) when a socket becomes readable. All of
+ *       them are forwarded to the connection callback before the next poll.
+ *       The receive buffer is allocated with recv-bufsize for every datagram
+ *       of the batch. Only on Linux (default: 1).
+ * - 0:send-batchsize [uint16]: Maximum number of datagrams that are sent with
+ *       a single syscall (sendmmsg). See the "more" send parameter. Only on
+ *       Linux (default: 1).
  *
  * Open Connection Parameters:
  * - 0:listen [boolean]: Use the connection for listening or for sending
@@ -543,7 +565,14 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  * - 0:remote-port [uint16]: Contains the remote port.
  *
  * Send Parameters:
- * No additional parameters for sending over an UDP connection defined. */
+ * - 0:more [boolean]: More messages for the same connection follow right away
+ *       (default: false). The message is queued until a message without this
+ *       flag is sent or send-batchsize messages are queued. Then all queued
+ *       messages are sent in order with a single syscall. Has no effect if
+ *       send-batchsize is 1 or for messages in the static buffer configured
+ *       with send-bufsize.
+ * - 0:flush [boolean]: Only send out the queued messages (default: false). The
+ *       message buffer is released without being sent. */
 UA_EXPORT UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
 
@@ -583,6 +612,21 @@ UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
  *       without actually creating any connection but solely validating the
  *       provided parameters (default: false)
  *
+ * On Linux the socket can use a PACKET_MMAP ring (TPACKET_V3) that is shared
+ * with the kernel. Listening connections then parse the received frames in
+ * place from the RX ring. For send connections, `allocNetworkBuffer` returns
+ * a frame slot in the TX ring and the frame is sent without a copy. If the TX
+ * ring is full or the message is larger than a slot (2048 bytes with the
+ * header), a normal buffer is used instead. Note that the kernel hands over
+ * an RX block only once it is full or after the ring-timeout. This adds up to
+ * ring-timeout milliseconds of latency in exchange for fewer wakeups.
+ * - 0:ring [bool]: Use a PACKET_MMAP ring for the connection (default: false).
+ * - 0:ring-blocksize [uint32]: Size of a ring block in bytes. Must be a
+ *                              multiple of the page size (default: 65536).
+ * - 0:ring-blocks [uint32]: Number of blocks in the ring (default: 8).
+ * - 0:ring-timeout [uint32]: Milliseconds after which a partially filled RX
+ *                            block is handed over (default: 1).
+ *
  * Sending with a txtime (for Time-Sensitive Networking) is possible on recent
  * Linux kernels, If enabled for the socket, then a txtime parameters can be
  * passed to `sendWithConnection`. Note that the clock source for txtime sending
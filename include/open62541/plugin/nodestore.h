@@ -336,9 +336,9 @@ typedef struct UA_ReferenceTargetTreeElem {
 
 
 /* List of reference targets with the same reference type and direction. Uses
- * either an array or a tree structure. The SDK will not change the type of
- * reference target structure internally. The nodestore implementations may
- * switch internally when a node is updated.
+ * either an array, a tree or a compact sorted array. The SDK will not change
+ * the type of reference target structure internally. The nodestore
+ * implementations may switch internally when a node is updated.
  *
  * The recommendation is to switch to a tree once the number of refs > 8. */
 typedef struct {
@@ -357,9 +357,20 @@ typedef struct {
             UA_ReferenceTargetTreeElem *idRoot;   /* Lookup based on target id */
             UA_ReferenceTargetTreeElem *nameRoot; /* Lookup based on browseName*/
         } tree;
+
+        /* Compact representation for large and mostly static lists of
+         * references. The array is sorted by the targetId for lookups with a
+         * binary search. The nameIndex contains the array positions sorted by
+         * the targetNameHash. Uses much less memory than the tree. But adding
+         * and removing targets takes linear time. */
+        struct {
+            UA_ReferenceTarget *array; /* Aliases the array from above */
+            UA_UInt32 *nameIndex;
+        } compact;
     } targets;
     size_t targetsSize;
     UA_Boolean hasRefTree; /* RefTree or RefArray? */
+    UA_Boolean isCompact;  /* RefArray in the compact representation? */
     UA_Byte referenceTypeIndex;
     UA_Boolean isInverse;
 } UA_NodeReferenceKind;
@@ -385,6 +396,12 @@ UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
 UA_EXPORT UA_StatusCode
 UA_NodeReferenceKind_switch(UA_NodeReferenceKind *rk);
 
+/* Convert the array or tree to the compact representation. Switching a compact
+ * list of references results in a tree. Does nothing upon error (e.g.
+ * out-of-memory). */
+UA_EXPORT UA_StatusCode
+UA_NodeReferenceKind_compact(UA_NodeReferenceKind *rk);
+
 /* Singly-linked LocalizedText list */
 typedef struct UA_LocalizedTextListEntry {
     struct UA_LocalizedTextListEntry *next;
@@ -532,6 +549,39 @@ typedef struct {
                            const UA_DataValue *value);
 } UA_DataSource;
 
+/* Several DataSource variables can be read with a single call if the server
+ * configuration defines a ``readDataSourceBatch`` callback. The items of a
+ * batch all have a DataSource with the same read callback. Items without an
+ * IndexRange are considered for batching.
+ *
+ * The batched read sets the value (or the status) of each item. Values may
+ * point to memory owned by the user if the storageType is set to
+ * `UA_VARIANT_DATA_NODELETE`. The individual read callback of the DataSource
+ * is used for items where neither value nor status is set. If an error is
+ * returned, all items are read individually.
+ *
+ * @param server The server executing the callback
+ * @param sessionId The identifier of the session
+ * @param sessionContext Additional data attached to the session in the
+ *        access control layer
+ * @param dataSource The DataSource common to all items
+ * @param includeSourceTimeStamp If true, then the source timestamp is
+ *        expected to be set in the returned values
+ * @param itemsSize The number of items in the batch
+ * @param items The items with the node identifiers and node contexts. The
+ *        values are initialized as empty. */
+typedef struct {
+    const UA_NodeId *nodeId;
+    void *nodeContext;
+    UA_DataValue value;
+} UA_DataSourceReadItem;
+
+typedef UA_StatusCode
+(*UA_DataSourceBatchRead)(UA_Server *server, const UA_NodeId *sessionId,
+                          void *sessionContext, const UA_DataSource *dataSource,
+                          UA_Boolean includeSourceTimeStamp,
+                          size_t itemsSize, UA_DataSourceReadItem *items);
+
 /**
  * .. _value-callback:
  *
@@ -749,6 +799,34 @@ typedef union {
 
 typedef void (*UA_NodestoreVisitor)(void *visitorCtx, const UA_Node *node);
 
+/* Statistics to size and tune the nodestore. The operation counters are
+ * cumulated since the nodestore was created. The NodeClass arrays are indexed
+ * by the bit position of the NodeClass (Object, Variable, Method, ObjectType,
+ * VariableType, ReferenceType, DataType, View). The counters for the lookups
+ * (getCount, copyCount, probeHistogram) are updated on every node access. The
+ * default nodestores only count them with UA_ENABLE_NODESTORE_STATISTICS. */
+#define UA_NODESTORE_NODECLASSES 8
+#define UA_NODESTORE_PROBEHISTOGRAMSIZE 8
+
+typedef struct {
+    size_t nodeCount;
+    size_t capacity;             /* Allocated slots. Equal to nodeCount if the
+                                  * nodestore has no notion of slots. */
+    size_t getCount;             /* getNode and getNodeFromPtr */
+    size_t copyCount;            /* getNodeCopy */
+    size_t insertCount;
+    size_t replaceCount;
+    size_t replaceConflictCount; /* The node was replaced since the copy was made */
+    size_t removeCount;
+
+    /* Lookups by the number of probed slots: 1, 2, 3-4, 5-8, 9-16, 17-32,
+     * 33-64 and more. All zero if the nodestore does not probe. */
+    size_t probeHistogram[UA_NODESTORE_PROBEHISTOGRAMSIZE];
+
+    size_t nodeClassCount[UA_NODESTORE_NODECLASSES];
+    size_t nodeClassBytes[UA_NODESTORE_NODECLASSES]; /* Approximate memory */
+} UA_NodestoreStatistics;
+
 typedef struct {
     /* Nodestore context and lifecycle */
     void *context;
@@ -822,6 +900,10 @@ typedef struct {
     /* Execute a callback for every node in the nodestore. */
     void (*iterate)(void *nsCtx, UA_NodestoreVisitor visitor,
                     void *visitorCtx);
+
+    /* Optional, can be NULL. Returns the current statistics. This is not
+     * intended for the fast path and can iterate over all nodes. */
+    void (*getStatistics)(void *nsCtx, UA_NodestoreStatistics *stats);
 } UA_Nodestore;
 
 /* Attributes must be of a matching type (VariableAttributes, ObjectAttributes,
@@ -866,6 +948,12 @@ UA_Node_deleteReferences(UA_Node *node);
 void UA_EXPORT
 UA_Node_clear(UA_Node *node);
 
+/* Approximate heap memory used by the members of the node. Without the node
+ * structure itself (that is allocated by the nodestore) and without interned
+ * strings and NodeIds that are shared between the nodes. */
+size_t UA_EXPORT
+UA_Node_getMemoryUsage(const UA_Node *node);
+
 _UA_END_DECLS
 
 #endif /* UA_NODESTORE_H_ */
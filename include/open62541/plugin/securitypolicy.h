@@ -310,6 +310,12 @@ struct UA_SecurityPolicy {
 
     const UA_Logger *logger;
 
+    /* The symmetric module and the channel contexts can be used concurrently
+     * for different SecureChannels. Otherwise all operations of the policy are
+     * serialized by the server. This is required for reactor threads in the
+     * EventLoop. */
+    UA_Boolean threadSafe;
+
     /* Updates the ApplicationInstanceCertificate and the corresponding private
      * key at runtime. */
     UA_StatusCode (*updateCertificateAndPrivateKey)(UA_SecurityPolicy *policy,
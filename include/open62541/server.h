@@ -231,6 +231,22 @@ struct UA_ServerConfig {
      * ModellingRule of their InstanceDeclaration */
     UA_Boolean modellingRulesOnInstances;
 
+    /**
+     * Nodestore Image
+     * ^^^^^^^^^^^^^^^
+     * Start the server from an image of the nodestore that was created with
+     * :c:func:`UA_Server_saveNodestoreImage`. The nodes are inserted without
+     * the consistency checks of AddNodes and namespace zero is not generated.
+     * This shortens the startup for large information models. The image is
+     * not owned by the server and only used during
+     * :c:func:`UA_Server_newWithConfig`. So it can point into a memory-mapped
+     * file. The nodestore has to be empty before the image is loaded.
+     *
+     * Callbacks, node contexts, value backends and DataSources are not part
+     * of the image. The callbacks in namespace zero are attached by the
+     * server. All other callbacks have to be set again by the application. */
+    const UA_ByteString *nodestoreImage;
+
     /**
      * Limits
      * ^^^^^^ */
@@ -255,6 +271,89 @@ struct UA_ServerConfig {
     /* Limits for Requests */
     UA_UInt32 maxReferencesPerNode;
 
+    /**
+     * Value Cache
+     * ^^^^^^^^^^^
+     * Values read from DataSources can be cached in the server. A Read request
+     * then reuses a cached value if it is not older than the requested maxAge.
+     * The sampling of MonitoredItems reuses cached values that are not older
+     * than half the sampling interval. Reads with an IndexRange bypass the
+     * cache. A write to the DataSource removes the value from the cache.
+     *
+     * The cache is shared between all Sessions. Only enable it if the values
+     * returned by the DataSources do not depend on the Session. When the cache
+     * is full, the least recently used value is evicted. */
+    UA_UInt32 maxValueCacheSize; /* 0 -> cache disabled */
+
+    /**
+     * Browse Cache
+     * ^^^^^^^^^^^^
+     * The results of Browse operations can be cached in the server. The cache
+     * key is the browsed node together with the BrowseDirection, the set of
+     * ReferenceTypes, the NodeClassMask, the ResultMask and the locales of the
+     * Session (if the DisplayName is requested). Only results that fit into a
+     * single response without a ContinuationPoint are cached.
+     *
+     * When a reference is added or removed, the cached results for the node
+     * are removed. When a node is deleted, a DisplayName is written or a
+     * TypeDefinition changes, the results of the neighbors (that contain the
+     * node) are removed as well. So the cache is most useful for static
+     * regions of the address space such as the type hierarchies. When the
+     * cache is full, the least recently used result is evicted. */
+    UA_UInt32 maxBrowseCacheSize; /* 0 -> cache disabled */
+
+    /**
+     * BrowsePath Cache
+     * ^^^^^^^^^^^^^^^^
+     * The resolution of BrowsePaths (TranslateBrowsePathsToNodeIds) can be
+     * cached in a prefix tree. Every entry holds the target nodes for a
+     * starting node and a sequence of RelativePathElements. Paths that share a
+     * prefix reuse the resolution of the prefix. This helps when clients
+     * resolve the same paths (with the same start) after every reconnect.
+     *
+     * The configured size is the maximum number of cached prefixes. When the
+     * cache is full, the least recently used prefixes are evicted. When a
+     * reference is added or removed or a node is deleted, only the prefixes
+     * that resolve to the node (and the longer paths with these prefixes) are
+     * removed. Paths that contain remote nodes are not cached. */
+    UA_UInt32 maxBrowsePathCacheSize; /* 0 -> cache disabled */
+
+    /**
+     * Batched DataSource Reads
+     * ^^^^^^^^^^^^^^^^^^^^^^^^
+     * If set, the DataSource variables of a Read request are read in batches.
+     * The same applies to the MonitoredItems that are sampled together in the
+     * publishing interval of their Subscription. A batch contains the items
+     * whose DataSource has the same read callback. See the definition of
+     * ``UA_DataSourceBatchRead`` for details. */
+    UA_DataSourceBatchRead readDataSourceBatch;
+
+    /**
+     * Parallel Operations
+     * ^^^^^^^^^^^^^^^^^^^
+     * The operations of large Read, Browse and TranslateBrowsePathsToNodeIds
+     * requests can be partitioned into slices that are processed by worker
+     * threads. Every slice contains at least ``minParallelOperations``
+     * operations. So small requests remain on the sequential path.
+     *
+     * The worker threads are started with the server and stopped at shutdown.
+     * Changes of ``maxParallelOperationThreads`` take effect at the next
+     * startup. The worker threads access the NodeStore concurrently while the
+     * server remains locked. Operations that call into user code (DataSources,
+     * value callbacks, value backends) or that create a ContinuationPoint are
+     * deferred and processed sequentially afterwards.
+     *
+     * By default, this also applies to operations of non-admin Sessions that
+     * call into the AccessControl plugin. Set ``parallelAccessControl`` if the
+     * AccessControl callbacks ``getUserAccessLevel`` and ``allowBrowseNode``
+     * are thread-safe (see the AccessControl plugin API). Then they are called
+     * from the worker threads. Only available with POSIX threads. */
+#if UA_MULTITHREADING >= 100
+    UA_UInt16 maxParallelOperationThreads; /* 0 -> disabled */
+    UA_UInt32 minParallelOperations; /* Minimum operations per thread */
+    UA_Boolean parallelAccessControl; /* AccessControl is thread-safe */
+#endif
+
     /**
      * Async Operations
      * ^^^^^^^^^^^^^^^^
@@ -407,6 +506,13 @@ UA_Server_new(void);
 UA_EXPORT UA_Server *
 UA_Server_newWithConfig(UA_ServerConfig *config);
 
+/* Encode all nodes of the nodestore (and the namespace array) into an image.
+ * The image can be used in the ``nodestoreImage`` field of the server
+ * configuration to start a server with the same information model. The image
+ * has to be freed with UA_ByteString_clear. */
+UA_StatusCode UA_EXPORT
+UA_Server_saveNodestoreImage(UA_Server *server, UA_ByteString *image);
+
 /* Delete the server. */
 UA_EXPORT UA_StatusCode
 UA_Server_delete(UA_Server *server);
@@ -1548,6 +1654,35 @@ UA_Server_addMethodNode_finish(UA_Server *server, const UA_NodeId nodeId,
 
 #endif
 
+/**
+ * UA_Server_addNodes adds a batch of nodes. This is faster than adding the
+ * nodes one by one for large information models:
+ *
+ *  - All nodes are inserted into the nodestore first. Then the references to
+ *    the parents and TypeDefinitions are added for the entire batch before
+ *    the nodes are validated. So the parent, the ReferenceType to the parent
+ *    and the TypeDefinition of a node can appear later in the batch. Objects
+ *    without a BrowseName take the DefaultInstanceBrowseName from their
+ *    TypeDefinition. That property has to exist before the batch is added.
+ *  - Nodes with the same parent, ReferenceType, TypeDefinition and NodeClass
+ *    are validated only once.
+ *  - The references are added sorted by the parent and the TypeDefinition.
+ *    The parent (or type) node gets the references of the group in a single
+ *    edit.
+ *  - Then the nodes are finished (children from the TypeDefinition,
+ *    constructors) in the order of the batch.
+ *
+ * A node fails if its parent, ReferenceType or TypeDefinition in the batch has
+ * failed. The failed nodes are removed together with their references. The
+ * nodeContexts array is optional. Otherwise it has itemsSize entries. The
+ * results array has itemsSize entries and is initialized by the method. The
+ * results need to be cleared by the caller. A bad StatusCode is returned only
+ * if the batch could not be processed at all. */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_addNodes(UA_Server *server, size_t itemsSize,
+                   const UA_AddNodesItem *items, void **nodeContexts,
+                   UA_AddNodesResult *results);
+
 /* Deletes a node and optionally all references leading to the node. */
 UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_deleteNode(UA_Server *server, const UA_NodeId nodeId,
@@ -1567,6 +1702,16 @@ UA_Server_deleteReference(UA_Server *server, const UA_NodeId sourceNodeId,
                           const UA_ExpandedNodeId targetNodeId,
                           UA_Boolean deleteBidirectional);
 
+/* Convert the larger lists of references (more than eight targets with the
+ * same ReferenceType and direction) of all nodes to a compact representation.
+ * The compact representation is a sorted array with an index for the
+ * BrowseNames. It uses much less memory than the tree representation and
+ * lookups still use a binary search. But adding and removing references of
+ * a compacted list takes linear time. Call this after a large and mostly static
+ * information model was loaded. */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_compactReferences(UA_Server *server);
+
 /**
  * .. _events:
  *
@@ -1945,9 +2090,36 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
  * Statistic counters keeping track of the current state of the stack. Counters
  * are structured per OPC UA communication layer. */
 
+typedef struct {
+    size_t currentEntryCount;
+    size_t hitCount;
+    size_t missCount;
+    size_t evictionCount;
+} UA_ValueCacheStatistics;
+
+typedef struct {
+    size_t currentEntryCount;
+    size_t hitCount;
+    size_t missCount;
+    size_t evictionCount;
+    size_t invalidationCount; /* Entries removed after a change */
+} UA_BrowseCacheStatistics;
+
+typedef struct {
+    size_t currentEntryCount;
+    size_t hitCount;  /* Path elements resolved from the cache */
+    size_t missCount; /* Path elements resolved from the nodestore */
+    size_t evictionCount;
+    size_t invalidationCount; /* Entries removed after a change */
+} UA_BrowsePathCacheStatistics;
+
 typedef struct {
    UA_SecureChannelStatistics scs;
    UA_SessionStatistics ss;
+   UA_ValueCacheStatistics vcs;
+   UA_BrowseCacheStatistics bcs;
+   UA_BrowsePathCacheStatistics bpcs;
+   UA_NodestoreStatistics ns; /* All zero if the nodestore has no statistics */
 } UA_ServerStatistics;
 
 UA_ServerStatistics UA_EXPORT
@@ -446,7 +446,14 @@ typedef struct {
  * container for :ref:`dsw` and network message settings. The WriterGroup can be
  * imagined as producer of the network messages. The creation of network
  * messages is controlled by parameters like the publish interval, which is e.g.
- * contained in the WriterGroup. */
+ * contained in the WriterGroup.
+ *
+ * WriterGroups of the same PubSubConnection with an equal publishing interval
+ * are published together from one cyclic callback. With the UDP
+ * ConnectionManager and its ``send-batchsize`` parameter set above one, their
+ * NetworkMessages are then sent in a single batch per cycle. WriterGroups with
+ * the realtime level ``UA_PUBSUB_RT_FIXED_SIZE`` are always published on their
+ * own (without the server lock once frozen). */
 
 typedef enum {
     UA_PUBSUB_ENCODING_UADP = 0,
@@ -507,6 +514,10 @@ typedef struct {
     UA_UInt16 maxEncapsulatedDataSetMessageCount;
     /* non std. field */
     UA_PubSubRTLevel rtLevel;
+    /* non std. field. Optional sequence counter that guards the external
+     * values of the DataSetFields. See the section on realtime value updates
+     * below. */
+    UA_UInt32 *rtValueSequence;
 
     /* Message are encrypted if a SecurityPolicy is configured and the
      * securityMode set accordingly. The symmetric key is a runtime information
@@ -558,6 +569,49 @@ UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_unfreezeWriterGroupConfiguration(UA_Server *server,
                                            const UA_NodeId wgId);
 
+/**
+ * Realtime Value Updates
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ * Frozen WriterGroups and ReaderGroups with ``UA_PUBSUB_RT_FIXED_SIZE`` are
+ * published and received without taking the server lock. So the publish
+ * interval is not delayed by concurrent client requests. The fast path is
+ * taken while the group (and for the ReaderGroups all groups of the
+ * PubSubConnection) are frozen and operational. Otherwise the messages are
+ * processed with the server lock as before. The beforeWrite/afterWrite
+ * callbacks of the target variables are then called without the server lock.
+ * They must not reconfigure PubSub.
+ *
+ * The external values are read by the publisher and written by the subscriber
+ * concurrently to the application. If a group is configured with an
+ * ``rtValueSequence`` counter, then all access to the external values of the
+ * group is guarded as a sequence lock. Writers (the application for the
+ * published values, the ReaderGroup for the target variables) bracket their
+ * updates with ``UA_PubSub_beginValueUpdate`` and ``UA_PubSub_endValueUpdate``.
+ * Only one writer may update the values at a time. Readers (the publisher, or
+ * the read callback of the value backend for the client access) never block
+ * the writer. They retry until they got a consistent snapshot::
+ *
+ *     UA_UInt32 seq;
+ *     do {
+ *         seq = UA_PubSub_beginValueRead(&counter);
+ *         copy the values
+ *     } while(UA_PubSub_retryValueRead(&counter, seq));
+ *
+ * The values have to be updated in-place. That is, the data pointers of the
+ * external DataValues must not change while the group is frozen. */
+
+void UA_EXPORT
+UA_PubSub_beginValueUpdate(UA_UInt32 *sequence);
+
+void UA_EXPORT
+UA_PubSub_endValueUpdate(UA_UInt32 *sequence);
+
+UA_UInt32 UA_EXPORT
+UA_PubSub_beginValueRead(const UA_UInt32 *sequence);
+
+UA_Boolean UA_EXPORT
+UA_PubSub_retryValueRead(const UA_UInt32 *sequence, UA_UInt32 start);
+
 UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_enableWriterGroup(UA_Server *server, const UA_NodeId wgId);
 
@@ -810,6 +864,9 @@ typedef struct {
 
     /* non std. field */
     UA_PubSubRTLevel rtLevel;
+    /* non std. field. Optional sequence counter that guards the external
+     * target values (see the section on realtime value updates). */
+    UA_UInt32 *rtValueSequence;
     UA_KeyValueMap groupProperties;
     UA_PubSubEncodingType encodingMimeType;
     UA_ExtensionObject transportSettings;
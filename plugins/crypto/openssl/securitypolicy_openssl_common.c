@@ -31,6 +31,10 @@ modification history
 #include "securitypolicy_openssl_common.h"
 #include "ua_openssl_version_abstraction.h"
 
+#ifdef UA_OPENSSL_EVP_MAC
+#include <openssl/core_names.h>
+#endif
+
 #define SHA1_DIGEST_LENGTH 20          /* 160 bits */
 #define RSA_DECRYPT_BUFFER_LENGTH 2048 /* bytes */
 
@@ -629,199 +633,216 @@ UA_Openssl_RSA_PSS_SHA256_Sign (const UA_ByteString * message,
                                         RSA_PKCS1_PSS_PADDING, outSignature);
 }
 
-UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Verify (const UA_ByteString *     message,
-                               const UA_ByteString *     key,
-                               const UA_ByteString *     signature
-                              ) {
-    unsigned char buf[SHA256_DIGEST_LENGTH] = {0};
-    UA_ByteString mac = {SHA256_DIGEST_LENGTH, buf};
-
-    if (HMAC (EVP_sha256(), key->data, (int) key->length, message->data, message->length,
-              mac.data, (unsigned int *) &mac.length) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    if (UA_ByteString_equal (signature, &mac)) {
-        return UA_STATUSCODE_GOOD;
-    }
-    else {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
+#if (OPENSSL_VERSION_NUMBER < 0x10100000L && !defined(LIBRESSL_VERSION_NUMBER)) || \
+    (defined(LIBRESSL_VERSION_NUMBER) && LIBRESSL_VERSION_NUMBER < 0x2070000fL)
+static HMAC_CTX *
+HMAC_CTX_new(void) {
+    HMAC_CTX *ctx = (HMAC_CTX *)OPENSSL_malloc(sizeof(HMAC_CTX));
+    if(ctx != NULL)
+        HMAC_CTX_init(ctx);
+    return ctx;
 }
 
-UA_StatusCode
-UA_OpenSSL_HMAC_SHA256_Sign (const UA_ByteString *     message,
-                             const UA_ByteString *     key,
-                             UA_ByteString *           signature
-                             ) {
-    if (HMAC (EVP_sha256(), key->data, (int) key->length, message->data,
-              message->length,
-              signature->data, (unsigned int *) &(signature->length)) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    return UA_STATUSCODE_GOOD;
+static void
+HMAC_CTX_free(HMAC_CTX *ctx) {
+    if(ctx == NULL)
+        return;
+    HMAC_CTX_cleanup(ctx);
+    OPENSSL_free(ctx);
 }
+#endif
 
-static UA_StatusCode
-UA_OpenSSL_Decrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/) {
-    UA_ByteString    ivCopy    = {0, NULL};
-    UA_ByteString    cipherTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx       = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
+static void
+UA_OpenSSL_SymContext_clearHMAC(UA_OpenSSL_SymContext *ctx) {
+#ifdef UA_OPENSSL_EVP_MAC
+    EVP_MAC_CTX_free(ctx->hmacCtx);
+#else
+    HMAC_CTX_free(ctx->hmacCtx);
+#endif
+    ctx->hmacCtx = NULL;
+}
 
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
+static void
+UA_OpenSSL_SymContext_clearCipher(UA_OpenSSL_SymContext *ctx) {
+    if(ctx->cipherCtx != NULL)
+        EVP_CIPHER_CTX_free(ctx->cipherCtx);
+    ctx->cipherCtx = NULL;
+}
 
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
+void
+UA_OpenSSL_SymContext_clear(UA_OpenSSL_SymContext *ctx) {
+    UA_OpenSSL_SymContext_clearHMAC(ctx);
+    UA_OpenSSL_SymContext_clearCipher(ctx);
+}
 
-    ret = UA_ByteString_copy (data, &cipherTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
+/* Key the HMAC context on first use. Afterwards it is only reset to the keyed
+ * state for every message. */
+static UA_StatusCode
+UA_OpenSSL_HMAC_init(UA_OpenSSL_SymContext *ctx, const EVP_MD *md,
+                     const UA_ByteString *key) {
+    if(ctx->hmacCtx != NULL)
+        return UA_STATUSCODE_GOOD;
 
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
+#ifdef UA_OPENSSL_EVP_MAC
+    EVP_MAC *mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+    if(mac == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    ctx->hmacCtx = EVP_MAC_CTX_new(mac);
+    EVP_MAC_free(mac); /* The context holds a reference */
+    if(ctx->hmacCtx == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    OSSL_PARAM params[2];
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                                 (char *)(uintptr_t)EVP_MD_get0_name(md), 0);
+    params[1] = OSSL_PARAM_construct_end();
+    int opensslRet = EVP_MAC_init(ctx->hmacCtx, key->data, key->length, params);
+#else
+    ctx->hmacCtx = HMAC_CTX_new();
+    if(ctx->hmacCtx == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    int opensslRet = HMAC_Init_ex(ctx->hmacCtx, key->data, (int) key->length, md, NULL);
+#endif
+    if(opensslRet != 1) {
+        UA_OpenSSL_SymContext_clearHMAC(ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
+    return UA_STATUSCODE_GOOD;
+}
 
-    /* call EVP_* to decrypt */
-
-    opensslRet = EVP_DecryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    /* EVP_DecryptFinal() will return an error code if padding is enabled
-     * and the final block is not correctly formatted.
-     */
-    EVP_CIPHER_CTX_set_padding (ctx, 0);
-    opensslRet = EVP_DecryptUpdate (ctx, data->data, &outLen,
-                                    cipherTxt.data, (int) cipherTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_DecryptFinal_ex (ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
+/* The mac length is the size of the buffer as input and the length of the
+ * result as output */
+static UA_StatusCode
+UA_OpenSSL_HMAC(UA_OpenSSL_SymContext *ctx, const EVP_MD *md,
+                const UA_ByteString *key, const UA_ByteString *message,
+                UA_ByteString *mac) {
+    if(mac->length < (size_t) EVP_MD_size(md))
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_StatusCode ret = UA_OpenSSL_HMAC_init(ctx, md, key);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
 
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&cipherTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    return ret;
+#ifdef UA_OPENSSL_EVP_MAC
+    size_t macLen = 0;
+    if(EVP_MAC_init(ctx->hmacCtx, NULL, 0, NULL) != 1 ||
+       EVP_MAC_update(ctx->hmacCtx, message->data, message->length) != 1 ||
+       EVP_MAC_final(ctx->hmacCtx, mac->data, &macLen, mac->length) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+#else
+    unsigned int macLen = 0;
+    if(HMAC_Init_ex(ctx->hmacCtx, NULL, 0, NULL, NULL) != 1 ||
+       HMAC_Update(ctx->hmacCtx, message->data, message->length) != 1 ||
+       HMAC_Final(ctx->hmacCtx, mac->data, &macLen) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+#endif
+    mac->length = (size_t) macLen;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
-UA_OpenSSL_Encrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/
-                    ) {
-
-    UA_ByteString    ivCopy   = {0, NULL};
-    UA_ByteString    plainTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx      = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
+UA_OpenSSL_HMAC_Verify(UA_OpenSSL_SymContext *ctx, const EVP_MD *md,
+                       const UA_ByteString *key, const UA_ByteString *message,
+                       const UA_ByteString *signature) {
+    unsigned char buf[EVP_MAX_MD_SIZE] = {0};
+    UA_ByteString mac = {EVP_MAX_MD_SIZE, buf};
+    UA_StatusCode ret = UA_OpenSSL_HMAC(ctx, md, key, message, &mac);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    if(UA_ByteString_equal(signature, &mac))
+        return UA_STATUSCODE_GOOD;
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
 
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
+UA_StatusCode
+UA_OpenSSL_HMAC_SHA256_Verify (const UA_ByteString *     message,
+                               const UA_ByteString *     key,
+                               UA_OpenSSL_SymContext *   ctx,
+                               const UA_ByteString *     signature
+                              ) {
+    return UA_OpenSSL_HMAC_Verify(ctx, EVP_sha256(), key, message, signature);
+}
 
-    ret = UA_ByteString_copy (data, &plainTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
+UA_StatusCode
+UA_OpenSSL_HMAC_SHA256_Sign (const UA_ByteString *     message,
+                             const UA_ByteString *     key,
+                             UA_OpenSSL_SymContext *   ctx,
+                             UA_ByteString *           signature
+                             ) {
+    return UA_OpenSSL_HMAC(ctx, EVP_sha256(), key, message, signature);
+}
 
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
-    }
+/* Key the cipher context on first use. For every chunk only the IV is set. */
+static UA_StatusCode
+UA_OpenSSL_Cipher_init(UA_OpenSSL_SymContext *ctx, const EVP_CIPHER *cipherAlg,
+                       const UA_ByteString *key, int enc) {
+    if(ctx->cipherCtx != NULL)
+        return UA_STATUSCODE_GOOD;
+    if(key->length != (size_t) EVP_CIPHER_key_length(cipherAlg))
+        return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* call EVP_* to encrypt */
+    ctx->cipherCtx = EVP_CIPHER_CTX_new();
+    if(ctx->cipherCtx == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    opensslRet = EVP_EncryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
+    /* Disable padding. Padding is done in the stack before calling
+     * encryption. EVP_DecryptFinal() would return an error code if padding is
+     * enabled and the final block is not correctly formatted. */
+    if(EVP_CipherInit_ex(ctx->cipherCtx, cipherAlg, NULL, key->data, NULL, enc) != 1 ||
+       EVP_CIPHER_CTX_set_padding(ctx->cipherCtx, 0) != 1) {
+        UA_OpenSSL_SymContext_clearCipher(ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
+    return UA_STATUSCODE_GOOD;
+}
 
-    /* Disable padding. Padding is done in the stack before calling encryption.
-     * Ensure that we have a multiple of the block size */
-    if(data->length % (size_t)EVP_CIPHER_CTX_block_size(ctx)) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_CIPHER_CTX_set_padding(ctx, 0);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
+/* Encrypt or decrypt in-place. CBC allows the output to fully overlap the
+ * input. So no copy of the data is required. */
+static UA_StatusCode
+UA_OpenSSL_Cipher (const UA_ByteString *   iv,
+                   const UA_ByteString *   key,
+                   UA_OpenSSL_SymContext * ctx,
+                   const EVP_CIPHER *      cipherAlg,
+                   int                     enc,
+                   UA_ByteString *         data  /* [in/out]*/) {
+    UA_StatusCode ret = UA_OpenSSL_Cipher_init(ctx, cipherAlg, key, enc);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
 
-    /* Encrypt the data */
-    opensslRet = EVP_EncryptUpdate (ctx, data->data, &outLen,
-                                    plainTxt.data, (int) plainTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
+    /* Ensure that we have a multiple of the block size */
+    if(data->length % (size_t) EVP_CIPHER_CTX_block_size(ctx->cipherCtx) ||
+       iv->length < (size_t) EVP_CIPHER_CTX_iv_length(ctx->cipherCtx))
+        return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* Encrypt-final does nothing as padding is disabled */
-    opensslRet = EVP_EncryptFinal_ex(ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
+    /* Set the IV. The key schedule of the context is kept. */
+    int outLen;
+    int tmpLen;
+    if(EVP_CipherInit_ex(ctx->cipherCtx, NULL, NULL, NULL, iv->data, -1) != 1 ||
+       EVP_CipherUpdate(ctx->cipherCtx, data->data, &outLen,
+                        data->data, (int) data->length) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
 
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&plainTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
-    }
-    return ret;
+    /* Final does nothing as padding is disabled */
+    if(EVP_CipherFinal_ex(ctx->cipherCtx, data->data + outLen, &tmpLen) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    data->length = (size_t) (outLen + tmpLen);
+    return UA_STATUSCODE_GOOD;
 }
 
 UA_StatusCode
 UA_OpenSSL_AES_256_CBC_Decrypt (const UA_ByteString * iv,
                                 const UA_ByteString * key,
+                                UA_OpenSSL_SymContext * ctx,
                                 UA_ByteString *       data  /* [in/out]*/
                                 ) {
-    return UA_OpenSSL_Decrypt (iv, key, EVP_aes_256_cbc (), data);
+    return UA_OpenSSL_Cipher (iv, key, ctx, EVP_aes_256_cbc (), 0, data);
 }
 
 UA_StatusCode
 UA_OpenSSL_AES_256_CBC_Encrypt (const UA_ByteString * iv,
                             const UA_ByteString * key,
+                            UA_OpenSSL_SymContext * ctx,
                             UA_ByteString *       data  /* [in/out]*/
                             ) {
-    return UA_OpenSSL_Encrypt (iv, key, EVP_aes_256_cbc (), data);
+    return UA_OpenSSL_Cipher (iv, key, ctx, EVP_aes_256_cbc (), 1, data);
 }
 
 UA_StatusCode
@@ -939,34 +960,19 @@ UA_Openssl_Random_Key_PSHA1_Derive (const UA_ByteString *     secret,
 UA_StatusCode
 UA_OpenSSL_HMAC_SHA1_Verify (const UA_ByteString *     message,
                              const UA_ByteString *     key,
+                             UA_OpenSSL_SymContext *   ctx,
                              const UA_ByteString *     signature
                              ) {
-    unsigned char buf[SHA1_DIGEST_LENGTH] = {0};
-    UA_ByteString mac = {SHA1_DIGEST_LENGTH, buf};
-
-    if(HMAC (EVP_sha1(), key->data, (int) key->length, message->data, message->length,
-             mac.data, (unsigned int *) &mac.length) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    if (UA_ByteString_equal (signature, &mac)) {
-        return UA_STATUSCODE_GOOD;
-    }
-    else {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
+    return UA_OpenSSL_HMAC_Verify(ctx, EVP_sha1(), key, message, signature);
 }
 
 UA_StatusCode
 UA_OpenSSL_HMAC_SHA1_Sign (const UA_ByteString *     message,
                            const UA_ByteString *     key,
+                           UA_OpenSSL_SymContext *   ctx,
                            UA_ByteString *           signature
                            ) {
-    if (HMAC (EVP_sha1(), key->data, (int) key->length, message->data,
-              message->length,
-              signature->data, (unsigned int *) &(signature->length)) == NULL) {
-        return UA_STATUSCODE_BADINTERNALERROR;
-    }
-    return UA_STATUSCODE_GOOD;
+    return UA_OpenSSL_HMAC(ctx, EVP_sha1(), key, message, signature);
 }
 
 UA_StatusCode
@@ -996,17 +1002,19 @@ UA_Openssl_RSA_PKCS1_V15_Encrypt (UA_ByteString * data,
 UA_StatusCode
 UA_OpenSSL_AES_128_CBC_Decrypt (const UA_ByteString * iv,
                                 const UA_ByteString * key,
+                                UA_OpenSSL_SymContext * ctx,
                                 UA_ByteString *       data  /* [in/out]*/
                                 ) {
-    return UA_OpenSSL_Decrypt (iv, key, EVP_aes_128_cbc (), data);
+    return UA_OpenSSL_Cipher (iv, key, ctx, EVP_aes_128_cbc (), 0, data);
 }
 
 UA_StatusCode
 UA_OpenSSL_AES_128_CBC_Encrypt (const UA_ByteString * iv,
                                 const UA_ByteString * key,
+                                UA_OpenSSL_SymContext * ctx,
                                 UA_ByteString *       data  /* [in/out]*/
                                 ) {
-    return UA_OpenSSL_Encrypt (iv, key, EVP_aes_128_cbc (), data);
+    return UA_OpenSSL_Cipher (iv, key, ctx, EVP_aes_128_cbc (), 1, data);
 }
 
 EVP_PKEY *
@@ -17,9 +17,27 @@
 
 #include <openssl/x509.h>
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include "ua_openssl_version_abstraction.h"
 
 _UA_BEGIN_DECLS
 
+/* Cipher and HMAC contexts for one direction of a SecureChannel. They are
+ * keyed on first use and then reused for every chunk. The contexts must be
+ * cleared when the keys change. */
+typedef struct {
+    EVP_CIPHER_CTX *cipherCtx;
+#ifdef UA_OPENSSL_EVP_MAC
+    EVP_MAC_CTX *hmacCtx;
+#else
+    HMAC_CTX *hmacCtx;
+#endif
+} UA_OpenSSL_SymContext;
+
+void
+UA_OpenSSL_SymContext_clear(UA_OpenSSL_SymContext *ctx);
+
 void saveDataToFile(const char *fileName, const UA_ByteString *str);
 void UA_Openssl_Init(void);
 
@@ -80,21 +98,25 @@ UA_Openssl_RSA_PSS_SHA256_Sign (const UA_ByteString * message,
 UA_StatusCode
 UA_OpenSSL_HMAC_SHA256_Verify(const UA_ByteString *message,
                               const UA_ByteString *key,
+                              UA_OpenSSL_SymContext *ctx,
                               const UA_ByteString *signature);
 
 UA_StatusCode
 UA_OpenSSL_HMAC_SHA256_Sign(const UA_ByteString *message,
                             const UA_ByteString *key,
+                            UA_OpenSSL_SymContext *ctx,
                             UA_ByteString *signature);
 
 UA_StatusCode
 UA_OpenSSL_AES_256_CBC_Decrypt(const UA_ByteString *iv,
                                const UA_ByteString *key,
+                               UA_OpenSSL_SymContext *ctx,
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
 UA_OpenSSL_AES_256_CBC_Encrypt(const UA_ByteString *iv,
                                const UA_ByteString *key,
+                               UA_OpenSSL_SymContext *ctx,
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
@@ -120,11 +142,13 @@ UA_Openssl_Random_Key_PSHA1_Derive(const UA_ByteString *secret,
 UA_StatusCode
 UA_OpenSSL_HMAC_SHA1_Verify(const UA_ByteString *message,
                             const UA_ByteString *key,
+                            UA_OpenSSL_SymContext *ctx,
                             const UA_ByteString *signature);
 
 UA_StatusCode
 UA_OpenSSL_HMAC_SHA1_Sign(const UA_ByteString *message,
                           const UA_ByteString *key,
+                          UA_OpenSSL_SymContext *ctx,
                           UA_ByteString *signature);
 
 UA_StatusCode
@@ -139,11 +163,13 @@ UA_Openssl_RSA_PKCS1_V15_Encrypt(UA_ByteString *data,
 UA_StatusCode
 UA_OpenSSL_AES_128_CBC_Decrypt(const UA_ByteString *iv,
                                const UA_ByteString *key,
+                               UA_OpenSSL_SymContext *ctx,
                                UA_ByteString *data  /* [in/out]*/);
 
 UA_StatusCode
 UA_OpenSSL_AES_128_CBC_Encrypt(const UA_ByteString *iv,
                                const UA_ByteString *key,
+                               UA_OpenSSL_SymContext *ctx,
                                UA_ByteString *data  /* [in/out]*/);
 
 EVP_PKEY *
@@ -41,6 +41,8 @@ typedef struct {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymContext;
+    UA_OpenSSL_SymContext remoteSymContext;
 
     Policy_Context_Aes128Sha256RsaOaep *policyContext;
     UA_ByteString remoteCertificate;
@@ -175,6 +177,8 @@ UA_ChannelModule_Aes128Sha256RsaOaep_New_Context(const UA_SecurityPolicy *securi
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymContext, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymContext, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval =
         UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
@@ -218,6 +222,8 @@ UA_ChannelModule_Aes128Sha256RsaOaep_Delete_Context(void *channelContext) {
         UA_ByteString_clear(&cc->remoteSymSigningKey);
         UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear(&cc->localSymContext);
+        UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
 
         UA_LOG_INFO(
             cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
@@ -376,6 +382,7 @@ UA_ChannelModule_Aes128Sha256RsaOaep_setLocalSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymSigningKey);
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
@@ -387,6 +394,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setLocalSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
@@ -426,6 +434,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setRemoteSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
@@ -437,6 +446,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setRemoteSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
@@ -487,7 +497,8 @@ UA_SymSig_Aes128Sha256RsaOaep_verify(void *channelContext, const UA_ByteString *
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey,
+                                         &cc->remoteSymContext, signature);
 }
 
 static UA_StatusCode
@@ -499,7 +510,8 @@ UA_SymSig_Aes128Sha256RsaOaep_sign(void *channelContext, const UA_ByteString *me
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey,
+                                       &cc->localSymContext, signature);
 }
 
 static size_t
@@ -514,6 +526,7 @@ UA_SymEn_Aes128Sha256RsaOaep_decrypt(void *channelContext, UA_ByteString *data)
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
     return UA_OpenSSL_AES_128_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+                                          &cc->remoteSymContext,
                                           data);
 }
 
@@ -525,6 +538,7 @@ UA_SymEn_Aes128Sha256RsaOaep_encrypt(void *channelContext, UA_ByteString *data)
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
     return UA_OpenSSL_AES_128_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
+                                          &cc->localSymContext,
                                           data);
 }
 
@@ -569,6 +583,7 @@ UA_SecurityPolicy_Aes128Sha256RsaOaep(UA_SecurityPolicy *policy,
     UA_Openssl_Init();
     memset(policy, 0, sizeof(UA_SecurityPolicy));
     policy->logger = logger;
+    policy->threadSafe = true; /* Only per-channel crypto contexts */
     policy->policyUri =
         UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#Aes128_Sha256_RsaOaep\0");
 
@@ -41,6 +41,8 @@ typedef struct {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymContext;
+    UA_OpenSSL_SymContext remoteSymContext;
 
     Policy_Context_Aes256Sha256RsaPss *policyContext;
     UA_ByteString remoteCertificate;
@@ -126,6 +128,8 @@ UA_ChannelModule_Aes256Sha256RsaPss_New_Context(const UA_SecurityPolicy *securit
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymContext, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymContext, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval =
         UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
@@ -169,6 +173,8 @@ UA_ChannelModule_Aes256Sha256RsaPss_Delete_Context(void *channelContext) {
         UA_ByteString_clear(&cc->remoteSymSigningKey);
         UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear(&cc->localSymContext);
+        UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
 
         UA_LOG_INFO(
             cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
@@ -376,6 +382,7 @@ UA_ChannelModule_Aes256Sha256RsaPss_setLocalSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymSigningKey);
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
@@ -387,6 +394,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setLocalSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
@@ -426,6 +434,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setRemoteSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
@@ -437,6 +446,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setRemoteSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
@@ -489,7 +499,8 @@ UA_SymSig_Aes256Sha256RsaPss_verify(void *channelContext, const UA_ByteString *m
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey,
+                                         &cc->remoteSymContext, signature);
 }
 
 static UA_StatusCode
@@ -501,7 +512,8 @@ UA_SymSig_Aes256Sha256RsaPss_sign(void *channelContext, const UA_ByteString *mes
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey,
+                                       &cc->localSymContext, signature);
 }
 
 static size_t
@@ -516,6 +528,7 @@ UA_SymEn_Aes256Sha256RsaPss_decrypt(void *channelContext, UA_ByteString *data) {
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
     return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+                                          &cc->remoteSymContext,
                                           data);
 }
 
@@ -527,6 +540,7 @@ UA_SymEn_Aes256Sha256RsaPss_encrypt(void *channelContext, UA_ByteString *data) {
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
     return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
+                                          &cc->localSymContext,
                                           data);
 }
 
@@ -573,6 +587,7 @@ UA_SecurityPolicy_Aes256Sha256RsaPss(UA_SecurityPolicy *policy,
     UA_Openssl_Init();
     memset(policy, 0, sizeof(UA_SecurityPolicy));
     policy->logger = logger;
+    policy->threadSafe = true; /* Only per-channel crypto contexts */
     policy->policyUri =
         UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#Aes256_Sha256_RsaPss\0");
 
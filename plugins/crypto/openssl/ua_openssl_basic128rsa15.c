@@ -37,6 +37,8 @@ typedef struct {
     UA_ByteString             remoteSymSigningKey;
     UA_ByteString             remoteSymEncryptingKey;
     UA_ByteString             remoteSymIv;
+    UA_OpenSSL_SymContext     localSymContext;
+    UA_OpenSSL_SymContext     remoteSymContext;
 
     Policy_Context_Basic128Rsa15 * policyContext;
     UA_ByteString             remoteCertificate;
@@ -168,6 +170,8 @@ UA_ChannelModule_Basic128Rsa15_New_Context (const UA_SecurityPolicy * securityPo
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymContext, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymContext, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval = UA_copyCertificate (&context->remoteCertificate,
                                                remoteCertificate);
@@ -211,6 +215,8 @@ UA_ChannelModule_Basic128Rsa15_Delete_Context (void * channelContext) {
         UA_ByteString_clear (&cc->remoteSymSigningKey);
         UA_ByteString_clear (&cc->remoteSymEncryptingKey);
         UA_ByteString_clear (&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear (&cc->localSymContext);
+        UA_OpenSSL_SymContext_clear (&cc->remoteSymContext);
         UA_LOG_INFO (cc->policyContext->logger,
                  UA_LOGCATEGORY_SECURITYPOLICY,
                  "The Basic128Rsa15 security policy channel with openssl is deleted.");
@@ -227,6 +233,7 @@ UA_ChannelModule_Basic128Rsa15_setLocalSymSigningKey (void *                chan
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymSigningKey);
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
@@ -239,6 +246,7 @@ UA_ChannelModule_Basic128Rsa15_setLocalSymEncryptingKey (void *                c
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
@@ -263,6 +271,7 @@ UA_ChannelModule_Basic128Rsa15_setRemoteSymSigningKey (void *                cha
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
@@ -275,6 +284,7 @@ UA_ChannelModule_Basic128Rsa15_setRemoteSymEncryptingKey (void *
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
@@ -495,7 +505,8 @@ UA_SymEn_Basic128Rsa15_Encrypt (void *channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_AES_128_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_AES_128_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey,
+                                           &cc->localSymContext, data);
 }
 
 static UA_StatusCode
@@ -504,7 +515,8 @@ UA_SymEn_Basic128Rsa15_Decrypt (void *                    channelContext,
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_AES_128_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_AES_128_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+                                           &cc->remoteSymContext, data);
 }
 
 static size_t
@@ -527,6 +539,7 @@ UA_SymSig_Basic128Rsa15_Verify (void *                    channelContext,
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
     return UA_OpenSSL_HMAC_SHA1_Verify (message,
                                         &cc->remoteSymSigningKey,
+                                        &cc->remoteSymContext,
                                         signature);
 }
 
@@ -538,7 +551,8 @@ UA_SymSig_Basic128Rsa15_Sign (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey,
+                                      &cc->localSymContext, signature);
 }
 
 /* the main entry of Basic128Rsa15 */
@@ -560,6 +574,7 @@ UA_SecurityPolicy_Basic128Rsa15 (UA_SecurityPolicy * policy,
     UA_Openssl_Init ();
     memset(policy, 0, sizeof(UA_SecurityPolicy));
     policy->logger = logger;
+    policy->threadSafe = true; /* Only per-channel crypto contexts */
     policy->policyUri = UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#Basic128Rsa15\0");
 
     /* set ChannelModule context  */
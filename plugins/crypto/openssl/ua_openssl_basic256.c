@@ -35,6 +35,8 @@ typedef struct {
     UA_ByteString             remoteSymSigningKey;
     UA_ByteString             remoteSymEncryptingKey;
     UA_ByteString             remoteSymIv;
+    UA_OpenSSL_SymContext     localSymContext;
+    UA_OpenSSL_SymContext     remoteSymContext;
 
     Policy_Context_Basic256 * policyContext;
     UA_ByteString             remoteCertificate;
@@ -166,6 +168,8 @@ UA_ChannelModule_Basic256_New_Context (const UA_SecurityPolicy * securityPolicy,
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymContext, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymContext, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval = UA_copyCertificate (&context->remoteCertificate,
                                                remoteCertificate);
@@ -209,6 +213,8 @@ UA_ChannelModule_Basic256_Delete_Context (void * channelContext) {
         UA_ByteString_clear (&cc->remoteSymSigningKey);
         UA_ByteString_clear (&cc->remoteSymEncryptingKey);
         UA_ByteString_clear (&cc->remoteSymIv);
+        UA_OpenSSL_SymContext_clear (&cc->localSymContext);
+        UA_OpenSSL_SymContext_clear (&cc->remoteSymContext);
         UA_LOG_INFO (cc->policyContext->logger,
                  UA_LOGCATEGORY_SECURITYPOLICY,
                  "The basic256 security policy channel with openssl is deleted.");
@@ -253,6 +259,7 @@ UA_ChannelModule_Basic256_setLocalSymSigningKey (void *                channelCo
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymSigningKey);
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
@@ -265,6 +272,7 @@ UA_ChannelModule_Basic256_setLocalSymEncryptingKey (void *                channe
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
@@ -289,6 +297,7 @@ UA_ChannelModule_Basic256_setRemoteSymSigningKey (void *                channelC
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
@@ -301,6 +310,7 @@ UA_ChannelModule_Basic256_setRemoteSymEncryptingKey (void *                chann
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
@@ -496,7 +506,8 @@ UA_SymEn_Basic256_Encrypt (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_AES_256_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey,
+                                           &cc->localSymContext, data);
 }
 
 static UA_StatusCode
@@ -505,7 +516,8 @@ UA_SymEn_Basic256_Decrypt (void *                    channelContext,
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_AES_256_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
+                                           &cc->remoteSymContext, data);
 }
 
 static size_t
@@ -529,6 +541,7 @@ UA_SymSig_Basic256_Verify (void *                    channelContext,
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
     return UA_OpenSSL_HMAC_SHA1_Verify (message,
                                         &cc->remoteSymSigningKey,
+                                        &cc->remoteSymContext,
                                         signature);
 }
 
@@ -540,7 +553,8 @@ UA_SymSig_Basic256_Sign (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey,
+                                      &cc->localSymContext, signature);
 }
 
 /* the main entry of Basic256 */
@@ -561,6 +575,7 @@ UA_SecurityPolicy_Basic256 (UA_SecurityPolicy * policy,
     UA_Openssl_Init ();
     memset(policy, 0, sizeof(UA_SecurityPolicy));
     policy->logger = logger;
+    policy->threadSafe = true; /* Only per-channel crypto contexts */
     policy->policyUri = UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#Basic256\0");
 
     /* set ChannelModule context  */
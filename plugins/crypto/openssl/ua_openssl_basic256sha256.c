@@ -42,6 +42,8 @@ typedef struct {
     UA_ByteString remoteSymSigningKey;
     UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
+    UA_OpenSSL_SymContext localSymContext;
+    UA_OpenSSL_SymContext remoteSymContext;
 
     Policy_Context_Basic256Sha256 *policyContext;
     UA_ByteString remoteCertificate;
@@ -165,6 +167,8 @@ UA_ChannelModule_New_Context(const UA_SecurityPolicy * securityPolicy,
     UA_ByteString_init(&context->remoteSymSigningKey);
     UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
+    memset(&context->localSymContext, 0, sizeof(UA_OpenSSL_SymContext));
+    memset(&context->remoteSymContext, 0, sizeof(UA_OpenSSL_SymContext));
 
     UA_StatusCode retval =
         UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
@@ -207,6 +211,8 @@ UA_ChannelModule_Delete_Context(void * channelContext) {
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     UA_ByteString_clear(&cc->remoteSymIv);
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
 
     UA_LOG_INFO(cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
                 "The basic256sha256 security policy channel with openssl is deleted.");
@@ -359,6 +365,7 @@ UA_ChannelModule_Basic256Sha256_setLocalSymSigningKey(void * channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymSigningKey);
     return UA_ByteString_copy(key, &cc->localSymSigningKey);
 }
@@ -369,6 +376,7 @@ UA_ChannelM_Basic256Sha256_setLocalSymEncryptingKey(void * channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->localSymContext);
     UA_ByteString_clear(&cc->localSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
 }
@@ -406,6 +414,7 @@ UA_ChannelM_Basic256Sha256_setRemoteSymSigningKey(void *channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymSigningKey);
     return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
 }
@@ -416,6 +425,7 @@ UA_ChannelM_Basic256Sha256_setRemoteSymEncryptingKey(void *channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
+    UA_OpenSSL_SymContext_clear(&cc->remoteSymContext);
     UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
 }
@@ -462,7 +472,8 @@ UA_SymSig_Basic256Sha256_verify(void *channelContext, const UA_ByteString *messa
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey,
+                                         &cc->remoteSymContext, signature);
 }
 
 static UA_StatusCode
@@ -472,7 +483,8 @@ UA_SymSig_Basic256Sha256_sign(void *channelContext, const UA_ByteString *message
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey,
+                                       &cc->localSymContext, signature);
 }
 
 static size_t
@@ -486,7 +498,8 @@ UA_SymEn_Basic256Sha256_decrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
     return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymIv,
-                                          &cc->remoteSymEncryptingKey, data);
+                                          &cc->remoteSymEncryptingKey,
+                                          &cc->remoteSymContext, data);
 }
 
 static UA_StatusCode
@@ -495,7 +508,8 @@ UA_SymEn_Basic256Sha256_encrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
+                                          &cc->localSymContext, data);
 }
 
 static UA_StatusCode
@@ -538,6 +552,7 @@ UA_SecurityPolicy_Basic256Sha256(UA_SecurityPolicy *policy,
     UA_Openssl_Init();
     memset(policy, 0, sizeof(UA_SecurityPolicy));
     policy->logger = logger;
+    policy->threadSafe = true; /* Only per-channel crypto contexts */
     policy->policyUri =
         UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256\0");
 
@@ -41,5 +41,10 @@
 #define get_error_line_data(pFile, pLine, pData, pFlags) ERR_get_error_all(pFile, pLine, NULL, pData, pFlags)
 #endif
 
+/* The HMAC_CTX API is deprecated since OpenSSL 3.0. Use EVP_MAC instead. */
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define UA_OPENSSL_EVP_MAC
+#endif
+
 #endif /* defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL) */
 #endif /* UA_OPENSSL_VERSION_ABSTRACTION_H_ */
@@ -495,6 +495,8 @@ setDefaultConfig(UA_ServerConfig *conf, UA_UInt16 portNumber) {
 #if UA_MULTITHREADING >= 100
     conf->maxAsyncOperationQueueSize = 0;
     conf->asyncOperationTimeout = 120000; /* Async Operation Timeout in ms (2 minutes) */
+    conf->maxParallelOperationThreads = 0; /* Disabled */
+    conf->minParallelOperations = 1000;
 #endif
 
 #ifdef UA_ENABLE_PUBSUB
@@ -0,0 +1,76 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#ifndef UA_NODESTORE_COMMON_H_
+#define UA_NODESTORE_COMMON_H_
+
+#include <open62541/types.h>
+
+_UA_BEGIN_DECLS
+
+/* Reference counting of the Nodestore entries. The entry is cleaned up (deleted
+ * or its references optimized) when the last consumer releases it.
+ *
+ * With multithreading, nodes can be retrieved concurrently from worker threads
+ * while the server is locked (see the parallel service operations). Then the
+ * refCount is modified atomically. The highest bit is set while the entry is
+ * cleaned up. Concurrent readers wait until the cleanup is done.
+ *
+ * UA_NodestoreRefCount_release returns whether the caller has to clean up the
+ * entry. Afterwards, UA_NodestoreRefCount_cleanupDone unblocks the waiting
+ * readers. Except if the entry was deleted. There are no concurrent readers
+ * for removed entries. */
+
+#if UA_MULTITHREADING >= 100 && defined(__GNUC__)
+
+#define UA_NODESTORE_REFCOUNT_CLEANUP 0x8000
+
+static UA_INLINE void
+UA_NodestoreRefCount_acquire(UA_UInt16 *refCount) {
+    UA_UInt16 rc = __atomic_add_fetch(refCount, 1, __ATOMIC_ACQ_REL);
+    while(rc & UA_NODESTORE_REFCOUNT_CLEANUP)
+        rc = __atomic_load_n(refCount, __ATOMIC_ACQUIRE);
+}
+
+static UA_INLINE UA_Boolean
+UA_NodestoreRefCount_release(UA_UInt16 *refCount) {
+    if(__atomic_sub_fetch(refCount, 1, __ATOMIC_ACQ_REL) != 0)
+        return false;
+    UA_UInt16 expected = 0;
+    /* Fails if retrieved again in the meantime */
+    return __atomic_compare_exchange_n(refCount, &expected,
+                                       UA_NODESTORE_REFCOUNT_CLEANUP, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static UA_INLINE void
+UA_NodestoreRefCount_cleanupDone(UA_UInt16 *refCount) {
+    __atomic_and_fetch(refCount, (UA_UInt16)~UA_NODESTORE_REFCOUNT_CLEANUP,
+                       __ATOMIC_RELEASE);
+}
+
+#else
+
+static UA_INLINE void
+UA_NodestoreRefCount_acquire(UA_UInt16 *refCount) {
+    ++(*refCount);
+}
+
+static UA_INLINE UA_Boolean
+UA_NodestoreRefCount_release(UA_UInt16 *refCount) {
+    UA_assert(*refCount > 0);
+    --(*refCount);
+    return (*refCount == 0);
+}
+
+static UA_INLINE void
+UA_NodestoreRefCount_cleanupDone(UA_UInt16 *refCount) {
+    (void)refCount;
+}
+
+#endif
+
+_UA_END_DECLS
+
+#endif /* UA_NODESTORE_COMMON_H_ */
@@ -8,6 +8,7 @@
 
 #include <open62541/util.h>
 #include <open62541/plugin/nodestore_default.h>
+#include "ua_nodestore_common.h"
 
 #ifndef container_of
 #define container_of(ptr, type, member) \
@@ -45,8 +46,33 @@ typedef struct {
     /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
     UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
     UA_Byte referenceTypeCounter;
+
+    /* Operation counters. The remaining fields are computed on demand. */
+    UA_NodestoreStatistics stats;
 } UA_NodeMap;
 
+/* The lookup counters are only updated with UA_ENABLE_NODESTORE_STATISTICS.
+ * Nodes are retrieved concurrently from worker threads with multithreading
+ * (see below). Count with relaxed atomics then. Without atomics the lookups
+ * are not counted. The other counters are only modified by the thread holding
+ * the server lock. */
+#ifndef UA_ENABLE_NODESTORE_STATISTICS
+# define UA_NODEMAP_COUNT(counter)
+#elif UA_MULTITHREADING < 100
+# define UA_NODEMAP_COUNT(counter) (counter)++
+#elif defined(__GNUC__) /* GCC/Clang */
+# define UA_NODEMAP_COUNT(counter) \
+    __atomic_fetch_add(&(counter), 1, __ATOMIC_RELAXED)
+#elif defined(_WIN32) && defined(_WIN64) /* Visual Studio, size_t is 64bit */
+# define UA_NODEMAP_COUNT(counter) \
+    InterlockedIncrement64((volatile LONG64*)&(counter))
+#elif defined(_WIN32)
+# define UA_NODEMAP_COUNT(counter) \
+    InterlockedIncrement((volatile LONG*)&(counter))
+#else
+# define UA_NODEMAP_COUNT(counter)
+#endif
+
 /*********************/
 /* HashMap Utilities */
 /*********************/
@@ -148,37 +174,37 @@ expand(UA_NodeMap *ns) {
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_NodeMapEntry *
-createEntry(UA_NodeClass nodeClass) {
+/* Returns zero for an unknown NodeClass */
+static size_t
+entrySize(UA_NodeClass nodeClass) {
     size_t size = sizeof(UA_NodeMapEntry) - sizeof(UA_Node);
     switch(nodeClass) {
     case UA_NODECLASS_OBJECT:
-        size += sizeof(UA_ObjectNode);
-        break;
+        return size + sizeof(UA_ObjectNode);
     case UA_NODECLASS_VARIABLE:
-        size += sizeof(UA_VariableNode);
-        break;
+        return size + sizeof(UA_VariableNode);
     case UA_NODECLASS_METHOD:
-        size += sizeof(UA_MethodNode);
-        break;
+        return size + sizeof(UA_MethodNode);
     case UA_NODECLASS_OBJECTTYPE:
-        size += sizeof(UA_ObjectTypeNode);
-        break;
+        return size + sizeof(UA_ObjectTypeNode);
     case UA_NODECLASS_VARIABLETYPE:
-        size += sizeof(UA_VariableTypeNode);
-        break;
+        return size + sizeof(UA_VariableTypeNode);
     case UA_NODECLASS_REFERENCETYPE:
-        size += sizeof(UA_ReferenceTypeNode);
-        break;
+        return size + sizeof(UA_ReferenceTypeNode);
     case UA_NODECLASS_DATATYPE:
-        size += sizeof(UA_DataTypeNode);
-        break;
+        return size + sizeof(UA_DataTypeNode);
     case UA_NODECLASS_VIEW:
-        size += sizeof(UA_ViewNode);
-        break;
+        return size + sizeof(UA_ViewNode);
     default:
-        return NULL;
+        return 0;
     }
+}
+
+static UA_NodeMapEntry *
+createEntry(UA_NodeClass nodeClass) {
+    size_t size = entrySize(nodeClass);
+    if(size == 0)
+        return NULL;
     UA_NodeMapEntry *entry = (UA_NodeMapEntry*)UA_calloc(1, size);
     if(!entry)
         return NULL;
@@ -192,6 +218,15 @@ deleteNodeMapEntry(UA_NodeMapEntry *entry) {
     UA_free(entry);
 }
 
+static void
+switchNodeMapEntryReferences(UA_NodeMapEntry *entry) {
+    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree && !rk->isCompact)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
 static void
 cleanupNodeMapEntry(UA_NodeMapEntry *entry) {
     if(entry->refCount > 0)
@@ -200,30 +235,64 @@ cleanupNodeMapEntry(UA_NodeMapEntry *entry) {
         deleteNodeMapEntry(entry);
         return;
     }
-    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
-        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
-        if(rk->targetsSize > 16 && !rk->hasRefTree)
-            UA_NodeReferenceKind_switch(rk);
+    switchNodeMapEntryReferences(entry);
+}
+
+static void
+acquireNodeMapEntry(UA_NodeMapEntry *entry) {
+    UA_NodestoreRefCount_acquire(&entry->refCount);
+}
+
+static void
+releaseNodeMapEntry(UA_NodeMapEntry *entry) {
+    if(!UA_NodestoreRefCount_release(&entry->refCount))
+        return;
+    if(entry->deleted) {
+        deleteNodeMapEntry(entry);
+        return;
     }
+    switchNodeMapEntryReferences(entry);
+    UA_NodestoreRefCount_cleanupDone(&entry->refCount);
+}
+
+/* Bucket i counts the lookups with 2^(i-1) < probes <= 2^i */
+static void
+countProbes(UA_NodeMap *ns, UA_UInt32 probes) {
+#ifdef UA_ENABLE_NODESTORE_STATISTICS
+    size_t bucket = 0;
+    for(probes--; probes > 0 && bucket < UA_NODESTORE_PROBEHISTOGRAMSIZE - 1;
+        probes >>= 1)
+        bucket++;
+    UA_NODEMAP_COUNT(ns->stats.probeHistogram[bucket]);
+#else
+    (void)ns;
+    (void)probes;
+#endif
 }
 
 static UA_NodeMapSlot *
-findOccupiedSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
+findOccupiedSlot(UA_NodeMap *ns, const UA_NodeId *nodeid) {
     UA_UInt32 h = UA_NodeId_hash(nodeid);
     UA_UInt32 size = ns->size;
     UA_UInt64 idx = mod(h, size); /* Use 64bit container to avoid overflow */
     UA_UInt32 hash2 = mod2(h, size);
     UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_UInt32 probes = 0;
 
     do {
+        probes++;
         UA_NodeMapSlot *slot= &ns->slots[(UA_UInt32)idx];
         if(slot->entry > UA_NODEMAP_TOMBSTONE) {
             if(slot->nodeIdHash == h &&
-               UA_NodeId_equal(&slot->entry->node.head.nodeId, nodeid))
+               UA_NodeId_equal(&slot->entry->node.head.nodeId, nodeid)) {
+                countProbes(ns, probes);
                 return slot;
+            }
         } else {
-            if(slot->entry == NULL)
+            if(slot->entry == NULL) {
+                countProbes(ns, probes);
                 return NULL; /* No further entry possible */
+            }
         }
 
         idx += hash2;
@@ -231,6 +300,7 @@ findOccupiedSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
             idx -= size;
     } while((UA_UInt32)idx != startIdx);
 
+    countProbes(ns, probes);
     return NULL;
 }
 
@@ -259,10 +329,11 @@ UA_NodeMap_getNode(void *context, const UA_NodeId *nodeid,
                    UA_ReferenceTypeSet references,
                    UA_BrowseDirection referenceDirections) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
+    UA_NODEMAP_COUNT(ns->stats.getCount);
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
     if(!slot)
         return NULL;
-    ++slot->entry->refCount;
+    acquireNodeMapEntry(slot->entry);
     return &slot->entry->node;
 }
 
@@ -283,15 +354,14 @@ UA_NodeMap_releaseNode(void *context, const UA_Node *node) {
         return;
     UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
     UA_assert(&entry->node == node);
-    UA_assert(entry->refCount > 0);
-    --entry->refCount;
-    cleanupNodeMapEntry(entry);
+    releaseNodeMapEntry(entry);
 }
 
 static UA_StatusCode
 UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
                        UA_Node **outNode) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
+    UA_NODEMAP_COUNT(ns->stats.copyCount);
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
     if(!slot)
         return UA_STATUSCODE_BADNODEIDUNKNOWN;
@@ -321,6 +391,7 @@ UA_NodeMap_removeNode(void *context, const UA_NodeId *nodeid) {
     entry->deleted = true;
     cleanupNodeMapEntry(entry);
     --ns->count;
+    ns->stats.removeCount++;
     /* Downsize the hashmap if it is very empty */
     if(ns->count * 8 < ns->size && ns->size > UA_NODEMAP_MINSIZE)
         expand(ns); /* Can fail. Just continue with the bigger hashmap. */
@@ -420,6 +491,7 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
     slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
     slot->entry = newEntry;
     ++ns->count;
+    ns->stats.insertCount++;
     return retval;
 }
 
@@ -438,6 +510,7 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     /* The node was already updated since the copy was made? */
     UA_NodeMapEntry *oldEntry = slot->entry;
     if(oldEntry != newEntry->orig) {
+        ns->stats.replaceConflictCount++;
         deleteNodeMapEntry(newEntry);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
@@ -446,6 +519,7 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     slot->entry = newEntry;
     oldEntry->deleted = true;
     cleanupNodeMapEntry(oldEntry);
+    ns->stats.replaceCount++;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -473,6 +547,35 @@ UA_NodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
     }
 }
 
+/* The NodeClass enum values are single bits */
+static size_t
+nodeClassIndex(UA_NodeClass nodeClass) {
+    size_t index = 0;
+    for(UA_UInt32 nc = (UA_UInt32)nodeClass; nc > 1; nc >>= 1)
+        index++;
+    return index;
+}
+
+static void
+UA_NodeMap_getStatistics(void *context, UA_NodestoreStatistics *stats) {
+    UA_NodeMap *ns = (UA_NodeMap*)context;
+    *stats = ns->stats;
+    stats->nodeCount = ns->count;
+    stats->capacity = ns->size;
+    for(UA_UInt32 i = 0; i < ns->size; ++i) {
+        UA_NodeMapSlot *slot = &ns->slots[i];
+        if(slot->entry <= UA_NODEMAP_TOMBSTONE)
+            continue;
+        const UA_Node *node = &slot->entry->node;
+        size_t index = nodeClassIndex(node->head.nodeClass);
+        if(index >= UA_NODESTORE_NODECLASSES)
+            continue;
+        stats->nodeClassCount[index]++;
+        stats->nodeClassBytes[index] +=
+            entrySize(node->head.nodeClass) + UA_Node_getMemoryUsage(node);
+    }
+}
+
 static void
 UA_NodeMap_delete(void *context) {
     /* Already cleaned up? */
@@ -516,6 +619,7 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
     }
 
     nodemap->referenceTypeCounter = 0;
+    memset(&nodemap->stats, 0, sizeof(UA_NodestoreStatistics));
 
     /* Populate the nodestore */
     ns->context = nodemap;
@@ -531,5 +635,6 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
     ns->removeNode = UA_NodeMap_removeNode;
     ns->getReferenceTypeId = UA_NodeMap_getReferenceTypeId;
     ns->iterate = UA_NodeMap_iterate;
+    ns->getStatistics = UA_NodeMap_getStatistics;
     return UA_STATUSCODE_GOOD;
 }
@@ -9,6 +9,7 @@
 #include <open62541/types_generated_handling.h>
 #include <open62541/plugin/nodestore_default.h>
 #include "ziptree.h"
+#include "ua_nodestore_common.h"
 
 #ifndef container_of
 #define container_of(ptr, type, member) \
@@ -103,6 +104,16 @@ deleteEntry(NodeEntry *entry) {
     UA_free(entry);
 }
 
+static void
+switchReferences(NodeEntry *entry) {
+    UA_NodeHead *head = (UA_NodeHead*)&entry->nodeId;
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        if(rk->targetsSize > 16 && !rk->hasRefTree && !rk->isCompact)
+            UA_NodeReferenceKind_switch(rk);
+    }
+}
+
 static void
 cleanupEntry(NodeEntry *entry) {
     if(entry->refCount > 0)
@@ -111,12 +122,24 @@ cleanupEntry(NodeEntry *entry) {
         deleteEntry(entry);
         return;
     }
-    UA_NodeHead *head = (UA_NodeHead*)&entry->nodeId;
-    for(size_t i = 0; i < head->referencesSize; i++) {
-        UA_NodeReferenceKind *rk = &head->references[i];
-        if(rk->targetsSize > 16 && !rk->hasRefTree)
-            UA_NodeReferenceKind_switch(rk);
+    switchReferences(entry);
+}
+
+static void
+acquireEntry(NodeEntry *entry) {
+    UA_NodestoreRefCount_acquire(&entry->refCount);
+}
+
+static void
+releaseEntry(NodeEntry *entry) {
+    if(!UA_NodestoreRefCount_release(&entry->refCount))
+        return;
+    if(entry->deleted) {
+        deleteEntry(entry);
+        return;
     }
+    switchReferences(entry);
+    UA_NodestoreRefCount_cleanupDone(&entry->refCount);
 }
 
 /***********************/
@@ -150,7 +173,7 @@ zipNsGetNode(void *nsCtx, const UA_NodeId *nodeId,
     NodeEntry *entry = ZIP_FIND(NodeTree, &ns->root, &dummy);
     if(!entry)
         return NULL;
-    ++entry->refCount;
+    acquireEntry(entry);
     return (const UA_Node*)&entry->nodeId;
 }
 
@@ -171,9 +194,7 @@ zipNsReleaseNode(void *nsCtx, const UA_Node *node) {
     if(!node)
         return;
     NodeEntry *entry = container_of(node, NodeEntry, nodeId);
-    UA_assert(entry->refCount > 0);
-    --entry->refCount;
-    cleanupEntry(entry);
+    releaseEntry(entry);
 }
 
 static UA_StatusCode
@@ -402,6 +423,7 @@ UA_Nodestore_ZipTree(UA_Nodestore *ns) {
     ns->removeNode = zipNsRemoveNode;
     ns->getReferenceTypeId = zipNsGetReferenceTypeId;
     ns->iterate = zipNsIterate;
+    ns->getStatistics = NULL; /* Not implemented */
 
     return UA_STATUSCODE_GOOD;
 }
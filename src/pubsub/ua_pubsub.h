@@ -104,6 +104,96 @@ typedef struct UA_ReaderGroup UA_ReaderGroup;
 struct UA_SecurityGroup;
 typedef struct UA_SecurityGroup UA_SecurityGroup;
 
+struct UA_PublishSchedule;
+typedef struct UA_PublishSchedule UA_PublishSchedule;
+
+/**********************************************/
+/*               Realtime Guard               */
+/**********************************************/
+
+/* Frozen WriterGroups and ReaderGroups with RT_FIXED_SIZE are published and
+ * received without taking the server lock. The guard protects the frozen state
+ * against concurrent changes. The realtime path tries to enter the guard and
+ * takes the normal (locked) path if the guard is not enabled.
+ *
+ * Every change to a guarded component is made with the server lock and
+ * bracketed by _pauseRT and _resumeRT. Pausing disables the guard and waits
+ * until an ongoing realtime path has left. Resuming re-enables the guard if the
+ * component can (still) take the realtime path. Without atomic operations the
+ * guard is never enabled in multithreaded builds. */
+
+#define UA_PUBSUB_RTGUARD_ENABLED 0x01
+#define UA_PUBSUB_RTGUARD_BUSY    0x02
+
+typedef struct {
+    UA_UInt32 state;
+    UA_UInt32 pauseCounter; /* Modified only with the server lock */
+} UA_PubSubRTGuard;
+
+#if UA_MULTITHREADING >= 100 && defined(__GNUC__)
+
+static UA_INLINE UA_Boolean
+UA_PubSubRTGuard_enter(UA_PubSubRTGuard *g) {
+    UA_UInt32 s = __atomic_load_n(&g->state, __ATOMIC_RELAXED);
+    while(s & UA_PUBSUB_RTGUARD_ENABLED) {
+        /* Wait if the realtime path is taken concurrently for the component */
+        if(!(s & UA_PUBSUB_RTGUARD_BUSY) &&
+           __atomic_compare_exchange_n(&g->state, &s, s | UA_PUBSUB_RTGUARD_BUSY,
+                                       true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return true;
+        s = __atomic_load_n(&g->state, __ATOMIC_RELAXED);
+    }
+    return false;
+}
+
+static UA_INLINE void
+UA_PubSubRTGuard_leave(UA_PubSubRTGuard *g) {
+    __atomic_and_fetch(&g->state, (UA_UInt32)~UA_PUBSUB_RTGUARD_BUSY,
+                       __ATOMIC_RELEASE);
+}
+
+static UA_INLINE void
+UA_PubSubRTGuard_disable(UA_PubSubRTGuard *g) {
+    __atomic_and_fetch(&g->state, (UA_UInt32)~UA_PUBSUB_RTGUARD_ENABLED,
+                       __ATOMIC_ACQ_REL);
+    while(__atomic_load_n(&g->state, __ATOMIC_ACQUIRE) & UA_PUBSUB_RTGUARD_BUSY) {}
+}
+
+static UA_INLINE void
+UA_PubSubRTGuard_enable(UA_PubSubRTGuard *g) {
+    __atomic_or_fetch(&g->state, UA_PUBSUB_RTGUARD_ENABLED, __ATOMIC_RELEASE);
+}
+
+#elif UA_MULTITHREADING >= 100
+
+static UA_INLINE UA_Boolean
+UA_PubSubRTGuard_enter(UA_PubSubRTGuard *g) { (void)g; return false; }
+static UA_INLINE void
+UA_PubSubRTGuard_leave(UA_PubSubRTGuard *g) { (void)g; }
+static UA_INLINE void
+UA_PubSubRTGuard_disable(UA_PubSubRTGuard *g) { (void)g; }
+static UA_INLINE void
+UA_PubSubRTGuard_enable(UA_PubSubRTGuard *g) { (void)g; }
+
+#else
+
+static UA_INLINE UA_Boolean
+UA_PubSubRTGuard_enter(UA_PubSubRTGuard *g) {
+    return (g->state & UA_PUBSUB_RTGUARD_ENABLED) != 0;
+}
+static UA_INLINE void
+UA_PubSubRTGuard_leave(UA_PubSubRTGuard *g) { (void)g; }
+static UA_INLINE void
+UA_PubSubRTGuard_disable(UA_PubSubRTGuard *g) {
+    g->state &= (UA_UInt32)~UA_PUBSUB_RTGUARD_ENABLED;
+}
+static UA_INLINE void
+UA_PubSubRTGuard_enable(UA_PubSubRTGuard *g) {
+    g->state |= UA_PUBSUB_RTGUARD_ENABLED;
+}
+
+#endif
+
 /**********************************************/
 /*            PublishedDataSet                */
 /**********************************************/
@@ -211,6 +301,8 @@ typedef struct UA_PubSubConnection {
      * or QoS parameters. In that case a dedicated NetworkCallback is used that
      * takes this ReaderGroup/WriterGroup directly as context. */
     UA_ConnectionManager *cm;
+    UA_Boolean batchSend; /* The cm sends messages with the "more" parameter
+                           * in batches. Set together with the cm. */
     uintptr_t recvChannels[UA_PUBSUB_MAXCHANNELS];
     size_t recvChannelsSize;
     uintptr_t sendChannel;
@@ -218,11 +310,18 @@ typedef struct UA_PubSubConnection {
     size_t writerGroupsSize;
     LIST_HEAD(, UA_WriterGroup) writerGroups;
 
+    /* WriterGroups with the same publishing interval share a schedule */
+    LIST_HEAD(, UA_PublishSchedule) publishSchedules;
+
     size_t readerGroupsSize;
     LIST_HEAD(, UA_ReaderGroup) readerGroups;
 
     UA_UInt16 configurationFreezeCounter;
 
+    /* Received messages are processed without the server lock if all
+     * ReaderGroups are frozen and realtime-capable */
+    UA_PubSubRTGuard rtGuard;
+
     UA_Boolean deleteFlag; /* To be deleted - in addition to the PubSubState */
     UA_DelayedCallback dc; /* For delayed freeing */
 } UA_PubSubConnection;
@@ -264,6 +363,17 @@ UA_PubSubConnection_setPubSubState(UA_Server *server,
                                    UA_PubSubState state,
                                    UA_StatusCode cause);
 
+/* Disable/enable the lock-free processing of received messages */
+void
+UA_PubSubConnection_pauseRT(UA_PubSubConnection *c);
+
+void
+UA_PubSubConnection_resumeRT(UA_PubSubConnection *c);
+
+/* Enable the lock-free processing if possible and not paused */
+void
+UA_PubSubConnection_updateRT(UA_PubSubConnection *c);
+
 #define UA_LOG_CONNECTION_INTERNAL(LOGGER, LEVEL, CONNECTION, MSG, ...) \
     if(UA_LOGLEVEL <= UA_LOGLEVEL_##LEVEL) {                            \
         UA_String idStr = UA_STRING_NULL;                               \
@@ -293,7 +403,6 @@ UA_PubSubConnection_setPubSubState(UA_Server *server,
 /**********************************************/
 
 typedef struct UA_DataSetWriterSample {
-    UA_Boolean valueChanged;
     UA_DataValue value;
 } UA_DataSetWriterSample;
 
@@ -311,6 +420,8 @@ typedef struct UA_DataSetWriter {
     UA_UInt16 deltaFrameCounter; /* count of sent deltaFrames */
     size_t lastSamplesCount;
     UA_DataSetWriterSample *lastSamples;
+    UA_DataSetMessage_DeltaFrameField *deltaFrameFields; /* reused for every
+                                                          * delta frame */
 
     UA_UInt16 actualDataSetMessageSequenceCount;
     UA_Boolean configurationFrozen;
@@ -398,9 +509,12 @@ struct UA_WriterGroup {
     UA_UInt32 writersCount;
 
     UA_UInt64 publishCallbackId; /* registered if != 0 */
+    UA_PublishSchedule *schedule; /* Published with other WriterGroups if set */
     UA_PubSubState state;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
     UA_UInt16 sequenceNumber; /* Increased after every succressuly sent message */
+    size_t jsonMessageSize; /* Size of the last JSON message. Used as the
+                             * initial buffer size for the next message. */
     UA_Boolean configurationFrozen;
     UA_DateTime lastPublishTimeStamp;
 
@@ -410,6 +524,9 @@ struct UA_WriterGroup {
     uintptr_t sendChannel;
     UA_Boolean deleteFlag;
 
+    /* Publish without the server lock if frozen and realtime-capable */
+    UA_PubSubRTGuard rtGuard;
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     UA_UInt32 securityTokenId;
     UA_UInt32 nonceSequenceNumber; /* To be part of the MessageNonce */
@@ -462,6 +579,18 @@ UA_StatusCode
 UA_WriterGroup_setPubSubState(UA_Server *server,
                               UA_WriterGroup *writerGroup,
                               UA_PubSubState targetState);
+
+/* Disable/enable the lock-free publish path */
+void
+UA_WriterGroup_pauseRT(UA_WriterGroup *wg);
+
+void
+UA_WriterGroup_resumeRT(UA_WriterGroup *wg);
+
+/* Enable the lock-free publish path if possible and not paused */
+void
+UA_WriterGroup_updateRT(UA_WriterGroup *wg);
+
 UA_StatusCode
 UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *writerGroup);
 
@@ -477,6 +606,38 @@ UA_StatusCode
 UA_WriterGroup_enableWriterGroup(UA_Server *server,
                                  const UA_NodeId writerGroup);
 
+/* WriterGroups of a PubSubConnection with the same publishing interval are
+ * published from a single cyclic callback of the EventLoop. The server lock is
+ * taken once for all of them. If the ConnectionManager supports batched sending
+ * (UDP with send-batchsize > 1), the NetworkMessages are sent with the "more"
+ * parameter and flushed together at the end of the cycle. The WriterGroups are
+ * published in the order in which they joined the schedule.
+ *
+ * A schedule is created once a second WriterGroup with the same interval
+ * becomes operational. A single WriterGroup keeps its own cyclic callback.
+ * WriterGroups with RT_FIXED_SIZE never join a schedule. They keep their own
+ * callback for the lock-free realtime path. */
+struct UA_PublishSchedule {
+    LIST_ENTRY(UA_PublishSchedule) listEntry;
+    UA_PubSubConnection *connection;
+    UA_Duration interval;
+    UA_UInt64 callbackId;
+
+    UA_WriterGroup **writerGroups;
+    size_t writerGroupsSize;
+    size_t cursor; /* Position while publishing. Adjusted if a WriterGroup is
+                    * removed from the schedule during the cycle. */
+
+    /* Send channels with messages waiting for the batched send. The capacity
+     * of both arrays is the same, each WriterGroup uses one channel. */
+    uintptr_t *pendingChannels;
+    size_t pendingChannelsSize;
+    size_t capacity;
+    UA_Boolean batching;
+
+    UA_DelayedCallback dc; /* For delayed freeing */
+};
+
 #define UA_LOG_WRITERGROUP_INTERNAL(LOGGER, LEVEL, WRITERGROUP, MSG, ...) \
     if(UA_LOGLEVEL <= UA_LOGLEVEL_##LEVEL) {                            \
         UA_String idStr = UA_STRING_NULL;                               \
@@ -552,6 +713,14 @@ typedef struct UA_DataSetReader {
     UA_Boolean configurationFrozen;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
 
+    /* The fields of RT fixed-size messages are decoded with the offsets of the
+     * bufferedMessage directly into the external target values. Without
+     * decoding a NetworkMessage first. The layout of the first received
+     * message (header byte and length) is required for every message. */
+    UA_Boolean directDecoding;
+    UA_Byte directDecodingFlags;
+    size_t directDecodingLength;
+
 #ifdef UA_ENABLE_PUBSUB_MONITORING
     /* MessageReceiveTimeout handling */
     UA_ServerCallback msgRcvTimeoutTimerCallback;
@@ -573,6 +742,20 @@ UA_DataSetReader_checkIdentifier(UA_Server *server, UA_NetworkMessage *msg,
                                  UA_DataSetReader *reader,
                                  UA_ReaderGroupConfig readerGroupConfig);
 
+/* Get the numerical PublisherId as a single key. Returns false for String
+ * PublisherIds. */
+UA_Boolean
+UA_DataSetReader_publisherIdKey(const UA_Variant *publisherId,
+                                UA_PublisherIdType *type, UA_UInt64 *key);
+
+/* Decode the fields of a fixed-size RT message with the offset table of the
+ * reader into the target variables. Returns UA_STATUSCODE_BADNOTFOUND if the
+ * message is not intended for the reader and UA_STATUSCODE_BADTYPEMISMATCH if
+ * the payload does not have the buffered layout (e.g. for delta frames). */
+UA_StatusCode
+UA_DataSetReader_decodeDirect(UA_Server *server, UA_ReaderGroup *rg,
+                              UA_DataSetReader *dsr, const UA_ByteString *buf);
+
 UA_StatusCode
 UA_DataSetReader_create(UA_Server *server, UA_NodeId readerGroupIdentifier,
                         const UA_DataSetReaderConfig *dataSetReaderConfig,
@@ -636,6 +819,16 @@ UA_DataSetReader_setPubSubState(UA_Server *server, UA_DataSetReader *dsr,
 /*                ReaderGroup                 */
 /**********************************************/
 
+/* Entry in the lookup index of the DataSetReaders in a frozen ReaderGroup. The
+ * index is sorted by the identifiers of the expected DataSetMessages. */
+typedef struct {
+    UA_PublisherIdType publisherIdType;
+    UA_UInt64 publisherId;
+    UA_UInt16 writerGroupId;
+    UA_UInt16 dataSetWriterId;
+    UA_DataSetReader *reader;
+} UA_ReaderIndexEntry;
+
 struct UA_ReaderGroup {
     UA_PubSubComponentEnumType componentType;
     UA_ReaderGroupConfig config;
@@ -645,6 +838,11 @@ struct UA_ReaderGroup {
     LIST_HEAD(, UA_DataSetReader) readers;
     UA_UInt32 readersCount;
 
+    /* Built when the configuration is frozen. Not used (NULL) if a reader
+     * has a String PublisherId. */
+    UA_ReaderIndexEntry *readerIndex;
+    size_t readerIndexSize;
+
     UA_PubSubState state;
     UA_Boolean configurationFrozen;
     UA_Boolean hasReceived; /* Received a message since the last _connect */
@@ -717,6 +915,14 @@ UA_Boolean
 UA_ReaderGroup_process(UA_Server *server, UA_ReaderGroup *readerGroup,
                        UA_NetworkMessage *nm);
 
+/* Find the readers for the DataSetMessage with the given DataSetWriterId in the
+ * reader index. Returns false if the index cannot be used. For example if the
+ * NetworkMessage does not contain all identifiers. Otherwise the matching
+ * readers are in the index from position *first to *first + *count - 1. */
+UA_Boolean
+UA_ReaderGroup_findReaders(UA_ReaderGroup *rg, const UA_NetworkMessage *nm,
+                           UA_UInt16 dataSetWriterId, size_t *first, size_t *count);
+
 #define UA_LOG_READERGROUP_INTERNAL(LOGGER, LEVEL, RG, MSG, ...)        \
     if(UA_LOGLEVEL <= UA_LOGLEVEL_##LEVEL) {                            \
         UA_String idStr = UA_STRING_NULL;                               \
@@ -234,22 +234,26 @@ void
 UA_PubSubConnection_delete(UA_Server *server, UA_PubSubConnection *c) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-    /* Stop, unfreeze and delete all WriterGroups attached to the Connection */
+    /* Stop and unfreeze all WriterGroups and ReaderGroups attached to the
+     * Connection. The groups can only be removed once the Connection is no
+     * longer frozen by any of them. */
     UA_WriterGroup *writerGroup, *tmpWriterGroup;
-    LIST_FOREACH_SAFE(writerGroup, &c->writerGroups, listEntry, tmpWriterGroup) {
+    LIST_FOREACH(writerGroup, &c->writerGroups, listEntry) {
         UA_WriterGroup_setPubSubState(server, writerGroup, UA_PUBSUBSTATE_DISABLED);
         UA_WriterGroup_unfreezeConfiguration(server, writerGroup);
-        UA_WriterGroup_remove(server, writerGroup);
     }
-
-    /* Stop, unfreeze and delete all ReaderGroups attached to the Connection */
     UA_ReaderGroup *readerGroup, *tmpReaderGroup;
-    LIST_FOREACH_SAFE(readerGroup, &c->readerGroups, listEntry, tmpReaderGroup) {
+    LIST_FOREACH(readerGroup, &c->readerGroups, listEntry) {
         UA_ReaderGroup_setPubSubState(server, readerGroup, UA_PUBSUBSTATE_DISABLED);
         UA_ReaderGroup_unfreezeConfiguration(server, readerGroup);
-        UA_ReaderGroup_remove(server, readerGroup);
     }
 
+    /* Delete the groups */
+    LIST_FOREACH_SAFE(writerGroup, &c->writerGroups, listEntry, tmpWriterGroup)
+        UA_WriterGroup_remove(server, writerGroup);
+    LIST_FOREACH_SAFE(readerGroup, &c->readerGroups, listEntry, tmpReaderGroup)
+        UA_ReaderGroup_remove(server, readerGroup);
+
     /* Shutting down and  unlinking in the server is done only once */
     if(!c->deleteFlag) {
         UA_PubSubConnection_disconnect(c);
@@ -296,6 +300,8 @@ UA_PubSubConnection_setPubSubState(UA_Server *server, UA_PubSubConnection *c,
                                    UA_PubSubState state, UA_StatusCode cause) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
+    UA_PubSubConnection_pauseRT(c);
+
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
     UA_PubSubState oldState = c->state;
     UA_WriterGroup *writerGroup;
@@ -338,6 +344,7 @@ UA_PubSubConnection_setPubSubState(UA_Server *server, UA_PubSubConnection *c,
         default:
             UA_LOG_WARNING_CONNECTION(&server->config.logger, c,
                                       "Received unknown PubSub state!");
+            UA_PubSubConnection_resumeRT(c);
             return UA_STATUSCODE_BADINTERNALERROR;
     }
 
@@ -349,9 +356,64 @@ UA_PubSubConnection_setPubSubState(UA_Server *server, UA_PubSubConnection *c,
             config->pubSubConfig.stateChangeCallback(server, &c->identifier, state, cause);
         UA_LOCK(&server->serviceMutex);
     }
+
+    UA_PubSubConnection_resumeRT(c);
     return ret;
 }
 
+/* Received messages are processed without the server lock only if all
+ * ReaderGroups of the connection take the realtime path and the processing
+ * cannot change the PubSub state. That is, all ReaderGroups and DataSetReaders
+ * are frozen and operational and the offset buffers are prepared (after the
+ * first received message). */
+static UA_Boolean
+UA_PubSubConnection_canReceiveRT(UA_PubSubConnection *c) {
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+    return false; /* The membuf allocator is not thread-safe */
+#else
+    if(c->state != UA_PUBSUBSTATE_OPERATIONAL || c->readerGroupsSize == 0)
+        return false;
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+        if(!rg->configurationFrozen ||
+           rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE ||
+           rg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP ||
+           rg->state != UA_PUBSUBSTATE_OPERATIONAL)
+            return false;
+        UA_DataSetReader *dsr;
+        LIST_FOREACH(dsr, &rg->readers, listEntry) {
+            if(dsr->state != UA_PUBSUBSTATE_OPERATIONAL ||
+               !dsr->bufferedMessage.nm)
+                return false;
+#ifdef UA_ENABLE_PUBSUB_MONITORING
+            if(dsr->config.messageReceiveTimeout > 0.0)
+                return false; /* Timer handling requires the lock */
+#endif
+        }
+    }
+    return true;
+#endif
+}
+
+void
+UA_PubSubConnection_pauseRT(UA_PubSubConnection *c) {
+    if(c->rtGuard.pauseCounter++ == 0)
+        UA_PubSubRTGuard_disable(&c->rtGuard);
+}
+
+void
+UA_PubSubConnection_resumeRT(UA_PubSubConnection *c) {
+    UA_assert(c->rtGuard.pauseCounter > 0);
+    c->rtGuard.pauseCounter--;
+    UA_PubSubConnection_updateRT(c);
+}
+
+void
+UA_PubSubConnection_updateRT(UA_PubSubConnection *c) {
+    if(c->rtGuard.pauseCounter == 0 && UA_PubSubConnection_canReceiveRT(c))
+        UA_PubSubRTGuard_enable(&c->rtGuard);
+}
+
 UA_EventLoop *
 UA_PubSubConnection_getEL(UA_Server *server, UA_PubSubConnection *c) {
     if(c->config.eventLoop)
@@ -83,11 +83,56 @@ getCM(UA_EventLoop *el, UA_String protocol) {
     return NULL;
 }
 
+/* The lock-free publish path of the WriterGroups reads the ConnectionManager
+ * and the send channel of the PubSubConnection. Pause it while these change. */
+static void
+pauseWriterGroupsRT(UA_PubSubConnection *c) {
+    UA_WriterGroup *wg;
+    LIST_FOREACH(wg, &c->writerGroups, listEntry) {
+        UA_WriterGroup_pauseRT(wg);
+    }
+}
+
+static void
+resumeWriterGroupsRT(UA_PubSubConnection *c) {
+    UA_WriterGroup *wg;
+    LIST_FOREACH(wg, &c->writerGroups, listEntry) {
+        UA_WriterGroup_resumeRT(wg);
+    }
+}
+
+/* Messages are marked with the "more" parameter only if the ConnectionManager
+ * sends them in batches. Otherwise the final flush with an empty message would
+ * be sent out as well. */
+static UA_Boolean
+canBatchSend(UA_ConnectionManager *cm) {
+    UA_String udp = UA_STRING_STATIC("udp");
+    if(!UA_String_equal(&cm->protocol, &udp))
+        return false;
+    const UA_UInt16 *batchSize = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(&cm->eventSource.params,
+                                 UA_QUALIFIEDNAME(0, "send-batchsize"),
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    return (batchSize && *batchSize > 1);
+}
+
+static void
+UA_PubSubConnection_setCM(UA_PubSubConnection *c, UA_ConnectionManager *cm) {
+    if(c->cm == cm)
+        return;
+    pauseWriterGroupsRT(c);
+    c->cm = cm;
+    c->batchSend = canBatchSend(cm);
+    resumeWriterGroupsRT(c);
+}
+
 static void
 UA_PubSubConnection_removeConnection(UA_PubSubConnection *c,
                                      uintptr_t connectionId) {
     if(c->sendChannel == connectionId) {
+        pauseWriterGroupsRT(c);
         c->sendChannel = 0;
+        resumeWriterGroupsRT(c);
         return;
     }
     for(size_t i = 0; i < UA_PUBSUB_MAXCHANNELS; i++) {
@@ -104,7 +149,11 @@ UA_PubSubConnection_addSendConnection(UA_PubSubConnection *c,
                                       uintptr_t connectionId) {
     if(c->sendChannel != 0 && c->sendChannel != connectionId)
         return UA_STATUSCODE_BADINTERNALERROR;
+    if(c->sendChannel == connectionId)
+        return UA_STATUSCODE_GOOD;
+    pauseWriterGroupsRT(c);
     c->sendChannel = connectionId;
+    resumeWriterGroupsRT(c);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -151,6 +200,24 @@ PubSubChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     UA_Server *server = (UA_Server*)application;
     UA_PubSubConnection *psc = (UA_PubSubConnection*)*connectionContext;
 
+    /* Realtime fast path without the server lock. The guard is only enabled if
+     * all ReaderGroups are frozen, operational and take the realtime path. */
+    if(recv && msg.length > 0 && state == UA_CONNECTIONSTATE_ESTABLISHED &&
+       UA_PubSubRTGuard_enter(&psc->rtGuard)) {
+        UA_Boolean processed = false;
+        UA_ReaderGroup *rg;
+        LIST_FOREACH(rg, &psc->readerGroups, listEntry) {
+            processed |= UA_ReaderGroup_decodeAndProcessRT(server, rg, &msg);
+        }
+        UA_PubSubRTGuard_leave(&psc->rtGuard);
+        if(!processed) {
+            UA_LOG_WARNING_CONNECTION(&server->config.logger, psc,
+                                      "Message received that could not be processed. "
+                                      "Check PublisherID, WriterGroupID and DatasetWriterID.");
+        }
+        return;
+    }
+
     UA_LOCK(&server->serviceMutex);
 
     /* The connection is closing in the EventLoop. This is the last callback
@@ -256,6 +323,10 @@ PubSubChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
                                   "Check PublisherID, WriterGroupID and DatasetWriterID.");
     }
 
+    /* The first received message prepares the offset buffers of the realtime
+     * ReaderGroups. Take the lock-free path for the next messages if possible. */
+    UA_PubSubConnection_updateRT(psc);
+
     UA_UNLOCK(&server->serviceMutex);
 }
 
@@ -482,7 +553,7 @@ UA_PubSubConnection_connect(UA_Server *server, UA_PubSubConnection *c,
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    c->cm = cm;
+    UA_PubSubConnection_setCM(c, cm);
     c->json = profile->json;
 
     /* Check the configuration address type */
@@ -525,7 +596,9 @@ WriterGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     if(state == UA_CONNECTIONSTATE_CLOSING) {
         if(wg->sendChannel == connectionId) {
             /* Reset the connection channel */
+            UA_WriterGroup_pauseRT(wg);
             wg->sendChannel = 0;
+            UA_WriterGroup_resumeRT(wg);
 
             /* PSC marked for deletion and the last EventLoop connection has closed */
             if(wg->deleteFlag) {
@@ -553,7 +626,11 @@ WriterGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         UA_UNLOCK(&server->serviceMutex);
         return;
     }
-    wg->sendChannel = connectionId;
+    if(wg->sendChannel != connectionId) {
+        UA_WriterGroup_pauseRT(wg);
+        wg->sendChannel = connectionId;
+        UA_WriterGroup_resumeRT(wg);
+    }
 
     /* Connection open, set to operational if not already done */
     UA_WriterGroup_setPubSubState(server, wg, wg->state);
@@ -709,7 +786,9 @@ UA_WriterGroup_disconnect(UA_WriterGroup *wg) {
         return;
     UA_PubSubConnection *c = wg->linkedConnection;
     c->cm->closeConnection(c->cm, c->sendChannel);
+    UA_WriterGroup_pauseRT(wg);
     wg->sendChannel = 0;
+    UA_WriterGroup_resumeRT(wg);
 }
 
 UA_StatusCode
@@ -749,7 +828,7 @@ UA_WriterGroup_connect(UA_Server *server, UA_WriterGroup *wg, UA_Boolean validat
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    c->cm = cm;
+    UA_PubSubConnection_setCM(c, cm);
     c->json = profile->json;
 
     /* Connect */
@@ -993,7 +1072,7 @@ UA_ReaderGroup_connect(UA_Server *server, UA_ReaderGroup *rg, UA_Boolean validat
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    c->cm = cm;
+    UA_PubSubConnection_setCM(c, cm);
     c->json = profile->json;
 
     /* Connect */
@@ -467,6 +467,101 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
 #endif
 }
 
+/* Sequence lock for the external values of realtime groups. The counter is odd
+ * while an update is ongoing. Readers retry if the counter was odd or has
+ * changed in the meantime. */
+
+#if UA_MULTITHREADING >= 100 && defined(__GNUC__)
+
+void
+UA_PubSub_beginValueUpdate(UA_UInt32 *sequence) {
+    UA_UInt32 s = __atomic_load_n(sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(sequence, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void
+UA_PubSub_endValueUpdate(UA_UInt32 *sequence) {
+    UA_UInt32 s = __atomic_load_n(sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(sequence, s + 1, __ATOMIC_RELEASE);
+}
+
+UA_UInt32
+UA_PubSub_beginValueRead(const UA_UInt32 *sequence) {
+    UA_UInt32 s = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+    while(s & 0x01)
+        s = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+    return s;
+}
+
+UA_Boolean
+UA_PubSub_retryValueRead(const UA_UInt32 *sequence, UA_UInt32 start) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) != start;
+}
+
+#elif UA_MULTITHREADING >= 100 && defined(_WIN32)
+
+/* Visual Studio. MemoryBarrier from the win32 API is a full fence. */
+
+void
+UA_PubSub_beginValueUpdate(UA_UInt32 *sequence) {
+    (*(volatile UA_UInt32*)sequence)++;
+    MemoryBarrier();
+}
+
+void
+UA_PubSub_endValueUpdate(UA_UInt32 *sequence) {
+    MemoryBarrier();
+    (*(volatile UA_UInt32*)sequence)++;
+}
+
+UA_UInt32
+UA_PubSub_beginValueRead(const UA_UInt32 *sequence) {
+    UA_UInt32 s = *(const volatile UA_UInt32*)sequence;
+    while(s & 0x01)
+        s = *(const volatile UA_UInt32*)sequence;
+    MemoryBarrier();
+    return s;
+}
+
+UA_Boolean
+UA_PubSub_retryValueRead(const UA_UInt32 *sequence, UA_UInt32 start) {
+    MemoryBarrier();
+    return *(const volatile UA_UInt32*)sequence != start;
+}
+
+#else
+
+# if UA_MULTITHREADING >= 100
+#  error The sequence lock for the realtime values requires atomic operations
+# endif
+
+void
+UA_PubSub_beginValueUpdate(UA_UInt32 *sequence) {
+    (*(volatile UA_UInt32*)sequence)++;
+}
+
+void
+UA_PubSub_endValueUpdate(UA_UInt32 *sequence) {
+    (*(volatile UA_UInt32*)sequence)++;
+}
+
+UA_UInt32
+UA_PubSub_beginValueRead(const UA_UInt32 *sequence) {
+    UA_UInt32 s = *(const volatile UA_UInt32*)sequence;
+    while(s & 0x01)
+        s = *(const volatile UA_UInt32*)sequence;
+    return s;
+}
+
+UA_Boolean
+UA_PubSub_retryValueRead(const UA_UInt32 *sequence, UA_UInt32 start) {
+    return *(const volatile UA_UInt32*)sequence != start;
+}
+
+#endif
+
 #ifdef UA_ENABLE_PUBSUB_MONITORING
 
 static UA_StatusCode
@@ -59,18 +59,29 @@ static UA_Boolean UA_NetworkMessage_ExtendedFlags2Enabled(const UA_NetworkMessag
 static UA_Boolean UA_DataSetMessageHeader_DataSetFlags2Enabled(const UA_DataSetMessageHeader* src);
 
 UA_StatusCode
-UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer) {
+UA_NetworkMessage_updateBufferedSequenceNumbers(UA_NetworkMessageOffsetBuffer *buffer) {
+    UA_StatusCode rv = UA_STATUSCODE_GOOD;
+    const UA_Byte *bufEnd = &buffer->buffer.data[buffer->buffer.length];
+    for(size_t i = 0; i < buffer->offsetsSize; ++i) {
+        UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
+        if(nmo->contentType != UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER &&
+           nmo->contentType != UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER)
+            continue;
+        UA_Byte *bufPos = &buffer->buffer.data[nmo->offset];
+        rv |= UA_UInt16_encodeBinary(&nmo->content.sequenceNumber, &bufPos, bufEnd);
+        nmo->content.sequenceNumber++;
+    }
+    return rv;
+}
+
+UA_StatusCode
+UA_NetworkMessage_updateBufferedPayload(UA_NetworkMessageOffsetBuffer *buffer) {
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
     const UA_Byte *bufEnd = &buffer->buffer.data[buffer->buffer.length];
     for(size_t i = 0; i < buffer->offsetsSize; ++i) {
         UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
         UA_Byte *bufPos = &buffer->buffer.data[nmo->offset];
         switch(nmo->contentType) {
-            case UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
-            case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
-                rv = UA_UInt16_encodeBinary(&nmo->content.sequenceNumber, &bufPos, bufEnd);
-                nmo->content.sequenceNumber++;
-                break;
             case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
                 rv = UA_DataValue_encodeBinary(&nmo->content.value, &bufPos, bufEnd);
                 break;
@@ -1790,10 +1801,6 @@ UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob) {
         UA_free(nmob->nm);
     }
 
-#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    UA_ByteString_clear(&nmob->encryptBuffer);
-#endif
-
     if(nmob->offsetsSize == 0)
         return;
 
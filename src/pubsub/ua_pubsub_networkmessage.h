@@ -14,6 +14,8 @@
 #include <open62541/plugin/securitypolicy.h>
 #include <open62541/server_pubsub.h>
 
+#include "ua_types_encoding_binary.h"
+
 #ifdef UA_ENABLE_PUBSUB
 
 _UA_BEGIN_DECLS
@@ -212,18 +214,23 @@ typedef struct {
     UA_NetworkMessage *nm; /* The precomputed NetworkMessage for subscriber */
     size_t rawMessageLength;
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    UA_ByteString encryptBuffer; /* The precomputed message buffer is copied
-                                  * into the encrypt buffer for encryption and
-                                  * signing*/
-    UA_Byte *payloadPosition; /* Payload Position of the message to encrypt*/
+    UA_Byte *payloadPosition; /* Payload Position of the message to encrypt.
+                               * The buffer is copied into the network buffer
+                               * and encrypted and signed there in-place. */
 #endif
 } UA_NetworkMessageOffsetBuffer;
 
 void
 UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob);
 
+/* Encode the sequence numbers at their offset and increase them */
+UA_StatusCode
+UA_NetworkMessage_updateBufferedSequenceNumbers(UA_NetworkMessageOffsetBuffer *buffer);
+
+/* Encode the current payload values at their offset. Can be repeated if the
+ * values were changed concurrently. */
 UA_StatusCode
-UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer);
+UA_NetworkMessage_updateBufferedPayload(UA_NetworkMessageOffsetBuffer *buffer);
 
 UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
@@ -330,6 +337,19 @@ UA_NetworkMessage_encodeJson(const UA_NetworkMessage *src,
                              size_t namespaceSize, UA_String *serverUris,
                              size_t serverUriSize, UA_Boolean useReversible);
 
+/* Encodes the NetworkMessage in a single pass. When the end of the buffer is
+ * reached, the exchangeCallback is called to set up the next buffer (see
+ * UA_encodeJsonInternal). Without the exchangeCallback, encoding fails if the
+ * buffer is too small. */
+UA_StatusCode
+UA_NetworkMessage_encodeJsonInternal(const UA_NetworkMessage *src,
+                                     UA_Byte **bufPos, const UA_Byte **bufEnd,
+                                     UA_exchangeEncodeBuffer exchangeCallback,
+                                     void *exchangeHandle,
+                                     UA_String *namespaces, size_t namespaceSize,
+                                     UA_String *serverUris, size_t serverUriSize,
+                                     UA_Boolean useReversible);
+
 size_t
 UA_NetworkMessage_calcSizeJson(const UA_NetworkMessage *src,
                                UA_String *namespaces, size_t namespaceSize,
@@ -213,16 +213,20 @@ UA_NetworkMessage_encodeJson_internal(const UA_NetworkMessage* src, CtxJson *ctx
 }
 
 UA_StatusCode
-UA_NetworkMessage_encodeJson(const UA_NetworkMessage *src,
-                             UA_Byte **bufPos, const UA_Byte **bufEnd,
-                             UA_String *namespaces, size_t namespaceSize,
-                             UA_String *serverUris, size_t serverUriSize,
-                             UA_Boolean useReversible) {
+UA_NetworkMessage_encodeJsonInternal(const UA_NetworkMessage *src,
+                                     UA_Byte **bufPos, const UA_Byte **bufEnd,
+                                     UA_exchangeEncodeBuffer exchangeCallback,
+                                     void *exchangeHandle,
+                                     UA_String *namespaces, size_t namespaceSize,
+                                     UA_String *serverUris, size_t serverUriSize,
+                                     UA_Boolean useReversible) {
     /* Set up the context */
     CtxJson ctx;
     memset(&ctx, 0, sizeof(ctx));
     ctx.pos = *bufPos;
     ctx.end = *bufEnd;
+    ctx.exchangeBufferCallback = exchangeCallback;
+    ctx.exchangeBufferCallbackHandle = exchangeHandle;
     ctx.depth = 0;
     ctx.namespaces = namespaces;
     ctx.namespacesSize = namespaceSize;
@@ -233,11 +237,24 @@ UA_NetworkMessage_encodeJson(const UA_NetworkMessage *src,
 
     status ret = UA_NetworkMessage_encodeJson_internal(src, &ctx);
 
+    /* The buffer might have been exchanged internally */
     *bufPos = ctx.pos;
     *bufEnd = ctx.end;
     return ret;
 }
 
+UA_StatusCode
+UA_NetworkMessage_encodeJson(const UA_NetworkMessage *src,
+                             UA_Byte **bufPos, const UA_Byte **bufEnd,
+                             UA_String *namespaces, size_t namespaceSize,
+                             UA_String *serverUris, size_t serverUriSize,
+                             UA_Boolean useReversible) {
+    return UA_NetworkMessage_encodeJsonInternal(src, bufPos, bufEnd, NULL, NULL,
+                                                namespaces, namespaceSize,
+                                                serverUris, serverUriSize,
+                                                useReversible);
+}
+
 size_t
 UA_NetworkMessage_calcSizeJson(const UA_NetworkMessage *src,
                                UA_String *namespaces, size_t namespaceSize,
@@ -512,16 +529,16 @@ NetworkMessage_decodeJsonInternal(ParseCtx *ctx, UA_NetworkMessage *dst) {
 status
 UA_NetworkMessage_decodeJson(UA_NetworkMessage *dst, const UA_ByteString *src) {
     /* Set up the context */
+    cj5_token tokens[UA_JSON_MAXTOKENCOUNT];
     ParseCtx ctx;
     memset(&ctx, 0, sizeof(ParseCtx));
-    ctx.tokens = (cj5_token*)
-        UA_calloc(UA_JSON_MAXTOKENCOUNT, sizeof(cj5_token));
-    if(!ctx.tokens)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ctx.tokens = tokens;
     status ret = tokenize(&ctx, src, UA_JSON_MAXTOKENCOUNT);
-    if(ret != UA_STATUSCODE_GOOD)
-        return ret;
-    ret = NetworkMessage_decodeJsonInternal(&ctx, dst);
-    UA_free((void*)(uintptr_t)ctx.tokens);
+    if(ret == UA_STATUSCODE_GOOD)
+        ret = NetworkMessage_decodeJsonInternal(&ctx, dst);
+
+    /* Free token array on the heap */
+    if(ctx.tokens != tokens)
+        UA_free((void*)(uintptr_t)ctx.tokens);
     return ret;
 }
@@ -61,6 +61,29 @@ publisherIdIsMatching(UA_NetworkMessage *msg, UA_Variant publisherId) {
     return true;
 }
 
+UA_Boolean
+UA_DataSetReader_publisherIdKey(const UA_Variant *publisherId,
+                                UA_PublisherIdType *type, UA_UInt64 *key) {
+    if(!UA_Variant_isScalar(publisherId))
+        return false;
+    if(publisherId->type == &UA_TYPES[UA_TYPES_BYTE]) {
+        *type = UA_PUBLISHERIDTYPE_BYTE;
+        *key = *(UA_Byte*)publisherId->data;
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_UINT16]) {
+        *type = UA_PUBLISHERIDTYPE_UINT16;
+        *key = *(UA_UInt16*)publisherId->data;
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_UINT32]) {
+        *type = UA_PUBLISHERIDTYPE_UINT32;
+        *key = *(UA_UInt32*)publisherId->data;
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_UINT64]) {
+        *type = UA_PUBLISHERIDTYPE_UINT64;
+        *key = *(UA_UInt64*)publisherId->data;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 UA_StatusCode
 UA_DataSetReader_checkIdentifier(UA_Server *server, UA_NetworkMessage *msg,
                                  UA_DataSetReader *reader,
@@ -551,6 +574,10 @@ UA_DataSetReader_setPubSubState(UA_Server *server, UA_DataSetReader *dsr,
         targetState = UA_PUBSUBSTATE_ERROR;
     }
 
+    UA_PubSubConnection *psc = (rg) ? rg->linkedConnection : NULL;
+    if(psc)
+        UA_PubSubConnection_pauseRT(psc);
+
     UA_PubSubState oldState = dsr->state;
     dsr->state = targetState;
 
@@ -589,6 +616,8 @@ UA_DataSetReader_setPubSubState(UA_Server *server, UA_DataSetReader *dsr,
         }
     }
 
+    if(psc)
+        UA_PubSubConnection_resumeRT(psc);
     return res;
 }
 
@@ -841,6 +870,58 @@ DataSetReader_processRaw(UA_Server *server, UA_ReaderGroup *rg,
     }
 }
 
+/* Write a field into the external value of the target variable (realtime
+ * capable) */
+static void
+DataSetReader_writeFixedSizeField(UA_Server *server, UA_DataSetReader *dsr,
+                                  UA_FieldTargetVariable *tv, UA_DataValue *field) {
+    if(tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE)
+        return;
+
+    if(field->value.type != (*tv->externalDataValue)->value.type) {
+        UA_LOG_WARNING_READER(&server->config.logger, dsr,
+                              "Mismatching type");
+        return;
+    }
+
+    if (tv->beforeWrite) {
+        UA_DataValue *tmp = field;
+        tv->beforeWrite(server,
+                  &dsr->identifier,
+                  &dsr->linkedReaderGroup,
+                  &tv->targetVariable.targetNodeId,
+                  tv->targetVariableContext,
+                  &tmp);
+    }
+    if(UA_LIKELY(tv->externalDataValue != NULL)) {
+        memcpy((**tv->externalDataValue).value.data,
+               field->value.data, field->value.type->memSize);
+    }
+    if(tv->afterWrite)
+        tv->afterWrite(server, &dsr->identifier, &dsr->linkedReaderGroup,
+                    &tv->targetVariable.targetNodeId,
+                    tv->targetVariableContext, tv->externalDataValue);
+}
+
+/* Write a field via the write service (non realtime) */
+static void
+DataSetReader_writeField(UA_Server *server, UA_DataSetReader *dsr,
+                         UA_FieldTargetVariable *tv, const UA_DataValue *field,
+                         size_t index) {
+    UA_WriteValue writeVal;
+    UA_WriteValue_init(&writeVal);
+    writeVal.attributeId = tv->targetVariable.attributeId;
+    writeVal.indexRange = tv->targetVariable.receiverIndexRange;
+    writeVal.nodeId = tv->targetVariable.targetNodeId;
+    writeVal.value = *field;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    Operation_Write(server, &server->adminSession, NULL, &writeVal, &res);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_LOG_INFO_READER(&server->config.logger, dsr,
+                           "Error writing field %u: %s",
+                           (unsigned)index, UA_StatusCode_name(res));
+}
+
 static void
 DataSetReader_processFixedSize(UA_Server *server, UA_ReaderGroup *rg,
                                UA_DataSetReader *dsr, UA_DataSetMessage *msg,
@@ -848,37 +929,39 @@ DataSetReader_processFixedSize(UA_Server *server, UA_ReaderGroup *rg,
     for(size_t i = 0; i < fieldCount; i++) {
         if(!msg->data.keyFrameData.dataSetFields[i].hasValue)
             continue;
+        DataSetReader_writeFixedSizeField(server, dsr,
+            &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i],
+            &msg->data.keyFrameData.dataSetFields[i]);
+    }
+}
 
-        UA_FieldTargetVariable *tv =
-            &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
-        if(tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE)
-            continue;
-
-        if(msg->data.keyFrameData.dataSetFields[i].value.type !=
-           (*tv->externalDataValue)->value.type) {
-            UA_LOG_WARNING_READER(&server->config.logger, dsr,
-                                  "Mismatching type");
+/* Only the changed fields are contained in a delta frame. The other target
+ * variables keep the value of the previous messages. */
+static void
+DataSetReader_processDeltaFrame(UA_Server *server, UA_ReaderGroup *rg,
+                                UA_DataSetReader *dsr, UA_DataSetMessage *msg) {
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    UA_TargetVariables *tvs = &dsr->config.subscribedDataSet.subscribedDataSetTarget;
+    if(tvs->targetVariablesSize < fieldsSize)
+        fieldsSize = tvs->targetVariablesSize;
+
+    UA_DataSetMessage_DataDeltaFrameData *dfd = &msg->data.deltaFrameData;
+    for(size_t i = 0; i < dfd->fieldCount; i++) {
+        UA_DataSetMessage_DeltaFrameField *dff = &dfd->deltaFrameFields[i];
+        if(dff->fieldIndex >= fieldsSize) {
+            UA_LOG_INFO_READER(&server->config.logger, dsr,
+                               "DeltaFrame field index %u out of range",
+                               (unsigned)dff->fieldIndex);
             continue;
         }
+        if(!dff->fieldValue.hasValue)
+            continue;
 
-        if (tv->beforeWrite) {
-            UA_DataValue *tmp = &msg->data.keyFrameData.dataSetFields[i];
-            tv->beforeWrite(server,
-                      &dsr->identifier,
-                      &dsr->linkedReaderGroup,
-                      &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i].targetVariable.targetNodeId,
-                      dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i].targetVariableContext,
-                      &tmp);
-        }
-        if(UA_LIKELY(tv->externalDataValue != NULL)) {
-            memcpy((**tv->externalDataValue).value.data,
-                   msg->data.keyFrameData.dataSetFields[i].value.data,
-                   msg->data.keyFrameData.dataSetFields[i].value.type->memSize);
-        }
-        if(tv->afterWrite)
-            tv->afterWrite(server, &dsr->identifier, &dsr->linkedReaderGroup,
-                        &tv->targetVariable.targetNodeId,
-                        tv->targetVariableContext, tv->externalDataValue);
+        UA_FieldTargetVariable *tv = &tvs->targetVariables[dff->fieldIndex];
+        if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
+            DataSetReader_writeFixedSizeField(server, dsr, tv, &dff->fieldValue);
+        else
+            DataSetReader_writeField(server, dsr, tv, &dff->fieldValue, dff->fieldIndex);
     }
 }
 
@@ -940,15 +1023,39 @@ UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
         return;
     }
 
-    if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME) {
+    if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME &&
+       msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATADELTAFRAME) {
         UA_LOG_WARNING_READER(&server->config.logger, dsr,
-                       "DataSetMessage is discarded: Only keyframes are supported");
+                       "DataSetMessage is discarded: Only keyframes and "
+                       "delta frames are supported");
+        return;
+    }
+
+    /* Concurrent readers of the external target values see either all or none
+     * of the updated fields of the message */
+    UA_UInt32 *sequence = (rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) ?
+        rg->config.rtValueSequence : NULL;
+
+    /* Process delta frame (realtime and non-realtime) */
+    if(msg->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME) {
+        if(sequence)
+            UA_PubSub_beginValueUpdate(sequence);
+        DataSetReader_processDeltaFrame(server, rg, dsr, msg);
+        if(sequence)
+            UA_PubSub_endValueUpdate(sequence);
+#ifdef UA_ENABLE_PUBSUB_MONITORING
+        UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
+#endif
         return;
     }
 
     /* Process message with raw encoding (realtime and non-realtime) */
     if(msg->header.fieldEncoding == UA_FIELDENCODING_RAWDATA) {
+        if(sequence)
+            UA_PubSub_beginValueUpdate(sequence);
         DataSetReader_processRaw(server, rg, dsr, msg);
+        if(sequence)
+            UA_PubSub_endValueUpdate(sequence);
 #ifdef UA_ENABLE_PUBSUB_MONITORING
         UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
 #endif
@@ -966,7 +1073,11 @@ UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
 
     /* Process message with fixed size fields (realtime capable) */
     if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        if(sequence)
+            UA_PubSub_beginValueUpdate(sequence);
         DataSetReader_processFixedSize(server, rg, dsr, msg, fieldCount);
+        if(sequence)
+            UA_PubSub_endValueUpdate(sequence);
 #ifdef UA_ENABLE_PUBSUB_MONITORING
         UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
 #endif
@@ -974,25 +1085,12 @@ UA_DataSetReader_process(UA_Server *server, UA_ReaderGroup *rg,
     }
 
     /* Write the message fields via the write service (non realtime) */
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
     for(size_t i = 0; i < fieldCount; i++) {
         if(!msg->data.keyFrameData.dataSetFields[i].hasValue)
             continue;
-
-        UA_FieldTargetVariable *tv =
-            &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
-
-        UA_WriteValue writeVal;
-        UA_WriteValue_init(&writeVal);
-        writeVal.attributeId = tv->targetVariable.attributeId;
-        writeVal.indexRange = tv->targetVariable.receiverIndexRange;
-        writeVal.nodeId = tv->targetVariable.targetNodeId;
-        writeVal.value = msg->data.keyFrameData.dataSetFields[i];
-        Operation_Write(server, &server->adminSession, NULL, &writeVal, &res);
-        if(res != UA_STATUSCODE_GOOD)
-            UA_LOG_INFO_READER(&server->config.logger, dsr,
-                               "Error writing KeyFrame field %u: %s",
-                               (unsigned)i, UA_StatusCode_name(res));
+        DataSetReader_writeField(server, dsr,
+            &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i],
+            &msg->data.keyFrameData.dataSetFields[i], i);
     }
 
 #ifdef UA_ENABLE_PUBSUB_MONITORING
@@ -1014,6 +1112,11 @@ UA_DataSetReader_checkMessageReceiveTimeout(UA_Server *server,
         UA_DataSetReader_setPubSubState(server, dsr, UA_PUBSUBSTATE_OPERATIONAL);
     }
 
+    /* No timeout configured. Then the lock-free realtime receive path (which
+     * also ends up here) does not touch the timers. */
+    if(dsr->config.messageReceiveTimeout <= 0.0 && !dsr->msgRcvTimeoutTimerRunning)
+        return;
+
     /* Stop message receive timeout timer */
     UA_StatusCode res;
     if(dsr->msgRcvTimeoutTimerRunning) {
@@ -1081,6 +1184,68 @@ UA_DataSetReader_handleMessageReceiveTimeout(UA_Server *server, UA_DataSetReader
  * as a subscriber
  ********************************************************************************/
 
+/* Check if the fields of the message can be decoded directly into the target
+ * variables. This requires a single keyframe DataSetMessage with scalar
+ * numerical fields of the same type as the external target values. */
+static void
+prepareDirectDecoding(UA_Server *server, UA_ReaderGroup *rg, UA_DataSetReader *dsr,
+                      const UA_ByteString *buf) {
+    dsr->directDecoding = false;
+    if(!rg->configurationFrozen || rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
+        return;
+
+    /* Signed and encrypted messages are verified with the decoded headers */
+    if(rg->config.securityMode == UA_MESSAGESECURITYMODE_SIGN ||
+       rg->config.securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
+        return;
+
+    UA_NetworkMessage *nm = dsr->bufferedMessage.nm;
+    UA_DataSetMessage *dsm = nm->payload.dataSetPayload.dataSetMessages;
+    if(!dsm || buf->length == 0)
+        return;
+    if(nm->payloadHeaderEnabled && nm->payloadHeader.dataSetPayloadHeader.count != 1)
+        return;
+    if(!dsm->header.dataSetMessageValid ||
+       dsm->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME)
+        return;
+
+    /* Heartbeats are processed with the decoded message */
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    if(fieldsSize == 0 || fieldsSize !=
+       dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize)
+        return;
+    UA_Boolean raw = (dsm->header.fieldEncoding == UA_FIELDENCODING_RAWDATA);
+    if(!raw && dsm->data.keyFrameData.fieldCount != fieldsSize)
+        return;
+
+    for(size_t i = 0; i < fieldsSize; i++) {
+        UA_FieldTargetVariable *tv =
+            &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
+        if(tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE ||
+           !tv->externalDataValue || !*tv->externalDataValue)
+            return;
+        const UA_Variant *target = &(*tv->externalDataValue)->value;
+        if(!target->type || !UA_Variant_isScalar(target) ||
+           target->type->typeKind > UA_DATATYPEKIND_DOUBLE)
+            return;
+        if(raw) {
+            const UA_DataType *type =
+                UA_findDataTypeWithCustom(&dsr->config.dataSetMetaData.fields[i].dataType,
+                                          server->config.customDataTypes);
+            if(type != target->type)
+                return;
+        } else {
+            const UA_Variant *v = &dsm->data.keyFrameData.dataSetFields[i].value;
+            if(v->type != target->type || !UA_Variant_isScalar(v))
+                return;
+        }
+    }
+
+    dsr->directDecoding = true;
+    dsr->directDecodingFlags = buf->data[0];
+    dsr->directDecodingLength = buf->length;
+}
+
 static UA_StatusCode
 prepareOffsetBuffer(UA_Server *server, UA_ReaderGroup *rg, UA_DataSetReader *reader,
                     UA_ByteString *buf, size_t *pos) {
@@ -1103,6 +1268,16 @@ prepareOffsetBuffer(UA_Server *server, UA_ReaderGroup *rg, UA_DataSetReader *rea
         return rv;
     }
 
+    /* The offset buffer requires the fixed layout of a keyframe. Process a
+     * delta frame right away and wait for the first keyframe. */
+    UA_DataSetMessage *dsm = nm->payload.dataSetPayload.dataSetMessages;
+    if(dsm && dsm->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME) {
+        UA_DataSetReader_process(server, rg, reader, dsm);
+        UA_NetworkMessage_clear(nm);
+        UA_free(nm);
+        return UA_STATUSCODE_GOOD;
+    }
+
     /* Compute and store the offsets necessary to decode */
     size_t nmSize = UA_NetworkMessage_calcSizeBinary(nm, &reader->bufferedMessage);
     if(nmSize == 0) {
@@ -1113,6 +1288,7 @@ prepareOffsetBuffer(UA_Server *server, UA_ReaderGroup *rg, UA_DataSetReader *rea
 
     /* Set the offset buffer in the reader */
     reader->bufferedMessage.nm = nm;
+    prepareDirectDecoding(server, rg, reader, buf);
 
     /* If pre-operational, set to operational after the first message was
      * processed */
@@ -1132,6 +1308,239 @@ prepareOffsetBuffer(UA_Server *server, UA_ReaderGroup *rg, UA_DataSetReader *rea
 /* Realtime Message Processing */
 /*******************************/
 
+/* Check if the DataSetMessage has the type of the buffered message. Delta
+ * frames don't have the fixed layout of the buffered keyframe. Invalid
+ * messages are also left to the decoded path, where they are discarded. */
+static UA_Boolean
+isBufferedMessageType(UA_DataSetReader *dsr, const UA_ByteString *buf) {
+    UA_NetworkMessageOffsetBuffer *ob = &dsr->bufferedMessage;
+    for(size_t i = 0; i < ob->offsetsSize; i++) {
+        if(ob->offsets[i].contentType !=
+           UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_FIELDENCDODING)
+            continue;
+        size_t pos = ob->offsets[i].offset;
+        UA_DataSetMessageHeader header;
+        if(UA_DataSetMessageHeader_decodeBinary(buf, &pos, &header) != UA_STATUSCODE_GOOD)
+            return false;
+        return (header.dataSetMessageValid &&
+                header.dataSetMessageType ==
+                ob->nm->payload.dataSetPayload.dataSetMessages->header.dataSetMessageType);
+    }
+    return true;
+}
+
+/* Decode and process a message without the offset buffer */
+static UA_StatusCode
+decodeAndProcessDeltaFrame(UA_Server *server, UA_ReaderGroup *rg,
+                           UA_DataSetReader *dsr, const UA_ByteString *buf) {
+    size_t pos = 0;
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    UA_StatusCode rv = UA_NetworkMessage_decodeHeaders(buf, &pos, &nm);
+    if(rv == UA_STATUSCODE_GOOD)
+        rv = UA_NetworkMessage_decodePayload(buf, &pos, &nm,
+                                             server->config.customDataTypes,
+                                             &dsr->config.dataSetMetaData);
+    if(rv == UA_STATUSCODE_GOOD)
+        rv = UA_NetworkMessage_decodeFooters(buf, &pos, &nm);
+    if(rv == UA_STATUSCODE_GOOD && nm.payload.dataSetPayload.dataSetMessages)
+        UA_DataSetReader_process(server, rg, dsr,
+                                 nm.payload.dataSetPayload.dataSetMessages);
+    UA_NetworkMessage_clear(&nm);
+    return rv;
+}
+
+/* Decode a scalar field at the position in the buffer and write it into the
+ * external value of the target variable */
+static UA_StatusCode
+decodeDirectField(UA_Server *server, UA_DataSetReader *dsr,
+                  UA_FieldTargetVariable *tv, UA_Boolean raw,
+                  const UA_ByteString *buf, size_t *pos) {
+    UA_DataValue *target = *tv->externalDataValue;
+    const UA_DataType *type = target->value.type;
+    UA_STACKARRAY(UA_Byte, value, type->memSize);
+    UA_StatusCode res = UA_decodeBinaryInternal(buf, pos, value, type, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    if(tv->beforeWrite) {
+        if(raw) {
+            /* Set the raw data as "preview" in the target */
+            void *pData = target->value.data;
+            target->value.data = value;
+            tv->beforeWrite(server, &dsr->identifier, &dsr->linkedReaderGroup,
+                            &tv->targetVariable.targetNodeId,
+                            tv->targetVariableContext, tv->externalDataValue);
+            target->value.data = pData;
+        } else {
+            UA_DataValue tmp;
+            UA_DataValue_init(&tmp);
+            UA_Variant_setScalar(&tmp.value, value, type);
+            tmp.hasValue = true;
+            UA_DataValue *tmpPtr = &tmp;
+            tv->beforeWrite(server, &dsr->identifier, &dsr->linkedReaderGroup,
+                            &tv->targetVariable.targetNodeId,
+                            tv->targetVariableContext, &tmpPtr);
+        }
+    }
+    memcpy(target->value.data, value, type->memSize);
+    if(tv->afterWrite)
+        tv->afterWrite(server, &dsr->identifier, &dsr->linkedReaderGroup,
+                       &tv->targetVariable.targetNodeId,
+                       tv->targetVariableContext, tv->externalDataValue);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_Boolean
+directIdentifierMatches(UA_DataSetReader *dsr, const UA_ByteString *buf) {
+    /* The message has the header layout of the first message */
+    if(buf->length == 0 || buf->data[0] != dsr->directDecodingFlags)
+        return false;
+
+    UA_PublisherIdType idType;
+    UA_UInt64 expectedId = 0;
+    UA_Boolean numericId =
+        UA_DataSetReader_publisherIdKey(&dsr->config.publisherId, &idType, &expectedId);
+
+    UA_NetworkMessageOffsetBuffer *ob = &dsr->bufferedMessage;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < ob->offsetsSize; i++) {
+        size_t pos = ob->offsets[i].offset;
+        UA_UInt16 id16 = 0;
+        switch(ob->offsets[i].contentType) {
+        case UA_PUBSUB_OFFSETTYPE_PUBLISHERID: {
+            if(!numericId || idType != ob->nm->publisherIdType)
+                return false;
+            UA_UInt64 id = 0;
+            switch(idType) {
+            case UA_PUBLISHERIDTYPE_BYTE: {
+                UA_Byte b = 0;
+                res = UA_Byte_decodeBinary(buf, &pos, &b);
+                id = b;
+                break;
+            }
+            case UA_PUBLISHERIDTYPE_UINT16:
+                res = UA_UInt16_decodeBinary(buf, &pos, &id16);
+                id = id16;
+                break;
+            case UA_PUBLISHERIDTYPE_UINT32: {
+                UA_UInt32 id32 = 0;
+                res = UA_UInt32_decodeBinary(buf, &pos, &id32);
+                id = id32;
+                break;
+            }
+            default:
+                res = UA_UInt64_decodeBinary(buf, &pos, &id);
+                break;
+            }
+            if(res != UA_STATUSCODE_GOOD || id != expectedId)
+                return false;
+            break;
+        }
+        case UA_PUBSUB_OFFSETTYPE_WRITERGROUPID:
+            res = UA_UInt16_decodeBinary(buf, &pos, &id16);
+            if(res != UA_STATUSCODE_GOOD || id16 != dsr->config.writerGroupId)
+                return false;
+            break;
+        case UA_PUBSUB_OFFSETTYPE_DATASETWRITERID:
+            res = UA_UInt16_decodeBinary(buf, &pos, &id16);
+            if(res != UA_STATUSCODE_GOOD || id16 != dsr->config.dataSetWriterId)
+                return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+UA_StatusCode
+UA_DataSetReader_decodeDirect(UA_Server *server, UA_ReaderGroup *rg,
+                              UA_DataSetReader *dsr, const UA_ByteString *buf) {
+    if(!directIdentifierMatches(dsr, buf))
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    /* The payload has a different layout (e.g. a delta frame) or the message
+     * is marked as invalid */
+    if(buf->length != dsr->directDecodingLength || !isBufferedMessageType(dsr, buf))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+
+    /* Received a (first) message for the Reader.
+     * Transition from PreOperational to Operational. */
+    if(dsr->state == UA_PUBSUBSTATE_PREOPERATIONAL) {
+        dsr->state = UA_PUBSUBSTATE_OPERATIONAL;
+        UA_ServerConfig *config = &server->config;
+        if(config->pubSubConfig.stateChangeCallback != 0) {
+            config->pubSubConfig.stateChangeCallback(server, &dsr->identifier,
+                                                     dsr->state, UA_STATUSCODE_GOOD);
+        }
+    }
+
+    UA_UInt32 *sequence = rg->config.rtValueSequence;
+    if(sequence)
+        UA_PubSub_beginValueUpdate(sequence);
+
+    /* Decode the fields at the offsets */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_NetworkMessageOffsetBuffer *ob = &dsr->bufferedMessage;
+    UA_FieldTargetVariable *tvs =
+        dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables;
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    size_t field = 0;
+    for(size_t i = 0; i < ob->offsetsSize && res == UA_STATUSCODE_GOOD; i++) {
+        size_t pos = ob->offsets[i].offset;
+        switch(ob->offsets[i].contentType) {
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW:
+            /* The raw fields follow each other without padding */
+            for(; field < fieldsSize && res == UA_STATUSCODE_GOOD; field++)
+                res = decodeDirectField(server, dsr, &tvs[field], true, buf, &pos);
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
+            if(field >= fieldsSize)
+                break;
+            if(ob->offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE) {
+                /* Skip fields without value. The value is encoded right after
+                 * the encoding mask. */
+                if(!(buf->data[pos] & 0x01)) {
+                    field++;
+                    break;
+                }
+                pos++;
+            }
+            /* Scalar Variant of the expected builtin type */
+            if(buf->data[pos] != (UA_Byte)((*tvs[field].externalDataValue)->
+                                           value.type->typeKind + 1)) {
+                UA_LOG_WARNING_READER(&server->config.logger, dsr,
+                                      "Mismatching type");
+                field++;
+                break;
+            }
+            pos++;
+            res = decodeDirectField(server, dsr, &tvs[field], false, buf, &pos);
+            field++;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if(sequence)
+        UA_PubSub_endValueUpdate(sequence);
+
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO_READER(&server->config.logger, dsr,
+                           "PubSub decoding failed. Could not decode with "
+                           "status code %s.", UA_StatusCode_name(res));
+        return res;
+    }
+
+#ifdef UA_ENABLE_PUBSUB_MONITORING
+    UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_Boolean
 UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *readerGroup,
                                   UA_ByteString *buf) {
@@ -1146,6 +1555,18 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *readerGroup
         }
     }
 
+    /* Check the identifiers and decode the fields with the offset table.
+     * Without decoding the NetworkMessage headers first. */
+    if(readerGroup->readersCount == 1) {
+        UA_DataSetReader *first = LIST_FIRST(&readerGroup->readers);
+        if(first->directDecoding) {
+            UA_StatusCode res =
+                UA_DataSetReader_decodeDirect(server, readerGroup, first, buf);
+            if(res != UA_STATUSCODE_BADTYPEMISMATCH)
+                return (res == UA_STATUSCODE_GOOD);
+        }
+    }
+
 #ifdef UA_ENABLE_PUBSUB_BUFMALLOC
     useMembufAlloc();
 #endif
@@ -1221,6 +1642,12 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *readerGroup
             /* This is the first message being received for the RT fastpath.
              * Prepare the offset buffer and set operational. */
             rv = prepareOffsetBuffer(server, readerGroup, dsr, buf, &pos);
+            if(!dsr->bufferedMessage.nm)
+                matches[i - 1] = false; /* Delta frame already processed */
+        } else if(!isBufferedMessageType(dsr, buf)) {
+            /* Delta frames are decoded and processed right away */
+            rv = decodeAndProcessDeltaFrame(server, readerGroup, dsr, buf);
+            matches[i - 1] = false;
         } else {
             /* Decode with offset information and update the networkMessage */
             rv = UA_NetworkMessage_updateBufferedNwMessage(&dsr->bufferedMessage, buf, &pos);
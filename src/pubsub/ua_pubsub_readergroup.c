@@ -291,6 +291,7 @@ UA_ReaderGroup_setPubSubState(UA_Server *server, UA_ReaderGroup *rg,
 
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
     UA_PubSubConnection *connection = rg->linkedConnection;
+    UA_PubSubConnection_pauseRT(connection);
     UA_PubSubState oldState = rg->state;
     rg->state = targetState;
 
@@ -345,6 +346,7 @@ UA_ReaderGroup_setPubSubState(UA_Server *server, UA_ReaderGroup *rg,
         UA_DataSetReader_setPubSubState(server, dsr, dsr->state);
     }
 
+    UA_PubSubConnection_resumeRT(connection);
     return ret;
 }
 
@@ -413,23 +415,30 @@ setReaderGroupEncryptionKeys(UA_Server *server, const UA_NodeId readerGroup,
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* The keys are used by the lock-free receive path */
+    UA_PubSubConnection_pauseRT(rg->linkedConnection);
+
     if(securityTokenId != rg->securityTokenId) {
         rg->securityTokenId = securityTokenId;
         rg->nonceSequenceNumber = 1;
     }
 
-    /* Create a new context */
+    UA_StatusCode res;
     if(!rg->securityPolicyContext) {
-        return rg->config.securityPolicy->
+        /* Create a new context */
+        res = rg->config.securityPolicy->
             newContext(rg->config.securityPolicy->policyContext,
                        &signingKey, &encryptingKey, &keyNonce,
                        &rg->securityPolicyContext);
+    } else {
+        /* Update the context */
+        res = rg->config.securityPolicy->
+            setSecurityKeys(rg->securityPolicyContext, &signingKey,
+                            &encryptingKey, &keyNonce);
     }
 
-    /* Update the context */
-    return rg->config.securityPolicy->
-        setSecurityKeys(rg->securityPolicyContext, &signingKey,
-                        &encryptingKey, &keyNonce);
+    UA_PubSubConnection_resumeRT(rg->linkedConnection);
+    return res;
 }
 
 UA_StatusCode
@@ -448,6 +457,116 @@ UA_Server_setReaderGroupEncryptionKeys(UA_Server *server,
 }
 #endif
 
+/* Lookup index of the DataSetReaders */
+
+static int
+cmpReaderIndexEntry(const void *a, const void *b) {
+    const UA_ReaderIndexEntry *ea = (const UA_ReaderIndexEntry*)a;
+    const UA_ReaderIndexEntry *eb = (const UA_ReaderIndexEntry*)b;
+    if(ea->publisherIdType != eb->publisherIdType)
+        return (ea->publisherIdType < eb->publisherIdType) ? -1 : 1;
+    if(ea->publisherId != eb->publisherId)
+        return (ea->publisherId < eb->publisherId) ? -1 : 1;
+    if(ea->writerGroupId != eb->writerGroupId)
+        return (ea->writerGroupId < eb->writerGroupId) ? -1 : 1;
+    if(ea->dataSetWriterId != eb->dataSetWriterId)
+        return (ea->dataSetWriterId < eb->dataSetWriterId) ? -1 : 1;
+    return 0;
+}
+
+static void
+UA_ReaderGroup_clearReaderIndex(UA_ReaderGroup *rg) {
+    UA_free(rg->readerIndex);
+    rg->readerIndex = NULL;
+    rg->readerIndexSize = 0;
+}
+
+static void
+UA_ReaderGroup_buildReaderIndex(UA_Server *server, UA_ReaderGroup *rg) {
+    UA_ReaderGroup_clearReaderIndex(rg);
+
+    /* The index uses the identifiers from the UADP headers */
+    if(rg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP ||
+       rg->readersCount == 0)
+        return;
+
+    UA_ReaderIndexEntry *index = (UA_ReaderIndexEntry*)
+        UA_calloc(rg->readersCount, sizeof(UA_ReaderIndexEntry));
+    if(!index) {
+        UA_LOG_WARNING_READERGROUP(&server->config.logger, rg,
+                                   "Could not allocate the lookup index for "
+                                   "the DataSetReaders");
+        return;
+    }
+
+    size_t size = 0;
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        UA_ReaderIndexEntry *entry = &index[size];
+        /* String PublisherIds are not indexed. Fall back to testing every
+         * reader for incoming messages. */
+        if(!UA_DataSetReader_publisherIdKey(&dsr->config.publisherId,
+                                            &entry->publisherIdType,
+                                            &entry->publisherId)) {
+            UA_free(index);
+            return;
+        }
+        entry->writerGroupId = dsr->config.writerGroupId;
+        entry->dataSetWriterId = dsr->config.dataSetWriterId;
+        entry->reader = dsr;
+        size++;
+    }
+
+    qsort(index, size, sizeof(UA_ReaderIndexEntry), cmpReaderIndexEntry);
+    rg->readerIndex = index;
+    rg->readerIndexSize = size;
+}
+
+UA_Boolean
+UA_ReaderGroup_findReaders(UA_ReaderGroup *rg, const UA_NetworkMessage *nm,
+                           UA_UInt16 dataSetWriterId, size_t *first, size_t *count) {
+    /* The index can only be used if all identifiers are contained */
+    if(!rg->readerIndex || !nm->publisherIdEnabled || !nm->groupHeaderEnabled ||
+       !nm->groupHeader.writerGroupIdEnabled || !nm->payloadHeaderEnabled)
+        return false;
+
+    UA_ReaderIndexEntry key;
+    key.publisherIdType = nm->publisherIdType;
+    key.writerGroupId = nm->groupHeader.writerGroupId;
+    key.dataSetWriterId = dataSetWriterId;
+    switch(nm->publisherIdType) {
+    case UA_PUBLISHERIDTYPE_BYTE: key.publisherId = nm->publisherId.byte; break;
+    case UA_PUBLISHERIDTYPE_UINT16: key.publisherId = nm->publisherId.uint16; break;
+    case UA_PUBLISHERIDTYPE_UINT32: key.publisherId = nm->publisherId.uint32; break;
+    case UA_PUBLISHERIDTYPE_UINT64: key.publisherId = nm->publisherId.uint64; break;
+    default:
+        /* No reader in the index has a String PublisherId */
+        *first = 0;
+        *count = 0;
+        return true;
+    }
+
+    /* Binary search for the first matching entry */
+    size_t lo = 0, hi = rg->readerIndexSize;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(cmpReaderIndexEntry(&rg->readerIndex[mid], &key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    /* Several readers can expect the same DataSetMessage */
+    size_t end = lo;
+    while(end < rg->readerIndexSize &&
+          cmpReaderIndexEntry(&rg->readerIndex[end], &key) == 0)
+        end++;
+
+    *first = lo;
+    *count = end - lo;
+    return true;
+}
+
 /* Freezing of the configuration */
 
 UA_StatusCode
@@ -476,6 +595,9 @@ UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
          * adding target variable one by one or in a group stored in a list. */
     }
 
+    /* The readers cannot change until the configuration is unfrozen */
+    UA_ReaderGroup_buildReaderIndex(server, rg);
+
     /* Not rt, we don't have to adjust anything */
     if(rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
         return UA_STATUSCODE_GOOD;
@@ -546,6 +668,7 @@ UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
      * settings which headers are present, etc. Until then the ReaderGroup is
      * "PreOperational". */
     UA_NetworkMessageOffsetBuffer_clear(&dsr->bufferedMessage);
+    dsr->directDecoding = false;
 
     /* Set the current state again. This can move the state from Operational to
      * PreOperational. */
@@ -568,20 +691,30 @@ UA_StatusCode
 UA_ReaderGroup_unfreezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
+    /* Already unfrozen */
+    if(!rg->configurationFrozen)
+        return UA_STATUSCODE_GOOD;
+
     /* PubSubConnection freezeCounter-- */
     UA_PubSubConnection *pubSubConnection = rg->linkedConnection;
     pubSubConnection->configurationFreezeCounter--;
 
+    /* Wait until a concurrent lock-free receive has finished */
+    UA_PubSubConnection_pauseRT(pubSubConnection);
+
     /* ReaderGroup unfreeze */
     rg->configurationFrozen = false;
+    UA_ReaderGroup_clearReaderIndex(rg);
 
     /* DataSetReader unfreeze */
     UA_DataSetReader *dataSetReader;
     LIST_FOREACH(dataSetReader, &rg->readers, listEntry) {
         dataSetReader->configurationFrozen = false;
         UA_NetworkMessageOffsetBuffer_clear(&dataSetReader->bufferedMessage);
+        dataSetReader->directDecoding = false;
     }
 
+    UA_PubSubConnection_resumeRT(pubSubConnection);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -605,9 +738,37 @@ UA_ReaderGroup_process(UA_Server *server, UA_ReaderGroup *readerGroup,
        readerGroup->state != UA_PUBSUBSTATE_PREOPERATIONAL)
         return false;
 
+    /* Lookup the readers in the index of the frozen configuration */
+    UA_Boolean processed = false;
+    UA_DataSetPayloadHeader *ph = &nm->payloadHeader.dataSetPayloadHeader;
+    size_t first = 0, count = 0;
+    if(nm->payloadHeaderEnabled && ph->count > 0 &&
+       UA_ReaderGroup_findReaders(readerGroup, nm, ph->dataSetWriterIds[0],
+                                  &first, &count)) {
+        for(UA_Byte i = 0; i < ph->count; i++) {
+            if(i > 0)
+                UA_ReaderGroup_findReaders(readerGroup, nm, ph->dataSetWriterIds[i],
+                                           &first, &count);
+            for(size_t j = first; j < first + count; j++) {
+                UA_DataSetReader *reader = readerGroup->readerIndex[j].reader;
+                if(reader->state != UA_PUBSUBSTATE_OPERATIONAL &&
+                   reader->state != UA_PUBSUBSTATE_PREOPERATIONAL)
+                    continue;
+                if(!readerGroup->hasReceived) {
+                    readerGroup->hasReceived = true;
+                    UA_ReaderGroup_setPubSubState(server, readerGroup,
+                                                  readerGroup->state);
+                }
+                processed = true;
+                UA_DataSetReader_process(server, readerGroup, reader,
+                                         &nm->payload.dataSetPayload.dataSetMessages[i]);
+            }
+        }
+        return processed;
+    }
+
     /* Safe iteration. The current Reader might be deleted in the ReaderGroup
      * _setPubSubState callback. */
-    UA_Boolean processed = false;
     UA_DataSetReader *reader, *reader_tmp;
     LIST_FOREACH_SAFE(reader, &readerGroup->readers, listEntry, reader_tmp) {
         UA_StatusCode res = UA_DataSetReader_checkIdentifier(server, nm, reader,
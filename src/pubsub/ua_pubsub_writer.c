@@ -177,6 +177,35 @@ UA_DataSetWriter_setPubSubState(UA_Server *server, UA_DataSetWriter *dsw,
     return res;
 }
 
+/* (Re)initialize the lastValue store and the field buffer for the delta
+ * frames. Only frees the memory for a fieldSize of zero. */
+static UA_StatusCode
+resetLastSamples(UA_DataSetWriter *dsw, size_t fieldSize) {
+    for(size_t i = 0; i < dsw->lastSamplesCount; i++)
+        UA_DataValue_clear(&dsw->lastSamples[i].value);
+    UA_free(dsw->lastSamples);
+    UA_free(dsw->deltaFrameFields);
+    dsw->lastSamples = NULL;
+    dsw->deltaFrameFields = NULL;
+    dsw->lastSamplesCount = 0;
+    if(fieldSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    dsw->lastSamples = (UA_DataSetWriterSample*)
+        UA_calloc(fieldSize, sizeof(UA_DataSetWriterSample));
+    dsw->deltaFrameFields = (UA_DataSetMessage_DeltaFrameField*)
+        UA_calloc(fieldSize, sizeof(UA_DataSetMessage_DeltaFrameField));
+    if(!dsw->lastSamples || !dsw->deltaFrameFields) {
+        UA_free(dsw->lastSamples);
+        UA_free(dsw->deltaFrameFields);
+        dsw->lastSamples = NULL;
+        dsw->deltaFrameFields = NULL;
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    dsw->lastSamplesCount = fieldSize;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_DataSetWriter_create(UA_Server *server,
                         const UA_NodeId writerGroup, const UA_NodeId dataSet,
@@ -248,21 +277,15 @@ UA_DataSetWriter_create(UA_Server *server,
         newDataSetWriter->connectedDataSetVersion =
             currentDataSetContext->dataSetMetaData.configurationVersion;
 
-        if(server->config.pubSubConfig.enableDeltaFrames) {
-            /* Initialize the queue for the last values */
-            if(currentDataSetContext->fieldSize > 0) {
-                newDataSetWriter->lastSamples = (UA_DataSetWriterSample*)
-                    UA_calloc(currentDataSetContext->fieldSize, sizeof(UA_DataSetWriterSample));
-                if(!newDataSetWriter->lastSamples) {
-                    UA_DataSetWriterConfig_clear(&newDataSetWriter->config);
-                    UA_free(newDataSetWriter);
-                    return UA_STATUSCODE_BADOUTOFMEMORY;
-                }
-                newDataSetWriter->lastSamplesCount = currentDataSetContext->fieldSize;
-                for(size_t i = 0; i < newDataSetWriter->lastSamplesCount; i++) {
-                    UA_DataValue_init(&newDataSetWriter->lastSamples[i].value);
-                    newDataSetWriter->lastSamples[i].valueChanged = false;
-                }
+        /* Initialize the queue for the last values. The fixed-size RT
+         * messages are always sent as keyframes. */
+        if(server->config.pubSubConfig.enableDeltaFrames &&
+           wg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE) {
+            res = resetLastSamples(newDataSetWriter, currentDataSetContext->fieldSize);
+            if(res != UA_STATUSCODE_GOOD) {
+                UA_DataSetWriterConfig_clear(&newDataSetWriter->config);
+                UA_free(newDataSetWriter);
+                return res;
             }
         }
         /* Connect PublishedDataSet with DataSetWriter */
@@ -451,15 +474,8 @@ UA_DataSetWriter_remove(UA_Server *server, UA_DataSetWriter *dataSetWriter) {
     UA_NodeId_clear(&dataSetWriter->linkedWriterGroup);
     UA_NodeId_clear(&dataSetWriter->connectedDataSet);
 
-    if(server->config.pubSubConfig.enableDeltaFrames) {
-        /* Delete lastSamples store */
-        for(size_t i = 0; i < dataSetWriter->lastSamplesCount; i++) {
-            UA_DataValue_clear(&dataSetWriter->lastSamples[i].value);
-        }
-        UA_free(dataSetWriter->lastSamples);
-        dataSetWriter->lastSamples = NULL;
-        dataSetWriter->lastSamplesCount = 0;
-    }
+    /* Delete lastSamples store */
+    resetLastSamples(dataSetWriter, 0);
 
     UA_free(dataSetWriter);
     return UA_STATUSCODE_GOOD;
@@ -484,55 +500,91 @@ UA_Server_removeDataSetWriter(UA_Server *server, const UA_NodeId dsw) {
 
 /* Compare two variants. Internally used for value change detection. */
 static UA_Boolean
-valueChangedVariant(UA_Variant *oldValue, UA_Variant *newValue) {
-    if(!oldValue || !newValue)
-        return false;
-
-    size_t oldValueEncodingSize = UA_calcSizeBinary(oldValue, &UA_TYPES[UA_TYPES_VARIANT]);
-    size_t newValueEncodingSize = UA_calcSizeBinary(newValue, &UA_TYPES[UA_TYPES_VARIANT]);
-    if(oldValueEncodingSize == 0 || newValueEncodingSize == 0)
-        return false;
+valueChangedVariant(const UA_Variant *oldValue, const UA_Variant *newValue) {
+    return (UA_order(oldValue, newValue, &UA_TYPES[UA_TYPES_VARIANT]) != UA_ORDER_EQ);
+}
 
-    if(oldValueEncodingSize != newValueEncodingSize)
+/* Compare the last sample with the value stored in the node. This avoids
+ * copying the value out of the node only to find that it has not changed.
+ * Returns true if the field has to be sampled. */
+static UA_Boolean
+fieldMaybeChanged(UA_Server *server, UA_DataSetField *dsf, const UA_Variant *last) {
+    const UA_PublishedVariableDataType *params =
+        &dsf->config.field.variable.publishParameters;
+    if(dsf->config.field.variable.rtValueSource.rtFieldSourceEnabled ||
+       dsf->config.field.variable.rtValueSource.rtInformationModelNode ||
+       params->attributeId != UA_ATTRIBUTEID_VALUE ||
+       params->indexRange.length > 0 || !last->type)
         return true;
 
-    UA_ByteString oldValueEncoding = UA_BYTESTRING_NULL;
-    UA_StatusCode res = UA_ByteString_allocBuffer(&oldValueEncoding, oldValueEncodingSize);
-    if(res != UA_STATUSCODE_GOOD)
-        return false;
-
-    UA_ByteString newValueEncoding = UA_BYTESTRING_NULL;
-    res = UA_ByteString_allocBuffer(&newValueEncoding, newValueEncodingSize);
-    if(res != UA_STATUSCODE_GOOD) {
-        UA_ByteString_clear(&oldValueEncoding);
-        return false;
-    }
-
-    UA_Byte *bufPosOldValue = oldValueEncoding.data;
-    const UA_Byte *bufEndOldValue = &oldValueEncoding.data[oldValueEncoding.length];
-    UA_Byte *bufPosNewValue = newValueEncoding.data;
-    const UA_Byte *bufEndNewValue = &newValueEncoding.data[newValueEncoding.length];
-
-    UA_Boolean compareResult = false; /* default */
-
-    res = UA_encodeBinaryInternal(oldValue, &UA_TYPES[UA_TYPES_VARIANT],
-                                  &bufPosOldValue, &bufEndOldValue, NULL, NULL);
-    if(res != UA_STATUSCODE_GOOD)
-        goto cleanup;
+    const UA_Node *node = UA_NODESTORE_GET(server, &params->publishedVariable);
+    if(!node)
+        return true;
 
-    res = UA_encodeBinaryInternal(newValue, &UA_TYPES[UA_TYPES_VARIANT],
-                                  &bufPosNewValue, &bufEndNewValue, NULL, NULL);
-    if(res != UA_STATUSCODE_GOOD)
-        goto cleanup;
+    UA_Boolean changed = true;
+    if(node->head.nodeClass == UA_NODECLASS_VARIABLE) {
+        const UA_VariableNode *vn = &node->variableNode;
+        UA_Boolean inNode =
+            (vn->valueBackend.backendType == UA_VALUEBACKENDTYPE_INTERNAL ||
+             (vn->valueBackend.backendType == UA_VALUEBACKENDTYPE_NONE &&
+              vn->valueSource == UA_VALUESOURCE_DATA));
+        if(inNode && !vn->value.data.callback.onRead)
+            changed = valueChangedVariant(last, &vn->value.data.value.value);
+    }
+    UA_NODESTORE_RELEASE(server, node);
+    return changed;
+}
 
-    oldValueEncoding.length = (uintptr_t)bufPosOldValue - (uintptr_t)oldValueEncoding.data;
-    newValueEncoding.length = (uintptr_t)bufPosNewValue - (uintptr_t)newValueEncoding.data;
-    compareResult = !UA_ByteString_equal(&oldValueEncoding, &newValueEncoding);
+/* Store the sample as the last published value. Fixed-size scalars are copied
+ * into the memory of the previous sample. With move, the sample is taken over
+ * (and the input cleared) unless it references external memory. */
+static void
+storeLastSample(UA_DataSetWriterSample *ls, UA_DataValue *value, UA_Boolean move) {
+    UA_Variant *last = &ls->value.value;
+    const UA_DataType *type = value->value.type;
+    if(type && type == last->type && type->pointerFree &&
+       last->storageType == UA_VARIANT_DATA &&
+       UA_Variant_isScalar(last) && UA_Variant_isScalar(&value->value)) {
+        memcpy(last->data, value->value.data, type->memSize);
+        UA_Variant lastValue = *last;
+        ls->value = *value;
+        ls->value.value = lastValue;
+        if(move)
+            UA_DataValue_clear(value);
+        return;
+    }
+
+    UA_DataValue_clear(&ls->value);
+    if(move && value->value.storageType == UA_VARIANT_DATA) {
+        ls->value = *value;
+        UA_DataValue_init(value);
+        return;
+    }
+    UA_DataValue_copy(value, &ls->value);
+    if(move)
+        UA_DataValue_clear(value);
+}
 
- cleanup:
-    UA_ByteString_clear(&oldValueEncoding);
-    UA_ByteString_clear(&newValueEncoding);
-    return compareResult;
+static void
+applyFieldContentMask(UA_DataSetWriter *dataSetWriter, UA_DataValue *dfv) {
+    /* Deactivate statuscode? */
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
+        dfv->hasStatus = false;
+
+    /* Deactivate timestamps */
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
+        dfv->hasSourceTimestamp = false;
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
+        dfv->hasSourcePicoseconds = false;
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
+        dfv->hasServerTimestamp = false;
+    if(((u64)dataSetWriter->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
+        dfv->hasServerPicoseconds = false;
 }
 
 static UA_StatusCode
@@ -564,6 +616,9 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
     }
 #endif
 
+    /* The lastValue store is used for the following delta frames */
+    UA_Boolean trackChanges = (dataSetWriter->lastSamplesCount == currentDataSet->fieldSize);
+
     /* Loop over the fields */
     size_t counter = 0;
     UA_DataSetField *dsf;
@@ -577,38 +632,24 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
         /* Sample the value */
         UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
         UA_PubSubDataSetField_sampleValue(server, dsf, dfv);
+        applyFieldContentMask(dataSetWriter, dfv);
 
-        /* Deactivate statuscode? */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
-            dfv->hasStatus = false;
-
-        /* Deactivate timestamps */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
-            dfv->hasSourceTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dfv->hasSourcePicoseconds = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
-            dfv->hasServerTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
-            dfv->hasServerPicoseconds = false;
-
-        if(server->config.pubSubConfig.enableDeltaFrames) {
-            /* Update lastValue store */
-            UA_DataValue_clear(&dataSetWriter->lastSamples[counter].value);
-            UA_DataValue_copy(dfv, &dataSetWriter->lastSamples[counter].value);
+        /* Update lastValue store */
+        if(trackChanges) {
+            UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
+            if(valueChangedVariant(&ls->value.value, &dfv->value))
+                storeLastSample(ls, dfv, false);
         }
         counter++;
     }
     return UA_STATUSCODE_GOOD;
 }
 
-/* the input message is already initialized and that the method 
- * must not be called twice for the same message */
+/* The input message is already initialized and the method must not be called
+ * twice for the same message. Only the changed fields are sampled into the
+ * lastValue store. The fields of the delta frame point into the store and the
+ * field array is owned by the DataSetWriter. So the DataSetMessage must not be
+ * cleared with the delta frame fields. */
 static UA_StatusCode
 UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
                                                  UA_DataSetMessage *dataSetMessage,
@@ -624,75 +665,44 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
     if(currentDataSet->fieldSize == 0)
         return UA_STATUSCODE_GOOD;
 
-    UA_DataSetField *dsf;
+    UA_DataSetMessage_DeltaFrameField *deltaFields = dataSetWriter->deltaFrameFields;
+    UA_UInt16 fieldCount = 0;
     UA_UInt16 counter = 0;
+    UA_DataSetField *dsf;
     TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
+        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
+        if(!fieldMaybeChanged(server, dsf, &ls->value.value)) {
+            counter++;
+            continue;
+        }
+
         /* Sample the value */
         UA_DataValue value;
         UA_DataValue_init(&value);
         UA_PubSubDataSetField_sampleValue(server, dsf, &value);
 
         /* Check if the value has changed */
-        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
-        if(valueChangedVariant(&ls->value.value, &value.value)) {
-            /* increase fieldCount for current delta message */
-            dataSetMessage->data.deltaFrameData.fieldCount++;
-            ls->valueChanged = true;
-
-            /* Update last stored sample */
-            UA_DataValue_clear(&ls->value);
-            ls->value = value;
-        } else {
+        if(!valueChangedVariant(&ls->value.value, &value.value)) {
             UA_DataValue_clear(&value);
-            ls->valueChanged = false;
+            counter++;
+            continue;
         }
 
+        /* Update last stored sample */
+        storeLastSample(ls, &value, true);
+
+        /* Reference the stored sample in the delta frame */
+        UA_DataSetMessage_DeltaFrameField *dff = &deltaFields[fieldCount];
+        dff->fieldIndex = counter;
+        dff->fieldValue = ls->value;
+        dff->fieldValue.value.storageType = UA_VARIANT_DATA_NODELETE;
+        applyFieldContentMask(dataSetWriter, &dff->fieldValue);
+        fieldCount++;
         counter++;
     }
 
-    /* Allocate DeltaFrameFields */
-    UA_DataSetMessage_DeltaFrameField *deltaFields = (UA_DataSetMessage_DeltaFrameField *)
-        UA_calloc(counter, sizeof(UA_DataSetMessage_DeltaFrameField));
-    if(!deltaFields)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-
     dataSetMessage->data.deltaFrameData.deltaFrameFields = deltaFields;
-    dataSetMessage->data.deltaFrameData.fieldCount = counter;
-
-    size_t currentDeltaField = 0;
-    for(size_t i = 0; i < currentDataSet->fieldSize; i++) {
-        if(!dataSetWriter->lastSamples[i].valueChanged)
-            continue;
-
-        UA_DataSetMessage_DeltaFrameField *dff = &deltaFields[currentDeltaField];
-
-        dff->fieldIndex = (UA_UInt16) i;
-        UA_DataValue_copy(&dataSetWriter->lastSamples[i].value, &dff->fieldValue);
-
-        /* Reset the changed flag */
-        dataSetWriter->lastSamples[i].valueChanged = false;
-
-        /* Deactivate statuscode? */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
-            dff->fieldValue.hasStatus = false;
-
-        /* Deactivate timestamps? */
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
-            dff->fieldValue.hasSourceTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
-            dff->fieldValue.hasServerTimestamp = false;
-        if(((u64)dataSetWriter->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
-
-        currentDeltaField++;
-    }
+    dataSetMessage->data.deltaFrameData.fieldCount = fieldCount;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -876,27 +886,18 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
 
     /* JSON does not differ between deltaframes and keyframes, only keyframes
      * are currently used. */
-    if(dsm && server->config.pubSubConfig.enableDeltaFrames) {
+    if(dsm && server->config.pubSubConfig.enableDeltaFrames &&
+       wg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE) {
         /* Check if the PublishedDataSet version has changed -> if yes flush the
          * lastValue store and send a KeyFrame */
         if(dataSetWriter->connectedDataSetVersion.majorVersion !=
            currentDataSet->dataSetMetaData.configurationVersion.majorVersion ||
            dataSetWriter->connectedDataSetVersion.minorVersion !=
            currentDataSet->dataSetMetaData.configurationVersion.minorVersion) {
-            /* Remove old samples */
-            for(size_t i = 0; i < dataSetWriter->lastSamplesCount; i++)
-                UA_DataValue_clear(&dataSetWriter->lastSamples[i].value);
-
             /* Realloc PDS dependent memory */
-            dataSetWriter->lastSamplesCount = currentDataSet->fieldSize;
-            UA_DataSetWriterSample *newSamplesArray = (UA_DataSetWriterSample * )
-                UA_realloc(dataSetWriter->lastSamples,
-                           sizeof(UA_DataSetWriterSample) * dataSetWriter->lastSamplesCount);
-            if(!newSamplesArray)
-                return UA_STATUSCODE_BADOUTOFMEMORY;
-            dataSetWriter->lastSamples = newSamplesArray;
-            memset(dataSetWriter->lastSamples, 0,
-                   sizeof(UA_DataSetWriterSample) * dataSetWriter->lastSamplesCount);
+            UA_StatusCode res = resetLastSamples(dataSetWriter, currentDataSet->fieldSize);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
 
             dataSetWriter->connectedDataSetVersion =
                 currentDataSet->dataSetMetaData.configurationVersion;
@@ -908,9 +909,12 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
 
         /* The standard defines: if a PDS contains only one fields no delta messages
          * should be generated because they need more memory than a keyframe with 1
-         * field. */
-        if(currentDataSet->fieldSize > 1 && dataSetWriter->deltaFrameCounter > 0 &&
-           dataSetWriter->deltaFrameCounter <= dataSetWriter->config.keyFrameCount) {
+         * field. The KeyFrameCount includes the keyframe. So a KeyFrameCount
+         * of one sends only keyframes. */
+        if(currentDataSet->fieldSize > 1 &&
+           dataSetWriter->lastSamplesCount == currentDataSet->fieldSize &&
+           dataSetWriter->deltaFrameCounter > 0 &&
+           dataSetWriter->deltaFrameCounter < dataSetWriter->config.keyFrameCount) {
             UA_PubSubDataSetWriter_generateDeltaFrameMessage(server, dataSetMessage,
                                                              dataSetWriter);
             dataSetWriter->deltaFrameCounter++;
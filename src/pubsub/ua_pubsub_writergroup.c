@@ -39,6 +39,9 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_ExtensionObject *transportSettings,
                        UA_NetworkMessage *networkMessage);
 
+static void
+publishWriterGroup(UA_Server *server, UA_WriterGroup *writerGroup);
+
 UA_Boolean
 UA_WriterGroup_canConnect(UA_WriterGroup *wg) {
     /* Already connected */
@@ -53,38 +56,250 @@ UA_WriterGroup_canConnect(UA_WriterGroup *wg) {
     return true;
 }
 
+/* Register a cyclic callback in the EventLoop for the WriterGroup alone */
+static UA_StatusCode
+addCyclicPublishCallback(UA_Server *server, UA_WriterGroup *wg) {
+    UA_EventLoop *el = UA_PubSubConnection_getEL(server, wg->linkedConnection);
+    return el->addCyclicCallback(el, (UA_Callback)UA_WriterGroup_publishCallback,
+                                 server, wg, wg->config.publishingInterval,
+                                 NULL /* TODO: use basetime */,
+                                 UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,
+                                 &wg->publishCallbackId);
+}
+
+/**********************************************/
+/*              Publish Schedule              */
+/**********************************************/
+
+static void
+UA_PublishSchedule_callback(UA_Server *server, UA_PublishSchedule *ps) {
+    UA_LOCK(&server->serviceMutex);
+
+    UA_PubSubConnection *connection = ps->connection;
+    ps->batching = connection->batchSend;
+    ps->pendingChannelsSize = 0;
+    for(ps->cursor = 0; ps->cursor < ps->writerGroupsSize; ps->cursor++)
+        publishWriterGroup(server, ps->writerGroups[ps->cursor]);
+    ps->batching = false;
+
+    /* Send the messages waiting for the batched send */
+    UA_Boolean flush = true;
+    UA_KeyValuePair param;
+    param.key = UA_QUALIFIEDNAME(0, "flush");
+    UA_Variant_setScalar(&param.value, &flush, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap params = {1, &param};
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < ps->pendingChannelsSize; i++) {
+        UA_ByteString empty = UA_BYTESTRING_NULL;
+        res |= connection->cm->sendWithConnection(connection->cm, ps->pendingChannels[i],
+                                                  &params, &empty);
+    }
+    ps->pendingChannelsSize = 0;
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR_CONNECTION(&server->config.logger, connection,
+                                "Sending the batched NetworkMessages failed");
+        UA_PubSubConnection_setPubSubState(server, connection,
+                                           UA_PUBSUBSTATE_ERROR, res);
+    }
+
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+static UA_StatusCode
+UA_PublishSchedule_addWriterGroup(UA_PublishSchedule *ps, UA_WriterGroup *wg) {
+    if(ps->writerGroupsSize == ps->capacity) {
+        size_t capacity = (ps->capacity == 0) ? 4 : ps->capacity * 2;
+        UA_WriterGroup **wgs = (UA_WriterGroup**)
+            UA_realloc(ps->writerGroups, capacity * sizeof(UA_WriterGroup*));
+        if(!wgs)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        ps->writerGroups = wgs;
+        uintptr_t *channels = (uintptr_t*)
+            UA_realloc(ps->pendingChannels, capacity * sizeof(uintptr_t));
+        if(!channels)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        ps->pendingChannels = channels;
+        ps->capacity = capacity;
+    }
+    ps->writerGroups[ps->writerGroupsSize++] = wg;
+    wg->schedule = ps;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+delayedPublishSchedule_delete(void *application, void *context) {
+    UA_PublishSchedule *ps = (UA_PublishSchedule*)context;
+    UA_free(ps->writerGroups);
+    UA_free(ps->pendingChannels);
+    UA_free(ps);
+}
+
+static void
+UA_PublishSchedule_delete(UA_Server *server, UA_PublishSchedule *ps) {
+    UA_EventLoop *el = UA_PubSubConnection_getEL(server, ps->connection);
+    el->removeCyclicCallback(el, ps->callbackId);
+    LIST_REMOVE(ps, listEntry);
+
+    /* Free the memory delayed. The schedule might be publishing right now. */
+    ps->dc.callback = delayedPublishSchedule_delete;
+    ps->dc.context = ps;
+    el->addDelayedCallback(el, &ps->dc);
+}
+
+/* Create a schedule for the WriterGroup and another WriterGroup that so far
+ * publishes on its own with the same interval */
+static UA_StatusCode
+UA_PublishSchedule_create(UA_Server *server, UA_WriterGroup *other,
+                          UA_WriterGroup *wg) {
+    UA_PublishSchedule *ps = (UA_PublishSchedule*)
+        UA_calloc(1, sizeof(UA_PublishSchedule));
+    if(!ps)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ps->connection = wg->linkedConnection;
+    ps->interval = wg->config.publishingInterval;
+
+    UA_EventLoop *el = UA_PubSubConnection_getEL(server, ps->connection);
+    UA_StatusCode res = UA_PublishSchedule_addWriterGroup(ps, other);
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_PublishSchedule_addWriterGroup(ps, wg);
+    if(res == UA_STATUSCODE_GOOD)
+        res = el->addCyclicCallback(el, (UA_Callback)UA_PublishSchedule_callback,
+                                    server, ps, ps->interval, NULL,
+                                    UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,
+                                    &ps->callbackId);
+    if(res != UA_STATUSCODE_GOOD) {
+        other->schedule = NULL;
+        wg->schedule = NULL;
+        delayedPublishSchedule_delete(NULL, ps);
+        return res;
+    }
+
+    /* Take over from the callback of the other WriterGroup */
+    el->removeCyclicCallback(el, other->publishCallbackId);
+    other->publishCallbackId = 0;
+    LIST_INSERT_HEAD(&ps->connection->publishSchedules, ps, listEntry);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Join the schedule of the WriterGroups with the same publishing interval.
+ * The schedule publishes with the server lock. So WriterGroups with
+ * RT_FIXED_SIZE keep their own callback for the lock-free realtime path. */
+static UA_StatusCode
+UA_PublishSchedule_join(UA_Server *server, UA_WriterGroup *wg) {
+    if(wg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_PubSubConnection *connection = wg->linkedConnection;
+    UA_PublishSchedule *ps;
+    LIST_FOREACH(ps, &connection->publishSchedules, listEntry) {
+        if(ps->interval == wg->config.publishingInterval)
+            return UA_PublishSchedule_addWriterGroup(ps, wg);
+    }
+
+    UA_WriterGroup *other;
+    LIST_FOREACH(other, &connection->writerGroups, listEntry) {
+        if(other != wg && other->publishCallbackId != 0 &&
+           !other->config.pubsubManagerCallback.addCustomCallback &&
+           other->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE &&
+           other->config.publishingInterval == wg->config.publishingInterval)
+            return UA_PublishSchedule_create(server, other, wg);
+    }
+    return UA_STATUSCODE_BADNOTFOUND;
+}
+
+static void
+UA_PublishSchedule_leave(UA_Server *server, UA_WriterGroup *wg) {
+    UA_PublishSchedule *ps = wg->schedule;
+    wg->schedule = NULL;
+    size_t i = 0;
+    for(; i < ps->writerGroupsSize; i++) {
+        if(ps->writerGroups[i] == wg)
+            break;
+    }
+    UA_assert(i < ps->writerGroupsSize);
+    memmove(&ps->writerGroups[i], &ps->writerGroups[i + 1],
+            (ps->writerGroupsSize - i - 1) * sizeof(UA_WriterGroup*));
+    ps->writerGroupsSize--;
+
+    /* Don't skip the next WriterGroup if removed during the cycle. The cursor
+     * may wrap around (unsigned) as it is increased right after. */
+    if(i <= ps->cursor)
+        ps->cursor--;
+
+    if(ps->writerGroupsSize > 1)
+        return;
+
+    /* The last WriterGroup publishes on its own again. Keep the schedule if
+     * the callback cannot be registered. */
+    if(ps->writerGroupsSize == 1) {
+        UA_WriterGroup *last = ps->writerGroups[0];
+        if(addCyclicPublishCallback(server, last) != UA_STATUSCODE_GOOD)
+            return;
+        last->schedule = NULL;
+        ps->writerGroupsSize = 0;
+    }
+    UA_PublishSchedule_delete(server, ps);
+}
+
+/* Send a NetworkMessage. While the WriterGroups of a schedule are published,
+ * the messages are marked for the batched send. */
+static UA_StatusCode
+sendWithConnection(UA_WriterGroup *wg, UA_ConnectionManager *cm,
+                   uintptr_t channel, UA_ByteString *buf) {
+    UA_PublishSchedule *ps = wg->schedule;
+    if(!ps || !ps->batching)
+        return cm->sendWithConnection(cm, channel, &UA_KEYVALUEMAP_NULL, buf);
+
+    UA_Boolean more = true;
+    UA_KeyValuePair param;
+    param.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&param.value, &more, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap params = {1, &param};
+    UA_StatusCode res = cm->sendWithConnection(cm, channel, &params, buf);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Remember the channel for the flush at the end of the cycle */
+    for(size_t i = 0; i < ps->pendingChannelsSize; i++) {
+        if(ps->pendingChannels[i] == channel)
+            return UA_STATUSCODE_GOOD;
+    }
+    if(ps->pendingChannelsSize < ps->capacity)
+        ps->pendingChannels[ps->pendingChannelsSize++] = channel;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *wg) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     /* Already registered */
-    if(wg->publishCallbackId != 0)
+    if(wg->publishCallbackId != 0 || wg->schedule)
         return UA_STATUSCODE_GOOD;
 
-    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    /* Use configured mechanism for cyclic callbacks */
     if(wg->config.pubsubManagerCallback.addCustomCallback) {
-        /* Use configured mechanism for cyclic callbacks */
-        retval = wg->config.pubsubManagerCallback.
+        return wg->config.pubsubManagerCallback.
             addCustomCallback(server, wg->identifier,
                               (UA_ServerCallback)UA_WriterGroup_publishCallback,
                               wg, wg->config.publishingInterval,
                               NULL, UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,
                               &wg->publishCallbackId);
-    } else {
-        /* Use EventLoop for cyclic callbacks */
-        UA_EventLoop *el = UA_PubSubConnection_getEL(server, wg->linkedConnection);
-        retval = el->addCyclicCallback(el, (UA_Callback)UA_WriterGroup_publishCallback,
-                                       server, wg, wg->config.publishingInterval,
-                                       NULL /* TODO: use basetime */,
-                                       UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,
-                                       &wg->publishCallbackId);
     }
 
-    return retval;
+    /* Use EventLoop for cyclic callbacks. Publish together with the
+     * WriterGroups of the same interval if possible. */
+    if(UA_PublishSchedule_join(server, wg) == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOOD;
+    return addCyclicPublishCallback(server, wg);
 }
 
 static void
 UA_WriterGroup_removePublishCallback(UA_Server *server, UA_WriterGroup *wg) {
+    if(wg->schedule) {
+        UA_PublishSchedule_leave(server, wg);
+        return;
+    }
     if(wg->publishCallbackId == 0)
         return;
     if(wg->config.pubsubManagerCallback.removeCustomCallback) {
@@ -405,7 +620,6 @@ UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
 
         wg->bufferedMessage.nm = (UA_NetworkMessage *)UA_calloc(1,sizeof(UA_NetworkMessage));
         wg->bufferedMessage.nm->securityHeader = networkMessage.securityHeader;
-        UA_ByteString_allocBuffer(&wg->bufferedMessage.encryptBuffer, msgSize);
     }
 #endif
 
@@ -426,6 +640,9 @@ UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
 #endif
     }
 
+    /* Publish without the server lock from now on */
+    if(res == UA_STATUSCODE_GOOD)
+        UA_WriterGroup_updateRT(wg);
     return res;
 }
 
@@ -451,6 +668,9 @@ UA_WriterGroup_unfreezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     if(!wg->configurationFrozen)
         return UA_STATUSCODE_GOOD;
 
+    /* Wait until a concurrent lock-free publish has finished */
+    UA_WriterGroup_pauseRT(wg);
+
     UA_PubSubConnection *pubSubConnection =  wg->linkedConnection;
     pubSubConnection->configurationFreezeCounter--;
 
@@ -463,6 +683,7 @@ UA_WriterGroup_unfreezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     UA_NetworkMessageOffsetBuffer_clear(&wg->bufferedMessage);
     wg->configurationFrozen = false;
 
+    UA_WriterGroup_resumeRT(wg);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -706,6 +927,9 @@ setWriterGroupEncryptionKeys(UA_Server *server, const UA_NodeId writerGroup,
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* The keys are used by the lock-free publish path */
+    UA_WriterGroup_pauseRT(wg);
+
     if(securityTokenId != wg->securityTokenId) {
         wg->securityTokenId = securityTokenId;
         wg->nonceSequenceNumber = 1;
@@ -723,6 +947,7 @@ setWriterGroupEncryptionKeys(UA_Server *server, const UA_NodeId writerGroup,
             setSecurityKeys(wg->securityPolicyContext, &signingKey, &encryptingKey, &keyNonce);
     }
 
+    UA_WriterGroup_resumeRT(wg);
     if(res != UA_STATUSCODE_GOOD)
         return res;
     return UA_WriterGroup_setPubSubState(server, wg, wg->state);
@@ -760,6 +985,8 @@ UA_WriterGroup_setPubSubState(UA_Server *server, UA_WriterGroup *wg,
                               UA_PubSubState targetState) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
+    UA_WriterGroup_pauseRT(wg);
+
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
     UA_PubSubConnection *connection = wg->linkedConnection;
     UA_PubSubState oldState = wg->state;
@@ -834,9 +1061,41 @@ UA_WriterGroup_setPubSubState(UA_Server *server, UA_WriterGroup *wg,
         UA_DataSetWriter_setPubSubState(server, writer, writer->state);
     }
 
+    UA_WriterGroup_resumeRT(wg);
     return ret;
 }
 
+/* The lock-free publish path requires a frozen, operational WriterGroup with a
+ * prepared message buffer */
+static UA_Boolean
+UA_WriterGroup_canPublishRT(UA_WriterGroup *wg) {
+    return (wg->configurationFrozen &&
+            wg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE &&
+            wg->state == UA_PUBSUBSTATE_OPERATIONAL &&
+            wg->bufferedMessage.buffer.data != NULL &&
+            wg->writersCount > 0 &&
+            wg->linkedConnection != NULL);
+}
+
+void
+UA_WriterGroup_pauseRT(UA_WriterGroup *wg) {
+    if(wg->rtGuard.pauseCounter++ == 0)
+        UA_PubSubRTGuard_disable(&wg->rtGuard);
+}
+
+void
+UA_WriterGroup_resumeRT(UA_WriterGroup *wg) {
+    UA_assert(wg->rtGuard.pauseCounter > 0);
+    wg->rtGuard.pauseCounter--;
+    UA_WriterGroup_updateRT(wg);
+}
+
+void
+UA_WriterGroup_updateRT(UA_WriterGroup *wg) {
+    if(wg->rtGuard.pauseCounter == 0 && UA_WriterGroup_canPublishRT(wg))
+        UA_PubSubRTGuard_enable(&wg->rtGuard);
+}
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
 static UA_StatusCode
 encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
@@ -913,9 +1172,8 @@ static void
 sendNetworkMessageBuffer(UA_Server *server, UA_WriterGroup *wg, 
                          UA_PubSubConnection *connection, uintptr_t connectionId,
                          UA_ByteString *buffer) {
-    UA_StatusCode res = connection->cm->
-        sendWithConnection(connection->cm, connectionId,
-                           &UA_KEYVALUEMAP_NULL, buffer);
+    UA_StatusCode res =
+        sendWithConnection(wg, connection->cm, connectionId, buffer);
 
     /* Failure, set the WriterGroup into an error mode */
     if(res != UA_STATUSCODE_GOOD) {
@@ -931,6 +1189,39 @@ sendNetworkMessageBuffer(UA_Server *server, UA_WriterGroup *wg,
 }
 
 #ifdef UA_ENABLE_JSON_ENCODING
+
+#define UA_JSON_NETWORKMESSAGE_INITIALSIZE 512
+
+typedef struct {
+    UA_ConnectionManager *cm;
+    uintptr_t sendChannel;
+    UA_ByteString buf;
+} JsonNetworkBuffer;
+
+/* Called by the encoder when the end of the network buffer is reached.
+ * Allocates a network buffer of twice the size and moves the already encoded
+ * part over. The messages are sent as a whole (datagrams, MQTT publish), so the
+ * buffer grows instead of sending the encoded part. */
+static UA_StatusCode
+growJsonNetworkBuffer(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    JsonNetworkBuffer *jb = (JsonNetworkBuffer*)handle;
+    size_t used = (uintptr_t)*bufPos - (uintptr_t)jb->buf.data;
+    UA_ByteString newBuf;
+    UA_StatusCode res = jb->cm->allocNetworkBuffer(jb->cm, jb->sendChannel, &newBuf,
+                                                   jb->buf.length * 2);
+    UA_CHECK_STATUS(res, return res);
+
+    /* The EventLoop can return the same (large enough) static buffer again */
+    if(newBuf.data != jb->buf.data) {
+        memcpy(newBuf.data, jb->buf.data, used);
+        jb->cm->freeNetworkBuffer(jb->cm, jb->sendChannel, &jb->buf);
+    }
+    jb->buf = newBuf;
+    *bufPos = &jb->buf.data[used];
+    *bufEnd = &jb->buf.data[jb->buf.length];
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 sendNetworkMessageJson(UA_Server *server, UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount) {
@@ -947,9 +1238,6 @@ sendNetworkMessageJson(UA_Server *server, UA_PubSubConnection *connection, UA_Wr
     nm.publisherIdType = connection->config.publisherIdType;
     nm.publisherId = connection->config.publisherId;
 
-    /* Compute the message length */
-    size_t msgSize = UA_NetworkMessage_calcSizeJson(&nm, NULL, 0, NULL, 0, true);
-
     UA_ConnectionManager *cm = connection->cm;
     if(!cm)
         return UA_STATUSCODE_BADINTERNALERROR;
@@ -964,23 +1252,36 @@ sendNetworkMessageJson(UA_Server *server, UA_PubSubConnection *connection, UA_Wr
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    /* Allocate the buffer */
-    UA_ByteString buf;
-    UA_StatusCode res = cm->allocNetworkBuffer(cm, sendChannel, &buf, msgSize);
+    /* Allocate the buffer. Start with the size of the last message. The
+     * messages of a WriterGroup usually have a similar size. So the buffer
+     * rarely has to grow during the encoding and there is no separate pass to
+     * compute the message size. */
+    JsonNetworkBuffer jb;
+    jb.cm = cm;
+    jb.sendChannel = sendChannel;
+    size_t initialSize = wg->jsonMessageSize;
+    if(initialSize < UA_JSON_NETWORKMESSAGE_INITIALSIZE)
+        initialSize = UA_JSON_NETWORKMESSAGE_INITIALSIZE;
+    UA_StatusCode res = cm->allocNetworkBuffer(cm, sendChannel, &jb.buf, initialSize);
     UA_CHECK_STATUS(res, return res);
 
-    /* Encode the message */
-    UA_Byte *bufPos = buf.data;
-    const UA_Byte *bufEnd = &buf.data[msgSize];
-    res = UA_NetworkMessage_encodeJson(&nm, &bufPos, &bufEnd, NULL, 0, NULL, 0, true);
+    /* Encode the message. The buffer is exchanged if it runs full. */
+    UA_Byte *bufPos = jb.buf.data;
+    const UA_Byte *bufEnd = &jb.buf.data[jb.buf.length];
+    res = UA_NetworkMessage_encodeJsonInternal(&nm, &bufPos, &bufEnd,
+                                               growJsonNetworkBuffer, &jb,
+                                               NULL, 0, NULL, 0, true);
     if(res != UA_STATUSCODE_GOOD) {
-        cm->freeNetworkBuffer(cm, sendChannel, &buf);
+        cm->freeNetworkBuffer(cm, sendChannel, &jb.buf);
         return res;
     }
-    UA_assert(bufPos == bufEnd);
+
+    /* Only send the encoded part */
+    jb.buf.length = (uintptr_t)bufPos - (uintptr_t)jb.buf.data;
+    wg->jsonMessageSize = jb.buf.length;
 
     /* Send the prepared messages */
-    sendNetworkMessageBuffer(server, wg, connection, sendChannel, &buf);
+    sendNetworkMessageBuffer(server, wg, connection, sendChannel, &jb.buf);
     return UA_STATUSCODE_GOOD;
 }
 #endif
@@ -1143,51 +1444,40 @@ sendNetworkMessageBinary(UA_Server *server, UA_PubSubConnection *connection, UA_
     return UA_STATUSCODE_GOOD;
 }
 
-static void
-publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *connection) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+/* Encode the current values into the buffered message. If the values are
+ * guarded by a sequence counter, retry until a consistent snapshot was
+ * encoded. */
+static UA_StatusCode
+updateBufferedPayload(UA_WriterGroup *wg) {
+    UA_UInt32 *sequence = wg->config.rtValueSequence;
+    if(!sequence)
+        return UA_NetworkMessage_updateBufferedPayload(&wg->bufferedMessage);
+    UA_UInt32 start;
+    UA_StatusCode res;
+    do {
+        start = UA_PubSub_beginValueRead(sequence);
+        res = UA_NetworkMessage_updateBufferedPayload(&wg->bufferedMessage);
+    } while(UA_PubSub_retryValueRead(sequence, start));
+    return res;
+}
 
+/* Can be called without the server lock from within the WriterGroup rtGuard.
+ * Only a failure of the send operation is returned. Then the WriterGroup and
+ * the PubSubConnection need to be set into the error state (with the lock). */
+static UA_StatusCode
+publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *connection) {
     UA_StatusCode res =
-        UA_NetworkMessage_updateBufferedMessage(&writerGroup->bufferedMessage);
-
+        UA_NetworkMessage_updateBufferedSequenceNumbers(&writerGroup->bufferedMessage);
+    res |= updateBufferedPayload(writerGroup);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_DEBUG_WRITERGROUP(&server->config.logger, writerGroup,
                                  "PubSub sending. Unknown field type.");
-        return;
-    }
-
-    UA_ByteString *buf = &writerGroup->bufferedMessage.buffer;
-
-#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    /* Send the encrypted buffered message if PubSub encryption is enabled */
-    if(writerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
-        size_t sigSize = writerGroup->config.securityPolicy->symmetricModule.cryptoModule.
-            signatureAlgorithm.getLocalSignatureSize(writerGroup->securityPolicyContext);
-
-        UA_Byte payloadOffset = (UA_Byte)(writerGroup->bufferedMessage.payloadPosition -
-                                          writerGroup->bufferedMessage.buffer.data);
-        memcpy(writerGroup->bufferedMessage.encryptBuffer.data,
-               writerGroup->bufferedMessage.buffer.data,
-               writerGroup->bufferedMessage.buffer.length);
-        res = encryptAndSign(writerGroup, writerGroup->bufferedMessage.nm,
-                             writerGroup->bufferedMessage.encryptBuffer.data,
-                             writerGroup->bufferedMessage.encryptBuffer.data + payloadOffset,
-                             writerGroup->bufferedMessage.encryptBuffer.data +
-                                 writerGroup->bufferedMessage.encryptBuffer.length - sigSize);
-
-        if(res != UA_STATUSCODE_GOOD) {
-            UA_LOG_ERROR_WRITERGROUP(&server->config.logger, writerGroup,
-                                     "PubSub Encryption failed");
-            return;
-        }
-
-        buf = &writerGroup->bufferedMessage.encryptBuffer;
+        return UA_STATUSCODE_GOOD;
     }
-#endif
 
     UA_ConnectionManager *cm = connection->cm;
     if(!cm)
-        return;
+        return UA_STATUSCODE_GOOD;
 
     /* Select the wg sendchannel if configured */
     uintptr_t sendChannel = connection->sendChannel;
@@ -1196,19 +1486,56 @@ publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *c
     if(sendChannel == 0) {
         UA_LOG_ERROR_WRITERGROUP(&server->config.logger, writerGroup,
                                  "Cannot send, no open connection");
-        return;
+        return UA_STATUSCODE_GOOD;
     }
 
     /* Copy into the network buffer */
+    const UA_ByteString *buf = &writerGroup->bufferedMessage.buffer;
     UA_ByteString outBuf;
     res = cm->allocNetworkBuffer(cm, sendChannel, &outBuf, buf->length);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR_WRITERGROUP(&server->config.logger, writerGroup,
                                  "PubSub message memory allocation failed");
-        return;
+        return UA_STATUSCODE_GOOD;
     }
     memcpy(outBuf.data, buf->data, buf->length);
-    sendNetworkMessageBuffer(server, writerGroup, connection, sendChannel, &outBuf);
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    /* Encrypt and sign in-place in the network buffer. The buffered message
+     * remains in plaintext for the next cycle. */
+    if(writerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        size_t sigSize = writerGroup->config.securityPolicy->symmetricModule.cryptoModule.
+            signatureAlgorithm.getLocalSignatureSize(writerGroup->securityPolicyContext);
+        size_t payloadOffset = (size_t)(writerGroup->bufferedMessage.payloadPosition -
+                                        buf->data);
+        res = encryptAndSign(writerGroup, writerGroup->bufferedMessage.nm,
+                             outBuf.data, outBuf.data + payloadOffset,
+                             outBuf.data + buf->length - sigSize);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR_WRITERGROUP(&server->config.logger, writerGroup,
+                                     "PubSub Encryption failed");
+            cm->freeNetworkBuffer(cm, sendChannel, &outBuf);
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+#endif
+
+    /* Send and increase the sequence number */
+    res = sendWithConnection(writerGroup, cm, sendChannel, &outBuf);
+    if(res == UA_STATUSCODE_GOOD)
+        writerGroup->sequenceNumber++;
+    return res;
+}
+
+/* Sending failed, set the WriterGroup into an error mode */
+static void
+publishRTFailed(UA_Server *server, UA_WriterGroup *wg, UA_StatusCode res) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_LOG_ERROR_WRITERGROUP(&server->config.logger, wg,
+                             "Sending NetworkMessage failed");
+    UA_WriterGroup_setPubSubState(server, wg, UA_PUBSUBSTATE_ERROR);
+    UA_PubSubConnection_setPubSubState(server, wg->linkedConnection,
+                                       UA_PUBSUBSTATE_ERROR, res);
 }
 
 static void
@@ -1238,6 +1565,22 @@ sendNetworkMessage(UA_Server *server, UA_WriterGroup *wg, UA_PubSubConnection *c
     }
 }
 
+/* The values of the direct value access point into the information model. The
+ * fields of delta frames are owned by the DataSetWriter. */
+static void
+clearDataSetMessage(UA_WriterGroup *wg, UA_DataSetMessage *dsm) {
+    if(wg->config.rtLevel == UA_PUBSUB_RT_DIRECT_VALUE_ACCESS &&
+       dsm->header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME) {
+        for(size_t i = 0; i < dsm->data.keyFrameData.fieldCount; ++i)
+            dsm->data.keyFrameData.dataSetFields[i].value.data = NULL;
+    }
+    if(dsm->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME) {
+        dsm->data.deltaFrameData.deltaFrameFields = NULL;
+        dsm->data.deltaFrameData.fieldCount = 0;
+    }
+    UA_DataSetMessage_clear(dsm);
+}
+
 /* This callback triggers the collection and publish of NetworkMessages and the
  * contained DataSetMessages. */
 void
@@ -1245,13 +1588,34 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     UA_assert(writerGroup != NULL);
     UA_assert(server != NULL);
 
+    /* Realtime fast path without the server lock. The guard is only enabled
+     * while the WriterGroup is frozen and operational. */
+    if(UA_PubSubRTGuard_enter(&writerGroup->rtGuard)) {
+        UA_StatusCode res =
+            publishRT(server, writerGroup, writerGroup->linkedConnection);
+        UA_PubSubRTGuard_leave(&writerGroup->rtGuard);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOCK(&server->serviceMutex);
+            publishRTFailed(server, writerGroup, res);
+            UA_UNLOCK(&server->serviceMutex);
+        }
+        return;
+    }
+
     UA_LOCK(&server->serviceMutex);
+    publishWriterGroup(server, writerGroup);
+    UA_UNLOCK(&server->serviceMutex);
+}
 
+/* Collect and publish the NetworkMessages of the WriterGroup with the server
+ * lock */
+static void
+publishWriterGroup(UA_Server *server, UA_WriterGroup *writerGroup) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
     UA_LOG_DEBUG_WRITERGROUP(&server->config.logger, writerGroup, "Publish Callback");
 
     /* Nothing to do? */
     if(writerGroup->writersCount == 0) {
-        UA_UNLOCK(&server->serviceMutex);
         return;
     }
 
@@ -1261,14 +1625,14 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
         UA_LOG_ERROR_WRITERGROUP(&server->config.logger, writerGroup,
                                  "Publish failed. PubSubConnection invalid");
         UA_WriterGroup_setPubSubState(server, writerGroup, UA_PUBSUBSTATE_ERROR);
-        UA_UNLOCK(&server->serviceMutex);
         return;
     }
 
     /* Realtime path - update the buffer message and send directly */
     if(writerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
-        publishRT(server, writerGroup, connection);
-        UA_UNLOCK(&server->serviceMutex);
+        UA_StatusCode res = publishRT(server, writerGroup, connection);
+        if(res != UA_STATUSCODE_GOOD)
+            publishRTFailed(server, writerGroup, res);
         return;
     }
 
@@ -1322,13 +1686,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
                                &dsWriterIds[dsmCount], 1);
 
             /* Clean up the current store entry */
-            if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DIRECT_VALUE_ACCESS &&
-               dsmStore[dsmCount].header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME) {
-                for(size_t i = 0; i < dsmStore[dsmCount].data.keyFrameData.fieldCount; ++i) {
-                    dsmStore[dsmCount].data.keyFrameData.dataSetFields[i].value.data = NULL;
-                }
-            }
-            UA_DataSetMessage_clear(&dsmStore[dsmCount]);
+            clearDataSetMessage(writerGroup, &dsmStore[dsmCount]);
 
             continue; /* Don't increase the dsmCount, reuse the slot */
         }
@@ -1348,17 +1706,8 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     }
 
     /* Clean up DSM */
-    for(size_t i = 0; i < dsmCount; i++) {
-        if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DIRECT_VALUE_ACCESS &&
-           dsmStore[i].header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME) {
-            for(size_t j = 0; j < dsmStore[i].data.keyFrameData.fieldCount; ++j) {
-                dsmStore[i].data.keyFrameData.dataSetFields[j].value.data = NULL;
-            }
-        }
-        UA_DataSetMessage_clear(&dsmStore[i]);
-    }
-
-    UA_UNLOCK(&server->serviceMutex);
+    for(size_t i = 0; i < dsmCount; i++)
+        clearDataSetMessage(writerGroup, &dsmStore[i]);
 }
 
 #endif /* UA_ENABLE_PUBSUB */
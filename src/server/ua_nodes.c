@@ -60,7 +60,7 @@ UA_NodePointer_clear(UA_NodePointer *np) {
     switch(np->immediate & UA_NODEPOINTER_MASK) {
     case UA_NODEPOINTER_TAG_NODEID:
         np->immediate &= ~(uintptr_t)UA_NODEPOINTER_MASK;
-        UA_NodeId_delete((UA_NodeId*)(uintptr_t)np->id);
+        UA_InternTable_releaseNodeId(np->id);
         break;
     case UA_NODEPOINTER_TAG_EXPANDEDNODEID:
         np->immediate &= ~(uintptr_t)UA_NODEPOINTER_MASK;
@@ -84,15 +84,10 @@ UA_NodePointer_copy(UA_NodePointer in, UA_NodePointer *out) {
         goto nodeid; /* fallthrough */
     case UA_NODEPOINTER_TAG_NODEID:
     nodeid:
-        out->id = UA_NodeId_new();
-        if(!out->id)
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        res = UA_NodeId_copy(in.id, (UA_NodeId*)(uintptr_t)out->id);
-        if(res != UA_STATUSCODE_GOOD) {
-            UA_free((void*)out->immediate);
-            out->immediate = 0;
+        /* The NodeIds are shared via the intern table */
+        res = UA_InternTable_addNodeId(in.id, &out->id);
+        if(res != UA_STATUSCODE_GOOD)
             break;
-        }
         out->immediate |= UA_NODEPOINTER_TAG_NODEID;
         break;
     case UA_NODEPOINTER_TAG_EXPANDEDNODEID:
@@ -302,6 +297,99 @@ removeTreeEntry(void *context, UA_ReferenceTargetTreeElem *elem) {
     return NULL;
 }
 
+static int
+cmpRefTargetOrder(const void *a, const void *b) {
+    const UA_ReferenceTarget *aa = (const UA_ReferenceTarget*)a;
+    const UA_ReferenceTarget *bb = (const UA_ReferenceTarget*)b;
+    return (int)UA_NodePointer_order(aa->targetId, bb->targetId);
+}
+
+static int
+cmpUInt64(const void *a, const void *b) {
+    UA_UInt64 aa = *(const UA_UInt64*)a;
+    UA_UInt64 bb = *(const UA_UInt64*)b;
+    if(aa == bb)
+        return 0;
+    return (aa < bb) ? -1 : 1;
+}
+
+/* Position of the first target in the compact array that is not ordered before
+ * the targetId */
+static size_t
+compactLowerBound(const UA_NodeReferenceKind *rk, UA_NodePointer targetId) {
+    size_t lo = 0, hi = rk->targetsSize;
+    while(lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if(UA_NodePointer_order(rk->targets.compact.array[mid].targetId,
+                                targetId) == UA_ORDER_LESS)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+size_t
+compactNameLowerBound(const UA_NodeReferenceKind *rk, UA_UInt32 nameHash) {
+    const UA_ReferenceTarget *array = rk->targets.compact.array;
+    const UA_UInt32 *nameIndex = rk->targets.compact.nameIndex;
+    size_t lo = 0, hi = rk->targetsSize;
+    while(lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if(array[nameIndex[mid]].targetNameHash < nameHash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+UA_StatusCode
+UA_NodeReferenceKind_compact(UA_NodeReferenceKind *rk) {
+    UA_assert(rk->targetsSize > 0);
+    UA_assert(rk->targetsSize <= UA_UINT32_MAX);
+    if(rk->isCompact)
+        return UA_STATUSCODE_GOOD;
+
+    /* Allocate everything upfront. So the conversion cannot fail halfway. */
+    size_t size = rk->targetsSize;
+    UA_UInt32 *nameIndex = (UA_UInt32*)UA_malloc(sizeof(UA_UInt32) * size);
+    UA_UInt64 *sortKeys = (UA_UInt64*)UA_malloc(sizeof(UA_UInt64) * size);
+    UA_ReferenceTarget *array = rk->targets.array;
+    if(rk->hasRefTree)
+        array = (UA_ReferenceTarget*)UA_malloc(sizeof(UA_ReferenceTarget) * size);
+    if(!nameIndex || !sortKeys || !array) {
+        UA_free(nameIndex);
+        UA_free(sortKeys);
+        if(rk->hasRefTree)
+            UA_free(array);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Move the tree elements into the array. The tree is ordered by the hash
+     * of the targetId. So the array needs to be sorted in any case. */
+    if(rk->hasRefTree) {
+        size_t pos = 0;
+        moveTreeToArray(array, &pos, rk->targets.tree.idRoot);
+    }
+    qsort(array, size, sizeof(UA_ReferenceTarget), cmpRefTargetOrder);
+
+    /* Sort the array positions by the BrowseName hash. The position is in the
+     * lower half of the sort key. */
+    for(size_t i = 0; i < size; i++)
+        sortKeys[i] = ((UA_UInt64)array[i].targetNameHash << 32) | (UA_UInt64)i;
+    qsort(sortKeys, size, sizeof(UA_UInt64), cmpUInt64);
+    for(size_t i = 0; i < size; i++)
+        nameIndex[i] = (UA_UInt32)sortKeys[i];
+    UA_free(sortKeys);
+
+    rk->targets.compact.array = array;
+    rk->targets.compact.nameIndex = nameIndex;
+    rk->hasRefTree = false;
+    rk->isCompact = true;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_NodeReferenceKind_switch(UA_NodeReferenceKind *rk) {
     UA_assert(rk->targetsSize > 0);
@@ -319,9 +407,10 @@ UA_NodeReferenceKind_switch(UA_NodeReferenceKind *rk) {
         return UA_STATUSCODE_GOOD;
     }
 
-    /* From array to tree */
+    /* From array (or the compact array) to tree */
     UA_NodeReferenceKind newRk = *rk;
     newRk.hasRefTree = true;
+    newRk.isCompact = false;
     newRk.targets.tree.idRoot = NULL;
     newRk.targets.tree.nameRoot = NULL;
     newRk.targetsSize = 0;
@@ -339,6 +428,8 @@ UA_NodeReferenceKind_switch(UA_NodeReferenceKind *rk) {
     for(size_t i = 0; i < rk->targetsSize; i++)
         UA_NodePointer_clear(&rk->targets.array[i].targetId);
     UA_free(rk->targets.array);
+    if(rk->isCompact)
+        UA_free(rk->targets.compact.nameIndex);
     *rk = newRk;
     return UA_STATUSCODE_GOOD;
 }
@@ -373,6 +464,12 @@ UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
                      (uintptr_t)&rk->targets.tree.idRoot, &tmpTarget);
         if(result)
             return &result->target;
+    } else if(rk->isCompact) {
+        /* Binary search in the sorted array */
+        size_t pos = compactLowerBound(rk, targetP);
+        if(pos < rk->targetsSize &&
+           UA_NodePointer_equal(targetP, rk->targets.compact.array[pos].targetId))
+            return &rk->targets.compact.array[pos];
     } else {
         /* Return from the array */
         for(size_t i = 0; i < rk->targetsSize; i++) {
@@ -383,6 +480,25 @@ UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *rk,
     return NULL;
 }
 
+/* The strings of the BrowseName and the LocalizedTexts are interned */
+
+static UA_StatusCode
+internLocalizedText(const UA_LocalizedText *src, UA_LocalizedText *dst) {
+    UA_StatusCode res = UA_InternTable_addString(&src->locale, &dst->locale);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = UA_InternTable_addString(&src->text, &dst->text);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_InternTable_releaseString(&dst->locale);
+    return res;
+}
+
+static void
+releaseLocalizedText(UA_LocalizedText *lt) {
+    UA_InternTable_releaseString(&lt->locale);
+    UA_InternTable_releaseString(&lt->text);
+}
+
 /* General node handling methods. There is no UA_Node_new() method here.
  * Creating nodes is part of the Nodestore layer */
 
@@ -393,19 +509,20 @@ void UA_Node_clear(UA_Node *node) {
     /* Delete other head content */
     UA_NodeHead *head = &node->head;
     UA_NodeId_clear(&head->nodeId);
-    UA_QualifiedName_clear(&head->browseName);
+    UA_InternTable_releaseString(&head->browseName.name);
+    head->browseName.namespaceIndex = 0;
 
     UA_LocalizedTextListEntry *lt;
 
     while((lt = head->displayName)) {
         head->displayName = lt->next;
-        UA_LocalizedText_clear(&lt->localizedText);
+        releaseLocalizedText(&lt->localizedText);
         UA_free(lt);
     }
 
     while((lt = head->description)) {
         head->description = lt->next;
-        UA_LocalizedText_clear(&lt->localizedText);
+        releaseLocalizedText(&lt->localizedText);
         UA_free(lt);
     }
 
@@ -545,7 +662,9 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
 
     /* Copy standard content */
     UA_StatusCode retval = UA_NodeId_copy(&srchead->nodeId, &dsthead->nodeId);
-    retval |= UA_QualifiedName_copy(&srchead->browseName, &dsthead->browseName);
+    dsthead->browseName.namespaceIndex = srchead->browseName.namespaceIndex;
+    retval |= UA_InternTable_addString(&srchead->browseName.name,
+                                       &dsthead->browseName.name);
 
     /* Copy the display name in several languages */
     for(UA_LocalizedTextListEntry *lt = srchead->displayName; lt != NULL; lt = lt->next) {
@@ -555,7 +674,7 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
             retval |= UA_STATUSCODE_BADOUTOFMEMORY;
             break;
         }
-        retval |= UA_LocalizedText_copy(&lt->localizedText, &newEntry->localizedText);
+        retval |= internLocalizedText(&lt->localizedText, &newEntry->localizedText);
 
         /* Add to the linked list possibly in reverse order */
         newEntry->next = dsthead->displayName;
@@ -570,7 +689,7 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
             retval |= UA_STATUSCODE_BADOUTOFMEMORY;
             break;
         }
-        retval |= UA_LocalizedText_copy(&lt->localizedText, &newEntry->localizedText);
+        retval |= internLocalizedText(&lt->localizedText, &newEntry->localizedText);
 
         /* Add to the linked list possibly in reverse order */
         newEntry->next = dsthead->description;
@@ -605,6 +724,7 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
             drefs->referenceTypeIndex = srefs->referenceTypeIndex;
             drefs->isInverse = srefs->isInverse;
             drefs->hasRefTree = srefs->hasRefTree; /* initially empty */
+            drefs->isCompact = srefs->isCompact;
 
             /* Copy all the targets */
             if(!srefs->hasRefTree) {
@@ -614,6 +734,17 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
                     UA_Node_clear(dst);
                     return UA_STATUSCODE_BADOUTOFMEMORY;
                 }
+                if(srefs->isCompact) {
+                    drefs->targets.compact.nameIndex = (UA_UInt32*)
+                        UA_malloc(sizeof(UA_UInt32) * srefs->targetsSize);
+                    if(!drefs->targets.compact.nameIndex) {
+                        UA_Node_clear(dst);
+                        return UA_STATUSCODE_BADOUTOFMEMORY;
+                    }
+                    memcpy(drefs->targets.compact.nameIndex,
+                           srefs->targets.compact.nameIndex,
+                           sizeof(UA_UInt32) * srefs->targetsSize);
+                }
                 for(size_t j = 0; j < srefs->targetsSize; j++) {
                     drefs->targets.array[j].targetNameHash =
                         srefs->targets.array[j].targetNameHash;
@@ -721,6 +852,59 @@ UA_Node_copy_alloc(const UA_Node *src) {
     }
     return dst;
 }
+
+/* Only the top-level array of the value. Without the members of structured
+ * types. */
+static size_t
+variantMemoryUsage(const UA_Variant *v) {
+    if(!v->type || v->data <= UA_EMPTY_ARRAY_SENTINEL)
+        return 0;
+    size_t length = (v->arrayLength > 0) ? v->arrayLength : 1;
+    return (length * v->type->memSize) +
+        (v->arrayDimensionsSize * sizeof(UA_UInt32));
+}
+
+size_t
+UA_Node_getMemoryUsage(const UA_Node *node) {
+    const UA_NodeHead *head = &node->head;
+    size_t size = 0;
+    if(head->nodeId.identifierType == UA_NODEIDTYPE_STRING ||
+       head->nodeId.identifierType == UA_NODEIDTYPE_BYTESTRING)
+        size += head->nodeId.identifier.string.length;
+
+    /* The text of the LocalizedTexts is interned */
+    for(UA_LocalizedTextListEntry *lt = head->displayName; lt; lt = lt->next)
+        size += sizeof(UA_LocalizedTextListEntry);
+    for(UA_LocalizedTextListEntry *lt = head->description; lt; lt = lt->next)
+        size += sizeof(UA_LocalizedTextListEntry);
+
+    /* References. The target NodeIds are interned. */
+    size += head->referencesSize * sizeof(UA_NodeReferenceKind);
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &head->references[i];
+        if(rk->hasRefTree)
+            size += rk->targetsSize * sizeof(UA_ReferenceTargetTreeElem);
+        else if(rk->isCompact)
+            size += rk->targetsSize * (sizeof(UA_ReferenceTarget) + sizeof(UA_UInt32));
+        else
+            size += rk->targetsSize * sizeof(UA_ReferenceTarget);
+    }
+
+    /* Value and ArrayDimensions */
+    if(head->nodeClass == UA_NODECLASS_VARIABLE) {
+        const UA_VariableNode *vn = &node->variableNode;
+        size += vn->arrayDimensionsSize * sizeof(UA_UInt32);
+        if(vn->valueSource == UA_VALUESOURCE_DATA)
+            size += variantMemoryUsage(&vn->value.data.value.value);
+    } else if(head->nodeClass == UA_NODECLASS_VARIABLETYPE) {
+        const UA_VariableTypeNode *vtn = &node->variableTypeNode;
+        size += vtn->arrayDimensionsSize * sizeof(UA_UInt32);
+        if(vtn->valueSource == UA_VALUESOURCE_DATA)
+            size += variantMemoryUsage(&vtn->value.data.value.value);
+    }
+    return size;
+}
+
 /******************************/
 /* Copy Attributes into Nodes */
 /******************************/
@@ -920,6 +1104,87 @@ addReferenceTargetToTree(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Insert at the sorted position. Moves the entries behind the new target. */
+static UA_StatusCode
+addReferenceTargetToCompact(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
+                            UA_UInt32 targetNameHash) {
+    size_t size = rk->targetsSize;
+    if(size >= UA_UINT32_MAX)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Grow the buffers. The array can remain larger if the second realloc
+     * fails. */
+    UA_ReferenceTarget *array = (UA_ReferenceTarget*)
+        UA_realloc(rk->targets.compact.array,
+                   sizeof(UA_ReferenceTarget) * (size + 1));
+    if(!array)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    rk->targets.compact.array = array;
+    UA_UInt32 *nameIndex = (UA_UInt32*)
+        UA_realloc(rk->targets.compact.nameIndex, sizeof(UA_UInt32) * (size + 1));
+    if(!nameIndex)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    rk->targets.compact.nameIndex = nameIndex;
+
+    UA_ReferenceTarget target;
+    UA_StatusCode res = UA_NodePointer_copy(targetId, &target.targetId);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    target.targetNameHash = targetNameHash;
+
+    /* Insert into the array */
+    size_t pos = compactLowerBound(rk, target.targetId);
+    memmove(&array[pos + 1], &array[pos], sizeof(UA_ReferenceTarget) * (size - pos));
+    array[pos] = target;
+
+    /* Update the positions in the name index and insert the new position */
+    for(size_t i = 0; i < size; i++) {
+        if(nameIndex[i] >= pos)
+            nameIndex[i]++;
+    }
+    size_t namePos = compactNameLowerBound(rk, targetNameHash);
+    memmove(&nameIndex[namePos + 1], &nameIndex[namePos],
+            sizeof(UA_UInt32) * (size - namePos));
+    nameIndex[namePos] = (UA_UInt32)pos;
+
+    rk->targetsSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Remove from the sorted array and the name index. The targetsSize was already
+ * decreased. */
+static void
+deleteReferenceTargetFromCompact(UA_NodeReferenceKind *rk,
+                                 UA_ReferenceTarget *target) {
+    UA_ReferenceTarget *array = rk->targets.compact.array;
+    UA_UInt32 *nameIndex = rk->targets.compact.nameIndex;
+    size_t size = rk->targetsSize;
+    size_t pos = (size_t)(target - array);
+    UA_NodePointer_clear(&target->targetId);
+    memmove(&array[pos], &array[pos + 1], sizeof(UA_ReferenceTarget) * (size - pos));
+
+    /* Remove the position from the name index and update the positions behind
+     * the removed target */
+    size_t j = 0;
+    for(size_t i = 0; i <= size; i++) {
+        UA_UInt32 p = nameIndex[i];
+        if(p == pos)
+            continue;
+        nameIndex[j++] = (p > pos) ? p - 1 : p;
+    }
+
+    /* Shrink the buffers. Realloc is allowed to fail. */
+    if(size == 0)
+        return;
+    array = (UA_ReferenceTarget*)
+        UA_realloc(array, sizeof(UA_ReferenceTarget) * size);
+    if(array)
+        rk->targets.compact.array = array;
+    nameIndex = (UA_UInt32*)UA_realloc(nameIndex, sizeof(UA_UInt32) * size);
+    if(nameIndex)
+        rk->targets.compact.nameIndex = nameIndex;
+}
+
 static UA_StatusCode
 addReferenceTarget(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
                    UA_UInt32 targetNameHash) {
@@ -930,6 +1195,10 @@ addReferenceTarget(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
                                         targetNameHash);
     }
 
+    /* Insert into the compact array */
+    if(rk->isCompact)
+        return addReferenceTargetToCompact(rk, targetId, targetNameHash);
+
     /* Insert to the array */
     UA_ReferenceTarget *newRefs = (UA_ReferenceTarget*)
         UA_realloc(rk->targets.array,
@@ -1035,7 +1304,14 @@ UA_Node_deleteReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForwar
         /* Ok, delete the reference. Cannot fail */
         refs->targetsSize--;
 
-        if(!refs->hasRefTree) {
+        if(refs->isCompact) {
+            /* Remove from the compact array */
+            deleteReferenceTargetFromCompact(refs, target);
+            if(refs->targetsSize > 0)
+                return UA_STATUSCODE_GOOD;
+            UA_free(refs->targets.compact.array);
+            UA_free(refs->targets.compact.nameIndex);
+        } else if(!refs->hasRefTree) {
             /* Remove from array */
             UA_NodePointer_clear(&target->targetId);
 
@@ -1103,6 +1379,8 @@ UA_Node_deleteReferencesSubset(UA_Node *node, const UA_ReferenceTypeSet *keepSet
             for(size_t j = 0; j < refs->targetsSize; j++)
                 UA_NodePointer_clear(&refs->targets.array[j].targetId);
             UA_free(refs->targets.array);
+            if(refs->isCompact)
+                UA_free(refs->targets.compact.nameIndex);
         } else {
             ZIP_ITER(UA_ReferenceIdTree,
                      (UA_ReferenceIdTree*)&refs->targets.tree.idRoot,
@@ -1153,7 +1431,7 @@ UA_Node_insertOrUpdateLocale(UA_LocalizedTextListEntry **root,
                 *root = lt->next;
             else
                 prev->next = lt->next;
-            UA_LocalizedText_clear(&lt->localizedText);
+            releaseLocalizedText(&lt->localizedText);
             UA_free(lt);
             return UA_STATUSCODE_GOOD;
         }
@@ -1161,11 +1439,11 @@ UA_Node_insertOrUpdateLocale(UA_LocalizedTextListEntry **root,
         /* First make a copy of the text, if this succeeds replace the old
          * version */
         UA_String tmp;
-        res = UA_String_copy(&value->text, &tmp);
+        res = UA_InternTable_addString(&value->text, &tmp);
         if(res != UA_STATUSCODE_GOOD)
             return res;
 
-        UA_String_clear(&lt->localizedText.text);
+        UA_InternTable_releaseString(&lt->localizedText.text);
         lt->localizedText.text = tmp;
         return UA_STATUSCODE_GOOD;
     }
@@ -1181,7 +1459,7 @@ UA_Node_insertOrUpdateLocale(UA_LocalizedTextListEntry **root,
     if(!lt)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    res = UA_LocalizedText_copy(value, &lt->localizedText);
+    res = internLocalizedText(value, &lt->localizedText);
     if(res != UA_STATUSCODE_GOOD) {
         UA_free(lt);
         return res;
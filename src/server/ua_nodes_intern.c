@@ -0,0 +1,249 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+
+/* The intern table is global. So identical values are shared also between the
+ * nodestores of several servers. They can run in different threads also
+ * without UA_MULTITHREADING. So the table is always protected. Use a spinlock
+ * on non-POSIX as we cannot statically initialize a global lock. Without
+ * UA_MULTITHREADING the UA_atomic_* functions are not atomic. Then the
+ * spinlock uses the compiler intrinsics directly. */
+#if UA_MULTITHREADING >= 100
+# ifdef UA_ARCHITECTURE_POSIX
+static UA_Lock internLock = UA_LOCK_STATIC_INIT;
+#  define INTERN_LOCK() UA_LOCK(&internLock)
+#  define INTERN_UNLOCK() UA_UNLOCK(&internLock)
+# else
+static void * volatile internSpinLock = NULL;
+#  define INTERN_LOCK() \
+    while(UA_atomic_cmpxchg(&internSpinLock, NULL, (void*)0x1) != NULL) {}
+#  define INTERN_UNLOCK() UA_atomic_xchg(&internSpinLock, NULL)
+# endif
+#elif defined(__GNUC__) /* GCC/Clang */
+static volatile int internSpinLock = 0;
+# define INTERN_LOCK() while(__sync_lock_test_and_set(&internSpinLock, 1)) {}
+# define INTERN_UNLOCK() __sync_lock_release(&internSpinLock)
+#elif defined(_MSC_VER) /* Visual Studio */
+# include <intrin.h>
+static volatile long internSpinLock = 0;
+# define INTERN_LOCK() while(_InterlockedExchange(&internSpinLock, 1)) {}
+# define INTERN_UNLOCK() _InterlockedExchange(&internSpinLock, 0)
+#else
+# warning The intern table is not protected. Use servers from only one thread.
+# define INTERN_LOCK()
+# define INTERN_UNLOCK()
+#endif
+
+/* Interned Strings. The string content is stored behind the entry. */
+
+typedef struct {
+    UA_UInt32 hash;
+    UA_String str;
+} InternedStringKey;
+
+typedef struct InternedString {
+    ZIP_ENTRY(InternedString) treeEntry;
+    InternedStringKey key;
+    size_t refCount;
+} InternedString;
+
+static enum ZIP_CMP
+cmpInternedString(const InternedStringKey *a, const InternedStringKey *b) {
+    if(a->hash != b->hash)
+        return (a->hash < b->hash) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    return (enum ZIP_CMP)UA_order(&a->str, &b->str, &UA_TYPES[UA_TYPES_STRING]);
+}
+
+typedef ZIP_HEAD(InternedStringTree, InternedString) InternedStringTree;
+ZIP_FUNCTIONS(InternedStringTree, InternedString, treeEntry,
+              InternedStringKey, key, cmpInternedString)
+
+/* Interned NodeIds. The string identifier is stored behind the entry. */
+
+typedef struct {
+    UA_UInt32 hash;
+    UA_NodeId id;
+} InternedNodeIdKey;
+
+typedef struct InternedNodeId {
+    ZIP_ENTRY(InternedNodeId) treeEntry;
+    InternedNodeIdKey key;
+    size_t refCount;
+} InternedNodeId;
+
+static enum ZIP_CMP
+cmpInternedNodeId(const InternedNodeIdKey *a, const InternedNodeIdKey *b) {
+    if(a->hash != b->hash)
+        return (a->hash < b->hash) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    return (enum ZIP_CMP)UA_NodeId_order(&a->id, &b->id);
+}
+
+typedef ZIP_HEAD(InternedNodeIdTree, InternedNodeId) InternedNodeIdTree;
+ZIP_FUNCTIONS(InternedNodeIdTree, InternedNodeId, treeEntry,
+              InternedNodeIdKey, key, cmpInternedNodeId)
+
+static InternedStringTree internedStrings = {NULL};
+static InternedNodeIdTree internedNodeIds = {NULL};
+static UA_InternTableStatistics internStats;
+
+/* Size of the string identifier stored behind the entry */
+static size_t
+nodeIdPayload(const UA_NodeId *id) {
+    if(id->identifierType == UA_NODEIDTYPE_STRING ||
+       id->identifierType == UA_NODEIDTYPE_BYTESTRING)
+        return id->identifier.string.length;
+    return 0;
+}
+
+UA_StatusCode
+UA_InternTable_addString(const UA_String *src, UA_String *dst) {
+    /* Empty strings don't allocate memory */
+    if(src->length == 0)
+        return UA_String_copy(src, dst);
+
+    InternedStringKey key;
+    key.hash = UA_ByteString_hash(0, src->data, src->length);
+    key.str = *src;
+
+    INTERN_LOCK();
+    InternedString *entry = ZIP_FIND(InternedStringTree, &internedStrings, &key);
+    if(entry) {
+        entry->refCount++;
+        internStats.references++;
+        internStats.savedBytes += src->length;
+        *dst = entry->key.str;
+        INTERN_UNLOCK();
+        return UA_STATUSCODE_GOOD;
+    }
+
+    entry = (InternedString*)UA_malloc(sizeof(InternedString) + src->length);
+    if(!entry) {
+        INTERN_UNLOCK();
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    entry->key.hash = key.hash;
+    entry->key.str.length = src->length;
+    entry->key.str.data = (UA_Byte*)&entry[1];
+    memcpy(entry->key.str.data, src->data, src->length);
+    entry->refCount = 1;
+    ZIP_INSERT(InternedStringTree, &internedStrings, entry);
+    internStats.entries++;
+    internStats.references++;
+    internStats.bytes += sizeof(InternedString) + src->length;
+    *dst = entry->key.str;
+    INTERN_UNLOCK();
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_InternTable_releaseString(UA_String *s) {
+    if(s->length == 0) {
+        UA_String_clear(s);
+        return;
+    }
+
+    InternedStringKey key;
+    key.hash = UA_ByteString_hash(0, s->data, s->length);
+    key.str = *s;
+
+    INTERN_LOCK();
+    InternedString *entry = ZIP_FIND(InternedStringTree, &internedStrings, &key);
+    if(!entry || entry->key.str.data != s->data) {
+        /* Not interned */
+        INTERN_UNLOCK();
+        UA_String_clear(s);
+        return;
+    }
+    internStats.references--;
+    entry->refCount--;
+    if(entry->refCount > 0) {
+        internStats.savedBytes -= s->length;
+    } else {
+        ZIP_REMOVE(InternedStringTree, &internedStrings, entry);
+        internStats.entries--;
+        internStats.bytes -= sizeof(InternedString) + s->length;
+        UA_free(entry);
+    }
+    INTERN_UNLOCK();
+    UA_String_init(s);
+}
+
+UA_StatusCode
+UA_InternTable_addNodeId(const UA_NodeId *src, const UA_NodeId **dst) {
+    InternedNodeIdKey key;
+    key.hash = UA_NodeId_hash(src);
+    key.id = *src;
+    size_t payload = nodeIdPayload(src);
+
+    INTERN_LOCK();
+    InternedNodeId *entry = ZIP_FIND(InternedNodeIdTree, &internedNodeIds, &key);
+    if(entry) {
+        entry->refCount++;
+        internStats.references++;
+        internStats.savedBytes += sizeof(UA_NodeId) + payload;
+        *dst = &entry->key.id;
+        INTERN_UNLOCK();
+        return UA_STATUSCODE_GOOD;
+    }
+
+    entry = (InternedNodeId*)UA_malloc(sizeof(InternedNodeId) + payload);
+    if(!entry) {
+        INTERN_UNLOCK();
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    entry->key = key; /* Shallow copy */
+    if(payload > 0) {
+        entry->key.id.identifier.string.data = (UA_Byte*)&entry[1];
+        memcpy(entry->key.id.identifier.string.data,
+               src->identifier.string.data, payload);
+    }
+    entry->refCount = 1;
+    ZIP_INSERT(InternedNodeIdTree, &internedNodeIds, entry);
+    internStats.entries++;
+    internStats.references++;
+    internStats.bytes += sizeof(InternedNodeId) + payload;
+    *dst = &entry->key.id;
+    INTERN_UNLOCK();
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The NodeId is part of an InternedNodeId entry if the entry found for the
+ * NodeId content contains the same pointer */
+void
+UA_InternTable_releaseNodeId(const UA_NodeId *id) {
+    InternedNodeIdKey key;
+    key.hash = UA_NodeId_hash(id);
+    key.id = *id;
+
+    INTERN_LOCK();
+    InternedNodeId *entry = ZIP_FIND(InternedNodeIdTree, &internedNodeIds, &key);
+    if(!entry || &entry->key.id != id) {
+        /* Not interned */
+        INTERN_UNLOCK();
+        UA_NodeId_delete((UA_NodeId*)(uintptr_t)id);
+        return;
+    }
+    size_t payload = nodeIdPayload(id);
+    internStats.references--;
+    entry->refCount--;
+    if(entry->refCount > 0) {
+        internStats.savedBytes -= sizeof(UA_NodeId) + payload;
+    } else {
+        ZIP_REMOVE(InternedNodeIdTree, &internedNodeIds, entry);
+        internStats.entries--;
+        internStats.bytes -= sizeof(InternedNodeId) + payload;
+        UA_free(entry);
+    }
+    INTERN_UNLOCK();
+}
+
+UA_InternTableStatistics
+UA_InternTable_getStatistics(void) {
+    INTERN_LOCK();
+    UA_InternTableStatistics stats = internStats;
+    INTERN_UNLOCK();
+    return stats;
+}
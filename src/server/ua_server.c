@@ -293,6 +293,11 @@ UA_Server_delete(UA_Server *server) {
     /* Clean up the Admin Session */
     UA_Session_clear(&server->adminSession, server);
 
+    /* Clean up the cached values */
+    UA_ValueCache_clear(&server->valueCache);
+    UA_BrowseCache_clear(&server->browseCache);
+    UA_BrowsePathCache_clear(&server->browsePathCache);
+
     /* Remove all remaining server components (must be all stopped) */
     ZIP_ITER(UA_ServerComponentTree, &server->serverComponents,
              removeServerComponent, server);
@@ -370,6 +375,11 @@ UA_Server_init(UA_Server *server) {
     LIST_INIT(&server->sessions);
     server->sessionCount = 0;
 
+    /* Initialize the cache for DataSource values */
+    UA_ValueCache_init(&server->valueCache);
+    UA_BrowseCache_init(&server->browseCache);
+    UA_BrowsePathCache_init(&server->browsePathCache);
+
 #if UA_MULTITHREADING >= 100
     UA_AsyncManager_init(&server->asyncManager, server);
 #endif
@@ -638,6 +648,44 @@ verifyServerApplicationURI(const UA_Server *server) {
     return UA_STATUSCODE_GOOD;
 }
 
+#if UA_MULTITHREADING >= 100
+/* The reactor threads of the EventLoop process the SecureChannels
+ * concurrently. Disable the reactors if a SecurityPolicy is not thread-safe.
+ * The reactors of a running EventLoop cannot be disabled. Then refuse to
+ * start. */
+static UA_StatusCode
+verifyReactors(UA_Server *server) {
+    UA_ServerConfig *config = &server->config;
+    UA_EventLoop *el = config->eventLoop;
+    const UA_QualifiedName reactorsName = UA_QUALIFIEDNAME(0, "reactors");
+    const UA_UInt16 *reactors = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(&el->params, reactorsName,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    if(!reactors || *reactors == 0)
+        return UA_STATUSCODE_GOOD;
+
+    for(size_t i = 0; i < config->securityPoliciesSize; i++) {
+        UA_SecurityPolicy *sp = &config->securityPolicies[i];
+        if(sp->threadSafe)
+            continue;
+        if(el->state == UA_EVENTLOOPSTATE_STARTED ||
+           el->state == UA_EVENTLOOPSTATE_STOPPING) {
+            UA_LOG_ERROR(&config->logger, UA_LOGCATEGORY_SERVER,
+                         "The SecurityPolicy %.*s is not thread-safe and "
+                         "cannot be used with the reactors of the EventLoop",
+                         (int)sp->policyUri.length, sp->policyUri.data);
+            return UA_STATUSCODE_BADCONFIGURATIONERROR;
+        }
+        UA_LOG_WARNING(&config->logger, UA_LOGCATEGORY_SERVER,
+                       "The SecurityPolicy %.*s is not thread-safe. "
+                       "Disabling the reactors of the EventLoop.",
+                       (int)sp->policyUri.length, sp->policyUri.data);
+        return UA_KeyValueMap_remove(&el->params, reactorsName);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 UA_ServerStatistics
 UA_Server_getStatistics(UA_Server *server) {
     UA_ServerStatistics stat;
@@ -649,6 +697,15 @@ UA_Server_getStatistics(UA_Server *server) {
     stat.ss.rejectedSessionCount = sds->rejectedSessionCount;
     stat.ss.sessionTimeoutCount = sds->sessionTimeoutCount;
     stat.ss.sessionAbortCount = sds->sessionAbortCount;
+    UA_LOCK(&server->serviceMutex);
+    stat.vcs = server->valueCache.stats;
+    stat.bcs = server->browseCache.stats;
+    stat.bpcs = server->browsePathCache.stats;
+    memset(&stat.ns, 0, sizeof(UA_NodestoreStatistics));
+    if(server->config.nodestore.getStatistics)
+        server->config.nodestore.getStatistics(server->config.nodestore.context,
+                                               &stat.ns);
+    UA_UNLOCK(&server->serviceMutex);
     return stat;
 }
 
@@ -714,6 +771,11 @@ UA_Server_run_startup(UA_Server *server) {
                        &config->logger, UA_LOGCATEGORY_SERVER,
                        "An EventLoop must be configured");
 
+#if UA_MULTITHREADING >= 100
+    retVal = verifyReactors(server);
+    UA_CHECK_STATUS(retVal, return retVal);
+#endif
+
     if(el->state != UA_EVENTLOOPSTATE_STARTED) {
         retVal = el->start(el);
         UA_CHECK_STATUS(retVal, return retVal); /* Errors are logged internally */
@@ -782,6 +844,11 @@ UA_Server_run_startup(UA_Server *server) {
     ZIP_ITER(UA_ServerComponentTree, &server->serverComponents,
              startServerComponent, server);
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+    /* Start the worker threads for parallel service operations */
+    UA_OperationWorkers_start(server);
+#endif
+
     /* Set the server to STARTED. From here on, only use
      * UA_Server_run_shutdown(server) to stop the server. */
     setServerLifecycleState(server, UA_LIFECYCLESTATE_STARTED);
@@ -848,6 +915,11 @@ UA_Server_run_shutdown(UA_Server *server) {
     UA_AsyncManager_stop(&server->asyncManager, server);
 #endif
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+    /* Stop the worker threads for parallel service operations */
+    UA_OperationWorkers_stop(server);
+#endif
+
     /* Stop the regular housekeeping tasks */
     if(server->houseKeepingCallbackId != 0) {
         removeCallback(server, server->houseKeepingCallbackId);
@@ -702,13 +702,18 @@ static const UA_String securityPolicyNone =
     UA_STRING_STATIC("http://opcfoundation.org/UA/SecurityPolicy#None");
 
 /* Returns a status of the SecureChannel. The detailed service status (usually
- * part of the response) is set in the serviceResult argument. */
+ * part of the response) is set in the serviceResult argument. The serviceMutex
+ * is held also for sending the response. So the response is not interleaved
+ * with messages sent on the same SecureChannel from another thread (e.g.
+ * PublishResponses). */
 static UA_StatusCode
 processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
                   UA_Service service, const UA_Request *request,
                   const UA_DataType *requestType, UA_Response *response,
                   const UA_DataType *responseType, UA_Boolean sessionRequired,
                   size_t counterOffset) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
     UA_Session *session = NULL;
     UA_StatusCode channelRes = UA_STATUSCODE_GOOD;
     UA_StatusCode serviceRes = UA_STATUSCODE_GOOD;
@@ -733,9 +738,7 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     if(requestType == &UA_TYPES[UA_TYPES_CREATESESSIONREQUEST] ||
        requestType == &UA_TYPES[UA_TYPES_ACTIVATESESSIONREQUEST] ||
        requestType == &UA_TYPES[UA_TYPES_CLOSESESSIONREQUEST]) {
-        UA_LOCK(&server->serviceMutex);
         ((UA_ChannelService)service)(server, channel, request, response);
-        UA_UNLOCK(&server->serviceMutex);
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
         /* Store the authentication token so we can help fuzzing by setting
          * these values in the next request automatically */
@@ -751,11 +754,9 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
 
     /* Get the Session bound to the SecureChannel (not necessarily activated) */
     if(!UA_NodeId_isNull(&requestHeader->authenticationToken)) {
-        UA_LOCK(&server->serviceMutex);
         UA_StatusCode retval =
             getBoundSession(server, channel,
                             &requestHeader->authenticationToken, &session);
-        UA_UNLOCK(&server->serviceMutex);
         if(retval != UA_STATUSCODE_GOOD) {
             serviceRes = response->responseHeader.serviceResult;
             channelRes = sendServiceFault(channel, requestId,
@@ -802,12 +803,9 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
                                "Service %" PRIu32 " refused on a non-activated session",
                                requestType->binaryEncodingId.identifier.numeric);
 #endif
-        if(session != &anonymousSession) {
-            UA_LOCK(&server->serviceMutex);
+        if(session != &anonymousSession)
             UA_Server_removeSessionByToken(server, &session->header.authenticationToken,
                                            UA_SHUTDOWNREASON_ABORT);
-            UA_UNLOCK(&server->serviceMutex);
-        }
         serviceRes = UA_STATUSCODE_BADSESSIONNOTACTIVATED;
         channelRes = sendServiceFault(channel, requestId, requestHeader->requestHandle,
                                       UA_STATUSCODE_BADSESSIONNOTACTIVATED);
@@ -822,10 +820,8 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* The publish request is not answered immediately */
     if(requestType == &UA_TYPES[UA_TYPES_PUBLISHREQUEST]) {
-        UA_LOCK(&server->serviceMutex);
         serviceRes = Service_Publish(server, session, &request->publishRequest, requestId);
         /* No channelRes due to the async response */
-        UA_UNLOCK(&server->serviceMutex);
         goto update_statistics;
     }
 #endif
@@ -834,10 +830,8 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     /* The call request might not be answered immediately */
     if(requestType == &UA_TYPES[UA_TYPES_CALLREQUEST]) {
         UA_Boolean finished = true;
-        UA_LOCK(&server->serviceMutex);
         Service_CallAsync(server, session, requestId, &request->callRequest,
                           &response->callResponse, &finished);
-        UA_UNLOCK(&server->serviceMutex);
 
         /* Async method calls remain. Don't send a response now. In case we have
          * an async call, count as a "good" request for the diagnostics
@@ -852,9 +846,7 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
 #endif
 
     /* Execute the synchronous service call */
-    UA_LOCK(&server->serviceMutex);
     service(server, session, request, response);
-    UA_UNLOCK(&server->serviceMutex);
 
     /* Send the response */
     serviceRes = response->responseHeader.serviceResult;
@@ -882,9 +874,23 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     return channelRes;
 }
 
+/* A MSG request decoded outside of the serviceMutex */
+typedef struct {
+    UA_Service service;
+    UA_Boolean sessionRequired;
+    const UA_DataType *requestType;
+    const UA_DataType *responseType;
+    size_t counterOffset;
+    size_t requestPos; /* Offset after the NodeId (for sendServiceFault) */
+    UA_StatusCode faultCode; /* Answer with a ServiceFault */
+    UA_Request request;
+} UA_DecodedMSG;
+
+/* Decode the request. Does not require the serviceMutex and does not send. If
+ * the request cannot be decoded, the faultCode is set. */
 static UA_StatusCode
-processMSG(UA_Server *server, UA_SecureChannel *channel,
-           UA_UInt32 requestId, const UA_ByteString *msg) {
+decodeMSG(UA_Server *server, UA_SecureChannel *channel,
+          const UA_ByteString *msg, UA_DecodedMSG *dm) {
     if(channel->state != UA_SECURECHANNELSTATE_OPEN)
         return UA_STATUSCODE_BADINTERNALERROR;
     /* Decode the nodeid */
@@ -897,17 +903,19 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
        requestTypeId.identifierType != UA_NODEIDTYPE_NUMERIC)
         UA_NodeId_clear(&requestTypeId); /* leads to badserviceunsupported */
 
-    size_t requestPos = offset; /* Store the offset (for sendServiceFault) */
+    dm->requestPos = offset;
+    dm->faultCode = UA_STATUSCODE_GOOD;
 
     /* Get the service pointers */
-    UA_Service service = NULL;
-    UA_Boolean sessionRequired = true;
-    const UA_DataType *requestType = NULL;
-    const UA_DataType *responseType = NULL;
-    size_t counterOffset = 0;
-    getServicePointers(requestTypeId.identifier.numeric, &requestType,
-                       &responseType, &service, &sessionRequired, &counterOffset);
-    if(!requestType) {
+    dm->service = NULL;
+    dm->sessionRequired = true;
+    dm->requestType = NULL;
+    dm->responseType = NULL;
+    dm->counterOffset = 0;
+    getServicePointers(requestTypeId.identifier.numeric, &dm->requestType,
+                       &dm->responseType, &dm->service, &dm->sessionRequired,
+                       &dm->counterOffset);
+    if(!dm->requestType) {
         if(requestTypeId.identifier.numeric ==
            UA_NS0ID_CREATESUBSCRIPTIONREQUEST_ENCODING_DEFAULTBINARY) {
             UA_LOG_INFO_CHANNEL(&server->config.logger, channel,
@@ -918,26 +926,39 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                 "Unknown request with type identifier %" PRIi32,
                                 requestTypeId.identifier.numeric);
         }
-        return decodeHeaderSendServiceFault(channel, msg, requestPos,
-                                            &UA_TYPES[UA_TYPES_SERVICEFAULT],
-                                            requestId, UA_STATUSCODE_BADSERVICEUNSUPPORTED);
+        dm->responseType = &UA_TYPES[UA_TYPES_SERVICEFAULT];
+        dm->faultCode = UA_STATUSCODE_BADSERVICEUNSUPPORTED;
+        return UA_STATUSCODE_GOOD;
     }
-    UA_assert(responseType);
+    UA_assert(dm->responseType);
 
     /* Decode the request */
-    UA_Request request;
-    retval = UA_decodeBinaryInternal(msg, &offset, &request,
-                                     requestType, server->config.customDataTypes);
+    retval = UA_decodeBinaryInternal(msg, &offset, &dm->request,
+                                     dm->requestType, server->config.customDataTypes);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_DEBUG_CHANNEL(&server->config.logger, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
-        return decodeHeaderSendServiceFault(channel, msg, requestPos,
-                                            responseType, requestId, retval);
+        dm->faultCode = retval;
     }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+processDecodedMSG(UA_Server *server, UA_SecureChannel *channel,
+                  UA_UInt32 requestId, const UA_ByteString *msg,
+                  UA_DecodedMSG *dm) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    /* The request could not be decoded */
+    if(dm->faultCode != UA_STATUSCODE_GOOD)
+        return decodeHeaderSendServiceFault(channel, msg, dm->requestPos,
+                                            dm->responseType, requestId,
+                                            dm->faultCode);
 
     /* Check timestamp in the request header */
-    UA_RequestHeader *requestHeader = &request.requestHeader;
+    UA_StatusCode retval;
+    UA_RequestHeader *requestHeader = &dm->request.requestHeader;
     if(requestHeader->timestamp == 0 &&
        server->config.verifyRequestTimestamp <= UA_RULEHANDLING_WARN) {
         UA_LOG_WARNING_CHANNEL(&server->config.logger, channel,
@@ -946,7 +967,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
         if(server->config.verifyRequestTimestamp <= UA_RULEHANDLING_ABORT) {
             retval = sendServiceFault(channel, requestId, requestHeader->requestHandle,
                                       UA_STATUSCODE_BADINVALIDTIMESTAMP);
-            UA_clear(&request, requestType);
+            UA_clear(&dm->request, dm->requestType);
             return retval;
         }
     }
@@ -963,24 +984,62 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 
     /* Prepare the respone and process the request */
     UA_Response response;
-    UA_init(&response, responseType);
+    UA_init(&response, dm->responseType);
     response.responseHeader.requestHandle = requestHeader->requestHandle;
-    retval = processMSGDecoded(server, channel, requestId, service, &request, requestType,
-                               &response, responseType, sessionRequired, counterOffset);
+    retval = processMSGDecoded(server, channel, requestId, dm->service, &dm->request,
+                               dm->requestType, &response, dm->responseType,
+                               dm->sessionRequired, dm->counterOffset);
 
     /* Clean up */
-    UA_clear(&request, requestType);
-    UA_clear(&response, responseType);
+    UA_clear(&dm->request, dm->requestType);
+    UA_clear(&response, dm->responseType);
     return retval;
 }
 
-/* Takes decoded messages starting at the nodeid of the content type. */
+static void
+processMessageError(UA_Server *server, UA_SecureChannel *channel,
+                    UA_StatusCode retval) {
+    if(!UA_SecureChannel_isConnected(channel)) {
+        UA_LOG_INFO_CHANNEL(&server->config.logger, channel,
+                            "Processing the message failed. Channel already closed "
+                            "with StatusCode %s. ", UA_StatusCode_name(retval));
+        return;
+    }
+
+    UA_LOG_INFO_CHANNEL(&server->config.logger, channel,
+                        "Processing the message failed with StatusCode %s. "
+                        "Closing the channel.", UA_StatusCode_name(retval));
+    UA_TcpErrorMessage errMsg;
+    UA_TcpErrorMessage_init(&errMsg);
+    errMsg.error = retval;
+    UA_SecureChannel_sendError(channel, &errMsg);
+    UA_ShutdownReason reason;
+    switch(retval) {
+    case UA_STATUSCODE_BADSECURITYMODEREJECTED:
+    case UA_STATUSCODE_BADSECURITYCHECKSFAILED:
+    case UA_STATUSCODE_BADSECURECHANNELIDINVALID:
+    case UA_STATUSCODE_BADSECURECHANNELTOKENUNKNOWN:
+    case UA_STATUSCODE_BADSECURITYPOLICYREJECTED:
+    case UA_STATUSCODE_BADCERTIFICATEUSENOTALLOWED:
+        reason = UA_SHUTDOWNREASON_SECURITYREJECT;
+        break;
+    default:
+        reason = UA_SHUTDOWNREASON_CLOSE;
+        break;
+    }
+    UA_SecureChannel_shutdown(channel, reason);
+}
+
+/* Takes decoded messages starting at the nodeid of the content type. Requires
+ * the serviceMutex. */
 static UA_StatusCode
-processSecureChannelMessage(void *application, UA_SecureChannel *channel,
-                            UA_MessageType messagetype, UA_UInt32 requestId,
-                            UA_ByteString *message) {
+processSecureChannelMessageLocked(void *application, UA_SecureChannel *channel,
+                                  UA_MessageType messagetype, UA_UInt32 requestId,
+                                  UA_ByteString *message) {
     UA_Server *server = (UA_Server*)application;
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
+    UA_DecodedMSG dm;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     switch(messagetype) {
     case UA_MESSAGETYPE_HEL:
@@ -993,7 +1052,9 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
         break;
     case UA_MESSAGETYPE_MSG:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a MSG");
-        retval = processMSG(server, channel, requestId, message);
+        retval = decodeMSG(server, channel, message, &dm);
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = processDecodedMSG(server, channel, requestId, message, &dm);
         break;
     case UA_MESSAGETYPE_CLO:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a CLO");
@@ -1004,38 +1065,39 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
         retval = UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
         break;
     }
-    if(retval != UA_STATUSCODE_GOOD) {
-        if(!UA_SecureChannel_isConnected(channel)) {
-            UA_LOG_INFO_CHANNEL(&server->config.logger, channel,
-                                "Processing the message failed. Channel already closed "
-                                "with StatusCode %s. ", UA_StatusCode_name(retval));
-            return retval;
-        }
+    if(retval != UA_STATUSCODE_GOOD)
+        processMessageError(server, channel, retval);
+    return retval;
+}
 
-        UA_LOG_INFO_CHANNEL(&server->config.logger, channel,
-                            "Processing the message failed with StatusCode %s. "
-                            "Closing the channel.", UA_StatusCode_name(retval));
-        UA_TcpErrorMessage errMsg;
-        UA_TcpErrorMessage_init(&errMsg);
-        errMsg.error = retval;
-        UA_SecureChannel_sendError(channel, &errMsg);
-        UA_ShutdownReason reason;
-        switch(retval) {
-        case UA_STATUSCODE_BADSECURITYMODEREJECTED:
-        case UA_STATUSCODE_BADSECURITYCHECKSFAILED:
-        case UA_STATUSCODE_BADSECURECHANNELIDINVALID:
-        case UA_STATUSCODE_BADSECURECHANNELTOKENUNKNOWN:
-        case UA_STATUSCODE_BADSECURITYPOLICYREJECTED:
-        case UA_STATUSCODE_BADCERTIFICATEUSENOTALLOWED:
-            reason = UA_SHUTDOWNREASON_SECURITYREJECT;
-            break;
-        default:
-            reason = UA_SHUTDOWNREASON_CLOSE;
-            break;
-        }
-        UA_SecureChannel_shutdown(channel, reason);
+/* The handoff from the network thread into the service processing. The
+ * network thread can be a reactor thread of the EventLoop. Then several
+ * network threads process messages concurrently. MSG requests are decoded
+ * before taking the serviceMutex. Everything else (including sending the
+ * response) happens with the serviceMutex held. */
+static UA_StatusCode
+processSecureChannelMessage(void *application, UA_SecureChannel *channel,
+                            UA_MessageType messagetype, UA_UInt32 requestId,
+                            UA_ByteString *message) {
+    UA_Server *server = (UA_Server*)application;
+    UA_StatusCode retval;
+    if(messagetype != UA_MESSAGETYPE_MSG) {
+        UA_LOCK(&server->serviceMutex);
+        retval = processSecureChannelMessageLocked(application, channel,
+                                                   messagetype, requestId, message);
+        UA_UNLOCK(&server->serviceMutex);
+        return retval;
     }
 
+    UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a MSG");
+    UA_DecodedMSG dm;
+    retval = decodeMSG(server, channel, message, &dm);
+    UA_LOCK(&server->serviceMutex);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = processDecodedMSG(server, channel, requestId, message, &dm);
+    if(retval != UA_STATUSCODE_GOOD)
+        processMessageError(server, channel, retval);
+    UA_UNLOCK(&server->serviceMutex);
     return retval;
 }
 
@@ -1154,7 +1216,53 @@ createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *c
     return UA_STATUSCODE_GOOD;
 }
 
-/* Callback of a TCP socket (server socket or an active connection) */
+static UA_Boolean
+isSymmetricChunk(const UA_Byte *hdr, UA_UInt32 *chunkSize) {
+    UA_UInt32 msgType = (UA_UInt32)hdr[0] | ((UA_UInt32)hdr[1] << 8) |
+        ((UA_UInt32)hdr[2] << 16);
+    *chunkSize = (UA_UInt32)hdr[4] | ((UA_UInt32)hdr[5] << 8) |
+        ((UA_UInt32)hdr[6] << 16) | ((UA_UInt32)hdr[7] << 24);
+    return ((msgType == UA_MESSAGETYPE_MSG || msgType == UA_MESSAGETYPE_CLO) &&
+            *chunkSize >= UA_SECURECHANNEL_MESSAGE_MIN_LENGTH);
+}
+
+/* Symmetric MSG/CLO chunks of an open SecureChannel without a pending token
+ * rollover are decrypted and decoded without the serviceMutex. The remaining
+ * cases (handshake, OPN with the asymmetric crypto, token rollover) touch state
+ * that is shared with other threads. They are rare and processed with the
+ * serviceMutex held. So are all chunks if the SecurityPolicy is not
+ * thread-safe. The chunk headers are checked starting with the incomplete
+ * chunk from the previous buffer. */
+static UA_Boolean
+processWithoutLock(const UA_SecureChannel *channel, const UA_ByteString *msg) {
+    if(channel->state != UA_SECURECHANNELSTATE_OPEN ||
+       channel->renewState != UA_SECURECHANNELRENEWSTATE_NORMAL ||
+       !channel->securityPolicy || !channel->securityPolicy->threadSafe)
+        return false;
+
+    /* The remainder of the incomplete chunk is at the start of the buffer */
+    size_t pos = 0;
+    UA_UInt32 chunkSize;
+    const UA_ByteString *incomplete = &channel->incompleteChunk;
+    if(incomplete->length > 0) {
+        if(incomplete->length < UA_SECURECHANNEL_MESSAGEHEADER_LENGTH ||
+           !isSymmetricChunk(incomplete->data, &chunkSize) ||
+           chunkSize <= incomplete->length)
+            return false;
+        pos = chunkSize - incomplete->length;
+    }
+
+    /* Check the chunks in the buffer. The last chunk can be incomplete. */
+    for(; pos + UA_SECURECHANNEL_MESSAGEHEADER_LENGTH <= msg->length; pos += chunkSize) {
+        if(!isSymmetricChunk(&msg->data[pos], &chunkSize))
+            return false;
+    }
+    return true;
+}
+
+/* Callback of a TCP socket (server socket or an active connection). With
+ * reactors in the EventLoop, this is called from several threads
+ * concurrently. */
 void
 serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
                       void *application, void **connectionContext,
@@ -1167,7 +1275,8 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
      * set the connection context to the pointer in the
      * bpm->serverConnections list. New connections on that server socket
      * inherit the context (and on the first callback we set the context of
-     * client-connections to a SecureChannel). */
+     * client-connections to a SecureChannel). This is called from
+     * createServerConnection with the serviceMutex already held. */
     if(*connectionContext == NULL) {
         /* The socket is closing without being previously registered -> ignore */
         if(state == UA_CONNECTIONSTATE_CLOSED ||
@@ -1200,7 +1309,9 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
                                sc < &bpm->serverConnections[UA_MAXSERVERCONNECTIONS]);
 
     /* The connection is closing. This is the last callback for it. */
+    UA_Server *server = bpm->server;
     if(state == UA_CONNECTIONSTATE_CLOSING) {
+        UA_LOCK(&server->serviceMutex);
         if(serverSocket) {
             /* Server socket is closed */
             sc->state = UA_CONNECTIONSTATE_CLOSED;
@@ -1221,6 +1332,7 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
            setBinaryProtocolManagerState(bpm->server, bpm,
                                          UA_LIFECYCLESTATE_STOPPED);
         }
+        UA_UNLOCK(&server->serviceMutex);
         return;
     }
 
@@ -1228,7 +1340,9 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     if(serverSocket) {
         /* A new connection is opening. This is the only place where
          * createSecureChannel is used. */
+        UA_LOCK(&server->serviceMutex);
         retval = createServerSecureChannel(bpm, cm, connectionId, &channel);
+        UA_UNLOCK(&server->serviceMutex);
         if(retval != UA_STATUSCODE_GOOD) {
             UA_LOG_WARNING(bpm->logging, UA_LOGCATEGORY_SERVER,
                            "TCP %lu\t| Could not accept the connection with status %s",
@@ -1257,23 +1371,38 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     UA_debug_dumpCompleteChunk(server, channel->connection, message);
 #endif
 
-    UA_EventLoop *el = bpm->server->config.eventLoop;
+    UA_EventLoop *el = server->config.eventLoop;
     UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
-    retval = UA_SecureChannel_processBuffer(channel, bpm->server,
-                                            processSecureChannelMessage,
-                                            &msg, nowMonotonic);
+    UA_Boolean locked = !processWithoutLock(channel, &msg);
+    if(locked) {
+        UA_LOCK(&server->serviceMutex);
+        retval = UA_SecureChannel_processBuffer(channel, server,
+                                                processSecureChannelMessageLocked,
+                                                &msg, nowMonotonic);
+    } else {
+        retval = UA_SecureChannel_processBuffer(channel, server,
+                                                processSecureChannelMessage,
+                                                &msg, nowMonotonic);
+    }
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_CHANNEL(bpm->logging, channel,
                                "Processing the message failed with error %s",
                                UA_StatusCode_name(retval));
 
         /* Send an ERR message and close the connection */
+        if(!locked) {
+            UA_LOCK(&server->serviceMutex);
+        }
+        locked = true;
         UA_TcpErrorMessage error;
         error.error = retval;
         error.reason = UA_STRING_NULL;
         UA_SecureChannel_sendError(channel, &error);
         UA_SecureChannel_shutdown(channel, UA_SHUTDOWNREASON_ABORT);
     }
+    if(locked) {
+        UA_UNLOCK(&server->serviceMutex);
+    }
 }
 
 static UA_StatusCode
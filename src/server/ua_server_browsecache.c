@@ -0,0 +1,176 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+
+static enum ZIP_CMP
+cmpBrowseCacheKey(const UA_BrowseCacheKey *a, const UA_BrowseCacheKey *b) {
+    UA_Order o = UA_NodeId_order(&a->nodeId, &b->nodeId);
+    if(o != UA_ORDER_EQ)
+        return (enum ZIP_CMP)o;
+    if(a->browseDirection != b->browseDirection)
+        return (a->browseDirection < b->browseDirection) ?
+            ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(a->nodeClassMask != b->nodeClassMask)
+        return (a->nodeClassMask < b->nodeClassMask) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(a->resultMask != b->resultMask)
+        return (a->resultMask < b->resultMask) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    int c = memcmp(&a->references, &b->references, sizeof(UA_ReferenceTypeSet));
+    if(c != 0)
+        return (c < 0) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(a->localeIdsSize != b->localeIdsSize)
+        return (a->localeIdsSize < b->localeIdsSize) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    for(size_t i = 0; i < a->localeIdsSize; i++) {
+        o = UA_order(&a->localeIds[i], &b->localeIds[i], &UA_TYPES[UA_TYPES_STRING]);
+        if(o != UA_ORDER_EQ)
+            return (enum ZIP_CMP)o;
+    }
+    return ZIP_CMP_EQ;
+}
+
+ZIP_FUNCTIONS(UA_BrowseCacheTree, UA_BrowseCacheEntry, treeEntry,
+              UA_BrowseCacheKey, key, cmpBrowseCacheKey)
+
+static enum ZIP_CMP
+cmpBrowseCacheNodeId(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
+
+ZIP_FUNCTIONS(UA_BrowseCacheNodeTree, UA_BrowseCacheEntry, nodeEntry,
+              UA_NodeId, key.nodeId, cmpBrowseCacheNodeId)
+
+static void
+UA_BrowseCacheEntry_delete(UA_BrowseCache *bc, UA_BrowseCacheEntry *entry) {
+    ZIP_REMOVE(UA_BrowseCacheTree, &bc->entries, entry);
+    ZIP_REMOVE(UA_BrowseCacheNodeTree, &bc->nodes, entry);
+    TAILQ_REMOVE(&bc->lru, entry, lruEntry);
+    UA_NodeId_clear(&entry->key.nodeId);
+    UA_Array_delete(entry->key.localeIds, entry->key.localeIdsSize,
+                    &UA_TYPES[UA_TYPES_STRING]);
+    UA_Array_delete(entry->references, entry->referencesSize,
+                    &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+    UA_free(entry);
+    bc->stats.currentEntryCount--;
+}
+
+void
+UA_BrowseCache_init(UA_BrowseCache *bc) {
+    memset(bc, 0, sizeof(UA_BrowseCache));
+    ZIP_INIT(&bc->entries);
+    ZIP_INIT(&bc->nodes);
+    TAILQ_INIT(&bc->lru);
+}
+
+void
+UA_BrowseCache_clear(UA_BrowseCache *bc) {
+    UA_BrowseCacheEntry *entry, *entry_tmp;
+    TAILQ_FOREACH_SAFE(entry, &bc->lru, lruEntry, entry_tmp) {
+        UA_BrowseCacheEntry_delete(bc, entry);
+    }
+    UA_BrowseCache_init(bc);
+}
+
+void
+UA_BrowseCache_invalidate(UA_BrowseCache *bc, const UA_NodeId *nodeId) {
+    /* The NodeId tree can contain several entries for the node */
+    UA_BrowseCacheEntry *entry;
+    while((entry = ZIP_FIND(UA_BrowseCacheNodeTree, &bc->nodes, nodeId))) {
+        UA_BrowseCacheEntry_delete(bc, entry);
+        bc->stats.invalidationCount++;
+    }
+}
+
+static void *
+invalidateTarget(void *context, UA_ReferenceTarget *t) {
+    if(!UA_NodePointer_isLocal(t->targetId))
+        return NULL;
+    UA_NodeId targetId = UA_NodePointer_toNodeId(t->targetId);
+    UA_BrowseCache_invalidate((UA_BrowseCache*)context, &targetId);
+    return NULL;
+}
+
+void
+UA_BrowseCache_invalidateNeighbors(UA_BrowseCache *bc, const UA_NodeHead *head) {
+    if(TAILQ_EMPTY(&bc->lru))
+        return;
+    UA_BrowseCache_invalidate(bc, &head->nodeId);
+    for(size_t i = 0; i < head->referencesSize; i++)
+        UA_NodeReferenceKind_iterate(&head->references[i], invalidateTarget, bc);
+}
+
+UA_StatusCode
+UA_BrowseCache_get(UA_BrowseCache *bc, const UA_BrowseCacheKey *key,
+                   size_t maxReferences, UA_ReferenceDescription **references,
+                   size_t *referencesSize) {
+    /* Not found or the result needs a ContinuationPoint */
+    UA_BrowseCacheEntry *entry = ZIP_FIND(UA_BrowseCacheTree, &bc->entries, key);
+    if(!entry || entry->referencesSize > maxReferences) {
+        bc->stats.missCount++;
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+
+    UA_StatusCode res =
+        UA_Array_copy(entry->references, entry->referencesSize, (void**)references,
+                      &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    *referencesSize = entry->referencesSize;
+
+    /* Move to the front of the lru list */
+    TAILQ_REMOVE(&bc->lru, entry, lruEntry);
+    TAILQ_INSERT_HEAD(&bc->lru, entry, lruEntry);
+    bc->stats.hitCount++;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_BrowseCache_put(UA_BrowseCache *bc, size_t maxSize, const UA_BrowseCacheKey *key,
+                   const UA_ReferenceDescription *references, size_t referencesSize) {
+    if(maxSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Already cached. The result of browsing can only change together with
+     * an invalidation of the cache. */
+    if(ZIP_FIND(UA_BrowseCacheTree, &bc->entries, key))
+        return UA_STATUSCODE_GOOD;
+
+    /* Create the entry */
+    UA_BrowseCacheEntry *entry = (UA_BrowseCacheEntry*)
+        UA_calloc(1, sizeof(UA_BrowseCacheEntry));
+    if(!entry)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    entry->key = *key;
+    entry->key.localeIds = NULL;
+    UA_StatusCode res = UA_NodeId_copy(&key->nodeId, &entry->key.nodeId);
+    res |= UA_Array_copy(key->localeIds, key->localeIdsSize,
+                         (void**)&entry->key.localeIds, &UA_TYPES[UA_TYPES_STRING]);
+    res |= UA_Array_copy(references, referencesSize, (void**)&entry->references,
+                         &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&entry->key.nodeId);
+        if(entry->key.localeIds)
+            UA_Array_delete(entry->key.localeIds, key->localeIdsSize,
+                            &UA_TYPES[UA_TYPES_STRING]);
+        if(entry->references)
+            UA_Array_delete(entry->references, referencesSize,
+                            &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+        UA_free(entry);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    entry->referencesSize = referencesSize;
+
+    /* Evict the least recently used entries */
+    while(bc->stats.currentEntryCount >= maxSize) {
+        UA_BrowseCacheEntry_delete(bc, TAILQ_LAST(&bc->lru, UA_BrowseCacheList));
+        bc->stats.evictionCount++;
+    }
+
+    /* Add the entry */
+    ZIP_INSERT(UA_BrowseCacheTree, &bc->entries, entry);
+    ZIP_INSERT(UA_BrowseCacheNodeTree, &bc->nodes, entry);
+    TAILQ_INSERT_HEAD(&bc->lru, entry, lruEntry);
+    bc->stats.currentEntryCount++;
+    return UA_STATUSCODE_GOOD;
+}
@@ -0,0 +1,184 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+
+static enum ZIP_CMP
+cmpBrowsePathCacheKey(const UA_BrowsePathCacheKey *a,
+                      const UA_BrowsePathCacheKey *b) {
+    if(a->flags != b->flags)
+        return (a->flags < b->flags) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(a->name.namespaceIndex != b->name.namespaceIndex)
+        return (a->name.namespaceIndex < b->name.namespaceIndex) ?
+            ZIP_CMP_LESS : ZIP_CMP_MORE;
+    UA_Order o = UA_order(&a->name.name, &b->name.name, &UA_TYPES[UA_TYPES_STRING]);
+    if(o != UA_ORDER_EQ)
+        return (enum ZIP_CMP)o;
+    return (enum ZIP_CMP)UA_NodeId_order(&a->nodeId, &b->nodeId);
+}
+
+ZIP_FUNCTIONS(UA_BrowsePathCacheTree, UA_BrowsePathCacheEntry, treeEntry,
+              UA_BrowsePathCacheKey, key, cmpBrowsePathCacheKey)
+
+static enum ZIP_CMP
+cmpBrowsePathCacheTarget(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
+
+ZIP_FUNCTIONS(UA_BrowsePathCacheTargetTree, UA_BrowsePathCacheTarget, treeEntry,
+              UA_NodeId, nodeId, cmpBrowsePathCacheTarget)
+
+/* Deletes the entry together with all entries below. The entry is not removed
+ * from the tree of its parent. */
+static void *
+deleteBrowsePathCacheEntry(void *context, UA_BrowsePathCacheEntry *entry) {
+    UA_BrowsePathCache *bpc = (UA_BrowsePathCache*)context;
+    ZIP_ITER(UA_BrowsePathCacheTree, &entry->children,
+             deleteBrowsePathCacheEntry, bpc);
+    for(size_t i = 0; i < entry->targetsSize; i++)
+        ZIP_REMOVE(UA_BrowsePathCacheTargetTree, &bpc->targets, &entry->index[i]);
+    TAILQ_REMOVE(&bpc->lru, entry, lruEntry);
+    UA_NodeId_clear(&entry->key.nodeId);
+    UA_QualifiedName_clear(&entry->key.name);
+    UA_Array_delete(entry->targets, entry->targetsSize,
+                    &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    UA_free(entry->index);
+    UA_free(entry);
+    bpc->stats.currentEntryCount--;
+    return NULL;
+}
+
+static void
+removeBrowsePathCacheEntry(UA_BrowsePathCache *bpc, UA_BrowsePathCacheEntry *entry) {
+    UA_BrowsePathCacheTree *tree =
+        (entry->parent) ? &entry->parent->children : &bpc->roots;
+    ZIP_REMOVE(UA_BrowsePathCacheTree, tree, entry);
+    deleteBrowsePathCacheEntry(bpc, entry);
+}
+
+/* Move the entry and the entries above to the front of the lru list */
+static void
+touchBrowsePathCacheEntry(UA_BrowsePathCache *bpc, UA_BrowsePathCacheEntry *entry) {
+    for(; entry; entry = entry->parent) {
+        TAILQ_REMOVE(&bpc->lru, entry, lruEntry);
+        TAILQ_INSERT_HEAD(&bpc->lru, entry, lruEntry);
+    }
+}
+
+static UA_Boolean
+isAboveOrSame(const UA_BrowsePathCacheEntry *entry,
+              const UA_BrowsePathCacheEntry *below) {
+    for(; below; below = below->parent) {
+        if(below == entry)
+            return true;
+    }
+    return false;
+}
+
+void
+UA_BrowsePathCache_init(UA_BrowsePathCache *bpc) {
+    memset(bpc, 0, sizeof(UA_BrowsePathCache));
+    ZIP_INIT(&bpc->roots);
+    ZIP_INIT(&bpc->targets);
+    TAILQ_INIT(&bpc->lru);
+}
+
+void
+UA_BrowsePathCache_clear(UA_BrowsePathCache *bpc) {
+    ZIP_ITER(UA_BrowsePathCacheTree, &bpc->roots, deleteBrowsePathCacheEntry, bpc);
+    UA_BrowsePathCache_init(bpc);
+}
+
+void
+UA_BrowsePathCache_invalidate(UA_BrowsePathCache *bpc, const UA_NodeId *nodeId) {
+    /* The target tree can contain the node for several entries */
+    UA_BrowsePathCacheTarget *target;
+    while((target = ZIP_FIND(UA_BrowsePathCacheTargetTree, &bpc->targets, nodeId))) {
+        size_t before = bpc->stats.currentEntryCount;
+        removeBrowsePathCacheEntry(bpc, target->entry);
+        bpc->stats.invalidationCount += before - bpc->stats.currentEntryCount;
+    }
+}
+
+UA_BrowsePathCacheEntry *
+UA_BrowsePathCache_find(UA_BrowsePathCache *bpc, UA_BrowsePathCacheEntry *parent,
+                        const UA_BrowsePathCacheKey *key) {
+    UA_BrowsePathCacheTree *tree = (parent) ? &parent->children : &bpc->roots;
+    UA_BrowsePathCacheEntry *entry = ZIP_FIND(UA_BrowsePathCacheTree, tree, key);
+    if(!entry) {
+        bpc->stats.missCount++;
+        return NULL;
+    }
+    touchBrowsePathCacheEntry(bpc, entry);
+    bpc->stats.hitCount++;
+    return entry;
+}
+
+UA_BrowsePathCacheEntry *
+UA_BrowsePathCache_add(UA_BrowsePathCache *bpc, size_t maxSize,
+                       UA_BrowsePathCacheEntry *parent,
+                       const UA_BrowsePathCacheKey *key,
+                       const UA_ExpandedNodeId *targets, size_t targetsSize) {
+    if(maxSize == 0)
+        return NULL;
+
+    /* Evict the least recently used entries. These are leaves unless the
+     * parent and the entries above are the only entries left in the list. The
+     * parent is kept as the new entry is added below it. */
+    UA_BrowsePathCacheEntry *victim = TAILQ_LAST(&bpc->lru, UA_BrowsePathCacheList);
+    while(bpc->stats.currentEntryCount >= maxSize) {
+        while(victim && isAboveOrSame(victim, parent))
+            victim = TAILQ_PREV(victim, UA_BrowsePathCacheList, lruEntry);
+        if(!victim)
+            return NULL;
+        size_t before = bpc->stats.currentEntryCount;
+        removeBrowsePathCacheEntry(bpc, victim);
+        bpc->stats.evictionCount += before - bpc->stats.currentEntryCount;
+        victim = TAILQ_LAST(&bpc->lru, UA_BrowsePathCacheList);
+    }
+
+    UA_BrowsePathCacheEntry *entry = (UA_BrowsePathCacheEntry*)
+        UA_calloc(1, sizeof(UA_BrowsePathCacheEntry));
+    if(!entry)
+        return NULL;
+    entry->key.flags = key->flags;
+    UA_StatusCode res = UA_NodeId_copy(&key->nodeId, &entry->key.nodeId);
+    res |= UA_QualifiedName_copy(&key->name, &entry->key.name);
+    if(targetsSize > 0) {
+        res |= UA_Array_copy(targets, targetsSize, (void**)&entry->targets,
+                             &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+        entry->index = (UA_BrowsePathCacheTarget*)
+            UA_calloc(targetsSize, sizeof(UA_BrowsePathCacheTarget));
+        if(!entry->index)
+            res |= UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&entry->key.nodeId);
+        UA_QualifiedName_clear(&entry->key.name);
+        if(entry->targets)
+            UA_Array_delete(entry->targets, targetsSize,
+                            &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+        UA_free(entry->index);
+        UA_free(entry);
+        return NULL;
+    }
+    entry->targetsSize = targetsSize;
+    entry->parent = parent;
+    ZIP_INIT(&entry->children);
+
+    /* Index the targets */
+    for(size_t i = 0; i < targetsSize; i++) {
+        entry->index[i].nodeId = entry->targets[i].nodeId;
+        entry->index[i].entry = entry;
+        ZIP_INSERT(UA_BrowsePathCacheTargetTree, &bpc->targets, &entry->index[i]);
+    }
+
+    UA_BrowsePathCacheTree *tree = (parent) ? &parent->children : &bpc->roots;
+    ZIP_INSERT(UA_BrowsePathCacheTree, tree, entry);
+    TAILQ_INSERT_HEAD(&bpc->lru, entry, lruEntry);
+    touchBrowsePathCacheEntry(bpc, parent);
+    bpc->stats.currentEntryCount++;
+    return entry;
+}
@@ -107,6 +107,206 @@ addServerComponent(UA_Server *server, UA_ServerComponent *sc,
 UA_ServerComponent *
 getServerComponentByName(UA_Server *server, UA_String name);
 
+/***************/
+/* Value Cache */
+/***************/
+
+/* Cache for the values read from DataSources. The entries are looked up by
+ * their NodeId and kept in a list with the most recently used entry first. */
+
+typedef struct UA_ValueCacheEntry {
+    ZIP_ENTRY(UA_ValueCacheEntry) treeEntry;
+    TAILQ_ENTRY(UA_ValueCacheEntry) lruEntry;
+    UA_NodeId nodeId;
+    UA_DateTime readTime; /* Monotonic time when the value was read */
+    UA_DataValue value;
+} UA_ValueCacheEntry;
+
+typedef ZIP_HEAD(UA_ValueCacheTree, UA_ValueCacheEntry) UA_ValueCacheTree;
+typedef TAILQ_HEAD(UA_ValueCacheList, UA_ValueCacheEntry) UA_ValueCacheList;
+
+typedef struct {
+    UA_ValueCacheTree entries;
+    UA_ValueCacheList lru;
+    UA_ValueCacheStatistics stats;
+} UA_ValueCache;
+
+void
+UA_ValueCache_init(UA_ValueCache *vc);
+
+void
+UA_ValueCache_clear(UA_ValueCache *vc);
+
+/* Copies the cached value if it is not older than maxAge (in ms). Returns
+ * UA_STATUSCODE_BADNOTFOUND if there is no such value. */
+UA_StatusCode
+UA_ValueCache_get(UA_ValueCache *vc, const UA_NodeId *nodeId,
+                  UA_DateTime now, UA_Double maxAge, UA_DataValue *v);
+
+/* Stores a copy of the value. Evicts the least recently used entry if the
+ * cache already contains maxSize entries. */
+UA_StatusCode
+UA_ValueCache_put(UA_ValueCache *vc, size_t maxSize, const UA_NodeId *nodeId,
+                  UA_DateTime now, const UA_DataValue *v);
+
+void
+UA_ValueCache_remove(UA_ValueCache *vc, const UA_NodeId *nodeId);
+
+/****************/
+/* Browse Cache */
+/****************/
+
+/* Cache for the results of Browse operations. All parameters of the
+ * BrowseDescription that influence the result are part of the key. The
+ * entries are kept in a list with the most recently used entry first. A second
+ * tree indexes the entries by the browsed NodeId only, so that all results
+ * for a node can be invalidated at once. */
+
+typedef struct {
+    UA_NodeId nodeId;
+    UA_BrowseDirection browseDirection;
+    UA_ReferenceTypeSet references;
+    UA_UInt32 nodeClassMask;
+    UA_UInt32 resultMask;
+    size_t localeIdsSize; /* Only if the DisplayName is part of the result */
+    UA_String *localeIds;
+} UA_BrowseCacheKey;
+
+typedef struct UA_BrowseCacheEntry {
+    ZIP_ENTRY(UA_BrowseCacheEntry) treeEntry;
+    ZIP_ENTRY(UA_BrowseCacheEntry) nodeEntry;
+    TAILQ_ENTRY(UA_BrowseCacheEntry) lruEntry;
+    UA_BrowseCacheKey key;
+    size_t referencesSize;
+    UA_ReferenceDescription *references;
+} UA_BrowseCacheEntry;
+
+typedef ZIP_HEAD(UA_BrowseCacheTree, UA_BrowseCacheEntry) UA_BrowseCacheTree;
+typedef ZIP_HEAD(UA_BrowseCacheNodeTree, UA_BrowseCacheEntry) UA_BrowseCacheNodeTree;
+typedef TAILQ_HEAD(UA_BrowseCacheList, UA_BrowseCacheEntry) UA_BrowseCacheList;
+
+typedef struct {
+    UA_BrowseCacheTree entries;
+    UA_BrowseCacheNodeTree nodes;
+    UA_BrowseCacheList lru;
+    UA_BrowseCacheStatistics stats;
+} UA_BrowseCache;
+
+void
+UA_BrowseCache_init(UA_BrowseCache *bc);
+
+void
+UA_BrowseCache_clear(UA_BrowseCache *bc);
+
+/* Copies the cached references if there are not more than maxReferences.
+ * Returns UA_STATUSCODE_BADNOTFOUND otherwise. */
+UA_StatusCode
+UA_BrowseCache_get(UA_BrowseCache *bc, const UA_BrowseCacheKey *key,
+                   size_t maxReferences, UA_ReferenceDescription **references,
+                   size_t *referencesSize);
+
+/* Stores a copy of the references. Evicts the least recently used entry if
+ * the cache already contains maxSize entries. */
+UA_StatusCode
+UA_BrowseCache_put(UA_BrowseCache *bc, size_t maxSize, const UA_BrowseCacheKey *key,
+                   const UA_ReferenceDescription *references, size_t referencesSize);
+
+/* Removes the results for browsing the node. Called when the references of the
+ * node change. */
+void
+UA_BrowseCache_invalidate(UA_BrowseCache *bc, const UA_NodeId *nodeId);
+
+/* Removes the results for browsing the node and all nodes it references. The
+ * results of the referenced nodes contain the DisplayName and the
+ * TypeDefinition of the node. As references are bidirectional, these are also
+ * the nodes that contain the node in their results. */
+void
+UA_BrowseCache_invalidateNeighbors(UA_BrowseCache *bc, const UA_NodeHead *head);
+
+/********************/
+/* BrowsePath Cache */
+/********************/
+
+/* Prefix trie for the resolution of BrowsePaths. The roots are keyed by the
+ * starting node and the NodeClassMask. Every level below is keyed by the next
+ * RelativePathElement. Each entry holds the (local) target nodes that result
+ * from resolving the path up to the entry. So paths with a common prefix share
+ * the entries for the prefix.
+ *
+ * The entries below depend on the references of the targets. So the targets
+ * are indexed in a second tree. When the references of a node change, the
+ * entries that contain the node as a target are removed together with all
+ * entries below. The entries are kept in a list with the most recently used
+ * entry first. Using an entry also moves the entries above it to the front. So
+ * the least recently used entry is a leaf of the trie. */
+
+typedef struct {
+    UA_NodeId nodeId;       /* Starting node (root) or ReferenceType (element) */
+    UA_QualifiedName name;  /* Null for the root */
+    UA_UInt32 flags;        /* NodeClassMask (root) or the isInverse and
+                             * includeSubtypes flags (element) */
+} UA_BrowsePathCacheKey;
+
+struct UA_BrowsePathCacheEntry;
+typedef ZIP_HEAD(UA_BrowsePathCacheTree, UA_BrowsePathCacheEntry) UA_BrowsePathCacheTree;
+
+typedef struct UA_BrowsePathCacheTarget {
+    ZIP_ENTRY(UA_BrowsePathCacheTarget) treeEntry;
+    UA_NodeId nodeId; /* Shallow copy from the targets of the entry */
+    struct UA_BrowsePathCacheEntry *entry;
+} UA_BrowsePathCacheTarget;
+
+typedef ZIP_HEAD(UA_BrowsePathCacheTargetTree, UA_BrowsePathCacheTarget)
+    UA_BrowsePathCacheTargetTree;
+
+typedef struct UA_BrowsePathCacheEntry {
+    ZIP_ENTRY(UA_BrowsePathCacheEntry) treeEntry;
+    TAILQ_ENTRY(UA_BrowsePathCacheEntry) lruEntry;
+    struct UA_BrowsePathCacheEntry *parent; /* NULL for the roots */
+    UA_BrowsePathCacheTree children;
+    UA_BrowsePathCacheKey key;
+    size_t targetsSize;
+    UA_ExpandedNodeId *targets;
+    UA_BrowsePathCacheTarget *index; /* One for each target */
+} UA_BrowsePathCacheEntry;
+
+typedef TAILQ_HEAD(UA_BrowsePathCacheList, UA_BrowsePathCacheEntry)
+    UA_BrowsePathCacheList;
+
+typedef struct {
+    UA_BrowsePathCacheTree roots;
+    UA_BrowsePathCacheTargetTree targets;
+    UA_BrowsePathCacheList lru;
+    UA_BrowsePathCacheStatistics stats;
+} UA_BrowsePathCache;
+
+void
+UA_BrowsePathCache_init(UA_BrowsePathCache *bpc);
+
+void
+UA_BrowsePathCache_clear(UA_BrowsePathCache *bpc);
+
+/* Find the root (parent == NULL) or the child of an entry */
+UA_BrowsePathCacheEntry *
+UA_BrowsePathCache_find(UA_BrowsePathCache *bpc, UA_BrowsePathCacheEntry *parent,
+                        const UA_BrowsePathCacheKey *key);
+
+/* Adds an entry with a copy of the key and the targets. If the cache already
+ * contains maxSize entries, the least recently used entries are evicted
+ * (except for the parent and the entries above it). Returns NULL if no space
+ * could be made or if memory runs out. */
+UA_BrowsePathCacheEntry *
+UA_BrowsePathCache_add(UA_BrowsePathCache *bpc, size_t maxSize,
+                       UA_BrowsePathCacheEntry *parent,
+                       const UA_BrowsePathCacheKey *key,
+                       const UA_ExpandedNodeId *targets, size_t targetsSize);
+
+/* Removes the entries that contain the node as a target (and the entries
+ * below). Called when the references of the node change or the node is
+ * deleted. */
+void
+UA_BrowsePathCache_invalidate(UA_BrowsePathCache *bpc, const UA_NodeId *nodeId);
+
 /********************/
 /* Server Structure */
 /********************/
@@ -117,6 +317,28 @@ typedef struct session_list_entry {
     UA_Session session;
 } session_list_entry;
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+
+struct OperationSlice;
+
+/* Worker threads for the parallel service operations. They are started with
+ * the server and stopped at shutdown. Work is only handed out by the thread
+ * holding the serviceMutex. So there is at most one job at a time. */
+typedef struct {
+    pthread_t *threads;
+    size_t threadsSize;
+    pthread_mutex_t mutex;
+    pthread_cond_t workCondition; /* New slices or stop */
+    pthread_cond_t doneCondition; /* All slices of the job are done */
+    struct OperationSlice *slices;
+    size_t slicesSize;
+    size_t nextSlice;
+    size_t slicesDone;
+    UA_Boolean stop;
+} UA_OperationWorkers;
+
+#endif
+
 struct UA_Server {
     /* Config */
     UA_ServerConfig config;
@@ -180,11 +402,54 @@ struct UA_Server {
     UA_Lock serviceMutex;
 #endif
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+    UA_OperationWorkers operationWorkers;
+#endif
+
+    /* Values read from DataSources */
+    UA_ValueCache valueCache;
+
+    /* Results of Browse and TranslateBrowsePathsToNodeIds */
+    UA_BrowseCache browseCache;
+    UA_BrowsePathCache browsePathCache;
+
     /* Statistics */
     UA_SecureChannelStatistics secureChannelStatistics;
     UA_ServerDiagnosticsSummaryDataType serverDiagnosticsSummary;
 };
 
+/****************/
+/* Intern Table */
+/****************/
+
+/* Global table of refcounted strings and NodeIds. The nodes share the storage
+ * of identical BrowseNames, LocalizedTexts and reference target NodeIds. Equal
+ * interned values have the same pointer. The release functions also accept
+ * values that are not interned and clear/delete them. */
+
+typedef struct {
+    size_t entries;    /* Number of distinct values */
+    size_t references; /* Number of users of the values */
+    size_t bytes;      /* Memory used for the entries */
+    size_t savedBytes; /* Memory that would be used additionally for copies
+                        * of the values without interning */
+} UA_InternTableStatistics;
+
+UA_StatusCode
+UA_InternTable_addString(const UA_String *src, UA_String *dst);
+
+void
+UA_InternTable_releaseString(UA_String *s);
+
+UA_StatusCode
+UA_InternTable_addNodeId(const UA_NodeId *src, const UA_NodeId **dst);
+
+void
+UA_InternTable_releaseNodeId(const UA_NodeId *id);
+
+UA_InternTableStatistics
+UA_InternTable_getStatistics(void);
+
 /***********************/
 /* References Handling */
 /***********************/
@@ -195,6 +460,11 @@ cmpRefTargetId(const void *a, const void *b);
 enum ZIP_CMP
 cmpRefTargetName(const void *a, const void *b);
 
+/* Position of the first entry in the nameIndex of a compact ReferenceKind
+ * whose target does not have a smaller BrowseName hash */
+size_t
+compactNameLowerBound(const UA_NodeReferenceKind *rk, UA_UInt32 nameHash);
+
 /* Static inline methods for tree handling */
 typedef ZIP_HEAD(UA_ReferenceIdTree, UA_ReferenceTargetTreeElem) UA_ReferenceIdTree;
 ZIP_FUNCTIONS(UA_ReferenceIdTree, UA_ReferenceTargetTreeElem, idTreeEntry,
@@ -369,6 +639,40 @@ UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
                                    const UA_DataType *responseOperationsType)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Processes the operations in parallel slices if configured with
+ * maxParallelOperationThreads. The parallel callback runs in worker threads
+ * while the server remains locked by the calling thread. It returns false
+ * (and leaves the response operation initialized) if the operation needs to be
+ * processed sequentially. These operations are then processed with the
+ * operationCallback after all slices are done. */
+typedef UA_Boolean (*UA_ParallelServiceOperation)(UA_Server *server,
+                                                  UA_Session *session,
+                                                  const void *context,
+                                                  const void *requestOperation,
+                                                  void *responseOperation);
+
+UA_StatusCode
+UA_Server_processServiceOperationsParallel(UA_Server *server, UA_Session *session,
+                                           UA_ServiceOperation operationCallback,
+                                           UA_ParallelServiceOperation parallelCallback,
+                                           const void *context,
+                                           const size_t *requestOperations,
+                                           const UA_DataType *requestOperationsType,
+                                           size_t *responseOperations,
+                                           const UA_DataType *responseOperationsType)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+/* Start maxParallelOperationThreads - 1 worker threads. The thread calling the
+ * service takes part in processing the slices. */
+void
+UA_OperationWorkers_start(UA_Server *server);
+
+/* Stop and join the worker threads. Does nothing if they are not started. */
+void
+UA_OperationWorkers_stop(UA_Server *server);
+#endif
+
 /******************************************/
 /* Internal function calls, without locks */
 /******************************************/
@@ -462,7 +766,10 @@ translateBrowsePathToNodeIds(UA_Server *server, const UA_BrowsePath *browsePath)
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
 
-void monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem);
+/* The prefetched value (can be NULL) is used if the value was already read in
+ * a batch */
+void monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem,
+                                  UA_DataValue *prefetched);
 
 UA_Subscription *
 getSubscriptionById(UA_Server *server, UA_UInt32 subscriptionId);
@@ -596,11 +903,32 @@ RefTree_containsNodeId(RefTree *rt, const UA_NodeId *target);
 
 /* Read a node attribute in the context of a "checked-out" node. So the
  * attribute will not be copied when possible. The variant then points into the
- * node and has UA_VARIANT_DATA_NODELETE set. */
+ * node and has UA_VARIANT_DATA_NODELETE set. Values from a DataSource are taken
+ * from the value cache if they are not older than maxAge (in ms). If the value
+ * was already read in a batch, it is moved out of prefetched (can be NULL). */
 void
 ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
-             UA_TimestampsToReturn timestampsToReturn,
-             const UA_ReadValueId *id, UA_DataValue *v);
+             UA_TimestampsToReturn timestampsToReturn, UA_Double maxAge,
+             UA_DataValue *prefetched, const UA_ReadValueId *id, UA_DataValue *v);
+
+/* An item for readDataSourceBatch. The timestamps and the maxAge (in ms) are
+ * given for each item, as MonitoredItems can differ in both. */
+typedef struct {
+    const UA_ReadValueId *rvi;
+    UA_TimestampsToReturn timestamps;
+    UA_Double maxAge;
+} UA_BatchReadItem;
+
+/* Read the DataSource values of the items in batches with the
+ * readDataSourceBatch callback from the server config. The values are written
+ * to the prefetched array (with the same length as items). Entries remain
+ * empty if the item is not read as part of a batch. The service lock is
+ * released during the batch callback. The ReadValueIds are not accessed after
+ * the lock was released for the first time. */
+void
+readDataSourceBatch(UA_Server *server, UA_Session *session,
+                    size_t itemsSize, const UA_BatchReadItem *items,
+                    UA_DataValue *prefetched);
 
 UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
@@ -667,7 +995,8 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
 UA_DataValue
 UA_Server_readWithSession(UA_Server *server, UA_Session *session,
                           const UA_ReadValueId *item,
-                          UA_TimestampsToReturn timestampsToReturn);
+                          UA_TimestampsToReturn timestampsToReturn,
+                          UA_Double maxAge, UA_DataValue *prefetched);
 
 /************/
 /* AddNodes */
@@ -723,6 +1052,10 @@ addNode_finish(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId);
 
 UA_StatusCode initNS0(UA_Server *server);
 
+/* Insert the nodes from an image created with UA_Server_saveNodestoreImage.
+ * The nodestore must be empty. */
+UA_StatusCode loadNodestoreImage(UA_Server *server, const UA_ByteString *image);
+
 #ifdef UA_ENABLE_DIAGNOSTICS
 void createSessionObject(UA_Server *server, UA_Session *session);
 
@@ -754,6 +1087,10 @@ readSessionSecurityDiagnostics(UA_Server *server,
                                const UA_NodeId *nodeId, void *nodeContext,
                                UA_Boolean sourceTimestamp,
                                const UA_NumericRange *range, UA_DataValue *value);
+
+/* Variables below Server/VendorServerInfo/NodestoreStatistics that are read
+ * from the nodestore statistics */
+UA_StatusCode createNodestoreStatisticsObject(UA_Server *server);
 #endif
 
 /***************************/
@@ -0,0 +1,543 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+#include "ua_types_encoding_binary.h"
+
+/* The nodestore image begins with a header (magic number, version, namespace
+ * array, number of nodes), followed by the nodes. All fields use the OPC UA
+ * binary encoding. The ReferenceTypes come first, ordered by their
+ * ReferenceTypeIndex. When they are inserted into an empty nodestore, they get
+ * the same ReferenceTypeIndex as in the image. So the references of the nodes
+ * can be stored with the ReferenceTypeIndex. */
+
+#define UA_NODESTORE_IMAGE_MAGIC 0x534E4155 /* "UANS" */
+#define UA_NODESTORE_IMAGE_VERSION 1
+#define UA_NODESTORE_IMAGE_INITIALSIZE (64 * 1024) /* Grows by doubling */
+
+/***********/
+/* Writing */
+/***********/
+
+typedef struct {
+    UA_ByteString buf;
+    size_t pos;
+    UA_UInt32 nodesCount;
+    UA_StatusCode res; /* The first error is kept, then writing stops */
+} ImageWriter;
+
+/* Called by the encoder when the end of the buffer is reached. The buffer
+ * is doubled and the encoding continues at the same position. */
+static UA_StatusCode
+growImage(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    ImageWriter *w = (ImageWriter*)handle;
+    size_t pos = (size_t)(*bufPos - w->buf.data);
+    if(w->buf.length > SIZE_MAX / 2)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    size_t newLength = w->buf.length * 2;
+    UA_Byte *data = (UA_Byte*)UA_realloc(w->buf.data, newLength);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    w->buf.data = data;
+    w->buf.length = newLength;
+    *bufPos = &data[pos];
+    *bufEnd = &data[newLength];
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Encode directly into the image buffer. The buffer grows during the
+ * encoding. So every field is encoded once without computing its size
+ * first. */
+static void
+writeImage(ImageWriter *w, const void *p, const UA_DataType *type) {
+    if(w->res != UA_STATUSCODE_GOOD)
+        return;
+    UA_Byte *pos = &w->buf.data[w->pos];
+    const UA_Byte *end = &w->buf.data[w->buf.length];
+    w->res = UA_encodeBinaryInternal(p, type, &pos, &end, growImage, w);
+    w->pos = (size_t)(pos - w->buf.data);
+}
+
+static void
+writeUInt32(ImageWriter *w, UA_UInt32 v) {
+    writeImage(w, &v, &UA_TYPES[UA_TYPES_UINT32]);
+}
+
+static void
+writeArray(ImageWriter *w, const void *p, size_t size, const UA_DataType *type) {
+    writeUInt32(w, (UA_UInt32)size);
+    uintptr_t ptr = (uintptr_t)p;
+    for(size_t i = 0; i < size; i++, ptr += type->memSize)
+        writeImage(w, (const void*)ptr, type);
+}
+
+static void
+writeLocalizedTextList(ImageWriter *w, const UA_LocalizedTextListEntry *list) {
+    UA_UInt32 count = 0;
+    for(const UA_LocalizedTextListEntry *lt = list; lt; lt = lt->next)
+        count++;
+    writeUInt32(w, count);
+    for(const UA_LocalizedTextListEntry *lt = list; lt; lt = lt->next)
+        writeImage(w, &lt->localizedText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+}
+
+static void *
+writeReferenceTarget(void *context, UA_ReferenceTarget *t) {
+    ImageWriter *w = (ImageWriter*)context;
+    UA_ExpandedNodeId id = UA_NodePointer_toExpandedNodeId(t->targetId);
+    writeImage(w, &id, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    writeUInt32(w, t->targetNameHash);
+    return NULL;
+}
+
+/* The value is only stored if it is contained in the node. Callbacks are not
+ * part of the image. VariableNodes and VariableTypeNodes have the same layout
+ * for the variable attributes. */
+static void
+writeVariableAttributes(ImageWriter *w, const UA_VariableNode *vn) {
+    writeImage(w, &vn->dataType, &UA_TYPES[UA_TYPES_NODEID]);
+    writeImage(w, &vn->valueRank, &UA_TYPES[UA_TYPES_INT32]);
+    writeArray(w, vn->arrayDimensions, vn->arrayDimensionsSize,
+               &UA_TYPES[UA_TYPES_UINT32]);
+    UA_Boolean hasValue = (vn->valueSource == UA_VALUESOURCE_DATA);
+    writeImage(w, &hasValue, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(hasValue)
+        writeImage(w, &vn->value.data.value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+static void
+writeNode(ImageWriter *w, const UA_Node *node) {
+    const UA_NodeHead *head = &node->head;
+    writeImage(w, &head->nodeClass, &UA_TYPES[UA_TYPES_NODECLASS]);
+    writeImage(w, &head->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    writeImage(w, &head->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    writeLocalizedTextList(w, head->displayName);
+    writeLocalizedTextList(w, head->description);
+    writeImage(w, &head->writeMask, &UA_TYPES[UA_TYPES_UINT32]);
+    writeImage(w, &head->constructed, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    /* References */
+    writeUInt32(w, (UA_UInt32)head->referencesSize);
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        writeImage(w, &rk->referenceTypeIndex, &UA_TYPES[UA_TYPES_BYTE]);
+        writeImage(w, &rk->isInverse, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeUInt32(w, (UA_UInt32)rk->targetsSize);
+        UA_NodeReferenceKind_iterate(rk, writeReferenceTarget, w);
+    }
+
+    /* Attributes of the NodeClass */
+    switch(head->nodeClass) {
+    case UA_NODECLASS_VARIABLE:
+        writeVariableAttributes(w, &node->variableNode);
+        writeImage(w, &node->variableNode.accessLevel, &UA_TYPES[UA_TYPES_BYTE]);
+        writeImage(w, &node->variableNode.minimumSamplingInterval,
+                   &UA_TYPES[UA_TYPES_DOUBLE]);
+        writeImage(w, &node->variableNode.historizing, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeImage(w, &node->variableNode.isDynamic, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        writeVariableAttributes(w, (const UA_VariableNode*)&node->variableTypeNode);
+        writeImage(w, &node->variableTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_METHOD:
+        writeImage(w, &node->methodNode.executable, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_OBJECT:
+        writeImage(w, &node->objectNode.eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        writeImage(w, &node->objectTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        writeImage(w, &node->referenceTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeImage(w, &node->referenceTypeNode.symmetric, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        writeImage(w, &node->referenceTypeNode.inverseName,
+                   &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        writeImage(w, &node->referenceTypeNode.referenceTypeIndex,
+                   &UA_TYPES[UA_TYPES_BYTE]);
+        for(size_t i = 0; i < UA_REFERENCETYPESET_MAX / 32; i++)
+            writeUInt32(w, node->referenceTypeNode.subTypes.bits[i]);
+        break;
+    case UA_NODECLASS_DATATYPE:
+        writeImage(w, &node->dataTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_VIEW:
+        writeImage(w, &node->viewNode.eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        writeImage(w, &node->viewNode.containsNoLoops, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    default:
+        w->res = UA_STATUSCODE_BADINTERNALERROR;
+        break;
+    }
+    w->nodesCount++;
+}
+
+/* The ReferenceTypes were already written */
+static void
+writeNodeVisitor(void *context, const UA_Node *node) {
+    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE)
+        return;
+    writeNode((ImageWriter*)context, node);
+}
+
+UA_StatusCode
+UA_Server_saveNodestoreImage(UA_Server *server, UA_ByteString *image) {
+    ImageWriter w;
+    memset(&w, 0, sizeof(ImageWriter));
+    w.res = UA_ByteString_allocBuffer(&w.buf, UA_NODESTORE_IMAGE_INITIALSIZE);
+    UA_CHECK_STATUS(w.res, return w.res);
+
+    UA_LOCK(&server->serviceMutex);
+
+    /* Header */
+    setupNs1Uri(server);
+    writeUInt32(&w, UA_NODESTORE_IMAGE_MAGIC);
+    writeUInt32(&w, UA_NODESTORE_IMAGE_VERSION);
+    writeArray(&w, server->namespaces, server->namespacesSize,
+               &UA_TYPES[UA_TYPES_STRING]);
+    size_t nodesCountPos = w.pos;
+    writeUInt32(&w, 0); /* Replaced in the end */
+
+    /* ReferenceTypes ordered by the ReferenceTypeIndex */
+    for(size_t i = 0; i < UA_REFERENCETYPESET_MAX; i++) {
+        const UA_NodeId *refTypeId = UA_NODESTORE_GETREFERENCETYPEID(server, (UA_Byte)i);
+        if(!refTypeId)
+            break;
+        const UA_Node *node = UA_NODESTORE_GET(server, refTypeId);
+        if(!node) {
+            w.res = UA_STATUSCODE_BADINTERNALERROR;
+            break;
+        }
+        writeNode(&w, node);
+        UA_NODESTORE_RELEASE(server, node);
+    }
+
+    /* All other nodes */
+    server->config.nodestore.iterate(server->config.nodestore.context,
+                                     writeNodeVisitor, &w);
+
+    UA_UNLOCK(&server->serviceMutex);
+
+    if(w.res != UA_STATUSCODE_GOOD) {
+        UA_ByteString_clear(&w.buf);
+        return w.res;
+    }
+
+    /* Set the number of nodes */
+    UA_Byte *pos = &w.buf.data[nodesCountPos];
+    const UA_Byte *end = &w.buf.data[w.buf.length];
+    w.res = UA_encodeBinaryInternal(&w.nodesCount, &UA_TYPES[UA_TYPES_UINT32],
+                                    &pos, &end, NULL, NULL);
+    UA_assert(w.res == UA_STATUSCODE_GOOD);
+
+    /* Cut to the used length */
+    w.buf.length = w.pos;
+    *image = w.buf;
+    return UA_STATUSCODE_GOOD;
+}
+
+/***********/
+/* Loading */
+/***********/
+
+typedef struct {
+    const UA_ByteString *image;
+    size_t offset;
+    const UA_DataTypeArray *customTypes;
+    UA_StatusCode res; /* The first error is kept, then reading stops */
+} ImageReader;
+
+/* The target is initialized also if reading fails */
+static void
+readImage(ImageReader *r, void *dst, const UA_DataType *type) {
+    if(r->res != UA_STATUSCODE_GOOD) {
+        UA_init(dst, type);
+        return;
+    }
+    r->res = UA_decodeBinaryInternal(r->image, &r->offset, dst, type, r->customTypes);
+}
+
+/* Every array entry has at least one byte. This guards against allocating
+ * large arrays for a corrupted image. */
+static UA_UInt32
+readCount(ImageReader *r) {
+    UA_UInt32 count = 0;
+    readImage(r, &count, &UA_TYPES[UA_TYPES_UINT32]);
+    if(count > r->image->length - r->offset) {
+        r->res = UA_STATUSCODE_BADDECODINGERROR;
+        return 0;
+    }
+    return count;
+}
+
+/* Replace the decoded string with the interned version */
+static void
+internString(ImageReader *r, UA_String *s) {
+    if(r->res != UA_STATUSCODE_GOOD)
+        return;
+    UA_String interned;
+    r->res = UA_InternTable_addString(s, &interned);
+    UA_String_clear(s);
+    if(r->res == UA_STATUSCODE_GOOD)
+        *s = interned;
+}
+
+static void
+readLocalizedTextList(ImageReader *r, UA_LocalizedTextListEntry **list) {
+    UA_UInt32 count = readCount(r);
+    UA_LocalizedTextListEntry **last = list;
+    for(UA_UInt32 i = 0; i < count && r->res == UA_STATUSCODE_GOOD; i++) {
+        UA_LocalizedTextListEntry *lt = (UA_LocalizedTextListEntry*)
+            UA_calloc(1, sizeof(UA_LocalizedTextListEntry));
+        if(!lt) {
+            r->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        readImage(r, &lt->localizedText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        internString(r, &lt->localizedText.locale);
+        internString(r, &lt->localizedText.text);
+        *last = lt;
+        last = &lt->next;
+    }
+}
+
+/* The references are read into arrays. The nodestore can switch to the tree
+ * representation later on. */
+static void
+readReferences(ImageReader *r, UA_NodeHead *head) {
+    UA_UInt32 refsSize = readCount(r);
+    if(refsSize == 0)
+        return;
+    head->references = (UA_NodeReferenceKind*)
+        UA_calloc(refsSize, sizeof(UA_NodeReferenceKind));
+    if(!head->references) {
+        r->res = UA_STATUSCODE_BADOUTOFMEMORY;
+        return;
+    }
+
+    for(UA_UInt32 i = 0; i < refsSize && r->res == UA_STATUSCODE_GOOD; i++) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        head->referencesSize++;
+        readImage(r, &rk->referenceTypeIndex, &UA_TYPES[UA_TYPES_BYTE]);
+        readImage(r, &rk->isInverse, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        UA_UInt32 targetsSize = readCount(r);
+        if(targetsSize == 0)
+            continue;
+        rk->targets.array = (UA_ReferenceTarget*)
+            UA_calloc(targetsSize, sizeof(UA_ReferenceTarget));
+        if(!rk->targets.array) {
+            r->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        for(UA_UInt32 j = 0; j < targetsSize && r->res == UA_STATUSCODE_GOOD; j++) {
+            UA_ExpandedNodeId id;
+            UA_ReferenceTarget *t = &rk->targets.array[j];
+            readImage(r, &id, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+            readImage(r, &t->targetNameHash, &UA_TYPES[UA_TYPES_UINT32]);
+            if(r->res == UA_STATUSCODE_GOOD) {
+                r->res = UA_NodePointer_copy(UA_NodePointer_fromExpandedNodeId(&id),
+                                             &t->targetId);
+                if(r->res == UA_STATUSCODE_GOOD)
+                    rk->targetsSize++;
+            }
+            UA_ExpandedNodeId_clear(&id);
+        }
+    }
+}
+
+static void
+readVariableAttributes(ImageReader *r, UA_VariableNode *vn) {
+    readImage(r, &vn->dataType, &UA_TYPES[UA_TYPES_NODEID]);
+    readImage(r, &vn->valueRank, &UA_TYPES[UA_TYPES_INT32]);
+    UA_UInt32 dimsSize = readCount(r);
+    if(dimsSize > 0 && r->res == UA_STATUSCODE_GOOD) {
+        vn->arrayDimensions = (UA_UInt32*)
+            UA_Array_new(dimsSize, &UA_TYPES[UA_TYPES_UINT32]);
+        if(!vn->arrayDimensions) {
+            r->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        vn->arrayDimensionsSize = dimsSize;
+        for(UA_UInt32 i = 0; i < dimsSize; i++)
+            readImage(r, &vn->arrayDimensions[i], &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    UA_Boolean hasValue = false;
+    readImage(r, &hasValue, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    vn->valueSource = UA_VALUESOURCE_DATA;
+    if(hasValue)
+        readImage(r, &vn->value.data.value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+static UA_StatusCode
+readNode(UA_Server *server, ImageReader *r, UA_Node **outNode) {
+    UA_NodeClass nodeClass;
+    readImage(r, &nodeClass, &UA_TYPES[UA_TYPES_NODECLASS]);
+    if(r->res != UA_STATUSCODE_GOOD)
+        return r->res;
+    UA_Node *node = UA_NODESTORE_NEW(server, nodeClass);
+    if(!node)
+        return UA_STATUSCODE_BADDECODINGERROR;
+
+    UA_NodeHead *head = &node->head;
+    readImage(r, &head->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    readImage(r, &head->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    internString(r, &head->browseName.name);
+    readLocalizedTextList(r, &head->displayName);
+    readLocalizedTextList(r, &head->description);
+    readImage(r, &head->writeMask, &UA_TYPES[UA_TYPES_UINT32]);
+    readImage(r, &head->constructed, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    readReferences(r, head);
+
+    switch(nodeClass) {
+    case UA_NODECLASS_VARIABLE:
+        readVariableAttributes(r, &node->variableNode);
+        readImage(r, &node->variableNode.accessLevel, &UA_TYPES[UA_TYPES_BYTE]);
+        readImage(r, &node->variableNode.minimumSamplingInterval,
+                  &UA_TYPES[UA_TYPES_DOUBLE]);
+        readImage(r, &node->variableNode.historizing, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        readImage(r, &node->variableNode.isDynamic, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        readVariableAttributes(r, (UA_VariableNode*)&node->variableTypeNode);
+        readImage(r, &node->variableTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_METHOD:
+        readImage(r, &node->methodNode.executable, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_OBJECT:
+        readImage(r, &node->objectNode.eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        readImage(r, &node->objectTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        readImage(r, &node->referenceTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        readImage(r, &node->referenceTypeNode.symmetric, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        readImage(r, &node->referenceTypeNode.inverseName,
+                  &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        readImage(r, &node->referenceTypeNode.referenceTypeIndex,
+                  &UA_TYPES[UA_TYPES_BYTE]);
+        for(size_t i = 0; i < UA_REFERENCETYPESET_MAX / 32; i++)
+            readImage(r, &node->referenceTypeNode.subTypes.bits[i],
+                      &UA_TYPES[UA_TYPES_UINT32]);
+        break;
+    case UA_NODECLASS_DATATYPE:
+        readImage(r, &node->dataTypeNode.isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    case UA_NODECLASS_VIEW:
+        readImage(r, &node->viewNode.eventNotifier, &UA_TYPES[UA_TYPES_BYTE]);
+        readImage(r, &node->viewNode.containsNoLoops, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    default:
+        r->res = UA_STATUSCODE_BADDECODINGERROR;
+        break;
+    }
+
+    if(r->res != UA_STATUSCODE_GOOD) {
+        UA_NODESTORE_DELETE(server, node);
+        return r->res;
+    }
+    *outNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+setSubTypes(UA_Server *server, UA_Session *session, UA_Node *node,
+            void *context) {
+    node->referenceTypeNode.subTypes = *(UA_ReferenceTypeSet*)context;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Insert the node without the checks of AddNodes. The ReferenceTypes get their
+ * ReferenceTypeIndex during the insert. Check that it is the same as in the
+ * image. The set of subtypes is reset during the insert and restored
+ * afterwards. */
+static UA_StatusCode
+insertImageNode(UA_Server *server, UA_Node *node) {
+    if(node->head.nodeClass != UA_NODECLASS_REFERENCETYPE)
+        return UA_NODESTORE_INSERT(server, node, NULL);
+
+    UA_Byte refTypeIndex = node->referenceTypeNode.referenceTypeIndex;
+    UA_ReferenceTypeSet subTypes = node->referenceTypeNode.subTypes;
+    UA_NodeId nodeId;
+    UA_StatusCode res = UA_NodeId_copy(&node->head.nodeId, &nodeId);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_NODESTORE_DELETE(server, node);
+        return res;
+    }
+
+    res = UA_NODESTORE_INSERT(server, node, NULL);
+    if(res == UA_STATUSCODE_GOOD) {
+        const UA_NodeId *indexId = UA_NODESTORE_GETREFERENCETYPEID(server, refTypeIndex);
+        if(!indexId || !UA_NodeId_equal(indexId, &nodeId))
+            res = UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_Server_editNode(server, &server->adminSession, &nodeId,
+                                 setSubTypes, &subTypes);
+    UA_NodeId_clear(&nodeId);
+    return res;
+}
+
+UA_StatusCode
+loadNodestoreImage(UA_Server *server, const UA_ByteString *image) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    ImageReader r;
+    r.image = image;
+    r.offset = 0;
+    r.customTypes = server->config.customDataTypes;
+    r.res = UA_STATUSCODE_GOOD;
+
+    /* Check the header */
+    UA_UInt32 magic = 0, version = 0;
+    readImage(&r, &magic, &UA_TYPES[UA_TYPES_UINT32]);
+    readImage(&r, &version, &UA_TYPES[UA_TYPES_UINT32]);
+    if(magic != UA_NODESTORE_IMAGE_MAGIC || version != UA_NODESTORE_IMAGE_VERSION) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "The nodestore image has an unknown format");
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+
+    /* The ReferenceTypeIndex assignment requires an empty nodestore */
+    if(UA_NODESTORE_GETREFERENCETYPEID(server, 0)) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "The nodestore image can only be loaded into an empty nodestore");
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    }
+
+    /* Add the namespaces. Namespace 1 is always the application URI. The
+     * namespace indices have to be the same as in the image. */
+    UA_UInt32 namespacesSize = readCount(&r);
+    for(UA_UInt32 i = 0; i < namespacesSize && r.res == UA_STATUSCODE_GOOD; i++) {
+        UA_String ns;
+        readImage(&r, &ns, &UA_TYPES[UA_TYPES_STRING]);
+        if(i >= 2 && r.res == UA_STATUSCODE_GOOD && addNamespace(server, ns) != i)
+            r.res = UA_STATUSCODE_BADINTERNALERROR;
+        UA_String_clear(&ns);
+    }
+
+    /* Add the nodes */
+    UA_UInt32 nodesCount = readCount(&r);
+    UA_StatusCode res = r.res;
+    for(UA_UInt32 i = 0; i < nodesCount && res == UA_STATUSCODE_GOOD; i++) {
+        UA_Node *node = NULL;
+        res = readNode(server, &r, &node);
+        if(res == UA_STATUSCODE_GOOD)
+            res = insertImageNode(server, node);
+    }
+
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "Loading the nodestore image failed with %s",
+                     UA_StatusCode_name(res));
+        return res;
+    }
+
+    UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                "Loaded %u nodes from the nodestore image", (unsigned)nodesCount);
+    return UA_STATUSCODE_GOOD;
+}
@@ -912,17 +912,25 @@ initNS0(UA_Server *server) {
     /* Initialize base nodes which are always required an cannot be created
      * through the NS compiler */
     server->bootstrapNS0 = true;
-    UA_StatusCode retVal = createNS0_base(server);
+    UA_StatusCode retVal;
+    if(server->config.nodestoreImage) {
+        /* Load all nodes from the image. The image is only used during the
+         * server creation. */
+        retVal = loadNodestoreImage(server, server->config.nodestoreImage);
+        server->config.nodestoreImage = NULL;
+    } else {
+        retVal = createNS0_base(server);
 
 #ifdef UA_GENERATED_NAMESPACE_ZERO
-    UA_UNLOCK(&server->serviceMutex);
-    /* Load nodes and references generated from the XML ns0 definition */
-    retVal |= namespace0_generated(server);
-    UA_LOCK(&server->serviceMutex);
+        UA_UNLOCK(&server->serviceMutex);
+        /* Load nodes and references generated from the XML ns0 definition */
+        retVal |= namespace0_generated(server);
+        UA_LOCK(&server->serviceMutex);
 #else
-    /* Create a minimal server object */
-    retVal |= minimalServerObject(server);
+        /* Create a minimal server object */
+        retVal |= minimalServerObject(server);
 #endif
+    }
 
     server->bootstrapNS0 = false;
 
@@ -1209,6 +1217,9 @@ initNS0(UA_Server *server) {
     retVal |= setVariableNode_dataSource(server,
                         UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY_SESSIONSECURITYDIAGNOSTICSARRAY), sessionSecDiagSummary);
 
+    /* VendorServerInfo - NodestoreStatistics */
+    retVal |= createNodestoreStatisticsObject(server);
+
 #else
     /* Removing these NodeIds make Server Object to be non-complaint with UA
      * 1.03 in CTT (Base Inforamtion/Base Info Core Structure/ 001.js) In the
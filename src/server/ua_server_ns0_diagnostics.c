@@ -9,6 +9,7 @@
 #include "ua_session.h"
 #include "ua_subscription.h"
 #include "itoa.h"
+#include "../deps/mp_printf.h"
 
 #ifdef UA_ENABLE_DIAGNOSTICS
 
@@ -603,4 +604,152 @@ readDiagnostics(UA_Server *server, const UA_NodeId *sessionId, void *sessionCont
     return res;
 }
 
+/************************/
+/* Nodestore Statistics */
+/************************/
+
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+
+/* The variables have fixed NodeIds in namespace 1. So they are found again
+ * when the server is started from a nodestore image. The node context is the
+ * index in this table. The first entries are scalars, then the arrays. */
+static const char *nodestoreStatisticsNames[] = {
+    "NodeCount", "Capacity", "GetCount", "CopyCount", "InsertCount",
+    "ReplaceCount", "ReplaceConflictCount", "RemoveCount",
+    "ProbeHistogram", "NodeClassCount", "NodeClassBytes"
+};
+#define NODESTORESTATISTICS_SCALARS 8
+#define NODESTORESTATISTICS_SIZE 11
+
+static UA_StatusCode
+readNodestoreStatistics(UA_Server *server, const UA_NodeId *sessionId,
+                        void *sessionContext, const UA_NodeId *nodeId,
+                        void *nodeContext, UA_Boolean sourceTimestamp,
+                        const UA_NumericRange *range, UA_DataValue *value) {
+    if(range) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    if(sourceTimestamp) {
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = UA_DateTime_now();
+    }
+
+    UA_NodestoreStatistics stats;
+    memset(&stats, 0, sizeof(UA_NodestoreStatistics));
+    UA_LOCK(&server->serviceMutex);
+    if(server->config.nodestore.getStatistics)
+        server->config.nodestore.getStatistics(server->config.nodestore.context,
+                                               &stats);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Scalar counters */
+    uintptr_t index = (uintptr_t)nodeContext;
+    const size_t scalars[NODESTORESTATISTICS_SCALARS] = {
+        stats.nodeCount, stats.capacity, stats.getCount, stats.copyCount,
+        stats.insertCount, stats.replaceCount, stats.replaceConflictCount,
+        stats.removeCount
+    };
+    UA_StatusCode res;
+    if(index < NODESTORESTATISTICS_SCALARS) {
+        UA_UInt64 v = scalars[index];
+        res = UA_Variant_setScalarCopy(&value->value, &v, &UA_TYPES[UA_TYPES_UINT64]);
+        if(res == UA_STATUSCODE_GOOD)
+            value->hasValue = true;
+        return res;
+    }
+
+    /* Arrays */
+    const size_t *src;
+    size_t srcSize;
+    switch(index) {
+    case NODESTORESTATISTICS_SCALARS:
+        src = stats.probeHistogram;
+        srcSize = UA_NODESTORE_PROBEHISTOGRAMSIZE;
+        break;
+    case NODESTORESTATISTICS_SCALARS + 1:
+        src = stats.nodeClassCount;
+        srcSize = UA_NODESTORE_NODECLASSES;
+        break;
+    case NODESTORESTATISTICS_SCALARS + 2:
+        src = stats.nodeClassBytes;
+        srcSize = UA_NODESTORE_NODECLASSES;
+        break;
+    default:
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_UInt64 *arr = (UA_UInt64*)UA_Array_new(srcSize, &UA_TYPES[UA_TYPES_UINT64]);
+    if(!arr)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < srcSize; i++)
+        arr[i] = src[i];
+    UA_Variant_setArray(&value->value, arr, srcSize, &UA_TYPES[UA_TYPES_UINT64]);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_Boolean
+nodeExists(UA_Server *server, const UA_NodeId *nodeId) {
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node)
+        return false;
+    UA_NODESTORE_RELEASE(server, node);
+    return true;
+}
+
+UA_StatusCode
+createNodestoreStatisticsObject(UA_Server *server) {
+    UA_NodeId objId = UA_NODEID_STRING(1, "NodestoreStatistics");
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(!nodeExists(server, &objId)) {
+        UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+        oattr.displayName = UA_LOCALIZEDTEXT("", "NodestoreStatistics");
+        res = addNode(server, UA_NODECLASS_OBJECT, objId,
+                      UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_VENDORSERVERINFO),
+                      UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                      UA_QUALIFIEDNAME(1, "NodestoreStatistics"),
+                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                      &oattr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES], NULL, NULL);
+        UA_CHECK_STATUS(res, return res);
+    }
+
+    UA_DataSource statsSource = {readNodestoreStatistics, NULL};
+    for(size_t i = 0; i < NODESTORESTATISTICS_SIZE; i++) {
+        char idStr[64];
+        mp_snprintf(idStr, 64, "NodestoreStatistics.%s", nodestoreStatisticsNames[i]);
+        UA_NodeId varId = UA_NODEID_STRING(1, idStr);
+        if(!nodeExists(server, &varId)) {
+            UA_VariableAttributes vattr = UA_VariableAttributes_default;
+            vattr.displayName =
+                UA_LOCALIZEDTEXT("", (char*)(uintptr_t)nodestoreStatisticsNames[i]);
+            vattr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+            vattr.accessLevel = UA_ACCESSLEVELMASK_READ;
+            UA_UInt64 zero = 0;
+            UA_UInt32 arrayDims = 0;
+            if(i < NODESTORESTATISTICS_SCALARS) {
+                UA_Variant_setScalar(&vattr.value, &zero, &UA_TYPES[UA_TYPES_UINT64]);
+            } else {
+                vattr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+                vattr.arrayDimensionsSize = 1;
+                vattr.arrayDimensions = &arrayDims;
+                UA_Variant_setArray(&vattr.value, UA_EMPTY_ARRAY_SENTINEL,
+                                    0, &UA_TYPES[UA_TYPES_UINT64]);
+            }
+            res |= addNode(server, UA_NODECLASS_VARIABLE, varId, objId,
+                           UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                           UA_QUALIFIEDNAME(1, (char*)(uintptr_t)nodestoreStatisticsNames[i]),
+                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                           &vattr, &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES], NULL, NULL);
+        }
+        res |= setVariableNode_dataSource(server, varId, statsSource);
+        res |= setNodeContext(server, varId, (void*)(uintptr_t)i);
+    }
+    return res;
+}
+
+#endif /* UA_GENERATED_NAMESPACE_ZERO */
+
 #endif /* UA_ENABLE_DIAGNOSTICS */
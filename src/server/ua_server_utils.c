@@ -332,6 +332,222 @@ UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
     return UA_STATUSCODE_GOOD;
 }
 
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+
+typedef struct OperationSlice {
+    UA_Server *server;
+    UA_Session *session;
+    UA_ParallelServiceOperation callback;
+    const void *context;
+    uintptr_t reqOp;
+    const UA_DataType *reqType;
+    uintptr_t respOp;
+    const UA_DataType *respType;
+    UA_Boolean *deferred; /* Set for operations to be processed sequentially */
+    size_t ops;
+} OperationSlice;
+
+static void
+processOperationSlice(OperationSlice *slice) {
+    uintptr_t reqOp = slice->reqOp;
+    uintptr_t respOp = slice->respOp;
+    for(size_t i = 0; i < slice->ops; i++) {
+        slice->deferred[i] = !slice->callback(slice->server, slice->session,
+                                              slice->context, (void*)reqOp,
+                                              (void*)respOp);
+        reqOp += slice->reqType->memSize;
+        respOp += slice->respType->memSize;
+    }
+}
+
+/* Take the next slice of the current job and process it. Called with the
+ * mutex of the workers held. Returns false if there is no slice left. */
+static UA_Boolean
+processNextSlice(UA_OperationWorkers *ow) {
+    if(ow->nextSlice >= ow->slicesSize)
+        return false;
+    OperationSlice *slice = &ow->slices[ow->nextSlice++];
+    pthread_mutex_unlock(&ow->mutex);
+    processOperationSlice(slice);
+    pthread_mutex_lock(&ow->mutex);
+    ow->slicesDone++;
+    if(ow->slicesDone == ow->slicesSize)
+        pthread_cond_signal(&ow->doneCondition);
+    return true;
+}
+
+static void *
+operationWorkerLoop(void *data) {
+    UA_OperationWorkers *ow = (UA_OperationWorkers*)data;
+    pthread_mutex_lock(&ow->mutex);
+    while(!ow->stop) {
+        if(!processNextSlice(ow))
+            pthread_cond_wait(&ow->workCondition, &ow->mutex);
+    }
+    pthread_mutex_unlock(&ow->mutex);
+    return NULL;
+}
+
+void
+UA_OperationWorkers_start(UA_Server *server) {
+    UA_OperationWorkers *ow = &server->operationWorkers;
+    if(ow->threads || server->config.maxParallelOperationThreads < 2)
+        return;
+
+    size_t workers = (size_t)server->config.maxParallelOperationThreads - 1;
+    ow->threads = (pthread_t*)UA_calloc(workers, sizeof(pthread_t));
+    if(!ow->threads) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Could not allocate the parallel operation workers");
+        return;
+    }
+
+    pthread_mutex_init(&ow->mutex, NULL);
+    pthread_cond_init(&ow->workCondition, NULL);
+    pthread_cond_init(&ow->doneCondition, NULL);
+    ow->slices = NULL;
+    ow->slicesSize = 0;
+    ow->nextSlice = 0;
+    ow->slicesDone = 0;
+    ow->stop = false;
+
+    for(ow->threadsSize = 0; ow->threadsSize < workers; ow->threadsSize++) {
+        if(pthread_create(&ow->threads[ow->threadsSize], NULL,
+                          operationWorkerLoop, ow) != 0) {
+            UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                           "Could only start %u of %u parallel operation workers",
+                           (unsigned)ow->threadsSize, (unsigned)workers);
+            break;
+        }
+    }
+}
+
+void
+UA_OperationWorkers_stop(UA_Server *server) {
+    UA_OperationWorkers *ow = &server->operationWorkers;
+    if(!ow->threads)
+        return;
+
+    pthread_mutex_lock(&ow->mutex);
+    ow->stop = true;
+    pthread_cond_broadcast(&ow->workCondition);
+    pthread_mutex_unlock(&ow->mutex);
+    for(size_t i = 0; i < ow->threadsSize; i++)
+        pthread_join(ow->threads[i], NULL);
+
+    pthread_cond_destroy(&ow->doneCondition);
+    pthread_cond_destroy(&ow->workCondition);
+    pthread_mutex_destroy(&ow->mutex);
+    UA_free(ow->threads);
+    ow->threads = NULL;
+    ow->threadsSize = 0;
+}
+
+#endif
+
+UA_StatusCode
+UA_Server_processServiceOperationsParallel(UA_Server *server, UA_Session *session,
+                                           UA_ServiceOperation operationCallback,
+                                           UA_ParallelServiceOperation parallelCallback,
+                                           const void *context,
+                                           const size_t *requestOperations,
+                                           const UA_DataType *requestOperationsType,
+                                           size_t *responseOperations,
+                                           const UA_DataType *responseOperationsType) {
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    /* Use the sequential path for small requests. Every worker thread and the
+     * calling thread process one slice. */
+    UA_OperationWorkers *ow = &server->operationWorkers;
+    size_t ops = *requestOperations;
+    size_t minOps = server->config.minParallelOperations;
+    if(minOps == 0)
+        minOps = 1;
+    size_t slices = ops / minOps;
+    if(slices > ow->threadsSize + 1)
+        slices = ow->threadsSize + 1;
+    if(slices < 2)
+        return UA_Server_processServiceOperations(server, session, operationCallback,
+                                                  context, requestOperations,
+                                                  requestOperationsType,
+                                                  responseOperations,
+                                                  responseOperationsType);
+
+    /* Allocate the response array and the slices */
+    void **respPos = (void**)((uintptr_t)responseOperations + sizeof(size_t));
+    *respPos = UA_Array_new(ops, responseOperationsType);
+    UA_Boolean *deferred = (UA_Boolean*)UA_calloc(ops, sizeof(UA_Boolean));
+    OperationSlice *slice = (OperationSlice*)
+        UA_calloc(slices, sizeof(OperationSlice));
+    if(!(*respPos) || !deferred || !slice) {
+        UA_Array_delete(*respPos, ops, responseOperationsType);
+        *respPos = NULL;
+        UA_free(deferred);
+        UA_free(slice);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    *responseOperations = ops;
+
+    /* Partition the operations. Every slice writes into its own part of the
+     * response array. */
+    uintptr_t reqOp = *(uintptr_t*)((uintptr_t)requestOperations + sizeof(size_t));
+    uintptr_t respOp = (uintptr_t)*respPos;
+    size_t pos = 0;
+    for(size_t i = 0; i < slices; i++) {
+        size_t sliceOps = ops / slices + ((i < ops % slices) ? 1 : 0);
+        slice[i].server = server;
+        slice[i].session = session;
+        slice[i].callback = parallelCallback;
+        slice[i].context = context;
+        slice[i].reqOp = reqOp + (pos * requestOperationsType->memSize);
+        slice[i].reqType = requestOperationsType;
+        slice[i].respOp = respOp + (pos * responseOperationsType->memSize);
+        slice[i].respType = responseOperationsType;
+        slice[i].deferred = &deferred[pos];
+        slice[i].ops = sliceOps;
+        pos += sliceOps;
+    }
+
+    /* Hand the slices to the workers. The current thread takes part until no
+     * slice is left. Then wait for the slices still processed by the
+     * workers. */
+    pthread_mutex_lock(&ow->mutex);
+    ow->slices = slice;
+    ow->slicesSize = slices;
+    ow->nextSlice = 0;
+    ow->slicesDone = 0;
+    pthread_cond_broadcast(&ow->workCondition);
+    while(processNextSlice(ow)) {}
+    while(ow->slicesDone < ow->slicesSize)
+        pthread_cond_wait(&ow->doneCondition, &ow->mutex);
+    ow->slices = NULL;
+    ow->slicesSize = 0;
+    ow->nextSlice = 0;
+    ow->slicesDone = 0;
+    pthread_mutex_unlock(&ow->mutex);
+
+    /* Process the deferred operations sequentially */
+    for(size_t i = 0; i < ops; i++) {
+        if(!deferred[i])
+            continue;
+        operationCallback(server, session, context,
+                          (void*)(reqOp + (i * requestOperationsType->memSize)),
+                          (void*)(respOp + (i * responseOperationsType->memSize)));
+    }
+
+    UA_free(deferred);
+    UA_free(slice);
+    return UA_STATUSCODE_GOOD;
+#else
+    return UA_Server_processServiceOperations(server, session, operationCallback,
+                                              context, requestOperations,
+                                              requestOperationsType,
+                                              responseOperations,
+                                              responseOperationsType);
+#endif
+}
+
 /* A few global NodeId definitions */
 const UA_NodeId subtypeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASSUBTYPE}};
 const UA_NodeId hierarchicalReferences = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HIERARCHICALREFERENCES}};
@@ -0,0 +1,117 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+
+static enum ZIP_CMP
+cmpValueCacheNodeId(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
+
+ZIP_FUNCTIONS(UA_ValueCacheTree, UA_ValueCacheEntry, treeEntry,
+              UA_NodeId, nodeId, cmpValueCacheNodeId)
+
+static void
+UA_ValueCacheEntry_delete(UA_ValueCache *vc, UA_ValueCacheEntry *entry) {
+    ZIP_REMOVE(UA_ValueCacheTree, &vc->entries, entry);
+    TAILQ_REMOVE(&vc->lru, entry, lruEntry);
+    UA_NodeId_clear(&entry->nodeId);
+    UA_DataValue_clear(&entry->value);
+    UA_free(entry);
+    vc->stats.currentEntryCount--;
+}
+
+void
+UA_ValueCache_init(UA_ValueCache *vc) {
+    memset(vc, 0, sizeof(UA_ValueCache));
+    ZIP_INIT(&vc->entries);
+    TAILQ_INIT(&vc->lru);
+}
+
+void
+UA_ValueCache_clear(UA_ValueCache *vc) {
+    UA_ValueCacheEntry *entry, *entry_tmp;
+    TAILQ_FOREACH_SAFE(entry, &vc->lru, lruEntry, entry_tmp) {
+        UA_ValueCacheEntry_delete(vc, entry);
+    }
+    UA_ValueCache_init(vc);
+}
+
+UA_StatusCode
+UA_ValueCache_get(UA_ValueCache *vc, const UA_NodeId *nodeId,
+                  UA_DateTime now, UA_Double maxAge, UA_DataValue *v) {
+    /* Not found or too old */
+    UA_ValueCacheEntry *entry = ZIP_FIND(UA_ValueCacheTree, &vc->entries, nodeId);
+    if(!entry || (UA_Double)(now - entry->readTime) > maxAge * UA_DATETIME_MSEC) {
+        vc->stats.missCount++;
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+
+    UA_StatusCode res = UA_DataValue_copy(&entry->value, v);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Move to the front of the lru list */
+    TAILQ_REMOVE(&vc->lru, entry, lruEntry);
+    TAILQ_INSERT_HEAD(&vc->lru, entry, lruEntry);
+    vc->stats.hitCount++;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_ValueCache_put(UA_ValueCache *vc, size_t maxSize, const UA_NodeId *nodeId,
+                  UA_DateTime now, const UA_DataValue *v) {
+    if(maxSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Copy the value first. So the existing entry remains if this fails. */
+    UA_DataValue tmp;
+    UA_StatusCode res = UA_DataValue_copy(v, &tmp);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Replace the value of an existing entry */
+    UA_ValueCacheEntry *entry = ZIP_FIND(UA_ValueCacheTree, &vc->entries, nodeId);
+    if(entry) {
+        UA_DataValue_clear(&entry->value);
+        entry->value = tmp;
+        entry->readTime = now;
+        TAILQ_REMOVE(&vc->lru, entry, lruEntry);
+        TAILQ_INSERT_HEAD(&vc->lru, entry, lruEntry);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Evict the least recently used entries */
+    while(vc->stats.currentEntryCount >= maxSize) {
+        UA_ValueCacheEntry_delete(vc, TAILQ_LAST(&vc->lru, UA_ValueCacheList));
+        vc->stats.evictionCount++;
+    }
+
+    /* Add a new entry */
+    entry = (UA_ValueCacheEntry*)UA_malloc(sizeof(UA_ValueCacheEntry));
+    if(!entry) {
+        UA_DataValue_clear(&tmp);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    res = UA_NodeId_copy(nodeId, &entry->nodeId);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_DataValue_clear(&tmp);
+        UA_free(entry);
+        return res;
+    }
+    entry->value = tmp;
+    entry->readTime = now;
+    ZIP_INSERT(UA_ValueCacheTree, &vc->entries, entry);
+    TAILQ_INSERT_HEAD(&vc->lru, entry, lruEntry);
+    vc->stats.currentEntryCount++;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ValueCache_remove(UA_ValueCache *vc, const UA_NodeId *nodeId) {
+    UA_ValueCacheEntry *entry = ZIP_FIND(UA_ValueCacheTree, &vc->entries, nodeId);
+    if(entry)
+        UA_ValueCacheEntry_delete(vc, entry);
+}
@@ -196,11 +196,33 @@ static UA_StatusCode
 readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
                                  const UA_VariableNode *vn, UA_DataValue *v,
                                  UA_TimestampsToReturn timestamps,
-                                 UA_NumericRange *rangeptr) {
+                                 UA_NumericRange *rangeptr, UA_Double maxAge,
+                                 UA_DataValue *prefetched) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
     if(!vn->value.dataSource.read)
         return UA_STATUSCODE_BADINTERNALERROR;
-    UA_Boolean sourceTimeStamp = (timestamps == UA_TIMESTAMPSTORETURN_SOURCE ||
+
+    /* The value was already read in a batch. Move it into the result. */
+    if(prefetched && !rangeptr &&
+       (prefetched->hasValue || prefetched->hasStatus)) {
+        *v = *prefetched;
+        UA_DataValue_init(prefetched);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Use the value cache. Reads with an IndexRange bypass the cache. */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_Boolean useCache = (server->config.maxValueCacheSize > 0 && !rangeptr);
+    if(useCache && maxAge > 0.0 &&
+       UA_ValueCache_get(&server->valueCache, &vn->head.nodeId,
+                         el->dateTime_nowMonotonic(el), maxAge,
+                         v) == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOOD;
+
+    /* Cached values always contain the source timestamp. It is removed later
+     * on if it was not requested. */
+    UA_Boolean sourceTimeStamp = (useCache ||
+                                  timestamps == UA_TIMESTAMPSTORETURN_SOURCE ||
                                   timestamps == UA_TIMESTAMPSTORETURN_BOTH);
     UA_DataValue v2;
     UA_DataValue_init(&v2);
@@ -218,13 +240,19 @@ readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
     } else {
         *v = v2;
     }
+
+    /* Update the cache. Failing to cache is not an error for the read. */
+    if(useCache && retval == UA_STATUSCODE_GOOD)
+        UA_ValueCache_put(&server->valueCache, server->config.maxValueCacheSize,
+                          &vn->head.nodeId, el->dateTime_nowMonotonic(el), v);
     return retval;
 }
 
 static UA_StatusCode
 readValueAttributeComplete(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_TimestampsToReturn timestamps,
-                           const UA_String *indexRange, UA_DataValue *v) {
+                           const UA_String *indexRange, UA_Double maxAge,
+                           UA_DataValue *prefetched, UA_DataValue *v) {
     /* Compute the index range */
     UA_NumericRange range;
     UA_NumericRange *rangeptr = NULL;
@@ -243,7 +271,8 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
             break;
         case UA_VALUEBACKENDTYPE_DATA_SOURCE_CALLBACK:
             retval = readValueAttributeFromDataSource(server, session, vn, v,
-                                                      timestamps, rangeptr);
+                                                      timestamps, rangeptr, maxAge,
+                                                      prefetched);
             //TODO change old structure to value backend
             break;
         case UA_VALUEBACKENDTYPE_EXTERNAL:
@@ -272,7 +301,8 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
                 retval = readValueAttributeFromNode(server, session, vn, v, rangeptr);
             else
                 retval = readValueAttributeFromDataSource(server, session, vn, v,
-                                                          timestamps, rangeptr);
+                                                          timestamps, rangeptr, maxAge,
+                                                          prefetched);
             /* end lagacy */
             break;
     }
@@ -299,7 +329,8 @@ UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
                    const UA_VariableNode *vn, UA_DataValue *v) {
     return readValueAttributeComplete(server, session, vn,
-                                      UA_TIMESTAMPSTORETURN_NEITHER, NULL, v);
+                                      UA_TIMESTAMPSTORETURN_NEITHER, NULL,
+                                      0.0, NULL, v);
 }
 
 static const UA_String binEncoding = {sizeof("Default Binary")-1, (UA_Byte*)"Default Binary"};
@@ -383,8 +414,8 @@ getStructureDefinition(const UA_DataType *type, UA_StructureDefinition *def) {
  * node has been released! */
 void
 ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
-             UA_TimestampsToReturn timestampsToReturn,
-             const UA_ReadValueId *id, UA_DataValue *v) {
+             UA_TimestampsToReturn timestampsToReturn, UA_Double maxAge,
+             UA_DataValue *prefetched, const UA_ReadValueId *id, UA_DataValue *v) {
     UA_LOG_NODEID_TRACE(&node->head.nodeId,
                         UA_LOG_TRACE_SESSION(&server->config.logger, session,
                                              "Read attribute %"PRIi32 " of Node %.*s",
@@ -498,7 +529,8 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
             }
         }
         retval = readValueAttributeComplete(server, session, &node->variableNode,
-                                            timestampsToReturn, &id->indexRange, v);
+                                            timestampsToReturn, &id->indexRange,
+                                            maxAge, prefetched, v);
         break;
     }
     case UA_ATTRIBUTEID_DATATYPE:
@@ -632,8 +664,140 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
     }
 }
 
+/* Can the value be read as part of a batch? Checks the same conditions as
+ * ReadWithNode before the DataSource is called. */
+static UA_Boolean
+isBatchReadable(UA_Server *server, UA_Session *session, const UA_Node *node,
+                const UA_ReadValueId *rvi) {
+    if(rvi->attributeId != UA_ATTRIBUTEID_VALUE || rvi->indexRange.length > 0)
+        return false;
+    if(rvi->dataEncoding.name.length > 0 &&
+       !UA_String_equal(&binEncoding, &rvi->dataEncoding.name))
+        return false;
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE)
+        return false;
+    const UA_VariableNode *vn = &node->variableNode;
+    if(vn->valueBackend.backendType != UA_VALUEBACKENDTYPE_NONE ||
+       vn->valueSource != UA_VALUESOURCE_DATASOURCE || !vn->value.dataSource.read)
+        return false;
+    if(!(getAccessLevel(server, session, vn) & UA_ACCESSLEVELMASK_READ))
+        return false;
+    return (getUserAccessLevel(server, session, vn) & UA_ACCESSLEVELMASK_READ);
+}
+
+void
+readDataSourceBatch(UA_Server *server, UA_Session *session,
+                    size_t itemsSize, const UA_BatchReadItem *items,
+                    UA_DataValue *prefetched) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_DataSourceBatchRead batchRead = server->config.readDataSourceBatch;
+    if(!batchRead || itemsSize < 2)
+        return;
+
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_Boolean useCache = (server->config.maxValueCacheSize > 0);
+    const UA_Node **nodes = (const UA_Node**)
+        UA_calloc(itemsSize, sizeof(const UA_Node*));
+    UA_DataSourceReadItem *batch = (UA_DataSourceReadItem*)
+        UA_calloc(itemsSize, sizeof(UA_DataSourceReadItem));
+    size_t *batchIndex = (size_t*)UA_calloc(itemsSize, sizeof(size_t));
+    UA_Boolean *sourceTimeStamps = (UA_Boolean*)
+        UA_calloc(itemsSize, sizeof(UA_Boolean));
+    if(!nodes || !batch || !batchIndex || !sourceTimeStamps)
+        goto cleanup;
+
+    /* Collect the nodes to be read in batches. Take values from the cache
+     * where possible. */
+    for(size_t i = 0; i < itemsSize; i++) {
+        const UA_Node *node =
+            UA_NODESTORE_GET_SELECTIVE(server, &items[i].rvi->nodeId,
+                                       attributeId2AttributeMask(UA_ATTRIBUTEID_VALUE),
+                                       UA_REFERENCETYPESET_NONE,
+                                       UA_BROWSEDIRECTION_INVALID);
+        if(!node)
+            continue;
+        if(!isBatchReadable(server, session, node, items[i].rvi) ||
+           (useCache && items[i].maxAge > 0.0 &&
+            UA_ValueCache_get(&server->valueCache, &node->head.nodeId,
+                              el->dateTime_nowMonotonic(el), items[i].maxAge,
+                              &prefetched[i]) == UA_STATUSCODE_GOOD)) {
+            UA_NODESTORE_RELEASE(server, node);
+            continue;
+        }
+        nodes[i] = node;
+
+        /* Cached values always contain the source timestamp */
+        sourceTimeStamps[i] =
+            (useCache || items[i].timestamps == UA_TIMESTAMPSTORETURN_SOURCE ||
+             items[i].timestamps == UA_TIMESTAMPSTORETURN_BOTH);
+    }
+
+    /* Batch the nodes with the same DataSource read callback */
+    for(size_t i = 0; i < itemsSize; i++) {
+        if(!nodes[i])
+            continue;
+        UA_DataSource dataSource = nodes[i]->variableNode.value.dataSource;
+        UA_Boolean sourceTimeStamp = false;
+        size_t batchSize = 0;
+        for(size_t j = i; j < itemsSize; j++) {
+            if(!nodes[j] ||
+               nodes[j]->variableNode.value.dataSource.read != dataSource.read)
+                continue;
+            batch[batchSize].nodeId = &nodes[j]->head.nodeId;
+            batch[batchSize].nodeContext = nodes[j]->head.context;
+            UA_DataValue_init(&batch[batchSize].value);
+            batchIndex[batchSize] = j;
+            sourceTimeStamp |= sourceTimeStamps[j];
+            batchSize++;
+        }
+
+        /* Read the batch */
+        UA_UNLOCK(&server->serviceMutex);
+        UA_StatusCode res =
+            batchRead(server, session ? &session->sessionId : NULL,
+                      session ? session->sessionHandle : NULL,
+                      &dataSource, sourceTimeStamp, batchSize, batch);
+        UA_LOCK(&server->serviceMutex);
+
+        /* Move the values to the prefetched array. Items without a value are
+         * read individually later on. */
+        for(size_t k = 0; k < batchSize; k++) {
+            size_t j = batchIndex[k];
+            UA_DataValue *bv = &batch[k].value;
+            if(res == UA_STATUSCODE_GOOD && (bv->hasValue || bv->hasStatus)) {
+                if(bv->hasValue && bv->value.storageType == UA_VARIANT_DATA_NODELETE) {
+                    if(UA_DataValue_copy(bv, &prefetched[j]) != UA_STATUSCODE_GOOD)
+                        UA_DataValue_init(&prefetched[j]);
+                } else {
+                    prefetched[j] = *bv;
+                    UA_DataValue_init(bv);
+                }
+                if(useCache && prefetched[j].hasValue)
+                    UA_ValueCache_put(&server->valueCache,
+                                      server->config.maxValueCacheSize,
+                                      &nodes[j]->head.nodeId,
+                                      el->dateTime_nowMonotonic(el), &prefetched[j]);
+            }
+            UA_DataValue_clear(bv);
+            UA_NODESTORE_RELEASE(server, nodes[j]);
+            nodes[j] = NULL;
+        }
+    }
+
+ cleanup:
+    UA_free(nodes);
+    UA_free(batch);
+    UA_free(batchIndex);
+    UA_free(sourceTimeStamps);
+}
+
+typedef struct {
+    const UA_ReadRequest *request;
+    UA_DataValue *prefetched; /* Values from batched reads or NULL */
+} ReadContext;
+
 static void
-Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
+Operation_Read(UA_Server *server, UA_Session *session, ReadContext *ctx,
                UA_ReadValueId *rvi, UA_DataValue *result) {
     /* Get the node (with only the selected attribute if the NodeStore supports that) */
     const UA_Node *node =
@@ -644,7 +808,11 @@ Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
 
     /* Perform the read operation */
     if(node) {
-        ReadWithNode(node, server, session, request->timestampsToReturn, rvi, result);
+        UA_DataValue *prefetched = NULL;
+        if(ctx->prefetched)
+            prefetched = &ctx->prefetched[rvi - ctx->request->nodesToRead];
+        ReadWithNode(node, server, session, ctx->request->timestampsToReturn,
+                     ctx->request->maxAge, prefetched, rvi, result);
         UA_NODESTORE_RELEASE(server, node);
     } else {
         result->hasStatus = true;
@@ -652,6 +820,76 @@ Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
     }
 }
 
+/* Read in a worker thread of the parallel service operations. The server
+ * remains locked by the calling thread. Operations that call into user code
+ * are deferred to the sequential path. The AccessControl is called from the
+ * worker thread only if configured with parallelAccessControl. */
+static UA_Boolean
+Operation_ReadParallel(UA_Server *server, UA_Session *session, ReadContext *ctx,
+                       UA_ReadValueId *rvi, UA_DataValue *result) {
+    UA_Boolean isAdmin = (session == &server->adminSession);
+    if(!isAdmin && (rvi->attributeId == UA_ATTRIBUTEID_USERWRITEMASK ||
+                    rvi->attributeId == UA_ATTRIBUTEID_USERACCESSLEVEL ||
+                    rvi->attributeId == UA_ATTRIBUTEID_USEREXECUTABLE))
+        return false;
+
+    const UA_Node *node =
+        UA_NODESTORE_GET_SELECTIVE(server, &rvi->nodeId,
+                                   attributeId2AttributeMask((UA_AttributeId)rvi->attributeId),
+                                   UA_REFERENCETYPESET_NONE,
+                                   UA_BROWSEDIRECTION_INVALID);
+    if(!node) {
+        result->hasStatus = true;
+        result->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        return true;
+    }
+
+    /* Only read values stored in the node */
+    UA_Session *readSession = session;
+    if(rvi->attributeId == UA_ATTRIBUTEID_VALUE &&
+       (node->head.nodeClass == UA_NODECLASS_VARIABLE ||
+        node->head.nodeClass == UA_NODECLASS_VARIABLETYPE)) {
+        const UA_VariableNode *vn = &node->variableNode;
+        UA_Boolean inNode =
+            (vn->valueBackend.backendType == UA_VALUEBACKENDTYPE_INTERNAL ||
+             (vn->valueBackend.backendType == UA_VALUEBACKENDTYPE_NONE &&
+              vn->valueSource == UA_VALUESOURCE_DATA));
+        if(!inNode || vn->value.data.callback.onRead) {
+            UA_NODESTORE_RELEASE(server, node);
+            return false;
+        }
+
+        /* Check the UserAccessLevel without releasing the server lock. Then
+         * read with the admin session to skip the check in ReadWithNode. The
+         * session is not used otherwise to read the value from the node. */
+        if(!isAdmin && node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+           (vn->accessLevel & UA_ACCESSLEVELMASK_READ)) {
+#if UA_MULTITHREADING >= 100
+            if(!server->config.parallelAccessControl) {
+                UA_NODESTORE_RELEASE(server, node);
+                return false;
+            }
+#endif
+            UA_Byte userAccessLevel = vn->accessLevel &
+                server->config.accessControl.
+                getUserAccessLevel(server, &server->config.accessControl,
+                                   session ? &session->sessionId : NULL,
+                                   session ? session->sessionHandle : NULL,
+                                   &vn->head.nodeId, vn->head.context);
+            if(!(userAccessLevel & UA_ACCESSLEVELMASK_READ)) {
+                UA_NODESTORE_RELEASE(server, node);
+                return false;
+            }
+            readSession = &server->adminSession;
+        }
+    }
+
+    ReadWithNode(node, server, readSession, ctx->request->timestampsToReturn,
+                 ctx->request->maxAge, NULL, rvi, result);
+    UA_NODESTORE_RELEASE(server, node);
+    return true;
+}
+
 void
 Service_Read(UA_Server *server, UA_Session *session,
              const UA_ReadRequest *request, UA_ReadResponse *response) {
@@ -679,19 +917,48 @@ Service_Read(UA_Server *server, UA_Session *session,
 
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
+    /* Read the DataSource values in batches first */
+    ReadContext ctx;
+    ctx.request = request;
+    ctx.prefetched = NULL;
+    if(server->config.readDataSourceBatch && request->nodesToReadSize > 1) {
+        UA_BatchReadItem *items = (UA_BatchReadItem*)
+            UA_malloc(request->nodesToReadSize * sizeof(UA_BatchReadItem));
+        ctx.prefetched = (UA_DataValue*)
+            UA_Array_new(request->nodesToReadSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if(items && ctx.prefetched) {
+            for(size_t i = 0; i < request->nodesToReadSize; i++) {
+                items[i].rvi = &request->nodesToRead[i];
+                items[i].timestamps = request->timestampsToReturn;
+                items[i].maxAge = request->maxAge;
+            }
+            readDataSourceBatch(server, session, request->nodesToReadSize, items,
+                                ctx.prefetched);
+        }
+        UA_free(items);
+    }
+
     response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session,
-                                           (UA_ServiceOperation)Operation_Read,
-                                           request, &request->nodesToReadSize,
-                                           &UA_TYPES[UA_TYPES_READVALUEID],
-                                           &response->resultsSize,
-                                           &UA_TYPES[UA_TYPES_DATAVALUE]);
+        UA_Server_processServiceOperationsParallel(server, session,
+                                                   (UA_ServiceOperation)Operation_Read,
+                                                   (UA_ParallelServiceOperation)
+                                                   Operation_ReadParallel,
+                                                   &ctx, &request->nodesToReadSize,
+                                                   &UA_TYPES[UA_TYPES_READVALUEID],
+                                                   &response->resultsSize,
+                                                   &UA_TYPES[UA_TYPES_DATAVALUE]);
+
+    /* Clean up values that were not consumed */
+    if(ctx.prefetched)
+        UA_Array_delete(ctx.prefetched, request->nodesToReadSize,
+                        &UA_TYPES[UA_TYPES_DATAVALUE]);
 }
 
 UA_DataValue
 UA_Server_readWithSession(UA_Server *server, UA_Session *session,
                           const UA_ReadValueId *item,
-                          UA_TimestampsToReturn timestampsToReturn) {
+                          UA_TimestampsToReturn timestampsToReturn,
+                          UA_Double maxAge, UA_DataValue *prefetched) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     UA_DataValue dv;
@@ -710,7 +977,8 @@ UA_Server_readWithSession(UA_Server *server, UA_Session *session,
     }
 
     /* Perform the read operation */
-    ReadWithNode(node, server, session, timestampsToReturn, item, &dv);
+    ReadWithNode(node, server, session, timestampsToReturn, maxAge,
+                 prefetched, item, &dv);
 
     /* Release the node and return */
     UA_NODESTORE_RELEASE(server, node);
@@ -721,7 +989,8 @@ UA_DataValue
 readAttribute(UA_Server *server, const UA_ReadValueId *item,
                UA_TimestampsToReturn timestamps) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    return UA_Server_readWithSession(server, &server->adminSession, item, timestamps);
+    return UA_Server_readWithSession(server, &server->adminSession, item,
+                                     timestamps, 0.0, NULL);
 }
 
 UA_StatusCode
@@ -1536,6 +1805,8 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
                               &node->head.nodeId, node->head.context,
                               rangeptr, &adjustedValue);
                     UA_LOCK(&server->serviceMutex);
+                    /* The cached value is outdated */
+                    UA_ValueCache_remove(&server->valueCache, &node->head.nodeId);
                 } else {
                     retval = UA_STATUSCODE_BADWRITENOTSUPPORTED;
                 }
@@ -1650,8 +1921,8 @@ triggerImmediateDataChange(UA_Server *server, UA_Session *session,
             continue;
         UA_DataValue value;
         UA_DataValue_init(&value);
-        ReadWithNode(node, server, session, mon->timestampsToReturn,
-                     &mon->itemToMonitor, &value);
+        ReadWithNode(node, server, session, mon->timestampsToReturn, 0.0,
+                     NULL, &mon->itemToMonitor, &value);
         UA_Subscription *sub = mon->subscription;
         UA_StatusCode res = sampleCallbackWithValue(server, sub, mon, &value);
         if(res != UA_STATUSCODE_GOOD) {
@@ -1699,6 +1970,7 @@ copyAttributeIntoNode(UA_Server *server, UA_Session *session,
         CHECK_DATATYPE_SCALAR(LOCALIZEDTEXT);
         retval = UA_Node_insertOrUpdateDisplayName(&node->head,
                                                    (const UA_LocalizedText *)value);
+        UA_BrowseCache_invalidateNeighbors(&server->browseCache, &node->head);
         break;
     case UA_ATTRIBUTEID_DESCRIPTION:
         CHECK_USERWRITEMASK(UA_WRITEMASK_DESCRIPTION);
@@ -814,176 +814,200 @@ addTypeChildren(UA_Server *server, UA_Session *session,
 
 static const UA_NodeId hasSubtype = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASSUBTYPE}};
 
-UA_StatusCode
-addNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
-                const UA_NodeId *parentNodeId, const UA_NodeId *referenceTypeId,
-                const UA_NodeId *typeDefinitionId) {
-    /* Get the node */
-    const UA_Node *type = NULL;
-    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
-    if(!node)
-        return UA_STATUSCODE_BADNODEIDUNKNOWN;
-
-    /* Use the typeDefinition as parent for type-nodes */
-    const UA_NodeHead *head = &node->head;
+/* Use the typeDefinition as parent for type-nodes. Replace an empty
+ * typeDefinition with the most permissive default. */
+static void
+resolveParentAndType(UA_Server *server, UA_Session *session, const UA_NodeHead *head,
+                     const UA_NodeId *parentNodeId, const UA_NodeId **referenceTypeId,
+                     const UA_NodeId **typeDefinitionId) {
     if(head->nodeClass == UA_NODECLASS_VARIABLETYPE ||
        head->nodeClass == UA_NODECLASS_OBJECTTYPE ||
        head->nodeClass == UA_NODECLASS_REFERENCETYPE ||
        head->nodeClass == UA_NODECLASS_DATATYPE) {
-        if(UA_NodeId_equal(referenceTypeId, &UA_NODEID_NULL))
-            referenceTypeId = &hasSubtype;
+        if(UA_NodeId_equal(*referenceTypeId, &UA_NODEID_NULL))
+            *referenceTypeId = &hasSubtype;
         const UA_Node *parentNode = UA_NODESTORE_GET(server, parentNodeId);
         if(parentNode) {
             if(parentNode->head.nodeClass == head->nodeClass)
-                typeDefinitionId = parentNodeId;
+                *typeDefinitionId = parentNodeId;
             UA_NODESTORE_RELEASE(server, parentNode);
         }
     }
 
-    UA_StatusCode retval;
-    /* Make sure newly created node does not have itself as parent */
-    if(UA_NodeId_equal(nodeId, parentNodeId)) {
-        logAddNode(&server->config.logger, session, nodeId,
-                   "A node cannot have itself as parent");
-        retval = UA_STATUSCODE_BADINVALIDARGUMENT;
-        goto cleanup;
+    if((head->nodeClass == UA_NODECLASS_VARIABLE ||
+        head->nodeClass == UA_NODECLASS_OBJECT) &&
+       UA_NodeId_isNull(*typeDefinitionId)) {
+        logAddNode(&server->config.logger, session, &head->nodeId,
+                   "No TypeDefinition. Use the default "
+                   "TypeDefinition for the Variable/Object");
+        if(head->nodeClass == UA_NODECLASS_VARIABLE)
+            *typeDefinitionId = &baseDataVariableType;
+        else
+            *typeDefinitionId = &baseObjectType;
     }
+}
 
-
+/* Check the parent reference and the type definition. The result only depends
+ * on the NodeClass, the parent, the ReferenceType and the type definition. The
+ * NodeId in the head is used for logging only. */
+static UA_StatusCode
+checkParentAndType(UA_Server *server, UA_Session *session, const UA_NodeHead *head,
+                   const UA_NodeId *parentNodeId, const UA_NodeId *referenceTypeId,
+                   const UA_NodeId *typeDefinitionId) {
     /* Check parent reference. Objects may have no parent. */
-    retval = checkParentReference(server, session, head, parentNodeId, referenceTypeId);
+    UA_StatusCode retval =
+        checkParentReference(server, session, head, parentNodeId, referenceTypeId);
     if(retval != UA_STATUSCODE_GOOD) {
-        logAddNode(&server->config.logger, session, nodeId,
+        logAddNode(&server->config.logger, session, &head->nodeId,
                    "The parent reference for is invalid");
-        goto cleanup;
+        return retval;
     }
 
-    /* Replace empty typeDefinition with the most permissive default */
-    if((head->nodeClass == UA_NODECLASS_VARIABLE ||
-        head->nodeClass == UA_NODECLASS_OBJECT) &&
-       UA_NodeId_isNull(typeDefinitionId)) {
-        logAddNode(&server->config.logger, session, nodeId,
-                   "No TypeDefinition. Use the default "
-                   "TypeDefinition for the Variable/Object");
-        if(head->nodeClass == UA_NODECLASS_VARIABLE)
-            typeDefinitionId = &baseDataVariableType;
-        else
-            typeDefinitionId = &baseObjectType;
+    /* Reference to the parent cannot be null */
+    if(!UA_NodeId_isNull(parentNodeId) && UA_NodeId_isNull(referenceTypeId)) {
+        logAddNode(&server->config.logger, session, &head->nodeId,
+                   "Reference to parent cannot be null");
+        return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
     }
 
     /* Get the node type. There must be a typedefinition for variables, objects
      * and type-nodes. See the above checks. */
-    if(!UA_NodeId_isNull(typeDefinitionId)) {
-        /* Get the type node */
-        type = UA_NODESTORE_GET(server, typeDefinitionId);
-        if(!type) {
-            logAddNode(&server->config.logger, session, nodeId, "Node type not found");
-            retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+    if(UA_NodeId_isNull(typeDefinitionId))
+        return UA_STATUSCODE_GOOD;
+
+    /* Get the type node */
+    const UA_Node *type = UA_NODESTORE_GET(server, typeDefinitionId);
+    if(!type) {
+        logAddNode(&server->config.logger, session, &head->nodeId,
+                   "Node type not found");
+        return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+    }
+
+    UA_Boolean typeOk = false;
+    const UA_NodeHead *typeHead = &type->head;
+    switch(head->nodeClass) {
+        case UA_NODECLASS_DATATYPE:
+            typeOk = typeHead->nodeClass == UA_NODECLASS_DATATYPE;
+            break;
+        case UA_NODECLASS_METHOD:
+            typeOk = typeHead->nodeClass == UA_NODECLASS_METHOD;
+            break;
+        case UA_NODECLASS_OBJECT:
+        case UA_NODECLASS_OBJECTTYPE:
+            typeOk = typeHead->nodeClass == UA_NODECLASS_OBJECTTYPE;
+            break;
+        case UA_NODECLASS_REFERENCETYPE:
+            typeOk = typeHead->nodeClass == UA_NODECLASS_REFERENCETYPE;
+            break;
+        case UA_NODECLASS_VARIABLE:
+        case UA_NODECLASS_VARIABLETYPE:
+            typeOk = typeHead->nodeClass == UA_NODECLASS_VARIABLETYPE;
+            break;
+        case UA_NODECLASS_VIEW:
+            typeOk = typeHead->nodeClass == UA_NODECLASS_VIEW;
+            break;
+        default:
+            typeOk = false;
+    }
+    if(!typeOk) {
+        logAddNode(&server->config.logger, session, &head->nodeId,
+                   "Type does not match the NodeClass");
+        retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+        goto cleanup;
+    }
+
+    /* See if the type has the correct node class. For type-nodes, we know
+     * that type has the same nodeClass from checkParentReference. */
+    if(head->nodeClass == UA_NODECLASS_VARIABLE &&
+       type->variableTypeNode.isAbstract) {
+        /* Get subtypes of the parent reference types */
+        UA_ReferenceTypeSet refTypes1, refTypes2;
+        retval |= referenceTypeIndices(server, &parentReferences[0], &refTypes1, true);
+        retval |= referenceTypeIndices(server, &parentReferences[1], &refTypes2, true);
+        UA_ReferenceTypeSet refTypes = UA_ReferenceTypeSet_union(refTypes1, refTypes2);
+        if(retval != UA_STATUSCODE_GOOD)
             goto cleanup;
-        }
 
-        UA_Boolean typeOk = false;
-        const UA_NodeHead *typeHead = &type->head;
-        switch(head->nodeClass) {
-            case UA_NODECLASS_DATATYPE:
-                typeOk = typeHead->nodeClass == UA_NODECLASS_DATATYPE;
-                break;
-            case UA_NODECLASS_METHOD:
-                typeOk = typeHead->nodeClass == UA_NODECLASS_METHOD;
-                break;
-            case UA_NODECLASS_OBJECT:
-            case UA_NODECLASS_OBJECTTYPE:
-                typeOk = typeHead->nodeClass == UA_NODECLASS_OBJECTTYPE;
-                break;
-            case UA_NODECLASS_REFERENCETYPE:
-                typeOk = typeHead->nodeClass == UA_NODECLASS_REFERENCETYPE;
-                break;
-            case UA_NODECLASS_VARIABLE:
-            case UA_NODECLASS_VARIABLETYPE:
-                typeOk = typeHead->nodeClass == UA_NODECLASS_VARIABLETYPE;
-                break;
-            case UA_NODECLASS_VIEW:
-                typeOk = typeHead->nodeClass == UA_NODECLASS_VIEW;
-                break;
-            default:
-                typeOk = false;
-        }
-        if(!typeOk) {
-            logAddNode(&server->config.logger, session, nodeId,
-                       "Type does not match the NodeClass");
+        /* Abstract variable is allowed if parent is a children of a
+         * base data variable. An abstract variable may be part of an
+         * object type which again is below BaseObjectType */
+        const UA_NodeId variableTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE);
+        const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+        if(!isNodeInTree(server, parentNodeId, &variableTypes, &refTypes) &&
+           !isNodeInTree(server, parentNodeId, &objectTypes, &refTypes)) {
+            logAddNode(&server->config.logger, session, &head->nodeId,
+                       "Type of variable node must be a "
+                       "VariableType and not cannot be abstract");
             retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
             goto cleanup;
         }
+    }
 
-        /* See if the type has the correct node class. For type-nodes, we know
-         * that type has the same nodeClass from checkParentReference. */
-        if(head->nodeClass == UA_NODECLASS_VARIABLE &&
-           type->variableTypeNode.isAbstract) {
-            /* Get subtypes of the parent reference types */
-            UA_ReferenceTypeSet refTypes1, refTypes2;
-            retval |= referenceTypeIndices(server, &parentReferences[0], &refTypes1, true);
-            retval |= referenceTypeIndices(server, &parentReferences[1], &refTypes2, true);
-            UA_ReferenceTypeSet refTypes = UA_ReferenceTypeSet_union(refTypes1, refTypes2);
-            if(retval != UA_STATUSCODE_GOOD)
-                goto cleanup;
+    if(head->nodeClass == UA_NODECLASS_OBJECT &&
+       type->objectTypeNode.isAbstract) {
+        /* Get subtypes of the parent reference types */
+        UA_ReferenceTypeSet refTypes1, refTypes2;
+        retval |= referenceTypeIndices(server, &parentReferences[0], &refTypes1, true);
+        retval |= referenceTypeIndices(server, &parentReferences[1], &refTypes2, true);
+        UA_ReferenceTypeSet refTypes = UA_ReferenceTypeSet_union(refTypes1, refTypes2);
+        if(retval != UA_STATUSCODE_GOOD)
+            goto cleanup;
 
-            /* Abstract variable is allowed if parent is a children of a
-             * base data variable. An abstract variable may be part of an
-             * object type which again is below BaseObjectType */
-            const UA_NodeId variableTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE);
-            const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
-            if(!isNodeInTree(server, parentNodeId, &variableTypes, &refTypes) &&
-               !isNodeInTree(server, parentNodeId, &objectTypes, &refTypes)) {
-                logAddNode(&server->config.logger, session, nodeId,
-                           "Type of variable node must be a "
-                           "VariableType and not cannot be abstract");
-                retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-                goto cleanup;
-            }
-        }
 
-        if(head->nodeClass == UA_NODECLASS_OBJECT &&
-           type->objectTypeNode.isAbstract) {
-            /* Get subtypes of the parent reference types */
-            UA_ReferenceTypeSet refTypes1, refTypes2;
-            retval |= referenceTypeIndices(server, &parentReferences[0], &refTypes1, true);
-            retval |= referenceTypeIndices(server, &parentReferences[1], &refTypes2, true);
-            UA_ReferenceTypeSet refTypes = UA_ReferenceTypeSet_union(refTypes1, refTypes2);
-            if(retval != UA_STATUSCODE_GOOD)
-                goto cleanup;
+        /* Object node created of an abstract ObjectType. Only allowed if
+         * within BaseObjectType folder or if it's an event (subType of
+         * BaseEventType) */
+        const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+        UA_Boolean isInBaseObjectType =
+            isNodeInTree(server, parentNodeId, &objectTypes, &refTypes);
 
+        const UA_NodeId eventTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+        UA_Boolean isInBaseEventType =
+            isNodeInTree_singleRef(server, &type->head.nodeId, &eventTypes,
+                                   UA_REFERENCETYPEINDEX_HASSUBTYPE);
 
-            /* Object node created of an abstract ObjectType. Only allowed if
-             * within BaseObjectType folder or if it's an event (subType of
-             * BaseEventType) */
-            const UA_NodeId objectTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
-            UA_Boolean isInBaseObjectType =
-                isNodeInTree(server, parentNodeId, &objectTypes, &refTypes);
+        if(!isInBaseObjectType &&
+           !(isInBaseEventType && UA_NodeId_isNull(parentNodeId))) {
+            logAddNode(&server->config.logger, session, &head->nodeId,
+                       "Type of ObjectNode must be ObjectType and not be abstract");
+            retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+            goto cleanup;
+        }
+    }
 
-            const UA_NodeId eventTypes = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
-            UA_Boolean isInBaseEventType =
-                isNodeInTree_singleRef(server, &type->head.nodeId, &eventTypes,
-                                       UA_REFERENCETYPEINDEX_HASSUBTYPE);
+ cleanup:
+    UA_NODESTORE_RELEASE(server, type);
+    return retval;
+}
 
-            if(!isInBaseObjectType &&
-               !(isInBaseEventType && UA_NodeId_isNull(parentNodeId))) {
-                logAddNode(&server->config.logger, session, nodeId,
-                           "Type of ObjectNode must be ObjectType and not be abstract");
-                retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-                goto cleanup;
-            }
-        }
+UA_StatusCode
+addNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
+                const UA_NodeId *parentNodeId, const UA_NodeId *referenceTypeId,
+                const UA_NodeId *typeDefinitionId) {
+    /* Get the node */
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    const UA_NodeHead *head = &node->head;
+
+    UA_StatusCode retval;
+    /* Make sure newly created node does not have itself as parent */
+    if(UA_NodeId_equal(nodeId, parentNodeId)) {
+        logAddNode(&server->config.logger, session, nodeId,
+                   "A node cannot have itself as parent");
+        retval = UA_STATUSCODE_BADINVALIDARGUMENT;
+        goto cleanup;
     }
 
+    resolveParentAndType(server, session, head, parentNodeId,
+                         &referenceTypeId, &typeDefinitionId);
+    retval = checkParentAndType(server, session, head, parentNodeId,
+                                referenceTypeId, typeDefinitionId);
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
     /* Add reference to the parent */
     if(!UA_NodeId_isNull(parentNodeId)) {
-        if(UA_NodeId_isNull(referenceTypeId)) {
-            logAddNode(&server->config.logger, session, nodeId,
-                       "Reference to parent cannot be null");
-            retval = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
-            goto cleanup;
-        }
-
         retval = addRefWithSession(server, session, &head->nodeId, referenceTypeId,
                                    parentNodeId, false);
         if(retval != UA_STATUSCODE_GOOD) {
@@ -996,9 +1020,9 @@ addNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
     /* Add a hasTypeDefinition reference */
     if(head->nodeClass == UA_NODECLASS_VARIABLE ||
        head->nodeClass == UA_NODECLASS_OBJECT) {
-        UA_assert(type != NULL); /* see above */
+        UA_assert(!UA_NodeId_isNull(typeDefinitionId)); /* see above */
         retval = addRefWithSession(server, session, &head->nodeId, &hasTypeDefinition,
-                                   &type->head.nodeId, true);
+                                   typeDefinitionId, true);
         if(retval != UA_STATUSCODE_GOOD) {
             logAddNode(&server->config.logger, session, nodeId,
                        "Adding a reference to the type definition failed");
@@ -1007,8 +1031,6 @@ addNode_addRefs(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
 
  cleanup:
     UA_NODESTORE_RELEASE(server, node);
-    if(type)
-        UA_NODESTORE_RELEASE(server, type);
     return retval;
 }
 
@@ -1061,7 +1083,9 @@ addNode_raw(UA_Server *server, UA_Session *session, void *nodeContext,
     if(retval != UA_STATUSCODE_GOOD)
         goto create_error;
 
-    retval = UA_QualifiedName_copy(&item->browseName, &node->head.browseName);
+    node->head.browseName.namespaceIndex = item->browseName.namespaceIndex;
+    retval = UA_InternTable_addString(&item->browseName.name,
+                                      &node->head.browseName.name);
     if(retval != UA_STATUSCODE_GOOD)
         goto create_error;
 
@@ -1324,6 +1348,10 @@ recursiveCallConstructors(UA_Server *server, UA_Session *session,
 static UA_StatusCode
 addReferenceTypeSubtype(UA_Server *server, UA_Session *session,
                         UA_Node *node, void *context) {
+    /* The supertype of a ReferenceType from a bulk insertion is not validated
+     * yet. See setBulkReferenceTypeSubtypes. */
+    if(node->head.nodeClass != UA_NODECLASS_REFERENCETYPE)
+        return UA_STATUSCODE_BADNODECLASSINVALID;
     node->referenceTypeNode.subTypes =
         UA_ReferenceTypeSet_union(node->referenceTypeNode.subTypes,
                                   *(UA_ReferenceTypeSet*)context);
@@ -1919,6 +1947,9 @@ deleteNodeSet(UA_Server *server, UA_Session *session,
         UA_NODESTORE_RELEASE(server, member);
         if(removeTargetRefs)
             removeIncomingReferences(server, session, &member->head);
+        UA_ValueCache_remove(&server->valueCache, &member->head.nodeId);
+        UA_BrowseCache_invalidateNeighbors(&server->browseCache, &member->head);
+        UA_BrowsePathCache_invalidate(&server->browsePathCache, &member->head.nodeId);
         UA_NODESTORE_REMOVE(server, &member->head.nodeId);
     }
 }
@@ -2053,9 +2084,23 @@ struct AddNodeInfo {
     UA_UInt32 targetBrowseNameHash;
 };
 
+/* Remove the cached Browse results and BrowsePath resolutions that depend on
+ * the references of the node. A changed TypeDefinition also shows up in the
+ * Browse results of the neighbors. */
+static void
+invalidateReferenceCaches(UA_Server *server, UA_Node *node,
+                          UA_Byte refTypeIndex, UA_Boolean isForward) {
+    if(refTypeIndex == UA_REFERENCETYPEINDEX_HASTYPEDEFINITION && isForward)
+        UA_BrowseCache_invalidateNeighbors(&server->browseCache, &node->head);
+    else
+        UA_BrowseCache_invalidate(&server->browseCache, &node->head.nodeId);
+    UA_BrowsePathCache_invalidate(&server->browsePathCache, &node->head.nodeId);
+}
+
 static UA_StatusCode
 addOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
                    const struct AddNodeInfo *info) {
+    invalidateReferenceCaches(server, node, info->refTypeIndex, info->isForward);
     return UA_Node_addReference(node, info->refTypeIndex, info->isForward,
                                 info->targetNodeId, info->targetBrowseNameHash);
 }
@@ -2072,6 +2117,7 @@ deleteOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
     }
     UA_Byte refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
     UA_NODESTORE_RELEASE(server, refType);
+    invalidateReferenceCaches(server, node, refTypeIndex, item->isForward);
     return UA_Node_deleteReference(node, refTypeIndex, item->isForward, &item->targetNodeId);
 }
 
@@ -2341,6 +2387,501 @@ UA_Server_deleteReference(UA_Server *server, const UA_NodeId sourceNodeId,
     return res;
 }
 
+/**********************/
+/* Compact References */
+/**********************/
+
+/* Smaller ReferenceKinds remain in the array representation */
+#define UA_COMPACT_REFERENCES_MINSIZE 8
+
+static UA_Boolean
+hasCompactableReferences(const UA_NodeHead *head) {
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &head->references[i];
+        if(!rk->isCompact && rk->targetsSize > UA_COMPACT_REFERENCES_MINSIZE)
+            return true;
+    }
+    return false;
+}
+
+typedef struct {
+    UA_NodeId *nodeIds;
+    size_t nodeIdsSize;
+    size_t nodeIdsCapacity;
+    UA_StatusCode res;
+} CompactContext;
+
+/* Collect the nodes first. The nodestore cannot be modified during the
+ * iteration. */
+static void
+collectCompactableNode(void *context, const UA_Node *node) {
+    CompactContext *cc = (CompactContext*)context;
+    if(cc->res != UA_STATUSCODE_GOOD || !hasCompactableReferences(&node->head))
+        return;
+    if(cc->nodeIdsSize == cc->nodeIdsCapacity) {
+        size_t newCapacity = (cc->nodeIdsCapacity == 0) ? 64 : cc->nodeIdsCapacity * 2;
+        UA_NodeId *newIds = (UA_NodeId*)
+            UA_realloc(cc->nodeIds, sizeof(UA_NodeId) * newCapacity);
+        if(!newIds) {
+            cc->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        cc->nodeIds = newIds;
+        cc->nodeIdsCapacity = newCapacity;
+    }
+    cc->res = UA_NodeId_copy(&node->head.nodeId, &cc->nodeIds[cc->nodeIdsSize]);
+    if(cc->res == UA_STATUSCODE_GOOD)
+        cc->nodeIdsSize++;
+}
+
+static UA_StatusCode
+compactNodeReferences(UA_Server *server, UA_Session *session,
+                      UA_Node *node, void *context) {
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(rk->isCompact || rk->targetsSize <= UA_COMPACT_REFERENCES_MINSIZE)
+            continue;
+        UA_StatusCode res = UA_NodeReferenceKind_compact(rk);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_compactReferences(UA_Server *server) {
+    UA_LOCK(&server->serviceMutex);
+    CompactContext cc;
+    memset(&cc, 0, sizeof(CompactContext));
+    server->config.nodestore.iterate(server->config.nodestore.context,
+                                     collectCompactableNode, &cc);
+    UA_StatusCode res = cc.res;
+    for(size_t i = 0; i < cc.nodeIdsSize && res == UA_STATUSCODE_GOOD; i++)
+        res = UA_Server_editNode(server, &server->adminSession, &cc.nodeIds[i],
+                                 compactNodeReferences, NULL);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_Array_delete(cc.nodeIds, cc.nodeIdsSize, &UA_TYPES[UA_TYPES_NODEID]);
+    return res;
+}
+
+/******************/
+/* Bulk Add Nodes */
+/******************/
+
+/* A node of the batch that was inserted into the nodestore */
+typedef struct {
+    size_t index; /* Position in the batch */
+    UA_NodeClass nodeClass;
+    UA_UInt32 nameHash;
+    const UA_NodeId *nodeId; /* Points into the results */
+    const UA_NodeId *parentNodeId;
+    const UA_NodeId *referenceTypeId;
+    const UA_NodeId *typeDefinitionId;
+    UA_StatusCode res;
+} BulkNode;
+
+/* The validation only depends on these fields. Sorting by the parent first
+ * also groups the references that are added to the same parent node. */
+static int
+cmpBulkValidation(const void *p1, const void *p2) {
+    const BulkNode *a = *(const BulkNode * const *)p1;
+    const BulkNode *b = *(const BulkNode * const *)p2;
+    UA_Order o = UA_NodeId_order(a->parentNodeId, b->parentNodeId);
+    if(o == UA_ORDER_EQ)
+        o = UA_NodeId_order(a->referenceTypeId, b->referenceTypeId);
+    if(o == UA_ORDER_EQ)
+        o = UA_NodeId_order(a->typeDefinitionId, b->typeDefinitionId);
+    if(o == UA_ORDER_EQ && a->nodeClass != b->nodeClass)
+        o = (a->nodeClass < b->nodeClass) ? UA_ORDER_LESS : UA_ORDER_MORE;
+    return (int)o;
+}
+
+static int
+cmpBulkType(const void *p1, const void *p2) {
+    const BulkNode *a = *(const BulkNode * const *)p1;
+    const BulkNode *b = *(const BulkNode * const *)p2;
+    return (int)UA_NodeId_order(a->typeDefinitionId, b->typeDefinitionId);
+}
+
+static int
+cmpBulkNodeId(const void *p1, const void *p2) {
+    const BulkNode *a = *(const BulkNode * const *)p1;
+    const BulkNode *b = *(const BulkNode * const *)p2;
+    return (int)UA_NodeId_order(a->nodeId, b->nodeId);
+}
+
+static BulkNode *
+findBulkNode(BulkNode **byId, size_t size, const UA_NodeId *nodeId) {
+    BulkNode key;
+    key.nodeId = nodeId;
+    BulkNode *keyp = &key;
+    BulkNode **found = (BulkNode**)
+        bsearch(&keyp, byId, size, sizeof(BulkNode*), cmpBulkNodeId);
+    return (found) ? *found : NULL;
+}
+
+/* References from one node to a group of nodes of the batch */
+typedef struct {
+    UA_Byte refTypeIndex;
+    UA_Boolean isForward;
+    BulkNode **nodes;
+    size_t nodesSize;
+} BulkReferences;
+
+/* The failure to add a reference is stored for the target node. The node
+ * itself keeps the references that were added. */
+static UA_StatusCode
+addBulkReferences(UA_Server *server, UA_Session *session, UA_Node *node,
+                  const BulkReferences *br) {
+    invalidateReferenceCaches(server, node, br->refTypeIndex, br->isForward);
+    for(size_t i = 0; i < br->nodesSize; i++) {
+        BulkNode *bn = br->nodes[i];
+        if(bn->res != UA_STATUSCODE_GOOD)
+            continue;
+        UA_ExpandedNodeId target;
+        UA_ExpandedNodeId_init(&target);
+        target.nodeId = *bn->nodeId;
+        UA_StatusCode res = UA_Node_addReference(node, br->refTypeIndex, br->isForward,
+                                                 &target, bn->nameHash);
+        if(res != UA_STATUSCODE_GOOD &&
+           res != UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED)
+            bn->res = res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Add the references between a source node and a group of nodes from the
+ * batch. The source node is edited once for the entire group. */
+static void
+addBulkReferenceGroup(UA_Server *server, UA_Session *session,
+                      const UA_NodeId *sourceId, const UA_NodeId *refTypeId,
+                      UA_Boolean isForward, BulkNode **nodes, size_t nodesSize) {
+    const UA_Node *refType = UA_NODESTORE_GET(server, refTypeId);
+    const UA_Node *source = UA_NODESTORE_GET(server, sourceId);
+    if(!refType || refType->head.nodeClass != UA_NODECLASS_REFERENCETYPE || !source) {
+        /* Leave the nodes untouched. The validation reports the error. */
+        if(refType)
+            UA_NODESTORE_RELEASE(server, refType);
+        if(source)
+            UA_NODESTORE_RELEASE(server, source);
+        return;
+    }
+
+    BulkReferences br;
+    br.refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
+    br.isForward = isForward;
+    br.nodes = nodes;
+    br.nodesSize = nodesSize;
+    UA_UInt32 sourceNameHash = UA_QualifiedName_hash(&source->head.browseName);
+    UA_NODESTORE_RELEASE(server, refType);
+    UA_NODESTORE_RELEASE(server, source);
+
+    /* Add the references in the source node */
+    UA_StatusCode res = UA_Server_editNode(server, session, sourceId,
+                             (UA_EditNodeCallback)addBulkReferences, &br);
+    if(res != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < nodesSize; i++)
+            nodes[i]->res = res;
+        return;
+    }
+
+    /* Add the inverse reference in the nodes of the group */
+    UA_ExpandedNodeId target;
+    UA_ExpandedNodeId_init(&target);
+    target.nodeId = *sourceId;
+    struct AddNodeInfo info;
+    info.refTypeIndex = br.refTypeIndex;
+    info.isForward = !isForward;
+    info.targetNodeId = &target;
+    info.targetBrowseNameHash = sourceNameHash;
+    for(size_t i = 0; i < nodesSize; i++) {
+        if(nodes[i]->res != UA_STATUSCODE_GOOD)
+            continue;
+        res = UA_Server_editNode(server, session, nodes[i]->nodeId,
+                                 (UA_EditNodeCallback)addOneWayReference, &info);
+        if(res != UA_STATUSCODE_GOOD &&
+           res != UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED)
+            nodes[i]->res = res;
+    }
+}
+
+/* Calls the callback for every group of consecutive nodes that are equal
+ * according to the comparison. Nodes that failed before are left out. */
+typedef void
+(*BulkGroupCallback)(UA_Server *server, UA_Session *session,
+                     BulkNode **nodes, size_t nodesSize);
+
+static void
+forEachBulkGroup(UA_Server *server, UA_Session *session, BulkNode **order,
+                 size_t orderSize, int (*cmp)(const void*, const void*),
+                 BulkGroupCallback callback) {
+    size_t begin = 0;
+    while(begin < orderSize) {
+        /* Find the end of the group */
+        size_t end = begin + 1;
+        while(end < orderSize && cmp(&order[begin], &order[end]) == 0)
+            end++;
+
+        /* Compact the nodes that did not fail. Reordering within the group
+         * does not change the sort order. */
+        size_t good = begin;
+        for(size_t i = begin; i < end; i++) {
+            if(order[i]->res != UA_STATUSCODE_GOOD)
+                continue;
+            BulkNode *tmp = order[good];
+            order[good++] = order[i];
+            order[i] = tmp;
+        }
+        if(good > begin)
+            callback(server, session, &order[begin], good - begin);
+        begin = end;
+    }
+}
+
+/* The validation result is the same for the entire group */
+static void
+validateBulkGroup(UA_Server *server, UA_Session *session,
+                  BulkNode **nodes, size_t nodesSize) {
+    UA_NodeHead head;
+    memset(&head, 0, sizeof(UA_NodeHead));
+    head.nodeClass = nodes[0]->nodeClass;
+    head.nodeId = *nodes[0]->nodeId;
+    UA_StatusCode res =
+        checkParentAndType(server, session, &head, nodes[0]->parentNodeId,
+                           nodes[0]->referenceTypeId, nodes[0]->typeDefinitionId);
+    for(size_t i = 0; i < nodesSize; i++)
+        nodes[i]->res = res;
+}
+
+static void
+addBulkParentReferences(UA_Server *server, UA_Session *session,
+                        BulkNode **nodes, size_t nodesSize) {
+    if(UA_NodeId_isNull(nodes[0]->parentNodeId))
+        return;
+    addBulkReferenceGroup(server, session, nodes[0]->parentNodeId,
+                          nodes[0]->referenceTypeId, true, nodes, nodesSize);
+}
+
+static void
+addBulkTypeReferences(UA_Server *server, UA_Session *session,
+                      BulkNode **nodes, size_t nodesSize) {
+    /* Only a subset of the group can be instances */
+    size_t instances = 0;
+    for(size_t i = 0; i < nodesSize; i++) {
+        if(nodes[i]->nodeClass != UA_NODECLASS_VARIABLE &&
+           nodes[i]->nodeClass != UA_NODECLASS_OBJECT)
+            continue;
+        BulkNode *tmp = nodes[instances];
+        nodes[instances++] = nodes[i];
+        nodes[i] = tmp;
+    }
+    if(instances == 0)
+        return;
+    addBulkReferenceGroup(server, session, nodes[0]->typeDefinitionId,
+                          &hasTypeDefinition, false, nodes, instances);
+}
+
+/* The ReferenceTypes of the batch are added to the subtypes of their
+ * supertypes before the validation. Then the checks that use the subtypes of
+ * a ReferenceType also see the ReferenceTypes from the batch. A failed
+ * ReferenceType leaves its index in the supertypes. The index is not reused
+ * by the nodestore. */
+static void
+setBulkReferenceTypeSubtypes(UA_Server *server, BulkNode *bn) {
+    const UA_Node *node = UA_NODESTORE_GET(server, bn->nodeId);
+    if(!node)
+        return;
+    UA_StatusCode res = setReferenceTypeSubtypes(server, &node->referenceTypeNode);
+    if(res != UA_STATUSCODE_GOOD)
+        bn->res = res;
+    UA_NODESTORE_RELEASE(server, node);
+}
+
+/* Remove a node of the batch that has failed. The references from other nodes
+ * to it are removed as well. The node was not constructed yet. So no
+ * destructor is called. */
+static void
+removeBulkNode(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId) {
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node)
+        return;
+    removeIncomingReferences(server, session, &node->head);
+    UA_BrowseCache_invalidateNeighbors(&server->browseCache, &node->head);
+    UA_NODESTORE_RELEASE(server, node);
+    UA_NODESTORE_REMOVE(server, nodeId);
+}
+
+/* Insert a node without references */
+static UA_StatusCode
+insertBulkNode(UA_Server *server, UA_Session *session, void *nodeContext,
+               const UA_AddNodesItem *item, BulkNode *bn, UA_NodeId *outNewNodeId) {
+    UA_Boolean noBrowseName = UA_QualifiedName_isNull(&item->browseName);
+    UA_StatusCode retval =
+        checkSetBrowseName(server, session, (UA_AddNodesItem*)(uintptr_t)item);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    retval = addNode_raw(server, session, nodeContext, item, outNewNodeId);
+    bn->nameHash = UA_QualifiedName_hash(&item->browseName);
+    if(noBrowseName)
+        UA_QualifiedName_clear((UA_QualifiedName*)(uintptr_t)&item->browseName);
+    return retval;
+}
+
+static UA_StatusCode
+addNodesBulk(UA_Server *server, UA_Session *session, size_t itemsSize,
+             const UA_AddNodesItem *items, void **nodeContexts,
+             UA_AddNodesResult *results) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    for(size_t i = 0; i < itemsSize; i++)
+        UA_AddNodesResult_init(&results[i]);
+    if(itemsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Allocate everything upfront. So no node has to be rolled back when the
+     * allocation fails. */
+    BulkNode *bulk = (BulkNode*)UA_calloc(itemsSize, sizeof(BulkNode));
+    BulkNode **order = (BulkNode**)UA_calloc(itemsSize, sizeof(BulkNode*));
+    BulkNode **byId = (BulkNode**)UA_calloc(itemsSize, sizeof(BulkNode*));
+    if(!bulk || !order || !byId) {
+        UA_free(bulk);
+        UA_free(order);
+        UA_free(byId);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* 1. Insert all nodes into the nodestore. Then the parents and type
+     * definitions can be found regardless of the order in the batch. */
+    size_t bulkSize = 0;
+    for(size_t i = 0; i < itemsSize; i++) {
+        const UA_AddNodesItem *item = &items[i];
+        BulkNode *bn = &bulk[bulkSize];
+        void *nodeContext = (nodeContexts) ? nodeContexts[i] : NULL;
+        results[i].statusCode =
+            insertBulkNode(server, session, nodeContext, item, bn,
+                           &results[i].addedNodeId);
+        if(results[i].statusCode != UA_STATUSCODE_GOOD)
+            continue;
+        bn->index = i;
+        bn->nodeClass = item->nodeClass;
+        bn->nodeId = &results[i].addedNodeId;
+        bn->parentNodeId = &item->parentNodeId.nodeId;
+        bn->referenceTypeId = &item->referenceTypeId;
+        bn->typeDefinitionId = &item->typeDefinition.nodeId;
+        order[bulkSize] = bn;
+        byId[bulkSize] = bn;
+        bulkSize++;
+    }
+
+    /* 2. Resolve the parent reference and the type definition */
+    for(size_t i = 0; i < bulkSize; i++) {
+        BulkNode *bn = &bulk[i];
+        UA_NodeHead head;
+        memset(&head, 0, sizeof(UA_NodeHead));
+        head.nodeClass = bn->nodeClass;
+        head.nodeId = *bn->nodeId;
+        resolveParentAndType(server, session, &head, bn->parentNodeId,
+                             &bn->referenceTypeId, &bn->typeDefinitionId);
+        if(UA_NodeId_equal(bn->nodeId, bn->parentNodeId)) {
+            logAddNode(&server->config.logger, session, bn->nodeId,
+                       "A node cannot have itself as parent");
+            bn->res = UA_STATUSCODE_BADINVALIDARGUMENT;
+        }
+    }
+
+    /* 3. Add the references to the parents, grouped by the parent node. Then
+     * add the references to the type definitions. The validation needs the
+     * hierarchy of the entire batch. For example when a ReferenceType from the
+     * batch is used as the parent reference. */
+    qsort(order, bulkSize, sizeof(BulkNode*), cmpBulkValidation);
+    forEachBulkGroup(server, session, order, bulkSize,
+                     cmpBulkValidation, addBulkParentReferences);
+    qsort(order, bulkSize, sizeof(BulkNode*), cmpBulkType);
+    forEachBulkGroup(server, session, order, bulkSize,
+                     cmpBulkType, addBulkTypeReferences);
+    for(size_t i = 0; i < bulkSize; i++) {
+        if(bulk[i].res == UA_STATUSCODE_GOOD &&
+           bulk[i].nodeClass == UA_NODECLASS_REFERENCETYPE)
+            setBulkReferenceTypeSubtypes(server, &bulk[i]);
+    }
+
+    /* 4. Validate the parent reference and the type definition. Nodes with the
+     * same parent, ReferenceType, type definition and NodeClass are validated
+     * only once. */
+    qsort(order, bulkSize, sizeof(BulkNode*), cmpBulkValidation);
+    forEachBulkGroup(server, session, order, bulkSize,
+                     cmpBulkValidation, validateBulkGroup);
+
+    /* Nodes fail if their parent, ReferenceType or type definition from the
+     * batch failed. Repeat until the failures have propagated through the
+     * hierarchy. */
+    qsort(byId, bulkSize, sizeof(BulkNode*), cmpBulkNodeId);
+    UA_Boolean changed;
+    do {
+        changed = false;
+        for(size_t i = 0; i < bulkSize; i++) {
+            BulkNode *bn = &bulk[i];
+            if(bn->res != UA_STATUSCODE_GOOD)
+                continue;
+            BulkNode *parent = findBulkNode(byId, bulkSize, bn->parentNodeId);
+            if(parent && parent->res != UA_STATUSCODE_GOOD) {
+                bn->res = UA_STATUSCODE_BADPARENTNODEIDINVALID;
+                changed = true;
+                continue;
+            }
+            BulkNode *refType = findBulkNode(byId, bulkSize, bn->referenceTypeId);
+            if(refType && refType->res != UA_STATUSCODE_GOOD) {
+                bn->res = UA_STATUSCODE_BADREFERENCETYPEIDINVALID;
+                changed = true;
+                continue;
+            }
+            BulkNode *type = findBulkNode(byId, bulkSize, bn->typeDefinitionId);
+            if(type && type->res != UA_STATUSCODE_GOOD) {
+                bn->res = UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+                changed = true;
+            }
+        }
+    } while(changed);
+
+    /* Remove the failed nodes together with the references to them */
+    for(size_t i = 0; i < bulkSize; i++) {
+        if(bulk[i].res == UA_STATUSCODE_GOOD)
+            continue;
+        removeBulkNode(server, session, bulk[i].nodeId);
+        results[bulk[i].index].statusCode = bulk[i].res;
+    }
+
+    /* 5. Finish the nodes in the order of the batch. Adds the children from the
+     * type definition and calls the constructors. */
+    for(size_t i = 0; i < itemsSize; i++) {
+        if(results[i].statusCode != UA_STATUSCODE_GOOD)
+            continue;
+        results[i].statusCode = addNode_finish(server, session, &results[i].addedNodeId);
+    }
+
+    /* The NodeId is only returned for added nodes */
+    for(size_t i = 0; i < itemsSize; i++) {
+        if(results[i].statusCode != UA_STATUSCODE_GOOD)
+            UA_NodeId_clear(&results[i].addedNodeId);
+    }
+
+    UA_free(bulk);
+    UA_free(order);
+    UA_free(byId);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_addNodes(UA_Server *server, size_t itemsSize,
+                   const UA_AddNodesItem *items, void **nodeContexts,
+                   UA_AddNodesResult *results) {
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode res = addNodesBulk(server, &server->adminSession, itemsSize,
+                                     items, nodeContexts, results);
+    UA_UNLOCK(&server->serviceMutex);
+    return res;
+}
+
 /**********************/
 /* Set Value Callback */
 /**********************/
@@ -2446,6 +2987,7 @@ setDataSource(UA_Server *server, UA_Session *session,
         UA_DataValue_clear(&node->value.data.value);
     node->value.dataSource = *dataSource;
     node->valueSource = UA_VALUESOURCE_DATASOURCE;
+    UA_ValueCache_remove(&server->valueCache, &node->head.nodeId);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -529,6 +529,8 @@ struct BrowseContext {
                                      * lookups */
     UA_Boolean activeCP; /* true during "forwarding" to the position of the last
                           * reference target */
+    UA_Boolean parallel; /* Running in a worker thread. The server remains
+                          * locked by the calling thread. */
 
     /* Results */
     RefResult rr;
@@ -698,6 +700,20 @@ browseWithNode(struct BrowseContext *bc, const UA_NodeHead *head ) {
                           (UA_ReferenceIdTree*)&rk->targets.tree.idRoot,
                           &key, &left, &right);
                 rk->targets.tree.idRoot = right.root;
+            } else if(rk->isCompact) {
+                /* Binary search for the position in the sorted array */
+                UA_ExpandedNodeId lastEn =
+                    UA_NodePointer_toExpandedNodeId(cp->lastTarget);
+                const UA_ReferenceTarget *t =
+                    UA_NodeReferenceKind_findTarget(rk, &lastEn);
+                if(!t) {
+                    /* Not found - assume that this reference kind is done */
+                    bc->activeCP = false;
+                    continue;
+                }
+                nextTargetIndex = (size_t)(t - rk->targets.array) + 1;
+                rk->targets.array = &rk->targets.array[nextTargetIndex];
+                rk->targetsSize -= nextTargetIndex;
             } else {
                 /* Iterate over the array to find the match */
                 for(; nextTargetIndex < rk->targetsSize; nextTargetIndex++) {
@@ -756,6 +772,61 @@ browseWithNode(struct BrowseContext *bc, const UA_NodeHead *head ) {
     bc->done = true;
 }
 
+/* The browse cache is not used for continuation points and not from the
+ * worker threads of parallel operations */
+static UA_Boolean
+browseCacheKey(struct BrowseContext *bc, UA_BrowseCacheKey *key) {
+    if(bc->server->config.maxBrowseCacheSize == 0 || bc->activeCP || bc->parallel)
+        return false;
+    const UA_BrowseDescription *descr = &bc->cp->browseDescription;
+    key->nodeId = descr->nodeId;
+    key->browseDirection = descr->browseDirection;
+    key->references = bc->cp->relevantReferences;
+    key->nodeClassMask = descr->nodeClassMask;
+    key->resultMask = descr->resultMask;
+    key->localeIdsSize = 0;
+    key->localeIds = NULL;
+    if(descr->resultMask & UA_BROWSERESULTMASK_DISPLAYNAME) {
+        key->localeIdsSize = bc->session->localeIdsSize;
+        key->localeIds = bc->session->localeIds;
+    }
+    return true;
+}
+
+static UA_Boolean
+browseCached(struct BrowseContext *bc) {
+    UA_BrowseCacheKey key;
+    if(!browseCacheKey(bc, &key))
+        return false;
+    UA_ReferenceDescription *refs = NULL;
+    size_t refsSize = 0;
+    UA_StatusCode res =
+        UA_BrowseCache_get(&bc->server->browseCache, &key, bc->cp->maxReferences,
+                           &refs, &refsSize);
+    if(res != UA_STATUSCODE_GOOD)
+        return false;
+
+    /* Replace the (empty) result with the cached references */
+    if(refsSize > 0) {
+        RefResult_clear(&bc->rr);
+        bc->rr.descr = refs;
+        bc->rr.size = refsSize;
+        bc->rr.capacity = refsSize;
+    }
+    bc->done = true;
+    return true;
+}
+
+/* Only complete results are cached */
+static void
+cacheBrowseResult(struct BrowseContext *bc) {
+    UA_BrowseCacheKey key;
+    if(!bc->done || bc->status != UA_STATUSCODE_GOOD || !browseCacheKey(bc, &key))
+        return;
+    UA_BrowseCache_put(&bc->server->browseCache, bc->server->config.maxBrowseCacheSize,
+                       &key, bc->rr.descr, bc->rr.size);
+}
+
 /* Results for a single browsedescription. This is the inner loop for both
  * Browse and BrowseNext. The ContinuationPoint contains all the data used.
  * Including the BrowseDescription. Returns whether there are remaining
@@ -785,21 +856,28 @@ browse(struct BrowseContext *bc) {
     /* Check AccessControl rights */
     if(bc->session != &bc->server->adminSession) {
         UA_LOCK_ASSERT(&bc->server->serviceMutex, 1);
-        UA_UNLOCK(&bc->server->serviceMutex);
-        if(!bc->server->config.accessControl.
-           allowBrowseNode(bc->server, &bc->server->config.accessControl,
-                           &bc->session->sessionId, bc->session->sessionHandle,
-                           &descr->nodeId, node->head.context)) {
+        if(!bc->parallel) {
+            UA_UNLOCK(&bc->server->serviceMutex);
+        }
+        UA_Boolean allowed = bc->server->config.accessControl.
+            allowBrowseNode(bc->server, &bc->server->config.accessControl,
+                            &bc->session->sessionId, bc->session->sessionHandle,
+                            &descr->nodeId, node->head.context);
+        if(!bc->parallel) {
             UA_LOCK(&bc->server->serviceMutex);
+        }
+        if(!allowed) {
             UA_NODESTORE_RELEASE(bc->server, node);
             bc->status = UA_STATUSCODE_BADUSERACCESSDENIED;
             return;
         }
-        UA_LOCK(&bc->server->serviceMutex);
     }
 
-    /* Browse the node */
-    browseWithNode(bc, &node->head);
+    /* Browse the node. Try the cache first. */
+    if(!browseCached(bc)) {
+        browseWithNode(bc, &node->head);
+        cacheBrowseResult(bc);
+    }
     UA_NODESTORE_RELEASE(bc->server, node);
 
     /* Is the reference type valid? This is very infrequent. So we only test
@@ -826,10 +904,12 @@ browse(struct BrowseContext *bc) {
     }
 }
 
-/* Start to browse with no previous cp */
-void
-Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxrefs,
-                 const UA_BrowseDescription *descr, UA_BrowseResult *result) {
+/* Start to browse with no previous cp. Returns false if the browse ran in
+ * parallel mode and a continuation point would be required. */
+static UA_Boolean
+browseFirst(UA_Server *server, UA_Session *session, const UA_UInt32 *maxrefs,
+            const UA_BrowseDescription *descr, UA_BrowseResult *result,
+            UA_Boolean parallel) {
     /* Stack-allocate a temporary cp */
     ContinuationPoint cp;
     memset(&cp, 0, sizeof(ContinuationPoint));
@@ -855,7 +935,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
         referenceTypeIndices(server, &descr->referenceTypeId,
                              &cp.relevantReferences, descr->includeSubtypes);
     if(result->statusCode != UA_STATUSCODE_GOOD)
-        return;
+        return true;
 
     /* Prepare the context */
     struct BrowseContext bc;
@@ -865,6 +945,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     bc.status = UA_STATUSCODE_GOOD;
     bc.done = false;
     bc.activeCP = false;
+    bc.parallel = parallel;
     bc.resultRefs = cp.relevantReferences;
     if(cp.browseDescription.resultMask & UA_BROWSERESULTMASK_TYPEDEFINITION) {
         /* Get the node with additional reference types if we need to lookup the
@@ -875,7 +956,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     }
     result->statusCode = RefResult_init(&bc.rr);
     if(result->statusCode != UA_STATUSCODE_GOOD)
-        return;
+        return true;
 
     /* Perform the browse */
     browse(&bc);
@@ -885,7 +966,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
         RefResult_clear(&bc.rr);
         result->references = (UA_ReferenceDescription*)UA_EMPTY_ARRAY_SENTINEL;
         result->statusCode = bc.status;
-        return;
+        return true;
     }
 
     /* Move results */
@@ -894,7 +975,15 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
 
     /* Exit early if done */
     if(bc.done)
-        return;
+        return true;
+
+    /* The session cannot be modified in a worker thread. Clean up and process
+     * the operation sequentially. */
+    if(parallel) {
+        UA_NodePointer_clear(&cp.lastTarget);
+        UA_BrowseResult_clear(result);
+        return false;
+    }
 
     /* Persist the continuation point */
 
@@ -945,7 +1034,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     cp2->next = session->continuationPoints;
     session->continuationPoints = cp2;
     --session->availableContinuationPoints;
-    return;
+    return true;
 
  cleanup:
     if(cp2) {
@@ -955,6 +1044,27 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     UA_NodePointer_clear(&cp.lastTarget);
     UA_BrowseResult_clear(result);
     result->statusCode = retval;
+    return true;
+}
+
+void
+Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxrefs,
+                 const UA_BrowseDescription *descr, UA_BrowseResult *result) {
+    browseFirst(server, session, maxrefs, descr, result, false);
+}
+
+static UA_Boolean
+Operation_BrowseParallel(UA_Server *server, UA_Session *session,
+                         const UA_UInt32 *maxrefs, const UA_BrowseDescription *descr,
+                         UA_BrowseResult *result) {
+#if UA_MULTITHREADING >= 100
+    /* Call the AccessControl only in the calling thread unless it is
+     * configured to be thread-safe */
+    if(session != &server->adminSession &&
+       !server->config.parallelAccessControl)
+        return false;
+#endif
+    return browseFirst(server, session, maxrefs, descr, result, true);
 }
 
 void Service_Browse(UA_Server *server, UA_Session *session,
@@ -976,13 +1086,15 @@ void Service_Browse(UA_Server *server, UA_Session *session,
     }
 
     response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session,
-                                           (UA_ServiceOperation)Operation_Browse,
-                                           &request->requestedMaxReferencesPerNode,
-                                           &request->nodesToBrowseSize,
-                                           &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION],
-                                           &response->resultsSize,
-                                           &UA_TYPES[UA_TYPES_BROWSERESULT]);
+        UA_Server_processServiceOperationsParallel(server, session,
+                                                   (UA_ServiceOperation)Operation_Browse,
+                                                   (UA_ParallelServiceOperation)
+                                                   Operation_BrowseParallel,
+                                                   &request->requestedMaxReferencesPerNode,
+                                                   &request->nodesToBrowseSize,
+                                                   &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION],
+                                                   &response->resultsSize,
+                                                   &UA_TYPES[UA_TYPES_BROWSERESULT]);
 }
 
 UA_BrowseResult
@@ -1029,6 +1141,7 @@ Operation_BrowseNext(UA_Server *server, UA_Session *session,
     bc.status = UA_STATUSCODE_GOOD;
     bc.done = false;
     bc.activeCP = true;
+    bc.parallel = false;
     bc.resultRefs = cp->relevantReferences;
     if(cp->browseDescription.resultMask & UA_BROWSERESULTMASK_TYPEDEFINITION) {
         /* Get the node with additional reference types if we need to lookup the
@@ -1122,7 +1235,8 @@ static UA_StatusCode
 walkBrowsePathElement(UA_Server *server, UA_Session *session,
                       const UA_RelativePath *path, const size_t pathIndex,
                       UA_UInt32 nodeClassMask, const UA_QualifiedName *lastBrowseName,
-                      UA_BrowsePathResult *result, RefTree *current, RefTree *next) {
+                      UA_BrowsePathResult *result, const UA_ExpandedNodeId *current,
+                      size_t currentSize, RefTree *next) {
     /* For the next level. Note the difference from lastBrowseName */
     const UA_RelativePathElement *elem = &path->elements[pathIndex];
     UA_UInt32 browseNameHash = UA_QualifiedName_hash(&elem->targetName);
@@ -1136,10 +1250,10 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
         return UA_STATUSCODE_BADNOMATCH;
 
     /* Loop over all Nodes in the current depth level */
-    for(size_t i = 0; i < current->size; i++) {
+    for(size_t i = 0; i < currentSize; i++) {
         /* Remote Node. Immediately add to the results with the
          * RemainingPathIndex set. */
-        if(!UA_ExpandedNodeId_isLocal(&current->targets[i])) {
+        if(!UA_ExpandedNodeId_isLocal(&current[i])) {
             /* Increase the size of the results array */
             UA_BrowsePathTarget *tmpResults = (UA_BrowsePathTarget*)
                 UA_realloc(result->targets, sizeof(UA_BrowsePathTarget) *
@@ -1149,7 +1263,7 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
             result->targets = tmpResults;
 
             /* Copy over the result */
-            res = UA_ExpandedNodeId_copy(&current->targets[i],
+            res = UA_ExpandedNodeId_copy(&current[i],
                                          &result->targets[result->targetsSize].targetId);
             result->targets[result->targetsSize].remainingPathIndex = (UA_UInt32)pathIndex;
             result->targetsSize++;
@@ -1162,7 +1276,7 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
          * the NodeClass + BrowseName attribute and the selected ReferenceTypes
          * if the nodestore supports that. */
         const UA_Node *node =
-            UA_NODESTORE_GET_SELECTIVE(server, &current->targets[i].nodeId,
+            UA_NODESTORE_GET_SELECTIVE(server, &current[i].nodeId,
                                        UA_NODEATTRIBUTESMASK_NODECLASS |
                                        UA_NODEATTRIBUTESMASK_BROWSENAME,
                                        refTypes,
@@ -1210,6 +1324,20 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
                                  &targetHashKey, addBrowseHashTarget, next);
                 if(res != UA_STATUSCODE_GOOD)
                     break;
+            } else if(rk->isCompact) {
+                /* Binary search in the name index */
+                size_t k = compactNameLowerBound(rk, browseNameHash);
+                for(; k < rk->targetsSize; k++) {
+                    UA_ReferenceTarget *t =
+                        &rk->targets.array[rk->targets.compact.nameIndex[k]];
+                    if(t->targetNameHash != browseNameHash)
+                        break;
+                    res = RefTree_add(next, t->targetId, NULL);
+                    if(res != UA_STATUSCODE_GOOD)
+                        break;
+                }
+                if(res != UA_STATUSCODE_GOOD)
+                    break;
             } else {
                 /* The array entries don't have a BrowseName hash. Add all of
                  * them at this level to be checked with a full string
@@ -1231,6 +1359,169 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
     return res;
 }
 
+/* Remove the targets where the BrowseName does not match. So far they were
+ * selected only via the hash of the BrowseName. Remote nodes cannot be checked
+ * and lead to UA_STATUSCODE_BADNOTSUPPORTED. */
+static UA_StatusCode
+filterBrowseName(UA_Server *server, RefTree *rt, const UA_QualifiedName *browseName) {
+    size_t matches = 0;
+    for(size_t i = 0; i < rt->size; i++) {
+        if(!UA_ExpandedNodeId_isLocal(&rt->targets[i]))
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        const UA_Node *node =
+            UA_NODESTORE_GET_SELECTIVE(server, &rt->targets[i].nodeId,
+                                       UA_NODEATTRIBUTESMASK_BROWSENAME,
+                                       UA_REFERENCETYPESET_NONE,
+                                       UA_BROWSEDIRECTION_INVALID);
+        UA_Boolean match = false;
+        if(node) {
+            match = UA_QualifiedName_equal(browseName, &node->head.browseName);
+            UA_NODESTORE_RELEASE(server, node);
+        }
+        if(!match) {
+            UA_ExpandedNodeId_clear(&rt->targets[i]);
+            continue;
+        }
+        if(i != matches) {
+            rt->targets[matches] = rt->targets[i];
+            UA_ExpandedNodeId_init(&rt->targets[i]);
+        }
+        matches++;
+    }
+
+    /* The tree-part is no longer valid. The RefTree is only used as an array
+     * from here on. */
+    rt->size = matches;
+    ZIP_INIT(&rt->head);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Resolve the BrowsePath element-by-element. The targets for every prefix of
+ * the path are taken from the BrowsePath cache or added to it. Returns
+ * UA_STATUSCODE_BADNOTSUPPORTED if a remote node is encountered. Then the path
+ * has to be resolved without the cache. */
+static UA_StatusCode
+translateBrowsePathCached(UA_Server *server, UA_Session *session,
+                          UA_UInt32 nodeClassMask, const UA_BrowsePath *path,
+                          UA_BrowsePathResult *result) {
+    UA_BrowsePathCache *bpc = &server->browsePathCache;
+    size_t maxSize = server->config.maxBrowsePathCacheSize;
+
+    /* The root entry for the starting node */
+    UA_BrowsePathCacheKey key;
+    key.nodeId = path->startingNode;
+    UA_QualifiedName_init(&key.name);
+    key.flags = nodeClassMask;
+    UA_ExpandedNodeId start;
+    UA_ExpandedNodeId_init(&start);
+    start.nodeId = path->startingNode;
+    const UA_ExpandedNodeId *current = &start;
+    size_t currentSize = 1;
+    UA_BrowsePathCacheEntry *entry = UA_BrowsePathCache_find(bpc, NULL, &key);
+    if(entry) {
+        current = entry->targets;
+        currentSize = entry->targetsSize;
+    } else {
+        /* Check if the starting node exists */
+        const UA_Node *startingNode =
+            UA_NODESTORE_GET_SELECTIVE(server, &path->startingNode,
+                                       UA_NODEATTRIBUTESMASK_NONE,
+                                       UA_REFERENCETYPESET_NONE,
+                                       UA_BROWSEDIRECTION_INVALID);
+        if(!startingNode)
+            return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        UA_NODESTORE_RELEASE(server, startingNode);
+        entry = UA_BrowsePathCache_add(bpc, maxSize, NULL, &key, &start, 1);
+    }
+
+    /* Two RefTrees that are alternated between the path elements if the
+     * targets are not taken from the cache */
+    RefTree rt1;
+    RefTree rt2;
+    RefTree *next = &rt1;
+    UA_StatusCode res = RefTree_init(&rt1);
+    res |= RefTree_init(&rt2);
+    if(res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    for(size_t i = 0; i < path->relativePath.elementsSize && currentSize > 0; i++) {
+        const UA_RelativePathElement *elem = &path->relativePath.elements[i];
+        key.nodeId = elem->referenceTypeId;
+        key.name = elem->targetName;
+        key.flags = (elem->isInverse ? 0x01u : 0x00u) | (elem->includeSubtypes ? 0x02u : 0x00u);
+
+        /* Resolved prefix in the cache */
+        UA_BrowsePathCacheEntry *child =
+            (entry) ? UA_BrowsePathCache_find(bpc, entry, &key) : NULL;
+        if(child) {
+            entry = child;
+            current = child->targets;
+            currentSize = child->targetsSize;
+            continue;
+        }
+
+        /* Clear up next, keep the capacity */
+        for(size_t j = 0; j < next->size; j++)
+            UA_ExpandedNodeId_clear(&next->targets[j]);
+        next->size = 0;
+        ZIP_INIT(&next->head);
+
+        /* Walk the element and check the BrowseName of the targets. Remote
+         * nodes are added to the result by the walk. */
+        res = walkBrowsePathElement(server, session, &path->relativePath, i,
+                                    nodeClassMask, NULL, result,
+                                    current, currentSize, next);
+        if(res == UA_STATUSCODE_GOOD && result->targetsSize > 0)
+            res = UA_STATUSCODE_BADNOTSUPPORTED;
+        if(res == UA_STATUSCODE_GOOD)
+            res = filterBrowseName(server, next, &elem->targetName);
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+
+        /* Add to the cache */
+        if(entry)
+            entry = UA_BrowsePathCache_add(bpc, maxSize, entry, &key,
+                                           next->targets, next->size);
+        current = next->targets;
+        currentSize = next->size;
+
+        /* Switch the trees. Current points into the other tree now. */
+        next = (next == &rt1) ? &rt2 : &rt1;
+    }
+
+    /* No results => BadNoMatch status code */
+    if(currentSize == 0) {
+        res = UA_STATUSCODE_BADNOMATCH;
+        goto cleanup;
+    }
+
+    /* Copy the targets to the result */
+    result->targets = (UA_BrowsePathTarget*)
+        UA_calloc(currentSize, sizeof(UA_BrowsePathTarget));
+    if(!result->targets) {
+        res = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto cleanup;
+    }
+    for(size_t k = 0; k < currentSize; k++) {
+        res |= UA_ExpandedNodeId_copy(&current[k], &result->targets[k].targetId);
+        result->targets[k].remainingPathIndex = UA_UINT32_MAX;
+    }
+    result->targetsSize = currentSize;
+
+ cleanup:
+    RefTree_clear(&rt1);
+    RefTree_clear(&rt2);
+    if(res != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < result->targetsSize; ++i)
+            UA_BrowsePathTarget_clear(&result->targets[i]);
+        if(result->targets)
+            UA_free(result->targets);
+        result->targets = NULL;
+        result->targetsSize = 0;
+    }
+    return res;
+}
+
 static void
 Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
                                        const UA_UInt32 *nodeClassMask,
@@ -1251,6 +1542,16 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
         }
     }
 
+    /* Use the BrowsePath cache. Fall back to the resolution without the
+     * cache for paths that contain remote nodes. */
+    if(server->config.maxBrowsePathCacheSize > 0) {
+        result->statusCode =
+            translateBrowsePathCached(server, session, *nodeClassMask, path, result);
+        if(result->statusCode != UA_STATUSCODE_BADNOTSUPPORTED)
+            return;
+        result->statusCode = UA_STATUSCODE_GOOD;
+    }
+
     /* Check if the starting node exists */
     const UA_Node *startingNode =
         UA_NODESTORE_GET_SELECTIVE(server, &path->startingNode,
@@ -1303,7 +1604,8 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
          * Puts new results in the "next" tree. */
         result->statusCode =
             walkBrowsePathElement(server, session, &path->relativePath, i,
-                                  *nodeClassMask, browseNameFilter, result, current, next);
+                                  *nodeClassMask, browseNameFilter, result,
+                                  current->targets, current->size, next);
         if(result->statusCode != UA_STATUSCODE_GOOD)
             goto cleanup;
 
@@ -1360,6 +1662,19 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
     }
 }
 
+/* Only accesses the NodeStore. Can run in a worker thread unless the
+ * BrowsePath cache is used. */
+static UA_Boolean
+Operation_TranslateBrowsePathToNodeIdsParallel(UA_Server *server, UA_Session *session,
+                                               const UA_UInt32 *nodeClassMask,
+                                               const UA_BrowsePath *path,
+                                               UA_BrowsePathResult *result) {
+    if(server->config.maxBrowsePathCacheSize > 0)
+        return false;
+    Operation_TranslateBrowsePathToNodeIds(server, session, nodeClassMask, path, result);
+    return true;
+}
+
 UA_BrowsePathResult
 translateBrowsePathToNodeIds(UA_Server *server,
                                        const UA_BrowsePath *browsePath) {
@@ -1398,11 +1713,13 @@ Service_TranslateBrowsePathsToNodeIds(UA_Server *server, UA_Session *session,
 
     UA_UInt32 nodeClassMask = 0; /* All node classes */
     response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session,
-                                           (UA_ServiceOperation)Operation_TranslateBrowsePathToNodeIds,
-                                           &nodeClassMask,
-                                           &request->browsePathsSize, &UA_TYPES[UA_TYPES_BROWSEPATH],
-                                           &response->resultsSize, &UA_TYPES[UA_TYPES_BROWSEPATHRESULT]);
+        UA_Server_processServiceOperationsParallel(server, session,
+                                                   (UA_ServiceOperation)Operation_TranslateBrowsePathToNodeIds,
+                                                   (UA_ParallelServiceOperation)
+                                                   Operation_TranslateBrowsePathToNodeIdsParallel,
+                                                   &nodeClassMask,
+                                                   &request->browsePathsSize, &UA_TYPES[UA_TYPES_BROWSEPATH],
+                                                   &response->resultsSize, &UA_TYPES[UA_TYPES_BROWSEPATHRESULT]);
 }
 
 UA_BrowsePathResult
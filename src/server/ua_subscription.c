@@ -678,11 +678,60 @@ UA_Subscription_sampleAndPublish(UA_Server *server, UA_Subscription *sub) {
     UA_assert(sub);
 
     /* Sample the MonitoredItems with sampling interval <0 (which implies
-     * sampling in the same interval as the subscription) */
+     * sampling in the same interval as the subscription). Read the DataSource
+     * values in batches first if possible. */
     UA_MonitoredItem *mon;
+    UA_DataValue *prefetched = NULL;
+    UA_BatchReadItem *items = NULL;
+    UA_UInt32 *itemIds = NULL;
+    size_t samplingSize = 0;
+    if(server->config.readDataSourceBatch) {
+        LIST_FOREACH(mon, &sub->samplingMonitoredItems, sampling.samplingListEntry)
+            samplingSize++;
+    }
+    if(samplingSize > 1) {
+        items = (UA_BatchReadItem*)UA_malloc(samplingSize * sizeof(UA_BatchReadItem));
+        itemIds = (UA_UInt32*)UA_malloc(samplingSize * sizeof(UA_UInt32));
+        prefetched = (UA_DataValue*)
+            UA_Array_new(samplingSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if(items && itemIds && prefetched) {
+            size_t i = 0;
+            LIST_FOREACH(mon, &sub->samplingMonitoredItems, sampling.samplingListEntry) {
+                /* Same maxAge as in monitoredItem_sampleCallback */
+                items[i].rvi = &mon->itemToMonitor;
+                items[i].timestamps = mon->timestampsToReturn;
+                items[i].maxAge = mon->parameters.samplingInterval / 2.0;
+                itemIds[i] = mon->monitoredItemId;
+                i++;
+            }
+            readDataSourceBatch(server, sub->session, samplingSize, items, prefetched);
+        }
+    }
+
+    /* The MonitoredItems might have been deleted and re-created (possibly at
+     * the same address) while the service lock was released for the batched
+     * read. So the prefetched values are matched by the MonitoredItemId which
+     * is never reused within the Subscription. The list order is retained, so
+     * the search continues after the last match. Prefetched values without a
+     * matching MonitoredItem are dropped. */
+    size_t next = 0;
     LIST_FOREACH(mon, &sub->samplingMonitoredItems, sampling.samplingListEntry) {
-        monitoredItem_sampleCallback(server, mon);
+        UA_DataValue *pv = NULL;
+        if(items && itemIds && prefetched) {
+            for(size_t j = next; j < samplingSize; j++) {
+                if(itemIds[j] != mon->monitoredItemId)
+                    continue;
+                pv = &prefetched[j];
+                next = j + 1;
+                break;
+            }
+        }
+        monitoredItem_sampleCallback(server, mon, pv);
     }
+    UA_free(items);
+    UA_free(itemIds);
+    if(prefetched)
+        UA_Array_delete(prefetched, samplingSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
 
     /* Publish the queued notifications */
     UA_Subscription_publish(server, sub);
@@ -202,12 +202,13 @@ sampleCallbackWithValue(UA_Server *server, UA_Subscription *sub,
 void
 UA_MonitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem) {
     UA_LOCK(&server->serviceMutex);
-    monitoredItem_sampleCallback(server, monitoredItem);
+    monitoredItem_sampleCallback(server, monitoredItem, NULL);
     UA_UNLOCK(&server->serviceMutex);
 }
 
 void
-monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem) {
+monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem,
+                             UA_DataValue *prefetched) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     UA_Subscription *sub = monitoredItem->subscription;
@@ -221,10 +222,14 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem)
 
     UA_assert(monitoredItem->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
 
-    /* Sample the value. The sample can still point into the node. */
-    UA_DataValue value = UA_Server_readWithSession(server, session,
-                                                   &monitoredItem->itemToMonitor,
-                                                   monitoredItem->timestampsToReturn);
+    /* Sample the value. The sample can still point into the node. Values
+     * from the value cache are used if they are not older than half the
+     * sampling interval. */
+    UA_DataValue value =
+        UA_Server_readWithSession(server, session, &monitoredItem->itemToMonitor,
+                                  monitoredItem->timestampsToReturn,
+                                  monitoredItem->parameters.samplingInterval / 2.0,
+                                  prefetched);
 
     /* Operate on the sample. The sample is consumed when the status is good. */
     UA_StatusCode res = sampleCallbackWithValue(server, sub, monitoredItem, &value);
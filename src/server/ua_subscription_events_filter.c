@@ -500,7 +500,7 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session,
         }
 
         v = UA_Server_readWithSession(server, session, &rvi,
-                                      UA_TIMESTAMPSTORETURN_NEITHER);
+                                      UA_TIMESTAMPSTORETURN_NEITHER, 0.0, NULL);
     } else {
         /* Resolve the browse path, starting from the event-source (and not the
          * typeDefinitionId). */
@@ -518,7 +518,7 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session,
         /* Use the first match */
         rvi.nodeId = bpr.targets[0].targetId.nodeId;
         v = UA_Server_readWithSession(server, session, &rvi,
-                                      UA_TIMESTAMPSTORETURN_NEITHER);
+                                      UA_TIMESTAMPSTORETURN_NEITHER, 0.0, NULL);
         UA_BrowsePathResult_clear(&bpr);
     }
 
@@ -560,7 +560,7 @@ UA_MonitoredItem_setMonitoringMode(UA_Server *server, UA_MonitoredItem *mon,
     if(oldMode == UA_MONITORINGMODE_DISABLED &&
        mon->monitoringMode > UA_MONITORINGMODE_DISABLED &&
        mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER)
-        monitoredItem_sampleCallback(server, mon);
+        monitoredItem_sampleCallback(server, mon, NULL);
 
     return UA_STATUSCODE_GOOD;
 }
@@ -1297,7 +1297,12 @@ copyStructure(const void *src, void *dst, const UA_DataType *type) {
         ptrd += m->padding;
         if(!m->isOptional) {
             if(!m->isArray) {
-                retval |= copyJumpTable[mt->typeKind]((const void *)ptrs, (void *)ptrd, mt);
+                /* Copy pointer-free members without dispatching */
+                if(mt->pointerFree)
+                    memcpy((void*)ptrd, (const void*)ptrs, mt->memSize);
+                else
+                    retval |= copyJumpTable[mt->typeKind]((const void *)ptrs,
+                                                          (void *)ptrd, mt);
                 ptrs += mt->memSize;
                 ptrd += mt->memSize;
             } else {
@@ -1413,6 +1418,12 @@ const UA_copySignature copyJumpTable[UA_DATATYPEKINDS] = {
 
 UA_StatusCode
 UA_copy(const void *src, void *dst, const UA_DataType *type) {
+    /* Shallow copy is enough */
+    if(type->pointerFree) {
+        memcpy(dst, src, type->memSize);
+        return UA_STATUSCODE_GOOD;
+    }
+
     memset(dst, 0, type->memSize); /* init */
     UA_StatusCode retval = copyJumpTable[type->typeKind](src, dst, type);
     if(retval != UA_STATUSCODE_GOOD)
@@ -1429,7 +1440,9 @@ clearStructure(void *p, const UA_DataType *type) {
         ptr += m->padding;
         if(!m->isOptional) {
             if(!m->isArray) {
-                clearJumpTable[mt->typeKind]((void*)ptr, mt);
+                /* Nothing to clear in pointer-free members */
+                if(!mt->pointerFree)
+                    clearJumpTable[mt->typeKind]((void*)ptr, mt);
                 ptr += mt->memSize;
             } else {
                 size_t length = *(size_t*)ptr;
@@ -1516,13 +1529,15 @@ UA_clearSignature clearJumpTable[UA_DATATYPEKINDS] = {
 
 void
 UA_clear(void *p, const UA_DataType *type) {
-    clearJumpTable[type->typeKind](p, type);
+    if(!type->pointerFree)
+        clearJumpTable[type->typeKind](p, type);
     memset(p, 0, type->memSize); /* init */
 }
 
 void
 UA_delete(void *p, const UA_DataType *type) {
-    clearJumpTable[type->typeKind](p, type);
+    if(!type->pointerFree)
+        clearJumpTable[type->typeKind](p, type);
     UA_free(p);
 }
 
@@ -1974,21 +1989,31 @@ UA_Array_copy(const void *src, size_t size,
     if(!type)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* calloc, so we don't have to check retval in every iteration of copying */
-    *dst = UA_calloc(size, type->memSize);
-    if(!*dst)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-
+    /* Pointer-free arrays are copied in one piece. No need to zero out the
+     * memory first. */
     if(type->pointerFree) {
+        if(size > SIZE_MAX / type->memSize)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        *dst = UA_malloc(type->memSize * size);
+        if(!*dst)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
         memcpy(*dst, src, type->memSize * size);
         return UA_STATUSCODE_GOOD;
     }
 
+    /* calloc, so we don't have to check retval in every iteration of copying.
+     * The elements are already initialized, so we can use the jump table
+     * directly instead of UA_copy. */
+    *dst = UA_calloc(size, type->memSize);
+    if(!*dst)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     uintptr_t ptrs = (uintptr_t)src;
     uintptr_t ptrd = (uintptr_t)*dst;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_copySignature copyType = copyJumpTable[type->typeKind];
     for(size_t i = 0; i < size; ++i) {
-        retval |= UA_copy((void*)ptrs, (void*)ptrd, type);
+        retval |= copyType((void*)ptrs, (void*)ptrd, type);
         ptrs += type->memSize;
         ptrd += type->memSize;
     }
@@ -2088,10 +2113,13 @@ UA_Array_appendCopy(void **p, size_t *size, const void *newElem,
 
 void
 UA_Array_delete(void *p, size_t size, const UA_DataType *type) {
+    /* The elements are freed with the array. No need to reset them with
+     * UA_clear. */
     if(!type->pointerFree) {
         uintptr_t ptr = (uintptr_t)p;
+        UA_clearSignature clearType = clearJumpTable[type->typeKind];
         for(size_t i = 0; i < size; ++i) {
-            UA_clear((void*)ptr, type);
+            clearType((void*)ptr, type);
             ptr += type->memSize;
         }
     }
@@ -15,6 +15,7 @@
 #include "ua_types_encoding_json.h"
 
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 
 #include "../deps/itoa.h"
@@ -57,10 +58,29 @@
 #define ENCODE_DIRECT_JSON(SRC, TYPE) \
     TYPE##_encodeJson(ctx, (const UA_##TYPE*)SRC, NULL)
 
+/* The buffer is full. Flush it out via the callback and continue in the new
+ * buffer. JSON has no chunk structure, so the output can be split at any
+ * position. */
 static status UA_FUNC_ATTR_WARN_UNUSED_RESULT
-writeChar(CtxJson *ctx, char c) {
-    if(ctx->pos >= ctx->end)
+exchangeJsonBuffer(CtxJson *ctx) {
+    if(!ctx->exchangeBufferCallback)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    status ret = ctx->exchangeBufferCallback(ctx->exchangeBufferCallbackHandle,
+                                             &ctx->pos, &ctx->end);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    if(ctx->pos >= ctx->end) /* No progress possible */
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    return UA_STATUSCODE_GOOD;
+}
+
+static status UA_FUNC_ATTR_WARN_UNUSED_RESULT
+writeChar(CtxJson *ctx, char c) {
+    if(ctx->pos >= ctx->end) {
+        status ret = exchangeJsonBuffer(ctx);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+    }
     if(!ctx->calcOnly)
         *ctx->pos = (UA_Byte)c;
     ctx->pos++;
@@ -69,8 +89,20 @@ writeChar(CtxJson *ctx, char c) {
 
 static status UA_FUNC_ATTR_WARN_UNUSED_RESULT
 writeChars(CtxJson *ctx, const char *c, size_t len) {
-    if(ctx->pos + len > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    /* Fill up and exchange the buffer until the remaining chars fit */
+    while(ctx->pos + len > ctx->end) {
+        if(!ctx->exchangeBufferCallback)
+            return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+        size_t part = (size_t)(ctx->end - ctx->pos);
+        if(!ctx->calcOnly)
+            memcpy(ctx->pos, c, part);
+        ctx->pos += part;
+        c += part;
+        len -= part;
+        status ret = exchangeJsonBuffer(ctx);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+    }
     if(!ctx->calcOnly)
         memcpy(ctx->pos, c, len);
     ctx->pos += len;
@@ -260,84 +292,42 @@ ENCODE_JSON(Boolean) {
 ENCODE_JSON(Byte) {
     char buf[4];
     UA_UInt16 digits = itoaUnsigned(*src, buf, 10);
-
-    /* Ensure destination can hold the data- */
-    if(ctx->pos + digits > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    /* Copy digits to the output string/buffer. */
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, digits);
-    ctx->pos += digits;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, digits);
 }
 
 /* signed Byte */
 ENCODE_JSON(SByte) {
     char buf[5];
     UA_UInt16 digits = itoaSigned(*src, buf);
-    if(ctx->pos + digits > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, digits);
-    ctx->pos += digits;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, digits);
 }
 
 /* UInt16 */
 ENCODE_JSON(UInt16) {
     char buf[6];
     UA_UInt16 digits = itoaUnsigned(*src, buf, 10);
-
-    if(ctx->pos + digits > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, digits);
-    ctx->pos += digits;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, digits);
 }
 
 /* Int16 */
 ENCODE_JSON(Int16) {
     char buf[7];
     UA_UInt16 digits = itoaSigned(*src, buf);
-
-    if(ctx->pos + digits > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, digits);
-    ctx->pos += digits;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, digits);
 }
 
 /* UInt32 */
 ENCODE_JSON(UInt32) {
     char buf[11];
     UA_UInt16 digits = itoaUnsigned(*src, buf, 10);
-
-    if(ctx->pos + digits > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, digits);
-    ctx->pos += digits;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, digits);
 }
 
 /* Int32 */
 ENCODE_JSON(Int32) {
     char buf[12];
     UA_UInt16 digits = itoaSigned(*src, buf);
-
-    if(ctx->pos + digits > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, digits);
-    ctx->pos += digits;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, digits);
 }
 
 /* UInt64 */
@@ -347,14 +337,7 @@ ENCODE_JSON(UInt64) {
     UA_UInt16 digits = itoaUnsigned(*src, buf + 1, 10);
     buf[digits + 1] = '\"';
     UA_UInt16 length = (UA_UInt16)(digits + 2);
-
-    if(ctx->pos + length > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, length);
-    ctx->pos += length;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, length);
 }
 
 /* Int64 */
@@ -364,14 +347,7 @@ ENCODE_JSON(Int64) {
     UA_UInt16 digits = itoaSigned(*src, buf + 1);
     buf[digits + 1] = '\"';
     UA_UInt16 length = (UA_UInt16)(digits + 2);
-
-    if(ctx->pos + length > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buf, length);
-    ctx->pos += length;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buf, length);
 }
 
 ENCODE_JSON(Float) {
@@ -389,14 +365,7 @@ ENCODE_JSON(Float) {
     } else {
         len = dtoa((UA_Double)*src, buffer);
     }
-
-    if(ctx->pos + len > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buffer, len);
-    ctx->pos += len;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buffer, len);
 }
 
 ENCODE_JSON(Double) {
@@ -414,14 +383,7 @@ ENCODE_JSON(Double) {
     } else {
         len = dtoa(*src, buffer);
     }
-
-    if(ctx->pos + len > ctx->end)
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, buffer, len);
-    ctx->pos += len;
-    return UA_STATUSCODE_GOOD;
+    return writeChars(ctx, buffer, len);
 }
 
 static status
@@ -534,11 +496,9 @@ ENCODE_JSON(String) {
 
         /* Write out the characters that don't need escaping */
         if(pos != str) {
-            if(ctx->pos + (pos - str) > ctx->end)
-                return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-            if(!ctx->calcOnly)
-                memcpy(ctx->pos, str, (size_t)(pos - str));
-            ctx->pos += pos - str;
+            ret |= writeChars(ctx, (const char*)str, (size_t)(pos - str));
+            if(ret != UA_STATUSCODE_GOOD)
+                return ret;
         }
 
         /* Reached the end of the utf8 encoding */
@@ -596,11 +556,9 @@ ENCODE_JSON(String) {
             }
             break;
         }
-        if(ctx->pos + length > ctx->end)
-            return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-        if(!ctx->calcOnly)
-            memcpy(ctx->pos, text, length);
-        ctx->pos += length;
+        ret |= writeChars(ctx, text, length);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
         str = pos = end;
     }
 
@@ -626,15 +584,8 @@ ENCODE_JSON(ByteString) {
     if(!ba64)
         return UA_STATUSCODE_BADENCODINGERROR;
 
-    if(ctx->pos + flen > ctx->end) {
-        UA_free(ba64);
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-    }
-
     /* Copy flen bytes to output stream. */
-    if(!ctx->calcOnly)
-        memcpy(ctx->pos, ba64, flen);
-    ctx->pos += flen;
+    ret |= writeChars(ctx, (const char*)ba64, flen);
 
     /* Base64 result no longer needed */
     UA_free(ba64);
@@ -645,14 +596,11 @@ ENCODE_JSON(ByteString) {
 
 /* Guid */
 ENCODE_JSON(Guid) {
-    if(ctx->pos + 38 > ctx->end) /* 36 + 2 (") */
-        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
-    status ret = writeJsonQuote(ctx);
-    if(!ctx->calcOnly)
-        UA_Guid_to_hex(src, ctx->pos, false);
-    ctx->pos += 36;
-    ret |= writeJsonQuote(ctx);
-    return ret;
+    UA_Byte buf[38]; /* 36 + 2 (") */
+    buf[0] = '\"';
+    UA_Guid_to_hex(src, &buf[1], false);
+    buf[37] = '\"';
+    return writeChars(ctx, (const char*)buf, 38);
 }
 
 static u8
@@ -1282,52 +1230,110 @@ const encodeJsonSignature encodeJsonJumpTable[UA_DATATYPEKINDS] = {
     (encodeJsonSignature)encodeJsonNotImplemented /* BitfieldCluster */
 };
 
+static void
+setupEncodeJsonCtx(CtxJson *ctx, const UA_EncodeJsonOptions *options) {
+    memset(ctx, 0, sizeof(CtxJson));
+    ctx->useReversible = true; /* default */
+    if(options) {
+        ctx->namespaces = options->namespaces;
+        ctx->namespacesSize = options->namespacesSize;
+        ctx->serverUris = options->serverUris;
+        ctx->serverUrisSize = options->serverUrisSize;
+        ctx->useReversible = options->useReversible;
+        ctx->prettyPrint = options->prettyPrint;
+        ctx->unquotedKeys = options->unquotedKeys;
+        ctx->stringNodeIds = options->stringNodeIds;
+    }
+}
+
+UA_StatusCode
+UA_encodeJsonInternal(const void *src, const UA_DataType *type,
+                      UA_Byte **bufPos, const UA_Byte **bufEnd,
+                      UA_exchangeEncodeBuffer exchangeCallback,
+                      void *exchangeHandle,
+                      const UA_EncodeJsonOptions *options) {
+    if(!src || !type)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Set up the context */
+    CtxJson ctx;
+    setupEncodeJsonCtx(&ctx, options);
+    ctx.pos = *bufPos;
+    ctx.end = *bufEnd;
+    ctx.exchangeBufferCallback = exchangeCallback;
+    ctx.exchangeBufferCallbackHandle = exchangeHandle;
+
+    /* Encode */
+    status res = encodeJsonJumpTable[type->typeKind](&ctx, src, type);
+
+    /* Set the new buffer position for the output. Beware that the buffer might
+     * have been exchanged internally. */
+    *bufPos = ctx.pos;
+    *bufEnd = ctx.end;
+    return res;
+}
+
+/* Initial buffer size if UA_encodeJson allocates the output */
+#define UA_JSON_ENCODING_INITIAL_BUFFER 256
+
+/* Exchange callback for UA_encodeJson. Doubles the size of the output buffer
+ * and continues at the same position. */
+static status
+growJsonBuffer(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    UA_ByteString *buf = (UA_ByteString*)handle;
+    size_t used = (size_t)(*bufPos - buf->data);
+    size_t newLength = buf->length << 1;
+    if(newLength <= buf->length)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    UA_Byte *newData = (UA_Byte*)UA_realloc(buf->data, newLength);
+    if(!newData)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    buf->data = newData;
+    buf->length = newLength;
+    *bufPos = &newData[used];
+    *bufEnd = &newData[newLength];
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_encodeJson(const void *src, const UA_DataType *type, UA_ByteString *outBuf,
               const UA_EncodeJsonOptions *options) {
     if(!src || !type)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    /* Allocate buffer */
+    /* Allocate buffer. The buffer grows during the encoding. So the value is
+     * encoded in a single pass without computing the size beforehand. */
     UA_Boolean allocated = false;
     status res = UA_STATUSCODE_GOOD;
     if(outBuf->length == 0) {
-        size_t len = UA_calcSizeJson(src, type, options);
-        res = UA_ByteString_allocBuffer(outBuf, len);
+        res = UA_ByteString_allocBuffer(outBuf, UA_JSON_ENCODING_INITIAL_BUFFER);
         if(res != UA_STATUSCODE_GOOD)
             return res;
         allocated = true;
     }
 
-    /* Set up the context */
-    CtxJson ctx;
-    memset(&ctx, 0, sizeof(ctx));
-    ctx.pos = outBuf->data;
-    ctx.end = &outBuf->data[outBuf->length];
-    ctx.depth = 0;
-    ctx.calcOnly = false;
-    ctx.useReversible = true; /* default */
-    if(options) {
-        ctx.namespaces = options->namespaces;
-        ctx.namespacesSize = options->namespacesSize;
-        ctx.serverUris = options->serverUris;
-        ctx.serverUrisSize = options->serverUrisSize;
-        ctx.useReversible = options->useReversible;
-        ctx.prettyPrint = options->prettyPrint;
-        ctx.unquotedKeys = options->unquotedKeys;
-        ctx.stringNodeIds = options->stringNodeIds;
-    }
-
     /* Encode */
-    res = encodeJsonJumpTable[type->typeKind](&ctx, src, type);
+    UA_Byte *pos = outBuf->data;
+    const UA_Byte *end = &outBuf->data[outBuf->length];
+    res = UA_encodeJsonInternal(src, type, &pos, &end,
+                                allocated ? growJsonBuffer : NULL,
+                                outBuf, options);
 
     /* Clean up */
-    if(res == UA_STATUSCODE_GOOD) {
-        outBuf->length = (size_t)((uintptr_t)ctx.pos - (uintptr_t)outBuf->data);
-    } else if(allocated) {
-        UA_ByteString_clear(outBuf);
+    if(res != UA_STATUSCODE_GOOD) {
+        if(allocated)
+            UA_ByteString_clear(outBuf);
+        return res;
     }
-    return res;
+    outBuf->length = (size_t)((uintptr_t)pos - (uintptr_t)outBuf->data);
+
+    /* Release the unused part of the allocated buffer */
+    if(allocated && outBuf->length > 0) {
+        UA_Byte *shrunk = (UA_Byte*)UA_realloc(outBuf->data, outBuf->length);
+        if(shrunk)
+            outBuf->data = shrunk;
+    }
+    return UA_STATUSCODE_GOOD;
 }
 
 UA_StatusCode
@@ -1357,22 +1363,9 @@ UA_calcSizeJson(const void *src, const UA_DataType *type,
 
     /* Set up the context */
     CtxJson ctx;
-    memset(&ctx, 0, sizeof(ctx));
+    setupEncodeJsonCtx(&ctx, options);
     ctx.pos = NULL;
     ctx.end = (const UA_Byte*)(uintptr_t)SIZE_MAX;
-    ctx.depth = 0;
-    ctx.useReversible = true; /* default */
-    if(options) {
-        ctx.namespaces = options->namespaces;
-        ctx.namespacesSize = options->namespacesSize;
-        ctx.serverUris = options->serverUris;
-        ctx.serverUrisSize = options->serverUrisSize;
-        ctx.useReversible = options->useReversible;
-        ctx.prettyPrint = options->prettyPrint;
-        ctx.unquotedKeys = options->unquotedKeys;
-        ctx.stringNodeIds = options->stringNodeIds;
-    }
-
     ctx.calcOnly = true;
 
     /* Encode */
@@ -2643,6 +2636,74 @@ DiagnosticInfoInner_decodeJson(ParseCtx* ctx, void* dst, const UA_DataType* type
     return DiagnosticInfo_decodeJson(ctx, inner, type);
 }
 
+/* Hash table over the field names of a DecodeEntry array. Looking up the keys
+ * of an object is then independent of the number of entries, also if the keys
+ * do not appear in the order of the entries. The slots contain the entry index
+ * plus one. Zero marks an empty slot. */
+typedef struct {
+    u8 *slots;
+    size_t mask;
+} FieldLookup;
+
+static void
+FieldLookup_init(FieldLookup *fl, const DecodeEntry *entries, size_t entryCount) {
+    memset(fl->slots, 0, fl->mask + 1);
+    for(size_t i = 0; i < entryCount; i++) {
+        const char *name = entries[i].fieldName;
+        size_t pos = UA_ByteString_hash(0, (const u8*)name, strlen(name)) & fl->mask;
+        while(fl->slots[pos] != 0)
+            pos = (pos + 1) & fl->mask; /* Linear probing */
+        fl->slots[pos] = (u8)(i + 1);
+    }
+}
+
+static DecodeEntry *
+FieldLookup_find(const FieldLookup *fl, const ParseCtx *ctx, DecodeEntry *entries) {
+    const cj5_token *tok = &ctx->tokens[ctx->index];
+    size_t pos = UA_ByteString_hash(0, (const u8*)ctx->json5 + tok->start,
+                                    getTokenLength(tok)) & fl->mask;
+    while(fl->slots[pos] != 0) {
+        DecodeEntry *entry = &entries[fl->slots[pos] - 1];
+        if(jsoneq(ctx->json5, tok, entry->fieldName) == 0)
+            return entry;
+        pos = (pos + 1) & fl->mask;
+    }
+    return NULL;
+}
+
+/* Decode the value for the key at the current index */
+static status
+decodeFieldValue(ParseCtx *ctx, DecodeEntry *entry) {
+    /* Duplicate key found, abort */
+    if(entry->found)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    entry->found = true;
+
+    ctx->index++; /* Go from key to value */
+    CHECK_TOKEN_BOUNDS;
+
+    /* An entry that was expected, but shall not be decoded.
+     * Jump over it. */
+    if(!entry->function && !entry->type) {
+        skipObject(ctx);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* A null-value -> skip the decoding (as a convention, if we know
+     * the type here, the value must be already initialized) */
+    if(currentTokenType(ctx) == CJ5_TOKEN_NULL && entry->type) {
+        ctx->index++;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Decode */
+    if(entry->function) /* Specialized decoding function */
+        return entry->function(ctx, entry->fieldPointer, entry->type);
+    /* Decode by type-kind */
+    return decodeJsonJumpTable[entry->type->typeKind]
+        (ctx, entry->fieldPointer, entry->type);
+}
+
 status
 decodeFields(ParseCtx *ctx, DecodeEntry *entries, size_t entryCount) {
     CHECK_TOKEN_BOUNDS;
@@ -2671,73 +2732,62 @@ decodeFields(ParseCtx *ctx, DecodeEntry *entries, size_t entryCount) {
         return UA_STATUSCODE_BADDECODINGERROR;
     }
 
+    /* Use a hash table for the keys that are out of order if there are many
+     * entries. The table has at least twice as many slots as entries. It is
+     * only filled when the first out-of-order key is encountered. */
+    FieldLookup fl;
+    fl.mask = 0;
+    if(entryCount >= UA_JSON_DECODEFIELDS_LOOKUPMIN && entryCount < 0xff) {
+        fl.mask = 1;
+        while(fl.mask < (entryCount << 1))
+            fl.mask <<= 1;
+        fl.mask--;
+    }
+    UA_STACKARRAY(u8, slots, fl.mask + 1);
+    fl.slots = NULL;
+
     status ret = UA_STATUSCODE_GOOD;
+    size_t next = 0; /* The expected entry if the keys are in order */
     for(size_t currObj = 0; currObj < objectCount &&
             ctx->index < ctx->tokensSize; currObj++) {
 
         /* Key must be a string */
         UA_assert(currentTokenType(ctx) == CJ5_TOKEN_STRING);
 
-        /* Start searching at the index of currObj */
-        for(size_t i = currObj; i < entryCount + currObj; i++) {
-            /* Search for key, if found outer loop will be one less. Best case
-             * if objectCount is in order! */
-            size_t index = i % entryCount;
-
-            /* CHECK_TOKEN_BOUNDS */
-            if(ctx->index >= ctx->tokensSize) {
-                ret = UA_STATUSCODE_BADDECODINGERROR;
-                goto cleanup;
-            }
-
-            if(jsoneq(ctx->json5, &ctx->tokens[ctx->index],
-                      entries[index].fieldName) != 0)
-                continue;
-
-            /* Duplicate key found, abort */
-            if(entries[index].found) {
-                ret = UA_STATUSCODE_BADDECODINGERROR;
-                goto cleanup;
+        /* Best case if the keys are in the order of the entries */
+        DecodeEntry *entry = NULL;
+        if(next < entryCount &&
+           jsoneq(ctx->json5, &ctx->tokens[ctx->index],
+                  entries[next].fieldName) == 0) {
+            entry = &entries[next];
+        } else if(fl.mask > 0) {
+            /* Look up in the hash table */
+            if(!fl.slots) {
+                fl.slots = slots;
+                FieldLookup_init(&fl, entries, entryCount);
             }
-
-            entries[index].found = true;
-
-            ctx->index++; /* Go from key to value */
-
-            /* CHECK_TOKEN_BOUNDS */
-            if(ctx->index >= ctx->tokensSize) {
-                ret = UA_STATUSCODE_BADDECODINGERROR;
-                goto cleanup;
-            }
-
-            /* An entry that was expected, but shall not be decoded.
-             * Jump over it. */
-            if(!entries[index].function && !entries[index].type) {
-                skipObject(ctx);
-                break;
+            entry = FieldLookup_find(&fl, ctx, entries);
+        } else {
+            /* Start searching at the index of currObj */
+            for(size_t i = currObj; i < entryCount + currObj; i++) {
+                size_t index = i % entryCount;
+                if(jsoneq(ctx->json5, &ctx->tokens[ctx->index],
+                          entries[index].fieldName) == 0) {
+                    entry = &entries[index];
+                    break;
+                }
             }
+        }
 
-            /* A null-value -> skip the decoding (as a convention, if we know
-             * the type here, the value must be already initialized) */
-            if(currentTokenType(ctx) == CJ5_TOKEN_NULL && entries[index].type) {
-                ctx->index++;
-                break;
-            }
+        if(!entry)
+            continue;
+        next = (size_t)(entry - entries) + 1;
 
-            /* Decode */
-            if(entries[index].function) /* Specialized decoding function */
-                ret = entries[index].function(ctx, entries[index].fieldPointer,
-                                              entries[index].type);
-            else /* Decode by type-kind */
-                ret = decodeJsonJumpTable[entries[index].type->typeKind]
-                    (ctx, entries[index].fieldPointer, entries[index].type);
-            if(ret != UA_STATUSCODE_GOOD)
-                goto cleanup;
+        ret = decodeFieldValue(ctx, entry);
+        if(ret != UA_STATUSCODE_GOOD)
             break;
-        }
     }
 
- cleanup:
     ctx->depth--;
     return ret;
 }
@@ -2866,27 +2916,68 @@ const decodeJsonSignature decodeJsonJumpTable[UA_DATATYPEKINDS] = {
     (decodeJsonSignature)decodeJsonNotImplemented /* BitfieldCluster */
 };
 
+/* Grow the token array during the tokenization. The initial token array is
+ * provided by the caller (usually on the stack) and is not reallocated.
+ *
+ * The array grows by 1/8 and is trimmed to the final token count after the
+ * tokenization. So the token array never exceeds the final size by more than
+ * 1/8 (with doubling it could be up to 2x). */
+static cj5_token *
+growTokens(void *context, cj5_token *tokens, unsigned int *maxTokens) {
+    ParseCtx *ctx = (ParseCtx*)context;
+    size_t newMax = (size_t)*maxTokens + (*maxTokens / 8);
+    if(newMax > UINT_MAX || newMax > SIZE_MAX / sizeof(cj5_token))
+        return NULL;
+    cj5_token *grown;
+    if(tokens == ctx->tokens) {
+        grown = (cj5_token*)UA_malloc(sizeof(cj5_token) * newMax);
+        if(grown)
+            memcpy(grown, tokens, sizeof(cj5_token) * *maxTokens);
+    } else {
+        grown = (cj5_token*)UA_realloc(tokens, sizeof(cj5_token) * newMax);
+    }
+    if(!grown)
+        return NULL;
+    *maxTokens = (unsigned int)newMax;
+    ctx->grownTokens = grown;
+    return grown;
+}
+
 status
 tokenize(ParseCtx *ctx, const UA_ByteString *src, size_t tokensSize) {
-    /* Tokenize */
+    /* Tokenize in a single pass. If the initial token array is too small, a
+     * larger array is allocated on the heap and the parsing continues there.
+     * The caller has to free ctx->tokens if it has changed. */
+    cj5_options options;
+    memset(&options, 0, sizeof(cj5_options));
+    options.grow_tokens = growTokens;
+    options.grow_tokens_context = ctx;
+    ctx->grownTokens = NULL;
     cj5_result r = cj5_parse((char*)src->data, (unsigned int)src->length,
-                             ctx->tokens, (unsigned int)tokensSize, NULL);
-
-    /* Handle overflow error by allocating the number of tokens the parser would
-     * have needed */
-    if(r.error == CJ5_ERROR_OVERFLOW &&
-       tokensSize != r.num_tokens) {
-        ctx->tokens = (cj5_token*)
-            UA_malloc(sizeof(cj5_token) * r.num_tokens);
-        if(!ctx->tokens)
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        return tokenize(ctx, src, r.num_tokens);
-    }
+                             ctx->tokens, (unsigned int)tokensSize, &options);
+
+    /* Continue with the grown token array (also if the parsing failed, so that
+     * the caller frees it) */
+    if(ctx->grownTokens)
+        ctx->tokens = ctx->grownTokens;
+
+    /* The token array could not be grown */
+    if(r.error == CJ5_ERROR_OVERFLOW)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Cannot recover from other errors */
     if(r.error != CJ5_ERROR_NONE)
         return UA_STATUSCODE_BADDECODINGERROR;
 
+    /* Release the unused margin of the grown token array. The tokens are kept
+     * during the decoding, when the decoded values are allocated as well. */
+    if(ctx->grownTokens && r.num_tokens > 0) {
+        cj5_token *shrunk = (cj5_token*)
+            UA_realloc(ctx->tokens, sizeof(cj5_token) * r.num_tokens);
+        if(shrunk)
+            ctx->tokens = shrunk;
+    }
+
     /* Set up the context */
     ctx->json5 = (char*)src->data;
     ctx->depth = 0;
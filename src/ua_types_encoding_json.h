@@ -12,6 +12,7 @@
 #include <open62541/types.h>
 
 #include "ua_util_internal.h"
+#include "ua_types_encoding_binary.h"
 
 #include "../deps/cj5.h"
 
@@ -20,10 +21,20 @@ _UA_BEGIN_DECLS
 #define UA_JSON_MAXTOKENCOUNT 256
 #define UA_JSON_ENCODING_MAX_RECURSION 100
 
+/* Objects are decoded via a hash table over the field names if they have at
+ * least this many entries. Below that, the linear search is faster. */
+#define UA_JSON_DECODEFIELDS_LOOKUPMIN 8
+
 typedef struct {
     uint8_t *pos;
     const uint8_t *end;
 
+    /* Called when the end of the buffer is reached. Flushes the buffer and
+     * sets up pos/end for the next buffer. Encoding fails with
+     * BADENCODINGLIMITSEXCEEDED if not set. */
+    UA_exchangeEncodeBuffer exchangeBufferCallback;
+    void *exchangeBufferCallbackHandle;
+
     uint16_t depth; /* How often did we en-/decoding recurse? */
     UA_Boolean commaNeeded[UA_JSON_ENCODING_MAX_RECURSION];
     UA_Boolean useReversible;
@@ -40,6 +51,32 @@ typedef struct {
     UA_Boolean stringNodeIds;
 } CtxJson;
 
+/* Encodes the value in the JSON encoding in a single pass. The output is
+ * streamed into the buffer between *bufPos and *bufEnd. When the end of the
+ * buffer is reached, the exchangeCallback is called to send out the content and
+ * to set up the next buffer (see UA_encodeBinaryInternal). Other than for the
+ * binary encoding, the output can be split at any byte position.
+ *
+ * @param src The value. Must not be NULL.
+ * @param type The value type. Must not be NULL.
+ * @param bufPos Points to a pointer to the current position in the encoding
+ *        buffer. Must not be NULL. Is advanced to the position after the last
+ *        encoded byte (in the last exchanged buffer).
+ * @param bufEnd Points to a pointer to the end of the encoding buffer. Must
+ *        not be NULL. The pointer is changed when the buffer is exchanged.
+ * @param exchangeCallback Called when the end of the buffer is reached. Is
+ *        ignored if NULL.
+ * @param exchangeHandle Custom data passed into the exchangeCallback.
+ * @param options The encoding options. Can be NULL.
+ * @return Returns a statuscode whether encoding succeeded. */
+UA_StatusCode
+UA_encodeJsonInternal(const void *src, const UA_DataType *type,
+                      UA_Byte **bufPos, const UA_Byte **bufEnd,
+                      UA_exchangeEncodeBuffer exchangeCallback,
+                      void *exchangeHandle,
+                      const UA_EncodeJsonOptions *options)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 UA_StatusCode writeJsonObjStart(CtxJson *ctx);
 UA_StatusCode writeJsonObjElm(CtxJson *ctx, const char *key,
                               const void *value, const UA_DataType *type);
@@ -59,6 +96,7 @@ UA_StatusCode writeJsonBeforeElement(CtxJson *ctx, UA_Boolean distinct);
 typedef struct {
     const char *json5;
     cj5_token *tokens;
+    cj5_token *grownTokens; /* Heap array while the tokenization grows it */
     unsigned int tokensSize;
     unsigned int index;
     UA_Byte depth;
@@ -105,6 +143,11 @@ extern const encodeJsonSignature encodeJsonJumpTable[UA_DATATYPEKINDS];
 extern const decodeJsonSignature decodeJsonJumpTable[UA_DATATYPEKINDS];
 
 UA_StatusCode lookAheadForKey(ParseCtx *ctx, const char *search, size_t *resultIndex);
+
+/* Tokenizes the input in a single pass. Starts with the token array in
+ * ctx->tokens (of length tokensSize) and moves to a heap-allocated array if more
+ * tokens are required. The caller has to free ctx->tokens if it differs from
+ * the initial array afterwards (also if an error is returned). */
 UA_StatusCode tokenize(ParseCtx *ctx, const UA_ByteString *src, size_t tokensSize);
 
 static UA_INLINE
@@ -386,10 +386,10 @@ UA_KeyValueMap_remove(UA_KeyValueMap *map,
      * around. Resize never fails when reducing the size to zero. Reduce the
      * size integer in any case. */
     UA_StatusCode res =
-        UA_Array_resize((void**)&map->map, &map->mapSize, map->mapSize - 1,
+        UA_Array_resize((void**)&map->map, &map->mapSize, s - 1,
                           &UA_TYPES[UA_TYPES_KEYVALUEPAIR]);
     (void)res;
-    map->mapSize--;
+    map->mapSize = s - 1;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -215,6 +215,47 @@ START_TEST(parseNegInf) {
     ck_assert_msg(val == -INFINITY, "val: %f", val);
 } END_TEST
 
+static cj5_token growTokens[32];
+
+static cj5_token *
+growTokensCallback(void *context, cj5_token *tokens, unsigned int *max_tokens) {
+    unsigned int *calls = (unsigned int*)context;
+    (*calls)++;
+    if(*max_tokens >= 32)
+        return NULL;
+    memcpy(growTokens, tokens, sizeof(cj5_token) * *max_tokens);
+    *max_tokens = 32;
+    return growTokens;
+}
+
+START_TEST(parseGrowTokens) {
+    const char *json = "{'a':{}, 'b':{'c':3}, 'd':true, 'e':false, 'f':null, 'g':[1,2,3]}";
+    cj5_token tokens[4];
+    unsigned int calls = 0;
+    cj5_options options;
+    memset(&options, 0, sizeof(cj5_options));
+    options.grow_tokens = growTokensCallback;
+    options.grow_tokens_context = &calls;
+    cj5_result r = cj5_parse(json, (unsigned int)strlen(json), tokens, 4, &options);
+    ck_assert(r.error == CJ5_ERROR_NONE);
+    ck_assert_uint_eq(calls, 1);
+    ck_assert_ptr_eq(r.tokens, growTokens);
+    ck_assert_uint_eq(r.num_tokens, 18);
+
+    /* The parent sizes are also correct for tokens written before growing */
+    ck_assert_uint_eq(growTokens[0].size, 12);
+    ck_assert_uint_eq(growTokens[4].size, 2);
+    ck_assert_uint_eq(growTokens[14].size, 3);
+
+    /* Overflow if the tokens cannot be grown far enough */
+    calls = 0;
+    const char *json2 = "[0,1,2,3,4,5,6,7,8,9,0,1,2,3,4,5,6,7,8,9,0,1,2,3,4,5,6,7,8,9,0,1,2]";
+    r = cj5_parse(json2, (unsigned int)strlen(json2), tokens, 4, &options);
+    ck_assert(r.error == CJ5_ERROR_OVERFLOW);
+    ck_assert_uint_eq(calls, 2);
+    ck_assert_uint_eq(r.num_tokens, 34);
+} END_TEST
+
 static Suite *testSuite_builtin_json(void) {
     TCase *tc_parse= tcase_create("cj5_parse");
     tcase_add_test(tc_parse, parseObject);
@@ -234,6 +275,7 @@ static Suite *testSuite_builtin_json(void) {
     tcase_add_test(tc_parse, parseValueStopEarly);
     tcase_add_test(tc_parse, parseInf);
     tcase_add_test(tc_parse, parseNegInf);
+    tcase_add_test(tc_parse, parseGrowTokens);
 
     Suite *s = suite_create("Test JSON decoding with the cj5 library");
     suite_add_tcase(s, tc_parse);
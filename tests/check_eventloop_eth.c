@@ -197,11 +197,136 @@ START_TEST(connectETH) {
     el = NULL;
 } END_TEST
 
+#define RING_MESSAGES 1000 /* More than the frames of the TX ring */
+#define RING_MSGSIZE 100
+
+static size_t ringReceived;
+static size_t ringNextSeq;
+
+static void
+ringCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+             void *application, void **connectionContext,
+             UA_ConnectionState status, const UA_KeyValueMap *params,
+             UA_ByteString msg) {
+    TestContext *ctx = (TestContext*) *connectionContext;
+    if(status == UA_CONNECTIONSTATE_CLOSING) {
+        ctx->connCount--;
+        return;
+    }
+    if(msg.length == 0) {
+        ctx->connCount++;
+        clientId = connectionId;
+        return;
+    }
+
+    /* The frames arrive in order. On the loopback interface the outgoing frame
+     * can be seen a second time. */
+    ck_assert_uint_ge(msg.length, RING_MSGSIZE);
+    size_t seq;
+    memcpy(&seq, msg.data, sizeof(size_t));
+    for(size_t i = sizeof(size_t); i < RING_MSGSIZE; i++)
+        ck_assert_uint_eq(msg.data[i], (UA_Byte)(seq + i));
+    if(seq + 1 == ringNextSeq)
+        return; /* Duplicate */
+    ck_assert_uint_eq(seq, ringNextSeq);
+    ringNextSeq++;
+    ringReceived++;
+}
+
+/* Send and receive through the PACKET_MMAP rings */
+START_TEST(ringETH) {
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_Ethernet(UA_STRING("ethCM"));
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    UA_String interface = UA_STRING(ETHERNET_INTERFACE);
+    UA_String address = UA_STRING(MULTICAST_MAC_ADDRESS);
+    UA_Boolean listen = true;
+    UA_Boolean ring = true;
+    UA_UInt16 etherType = 0xb62c; /* OPC UA PubSub EtherType */
+
+    UA_KeyValuePair params[5];
+    params[0].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "interface");
+    UA_Variant_setScalar(&params[1].value, &interface, &UA_TYPES[UA_TYPES_STRING]);
+    params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
+    UA_Variant_setScalar(&params[2].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+    params[3].key = UA_QUALIFIEDNAME(0, "ring");
+    UA_Variant_setScalar(&params[3].value, &ring, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[4].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[4].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext = {0};
+
+    /* Open the listen connection with an RX ring */
+    UA_KeyValueMap kvm = {4, &params[1]};
+    UA_StatusCode retval =
+        cm->openConnection(cm, &kvm, NULL, &testContext, ringCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(testContext.connCount, 1);
+
+    /* Open the send connection with a TX ring */
+    kvm.map = params;
+    clientId = 0;
+    retval = cm->openConnection(cm, &kvm, NULL, &testContext, ringCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(clientId != 0);
+    ck_assert_uint_eq(testContext.connCount, 2);
+
+    /* A frame that is released without sending is not transmitted. Both the
+     * last and an earlier reservation are released. */
+    UA_ByteString unsent1, unsent2;
+    retval = cm->allocNetworkBuffer(cm, clientId, &unsent1, RING_MSGSIZE);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cm->allocNetworkBuffer(cm, clientId, &unsent2, RING_MSGSIZE);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    cm->freeNetworkBuffer(cm, clientId, &unsent1);
+    cm->freeNetworkBuffer(cm, clientId, &unsent2);
+
+    /* Send the sequenced frames in bursts */
+    ringReceived = 0;
+    ringNextSeq = 0;
+    for(size_t sent = 0; sent < RING_MESSAGES; sent += 50) {
+        for(size_t j = 0; j < 50; j++) {
+            UA_ByteString snd;
+            retval = cm->allocNetworkBuffer(cm, clientId, &snd, RING_MSGSIZE);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            size_t seq = sent + j;
+            memcpy(snd.data, &seq, sizeof(size_t));
+            for(size_t i = sizeof(size_t); i < RING_MSGSIZE; i++)
+                snd.data[i] = (UA_Byte)(seq + i);
+            retval = cm->sendWithConnection(cm, clientId, NULL, &snd);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        for(size_t i = 0; i < 100 && ringReceived < sent + 50; i++)
+            el->run(el, 10);
+    }
+    ck_assert_uint_eq(ringReceived, RING_MESSAGES);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    ck_assert_uint_eq(testContext.connCount, 0);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test ETH EventLoop");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, listenETH);
     tcase_add_test(tc, connectETH);
+    tcase_add_test(tc, ringETH);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -0,0 +1,234 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Echo round-trips over thousands of TCP connections within a single
+ * EventLoop. Every client connection has one message in flight. Reports the
+ * round-trips per second, the latency percentiles and the number of EventLoop
+ * iterations. Run with and without UA_ENABLE_IO_URING to compare the backends.
+ * Count the syscalls externally (e.g. with strace -c -f). */
+
+#include <open62541/plugin/eventloop.h>
+#include <open62541/plugin/log_stdout.h>
+#include "open62541/types.h"
+#include "open62541/types_generated.h"
+
+#include "testing_clock.h"
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <check.h>
+
+#define CLIENTS 4096 /* Maximum number of client connections */
+#define ROUNDTRIPS 400000 /* Total number of echo round-trips */
+
+typedef struct {
+    uintptr_t connectionId;
+    struct timespec sent;
+} Client;
+
+static UA_EventLoop *el;
+static UA_ConnectionManager *cm;
+static Client clients[CLIENTS];
+static size_t clientCount;
+static size_t clientsConnected;
+static size_t connCount;
+static size_t sent;
+static size_t received;
+static double latencies[ROUNDTRIPS];
+static char *testMsg = "open62541";
+
+static double
+elapsed(const struct timespec *begin, const struct timespec *end) {
+    return (double)(end->tv_sec - begin->tv_sec) +
+        (double)(end->tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+static void
+sendMessage(uintptr_t connectionId) {
+    UA_ByteString snd;
+    UA_StatusCode res = cm->allocNetworkBuffer(cm, connectionId, &snd, strlen(testMsg));
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    memcpy(snd.data, testMsg, strlen(testMsg));
+    res = cm->sendWithConnection(cm, connectionId, NULL, &snd);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+sendFromClient(Client *c) {
+    clock_gettime(CLOCK_MONOTONIC, &c->sent);
+    sent++;
+    sendMessage(c->connectionId);
+}
+
+static void
+connectionCallback(UA_ConnectionManager *cman, uintptr_t connectionId,
+                   void *application, void **connectionContext,
+                   UA_ConnectionState status,
+                   const UA_KeyValueMap *params,
+                   UA_ByteString msg) {
+    Client *c = (Client*)*connectionContext;
+    if(status == UA_CONNECTIONSTATE_CLOSING) {
+        connCount--;
+        return;
+    }
+
+    if(msg.length == 0) {
+        if(status == UA_CONNECTIONSTATE_ESTABLISHED) {
+            connCount++;
+            if(c) {
+                c->connectionId = connectionId;
+                clientsConnected++;
+            }
+        }
+        return;
+    }
+
+    /* Server side: echo the message */
+    if(!c) {
+        sendMessage(connectionId);
+        return;
+    }
+
+    /* Client side: record the latency and send the next message */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    latencies[received++] = elapsed(&c->sent, &now);
+    if(sent < ROUNDTRIPS)
+        sendFromClient(c);
+}
+
+/* Every client connection takes two fds (client and server side). Raise the
+ * fd limit as far as possible and reduce the number of clients to fit. */
+static size_t
+maxClients(void) {
+    size_t fds = 0;
+    struct rlimit rl;
+    if(getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        getrlimit(RLIMIT_NOFILE, &rl);
+        fds = (rl.rlim_cur == RLIM_INFINITY) ? SIZE_MAX : (size_t)rl.rlim_cur;
+    }
+#if !defined(__linux__)
+    /* The select backend is limited to FD_SETSIZE */
+    if(fds > FD_SETSIZE)
+        fds = FD_SETSIZE;
+#endif
+    size_t max = (fds > 64) ? (fds - 64) / 2 : 1;
+    return (max < CLIENTS) ? max : CLIENTS;
+}
+
+static int
+cmpDouble(const void *a, const void *b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da < db) ? -1 : (da > db) ? 1 : 0;
+}
+
+START_TEST(echoSpeed) {
+    cm = UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcpCM"));
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    UA_UInt16 port = 4841;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("localhost");
+
+    UA_KeyValuePair params[3];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+
+    UA_KeyValueMap paramsMap;
+    paramsMap.map = params;
+    paramsMap.mapSize = 3;
+
+    UA_StatusCode res =
+        cm->openConnection(cm, &paramsMap, NULL, NULL, connectionCallback);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    size_t listenSockets = connCount;
+
+    /* Open the client connections. In batches below the listen backlog. */
+    clientCount = maxClients();
+    listen = false;
+    for(size_t i = 0; i < clientCount; i++) {
+        res = cm->openConnection(cm, &paramsMap, NULL, &clients[i],
+                                 connectionCallback);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        if((i + 1) % 64 != 0 && i + 1 < clientCount)
+            continue;
+        for(size_t j = 0; j < 1000 && connCount < listenSockets + 2 * (i + 1); j++)
+            el->run(el, 10);
+    }
+    ck_assert_uint_eq(clientsConnected, clientCount);
+    ck_assert_uint_eq(connCount, listenSockets + 2 * clientCount);
+
+    /* Echo round-trips */
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(size_t i = 0; i < clientCount; i++)
+        sendFromClient(&clients[i]);
+    size_t iterations = 0;
+    while(received < ROUNDTRIPS) {
+        el->run(el, 100);
+        iterations++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double duration = elapsed(&begin, &end);
+    qsort(latencies, ROUNDTRIPS, sizeof(double), cmpDouble);
+#ifdef UA_ENABLE_IO_URING
+    const char *backend = "io_uring";
+#else
+    const char *backend = "epoll/select";
+#endif
+    printf("%s: %u clients, %u round-trips\n", backend,
+           (unsigned)clientCount, (unsigned)ROUNDTRIPS);
+    printf("duration was %f s\n", duration);
+    printf("round-trips per second: %.0f\n", (double)ROUNDTRIPS / duration);
+    printf("latency p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+           latencies[ROUNDTRIPS / 2] * 1e6,
+           latencies[(ROUNDTRIPS * 99) / 100] * 1e6,
+           latencies[(ROUNDTRIPS * 999) / 1000] * 1e6,
+           latencies[ROUNDTRIPS - 1] * 1e6);
+    printf("EventLoop iterations: %u (%.1f round-trips per iteration)\n",
+           (unsigned)iterations, (double)ROUNDTRIPS / (double)iterations);
+
+    /* Close the client connections */
+    for(size_t i = 0; i < clientCount; i++)
+        cm->closeConnection(cm, clients[i].connectionId);
+    for(size_t i = 0; i < 1000 && connCount > listenSockets; i++)
+        el->run(el, 10);
+    ck_assert_uint_eq(connCount, listenSockets);
+
+    /* Stop the EventLoop */
+    el->stop(el);
+    for(size_t i = 0; i < 1000 && el->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        el->run(el, 10);
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("Test TCP EventLoop Speed");
+    TCase *tc = tcase_create("test cases");
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, echoSpeed);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all (sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
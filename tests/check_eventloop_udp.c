@@ -16,6 +16,7 @@ static UA_EventLoop *el;
 static char *testMsg = "open62541";
 static uintptr_t clientId;
 static UA_Boolean received;
+static size_t receivedCount;
 
 typedef struct TestContext {
     unsigned connCount;
@@ -62,6 +63,7 @@ connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         UA_ByteString rcv = UA_BYTESTRING(testMsg);
         ck_assert(UA_String_equal(&msg, &rcv));
         received = true;
+        receivedCount++;
     }
 }
 
@@ -394,6 +396,228 @@ START_TEST(udpTalkerAndListener) {
     ck_assert_uint_eq(testContext.connCount, 0);
 } END_TEST
 
+#ifdef __linux__ /* Batching requires recvmmsg/sendmmsg */
+START_TEST(udpFlushSendQueue) {
+    UA_EventLoop *elListener = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_ConnectionManager *cmListener = UA_ConnectionManager_new_POSIX_UDP(UA_STRING("udpCM"));
+    elListener->registerEventSource(elListener, &cmListener->eventSource);
+    elListener->start(elListener);
+
+    /* The talker queues up to four messages */
+    UA_EventLoop *elTalker = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_ConnectionManager *cmTalker = UA_ConnectionManager_new_POSIX_UDP(UA_STRING("udpCM"));
+    UA_UInt16 batchSize = 4;
+    UA_KeyValueMap_setScalar(&cmTalker->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "send-batchsize"), &batchSize,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    elTalker->registerEventSource(elTalker, &cmTalker->eventSource);
+    elTalker->start(elTalker);
+
+    /* Open a listener connection */
+    UA_UInt16 port = 30000;
+    UA_Boolean listen = true;
+
+    UA_KeyValuePair params[3];
+    UA_KeyValueMap paramsMap = {2, params}; /* Hide some parameters */
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+
+    UA_StatusCode retval =
+        cmListener->openConnection(cmListener, &paramsMap, NULL, &testContext,
+                                   connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Open a talker connection */
+    clientId = 0;
+    listen = false;
+
+    UA_String targetHost = UA_STRING("localhost");
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &targetHost, &UA_TYPES[UA_TYPES_STRING]);
+    paramsMap.mapSize = 3;
+
+    retval = cmTalker->openConnection(cmTalker, &paramsMap, NULL, &testContext,
+                                      connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(clientId, 0);
+
+    /* Messages sent with the "more" parameter wait in the queue */
+    UA_Boolean flag = true;
+    UA_KeyValuePair sendParam;
+    UA_KeyValueMap sendParams = {1, &sendParam};
+    sendParam.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&sendParam.value, &flag, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    receivedCount = 0;
+    for(size_t i = 0; i < 3; i++) {
+        UA_ByteString snd;
+        retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, strlen(testMsg));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        memcpy(snd.data, testMsg, strlen(testMsg));
+        retval = cmTalker->sendWithConnection(cmTalker, clientId, &sendParams, &snd);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    for(size_t i = 0; i < 2; i++) {
+        UA_DateTime next = elListener->run(elListener, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_eq(receivedCount, 0);
+
+    /* The flush sends out the queued messages only */
+    sendParam.key = UA_QUALIFIEDNAME(0, "flush");
+    UA_ByteString empty = UA_BYTESTRING_NULL;
+    retval = cmTalker->sendWithConnection(cmTalker, clientId, &sendParams, &empty);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 4; i++) {
+        UA_DateTime next = elListener->run(elListener, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_eq(receivedCount, 3);
+
+    /* Stop the Talker EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    elTalker->stop(elTalker);
+    while(elTalker->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = elTalker->run(elTalker, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert_int_eq(elTalker->state, UA_EVENTLOOPSTATE_STOPPED);
+    elTalker->free(elTalker);
+    elTalker = NULL;
+
+    /* Stop the Listener EventLoop */
+    max_stop_iteration_count = 10;
+    iteration = 0;
+    elListener->stop(elListener);
+    while(elListener->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = elListener->run(elListener, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(elListener->state == UA_EVENTLOOPSTATE_STOPPED);
+    elListener->free(elListener);
+    elListener = NULL;
+
+    ck_assert_uint_eq(testContext.connCount, 0);
+} END_TEST
+
+/* Datagrams that do not fit into the rx buffer slot are dropped */
+START_TEST(udpBatchDropTruncated) {
+    UA_EventLoop *elListener = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_ConnectionManager *cmListener = UA_ConnectionManager_new_POSIX_UDP(UA_STRING("udpCM"));
+    UA_UInt16 batchSize = 4;
+    UA_UInt32 bufSize = 16;
+    UA_KeyValueMap_setScalar(&cmListener->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "recv-batchsize"), &batchSize,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    UA_KeyValueMap_setScalar(&cmListener->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "recv-bufsize"), &bufSize,
+                             &UA_TYPES[UA_TYPES_UINT32]);
+    elListener->registerEventSource(elListener, &cmListener->eventSource);
+    elListener->start(elListener);
+
+    UA_EventLoop *elTalker = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    UA_ConnectionManager *cmTalker = UA_ConnectionManager_new_POSIX_UDP(UA_STRING("udpCM"));
+    elTalker->registerEventSource(elTalker, &cmTalker->eventSource);
+    elTalker->start(elTalker);
+
+    /* Open a listener connection */
+    UA_UInt16 port = 30000;
+    UA_Boolean listen = true;
+
+    UA_KeyValuePair params[3];
+    UA_KeyValueMap paramsMap = {2, params}; /* Hide some parameters */
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+
+    UA_StatusCode retval =
+        cmListener->openConnection(cmListener, &paramsMap, NULL, &testContext,
+                                   connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    size_t listenSockets = testContext.connCount;
+
+    /* Open a talker connection */
+    clientId = 0;
+    listen = false;
+
+    UA_String targetHost = UA_STRING("localhost");
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &targetHost, &UA_TYPES[UA_TYPES_STRING]);
+    paramsMap.mapSize = 3;
+
+    retval = cmTalker->openConnection(cmTalker, &paramsMap, NULL, &testContext,
+                                      connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(clientId, 0);
+
+    /* Send a message larger than the rx buffer slot. Then the test message. */
+    UA_ByteString snd;
+    retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, 64);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    memset(snd.data, 'x', 64);
+    retval = cmTalker->sendWithConnection(cmTalker, clientId, &UA_KEYVALUEMAP_NULL, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cmTalker->allocNetworkBuffer(cmTalker, clientId, &snd, strlen(testMsg));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    memcpy(snd.data, testMsg, strlen(testMsg));
+    retval = cmTalker->sendWithConnection(cmTalker, clientId, &UA_KEYVALUEMAP_NULL, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Only the test message is forwarded. The listener stays open. */
+    receivedCount = 0;
+    for(size_t i = 0; i < 4; i++) {
+        UA_DateTime next = elListener->run(elListener, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+    }
+    ck_assert_uint_eq(receivedCount, 1);
+    ck_assert_uint_eq(testContext.connCount, listenSockets + 1);
+
+    /* Stop the Talker EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    elTalker->stop(elTalker);
+    while(elTalker->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = elTalker->run(elTalker, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert_int_eq(elTalker->state, UA_EVENTLOOPSTATE_STOPPED);
+    elTalker->free(elTalker);
+    elTalker = NULL;
+
+    /* Stop the Listener EventLoop */
+    max_stop_iteration_count = 10;
+    iteration = 0;
+    elListener->stop(elListener);
+    while(elListener->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        UA_DateTime next = elListener->run(elListener, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(elListener->state == UA_EVENTLOOPSTATE_STOPPED);
+    elListener->free(elListener);
+    elListener = NULL;
+
+    ck_assert_uint_eq(testContext.connCount, 0);
+} END_TEST
+#endif
+
 START_TEST(udpTalkerAndListenerDifferentDestination) {
     /* create listener eventloop */
     UA_EventLoop *elListener = UA_EventLoop_new_POSIX(UA_Log_Stdout);
@@ -526,6 +750,10 @@ int main(void) {
     tcase_add_test(tc, connectUDPValidationSucceeds);
     tcase_add_test(tc, udpTalkerAndListener);
     tcase_add_test(tc, udpTalkerAndListenerDifferentDestination);
+#ifdef __linux__
+    tcase_add_test(tc, udpFlushSendQueue);
+    tcase_add_test(tc, udpBatchDropTruncated);
+#endif
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -0,0 +1,186 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Bursts of UDP datagrams over loopback within a single EventLoop. Every burst
+ * is sent with the "more" parameter and received before the next burst is
+ * sent. Reports the messages per second and the number of EventLoop iterations
+ * with and without recvmmsg/sendmmsg batching. */
+
+#include <open62541/plugin/eventloop.h>
+#include <open62541/plugin/log_stdout.h>
+#include "open62541/types.h"
+#include "open62541/types_generated.h"
+
+#include "testing_clock.h"
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+#define MESSAGES 200000 /* Total number of datagrams */
+#define BURST 32 /* Datagrams sent back-to-back */
+#define MSGSIZE 64 /* Size of a datagram */
+
+static UA_EventLoop *el;
+static UA_ConnectionManager *cm;
+static uintptr_t sendConnection;
+static size_t connCount;
+static size_t received;
+static UA_Boolean outOfOrder;
+
+static double
+elapsed(const struct timespec *begin, const struct timespec *end) {
+    return (double)(end->tv_sec - begin->tv_sec) +
+        (double)(end->tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+static void
+connectionCallback(UA_ConnectionManager *cman, uintptr_t connectionId,
+                   void *application, void **connectionContext,
+                   UA_ConnectionState status,
+                   const UA_KeyValueMap *params,
+                   UA_ByteString msg) {
+    if(status == UA_CONNECTIONSTATE_CLOSING) {
+        connCount--;
+        return;
+    }
+
+    if(msg.length == 0) {
+        if(status == UA_CONNECTIONSTATE_ESTABLISHED) {
+            connCount++;
+            if(*connectionContext)
+                sendConnection = connectionId;
+        }
+        return;
+    }
+
+    /* The datagrams carry a sequence number */
+    size_t seq;
+    memcpy(&seq, msg.data, sizeof(size_t));
+    if(seq != received)
+        outOfOrder = true;
+    received++;
+}
+
+static void
+sendBurst(size_t first, size_t count) {
+    UA_Boolean more = true;
+    UA_KeyValuePair kvp;
+    kvp.key = UA_QUALIFIEDNAME(0, "more");
+    UA_Variant_setScalar(&kvp.value, &more, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap kvm = {1, &kvp};
+
+    for(size_t i = 0; i < count; i++) {
+        UA_ByteString snd;
+        UA_StatusCode res =
+            cm->allocNetworkBuffer(cm, sendConnection, &snd, MSGSIZE);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        memset(snd.data, 0, MSGSIZE);
+        size_t seq = first + i;
+        memcpy(snd.data, &seq, sizeof(size_t));
+        more = (i + 1 < count);
+        res = cm->sendWithConnection(cm, sendConnection, &kvm, &snd);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void
+runBursts(UA_UInt16 batchSize) {
+    cm = UA_ConnectionManager_new_POSIX_UDP(UA_STRING("udpCM"));
+    UA_KeyValueMap_setScalar(&cm->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "recv-batchsize"), &batchSize,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    UA_KeyValueMap_setScalar(&cm->eventSource.params,
+                             UA_QUALIFIEDNAME(0, "send-batchsize"), &batchSize,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    UA_UInt16 port = 4842;
+    UA_Boolean listen = true;
+    UA_String host = UA_STRING("127.0.0.1");
+
+    UA_KeyValuePair params[3];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    UA_KeyValueMap paramsMap = {3, params};
+
+    connCount = 0;
+    received = 0;
+    outOfOrder = false;
+    sendConnection = 0;
+
+    UA_StatusCode res =
+        cm->openConnection(cm, &paramsMap, NULL, NULL, connectionCallback);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(connCount, 1);
+
+    /* Open the sending connection. The context marks the sender. */
+    listen = false;
+    res = cm->openConnection(cm, &paramsMap, NULL, (void*)0x01, connectionCallback);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(sendConnection != 0);
+
+    /* Send and receive the bursts */
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    size_t iterations = 0;
+    for(size_t sent = 0; sent < MESSAGES; sent += BURST) {
+        sendBurst(sent, BURST);
+        for(size_t i = 0; i < 1000 && received < sent + BURST; i++) {
+            el->run(el, 100);
+            iterations++;
+        }
+        ck_assert_uint_eq(received, sent + BURST);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ck_assert(!outOfOrder);
+
+    double duration = elapsed(&begin, &end);
+    printf("batch size %u: %u messages in bursts of %u\n", (unsigned)batchSize,
+           (unsigned)MESSAGES, (unsigned)BURST);
+    printf("duration was %f s\n", duration);
+    printf("messages per second: %.0f\n", (double)MESSAGES / duration);
+    printf("EventLoop iterations: %u (%.1f messages per iteration)\n",
+           (unsigned)iterations, (double)MESSAGES / (double)iterations);
+
+    /* Stop the EventLoop */
+    el->stop(el);
+    for(size_t i = 0; i < 1000 && el->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        el->run(el, 10);
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    ck_assert_uint_eq(connCount, 0);
+    el->free(el);
+    el = NULL;
+}
+
+START_TEST(burstSpeedUnbatched) {
+    runBursts(1);
+} END_TEST
+
+START_TEST(burstSpeedBatched) {
+    runBursts(BURST);
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("Test UDP EventLoop Speed");
+    TCase *tc = tcase_create("test cases");
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, burstSpeedUnbatched);
+    tcase_add_test(tc, burstSpeedBatched);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all (sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
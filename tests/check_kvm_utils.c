@@ -82,6 +82,34 @@ START_TEST(CheckKVMCopy) {
 }
 END_TEST
 
+START_TEST(CheckKVMRemove) {
+        UA_KeyValueMap *kvm = keyValueMap_setup(3, 0, 0);
+
+        UA_StatusCode res = UA_KeyValueMap_remove(kvm, UA_QUALIFIEDNAME(0, "key01"));
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(kvm->mapSize, 2);
+        ck_assert(UA_KeyValueMap_contains(kvm, UA_QUALIFIEDNAME(0, "key00")));
+        ck_assert(!UA_KeyValueMap_contains(kvm, UA_QUALIFIEDNAME(0, "key01")));
+        ck_assert(UA_KeyValueMap_contains(kvm, UA_QUALIFIEDNAME(0, "key02")));
+
+        res = UA_KeyValueMap_remove(kvm, UA_QUALIFIEDNAME(0, "key01"));
+        ck_assert_uint_eq(res, UA_STATUSCODE_BADNOTFOUND);
+        ck_assert_uint_eq(kvm->mapSize, 2);
+
+        res = UA_KeyValueMap_remove(kvm, UA_QUALIFIEDNAME(0, "key00"));
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(kvm->mapSize, 1);
+        ck_assert(UA_KeyValueMap_contains(kvm, UA_QUALIFIEDNAME(0, "key02")));
+
+        res = UA_KeyValueMap_remove(kvm, UA_QUALIFIEDNAME(0, "key02"));
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(kvm->mapSize, 0);
+        ck_assert(UA_KeyValueMap_isEmpty(kvm));
+
+        UA_KeyValueMap_delete(kvm);
+}
+END_TEST
+
 START_TEST(CheckKVMCountMergedIntersecting) {
         UA_KeyValueMap *kvmLhs = keyValueMap_setup(10, 0, 0);
         UA_KeyValueMap *kvmRhs = keyValueMap_setup(10, 5, 10);
@@ -167,6 +195,7 @@ int main(void) {
     tcase_add_test(tc, CheckNullArgs);
     tcase_add_test(tc, CheckKVMContains);
     tcase_add_test(tc, CheckKVMCopy);
+    tcase_add_test(tc, CheckKVMRemove);
     tcase_add_test(tc, CheckKVMCountMergedIntersecting);
     tcase_add_test(tc, CheckKVMCountMergedComplementary);
     tcase_add_test(tc, CheckKVMCountMergedCommon);
@@ -1203,6 +1203,20 @@ START_TEST(UA_Array_copyUA_StringShallWorkOnExample) {
 }
 END_TEST
 
+START_TEST(UA_Array_copyShallFailOnSizeOverflow) {
+    // given
+    UA_UInt32 srcArray[2] = {1, 2};
+    void *dstArray = NULL;
+    //when
+    UA_StatusCode retval =
+        UA_Array_copy(srcArray, (SIZE_MAX / sizeof(UA_UInt32)) + 1,
+                      &dstArray, &UA_TYPES[UA_TYPES_UINT32]);
+    //then
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADOUTOFMEMORY);
+    ck_assert_ptr_eq(dstArray, NULL);
+}
+END_TEST
+
 START_TEST(UA_DiagnosticInfo_copyShallWorkOnExample) {
     //given
     UA_DiagnosticInfo value, innerValue, copiedValue;
@@ -1785,6 +1799,7 @@ static Suite *testSuite_builtin(void) {
     TCase *tc_copy = tcase_create("copy");
     tcase_add_test(tc_copy, UA_Array_copyByteArrayShallWorkOnExample);
     tcase_add_test(tc_copy, UA_Array_copyUA_StringShallWorkOnExample);
+    tcase_add_test(tc_copy, UA_Array_copyShallFailOnSizeOverflow);
     tcase_add_test(tc_copy, UA_ExtensionObject_copyShallWorkOnExample);
     tcase_add_test(tc_copy, UA_Variant_copyShallWorkOnSingleValueExample);
     tcase_add_test(tc_copy, UA_Variant_copyShallWorkOn1DArrayExample);
@@ -5438,6 +5438,84 @@ START_TEST(UA_JsonHelper) {
 }
 END_TEST
 
+/* Collects the streamed chunks and hands out a small buffer for the next
+ * chunk */
+typedef struct {
+    UA_Byte chunk[7];
+    UA_ByteString collected;
+    size_t chunks;
+} StreamCtx;
+
+static UA_StatusCode
+collectChunk(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    StreamCtx *sc = (StreamCtx*)handle;
+    size_t len = (size_t)(*bufPos - sc->chunk);
+    memcpy(&sc->collected.data[sc->collected.length], sc->chunk, len);
+    sc->collected.length += len;
+    sc->chunks++;
+    *bufPos = sc->chunk;
+    *bufEnd = &sc->chunk[sizeof(sc->chunk)];
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(UA_ReadResponse_json_encode_stream) {
+    UA_ReadResponse rr;
+    UA_ReadResponse_init(&rr);
+    rr.responseHeader.timestamp = UA_DateTime_fromUnixTime(1234567);
+    rr.responseHeader.requestHandle = 42;
+    UA_DataValue dv[3];
+    for(size_t i = 0; i < 3; i++)
+        UA_DataValue_init(&dv[i]);
+    UA_String str = UA_STRING("escaped \"\\\n\t text");
+    UA_Variant_setScalar(&dv[0].value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    dv[0].hasValue = true;
+    UA_Guid guid = {1, 2, 3, {4, 5, 6, 7, 8, 9, 10, 11}};
+    UA_Variant_setScalar(&dv[1].value, &guid, &UA_TYPES[UA_TYPES_GUID]);
+    dv[1].hasValue = true;
+    dv[1].sourceTimestamp = UA_DateTime_fromUnixTime(7654321);
+    dv[1].hasSourceTimestamp = true;
+    UA_Double doubles[4] = {1.5, -2.25, 1e300, 0.0};
+    UA_Variant_setArray(&dv[2].value, doubles, 4, &UA_TYPES[UA_TYPES_DOUBLE]);
+    dv[2].hasValue = true;
+    dv[2].status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+    dv[2].hasStatus = true;
+    rr.results = dv;
+    rr.resultsSize = 3;
+
+    /* Encode in one piece. The output buffer is allocated internally. */
+    const UA_DataType *type = &UA_TYPES[UA_TYPES_READRESPONSE];
+    UA_ByteString whole = UA_BYTESTRING_NULL;
+    UA_StatusCode s = UA_encodeJson(&rr, type, &whole, NULL);
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(whole.length, UA_calcSizeJson(&rr, type, NULL));
+
+    /* Encode streaming with small chunks */
+    StreamCtx sc;
+    memset(&sc, 0, sizeof(StreamCtx));
+    s = UA_ByteString_allocBuffer(&sc.collected, whole.length);
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+    sc.collected.length = 0;
+    UA_Byte *bufPos = sc.chunk;
+    const UA_Byte *bufEnd = &sc.chunk[sizeof(sc.chunk)];
+    s = UA_encodeJsonInternal(&rr, type, &bufPos, &bufEnd,
+                              collectChunk, &sc, NULL);
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+    s = collectChunk(&sc, &bufPos, &bufEnd); /* Flush the last chunk */
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(sc.chunks, 10);
+    ck_assert(UA_ByteString_equal(&whole, &sc.collected));
+
+    /* Without the callback the encoding fails at the end of the buffer */
+    bufPos = sc.chunk;
+    bufEnd = &sc.chunk[sizeof(sc.chunk)];
+    s = UA_encodeJsonInternal(&rr, type, &bufPos, &bufEnd, NULL, NULL, NULL);
+    ck_assert_int_eq(s, UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);
+
+    UA_ByteString_clear(&whole);
+    UA_ByteString_clear(&sc.collected);
+}
+END_TEST
+
 /* ----------------- Public API ---------------------*/
 START_TEST(UA_VariantBool_public_json_decode) {
     // given
@@ -5851,6 +5929,7 @@ static Suite *testSuite_builtin_json(void) {
 
     TCase *tc_json_helper = tcase_create("json_helper");
     tcase_add_test(tc_json_decode, UA_JsonHelper);
+    tcase_add_test(tc_json_helper, UA_ReadResponse_json_encode_stream);
     suite_add_tcase(s, tc_json_helper);
     return s;
 }
@@ -0,0 +1,139 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure how fast we can copy and clear the DataValues of a ReadResponse */
+
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define RESULTS 1000 /* Number of DataValues in the response */
+#define COPIES 1000 /* Number of copies to perform */
+
+static UA_DataValue *results;
+
+static void setup(void) {
+    results = (UA_DataValue*)
+        UA_Array_new(RESULTS, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    ck_assert_ptr_ne(results, NULL);
+    for(size_t i = 0; i < RESULTS; i++) {
+        UA_DataValue *dv = &results[i];
+        UA_Double d = (UA_Double)i;
+        if(i % 2 == 0) {
+            UA_Variant_setScalarCopy(&dv->value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+        } else {
+            UA_String s = UA_STRING("Value of a string variable");
+            UA_Variant_setScalarCopy(&dv->value, &s, &UA_TYPES[UA_TYPES_STRING]);
+        }
+        dv->hasValue = true;
+        dv->sourceTimestamp = UA_DateTime_now();
+        dv->hasSourceTimestamp = true;
+        dv->serverTimestamp = dv->sourceTimestamp;
+        dv->hasServerTimestamp = true;
+    }
+}
+
+static void teardown(void) {
+    UA_Array_delete(results, RESULTS, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+START_TEST(copyDataValueSpeed) {
+    UA_DataValue dst;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    clock_t begin, finish;
+    begin = clock();
+
+    for(size_t i = 0; i < COPIES; i++) {
+        for(size_t j = 0; j < RESULTS; j++) {
+            retval |= UA_DataValue_copy(&results[j], &dst);
+            UA_DataValue_clear(&dst);
+        }
+    }
+
+    finish = clock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    printf("DataValue copy: duration was %f s\n",
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+} END_TEST
+
+START_TEST(copyResponseSpeed) {
+    UA_ReadResponse src;
+    UA_ReadResponse_init(&src);
+    src.results = results;
+    src.resultsSize = RESULTS;
+
+    UA_ReadResponse dst;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    clock_t begin, finish;
+    begin = clock();
+
+    for(size_t i = 0; i < COPIES; i++) {
+        retval |= UA_ReadResponse_copy(&src, &dst);
+        UA_ReadResponse_clear(&dst);
+    }
+
+    finish = clock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    printf("ReadResponse copy: duration was %f s\n",
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+
+    /* Check the copied values */
+    retval = UA_ReadResponse_copy(&src, &dst);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(dst.resultsSize, RESULTS);
+    for(size_t j = 0; j < RESULTS; j++)
+        ck_assert(UA_order(&src.results[j], &dst.results[j],
+                           &UA_TYPES[UA_TYPES_DATAVALUE]) == UA_ORDER_EQ);
+    UA_ReadResponse_clear(&dst);
+} END_TEST
+
+START_TEST(copyPointerFreeArraySpeed) {
+    UA_DateTime *src = (UA_DateTime*)
+        UA_Array_new(RESULTS, &UA_TYPES[UA_TYPES_DATETIME]);
+    ck_assert_ptr_ne(src, NULL);
+    for(size_t j = 0; j < RESULTS; j++)
+        src[j] = (UA_DateTime)j;
+
+    UA_DateTime *dst = NULL;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    clock_t begin, finish;
+    begin = clock();
+
+    for(size_t i = 0; i < COPIES * 10; i++) {
+        retval |= UA_Array_copy(src, RESULTS, (void**)&dst,
+                                &UA_TYPES[UA_TYPES_DATETIME]);
+        UA_Array_delete(dst, RESULTS, &UA_TYPES[UA_TYPES_DATETIME]);
+    }
+
+    finish = clock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    printf("DateTime array copy: duration was %f s\n",
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+
+    UA_Array_delete(src, RESULTS, &UA_TYPES[UA_TYPES_DATETIME]);
+} END_TEST
+
+static Suite *testSuite_copySpeed(void) {
+    Suite *s = suite_create("Copy Speed");
+    TCase *tc = tcase_create("ReadResponse");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, copyDataValueSpeed);
+    tcase_add_test(tc, copyResponseSpeed);
+    tcase_add_test(tc, copyPointerFreeArraySpeed);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_copySpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,237 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure how fast we can decode JSON objects of structures with many members.
+ * The keys are encoded in the order of the structure members and shuffled.
+ * Also measure the tokenization of large inputs. */
+
+#include <open62541/types.h>
+
+#include "ua_types_encoding_json.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define MEMBERS 64 /* Number of members of the structure */
+#define DECODES 10000 /* Number of decodings to perform */
+#define ARRAYLENGTH 100000 /* Length of the array for tokenization */
+#define TOKENIZES 20 /* Number of tokenizations to perform */
+
+typedef struct {
+    UA_Int32 fields[MEMBERS];
+} LargeStruct;
+
+static char memberNames[MEMBERS][16];
+static UA_DataTypeMember largeMembers[MEMBERS];
+static UA_DataType largeType;
+
+static void setup(void) {
+    for(size_t i = 0; i < MEMBERS; i++) {
+        snprintf(memberNames[i], 16, "Field%02u", (unsigned)i);
+        largeMembers[i].memberName = memberNames[i];
+        largeMembers[i].memberType = &UA_TYPES[UA_TYPES_INT32];
+        largeMembers[i].padding = 0;
+        largeMembers[i].isArray = false;
+        largeMembers[i].isOptional = false;
+    }
+    largeType.typeName = "LargeStruct";
+    largeType.typeId = UA_NODEID_NUMERIC(1, 4711);
+    largeType.binaryEncodingId = UA_NODEID_NUMERIC(1, 4712);
+    largeType.memSize = sizeof(LargeStruct);
+    largeType.typeKind = UA_DATATYPEKIND_STRUCTURE;
+    largeType.pointerFree = true;
+    largeType.overlayable = false;
+    largeType.membersSize = MEMBERS;
+    largeType.members = largeMembers;
+}
+
+/* Print the JSON object with the keys in the order of the permutation */
+static void
+printObject(UA_ByteString *buf, const size_t *order) {
+    size_t pos = 0;
+    buf->data[pos++] = '{';
+    for(size_t i = 0; i < MEMBERS; i++) {
+        pos += (size_t)snprintf((char*)&buf->data[pos], buf->length - pos,
+                                "%s\"%s\":%u", (i > 0) ? "," : "",
+                                memberNames[order[i]], (unsigned)order[i]);
+    }
+    buf->data[pos++] = '}';
+    buf->length = pos;
+}
+
+static void
+decodeSpeed(UA_Boolean shuffle) {
+    size_t order[MEMBERS];
+    for(size_t i = 0; i < MEMBERS; i++)
+        order[i] = i;
+
+    /* Deterministic Fisher-Yates shuffle */
+    if(shuffle) {
+        UA_UInt32 seed = 42;
+        for(size_t i = MEMBERS - 1; i > 0; i--) {
+            seed = seed * 1103515245 + 12345;
+            size_t j = (seed >> 16) % (i + 1);
+            size_t tmp = order[i];
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+    }
+
+    UA_ByteString buf;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, MEMBERS * 24);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    printObject(&buf, order);
+
+    LargeStruct out;
+    clock_t begin, finish;
+    begin = clock();
+
+    for(size_t i = 0; i < DECODES; i++) {
+        retval |= UA_decodeJson(&buf, &out, &largeType, NULL);
+        UA_clear(&out, &largeType);
+    }
+
+    finish = clock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%s: duration was %f s\n", shuffle ? "shuffled" : "in order",
+           time_spent);
+
+    /* Check the decoded values */
+    retval = UA_decodeJson(&buf, &out, &largeType, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < MEMBERS; i++)
+        ck_assert_int_eq(out.fields[i], (UA_Int32)i);
+
+    UA_ByteString_clear(&buf);
+}
+
+START_TEST(decodeSpeedInOrder) {
+    decodeSpeed(false);
+} END_TEST
+
+START_TEST(decodeSpeedShuffled) {
+    decodeSpeed(true);
+} END_TEST
+
+START_TEST(decodeDuplicateKey) {
+    size_t order[MEMBERS];
+    for(size_t i = 0; i < MEMBERS; i++)
+        order[i] = MEMBERS - 1 - i;
+    order[MEMBERS - 1] = order[0]; /* Duplicate the first key at the end */
+
+    UA_ByteString buf;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, MEMBERS * 24);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    printObject(&buf, order);
+
+    LargeStruct out;
+    retval = UA_decodeJson(&buf, &out, &largeType, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADDECODINGERROR);
+
+    UA_ByteString_clear(&buf);
+} END_TEST
+
+/* Variant with a large Int32 array */
+static void
+printLargeVariant(UA_ByteString *buf) {
+    UA_StatusCode retval = UA_ByteString_allocBuffer(buf, ARRAYLENGTH * 8 + 32);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    size_t pos = (size_t)snprintf((char*)buf->data, buf->length,
+                                  "{\"Type\":6,\"Body\":[");
+    for(size_t i = 0; i < ARRAYLENGTH; i++) {
+        pos += (size_t)snprintf((char*)&buf->data[pos], buf->length - pos,
+                                "%s%u", (i > 0) ? "," : "", (unsigned)i);
+    }
+    buf->data[pos++] = ']';
+    buf->data[pos++] = '}';
+    buf->length = pos;
+}
+
+START_TEST(tokenizeSpeed) {
+    UA_ByteString buf;
+    printLargeVariant(&buf);
+
+    /* Count the required tokens first, then tokenize into an array of the
+     * exact size */
+    cj5_token tokens[UA_JSON_MAXTOKENCOUNT];
+    unsigned int numTokens = 0;
+    clock_t begin, finish;
+    begin = clock();
+    for(size_t i = 0; i < TOKENIZES; i++) {
+        cj5_result r = cj5_parse((char*)buf.data, (unsigned int)buf.length,
+                                 tokens, UA_JSON_MAXTOKENCOUNT, NULL);
+        ck_assert(r.error == CJ5_ERROR_OVERFLOW);
+        cj5_token *heapTokens = (cj5_token*)
+            UA_malloc(sizeof(cj5_token) * r.num_tokens);
+        ck_assert_ptr_ne(heapTokens, NULL);
+        r = cj5_parse((char*)buf.data, (unsigned int)buf.length,
+                      heapTokens, r.num_tokens, NULL);
+        ck_assert(r.error == CJ5_ERROR_NONE);
+        numTokens = r.num_tokens;
+        UA_free(heapTokens);
+    }
+    finish = clock();
+    printf("count and reparse: duration was %f s, %u tokens (%lu bytes)\n",
+           (double)(finish - begin) / CLOCKS_PER_SEC, numTokens,
+           (unsigned long)(numTokens * sizeof(cj5_token)));
+
+    /* Tokenize in a single pass and grow the token array */
+    begin = clock();
+    for(size_t i = 0; i < TOKENIZES; i++) {
+        ParseCtx ctx;
+        memset(&ctx, 0, sizeof(ParseCtx));
+        ctx.tokens = tokens;
+        UA_StatusCode retval = tokenize(&ctx, &buf, UA_JSON_MAXTOKENCOUNT);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(ctx.tokensSize, numTokens);
+        ck_assert_ptr_ne(ctx.tokens, tokens);
+        UA_free(ctx.tokens);
+    }
+    finish = clock();
+    printf("single pass: duration was %f s\n",
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+
+    /* Decode the full variant */
+    UA_Variant out;
+    begin = clock();
+    for(size_t i = 0; i < TOKENIZES; i++) {
+        UA_StatusCode retval =
+            UA_decodeJson(&buf, &out, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(out.arrayLength, ARRAYLENGTH);
+        UA_Variant_clear(&out);
+    }
+    finish = clock();
+    printf("decode: duration was %f s\n",
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+
+    UA_ByteString_clear(&buf);
+} END_TEST
+
+static Suite *testSuite_decodeSpeed(void) {
+    Suite *s = suite_create("JSON Decode Speed");
+    TCase *tc = tcase_create("Structure with many members");
+    tcase_add_checked_fixture(tc, setup, NULL);
+    tcase_add_test(tc, decodeSpeedInOrder);
+    tcase_add_test(tc, decodeSpeedShuffled);
+    tcase_add_test(tc, decodeDuplicateKey);
+    suite_add_tcase(s, tc);
+    TCase *tc_tokenize = tcase_create("Tokenize large input");
+    tcase_add_test(tc_tokenize, tokenizeSpeed);
+    suite_add_tcase(s, tc_tokenize);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_decodeSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
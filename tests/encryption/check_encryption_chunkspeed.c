@@ -0,0 +1,242 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Sign and encrypt (and decrypt and verify) small and full-size SecureChannel
+ * chunks with the symmetric algorithms of the SecurityPolicies and report the
+ * time per chunk. The keys of both sides are renewed in between to check that no
+ * state of the old keys is used afterwards. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+
+#include "certificates.h"
+
+#include <time.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHUNK_SIZE (2 << 16) /* Default chunk size of the SecureChannel */
+#define CHUNKS 2000
+#define SMALL_CHUNK_SIZE 1024 /* Typical size of a small service response */
+#define SMALL_CHUNKS 100000
+
+typedef UA_StatusCode
+(*PolicyFactory)(UA_SecurityPolicy *policy, const UA_ByteString localCertificate,
+                 const UA_ByteString localPrivateKey, const UA_Logger *logger);
+
+static UA_Logger logger;
+
+static UA_Int64
+elapsedNs(const struct timespec *begin, const struct timespec *end) {
+    return (UA_Int64)(end->tv_sec - begin->tv_sec) * 1000000000 +
+        (UA_Int64)(end->tv_nsec - begin->tv_nsec);
+}
+
+/* Set the (local or remote) symmetric keys of a channel context. The key
+ * material is derived from the seed, so both sides get the same keys. */
+static void
+setKeys(const UA_SecurityPolicy *sp, void *cc, UA_Boolean local, UA_Byte seed) {
+    const UA_SecurityPolicyCryptoModule *cm = &sp->symmetricModule.cryptoModule;
+    UA_ByteString signingKey, encryptingKey, iv;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&signingKey,
+                            cm->signatureAlgorithm.getLocalKeyLength(cc));
+    res |= UA_ByteString_allocBuffer(&encryptingKey,
+                            cm->encryptionAlgorithm.getLocalKeyLength(cc));
+    res |= UA_ByteString_allocBuffer(&iv,
+                            cm->encryptionAlgorithm.getRemoteBlockSize(cc));
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < signingKey.length; i++)
+        signingKey.data[i] = (UA_Byte)(seed + i);
+    for(size_t i = 0; i < encryptingKey.length; i++)
+        encryptingKey.data[i] = (UA_Byte)(seed * 3 + i);
+    for(size_t i = 0; i < iv.length; i++)
+        iv.data[i] = (UA_Byte)(seed * 7 + i);
+
+    const UA_SecurityPolicyChannelModule *chm = &sp->channelModule;
+    if(local) {
+        res = chm->setLocalSymSigningKey(cc, &signingKey);
+        res |= chm->setLocalSymEncryptingKey(cc, &encryptingKey);
+        res |= chm->setLocalSymIv(cc, &iv);
+    } else {
+        res = chm->setRemoteSymSigningKey(cc, &signingKey);
+        res |= chm->setRemoteSymEncryptingKey(cc, &encryptingKey);
+        res |= chm->setRemoteSymIv(cc, &iv);
+    }
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ByteString_clear(&signingKey);
+    UA_ByteString_clear(&encryptingKey);
+    UA_ByteString_clear(&iv);
+}
+
+/* Sign and encrypt the chunk in-place as the SecureChannel does. The signature
+ * at the end of the chunk covers the plaintext and is encrypted with it. */
+static UA_StatusCode
+protectChunk(const UA_SecurityPolicy *sp, void *cc,
+             UA_ByteString *chunk, size_t sigSize) {
+    const UA_SecurityPolicyCryptoModule *cm = &sp->symmetricModule.cryptoModule;
+    UA_ByteString msg = {chunk->length - sigSize, chunk->data};
+    UA_ByteString sig = {sigSize, chunk->data + msg.length};
+    UA_StatusCode res = cm->signatureAlgorithm.sign(cc, &msg, &sig);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_ByteString data = *chunk;
+    return cm->encryptionAlgorithm.encrypt(cc, &data);
+}
+
+static UA_StatusCode
+unprotectChunk(const UA_SecurityPolicy *sp, void *cc,
+               UA_ByteString *chunk, size_t sigSize) {
+    const UA_SecurityPolicyCryptoModule *cm = &sp->symmetricModule.cryptoModule;
+    UA_ByteString data = *chunk;
+    UA_StatusCode res = cm->encryptionAlgorithm.decrypt(cc, &data);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_ByteString msg = {chunk->length - sigSize, chunk->data};
+    UA_ByteString sig = {sigSize, chunk->data + msg.length};
+    return cm->signatureAlgorithm.verify(cc, &msg, &sig);
+}
+
+/* Every roundtrip restores the plaintext of the chunk */
+static void
+measureChunks(const UA_SecurityPolicy *sp, void *sender, void *receiver,
+              size_t chunkSize, size_t chunks, const char *name) {
+    size_t sigSize = sp->symmetricModule.cryptoModule.signatureAlgorithm.
+        getLocalSignatureSize(sender);
+    size_t blockSize = sp->symmetricModule.cryptoModule.encryptionAlgorithm.
+        getRemoteBlockSize(sender);
+    chunkSize -= chunkSize % blockSize;
+    UA_ByteString plain, chunk;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&plain, chunkSize);
+    res |= UA_ByteString_allocBuffer(&chunk, chunkSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < chunkSize; i++)
+        plain.data[i] = (UA_Byte)i;
+    memcpy(chunk.data, plain.data, chunkSize);
+
+    UA_Int64 protectNs = 0;
+    UA_Int64 unprotectNs = 0;
+    struct timespec begin, mid, end;
+    for(size_t i = 0; i < chunks; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        res |= protectChunk(sp, sender, &chunk, sigSize);
+        clock_gettime(CLOCK_MONOTONIC, &mid);
+        res |= unprotectChunk(sp, receiver, &chunk, sigSize);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        protectNs += elapsedNs(&begin, &mid);
+        unprotectNs += elapsedNs(&mid, &end);
+    }
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(chunk.data, plain.data, chunkSize - sigSize) == 0);
+
+    double bytes = (double)chunkSize * (double)chunks;
+    printf("%s: %u chunks of %u bytes\n", name, (unsigned)chunks, (unsigned)chunkSize);
+    printf("sign and encrypt %.2f us per chunk (%.0f MB/s)\n",
+           (double)protectNs / (double)chunks / 1e3, bytes / ((double)protectNs / 1e3));
+    printf("decrypt and verify %.2f us per chunk (%.0f MB/s)\n",
+           (double)unprotectNs / (double)chunks / 1e3, bytes / ((double)unprotectNs / 1e3));
+
+    UA_ByteString_clear(&plain);
+    UA_ByteString_clear(&chunk);
+}
+
+static void
+benchmarkPolicy(PolicyFactory factory, const char *name) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    UA_SecurityPolicy sp;
+    UA_StatusCode res = factory(&sp, certificate, privateKey, &logger);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    void *sender = NULL;
+    void *receiver = NULL;
+    res = sp.channelModule.newContext(&sp, &certificate, &sender);
+    res |= sp.channelModule.newContext(&sp, &certificate, &receiver);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    setKeys(&sp, sender, true, 1);
+    setKeys(&sp, receiver, false, 1);
+
+    /* The encrypted length must be a multiple of the block size */
+    size_t sigSize = sp.symmetricModule.cryptoModule.signatureAlgorithm.
+        getLocalSignatureSize(sender);
+    size_t blockSize = sp.symmetricModule.cryptoModule.encryptionAlgorithm.
+        getRemoteBlockSize(sender);
+    size_t chunkSize = CHUNK_SIZE - (CHUNK_SIZE % blockSize);
+    UA_ByteString plain, chunk;
+    res = UA_ByteString_allocBuffer(&plain, chunkSize);
+    res |= UA_ByteString_allocBuffer(&chunk, chunkSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < chunkSize; i++)
+        plain.data[i] = (UA_Byte)i;
+    size_t msgSize = chunkSize - sigSize;
+
+    /* Roundtrip */
+    memcpy(chunk.data, plain.data, chunkSize);
+    res = protectChunk(&sp, sender, &chunk, sigSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(chunk.data, plain.data, msgSize) != 0);
+    res = unprotectChunk(&sp, receiver, &chunk, sigSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(chunk.data, plain.data, msgSize) == 0);
+
+    /* Renew the keys of the sender only. The receiver still has the old keys
+     * and the chunk is rejected. */
+    setKeys(&sp, sender, true, 2);
+    memcpy(chunk.data, plain.data, chunkSize);
+    res = protectChunk(&sp, sender, &chunk, sigSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = unprotectChunk(&sp, receiver, &chunk, sigSize);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+
+    /* Renew the keys of the receiver as well */
+    setKeys(&sp, receiver, false, 2);
+    memcpy(chunk.data, plain.data, chunkSize);
+    res = protectChunk(&sp, sender, &chunk, sigSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = unprotectChunk(&sp, receiver, &chunk, sigSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(chunk.data, plain.data, msgSize) == 0);
+
+    UA_ByteString_clear(&plain);
+    UA_ByteString_clear(&chunk);
+
+    measureChunks(&sp, sender, receiver, SMALL_CHUNK_SIZE, SMALL_CHUNKS, name);
+    measureChunks(&sp, sender, receiver, CHUNK_SIZE, CHUNKS, name);
+
+    sp.channelModule.deleteContext(sender);
+    sp.channelModule.deleteContext(receiver);
+    sp.clear(&sp);
+}
+
+START_TEST(Basic256Sha256Chunks) {
+    benchmarkPolicy(UA_SecurityPolicy_Basic256Sha256, "Basic256Sha256");
+} END_TEST
+
+START_TEST(Aes128Sha256RsaOaepChunks) {
+    benchmarkPolicy(UA_SecurityPolicy_Aes128Sha256RsaOaep, "Aes128Sha256RsaOaep");
+} END_TEST
+
+START_TEST(Aes256Sha256RsaPssChunks) {
+    benchmarkPolicy(UA_SecurityPolicy_Aes256Sha256RsaPss, "Aes256Sha256RsaPss");
+} END_TEST
+
+int main(void) {
+    logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+
+    Suite *s  = suite_create("Encryption chunk speed");
+    TCase *tc = tcase_create("sign and encrypt chunks");
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, Basic256Sha256Chunks);
+    tcase_add_test(tc, Aes128Sha256RsaOaepChunks);
+    tcase_add_test(tc, Aes256Sha256RsaPssChunks);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
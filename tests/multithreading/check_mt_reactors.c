@@ -0,0 +1,164 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+#include "mt_testing.h"
+
+#define NUMBER_OF_REACTORS 4
+#define NUMBER_OF_CLIENTS 16
+#define ITERATIONS_PER_CLIENT 50
+
+UA_NodeId varId = {1, UA_NODEIDTYPE_NUMERIC, {1001}};
+UA_Logger logger;
+
+static void
+addVariableNode(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    attr.displayName = UA_LOCALIZEDTEXT("en-US","Temperature");
+    UA_StatusCode res =
+        UA_Server_addVariableNode(tc.server, varId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Temperature"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, res);
+}
+
+static void setup(void) {
+    tc.running = true;
+
+    /* Set up the EventLoop with reactors before the default configuration is
+     * applied. Then the default configuration does not add its own
+     * ConnectionManagers. */
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_INFO);
+    config.logger = logger;
+    config.eventLoop = UA_EventLoop_new_POSIX(&logger);
+    ck_assert(config.eventLoop != NULL);
+
+    UA_UInt16 reactors = NUMBER_OF_REACTORS;
+    UA_KeyValueMap_setScalar(&config.eventLoop->params,
+                             UA_QUALIFIEDNAME(0, "reactors"), &reactors,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    UA_ConnectionManager *tcpCM =
+        UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcp connection manager"));
+    config.eventLoop->registerEventSource(config.eventLoop, (UA_EventSource *)tcpCM);
+
+    UA_StatusCode res = UA_ServerConfig_setDefault(&config);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    tc.server = UA_Server_newWithConfig(&config);
+    ck_assert(tc.server != NULL);
+
+    addVariableNode();
+    UA_Server_run_startup(tc.server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void
+client_readValueAttribute(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    UA_Variant val;
+    UA_StatusCode retval =
+        UA_Client_readValueAttribute(tc.clients[tmp.index], varId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(42, *(UA_Int32 *)val.data);
+    UA_Variant_clear(&val);
+}
+
+static void
+initTest(void) {
+    for(size_t i = 0; i < tc.numberofClients; i++)
+        setThreadContext(&tc.clientContext[i], i, ITERATIONS_PER_CLIENT,
+                         client_readValueAttribute);
+}
+
+/* The connections are accepted and processed in the reactor threads */
+START_TEST(readValueAttributeReactors) {
+    startMultithreading();
+} END_TEST
+
+static UA_Server *
+newServerWithReactors(void) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_INFO);
+    config.logger = logger;
+    config.eventLoop = UA_EventLoop_new_POSIX(&logger);
+    ck_assert(config.eventLoop != NULL);
+
+    UA_UInt16 reactors = NUMBER_OF_REACTORS;
+    UA_KeyValueMap_setScalar(&config.eventLoop->params,
+                             UA_QUALIFIEDNAME(0, "reactors"), &reactors,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    UA_StatusCode res = UA_ServerConfig_setDefault(&config);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Pretend that the SecurityPolicy is not thread-safe */
+    config.securityPolicies[0].threadSafe = false;
+    UA_Server *server = UA_Server_newWithConfig(&config);
+    ck_assert(server != NULL);
+    return server;
+}
+
+/* The reactors are disabled if the EventLoop is not yet started */
+START_TEST(reactorsDisabledForUnsafePolicy) {
+    UA_Server *server = newServerWithReactors();
+    UA_EventLoop *el = UA_Server_getConfig(server)->eventLoop;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED)
+        el->run(el, 100);
+    UA_StatusCode res = UA_Server_run_startup(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(!UA_KeyValueMap_contains(&el->params, UA_QUALIFIEDNAME(0, "reactors")));
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+} END_TEST
+
+/* The reactors of an already running EventLoop cannot be disabled. The
+ * default configuration starts the EventLoop. */
+START_TEST(reactorsRefusedForUnsafePolicy) {
+    UA_Server *server = newServerWithReactors();
+    UA_StatusCode res = UA_Server_run_startup(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADCONFIGURATIONERROR);
+    UA_Server_delete(server);
+} END_TEST
+
+static Suite* testSuite_reactors(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_reactors = tcase_create("Reactors");
+    tcase_add_checked_fixture(tc_reactors, setup, teardown);
+    tcase_add_test(tc_reactors, readValueAttributeReactors);
+    suite_add_tcase(s, tc_reactors);
+    TCase *tc_unsafe = tcase_create("Reactors with unsafe SecurityPolicy");
+    tcase_add_test(tc_unsafe, reactorsDisabledForUnsafePolicy);
+    tcase_add_test(tc_unsafe, reactorsRefusedForUnsafePolicy);
+    suite_add_tcase(s, tc_unsafe);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_reactors();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+
+    createThreadContext(0, NUMBER_OF_CLIENTS, NULL);
+    initTest();
+    srunner_run_all(sr, CK_NORMAL);
+    deleteThreadContext();
+
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
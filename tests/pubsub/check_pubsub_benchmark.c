@@ -0,0 +1,691 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Publisher and subscriber in one server exchange NetworkMessages over the
+ * loopback. Every configuration (transport, encoding, RT level, security
+ * mode, number of fields and cycle time) is reported as one line of JSON:
+ *
+ * - messagesPerSecond: Received messages per second of wall time
+ * - publishUs: Time spent in the publish callback
+ * - latencyUs: Time from the start of the publish callback until the value
+ *   has arrived in the target variable of the subscriber
+ * - jitterUs: Deviation of the time between two calls of the publish callback
+ *   from the cycle time (only for paced configurations)
+ *
+ * A cycle time of zero publishes the next message as soon as the previous
+ * one was received. Otherwise the WriterGroup publishes from its cyclic
+ * callback in the EventLoop, which then runs with the real clock. The results
+ * are also appended to the file in the environment variable
+ * PUBSUB_BENCHMARK_OUTPUT (JSON lines). The Ethernet configurations run if
+ * ETHERNET_INTERFACE is set. For a veth pair, set ETHERNET_PEER_INTERFACE to
+ * the interface of the subscriber.
+ *
+ * Only built with UA_BUILD_BENCHMARKS. */
+
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+#include <open62541/plugin/securitypolicy_default.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub.h"
+#include "ua_server_internal.h"
+#include "ethernet_config.h"
+
+#include "testing_clock.h"
+
+#include <time.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PACED_CYCLES 250
+#define UNPACED_CYCLES 2000
+#define RECEIVE_TIMEOUT_NS 100000000 /* Count the message as lost after 100ms */
+#define MAX_FIELDS 256
+
+#define UA_AES128CTR_SIGNING_KEY_LENGTH 32
+#define UA_AES128CTR_KEY_LENGTH 16
+#define UA_AES128CTR_KEYNONCE_LENGTH 4
+
+typedef struct {
+    const char *transport; /* "udp" or "eth" */
+    UA_PubSubEncodingType encoding;
+    UA_PubSubRTLevel rtLevel;
+    UA_MessageSecurityMode securityMode;
+    size_t fields;
+    UA_UInt32 cycleTimeUs; /* 0: Publish back-to-back */
+} BenchmarkConfig;
+
+static UA_Server *server;
+static UA_NodeId pubConnectionId, subConnectionId;
+static UA_NodeId writerGroupId, readerGroupId;
+static UA_DataValue *pubValues[MAX_FIELDS];
+static UA_DataValue *subValues[MAX_FIELDS];
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+static UA_Byte signingKey[UA_AES128CTR_SIGNING_KEY_LENGTH] = {0};
+static UA_Byte encryptingKey[UA_AES128CTR_KEY_LENGTH] = {0};
+static UA_Byte keyNonce[UA_AES128CTR_KEYNONCE_LENGTH] = {0};
+#endif
+
+static UA_Int64
+nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UA_Int64)ts.tv_sec * 1000000000 + (UA_Int64)ts.tv_nsec;
+}
+
+/* Measurement of the paced cycles from within the cyclic publish callback */
+static struct {
+    UA_ServerCallback publishCallback; /* Of the WriterGroup */
+    UA_Int64 intervalNs;
+    UA_UInt32 sequence;
+    UA_Int64 lastStart;
+    UA_Boolean measuring;
+    UA_UInt32 first; /* Sequence number of the first measured cycle */
+    size_t cycles;
+    size_t maxCycles;
+    UA_Int64 *begin;
+    UA_Int64 *publish;
+    UA_Int64 *jitter;
+} paced;
+
+static void
+pacedPublishCallback(void *application, void *data) {
+    UA_Int64 start = nowNs();
+    *(UA_UInt32*)pubValues[0]->value.data = ++paced.sequence;
+    paced.publishCallback((UA_Server*)application, data);
+    if(paced.measuring) {
+        size_t i = paced.cycles++;
+        if(i == 0)
+            paced.first = paced.sequence;
+        paced.begin[i] = start;
+        paced.publish[i] = nowNs() - start;
+        UA_Int64 jitter = start - paced.lastStart - paced.intervalNs;
+        paced.jitter[i] = (jitter < 0) ? -jitter : jitter;
+        paced.measuring = (paced.cycles < paced.maxCycles);
+    }
+    paced.lastStart = start;
+}
+
+static UA_StatusCode
+addPacedCallback(UA_Server *s, UA_NodeId identifier, UA_ServerCallback callback,
+                 void *data, UA_Double interval_ms, UA_DateTime *baseTime,
+                 UA_TimerPolicy timerPolicy, UA_UInt64 *callbackId) {
+    paced.publishCallback = callback;
+    paced.intervalNs = (UA_Int64)(interval_ms * 1e6);
+    paced.sequence = 0;
+    paced.lastStart = nowNs();
+    paced.measuring = false;
+    UA_EventLoop *el = UA_Server_getConfig(s)->eventLoop;
+    return el->addCyclicCallback(el, pacedPublishCallback, s, data, interval_ms,
+                                 baseTime, timerPolicy, callbackId);
+}
+
+static void
+removePacedCallback(UA_Server *s, UA_NodeId identifier, UA_UInt64 callbackId) {
+    UA_EventLoop *el = UA_Server_getConfig(s)->eventLoop;
+    el->removeCyclicCallback(el, callbackId);
+}
+
+static UA_StatusCode
+readNotification(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+                 const UA_NodeId *nodeId, void *nodeContext,
+                 const UA_NumericRange *range) {
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The subscriber writes into the external value of the target variable */
+static UA_StatusCode
+writeTarget(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+            const UA_NodeId *nodeId, void *nodeContext, const UA_NumericRange *range,
+            const UA_DataValue *data) {
+    UA_DataValue *dv = (UA_DataValue*)nodeContext;
+    if(!data->hasValue || data->value.type != &UA_TYPES[UA_TYPES_UINT32])
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    *(UA_UInt32*)dv->value.data = *(UA_UInt32*)data->value.data;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_NodeId
+addExternalVariable(UA_DataValue **value, UA_Boolean target) {
+    *value = UA_DataValue_new();
+    ck_assert(*value != NULL);
+    UA_UInt32 *v = UA_UInt32_new();
+    ck_assert(v != NULL);
+    UA_Variant_setScalar(&(*value)->value, v, &UA_TYPES[UA_TYPES_UINT32]);
+    (*value)->hasValue = true;
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId nodeId;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Field"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, *value, &nodeId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ValueBackend backend;
+    memset(&backend, 0, sizeof(UA_ValueBackend));
+    backend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+    backend.backend.external.value = value;
+    backend.backend.external.callback.notificationRead = readNotification;
+    if(target)
+        backend.backend.external.callback.userWrite = writeTarget;
+    res = UA_Server_setVariableNode_valueBackend(server, nodeId, backend);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    return nodeId;
+}
+
+static void
+addConnection(const BenchmarkConfig *bc, const char *iface, UA_NodeId *connectionId) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("Benchmark Connection");
+    connectionConfig.enabled = UA_TRUE;
+    /* JSON decodes numeric PublisherIds as UInt32 */
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT32;
+    connectionConfig.publisherId.uint32 = 2234;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    if(strcmp(bc->transport, "eth") == 0) {
+        networkAddressUrl.networkInterface = UA_STRING((char*)(uintptr_t)iface);
+        networkAddressUrl.url = UA_STRING(MULTICAST_MAC_ADDRESS);
+        connectionConfig.transportProfileUri =
+            UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-eth-uadp");
+    }
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+addPublisher(const BenchmarkConfig *bc) {
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Benchmark PDS");
+    UA_NodeId pdsId;
+    UA_StatusCode res = UA_Server_addPublishedDataSet(server, &pdsConfig, &pdsId).addResult;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < bc->fields; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "Field %u", (unsigned)i);
+        UA_DataSetFieldConfig dsfConfig;
+        memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dsfConfig.field.variable.fieldNameAlias = UA_STRING(name);
+        dsfConfig.field.variable.publishParameters.publishedVariable =
+            addExternalVariable(&pubValues[i], false);
+        dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        dsfConfig.field.variable.rtValueSource.rtInformationModelNode =
+            (bc->rtLevel == UA_PUBSUB_RT_FIXED_SIZE);
+        res = UA_Server_addDataSetField(server, pdsId, &dsfConfig, NULL).result;
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Benchmark WriterGroup");
+    writerGroupConfig.publishingInterval =
+        (bc->cycleTimeUs > 0) ? bc->cycleTimeUs / 1000.0 : 1.0;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = bc->encoding;
+    writerGroupConfig.rtLevel = bc->rtLevel;
+    if(bc->cycleTimeUs > 0) {
+        writerGroupConfig.pubsubManagerCallback.addCustomCallback = addPacedCallback;
+        writerGroupConfig.pubsubManagerCallback.removeCustomCallback = removePacedCallback;
+    }
+    UA_UadpWriterGroupMessageDataType uadpMessage;
+    UA_JsonWriterGroupMessageDataType jsonMessage;
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    if(bc->encoding == UA_PUBSUB_ENCODING_UADP) {
+        UA_UadpWriterGroupMessageDataType_init(&uadpMessage);
+        uadpMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+            (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+             UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+             UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+             UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+        writerGroupConfig.messageSettings.content.decoded.data = &uadpMessage;
+        writerGroupConfig.messageSettings.content.decoded.type =
+            &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    } else {
+        UA_JsonWriterGroupMessageDataType_init(&jsonMessage);
+        jsonMessage.networkMessageContentMask = (UA_JsonNetworkMessageContentMask)
+            (UA_JSONNETWORKMESSAGECONTENTMASK_NETWORKMESSAGEHEADER |
+             UA_JSONNETWORKMESSAGECONTENTMASK_DATASETMESSAGEHEADER |
+             UA_JSONNETWORKMESSAGECONTENTMASK_PUBLISHERID);
+        writerGroupConfig.messageSettings.content.decoded.data = &jsonMessage;
+        writerGroupConfig.messageSettings.content.decoded.type =
+            &UA_TYPES[UA_TYPES_JSONWRITERGROUPMESSAGEDATATYPE];
+    }
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    writerGroupConfig.securityMode = bc->securityMode;
+    if(bc->securityMode > UA_MESSAGESECURITYMODE_NONE)
+        writerGroupConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+#endif
+    res = UA_Server_addWriterGroup(server, pubConnectionId,
+                                   &writerGroupConfig, &writerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    if(bc->securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_ByteString sk = {UA_AES128CTR_SIGNING_KEY_LENGTH, signingKey};
+        UA_ByteString ek = {UA_AES128CTR_KEY_LENGTH, encryptingKey};
+        UA_ByteString kn = {UA_AES128CTR_KEYNONCE_LENGTH, keyNonce};
+        res = UA_Server_setWriterGroupEncryptionKeys(server, writerGroupId, 1,
+                                                     sk, ek, kn);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+#endif
+
+    UA_DataSetWriterConfig dswConfig;
+    memset(&dswConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dswConfig.name = UA_STRING("Benchmark DataSetWriter");
+    dswConfig.dataSetWriterId = 62541;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, pdsId, &dswConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+}
+
+static void
+addSubscriber(const BenchmarkConfig *bc) {
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("Benchmark ReaderGroup");
+    readerGroupConfig.rtLevel = bc->rtLevel;
+    readerGroupConfig.encodingMimeType = bc->encoding;
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    readerGroupConfig.securityMode = bc->securityMode;
+    if(bc->securityMode > UA_MESSAGESECURITYMODE_NONE)
+        readerGroupConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+#endif
+    UA_StatusCode res = UA_Server_addReaderGroup(server, subConnectionId,
+                                                 &readerGroupConfig, &readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    if(bc->securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_ByteString sk = {UA_AES128CTR_SIGNING_KEY_LENGTH, signingKey};
+        UA_ByteString ek = {UA_AES128CTR_KEY_LENGTH, encryptingKey};
+        UA_ByteString kn = {UA_AES128CTR_KEYNONCE_LENGTH, keyNonce};
+        res = UA_Server_setReaderGroupEncryptionKeys(server, readerGroupId, 1,
+                                                     sk, ek, kn);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+#endif
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("Benchmark DataSetReader");
+    UA_UInt32 publisherId = 2234;
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                         &UA_TYPES[UA_TYPES_UINT32]);
+    readerConfig.writerGroupId = 100;
+    readerConfig.dataSetWriterId = 62541;
+    UA_UadpDataSetReaderMessageDataType readerMessage;
+    if(bc->encoding == UA_PUBSUB_ENCODING_UADP) {
+        UA_UadpDataSetReaderMessageDataType_init(&readerMessage);
+        readerMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+            (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+             UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+             UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+             UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+        readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+        readerConfig.messageSettings.content.decoded.type =
+            &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+        readerConfig.messageSettings.content.decoded.data = &readerMessage;
+    }
+
+    UA_FieldMetaData fields[MAX_FIELDS];
+    UA_FieldTargetVariable targets[MAX_FIELDS];
+    memset(targets, 0, sizeof(targets));
+    for(size_t i = 0; i < bc->fields; i++) {
+        UA_FieldMetaData_init(&fields[i]);
+        fields[i].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        fields[i].builtInType = UA_NS0ID_UINT32;
+        fields[i].valueRank = UA_VALUERANK_SCALAR;
+        targets[i].targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+        targets[i].targetVariable.targetNodeId = addExternalVariable(&subValues[i], true);
+    }
+    readerConfig.dataSetMetaData.name = UA_STRING("Benchmark DataSet");
+    readerConfig.dataSetMetaData.fieldsSize = bc->fields;
+    readerConfig.dataSetMetaData.fields = fields;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = bc->fields;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = targets;
+    res = UA_Server_addDataSetReader(server, readerGroupId, &readerConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+}
+
+static void
+setupBenchmark(const BenchmarkConfig *bc) {
+    /* The paced cycles are driven by the EventLoop timer and need the real
+     * clock. Otherwise the EventLoop timers stand still. */
+    server = (bc->cycleTimeUs > 0) ? UA_Server_new() : UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->pubSubConfig.securityPolicies = (UA_PubSubSecurityPolicy*)
+        UA_malloc(sizeof(UA_PubSubSecurityPolicy));
+    config->pubSubConfig.securityPoliciesSize = 1;
+    UA_PubSubSecurityPolicy_Aes128Ctr(&config->pubSubConfig.securityPolicies[0],
+                                      &config->logger);
+#endif
+    UA_Server_run_startup(server);
+
+    const char *iface = NULL;
+    const char *peerIface = NULL;
+    if(strcmp(bc->transport, "eth") == 0) {
+        iface = ETHERNET_INTERFACE;
+        peerIface = getenv("ETHERNET_PEER_INTERFACE");
+    }
+    addConnection(bc, iface, &pubConnectionId);
+    subConnectionId = pubConnectionId;
+    if(peerIface && strlen(peerIface) > 0)
+        addConnection(bc, peerIface, &subConnectionId);
+
+    addPublisher(bc);
+    addSubscriber(bc);
+
+    /* Freeze after both groups were added. Freezing also freezes the
+     * connection. */
+    UA_StatusCode res;
+    if(bc->rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        res = UA_Server_freezeWriterGroupConfiguration(server, writerGroupId);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        res = UA_Server_freezeReaderGroupConfiguration(server, readerGroupId);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+    res = UA_Server_enableWriterGroup(server, writerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+teardownBenchmark(const BenchmarkConfig *bc) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+    for(size_t i = 0; i < bc->fields; i++) {
+        UA_DataValue_delete(pubValues[i]);
+        UA_DataValue_delete(subValues[i]);
+        pubValues[i] = NULL;
+        subValues[i] = NULL;
+    }
+}
+
+static int
+cmpDuration(const void *a, const void *b) {
+    UA_Int64 da = *(const UA_Int64*)a;
+    UA_Int64 db = *(const UA_Int64*)b;
+    return (da > db) - (da < db);
+}
+
+/* Print the percentiles of the (unsorted) samples in microseconds */
+static int
+printPercentiles(char *buf, size_t bufSize, const char *name,
+                 UA_Int64 *samples, size_t samplesSize) {
+    if(samplesSize == 0)
+        return snprintf(buf, bufSize, ",\"%s\":null", name);
+    qsort(samples, samplesSize, sizeof(UA_Int64), cmpDuration);
+    return snprintf(buf, bufSize,
+                    ",\"%s\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f}",
+                    name, (double)samples[(samplesSize - 1) / 2] / 1e3,
+                    (double)samples[((samplesSize - 1) * 90) / 100] / 1e3,
+                    (double)samples[((samplesSize - 1) * 99) / 100] / 1e3,
+                    (double)samples[samplesSize - 1] / 1e3);
+}
+
+static void
+report(const BenchmarkConfig *bc, size_t cycles, size_t received, UA_Int64 duration,
+       UA_Int64 *publish, UA_Int64 *latency, UA_Int64 *jitter) {
+    const char *rtLevel = (bc->rtLevel == UA_PUBSUB_RT_FIXED_SIZE) ? "fixed-size" : "none";
+    const char *security = "none";
+    if(bc->securityMode == UA_MESSAGESECURITYMODE_SIGN)
+        security = "sign";
+    else if(bc->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
+        security = "signandencrypt";
+
+    char line[1024];
+    int pos = snprintf(line, sizeof(line),
+                       "{\"benchmark\":\"pubsub\",\"transport\":\"%s\",\"encoding\":\"%s\","
+                       "\"rtLevel\":\"%s\",\"security\":\"%s\",\"fields\":%u,"
+                       "\"cycleTimeUs\":%u,\"cycles\":%u,\"received\":%u,"
+                       "\"messagesPerSecond\":%.0f",
+                       bc->transport,
+                       (bc->encoding == UA_PUBSUB_ENCODING_JSON) ? "json" : "uadp",
+                       rtLevel, security, (unsigned)bc->fields,
+                       (unsigned)bc->cycleTimeUs, (unsigned)cycles, (unsigned)received,
+                       (double)received * 1e9 / (double)duration);
+    pos += printPercentiles(&line[pos], sizeof(line) - (size_t)pos,
+                            "publishUs", publish, cycles);
+    pos += printPercentiles(&line[pos], sizeof(line) - (size_t)pos,
+                            "latencyUs", latency, received);
+    pos += printPercentiles(&line[pos], sizeof(line) - (size_t)pos,
+                            "jitterUs", jitter, (bc->cycleTimeUs > 0) ? cycles : 0);
+    snprintf(&line[pos], sizeof(line) - (size_t)pos, "}\n");
+
+    printf("%s", line);
+    fflush(stdout);
+    const char *output = getenv("PUBSUB_BENCHMARK_OUTPUT");
+    if(output && strlen(output) > 0) {
+        FILE *f = fopen(output, "a");
+        ck_assert(f != NULL);
+        fputs(line, f);
+        fclose(f);
+    }
+}
+
+/* Publish until the value has arrived at the subscriber */
+static UA_Boolean
+waitForValue(UA_UInt32 expected, UA_Int64 deadline, UA_Int64 *receivedAt) {
+    volatile UA_UInt32 *received = (volatile UA_UInt32*)subValues[0]->value.data;
+    do {
+        UA_Server_run_iterate(server, false);
+        *receivedAt = nowNs();
+        if(*received == expected)
+            return true;
+    } while(*receivedAt < deadline);
+    return false;
+}
+
+/* The next message is published as soon as the previous one was received */
+static size_t
+runUnpaced(const BenchmarkConfig *bc, UA_WriterGroup *wg) {
+    /* Warm up until the first message is received. The sockets are opened
+     * asynchronously. */
+    UA_UInt32 *published = (UA_UInt32*)pubValues[0]->value.data;
+    UA_UInt32 sequence = 1;
+    UA_Int64 receivedAt;
+    UA_Boolean warm = false;
+    for(size_t i = 0; i < 50 && !warm; i++) {
+        *published = sequence;
+        UA_WriterGroup_publishCallback(server, wg);
+        warm = waitForValue(sequence, nowNs() + RECEIVE_TIMEOUT_NS / 10, &receivedAt);
+    }
+    ck_assert(warm);
+
+    size_t cycles = UNPACED_CYCLES;
+    UA_Int64 *publish = (UA_Int64*)UA_malloc(cycles * sizeof(UA_Int64));
+    UA_Int64 *latency = (UA_Int64*)UA_malloc(cycles * sizeof(UA_Int64));
+    ck_assert(publish && latency);
+
+    size_t received = 0;
+    UA_Int64 start = nowNs();
+    for(size_t i = 0; i < cycles; i++) {
+        UA_Int64 begin = nowNs();
+        *published = ++sequence;
+        UA_WriterGroup_publishCallback(server, wg);
+        publish[i] = nowNs() - begin;
+        if(waitForValue(sequence, begin + RECEIVE_TIMEOUT_NS, &receivedAt))
+            latency[received++] = receivedAt - begin;
+    }
+    UA_Int64 duration = nowNs() - start;
+
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+    report(bc, cycles, received, duration, publish, latency, NULL);
+    UA_free(publish);
+    UA_free(latency);
+    return received;
+}
+
+/* The WriterGroup publishes from its cyclic callback in the EventLoop. The
+ * cycles are measured in the callback (see pacedPublishCallback). */
+static size_t
+runPaced(const BenchmarkConfig *bc, UA_WriterGroup *wg) {
+    /* Warm up until the first message is received. The sockets are opened
+     * asynchronously. */
+    volatile UA_UInt32 *value = (volatile UA_UInt32*)subValues[0]->value.data;
+    UA_Int64 deadline = nowNs() + 5 * RECEIVE_TIMEOUT_NS;
+    while(*value == 0) {
+        ck_assert(nowNs() < deadline);
+        UA_Server_run_iterate(server, false);
+    }
+
+    size_t cycles = PACED_CYCLES;
+    paced.begin = (UA_Int64*)UA_malloc(cycles * sizeof(UA_Int64));
+    paced.publish = (UA_Int64*)UA_malloc(cycles * sizeof(UA_Int64));
+    paced.jitter = (UA_Int64*)UA_malloc(cycles * sizeof(UA_Int64));
+    UA_Int64 *latency = (UA_Int64*)UA_malloc(cycles * sizeof(UA_Int64));
+    ck_assert(paced.begin && paced.publish && paced.jitter && latency);
+    paced.cycles = 0;
+    paced.maxCycles = cycles;
+    paced.measuring = true;
+
+    /* Run the EventLoop until the last message has arrived or timed out */
+    size_t received = 0;
+    UA_UInt32 lastValue = *value;
+    UA_Int64 start = nowNs();
+    UA_Int64 now = start;
+    do {
+        UA_Server_run_iterate(server, false);
+        now = nowNs();
+        UA_UInt32 v = *value;
+        if(v == lastValue)
+            continue;
+        lastValue = v;
+        if(paced.cycles > 0 && v >= paced.first && v - paced.first < paced.cycles)
+            latency[received++] = now - paced.begin[v - paced.first];
+    } while(paced.measuring || (lastValue - paced.first < cycles - 1 &&
+                                now < paced.begin[cycles - 1] + RECEIVE_TIMEOUT_NS));
+    UA_Int64 duration = now - start;
+
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+    report(bc, cycles, received, duration, paced.publish, latency, paced.jitter);
+    UA_free(paced.begin);
+    UA_free(paced.publish);
+    UA_free(paced.jitter);
+    UA_free(latency);
+    paced.begin = paced.publish = paced.jitter = NULL;
+    return received;
+}
+
+static void
+runBenchmark(const BenchmarkConfig *bc) {
+    setupBenchmark(bc);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupId);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert(wg != NULL);
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+
+    size_t cycles = (bc->cycleTimeUs > 0) ? PACED_CYCLES : UNPACED_CYCLES;
+    size_t received = (bc->cycleTimeUs > 0) ?
+        runPaced(bc, wg) : runUnpaced(bc, wg);
+    teardownBenchmark(bc);
+
+    /* Some loss is tolerated on a busy machine */
+    ck_assert_uint_ge(received * 10, cycles * 9);
+}
+
+static const size_t fieldCounts[] = {8, MAX_FIELDS};
+static const UA_UInt32 cycleTimes[] = {0, 1000};
+
+static void
+runUadp(const char *transport) {
+    static const UA_PubSubRTLevel rtLevels[] =
+        {UA_PUBSUB_RT_NONE, UA_PUBSUB_RT_FIXED_SIZE};
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    static const UA_MessageSecurityMode securityModes[] =
+        {UA_MESSAGESECURITYMODE_NONE, UA_MESSAGESECURITYMODE_SIGN,
+         UA_MESSAGESECURITYMODE_SIGNANDENCRYPT};
+#else
+    static const UA_MessageSecurityMode securityModes[] =
+        {UA_MESSAGESECURITYMODE_NONE};
+#endif
+    for(size_t r = 0; r < sizeof(rtLevels) / sizeof(rtLevels[0]); r++) {
+        for(size_t s = 0; s < sizeof(securityModes) / sizeof(securityModes[0]); s++) {
+            for(size_t f = 0; f < sizeof(fieldCounts) / sizeof(fieldCounts[0]); f++) {
+                for(size_t c = 0; c < sizeof(cycleTimes) / sizeof(cycleTimes[0]); c++) {
+                    BenchmarkConfig bc = {transport, UA_PUBSUB_ENCODING_UADP,
+                                          rtLevels[r], securityModes[s],
+                                          fieldCounts[f], cycleTimes[c]};
+                    runBenchmark(&bc);
+                }
+            }
+        }
+    }
+}
+
+START_TEST(BenchmarkUdpUadp) {
+    runUadp("udp");
+} END_TEST
+
+#ifdef UA_ENABLE_JSON_ENCODING
+START_TEST(BenchmarkUdpJson) {
+    /* Message security and the RT levels are defined for UADP only */
+    for(size_t f = 0; f < sizeof(fieldCounts) / sizeof(fieldCounts[0]); f++) {
+        for(size_t c = 0; c < sizeof(cycleTimes) / sizeof(cycleTimes[0]); c++) {
+            BenchmarkConfig bc = {"udp", UA_PUBSUB_ENCODING_JSON, UA_PUBSUB_RT_NONE,
+                                  UA_MESSAGESECURITYMODE_NONE,
+                                  fieldCounts[f], cycleTimes[c]};
+            runBenchmark(&bc);
+        }
+    }
+} END_TEST
+#endif
+
+#ifdef __linux__
+START_TEST(BenchmarkEthUadp) {
+    runUadp("eth");
+} END_TEST
+#endif
+
+int main(void) {
+    TCase *tc = tcase_create("PubSub loopback benchmark");
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, BenchmarkUdpUadp);
+#ifdef UA_ENABLE_JSON_ENCODING
+    tcase_add_test(tc, BenchmarkUdpJson);
+#endif
+#ifdef __linux__
+    if(ETHERNET_INTERFACE && strlen(ETHERNET_INTERFACE) > 0 &&
+       !(SKIP_ETHERNET && strlen(SKIP_ETHERNET) > 0))
+        tcase_add_test(tc, BenchmarkEthUadp);
+#endif
+
+    Suite *s = suite_create("PubSub benchmark");
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
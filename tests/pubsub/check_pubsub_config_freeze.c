@@ -364,6 +364,56 @@ START_TEST(CreateConfigWithStaticFieldSource) {
     ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
     } END_TEST
 
+/* Delete a connection with a frozen WriterGroup and a frozen ReaderGroup. Every
+ * group holds the connection frozen until it is unfrozen. */
+START_TEST(DeleteConnectionWithFrozenGroups) {
+    UA_NodeId connection1, writerGroup1, readerGroup1;
+    UA_PubSubConnectionConfig connectionConfig;
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl = {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri = UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    retVal |= UA_Server_addPubSubConnection(server, &connectionConfig, &connection1);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 1");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_NONE;
+    retVal |= UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroup1);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(readerGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup 1");
+    retVal |= UA_Server_addReaderGroup(server, connection1, &readerGroupConfig, &readerGroup1);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    retVal |= UA_Server_freezeWriterGroupConfiguration(server, writerGroup1);
+    retVal |= UA_Server_freezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_PubSubConnection *pubSubConnection = UA_PubSubConnection_findConnectionbyId(server, connection1);
+    ck_assert(pubSubConnection->configurationFreezeCounter == 2);
+
+    //unfreezing the ReaderGroup twice only releases its own lock
+    retVal |= UA_Server_unfreezeReaderGroupConfiguration(server, readerGroup1);
+    retVal |= UA_Server_unfreezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert(pubSubConnection->configurationFreezeCounter == 1);
+    retVal |= UA_Server_freezeReaderGroupConfiguration(server, readerGroup1);
+    ck_assert(pubSubConnection->configurationFreezeCounter == 2);
+
+    //all groups are removed with the connection. The connection itself is
+    //freed in a delayed callback.
+    retVal |= UA_Server_removePubSubConnection(server, connection1);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(LIST_EMPTY(&pubSubConnection->writerGroups));
+    ck_assert(LIST_EMPTY(&pubSubConnection->readerGroups));
+    ck_assert(pubSubConnection->configurationFreezeCounter == 0);
+    } END_TEST
+
 int main(void) {
     TCase *tc_lock_configuration = tcase_create("Create and Lock");
     tcase_add_checked_fixture(tc_lock_configuration, setup, teardown);
@@ -372,6 +422,7 @@ int main(void) {
     tcase_add_test(tc_lock_configuration, CreateAndReleaseMultiplePDSLocks);
     tcase_add_test(tc_lock_configuration, CreateLockAndEditConfiguration);
     tcase_add_test(tc_lock_configuration, CreateConfigWithStaticFieldSource);
+    tcase_add_test(tc_lock_configuration, DeleteConnectionWithFrozenGroups);
 
     Suite *s = suite_create("PubSub RT configuration lock mechanism");
     suite_add_tcase(s, tc_lock_configuration);
@@ -0,0 +1,413 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Message size and processing time of a large DataSet where only a small part
+ * of the fields changes between the messages. Compares keyframes with delta
+ * frames. The messages are applied to a ReaderGroup that writes the target
+ * variables with the write service and to a realtime ReaderGroup with
+ * external target values. */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/server_config_default.h>
+#include <open62541/plugin/log_stdout.h>
+
+#include "ua_pubsub.h"
+#include "ua_pubsub_networkmessage.h"
+#include "ua_server_internal.h"
+#include "testing_clock.h"
+#include "test_helpers.h"
+
+#include <time.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PUBLISHER_ID 2234
+#define WRITER_GROUP_ID 100
+#define DATASET_WRITER_ID 62541
+#define FIELDS 10000
+#define CHANGES 100 /* Changed fields per message (1%) */
+#define CYCLES 100  /* Number of messages per measurement */
+
+static UA_Server *server;
+static UA_NodeId connectionId;
+static UA_NodeId writerGroupId;
+static UA_NodeId publishedDataSetId;
+static UA_NodeId readerGroupId;
+static UA_NodeId rtReaderGroupId;
+static UA_NodeId publishedNodes[FIELDS];
+static UA_NodeId targetNodes[FIELDS];
+static UA_NodeId rtTargetNodes[FIELDS];
+static UA_UInt32 publishedValues[FIELDS];
+static UA_UInt32 rtTargetValues[FIELDS];
+static UA_DataValue *rtTargetDataValues[FIELDS];
+
+static double
+elapsedNs(const struct timespec *begin, const struct timespec *end) {
+    return (double)(end->tv_sec - begin->tv_sec) * 1e9 +
+        (double)(end->tv_nsec - begin->tv_nsec);
+}
+
+static UA_NodeId
+addVariable(UA_UInt32 id, char *name) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_UInt32 value = 0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_NodeId nodeId;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, name),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, &nodeId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    return nodeId;
+}
+
+static void
+addPublisher(UA_UInt32 keyFrameCount) {
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet");
+    UA_AddPublishedDataSetResult pdsResult =
+        UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId);
+    ck_assert_int_eq(pdsResult.addResult, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < FIELDS; i++) {
+        publishedNodes[i] = addVariable((UA_UInt32)(10000 + i), "Published UInt32");
+        UA_DataSetFieldConfig fieldConfig;
+        memset(&fieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        fieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        fieldConfig.field.variable.fieldNameAlias = UA_STRING("Published UInt32");
+        fieldConfig.field.variable.publishParameters.publishedVariable = publishedNodes[i];
+        fieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_DataSetFieldResult fieldResult =
+            UA_Server_addDataSetField(server, publishedDataSetId, &fieldConfig, NULL);
+        ck_assert_int_eq(fieldResult.result, UA_STATUSCODE_GOOD);
+    }
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup");
+    writerGroupConfig.publishingInterval = 100;
+    writerGroupConfig.writerGroupId = WRITER_GROUP_ID;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_StatusCode res =
+        UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = DATASET_WRITER_ID;
+    dataSetWriterConfig.keyFrameCount = keyFrameCount;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, publishedDataSetId,
+                                     &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static UA_NodeId
+addReaderGroup(UA_PubSubRTLevel rtLevel, UA_NodeId *targets) {
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    readerGroupConfig.rtLevel = rtLevel;
+    UA_NodeId rgId;
+    UA_StatusCode res =
+        UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_UInt16 publisherId = PUBLISHER_ID;
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                         &UA_TYPES[UA_TYPES_UINT16]);
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    readerConfig.dataSetWriterId = DATASET_WRITER_ID;
+    UA_UadpDataSetReaderMessageDataType readerMessage;
+    UA_UadpDataSetReaderMessageDataType_init(&readerMessage);
+    readerMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = &readerMessage;
+
+    UA_FieldMetaData *fields = (UA_FieldMetaData*)
+        UA_calloc(FIELDS, sizeof(UA_FieldMetaData));
+    UA_FieldTargetVariable *tvs = (UA_FieldTargetVariable*)
+        UA_calloc(FIELDS, sizeof(UA_FieldTargetVariable));
+    ck_assert(fields != NULL && tvs != NULL);
+    for(size_t i = 0; i < FIELDS; i++) {
+        fields[i].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        fields[i].builtInType = UA_NS0ID_UINT32;
+        fields[i].valueRank = UA_VALUERANK_SCALAR;
+        tvs[i].targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+        tvs[i].targetVariable.targetNodeId = targets[i];
+    }
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet");
+    readerConfig.dataSetMetaData.fieldsSize = FIELDS;
+    readerConfig.dataSetMetaData.fields = fields;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = FIELDS;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = tvs;
+
+    res = UA_Server_addDataSetReader(server, rgId, &readerConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_free(fields);
+    UA_free(tvs);
+    return rgId;
+}
+
+static void
+addSubscribers(void) {
+    for(size_t i = 0; i < FIELDS; i++) {
+        targetNodes[i] = addVariable((UA_UInt32)(30000 + i), "Subscribed UInt32");
+
+        /* External value backend for the realtime ReaderGroup */
+        rtTargetNodes[i] = addVariable((UA_UInt32)(50000 + i), "Subscribed RT UInt32");
+        rtTargetValues[i] = 0;
+        rtTargetDataValues[i] = UA_DataValue_new();
+        ck_assert(rtTargetDataValues[i] != NULL);
+        rtTargetDataValues[i]->hasValue = true;
+        UA_Variant_setScalar(&rtTargetDataValues[i]->value, &rtTargetValues[i],
+                             &UA_TYPES[UA_TYPES_UINT32]);
+        UA_ValueBackend valueBackend;
+        memset(&valueBackend, 0, sizeof(UA_ValueBackend));
+        valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+        valueBackend.backend.external.value = &rtTargetDataValues[i];
+        UA_StatusCode res =
+            UA_Server_setVariableNode_valueBackend(server, rtTargetNodes[i], valueBackend);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    readerGroupId = addReaderGroup(UA_PUBSUB_RT_NONE, targetNodes);
+    rtReaderGroupId = addReaderGroup(UA_PUBSUB_RT_FIXED_SIZE, rtTargetNodes);
+
+    /* Freezing a ReaderGroup also freezes the connection. So this is done
+     * after the WriterGroup was added. */
+    UA_StatusCode res = UA_Server_freezeReaderGroupConfiguration(server, rtReaderGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableReaderGroup(server, rtReaderGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+setup(UA_UInt32 keyFrameCount) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    config->pubSubConfig.enableDeltaFrames = true;
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = PUBLISHER_ID;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    memset(publishedValues, 0, sizeof(publishedValues));
+    addPublisher(keyFrameCount);
+    addSubscribers();
+}
+
+static void
+teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_free(rtTargetDataValues[i]);
+        rtTargetDataValues[i] = NULL;
+    }
+}
+
+/* Change 1% of the published values. Different fields in every cycle. */
+static void
+changeValues(size_t cycle) {
+    for(size_t i = 0; i < CHANGES; i++) {
+        size_t field = (i * (FIELDS / CHANGES) + cycle) % FIELDS;
+        publishedValues[field]++;
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &publishedValues[field], &UA_TYPES[UA_TYPES_UINT32]);
+        UA_StatusCode res = UA_Server_writeValue(server, publishedNodes[field], value);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+/* Generate the DataSetMessage and encode it in a NetworkMessage */
+static void
+publish(UA_DataSetWriter *dsw, UA_ByteString *buf) {
+    UA_DataSetMessage dsm;
+    UA_StatusCode res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_UInt16 dataSetWriterId = DATASET_WRITER_ID;
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.version = 1;
+    nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm.publisherIdEnabled = true;
+    nm.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    nm.publisherId.uint16 = PUBLISHER_ID;
+    nm.groupHeaderEnabled = true;
+    nm.groupHeader.writerGroupIdEnabled = true;
+    nm.groupHeader.writerGroupId = WRITER_GROUP_ID;
+    nm.payloadHeaderEnabled = true;
+    nm.payloadHeader.dataSetPayloadHeader.count = 1;
+    nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &dataSetWriterId;
+    nm.payload.dataSetPayload.dataSetMessages = &dsm;
+
+    size_t msgSize = UA_NetworkMessage_calcSizeBinary(&nm, NULL);
+    res = UA_ByteString_allocBuffer(buf, msgSize);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = buf->data;
+    res = UA_NetworkMessage_encodeBinary(&nm, &bufPos, &buf->data[buf->length], NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The fields of the delta frame are owned by the DataSetWriter */
+    if(dsm.header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME)
+        dsm.data.deltaFrameData.deltaFrameFields = NULL;
+    UA_DataSetMessage_clear(&dsm);
+}
+
+static void
+subscribe(UA_ReaderGroup *rg, const UA_ByteString *buf) {
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    size_t pos = 0;
+    UA_StatusCode res = UA_NetworkMessage_decodeBinary(buf, &pos, &nm, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_Boolean processed = UA_ReaderGroup_process(server, rg, &nm);
+    ck_assert(processed);
+    UA_NetworkMessage_clear(&nm);
+}
+
+static void
+checkTargetValues(void) {
+    for(size_t i = 0; i < FIELDS; i++) {
+        ck_assert_uint_eq(rtTargetValues[i], publishedValues[i]);
+        UA_Variant value;
+        UA_StatusCode res = UA_Server_readValue(server, targetNodes[i], &value);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(*(UA_UInt32*)value.data, publishedValues[i]);
+        UA_Variant_clear(&value);
+    }
+}
+
+static double
+measure(const char *name, UA_UInt32 keyFrameCount,
+        UA_DataSetMessageType expectedType) {
+    setup(keyFrameCount);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupId);
+    UA_DataSetWriter *dsw = LIST_FIRST(&wg->writers);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupId);
+    UA_ReaderGroup *rtRg = UA_ReaderGroup_findRGbyId(server, rtReaderGroupId);
+    ck_assert(dsw != NULL && rg != NULL && rtRg != NULL);
+
+    /* The first message is always a keyframe. It also prepares the offset
+     * table of the realtime reader. */
+    UA_ByteString buf;
+    publish(dsw, &buf);
+    subscribe(rg, &buf);
+    ck_assert(UA_ReaderGroup_decodeAndProcessRT(server, rtRg, &buf));
+    UA_ByteString_clear(&buf);
+    UA_UNLOCK(&server->serviceMutex);
+
+    size_t bytes = 0;
+    double publishNs = 0.0, subscribeNs = 0.0, rtSubscribeNs = 0.0;
+    struct timespec begin, end;
+    for(size_t cycle = 0; cycle < CYCLES; cycle++) {
+        changeValues(cycle);
+
+        UA_LOCK(&server->serviceMutex);
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        publish(dsw, &buf);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        publishNs += elapsedNs(&begin, &end);
+        bytes += buf.length;
+
+        /* The DataSetMessage type is encoded in the DataSetFlags2 */
+        UA_NetworkMessage nm;
+        memset(&nm, 0, sizeof(UA_NetworkMessage));
+        size_t pos = 0;
+        UA_StatusCode res = UA_NetworkMessage_decodeBinary(&buf, &pos, &nm, NULL);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(nm.payload.dataSetPayload.dataSetMessages[0].header.dataSetMessageType,
+                         expectedType);
+        UA_NetworkMessage_clear(&nm);
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        subscribe(rg, &buf);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        subscribeNs += elapsedNs(&begin, &end);
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        ck_assert(UA_ReaderGroup_decodeAndProcessRT(server, rtRg, &buf));
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        rtSubscribeNs += elapsedNs(&begin, &end);
+        UA_UNLOCK(&server->serviceMutex);
+
+        UA_ByteString_clear(&buf);
+    }
+
+    checkTargetValues();
+
+    printf("%5u fields, %3u changed, %-12s: %7u bytes per message, "
+           "%8.1f us publish, %8.1f us subscribe, %8.1f us subscribe (RT)\n",
+           (unsigned)FIELDS, (unsigned)CHANGES, name, (unsigned)(bytes / CYCLES),
+           publishNs / CYCLES / 1000.0, subscribeNs / CYCLES / 1000.0,
+           rtSubscribeNs / CYCLES / 1000.0);
+
+    teardown();
+    return (double)bytes / CYCLES;
+}
+
+START_TEST(KeyFramesAndDeltaFrames) {
+    double keyFrameBytes = measure("keyframes", 1, UA_DATASETMESSAGE_DATAKEYFRAME);
+    double deltaFrameBytes = measure("delta frames", CYCLES + 1,
+                                     UA_DATASETMESSAGE_DATADELTAFRAME);
+
+    /* The size of the delta frames is proportional to the changes */
+    ck_assert(deltaFrameBytes * 20 < keyFrameBytes);
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("PubSub delta frame speed");
+    TCase *tc = tcase_create("keyframes and delta frames with sparse changes");
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, KeyFramesAndDeltaFrames);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
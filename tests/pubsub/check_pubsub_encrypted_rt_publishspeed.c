@@ -0,0 +1,241 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Publish a frozen RT_FIXED_SIZE WriterGroup with a 1ms cycle and report the
+ * time spent in the publish callback per cycle. Unsecured, signed and signed
+ * and encrypted UADP messages are compared. The secured messages are encrypted
+ * and signed in-place in the network buffer. */
+
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+#include <open62541/plugin/securitypolicy_default.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub.h"
+#include "ua_server_internal.h"
+
+#include "testing_clock.h"
+
+#include <time.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CYCLES 1000 /* Number of publish cycles */
+#define CYCLE_TIME_NS 1000000 /* 1ms publish cycle */
+#define FIELDS 64
+
+#define UA_AES128CTR_SIGNING_KEY_LENGTH 32
+#define UA_AES128CTR_KEY_LENGTH 16
+#define UA_AES128CTR_KEYNONCE_LENGTH 4
+
+static UA_Server *server;
+static UA_NodeId connectionId, pdsId, writerGroupId;
+static UA_DataValue *fieldValues[FIELDS];
+
+static UA_Byte signingKey[UA_AES128CTR_SIGNING_KEY_LENGTH] = {0};
+static UA_Byte encryptingKey[UA_AES128CTR_KEY_LENGTH] = {0};
+static UA_Byte keyNonce[UA_AES128CTR_KEYNONCE_LENGTH] = {0};
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->pubSubConfig.securityPolicies = (UA_PubSubSecurityPolicy*)
+        UA_malloc(sizeof(UA_PubSubSecurityPolicy));
+    config->pubSubConfig.securityPoliciesSize = 1;
+    UA_PubSubSecurityPolicy_Aes128Ctr(&config->pubSubConfig.securityPolicies[0],
+                                      &config->logger);
+    UA_Server_run_startup(server);
+
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_UInt32 *value = UA_UInt32_new();
+        ck_assert(value != NULL);
+        *value = (UA_UInt32)i;
+        fieldValues[i] = UA_DataValue_new();
+        ck_assert(fieldValues[i] != NULL);
+        UA_Variant_setScalar(&fieldValues[i]->value, value, &UA_TYPES[UA_TYPES_UINT32]);
+        fieldValues[i]->hasValue = true;
+    }
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_DataValue_delete(fieldValues[i]);
+        fieldValues[i] = NULL;
+    }
+}
+
+static void
+addPublisher(UA_MessageSecurityMode securityMode) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    res = UA_Server_addPublishedDataSet(server, &pdsConfig, &pdsId).addResult;
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 1;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    writerGroupConfig.securityMode = securityMode;
+    if(securityMode > UA_MESSAGESECURITYMODE_NONE)
+        writerGroupConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    res = UA_Server_addWriterGroup(server, connectionId,
+                                   &writerGroupConfig, &writerGroupId);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    if(securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_ByteString sk = {UA_AES128CTR_SIGNING_KEY_LENGTH, signingKey};
+        UA_ByteString ek = {UA_AES128CTR_KEY_LENGTH, encryptingKey};
+        UA_ByteString kn = {UA_AES128CTR_KEYNONCE_LENGTH, keyNonce};
+        res = UA_Server_setWriterGroupEncryptionKeys(server, writerGroupId, 1,
+                                                     sk, ek, kn);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    res = UA_Server_enableWriterGroup(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_DataSetFieldConfig dsfConfig;
+        memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+        dsfConfig.field.variable.rtValueSource.staticValueSource = &fieldValues[i];
+        dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        res = UA_Server_addDataSetField(server, pdsId, &dsfConfig, NULL).result;
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Demo DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, pdsId,
+                                     &dataSetWriterConfig, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_freezeWriterGroupConfiguration(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static int
+cmpDuration(const void *a, const void *b) {
+    UA_Int64 da = *(const UA_Int64*)a;
+    UA_Int64 db = *(const UA_Int64*)b;
+    return (da > db) - (da < db);
+}
+
+static void
+runCycles(UA_MessageSecurityMode securityMode, const char *name) {
+    addPublisher(securityMode);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupId);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert(wg != NULL);
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+    UA_UInt16 startSequence = wg->sequenceNumber;
+
+    /* The publish cycles are driven from a timer with the real clock. The
+     * EventLoop cannot be used as the testing clock stands still. */
+    UA_Int64 *duration = (UA_Int64*)UA_malloc(CYCLES * sizeof(UA_Int64));
+    ck_assert(duration != NULL);
+    struct timespec next, now;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for(size_t i = 0; i < CYCLES; i++) {
+        next.tv_nsec += CYCLE_TIME_NS;
+        if(next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        struct timespec begin;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        *(UA_UInt32*)fieldValues[i % FIELDS]->value.data = (UA_UInt32)i;
+        UA_WriterGroup_publishCallback(server, wg);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        duration[i] = (UA_Int64)(now.tv_sec - begin.tv_sec) * 1000000000 +
+            (UA_Int64)(now.tv_nsec - begin.tv_nsec);
+    }
+
+    /* Every cycle has sent a message */
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+    ck_assert_uint_eq((UA_UInt16)(wg->sequenceNumber - startSequence),
+                      (UA_UInt16)CYCLES);
+
+    qsort(duration, CYCLES, sizeof(UA_Int64), cmpDuration);
+    printf("%s: %u cycles of %.1f ms with %u fields\n", name, (unsigned)CYCLES,
+           CYCLE_TIME_NS / 1e6, (unsigned)FIELDS);
+    printf("cycle time median %.1f us, p99 %.1f us, max %.1f us\n",
+           (double)duration[CYCLES / 2] / 1e3,
+           (double)duration[(CYCLES * 99) / 100] / 1e3,
+           (double)duration[CYCLES - 1] / 1e3);
+    UA_free(duration);
+}
+
+START_TEST(PublishCycleNone) {
+    runCycles(UA_MESSAGESECURITYMODE_NONE, "UADP");
+} END_TEST
+
+START_TEST(PublishCycleSign) {
+    runCycles(UA_MESSAGESECURITYMODE_SIGN, "Signed UADP");
+} END_TEST
+
+START_TEST(PublishCycleSignAndEncrypt) {
+    runCycles(UA_MESSAGESECURITYMODE_SIGNANDENCRYPT, "Signed and encrypted UADP");
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("PubSub encrypted realtime publish");
+    TCase *tc = tcase_create("publish cycle time");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, PublishCycleNone);
+    tcase_add_test(tc, PublishCycleSign);
+    tcase_add_test(tc, PublishCycleSignAndEncrypt);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,351 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/server_config_default.h>
+
+#include "ua_pubsub.h"
+#include "ua_server_internal.h"
+#include "testing_clock.h"
+#include "test_helpers.h"
+
+#include <check.h>
+#include <stdio.h>
+
+#define WRITERGROUPS 3
+
+static UA_Server *server;
+static UA_NodeId connectionId;
+static UA_NodeId writerGroupIds[WRITERGROUPS + 1];
+static UA_NodeId publishedVarIds[WRITERGROUPS];
+static UA_NodeId subscribedVarIds[WRITERGROUPS];
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    /* Send the batched messages with a single syscall */
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_String udp = UA_STRING("udp");
+    UA_UInt16 batchSize = 8;
+    for(UA_EventSource *es = config->eventLoop->eventSources; es; es = es->next) {
+        if(es->eventSourceType != UA_EVENTSOURCETYPE_CONNECTIONMANAGER)
+            continue;
+        UA_ConnectionManager *cm = (UA_ConnectionManager*)es;
+        if(UA_String_equal(&cm->protocol, &udp))
+            UA_KeyValueMap_setScalar(&es->params, UA_QUALIFIEDNAME(0, "send-batchsize"),
+                                     &batchSize, &UA_TYPES[UA_TYPES_UINT16]);
+    }
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static UA_NodeId
+addInt32Variable(const char *name, UA_Int32 value) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", (char*)(uintptr_t)name);
+    attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    UA_NodeId nodeId;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, &nodeId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    return nodeId;
+}
+
+/* WriterGroup with one DataSetWriter that publishes an Int32 variable */
+static void
+addPublisher(size_t index, UA_Duration interval, UA_PubSubRTLevel rtLevel) {
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup");
+    writerGroupConfig.publishingInterval = interval;
+    writerGroupConfig.rtLevel = rtLevel;
+    writerGroupConfig.writerGroupId = (UA_UInt16)(100 + index);
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    UA_StatusCode res = UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig,
+                                                 &writerGroupIds[index]);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    if(index >= WRITERGROUPS)
+        return;
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    char name[32];
+    snprintf(name, sizeof(name), "PublishedDataSet %u", (unsigned)index);
+    pdsConfig.name = UA_STRING(name);
+    UA_NodeId pdsId;
+    res = UA_Server_addPublishedDataSet(server, &pdsConfig, &pdsId).addResult;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    publishedVarIds[index] = addInt32Variable("Published Int32", (UA_Int32)(1000 + index));
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dsfConfig.field.variable.fieldNameAlias = UA_STRING("Int32");
+    dsfConfig.field.variable.publishParameters.publishedVariable = publishedVarIds[index];
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    dsfConfig.field.variable.rtValueSource.rtInformationModelNode =
+        (rtLevel != UA_PUBSUB_RT_NONE);
+    res = UA_Server_addDataSetField(server, pdsId, &dsfConfig, NULL).result;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dswConfig;
+    memset(&dswConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dswConfig.name = UA_STRING("DataSetWriter");
+    dswConfig.dataSetWriterId = (UA_UInt16)(1 + index);
+    dswConfig.keyFrameCount = 10;
+    res = UA_Server_addDataSetWriter(server, writerGroupIds[index], pdsId,
+                                     &dswConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+addSubscriber(UA_NodeId rgId, size_t index) {
+    UA_UInt16 publisherId = 2234;
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                         &UA_TYPES[UA_TYPES_UINT16]);
+    readerConfig.writerGroupId = (UA_UInt16)(100 + index);
+    readerConfig.dataSetWriterId = (UA_UInt16)(1 + index);
+    UA_UadpDataSetReaderMessageDataType readerMessage;
+    UA_UadpDataSetReaderMessageDataType_init(&readerMessage);
+    readerMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = &readerMessage;
+
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    field.builtInType = UA_NS0ID_INT32;
+    field.valueRank = UA_VALUERANK_SCALAR;
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet");
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+
+    subscribedVarIds[index] = addInt32Variable("Subscribed Int32", 0);
+    UA_FieldTargetVariable tv;
+    memset(&tv, 0, sizeof(UA_FieldTargetVariable));
+    tv.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    tv.targetVariable.targetNodeId = subscribedVarIds[index];
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = 1;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = &tv;
+
+    UA_StatusCode res = UA_Server_addDataSetReader(server, rgId, &readerConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static UA_WriterGroup *
+getWG(size_t index) {
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIds[index]);
+    ck_assert(wg != NULL);
+    return wg;
+}
+
+START_TEST(ShareScheduleForEqualIntervals) {
+    for(size_t i = 0; i < WRITERGROUPS; i++)
+        addPublisher(i, 50, UA_PUBSUB_RT_NONE);
+    addPublisher(WRITERGROUPS, 100, UA_PUBSUB_RT_NONE); /* Different interval */
+    for(size_t i = 0; i < WRITERGROUPS + 1; i++) {
+        UA_StatusCode res = UA_Server_enableWriterGroup(server, writerGroupIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_LOCK(&server->serviceMutex);
+
+    /* The WriterGroups with the same interval are in one schedule in the order
+     * in which they became operational */
+    UA_PublishSchedule *ps = getWG(0)->schedule;
+    ck_assert(ps != NULL);
+    ck_assert_uint_eq(ps->writerGroupsSize, WRITERGROUPS);
+    for(size_t i = 0; i < WRITERGROUPS; i++) {
+        ck_assert_ptr_eq(ps->writerGroups[i], getWG(i));
+        ck_assert_uint_eq(getWG(i)->publishCallbackId, 0);
+    }
+
+    /* The other WriterGroup publishes on its own */
+    ck_assert(getWG(WRITERGROUPS)->schedule == NULL);
+    ck_assert_uint_ne(getWG(WRITERGROUPS)->publishCallbackId, 0);
+
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Leave the schedule */
+    UA_StatusCode res = UA_Server_disableWriterGroup(server, writerGroupIds[1]);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(getWG(1)->schedule == NULL);
+    ck_assert_uint_eq(getWG(1)->publishCallbackId, 0);
+    ck_assert_uint_eq(ps->writerGroupsSize, 2);
+    ck_assert_ptr_eq(ps->writerGroups[0], getWG(0));
+    ck_assert_ptr_eq(ps->writerGroups[1], getWG(2));
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* The last WriterGroup publishes on its own again */
+    res = UA_Server_disableWriterGroup(server, writerGroupIds[0]);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(getWG(2)->schedule == NULL);
+    ck_assert_uint_ne(getWG(2)->publishCallbackId, 0);
+    UA_PubSubConnection *c = UA_PubSubConnection_findConnectionbyId(server, connectionId);
+    ck_assert(LIST_EMPTY(&c->publishSchedules));
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Create a new schedule */
+    res = UA_Server_enableWriterGroup(server, writerGroupIds[0]);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ps = getWG(0)->schedule;
+    ck_assert(ps != NULL);
+    ck_assert_uint_eq(ps->writerGroupsSize, 2);
+    ck_assert_ptr_eq(ps->writerGroups[0], getWG(2));
+    ck_assert_ptr_eq(ps->writerGroups[1], getWG(0));
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Remove a WriterGroup of the schedule */
+    res = UA_Server_removeWriterGroup(server, writerGroupIds[2]);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(getWG(0)->schedule == NULL);
+    ck_assert_uint_ne(getWG(0)->publishCallbackId, 0);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+/* The schedule publishes with the server lock. WriterGroups with a fixed size
+ * keep their own callback for the lock-free realtime path. */
+START_TEST(NoScheduleForFixedSize) {
+    addPublisher(0, 50, UA_PUBSUB_RT_FIXED_SIZE);
+    addPublisher(1, 50, UA_PUBSUB_RT_FIXED_SIZE);
+    addPublisher(2, 50, UA_PUBSUB_RT_NONE);
+    for(size_t i = 0; i < WRITERGROUPS; i++) {
+        UA_StatusCode res = UA_Server_enableWriterGroup(server, writerGroupIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_LOCK(&server->serviceMutex);
+    for(size_t i = 0; i < WRITERGROUPS; i++) {
+        ck_assert(getWG(i)->schedule == NULL);
+        ck_assert_uint_ne(getWG(i)->publishCallbackId, 0);
+    }
+    UA_PubSubConnection *c = UA_PubSubConnection_findConnectionbyId(server, connectionId);
+    ck_assert(LIST_EMPTY(&c->publishSchedules));
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+START_TEST(ReceiveBatchedMessages) {
+    for(size_t i = 0; i < WRITERGROUPS; i++)
+        addPublisher(i, 50, UA_PUBSUB_RT_NONE);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    UA_NodeId rgId;
+    UA_StatusCode res =
+        UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < WRITERGROUPS; i++)
+        addSubscriber(rgId, i);
+    res = UA_Server_enableReaderGroup(server, rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < WRITERGROUPS; i++) {
+        res = UA_Server_enableWriterGroup(server, writerGroupIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = getWG(0);
+    ck_assert(wg->schedule != NULL);
+    ck_assert_uint_eq(wg->schedule->writerGroupsSize, WRITERGROUPS);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* All messages of the batch are received */
+    size_t cycles = 0;
+    UA_Boolean done = false;
+    while(!done) {
+        ck_assert_uint_lt(cycles++, 100);
+        UA_fakeSleep(50);
+        UA_Server_run_iterate(server, false);
+        done = true;
+        for(size_t i = 0; i < WRITERGROUPS; i++) {
+            UA_Variant value;
+            res = UA_Server_readValue(server, subscribedVarIds[i], &value);
+            ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+            if(*(UA_Int32*)value.data != (UA_Int32)(1000 + i))
+                done = false;
+            UA_Variant_clear(&value);
+        }
+    }
+
+    UA_LOCK(&server->serviceMutex);
+    for(size_t i = 0; i < WRITERGROUPS; i++) {
+        ck_assert_int_eq(getWG(i)->state, UA_PUBSUBSTATE_OPERATIONAL);
+        ck_assert_uint_gt(getWG(i)->sequenceNumber, 0);
+    }
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+int main(void) {
+    TCase *tc = tcase_create("PubSub publish schedule");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, ShareScheduleForEqualIntervals);
+    tcase_add_test(tc, NoScheduleForFixedSize);
+    tcase_add_test(tc, ReceiveBatchedMessages);
+
+    Suite *s = suite_create("PubSub WriterGroups with equal publishing intervals");
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,284 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Publish a WriterGroup with a 1ms cycle while background threads keep the
+ * server busy with Read requests for a large array. Every Read holds the
+ * server lock while the array is copied. Reports the lateness of the publish
+ * cycles (scheduled wakeup until the message is sent) for a frozen
+ * RT_FIXED_SIZE WriterGroup, which is published without the server lock, and
+ * for a WriterGroup without realtime configuration. */
+
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub.h"
+#include "ua_server_internal.h"
+#include "thread_wrapper.h"
+
+#include "testing_clock.h"
+
+#include <time.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CYCLES 2000 /* Number of publish cycles */
+#define CYCLE_TIME_NS 1000000 /* 1ms publish cycle */
+#define LOAD_THREADS 4
+#define ARRAY_LENGTH 100000 /* Length of the array read by the load threads */
+#define FIELDS 8
+
+static UA_Server *server;
+static UA_NodeId connectionId, pdsId, writerGroupId, dataSetWriterId;
+static UA_NodeId arrayId = {1, UA_NODEIDTYPE_NUMERIC, {2001}};
+static UA_DataValue *fieldValues[FIELDS];
+static UA_UInt32 valueSequence;
+static volatile UA_Boolean running;
+static size_t reads;
+static size_t readErrors;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    /* Add the array that is read by the load threads */
+    UA_Double *array = (UA_Double*)UA_Array_new(ARRAY_LENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert(array != NULL);
+    for(size_t i = 0; i < ARRAY_LENGTH; i++)
+        array[i] = (UA_Double)i;
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Variant_setArray(&attr.value, array, ARRAY_LENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "Array");
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, arrayId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Array"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    UA_Array_delete(array, ARRAY_LENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Server_run_startup(server);
+
+    for(size_t i = 0; i < FIELDS; i++) {
+        fieldValues[i] = UA_DataValue_new();
+        UA_UInt32 *v = UA_UInt32_new();
+        *v = (UA_UInt32)i;
+        UA_Variant_setScalar(&fieldValues[i]->value, v, &UA_TYPES[UA_TYPES_UINT32]);
+        fieldValues[i]->hasValue = true;
+    }
+    valueSequence = 0;
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_DataValue_delete(fieldValues[i]);
+        fieldValues[i] = NULL;
+    }
+}
+
+static void
+addPublisher(UA_PubSubRTLevel rtLevel) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    res = UA_Server_addPublishedDataSet(server, &pdsConfig, &pdsId).addResult;
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = 1;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = rtLevel;
+    if(rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
+        writerGroupConfig.rtValueSequence = &valueSequence;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    res = UA_Server_addWriterGroup(server, connectionId,
+                                   &writerGroupConfig, &writerGroupId);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableWriterGroup(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The fields are read from external values in both configurations */
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_DataSetFieldConfig dsfConfig;
+        memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+        dsfConfig.field.variable.rtValueSource.staticValueSource = &fieldValues[i];
+        dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        res = UA_Server_addDataSetField(server, pdsId, &dsfConfig, NULL).result;
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Demo DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, pdsId,
+                                     &dataSetWriterConfig, &dataSetWriterId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    if(rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        res = UA_Server_freezeWriterGroupConfiguration(server, writerGroupId);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+THREAD_CALLBACK(readLoop) {
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = arrayId;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    while(running) {
+        UA_DataValue dv = UA_Server_read(server, &rvi, UA_TIMESTAMPSTORETURN_NEITHER);
+        if(!dv.hasValue || dv.value.arrayLength != ARRAY_LENGTH)
+            __atomic_fetch_add(&readErrors, 1, __ATOMIC_RELAXED);
+        UA_DataValue_clear(&dv);
+        __atomic_fetch_add(&reads, 1, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+/* Update the published values in-place like a control application */
+THREAD_CALLBACK(valueLoop) {
+    UA_UInt32 counter = 0;
+    while(running) {
+        UA_PubSub_beginValueUpdate(&valueSequence);
+        for(size_t i = 0; i < FIELDS; i++)
+            *(UA_UInt32*)fieldValues[i]->value.data = counter;
+        UA_PubSub_endValueUpdate(&valueSequence);
+        counter++;
+        UA_realSleep(0);
+    }
+    return 0;
+}
+
+static int
+cmpLateness(const void *a, const void *b) {
+    UA_Int64 la = *(const UA_Int64*)a;
+    UA_Int64 lb = *(const UA_Int64*)b;
+    return (la > lb) - (la < lb);
+}
+
+static void
+runJitter(UA_PubSubRTLevel rtLevel, const char *name) {
+    addPublisher(rtLevel);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupId);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert(wg != NULL);
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+    UA_UInt16 startSequence = wg->sequenceNumber;
+
+    running = true;
+    reads = 0;
+    readErrors = 0;
+    THREAD_HANDLE loadThreads[LOAD_THREADS];
+    for(size_t i = 0; i < LOAD_THREADS; i++)
+        THREAD_CREATE(loadThreads[i], readLoop);
+    THREAD_HANDLE valueThread;
+    THREAD_CREATE(valueThread, valueLoop);
+
+    /* The publish cycles are driven from a timer with the real clock. The
+     * EventLoop cannot be used as the testing clock stands still. */
+    UA_Int64 *lateness = (UA_Int64*)UA_malloc(CYCLES * sizeof(UA_Int64));
+    ck_assert(lateness != NULL);
+    struct timespec next, now;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for(size_t i = 0; i < CYCLES; i++) {
+        next.tv_nsec += CYCLE_TIME_NS;
+        if(next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        UA_WriterGroup_publishCallback(server, wg);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        lateness[i] = (UA_Int64)(now.tv_sec - next.tv_sec) * 1000000000 +
+            (UA_Int64)(now.tv_nsec - next.tv_nsec);
+    }
+
+    running = false;
+    for(size_t i = 0; i < LOAD_THREADS; i++)
+        THREAD_JOIN(loadThreads[i]);
+    THREAD_JOIN(valueThread);
+
+    ck_assert_uint_eq(readErrors, 0);
+
+    /* Every cycle has sent a message */
+    ck_assert_int_eq(wg->state, UA_PUBSUBSTATE_OPERATIONAL);
+    ck_assert_uint_eq((UA_UInt16)(wg->sequenceNumber - startSequence),
+                      (UA_UInt16)CYCLES);
+
+    qsort(lateness, CYCLES, sizeof(UA_Int64), cmpLateness);
+    printf("%s: %u cycles of %.1f ms with %u reader threads (%u reads)\n",
+           name, (unsigned)CYCLES, CYCLE_TIME_NS / 1e6,
+           (unsigned)LOAD_THREADS, (unsigned)reads);
+    printf("lateness median %.1f us, p99 %.1f us, max %.1f us\n",
+           (double)lateness[CYCLES / 2] / 1e3,
+           (double)lateness[(CYCLES * 99) / 100] / 1e3,
+           (double)lateness[CYCLES - 1] / 1e3);
+    UA_free(lateness);
+}
+
+START_TEST(PublishJitterFixedSize) {
+    runJitter(UA_PUBSUB_RT_FIXED_SIZE, "RT_FIXED_SIZE (without server lock)");
+} END_TEST
+
+START_TEST(PublishJitterNoRT) {
+    runJitter(UA_PUBSUB_RT_NONE, "RT_NONE (with server lock)");
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("PubSub realtime publish jitter");
+    TCase *tc = tcase_create("publish under read load");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, PublishJitterFixedSize);
+    tcase_add_test(tc, PublishJitterNoRT);
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
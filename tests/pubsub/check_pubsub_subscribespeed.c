@@ -0,0 +1,416 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Processing time of received NetworkMessages for an increasing number of
+ * DataSetReaders. Compares the linear search over all readers of a ReaderGroup
+ * with the lookup index of a frozen ReaderGroup. And for realtime ReaderGroups
+ * the decoding of the headers for every group with the direct decoding from
+ * the offset table. */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/server_config_default.h>
+#include <open62541/plugin/log_stdout.h>
+
+#include "ua_pubsub.h"
+#include "ua_pubsub_networkmessage.h"
+#include "ua_server_internal.h"
+#include "testing_clock.h"
+#include "test_helpers.h"
+
+#include <time.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PUBLISHER_ID 2234
+#define WRITER_GROUP_ID 100
+#define MESSAGES 2000 /* Number of processed messages per measurement */
+#define MAX_READERS 500
+
+static const size_t readerCounts[] = {1, 10, 100, MAX_READERS};
+
+static UA_Server *server;
+static UA_NodeId connectionId;
+static UA_UInt32 targetValues[MAX_READERS];
+static UA_DataValue *targetDataValues[MAX_READERS];
+
+static double
+elapsedNs(const struct timespec *begin, const struct timespec *end) {
+    return (double)(end->tv_sec - begin->tv_sec) * 1e9 +
+        (double)(end->tv_nsec - begin->tv_nsec);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    /* Don't print the info messages for every non-matching reader */
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 1000;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+    for(size_t i = 0; i < MAX_READERS; i++) {
+        if(targetDataValues[i]) {
+            UA_free(targetDataValues[i]);
+            targetDataValues[i] = NULL;
+        }
+    }
+}
+
+/* Add a variable for the received value. Optionally with an external value
+ * backend for the realtime ReaderGroups. */
+static UA_NodeId
+addTargetVariable(size_t index, UA_Boolean external) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed UInt32");
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    UA_NodeId nodeId;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, (UA_UInt32)(50000 + index)),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, &nodeId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    if(!external)
+        return nodeId;
+
+    targetValues[index] = 0;
+    targetDataValues[index] = UA_DataValue_new();
+    targetDataValues[index]->hasValue = true;
+    UA_Variant_setScalar(&targetDataValues[index]->value, &targetValues[index],
+                         &UA_TYPES[UA_TYPES_UINT32]);
+    UA_ValueBackend valueBackend;
+    memset(&valueBackend, 0, sizeof(UA_ValueBackend));
+    valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+    valueBackend.backend.external.value = &targetDataValues[index];
+    res = UA_Server_setVariableNode_valueBackend(server, nodeId, valueBackend);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    return nodeId;
+}
+
+static UA_NodeId
+addReaderGroup(UA_PubSubRTLevel rtLevel) {
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    readerGroupConfig.rtLevel = rtLevel;
+    UA_NodeId rgId;
+    UA_StatusCode res =
+        UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    return rgId;
+}
+
+static void
+addReader(UA_NodeId rgId, UA_UInt16 dataSetWriterId, UA_NodeId targetId) {
+    UA_UInt16 publisherId = PUBLISHER_ID;
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                         &UA_TYPES[UA_TYPES_UINT16]);
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    readerConfig.dataSetWriterId = dataSetWriterId;
+    UA_UadpDataSetReaderMessageDataType readerMessage;
+    UA_UadpDataSetReaderMessageDataType_init(&readerMessage);
+    readerMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = &readerMessage;
+
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    field.builtInType = UA_NS0ID_UINT32;
+    field.valueRank = UA_VALUERANK_SCALAR;
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet");
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+
+    UA_FieldTargetVariable tv;
+    memset(&tv, 0, sizeof(UA_FieldTargetVariable));
+    tv.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    tv.targetVariable.targetNodeId = targetId;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = 1;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = &tv;
+
+    UA_StatusCode res = UA_Server_addDataSetReader(server, rgId, &readerConfig, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+/* Encode the message of the given DataSetWriter with a single UInt32 field */
+static void
+encodeMessage(UA_UInt16 dataSetWriterId, UA_UInt32 value, UA_Boolean valid,
+              UA_ByteString *buf) {
+    UA_DataValue field;
+    UA_DataValue_init(&field);
+    UA_Variant_setScalar(&field.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    field.hasValue = true;
+
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    dsm.header.dataSetMessageValid = valid;
+    dsm.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    dsm.data.keyFrameData.fieldCount = 1;
+    dsm.data.keyFrameData.dataSetFields = &field;
+
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.version = 1;
+    nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm.publisherIdEnabled = true;
+    nm.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    nm.publisherId.uint16 = PUBLISHER_ID;
+    nm.groupHeaderEnabled = true;
+    nm.groupHeader.writerGroupIdEnabled = true;
+    nm.groupHeader.writerGroupId = WRITER_GROUP_ID;
+    nm.payloadHeaderEnabled = true;
+    nm.payloadHeader.dataSetPayloadHeader.count = 1;
+    nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &dataSetWriterId;
+    nm.payload.dataSetPayload.dataSetMessages = &dsm;
+
+    size_t msgSize = UA_NetworkMessage_calcSizeBinary(&nm, NULL);
+    UA_StatusCode res = UA_ByteString_allocBuffer(buf, msgSize);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = buf->data;
+    res = UA_NetworkMessage_encodeBinary(&nm, &bufPos, &buf->data[buf->length], NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static double
+measureReaderGroup(UA_ReaderGroup *rg, UA_NetworkMessage *nm) {
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(size_t i = 0; i < MESSAGES; i++) {
+        UA_Boolean processed = UA_ReaderGroup_process(server, rg, nm);
+        ck_assert(processed);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return elapsedNs(&begin, &end) / MESSAGES;
+}
+
+static void
+lookupReaders(size_t readers) {
+    setup();
+
+    UA_NodeId targetId = addTargetVariable(0, false);
+    UA_NodeId rgId = addReaderGroup(UA_PUBSUB_RT_NONE);
+    for(size_t i = 0; i < readers; i++)
+        addReader(rgId, (UA_UInt16)(i + 1), targetId);
+    UA_StatusCode res = UA_Server_enableReaderGroup(server, rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The message is for the last reader */
+    UA_ByteString buf;
+    encodeMessage((UA_UInt16)readers, 42, true, &buf);
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    size_t pos = 0;
+    res = UA_NetworkMessage_decodeBinary(&buf, &pos, &nm, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, rgId);
+    ck_assert(rg != NULL);
+    double linear = measureReaderGroup(rg, &nm);
+    UA_UNLOCK(&server->serviceMutex);
+
+    res = UA_Server_freezeReaderGroupConfiguration(server, rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(rg->readerIndex != NULL);
+    ck_assert_uint_eq(rg->readerIndexSize, readers);
+    double indexed = measureReaderGroup(rg, &nm);
+    UA_UNLOCK(&server->serviceMutex);
+
+    UA_Variant value;
+    res = UA_Server_readValue(server, targetId, &value);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(*(UA_UInt32*)value.data, 42);
+    UA_Variant_clear(&value);
+
+    printf("%4u readers in one ReaderGroup: %8.0f ns per message (linear), "
+           "%8.0f ns per message (index)\n",
+           (unsigned)readers, linear, indexed);
+
+    UA_NetworkMessage_clear(&nm);
+    UA_ByteString_clear(&buf);
+    teardown();
+}
+
+START_TEST(LookupReaders) {
+    for(size_t i = 0; i < sizeof(readerCounts) / sizeof(size_t); i++)
+        lookupReaders(readerCounts[i]);
+} END_TEST
+
+/* Every message is tested by all ReaderGroups of the connection */
+static double
+measureConnection(UA_PubSubConnection *psc, UA_ByteString *bufs, size_t groups) {
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(size_t i = 0; i < MESSAGES; i++) {
+        UA_Boolean processed = false;
+        UA_ReaderGroup *rg;
+        LIST_FOREACH(rg, &psc->readerGroups, listEntry) {
+            processed |= UA_ReaderGroup_decodeAndProcessRT(server, rg,
+                                                           &bufs[i % groups]);
+        }
+        ck_assert(processed);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return elapsedNs(&begin, &end) / MESSAGES;
+}
+
+static void
+decodeRealtimeGroups(size_t groups) {
+    setup();
+
+    /* One realtime ReaderGroup with a single reader per DataSetWriter */
+    UA_NodeId *rgIds = (UA_NodeId*)UA_calloc(groups, sizeof(UA_NodeId));
+    UA_ByteString *bufs = (UA_ByteString*)UA_calloc(groups, sizeof(UA_ByteString));
+    ck_assert(rgIds != NULL && bufs != NULL);
+    for(size_t i = 0; i < groups; i++) {
+        UA_NodeId targetId = addTargetVariable(i, true);
+        rgIds[i] = addReaderGroup(UA_PUBSUB_RT_FIXED_SIZE);
+        addReader(rgIds[i], (UA_UInt16)(i + 1), targetId);
+        encodeMessage((UA_UInt16)(i + 1), (UA_UInt32)(i + 1000), true, &bufs[i]);
+    }
+
+    /* Freezing a ReaderGroup also freezes the connection. So the groups are
+     * frozen after all of them have been added. */
+    for(size_t i = 0; i < groups; i++) {
+        UA_StatusCode res = UA_Server_freezeReaderGroupConfiguration(server, rgIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        res = UA_Server_enableReaderGroup(server, rgIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_LOCK(&server->serviceMutex);
+    UA_PubSubConnection *psc = UA_PubSubConnection_findConnectionbyId(server, connectionId);
+    ck_assert(psc != NULL);
+
+    /* The first message prepares the offset table of each reader */
+    for(size_t i = 0; i < groups; i++) {
+        UA_ReaderGroup *rg;
+        LIST_FOREACH(rg, &psc->readerGroups, listEntry)
+            UA_ReaderGroup_decodeAndProcessRT(server, rg, &bufs[i]);
+    }
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &psc->readerGroups, listEntry)
+        ck_assert(LIST_FIRST(&rg->readers)->directDecoding);
+
+    double direct = measureConnection(psc, bufs, groups);
+
+    /* Decode the headers for every ReaderGroup */
+    LIST_FOREACH(rg, &psc->readerGroups, listEntry)
+        LIST_FIRST(&rg->readers)->directDecoding = false;
+    double headers = measureConnection(psc, bufs, groups);
+    UA_UNLOCK(&server->serviceMutex);
+
+    for(size_t i = 0; i < groups; i++)
+        ck_assert_uint_eq(targetValues[i], i + 1000);
+
+    printf("%4u realtime ReaderGroups: %8.0f ns per message (decoded headers), "
+           "%8.0f ns per message (direct)\n",
+           (unsigned)groups, headers, direct);
+
+    for(size_t i = 0; i < groups; i++)
+        UA_ByteString_clear(&bufs[i]);
+    UA_free(bufs);
+    UA_free(rgIds);
+    teardown();
+}
+
+START_TEST(DecodeRealtimeGroups) {
+    for(size_t i = 0; i < sizeof(readerCounts) / sizeof(size_t); i++)
+        decodeRealtimeGroups(readerCounts[i]);
+} END_TEST
+
+/* A message marked as invalid is not decoded directly into the target */
+START_TEST(DiscardInvalidRealtime) {
+    setup();
+    UA_NodeId targetId = addTargetVariable(0, true);
+    UA_NodeId rgId = addReaderGroup(UA_PUBSUB_RT_FIXED_SIZE);
+    addReader(rgId, 1, targetId);
+    UA_StatusCode res = UA_Server_freezeReaderGroupConfiguration(server, rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableReaderGroup(server, rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ByteString valid1, invalid, valid2;
+    encodeMessage(1, 1000, true, &valid1);
+    encodeMessage(1, 2000, false, &invalid);
+    encodeMessage(1, 3000, true, &valid2);
+    ck_assert_uint_eq(valid1.length, invalid.length);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, rgId);
+    ck_assert(rg != NULL);
+
+    /* The first message prepares the offset table */
+    UA_ReaderGroup_decodeAndProcessRT(server, rg, &valid1);
+    ck_assert(LIST_FIRST(&rg->readers)->directDecoding);
+    ck_assert_uint_eq(targetValues[0], 1000);
+
+    UA_ReaderGroup_decodeAndProcessRT(server, rg, &invalid);
+    ck_assert_uint_eq(targetValues[0], 1000);
+
+    UA_ReaderGroup_decodeAndProcessRT(server, rg, &valid2);
+    ck_assert_uint_eq(targetValues[0], 3000);
+    UA_UNLOCK(&server->serviceMutex);
+
+    UA_ByteString_clear(&valid1);
+    UA_ByteString_clear(&invalid);
+    UA_ByteString_clear(&valid2);
+    teardown();
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("PubSub subscriber speed");
+    TCase *tc = tcase_create("processing time over reader counts");
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, LookupReaders);
+    tcase_add_test(tc, DecodeRealtimeGroups);
+    suite_add_tcase(s, tc);
+    TCase *tc_rt = tcase_create("realtime decoding");
+    tcase_add_test(tc_rt, DiscardInvalidRealtime);
+    suite_add_tcase(s, tc_rt);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
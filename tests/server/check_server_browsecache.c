@@ -0,0 +1,195 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+static UA_Server *server;
+
+static void
+addVariable(UA_UInt32 id, const char *name) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en", (char*)(uintptr_t)name);
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                  UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    addVariable(1, "Var1");
+    addVariable(2, "Var2");
+    UA_Server_getConfig(server)->maxBrowseCacheSize = 2;
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+/* Browse the forward references of the node. Returns the number of
+ * references. */
+static size_t
+browseNode(UA_Session *session, UA_UInt32 ns0id, UA_UInt32 maxReferences) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(0, ns0id);
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.includeSubtypes = true;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.requestedMaxReferencesPerNode = maxReferences;
+    request.nodesToBrowseSize = 1;
+    request.nodesToBrowse = &bd;
+
+    UA_BrowseResponse response;
+    UA_BrowseResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Browse(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    size_t refs = response.results[0].referencesSize;
+    UA_BrowseResponse_clear(&response);
+    return refs;
+}
+
+START_TEST(browseCached) {
+    size_t refs = browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0), refs);
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0), refs);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.currentEntryCount, 1);
+    ck_assert_uint_eq(stats.bcs.hitCount, 2);
+    ck_assert_uint_eq(stats.bcs.missCount, 1);
+} END_TEST
+
+START_TEST(browseContinuationPoint) {
+    size_t refs = browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    ck_assert(refs > 1);
+
+    /* The cached result does not fit. Not cached as it is incomplete. */
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 1), 1);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.currentEntryCount, 1);
+    ck_assert_uint_eq(stats.bcs.hitCount, 0);
+    ck_assert_uint_eq(stats.bcs.missCount, 2);
+} END_TEST
+
+START_TEST(addNodeInvalidates) {
+    size_t refs = browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    addVariable(3, "Var3");
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0),
+                      refs + 1);
+
+    UA_StatusCode retval = UA_Server_deleteNode(server, UA_NODEID_NUMERIC(1, 3), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0),
+                      refs);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.hitCount, 0);
+    ck_assert(stats.bcs.invalidationCount >= 2);
+} END_TEST
+
+START_TEST(addNodeKeepsOtherNodes) {
+    /* Adding the node browses internally. Leave room for those results. */
+    UA_Server_getConfig(server)->maxBrowseCacheSize = 100;
+    size_t refs = browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    size_t typeRefs = browseNode(&server->adminSession, UA_NS0ID_TYPESFOLDER, 0);
+    addVariable(3, "Var3");
+
+    /* Only the result for the ObjectsFolder was removed */
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    size_t hits = stats.bcs.hitCount;
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_TYPESFOLDER, 0),
+                      typeRefs);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.hitCount, hits + 1);
+    ck_assert_uint_eq(browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0),
+                      refs + 1);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.hitCount, hits + 1);
+} END_TEST
+
+START_TEST(writeDisplayNameInvalidates) {
+    browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    UA_StatusCode retval =
+        UA_Server_writeDisplayName(server, UA_NODEID_NUMERIC(1, 1),
+                                   UA_LOCALIZEDTEXT("en", "Renamed"));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.currentEntryCount, 0);
+} END_TEST
+
+START_TEST(evictLeastRecentlyUsed) {
+    browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    browseNode(&server->adminSession, UA_NS0ID_TYPESFOLDER, 0);
+    browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    browseNode(&server->adminSession, UA_NS0ID_VIEWSFOLDER, 0);
+
+    /* The TypesFolder was evicted */
+    browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    browseNode(&server->adminSession, UA_NS0ID_TYPESFOLDER, 0);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.currentEntryCount, 2);
+    ck_assert_uint_eq(stats.bcs.hitCount, 2);
+    ck_assert_uint_eq(stats.bcs.missCount, 4);
+    ck_assert_uint_eq(stats.bcs.evictionCount, 2);
+} END_TEST
+
+START_TEST(cacheDisabled) {
+    UA_Server_getConfig(server)->maxBrowseCacheSize = 0;
+    browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+    browseNode(&server->adminSession, UA_NS0ID_OBJECTSFOLDER, 0);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.currentEntryCount, 0);
+    ck_assert_uint_eq(stats.bcs.hitCount, 0);
+    ck_assert_uint_eq(stats.bcs.missCount, 0);
+} END_TEST
+
+static Suite * testSuite_browseCache(void) {
+    Suite *s = suite_create("Server Browse Cache");
+    TCase *tc = tcase_create("Browse with cache");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, browseCached);
+    tcase_add_test(tc, browseContinuationPoint);
+    tcase_add_test(tc, addNodeInvalidates);
+    tcase_add_test(tc, addNodeKeepsOtherNodes);
+    tcase_add_test(tc, writeDisplayNameInvalidates);
+    tcase_add_test(tc, evictLeastRecentlyUsed);
+    tcase_add_test(tc, cacheDisabled);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_browseCache();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
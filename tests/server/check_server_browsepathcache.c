@@ -0,0 +1,258 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+/* Objects/A/B/C with C being a variable. A second variable A/D. */
+
+static UA_Server *server;
+
+static void
+addObject(UA_UInt32 id, UA_UInt32 parent, const char *name) {
+    UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(1, id),
+                                UA_NODEID_NUMERIC((parent < 1000) ? 0 : 1, parent),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void
+addVariable(UA_UInt32 id, UA_UInt32 parent, const char *name) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                  UA_NODEID_NUMERIC(1, parent),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                  UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    addObject(1001, UA_NS0ID_OBJECTSFOLDER, "A");
+    addObject(1002, 1001, "B");
+    addVariable(1003, 1002, "C");
+    addVariable(1004, 1001, "D");
+    UA_Server_getConfig(server)->maxBrowsePathCacheSize = 100;
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+/* Translates the path of BrowseNames (separated by "/") starting from the
+ * ObjectsFolder. Returns the status code. The target is stored if there is
+ * exactly one. */
+static UA_StatusCode
+translate(const char *path, UA_NodeId *target) {
+    UA_RelativePathElement rpe[8];
+    UA_BrowsePath bp;
+    UA_BrowsePath_init(&bp);
+    bp.startingNode = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bp.relativePath.elements = rpe;
+
+    const char *pos = path;
+    while(*pos) {
+        const char *end = strchr(pos, '/');
+        size_t len = (end) ? (size_t)(end - pos) : strlen(pos);
+        UA_RelativePathElement *e = &rpe[bp.relativePath.elementsSize++];
+        UA_RelativePathElement_init(e);
+        e->referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+        e->includeSubtypes = true;
+        e->targetName.namespaceIndex = 1;
+        e->targetName.name.length = len;
+        e->targetName.name.data = (UA_Byte*)(uintptr_t)pos;
+        pos += len;
+        if(*pos == '/')
+            pos++;
+    }
+
+    UA_TranslateBrowsePathsToNodeIdsRequest request;
+    UA_TranslateBrowsePathsToNodeIdsRequest_init(&request);
+    request.browsePathsSize = 1;
+    request.browsePaths = &bp;
+
+    UA_TranslateBrowsePathsToNodeIdsResponse response;
+    UA_TranslateBrowsePathsToNodeIdsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_TranslateBrowsePathsToNodeIds(server, &server->adminSession,
+                                          &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.resultsSize, 1);
+    UA_StatusCode res = response.results[0].statusCode;
+    if(target && response.results[0].targetsSize == 1)
+        UA_NodeId_copy(&response.results[0].targets[0].targetId.nodeId, target);
+    UA_TranslateBrowsePathsToNodeIdsResponse_clear(&response);
+    return res;
+}
+
+START_TEST(translateCached) {
+    UA_NodeId target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/B/C", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1003);
+
+    /* Root + three elements */
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 4);
+    ck_assert_uint_eq(stats.bpcs.hitCount, 0);
+
+    target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/B/C", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1003);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 4);
+    ck_assert_uint_eq(stats.bpcs.hitCount, 4);
+} END_TEST
+
+START_TEST(sharedPrefix) {
+    ck_assert_uint_eq(translate("A/B/C", NULL), UA_STATUSCODE_GOOD);
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    size_t hits = stats.bpcs.hitCount;
+
+    /* Root and A are reused */
+    UA_NodeId target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/D", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1004);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.hitCount, hits + 2);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 5);
+} END_TEST
+
+START_TEST(noMatchCached) {
+    ck_assert_uint_eq(translate("A/X/C", NULL), UA_STATUSCODE_BADNOMATCH);
+    ck_assert_uint_eq(translate("A/X/C", NULL), UA_STATUSCODE_BADNOMATCH);
+    ck_assert_uint_eq(translate("A/B/X", NULL), UA_STATUSCODE_BADNOMATCH);
+    ck_assert_uint_eq(translate("A/B/C", NULL), UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(addNodeInvalidates) {
+    ck_assert_uint_eq(translate("A/B/E", NULL), UA_STATUSCODE_BADNOMATCH);
+    addVariable(1005, 1002, "E");
+    UA_NodeId target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/B/E", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1005);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert(stats.bpcs.invalidationCount >= 1);
+} END_TEST
+
+START_TEST(addNodeKeepsOtherPaths) {
+    ck_assert_uint_eq(translate("A/B/C", NULL), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(translate("A/D", NULL), UA_STATUSCODE_GOOD);
+
+    /* Only A/B and A/B/C are removed */
+    addVariable(1005, 1002, "E");
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.invalidationCount, 2);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 3);
+
+    size_t hits = stats.bpcs.hitCount;
+    UA_NodeId target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/D", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1004);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.hitCount, hits + 3);
+} END_TEST
+
+START_TEST(deleteNodeInvalidates) {
+    ck_assert_uint_eq(translate("A/B/C", NULL), UA_STATUSCODE_GOOD);
+    UA_StatusCode retval = UA_Server_deleteNode(server, UA_NODEID_NUMERIC(1, 1003), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(translate("A/B/C", NULL), UA_STATUSCODE_BADNOMATCH);
+} END_TEST
+
+START_TEST(cacheFull) {
+    UA_Server_getConfig(server)->maxBrowsePathCacheSize = 2;
+    UA_NodeId target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/B/C", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1003);
+    target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/B/C", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1003);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 2);
+    ck_assert_uint_eq(stats.bpcs.hitCount, 2);
+} END_TEST
+
+START_TEST(evictLeastRecentlyUsed) {
+    UA_Server_getConfig(server)->maxBrowsePathCacheSize = 4;
+    ck_assert_uint_eq(translate("A/B/C", NULL), UA_STATUSCODE_GOOD);
+
+    /* The leaf A/B/C is evicted, the prefixes are kept */
+    UA_NodeId target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/D", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1004);
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 4);
+    ck_assert_uint_eq(stats.bpcs.evictionCount, 1);
+
+    /* Root, A and B are reused. A/D is evicted for C. */
+    size_t hits = stats.bpcs.hitCount;
+    target = UA_NODEID_NULL;
+    ck_assert_uint_eq(translate("A/B/C", &target), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(target.identifier.numeric, 1003);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.hitCount, hits + 3);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 4);
+    ck_assert_uint_eq(stats.bpcs.evictionCount, 2);
+} END_TEST
+
+START_TEST(unknownStartingNode) {
+    UA_RelativePathElement rpe;
+    UA_RelativePathElement_init(&rpe);
+    rpe.targetName = UA_QUALIFIEDNAME(1, "A");
+    UA_BrowsePath bp;
+    UA_BrowsePath_init(&bp);
+    bp.startingNode = UA_NODEID_NUMERIC(1, 999999);
+    bp.relativePath.elementsSize = 1;
+    bp.relativePath.elements = &rpe;
+    UA_BrowsePathResult res = UA_Server_translateBrowsePathToNodeIds(server, &bp);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    UA_BrowsePathResult_clear(&res);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.currentEntryCount, 0);
+} END_TEST
+
+static Suite * testSuite_browsePathCache(void) {
+    Suite *s = suite_create("Server BrowsePath Cache");
+    TCase *tc = tcase_create("Translate with cache");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, translateCached);
+    tcase_add_test(tc, sharedPrefix);
+    tcase_add_test(tc, noMatchCached);
+    tcase_add_test(tc, addNodeInvalidates);
+    tcase_add_test(tc, addNodeKeepsOtherPaths);
+    tcase_add_test(tc, deleteNodeInvalidates);
+    tcase_add_test(tc, cacheFull);
+    tcase_add_test(tc, evictLeastRecentlyUsed);
+    tcase_add_test(tc, unknownStartingNode);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_browsePathCache();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
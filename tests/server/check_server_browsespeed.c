@@ -0,0 +1,126 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Browse speed for a large and static address space. With and without the
+ * browse cache. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define FOLDERS 1000 /* Number of folders below the ObjectsFolder */
+#define VARIABLES 100 /* Number of variables in every folder */
+#define ROUNDS 5 /* How often every folder is browsed */
+
+static UA_Server *server;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    /* Add FOLDERS * VARIABLES nodes */
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&vattr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+        char name[20];
+        snprintf(name, 20, "Folder %u", i);
+        UA_NodeId folderId = UA_NODEID_NUMERIC(1, 100000 + i);
+        retval |= UA_Server_addObjectNode(server, folderId,
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                          UA_QUALIFIEDNAME(1, name),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                          oattr, NULL, NULL);
+        for(UA_UInt32 j = 0; j < VARIABLES; j++) {
+            snprintf(name, 20, "Variable %u", j);
+            retval |= UA_Server_addVariableNode(server,
+                                                UA_NODEID_NUMERIC(1, 200000 + (i * VARIABLES) + j),
+                                                folderId,
+                                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                                UA_QUALIFIEDNAME(1, name),
+                                                UA_NODEID_NULL, vattr, NULL, NULL);
+        }
+    }
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+static double
+browseFolders(void) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.includeSubtypes = true;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowseSize = 1;
+    request.nodesToBrowse = &bd;
+
+    UA_BrowseResponse response;
+    clock_t begin = clock();
+    for(size_t r = 0; r < ROUNDS; r++) {
+        for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+            bd.nodeId = UA_NODEID_NUMERIC(1, 100000 + i);
+            UA_BrowseResponse_init(&response);
+            UA_LOCK(&server->serviceMutex);
+            Service_Browse(server, &server->adminSession, &request, &response);
+            UA_UNLOCK(&server->serviceMutex);
+            ck_assert_uint_eq(response.resultsSize, 1);
+            ck_assert_uint_eq(response.results[0].referencesSize, VARIABLES);
+            UA_BrowseResponse_clear(&response);
+        }
+    }
+    clock_t finish = clock();
+    return (double)(finish - begin) / CLOCKS_PER_SEC;
+}
+
+START_TEST(browseSpeed) {
+    printf("duration was %f s\n", browseFolders());
+} END_TEST
+
+START_TEST(browseSpeedCached) {
+    UA_Server_getConfig(server)->maxBrowseCacheSize = FOLDERS;
+    printf("duration with cache was %f s\n", browseFolders());
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bcs.missCount, FOLDERS);
+    ck_assert_uint_eq(stats.bcs.hitCount, (ROUNDS - 1) * FOLDERS);
+} END_TEST
+
+static Suite * testSuite_browseSpeed(void) {
+    Suite *s = suite_create("Browse Speed");
+    TCase *tc = tcase_create("Browse");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, browseSpeed);
+    tcase_add_test(tc, browseSpeedCached);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_browseSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
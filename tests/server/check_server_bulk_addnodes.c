@@ -0,0 +1,346 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+static UA_Server *server;
+static UA_ObjectAttributes oattr;
+static UA_VariableAttributes vattr;
+static UA_ObjectTypeAttributes otattr;
+static UA_ReferenceTypeAttributes rtattr;
+static UA_Int32 myInteger = 42;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    oattr = UA_ObjectAttributes_default;
+    vattr = UA_VariableAttributes_default;
+    otattr = UA_ObjectTypeAttributes_default;
+    rtattr = UA_ReferenceTypeAttributes_default;
+    UA_Variant_setScalar(&vattr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+static void
+setItem(UA_AddNodesItem *item, UA_NodeClass nodeClass, UA_NodeId id,
+        UA_NodeId parent, UA_UInt32 refType, const char *name,
+        UA_NodeId typeDefinition) {
+    UA_AddNodesItem_init(item);
+    item->nodeClass = nodeClass;
+    item->requestedNewNodeId.nodeId = id;
+    item->parentNodeId.nodeId = parent;
+    item->referenceTypeId = UA_NODEID_NUMERIC(0, refType);
+    item->browseName = UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name);
+    item->typeDefinition.nodeId = typeDefinition;
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT:
+        UA_ExtensionObject_setValueNoDelete(&item->nodeAttributes, &oattr,
+                                            &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+        break;
+    case UA_NODECLASS_VARIABLE:
+        UA_ExtensionObject_setValueNoDelete(&item->nodeAttributes, &vattr,
+                                            &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES]);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        UA_ExtensionObject_setValueNoDelete(&item->nodeAttributes, &otattr,
+                                            &UA_TYPES[UA_TYPES_OBJECTTYPEATTRIBUTES]);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        UA_ExtensionObject_setValueNoDelete(&item->nodeAttributes, &rtattr,
+                                            &UA_TYPES[UA_TYPES_REFERENCETYPEATTRIBUTES]);
+        break;
+    default:
+        ck_abort();
+    }
+}
+
+static size_t
+countReferences(UA_NodeId nodeId, UA_BrowseDirection direction, UA_UInt32 refType) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = nodeId;
+    bd.browseDirection = direction;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, refType);
+    bd.includeSubtypes = true;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    size_t count = br.referencesSize;
+    UA_BrowseResult_clear(&br);
+    return count;
+}
+
+static void
+clearResults(UA_AddNodesResult *results, size_t size) {
+    for(size_t i = 0; i < size; i++)
+        UA_AddNodesResult_clear(&results[i]);
+}
+
+/* The children appear before their parent in the batch */
+START_TEST(addBatch) {
+    UA_AddNodesItem items[4];
+    UA_AddNodesResult results[4];
+    setItem(&items[0], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 1001),
+            UA_NODEID_NUMERIC(1, 1000), UA_NS0ID_HASCOMPONENT, "Var1", UA_NODEID_NULL);
+    setItem(&items[1], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 1002),
+            UA_NODEID_NUMERIC(1, 1000), UA_NS0ID_HASCOMPONENT, "Var2", UA_NODEID_NULL);
+    setItem(&items[2], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 1003),
+            UA_NODEID_NUMERIC(1, 1000), UA_NS0ID_HASCOMPONENT, "Var3", UA_NODEID_NULL);
+    setItem(&items[3], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 1000),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Folder", UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+
+    UA_StatusCode retval = UA_Server_addNodes(server, 4, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 4; i++) {
+        ck_assert_uint_eq(results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert(UA_NodeId_equal(&results[i].addedNodeId,
+                                  &items[i].requestedNewNodeId.nodeId));
+    }
+    clearResults(results, 4);
+
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 1000),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HASCOMPONENT), 3);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 1000),
+                                      UA_BROWSEDIRECTION_INVERSE,
+                                      UA_NS0ID_ORGANIZES), 1);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 1002),
+                                      UA_BROWSEDIRECTION_INVERSE,
+                                      UA_NS0ID_HASCOMPONENT), 1);
+
+    /* The default TypeDefinition was added */
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 1002),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HASTYPEDEFINITION), 1);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 1000),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HASTYPEDEFINITION), 1);
+
+    /* The value can be read */
+    UA_Variant value;
+    retval = UA_Server_readValue(server, UA_NODEID_NUMERIC(1, 1003), &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)value.data, 42);
+    UA_Variant_clear(&value);
+} END_TEST
+
+/* The failure of a node propagates to its children in the batch */
+START_TEST(failurePropagation) {
+    UA_AddNodesItem items[4];
+    UA_AddNodesResult results[4];
+    setItem(&items[0], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 2000),
+            UA_NODEID_NUMERIC(1, 999999), UA_NS0ID_ORGANIZES,
+            "Orphan", UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    setItem(&items[1], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 2001),
+            UA_NODEID_NUMERIC(1, 2000), UA_NS0ID_ORGANIZES,
+            "Child", UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    setItem(&items[2], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 2002),
+            UA_NODEID_NUMERIC(1, 2001), UA_NS0ID_HASCOMPONENT, "GrandChild",
+            UA_NODEID_NULL);
+    setItem(&items[3], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 2003),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Unrelated", UA_NODEID_NULL);
+
+    UA_StatusCode retval = UA_Server_addNodes(server, 4, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[0].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    ck_assert_uint_eq(results[1].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    ck_assert_uint_eq(results[2].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    ck_assert_uint_eq(results[3].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert(UA_NodeId_isNull(&results[0].addedNodeId));
+    clearResults(results, 4);
+
+    /* The failed nodes were removed */
+    UA_NodeClass nc;
+    retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, 2001), &nc);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, 2002), &nc);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, 2003), &nc);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(invalidReferenceType) {
+    UA_AddNodesItem items[2];
+    UA_AddNodesResult results[2];
+    /* HasTypeDefinition is not hierarchical */
+    setItem(&items[0], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 3000),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_HASTYPEDEFINITION,
+            "Invalid", UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    /* Duplicate NodeId */
+    setItem(&items[1], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Duplicate", UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    UA_StatusCode retval = UA_Server_addNodes(server, 2, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[0].statusCode, UA_STATUSCODE_BADREFERENCETYPEIDINVALID);
+    ck_assert_uint_eq(results[1].statusCode, UA_STATUSCODE_BADNODEIDEXISTS);
+    clearResults(results, 2);
+
+    /* The Server object is unchanged */
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                      UA_BROWSEDIRECTION_INVERSE,
+                                      UA_NS0ID_ORGANIZES), 1);
+} END_TEST
+
+/* Instantiate an ObjectType from a batch. The mandatory child is copied when
+ * the instance is finished. */
+START_TEST(instantiateType) {
+    UA_AddNodesItem items[2];
+    UA_AddNodesResult results[2];
+    setItem(&items[0], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 4001),
+            UA_NODEID_NUMERIC(1, 4000), UA_NS0ID_HASCOMPONENT, "Member",
+            UA_NODEID_NULL);
+    setItem(&items[1], UA_NODECLASS_OBJECTTYPE, UA_NODEID_NUMERIC(1, 4000),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE), UA_NS0ID_HASSUBTYPE,
+            "MyType", UA_NODEID_NULL);
+    UA_StatusCode retval = UA_Server_addNodes(server, 2, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[1].statusCode, UA_STATUSCODE_GOOD);
+    clearResults(results, 2);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 4000),
+                                      UA_BROWSEDIRECTION_INVERSE,
+                                      UA_NS0ID_HASSUBTYPE), 1);
+
+    retval = UA_Server_addReference(server, UA_NODEID_NUMERIC(1, 4001),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASMODELLINGRULE),
+                                    UA_EXPANDEDNODEID_NUMERIC(0, UA_NS0ID_MODELLINGRULE_MANDATORY),
+                                    true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    setItem(&items[0], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 4002),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Instance1", UA_NODEID_NUMERIC(1, 4000));
+    setItem(&items[1], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 4003),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Instance2", UA_NODEID_NUMERIC(1, 4000));
+    retval = UA_Server_addNodes(server, 2, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[1].statusCode, UA_STATUSCODE_GOOD);
+    clearResults(results, 2);
+
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 4002),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HASCOMPONENT), 1);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 4003),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HASCOMPONENT), 1);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 4000),
+                                      UA_BROWSEDIRECTION_INVERSE,
+                                      UA_NS0ID_HASTYPEDEFINITION), 2);
+} END_TEST
+
+/* A ReferenceType from the batch is used for the parent reference. The
+ * ReferenceType appears after the node that uses it. */
+START_TEST(referenceTypeInBatch) {
+    UA_AddNodesItem items[4];
+    UA_AddNodesResult results[4];
+    setItem(&items[0], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 6001),
+            UA_NODEID_NUMERIC(1, 6000), 0, "Child",
+            UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    items[0].referenceTypeId = UA_NODEID_NUMERIC(1, 6010);
+    setItem(&items[1], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 6000),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Parent", UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    setItem(&items[2], UA_NODECLASS_REFERENCETYPE, UA_NODEID_NUMERIC(1, 6010),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES), UA_NS0ID_HASSUBTYPE,
+            "MyOrganizes", UA_NODEID_NULL);
+    /* The parent reference of a ReferenceType that failed is invalid */
+    setItem(&items[3], UA_NODECLASS_REFERENCETYPE, UA_NODEID_NUMERIC(1, 6011),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_HASSUBTYPE,
+            "Invalid", UA_NODEID_NULL);
+    UA_StatusCode retval = UA_Server_addNodes(server, 4, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[1].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[2].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[3].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    clearResults(results, 4);
+
+    /* The reference of the new type is found as a subtype of Organizes */
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 6000),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_ORGANIZES), 1);
+
+    /* The failed ReferenceType was removed with its references */
+    UA_NodeClass nc;
+    retval = UA_Server_readNodeClass(server, UA_NODEID_NUMERIC(1, 6011), &nc);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HASSUBTYPE), 0);
+
+    /* A node that uses the failed ReferenceType fails as well */
+    setItem(&items[0], UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 6002),
+            UA_NODEID_NUMERIC(1, 6000), 0, "Child2",
+            UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE));
+    items[0].referenceTypeId = UA_NODEID_NUMERIC(1, 6012);
+    setItem(&items[1], UA_NODECLASS_REFERENCETYPE, UA_NODEID_NUMERIC(1, 6012),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_HASSUBTYPE,
+            "Invalid2", UA_NODEID_NULL);
+    retval = UA_Server_addNodes(server, 2, items, NULL, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[0].statusCode, UA_STATUSCODE_BADREFERENCETYPEIDINVALID);
+    ck_assert_uint_eq(results[1].statusCode, UA_STATUSCODE_BADPARENTNODEIDINVALID);
+    clearResults(results, 2);
+    ck_assert_uint_eq(countReferences(UA_NODEID_NUMERIC(1, 6000),
+                                      UA_BROWSEDIRECTION_FORWARD,
+                                      UA_NS0ID_HIERARCHICALREFERENCES), 1);
+} END_TEST
+
+START_TEST(nodeContexts) {
+    UA_AddNodesItem items[2];
+    UA_AddNodesResult results[2];
+    int ctx1 = 1, ctx2 = 2;
+    void *contexts[2] = {&ctx1, &ctx2};
+    setItem(&items[0], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 5000),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Var1", UA_NODEID_NULL);
+    setItem(&items[1], UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 5001),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), UA_NS0ID_ORGANIZES,
+            "Var2", UA_NODEID_NULL);
+    UA_StatusCode retval = UA_Server_addNodes(server, 2, items, contexts, results);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    clearResults(results, 2);
+
+    void *ctx = NULL;
+    retval = UA_Server_getNodeContext(server, UA_NODEID_NUMERIC(1, 5001), &ctx);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(ctx, &ctx2);
+} END_TEST
+
+static Suite * testSuite_bulkAddNodes(void) {
+    Suite *s = suite_create("Server Bulk AddNodes");
+    TCase *tc = tcase_create("Bulk AddNodes");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, addBatch);
+    tcase_add_test(tc, failurePropagation);
+    tcase_add_test(tc, invalidReferenceType);
+    tcase_add_test(tc, instantiateType);
+    tcase_add_test(tc, referenceTypeInBatch);
+    tcase_add_test(tc, nodeContexts);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_bulkAddNodes();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,265 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define VARIABLES 50 /* Number of variables in the folder */
+
+static UA_Server *server;
+static UA_NodeId folderId;
+
+/* Every second variable has a string NodeId. So the compact array contains
+ * immediate NodePointers and pointers to NodeIds. */
+static UA_NodeId
+variableId(UA_UInt32 i) {
+    if(i % 2 == 0)
+        return UA_NODEID_NUMERIC(1, 1000 + i);
+    static char buf[20];
+    snprintf(buf, 20, "Variable-%u", i);
+    return UA_NODEID_STRING(1, buf);
+}
+
+static void
+addVariable(UA_UInt32 i) {
+    char name[20];
+    snprintf(name, 20, "Variable %u", i);
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, variableId(i), folderId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, name),
+                                  UA_NODEID_NULL, vattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    folderId = UA_NODEID_NUMERIC(1, 100);
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, folderId,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Folder"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(UA_UInt32 i = 0; i < VARIABLES; i++)
+        addVariable(i);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+/* Check the ordering of the compact array and the name index. Returns the
+ * number of targets. */
+static size_t
+checkCompactFolder(void) {
+    const UA_Node *node = UA_NODESTORE_GET(server, &folderId);
+    ck_assert(node != NULL);
+    const UA_NodeReferenceKind *rk = NULL;
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        if(node->head.references[i].referenceTypeIndex ==
+           UA_REFERENCETYPEINDEX_HASCOMPONENT &&
+           !node->head.references[i].isInverse)
+            rk = &node->head.references[i];
+    }
+    ck_assert(rk != NULL);
+    ck_assert(rk->isCompact);
+    ck_assert(!rk->hasRefTree);
+
+    const UA_ReferenceTarget *array = rk->targets.compact.array;
+    const UA_UInt32 *nameIndex = rk->targets.compact.nameIndex;
+    UA_Boolean *seen = (UA_Boolean*)UA_calloc(rk->targetsSize, sizeof(UA_Boolean));
+    ck_assert(seen != NULL);
+    for(size_t i = 0; i < rk->targetsSize; i++) {
+        if(i > 0) {
+            ck_assert_int_eq(UA_NodePointer_order(array[i-1].targetId,
+                                                  array[i].targetId), UA_ORDER_LESS);
+            ck_assert_uint_le(array[nameIndex[i-1]].targetNameHash,
+                              array[nameIndex[i]].targetNameHash);
+        }
+        ck_assert_uint_lt(nameIndex[i], rk->targetsSize);
+        ck_assert(!seen[nameIndex[i]]);
+        seen[nameIndex[i]] = true;
+
+        /* Binary search finds every target */
+        UA_ExpandedNodeId en = UA_NodePointer_toExpandedNodeId(array[i].targetId);
+        ck_assert(UA_NodeReferenceKind_findTarget(rk, &en) == &array[i]);
+    }
+    UA_free(seen);
+    size_t size = rk->targetsSize;
+    UA_NODESTORE_RELEASE(server, node);
+    return size;
+}
+
+static size_t
+browseFolder(UA_UInt32 maxReferences) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = folderId;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+
+    size_t total = 0;
+    UA_BrowseResult br = UA_Server_browse(server, maxReferences, &bd);
+    while(true) {
+        ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+        total += br.referencesSize;
+        if(br.continuationPoint.length == 0)
+            break;
+        UA_ByteString cp = br.continuationPoint;
+        UA_ByteString_init(&br.continuationPoint);
+        UA_BrowseResult_clear(&br);
+        br = UA_Server_browseNext(server, false, &cp);
+        UA_ByteString_clear(&cp);
+    }
+    UA_BrowseResult_clear(&br);
+    return total;
+}
+
+static UA_StatusCode
+translateVariable(UA_UInt32 i, UA_NodeId *outId) {
+    char name[20];
+    snprintf(name, 20, "Variable %u", i);
+    UA_QualifiedName qn = UA_QUALIFIEDNAME(1, name);
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server, folderId, 1, &qn);
+    UA_StatusCode res = bpr.statusCode;
+    if(res == UA_STATUSCODE_GOOD) {
+        ck_assert_uint_eq(bpr.targetsSize, 1);
+        res = UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, outId);
+    }
+    UA_BrowsePathResult_clear(&bpr);
+    return res;
+}
+
+START_TEST(compactFolder) {
+    UA_StatusCode res = UA_Server_compactReferences(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(checkCompactFolder(), VARIABLES);
+    ck_assert_uint_eq(browseFolder(0), VARIABLES);
+
+    /* Lookup via the name index */
+    for(UA_UInt32 i = 0; i < VARIABLES; i++) {
+        UA_NodeId id;
+        res = translateVariable(i, &id);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_NodeId expected = variableId(i);
+        ck_assert(UA_NodeId_equal(&id, &expected));
+        UA_NodeId_clear(&id);
+    }
+
+    /* Compacting twice does nothing */
+    res = UA_Server_compactReferences(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(checkCompactFolder(), VARIABLES);
+} END_TEST
+
+START_TEST(compactAddDelete) {
+    UA_StatusCode res = UA_Server_compactReferences(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Add to the compact representation */
+    for(UA_UInt32 i = VARIABLES; i < VARIABLES + 10; i++)
+        addVariable(i);
+    ck_assert_uint_eq(checkCompactFolder(), VARIABLES + 10);
+
+    /* Remove from the compact representation */
+    for(UA_UInt32 i = 0; i < VARIABLES + 10; i += 3) {
+        res = UA_Server_deleteNode(server, variableId(i), true);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    size_t remaining = checkCompactFolder();
+    ck_assert_uint_eq(remaining, VARIABLES + 10 - 20);
+    ck_assert_uint_eq(browseFolder(0), remaining);
+
+    for(UA_UInt32 i = 0; i < VARIABLES + 10; i++) {
+        UA_NodeId id;
+        res = translateVariable(i, &id);
+        if(i % 3 == 0) {
+            ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+            continue;
+        }
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_NodeId_clear(&id);
+    }
+} END_TEST
+
+START_TEST(compactBrowseContinuation) {
+    UA_StatusCode res = UA_Server_compactReferences(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(browseFolder(7), VARIABLES);
+    ck_assert_uint_eq(browseFolder(1), VARIABLES);
+    ck_assert_uint_eq(browseFolder(VARIABLES), VARIABLES);
+} END_TEST
+
+START_TEST(compactCopyAndSwitch) {
+    UA_StatusCode res = UA_Server_compactReferences(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    const UA_Node *node = UA_NODESTORE_GET(server, &folderId);
+    ck_assert(node != NULL);
+    UA_Node *copy = UA_Node_copy_alloc(node);
+    UA_NODESTORE_RELEASE(server, node);
+    ck_assert(copy != NULL);
+
+    for(size_t i = 0; i < copy->head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &copy->head.references[i];
+        if(!rk->isCompact)
+            continue;
+        ck_assert_uint_eq(rk->targetsSize, VARIABLES);
+
+        /* Switch the copy to the tree and back */
+        res = UA_NodeReferenceKind_switch(rk);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(rk->hasRefTree);
+        ck_assert(!rk->isCompact);
+        res = UA_NodeReferenceKind_compact(rk);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(rk->isCompact);
+        ck_assert_uint_eq(rk->targetsSize, VARIABLES);
+        for(UA_UInt32 j = 0; j < VARIABLES; j++) {
+            UA_ExpandedNodeId en;
+            UA_ExpandedNodeId_init(&en);
+            en.nodeId = variableId(j);
+            ck_assert(UA_NodeReferenceKind_findTarget(rk, &en) != NULL);
+        }
+    }
+
+    UA_Node_clear(copy);
+    UA_free(copy);
+} END_TEST
+
+static Suite * testSuite_compactReferences(void) {
+    Suite *s = suite_create("Compact References");
+    TCase *tc = tcase_create("Compact");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, compactFolder);
+    tcase_add_test(tc, compactAddDelete);
+    tcase_add_test(tc, compactBrowseContinuation);
+    tcase_add_test(tc, compactCopyAndSwitch);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_compactReferences();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
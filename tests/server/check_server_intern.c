@@ -0,0 +1,192 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+static UA_Server *server;
+
+static void
+addFolder(const char *id, const UA_NodeId parent) {
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("en-US", "Folder");
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, UA_NODEID_STRING(1, (char*)(uintptr_t)id),
+                                parent, UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, (char*)(uintptr_t)id),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void
+addVariable(const char *id, const char *parent, const char *name) {
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    vattr.displayName = UA_LOCALIZEDTEXT("en-US", (char*)(uintptr_t)name);
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_STRING(1, (char*)(uintptr_t)id),
+                                  UA_NODEID_STRING(1, (char*)(uintptr_t)parent),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                  UA_NODEID_NULL, vattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    addFolder("Line1", UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER));
+    addFolder("Line2", UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER));
+    addVariable("Line1.Temperature", "Line1", "Temperature");
+    addVariable("Line2.Temperature", "Line2", "Temperature");
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+/* Returns the target of the first reference with the type and direction */
+static UA_NodePointer
+getTarget(const UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isInverse) {
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(rk->referenceTypeIndex == refTypeIndex && rk->isInverse == isInverse)
+            return rk->targets.array[0].targetId;
+    }
+    UA_NodePointer np;
+    UA_NodePointer_init(&np);
+    return np;
+}
+
+START_TEST(sharedReferenceTargets) {
+    /* Add a second reference to the variable */
+    UA_ExpandedNodeId target = UA_EXPANDEDNODEID_STRING(1, "Line1.Temperature");
+    UA_StatusCode retval =
+        UA_Server_addReference(server, UA_NODEID_STRING(1, "Line2"),
+                               UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                               target, true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Both parents point to the same NodeId */
+    UA_NodeId line1 = UA_NODEID_STRING(1, "Line1");
+    UA_NodeId line2 = UA_NODEID_STRING(1, "Line2");
+    const UA_Node *node1 = UA_NODESTORE_GET(server, &line1);
+    const UA_Node *node2 = UA_NODESTORE_GET(server, &line2);
+    ck_assert(node1 != NULL && node2 != NULL);
+    UA_NodePointer t1 = getTarget(node1, UA_REFERENCETYPEINDEX_HASCOMPONENT, false);
+    UA_NodePointer t2 = getTarget(node2, UA_REFERENCETYPEINDEX_ORGANIZES, false);
+    ck_assert(t1.immediate != 0);
+    ck_assert_uint_eq(t1.immediate, t2.immediate);
+
+    /* The inverse references of both variables point to the same parent */
+    UA_NodeId var2 = UA_NODEID_STRING(1, "Line2.Temperature");
+    const UA_Node *varNode = UA_NODESTORE_GET(server, &var2);
+    ck_assert(varNode != NULL);
+    UA_NodePointer p1 = getTarget(varNode, UA_REFERENCETYPEINDEX_HASCOMPONENT, true);
+    UA_NodeId target2 = UA_NodePointer_toNodeId(p1);
+    ck_assert(UA_NodeId_equal(&target2, &line2));
+
+    UA_NODESTORE_RELEASE(server, varNode);
+    UA_NODESTORE_RELEASE(server, node1);
+    UA_NODESTORE_RELEASE(server, node2);
+} END_TEST
+
+START_TEST(sharedNames) {
+    UA_NodeId var1 = UA_NODEID_STRING(1, "Line1.Temperature");
+    UA_NodeId var2 = UA_NODEID_STRING(1, "Line2.Temperature");
+    const UA_Node *node1 = UA_NODESTORE_GET(server, &var1);
+    const UA_Node *node2 = UA_NODESTORE_GET(server, &var2);
+    ck_assert(node1 != NULL && node2 != NULL);
+
+    ck_assert(node1->head.browseName.name.data == node2->head.browseName.name.data);
+    const UA_LocalizedText *dn1 = &node1->head.displayName->localizedText;
+    const UA_LocalizedText *dn2 = &node2->head.displayName->localizedText;
+    ck_assert(dn1->locale.data == dn2->locale.data);
+    ck_assert(dn1->text.data == dn2->text.data);
+
+    UA_NODESTORE_RELEASE(server, node1);
+    UA_NODESTORE_RELEASE(server, node2);
+} END_TEST
+
+START_TEST(releaseOnDelete) {
+    UA_InternTableStatistics before = UA_InternTable_getStatistics();
+
+    /* Deleting one variable releases the reference. The name is still used by
+     * the other variable. */
+    UA_StatusCode retval =
+        UA_Server_deleteNode(server, UA_NODEID_STRING(1, "Line2.Temperature"), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_InternTableStatistics after = UA_InternTable_getStatistics();
+    ck_assert_uint_lt(after.references, before.references);
+    ck_assert_uint_lt(after.savedBytes, before.savedBytes);
+
+    /* The remaining node is unchanged */
+    UA_QualifiedName bn;
+    retval = UA_Server_readBrowseName(server, UA_NODEID_STRING(1, "Line1.Temperature"), &bn);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_QualifiedName expected = UA_QUALIFIEDNAME(1, "Temperature");
+    ck_assert(UA_QualifiedName_equal(&bn, &expected));
+    UA_QualifiedName_clear(&bn);
+} END_TEST
+
+START_TEST(emptyAfterServerDelete) {
+    /* The global table is empty once all servers are deleted */
+    UA_Server_delete(server);
+    UA_InternTableStatistics stats = UA_InternTable_getStatistics();
+    ck_assert_uint_eq(stats.entries, 0);
+    ck_assert_uint_eq(stats.references, 0);
+    ck_assert_uint_eq(stats.bytes, 0);
+    ck_assert_uint_eq(stats.savedBytes, 0);
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+} END_TEST
+
+START_TEST(notInterned) {
+    /* Release also works for values that were not interned */
+    UA_String name = UA_STRING("Temperature");
+    UA_String s;
+    UA_StatusCode retval = UA_String_copy(&name, &s);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_InternTableStatistics before = UA_InternTable_getStatistics();
+    UA_InternTable_releaseString(&s);
+    UA_InternTableStatistics after = UA_InternTable_getStatistics();
+    ck_assert_uint_eq(before.references, after.references);
+    ck_assert_uint_eq(s.length, 0);
+
+    UA_NodeId line1 = UA_NODEID_STRING(1, "Line1");
+    UA_NodeId *id = UA_NodeId_new();
+    retval = UA_NodeId_copy(&line1, id);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_InternTable_releaseNodeId(id);
+    after = UA_InternTable_getStatistics();
+    ck_assert_uint_eq(before.references, after.references);
+} END_TEST
+
+static Suite * testSuite_intern(void) {
+    Suite *s = suite_create("Intern Table");
+    TCase *tc = tcase_create("Intern");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, sharedReferenceTargets);
+    tcase_add_test(tc, sharedNames);
+    tcase_add_test(tc, releaseOnDelete);
+    tcase_add_test(tc, emptyAfterServerDelete);
+    tcase_add_test(tc, notInterned);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_intern();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,222 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+/* The lookups are only counted if enabled */
+#ifdef UA_ENABLE_NODESTORE_STATISTICS
+# define LOOKUPS(n) (n)
+#else
+# define LOOKUPS(n) 0
+#endif
+
+static UA_Server *server;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+static UA_NodestoreStatistics
+getNodestoreStatistics(void) {
+    return UA_Server_getStatistics(server).ns;
+}
+
+START_TEST(operationCounters) {
+    UA_NodestoreStatistics before = getNodestoreStatistics();
+    ck_assert_uint_gt(before.nodeCount, 0);
+    ck_assert_uint_ge(before.capacity, before.nodeCount);
+    ck_assert_uint_eq(before.insertCount, before.nodeCount + before.removeCount);
+
+    /* Insert */
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 v = 42;
+    UA_Variant_setScalar(&vattr.value, &v, &UA_TYPES[UA_TYPES_INT32]);
+    UA_NodeId varId = UA_NODEID_NUMERIC(1, 5000);
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, varId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Variable"),
+                                  UA_NODEID_NULL, vattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_NodestoreStatistics after = getNodestoreStatistics();
+    ck_assert_uint_eq(after.nodeCount, before.nodeCount + 1);
+    ck_assert_uint_eq(after.insertCount, before.insertCount + 1);
+
+    /* Get */
+    before = after;
+    for(size_t i = 0; i < 10; i++) {
+        const UA_Node *node = UA_NODESTORE_GET(server, &varId);
+        ck_assert(node != NULL);
+        UA_NODESTORE_RELEASE(server, node);
+    }
+    after = getNodestoreStatistics();
+    ck_assert_uint_eq(after.getCount, before.getCount + LOOKUPS(10));
+
+    /* Copy and replace */
+    before = after;
+    UA_Node *copy = NULL;
+    res = UA_NODESTORE_GETCOPY(server, &varId, &copy);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_NODESTORE_REPLACE(server, copy);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    after = getNodestoreStatistics();
+    ck_assert_uint_eq(after.copyCount, before.copyCount + LOOKUPS(1));
+    ck_assert_uint_eq(after.replaceCount, before.replaceCount + 1);
+    ck_assert_uint_eq(after.replaceConflictCount, before.replaceConflictCount);
+
+    /* Replace with an outdated copy */
+    before = after;
+    UA_Node *copy1 = NULL;
+    UA_Node *copy2 = NULL;
+    res = UA_NODESTORE_GETCOPY(server, &varId, &copy1);
+    res |= UA_NODESTORE_GETCOPY(server, &varId, &copy2);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_NODESTORE_REPLACE(server, copy1);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_NODESTORE_REPLACE(server, copy2);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADINTERNALERROR);
+    after = getNodestoreStatistics();
+    ck_assert_uint_eq(after.replaceCount, before.replaceCount + 1);
+    ck_assert_uint_eq(after.replaceConflictCount, before.replaceConflictCount + 1);
+
+    /* Remove */
+    before = after;
+    res = UA_Server_deleteNode(server, varId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    after = getNodestoreStatistics();
+    ck_assert_uint_eq(after.nodeCount, before.nodeCount - 1);
+    ck_assert_uint_eq(after.removeCount, before.removeCount + 1);
+} END_TEST
+
+START_TEST(probeHistogram) {
+    UA_NodestoreStatistics before = getNodestoreStatistics();
+    UA_NodeId id = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    for(size_t i = 0; i < 100; i++) {
+        const UA_Node *node = UA_NODESTORE_GET(server, &id);
+        ck_assert(node != NULL);
+        UA_NODESTORE_RELEASE(server, node);
+    }
+
+    /* Every lookup lands in exactly one bucket */
+    UA_NodestoreStatistics after = getNodestoreStatistics();
+    size_t lookups = 0;
+    for(size_t i = 0; i < UA_NODESTORE_PROBEHISTOGRAMSIZE; i++) {
+        ck_assert_uint_ge(after.probeHistogram[i], before.probeHistogram[i]);
+        lookups += after.probeHistogram[i] - before.probeHistogram[i];
+    }
+    ck_assert_uint_eq(lookups, LOOKUPS(100));
+} END_TEST
+
+START_TEST(nodeClasses) {
+    UA_NodestoreStatistics stats = getNodestoreStatistics();
+    size_t nodes = 0;
+    for(size_t i = 0; i < UA_NODESTORE_NODECLASSES; i++) {
+        nodes += stats.nodeClassCount[i];
+        if(stats.nodeClassCount[i] > 0)
+            ck_assert_uint_gt(stats.nodeClassBytes[i], stats.nodeClassCount[i]);
+    }
+    ck_assert_uint_eq(nodes, stats.nodeCount);
+
+    /* ns0 contains nodes of every class except for views. The NodeClass
+     * values are single bits that give the index. */
+    ck_assert_uint_gt(stats.nodeClassCount[0], 0); /* Object */
+    ck_assert_uint_gt(stats.nodeClassCount[1], 0); /* Variable */
+    ck_assert_uint_gt(stats.nodeClassCount[5], 0); /* ReferenceType */
+    ck_assert_uint_gt(stats.nodeClassCount[6], 0); /* DataType */
+    ck_assert_uint_eq(stats.nodeClassCount[7], 0); /* View */
+
+    /* A large array value is counted for the variables */
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Double arr[1000];
+    memset(arr, 0, sizeof(arr));
+    UA_Variant_setArray(&vattr.value, arr, 1000, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 5000),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Array"),
+                                  UA_NODEID_NULL, vattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_NodestoreStatistics after = getNodestoreStatistics();
+    ck_assert_uint_ge(after.nodeClassBytes[1],
+                      stats.nodeClassBytes[1] + sizeof(arr));
+} END_TEST
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+START_TEST(diagnosticsVariables) {
+    /* Found below VendorServerInfo */
+    UA_QualifiedName path[2] = {UA_QUALIFIEDNAME(1, "NodestoreStatistics"),
+                                UA_QUALIFIEDNAME(1, "NodeCount")};
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server,
+                 UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_VENDORSERVERINFO), 2, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+
+    UA_Variant value;
+    UA_StatusCode res =
+        UA_Server_readValue(server, bpr.targets[0].targetId.nodeId, &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT64]));
+    ck_assert_uint_eq(*(UA_UInt64*)value.data, getNodestoreStatistics().nodeCount);
+    UA_Variant_clear(&value);
+    UA_BrowsePathResult_clear(&bpr);
+
+    /* Arrays per NodeClass */
+    res = UA_Server_readValue(server,
+                              UA_NODEID_STRING(1, "NodestoreStatistics.NodeClassBytes"),
+                              &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasArrayType(&value, &UA_TYPES[UA_TYPES_UINT64]));
+    ck_assert_uint_eq(value.arrayLength, UA_NODESTORE_NODECLASSES);
+    ck_assert_uint_gt(((UA_UInt64*)value.data)[0], 0);
+    UA_Variant_clear(&value);
+
+    res = UA_Server_readValue(server,
+                              UA_NODEID_STRING(1, "NodestoreStatistics.ProbeHistogram"),
+                              &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(value.arrayLength, UA_NODESTORE_PROBEHISTOGRAMSIZE);
+#ifdef UA_ENABLE_NODESTORE_STATISTICS
+    ck_assert_uint_gt(((UA_UInt64*)value.data)[0], 0);
+#endif
+    UA_Variant_clear(&value);
+} END_TEST
+#endif
+
+static Suite * testSuite_nodestoreStatistics(void) {
+    Suite *s = suite_create("Nodestore Statistics");
+    TCase *tc = tcase_create("Statistics");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, operationCounters);
+    tcase_add_test(tc, probeHistogram);
+    tcase_add_test(tc, nodeClasses);
+#ifdef UA_ENABLE_DIAGNOSTICS
+    tcase_add_test(tc, diagnosticsVariables);
+#endif
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_nodestoreStatistics();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
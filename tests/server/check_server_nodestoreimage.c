@@ -0,0 +1,258 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+static UA_ByteString image;
+static UA_UInt16 nsIndex;
+
+/* Creates a server with custom nodes and saves the image */
+static void setup(void) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    nsIndex = UA_Server_addNamespace(server, "http://example.org/image/");
+    ck_assert_uint_eq(nsIndex, 2);
+
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("en-US", "Folder");
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(nsIndex, 1000),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(nsIndex, "Folder"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_UInt32 dims[2] = {2, 2};
+    UA_Double values[4] = {1.0, 2.0, 3.0, 4.0};
+    UA_Variant_setArray(&vattr.value, values, 4, &UA_TYPES[UA_TYPES_DOUBLE]);
+    vattr.value.arrayDimensions = dims;
+    vattr.value.arrayDimensionsSize = 2;
+    vattr.arrayDimensions = dims;
+    vattr.arrayDimensionsSize = 2;
+    vattr.valueRank = UA_VALUERANK_TWO_DIMENSIONS;
+    vattr.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    vattr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    retval = UA_Server_addVariableNode(server, UA_NODEID_STRING(nsIndex, "Matrix"),
+                                       UA_NODEID_NUMERIC(nsIndex, 1000),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                       UA_QUALIFIEDNAME(nsIndex, "Matrix"),
+                                       UA_NODEID_NULL, vattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* A custom ReferenceType */
+    UA_ReferenceTypeAttributes rattr = UA_ReferenceTypeAttributes_default;
+    rattr.inverseName = UA_LOCALIZEDTEXT("", "IsSensorOf");
+    retval = UA_Server_addReferenceTypeNode(server, UA_NODEID_NUMERIC(nsIndex, 2000),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                            UA_QUALIFIEDNAME(nsIndex, "HasSensor"),
+                                            rattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_addReference(server, UA_NODEID_NUMERIC(nsIndex, 1000),
+                                    UA_NODEID_NUMERIC(nsIndex, 2000),
+                                    UA_EXPANDEDNODEID_STRING(nsIndex, "Matrix"), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    retval = UA_Server_saveNodestoreImage(server, &image);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(image.length > 0);
+    UA_Server_delete(server);
+}
+
+static void teardown(void) {
+    UA_ByteString_clear(&image);
+}
+
+static UA_Server *
+newServerFromImage(const UA_ByteString *img) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    UA_StatusCode retval = UA_ServerConfig_setDefault(&config);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    config.nodestoreImage = img;
+    return UA_Server_newWithConfig(&config);
+}
+
+START_TEST(loadImage) {
+    UA_Server *server = newServerFromImage(&image);
+    ck_assert(server != NULL);
+
+    /* Namespace */
+    size_t foundIndex = 0;
+    UA_StatusCode retval =
+        UA_Server_getNamespaceByName(server, UA_STRING("http://example.org/image/"),
+                                     &foundIndex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(foundIndex, nsIndex);
+
+    /* Value and attributes */
+    UA_Variant value;
+    retval = UA_Server_readValue(server, UA_NODEID_STRING(nsIndex, "Matrix"), &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(value.type == &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert_uint_eq(value.arrayLength, 4);
+    ck_assert_uint_eq(value.arrayDimensionsSize, 2);
+    ck_assert(((UA_Double*)value.data)[3] == 4.0);
+    UA_Variant_clear(&value);
+
+    UA_Int32 valueRank = 0;
+    retval = UA_Server_readValueRank(server, UA_NODEID_STRING(nsIndex, "Matrix"),
+                                     &valueRank);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(valueRank, UA_VALUERANK_TWO_DIMENSIONS);
+
+    UA_LocalizedText dn;
+    retval = UA_Server_readDisplayName(server, UA_NODEID_NUMERIC(nsIndex, 1000), &dn);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_String folder = UA_STRING("Folder");
+    ck_assert(UA_String_equal(&dn.text, &folder));
+    UA_LocalizedText_clear(&dn);
+
+    /* The value can be written */
+    UA_Double values[4] = {5.0, 6.0, 7.0, 8.0};
+    UA_UInt32 dims[2] = {2, 2};
+    UA_Variant_setArray(&value, values, 4, &UA_TYPES[UA_TYPES_DOUBLE]);
+    value.arrayDimensions = dims;
+    value.arrayDimensionsSize = 2;
+    retval = UA_Server_writeValue(server, UA_NODEID_STRING(nsIndex, "Matrix"), value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Server_delete(server);
+} END_TEST
+
+START_TEST(browseImage) {
+    UA_Server *server = newServerFromImage(&image);
+    ck_assert(server != NULL);
+
+    /* The custom ReferenceType is a subtype of the HierarchicalReferences */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(nsIndex, 1000);
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.includeSubtypes = true;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 2);
+    UA_BrowseResult_clear(&br);
+
+    bd.referenceTypeId = UA_NODEID_NUMERIC(nsIndex, 2000);
+    br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 1);
+    UA_BrowseResult_clear(&br);
+
+    /* Translate the path from the ObjectsFolder */
+    UA_QualifiedName names[2] = {UA_QUALIFIEDNAME(nsIndex, "Folder"),
+                                 UA_QUALIFIEDNAME(nsIndex, "Matrix")};
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server,
+                                             UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                             2, names);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+    UA_BrowsePathResult_clear(&bpr);
+
+    UA_Server_delete(server);
+} END_TEST
+
+/* The callbacks of ns0 are attached also when started from the image */
+START_TEST(ns0DataSource) {
+    UA_Server *server = newServerFromImage(&image);
+    ck_assert(server != NULL);
+    UA_Variant value;
+    UA_StatusCode retval =
+        UA_Server_readValue(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME),
+                            &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(value.type == &UA_TYPES[UA_TYPES_DATETIME]);
+    UA_Variant_clear(&value);
+
+    retval = UA_Server_readValue(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_NAMESPACEARRAY),
+                                 &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(value.arrayLength, 3);
+    UA_Variant_clear(&value);
+    UA_Server_delete(server);
+} END_TEST
+
+START_TEST(addNodesAfterLoad) {
+    UA_Server *server = newServerFromImage(&image);
+    ck_assert(server != NULL);
+
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 i = 42;
+    UA_Variant_setScalar(&vattr.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(nsIndex, 1001),
+                                  UA_NODEID_NUMERIC(nsIndex, 1000),
+                                  UA_NODEID_NUMERIC(nsIndex, 2000),
+                                  UA_QUALIFIEDNAME(nsIndex, "Sensor"),
+                                  UA_NODEID_NULL, vattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The image of the image contains one node more */
+    UA_ByteString image2;
+    retval = UA_Server_saveNodestoreImage(server, &image2);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(image2.length > image.length);
+    UA_Server_delete(server);
+
+    server = newServerFromImage(&image2);
+    ck_assert(server != NULL);
+    UA_Variant value;
+    retval = UA_Server_readValue(server, UA_NODEID_NUMERIC(nsIndex, 1001), &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)value.data, 42);
+    UA_Variant_clear(&value);
+    UA_Server_delete(server);
+    UA_ByteString_clear(&image2);
+} END_TEST
+
+START_TEST(corruptImage) {
+    /* Wrong magic number */
+    image.data[0] ^= 0xff;
+    UA_Server *server = newServerFromImage(&image);
+    ck_assert(server == NULL);
+    image.data[0] ^= 0xff;
+
+    /* Truncated */
+    UA_ByteString truncated = image;
+    truncated.length = image.length / 2;
+    server = newServerFromImage(&truncated);
+    ck_assert(server == NULL);
+} END_TEST
+
+static Suite * testSuite_nodestoreImage(void) {
+    Suite *s = suite_create("Server Nodestore Image");
+    TCase *tc = tcase_create("Nodestore Image");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, loadImage);
+    tcase_add_test(tc, browseImage);
+    tcase_add_test(tc, ns0DataSource);
+    tcase_add_test(tc, addNodesAfterLoad);
+    tcase_add_test(tc, corruptImage);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_nodestoreImage();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,284 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+
+#define NODES 100
+
+static UA_Server *server;
+static size_t dataSourceReads;
+
+static UA_StatusCode
+readDataSource(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+               const UA_NodeId *nodeId, void *nodeContext,
+               UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+               UA_DataValue *value) {
+    dataSourceReads++;
+    UA_Int32 v = 23;
+    UA_Variant_setScalarCopy(&value->value, &v, &UA_TYPES[UA_TYPES_INT32]);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Even NodeIds are variables with the value in the node. Odd NodeIds are
+ * DataSource variables. */
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_DataSource dataSource;
+    dataSource.read = readDataSource;
+    dataSource.write = NULL;
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        char name[20];
+        snprintf(name, 20, "Variable %u", i);
+        UA_StatusCode res;
+        if(i % 2 == 0) {
+            res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 1000 + i),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, name), UA_NODEID_NULL,
+                                            attr, NULL, NULL);
+        } else {
+            res = UA_Server_addDataSourceVariableNode(server, UA_NODEID_NUMERIC(1, 1000 + i),
+                                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                                      UA_QUALIFIEDNAME(1, name),
+                                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                                      attr, dataSource, NULL, NULL);
+        }
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+#if UA_MULTITHREADING >= 100
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->maxParallelOperationThreads = 4;
+    config->minParallelOperations = 10;
+#endif
+    UA_StatusCode res = UA_Server_run_startup(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+    ck_assert_uint_eq(server->operationWorkers.threadsSize, 3);
+#endif
+    dataSourceReads = 0;
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+START_TEST(readParallel) {
+    UA_ReadValueId rvi[NODES + 1];
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_NUMERIC(1, 1000 + i);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadValueId_init(&rvi[NODES]);
+    rvi[NODES].nodeId = UA_NODEID_NUMERIC(1, 999);
+    rvi[NODES].attributeId = UA_ATTRIBUTEID_VALUE;
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToReadSize = NODES + 1;
+    request.nodesToRead = rvi;
+
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Read(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* The DataSource reads were processed sequentially */
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, NODES + 1);
+    ck_assert_uint_eq(dataSourceReads, NODES / 2);
+    for(size_t i = 0; i < NODES; i++) {
+        ck_assert(response.results[i].hasValue);
+        ck_assert_int_eq(*(UA_Int32*)response.results[i].value.data,
+                         (i % 2 == 0) ? 42 : 23);
+    }
+    ck_assert_uint_eq(response.results[NODES].status, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
+START_TEST(browseParallel) {
+    /* The last browse needs a continuation point */
+    UA_BrowseDescription bd[NODES];
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        UA_BrowseDescription_init(&bd[i]);
+        bd[i].nodeId = UA_NODEID_NUMERIC(1, 1000 + i);
+        bd[i].browseDirection = UA_BROWSEDIRECTION_BOTH;
+        bd[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+    bd[NODES - 1].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.requestedMaxReferencesPerNode = 5;
+    request.nodesToBrowseSize = NODES;
+    request.nodesToBrowse = bd;
+
+    UA_BrowseResponse response;
+    UA_BrowseResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Browse(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, NODES);
+    for(size_t i = 0; i < NODES - 1; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.results[i].referencesSize, 2);
+        ck_assert_uint_eq(response.results[i].continuationPoint.length, 0);
+    }
+    ck_assert_uint_eq(response.results[NODES - 1].referencesSize, 5);
+    ck_assert(response.results[NODES - 1].continuationPoint.length > 0);
+    UA_BrowseResponse_clear(&response);
+} END_TEST
+
+START_TEST(translateParallel) {
+    UA_RelativePathElement rpe[NODES];
+    UA_BrowsePath bp[NODES];
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        char name[20];
+        snprintf(name, 20, "Variable %u", i);
+        UA_RelativePathElement_init(&rpe[i]);
+        rpe[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+        rpe[i].targetName = UA_QUALIFIEDNAME_ALLOC(1, name);
+        UA_BrowsePath_init(&bp[i]);
+        bp[i].startingNode = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        bp[i].relativePath.elementsSize = 1;
+        bp[i].relativePath.elements = &rpe[i];
+    }
+
+    UA_TranslateBrowsePathsToNodeIdsRequest request;
+    UA_TranslateBrowsePathsToNodeIdsRequest_init(&request);
+    request.browsePathsSize = NODES;
+    request.browsePaths = bp;
+
+    UA_TranslateBrowsePathsToNodeIdsResponse response;
+    UA_TranslateBrowsePathsToNodeIdsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_TranslateBrowsePathsToNodeIds(server, &server->adminSession,
+                                          &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, NODES);
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.results[i].targetsSize, 1);
+        UA_NodeId target = UA_NODEID_NUMERIC(1, 1000 + i);
+        ck_assert(UA_NodeId_equal(&response.results[i].targets[0].targetId.nodeId,
+                                  &target));
+        UA_QualifiedName_clear(&rpe[i].targetName);
+    }
+    UA_TranslateBrowsePathsToNodeIdsResponse_clear(&response);
+} END_TEST
+
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+static pthread_t serviceThread;
+static size_t allowBrowseCalls;
+static UA_Boolean allowBrowseOtherThread;
+
+static UA_Boolean
+allowBrowseNode(UA_Server *s, UA_AccessControl *ac,
+                const UA_NodeId *sessionId, void *sessionContext,
+                const UA_NodeId *nodeId, void *nodeContext) {
+    __atomic_fetch_add(&allowBrowseCalls, 1, __ATOMIC_RELAXED);
+    if(!pthread_equal(pthread_self(), serviceThread))
+        __atomic_store_n(&allowBrowseOtherThread, true, __ATOMIC_RELAXED);
+    return true;
+}
+
+static void
+browseWithSession(UA_Session *session) {
+    UA_BrowseDescription bd[NODES];
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        UA_BrowseDescription_init(&bd[i]);
+        bd[i].nodeId = UA_NODEID_NUMERIC(1, 1000 + i);
+        bd[i].browseDirection = UA_BROWSEDIRECTION_BOTH;
+        bd[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowseSize = NODES;
+    request.nodesToBrowse = bd;
+
+    UA_BrowseResponse response;
+    UA_BrowseResponse_init(&response);
+    Service_Browse(server, session, &request, &response);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, NODES);
+    for(size_t i = 0; i < NODES; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.results[i].referencesSize, 2);
+    }
+    UA_BrowseResponse_clear(&response);
+}
+
+/* The AccessControl is only called from worker threads if configured */
+START_TEST(browseParallelAccessControl) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->accessControl.allowBrowseNode = allowBrowseNode;
+    serviceThread = pthread_self();
+
+    UA_Session session;
+    UA_Session_init(&session);
+    session.sessionId = UA_NODEID_NUMERIC(0, 4242);
+
+    UA_LOCK(&server->serviceMutex);
+    allowBrowseCalls = 0;
+    allowBrowseOtherThread = false;
+    browseWithSession(&session);
+    ck_assert_uint_eq(allowBrowseCalls, NODES);
+    ck_assert(!allowBrowseOtherThread);
+
+    config->parallelAccessControl = true;
+    allowBrowseCalls = 0;
+    browseWithSession(&session);
+    ck_assert_uint_eq(allowBrowseCalls, NODES);
+
+    UA_Session_clear(&session, server);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+#endif
+
+static Suite * testSuite_parallelOperations(void) {
+    Suite *s = suite_create("Server Parallel Operations");
+    TCase *tc = tcase_create("Parallel Operations");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, readParallel);
+    tcase_add_test(tc, browseParallel);
+    tcase_add_test(tc, translateParallel);
+#if UA_MULTITHREADING >= 100 && defined(UA_ARCHITECTURE_POSIX)
+    tcase_add_test(tc, browseParallelAccessControl);
+#endif
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_parallelOperations();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
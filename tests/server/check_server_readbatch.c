@@ -0,0 +1,364 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+
+#define NODES 4 /* DataSource variables with the same read callback */
+
+static UA_Server *server;
+static UA_Session *session;
+static size_t readCount;
+static size_t batchCount;
+static size_t batchItemCount;
+static UA_StatusCode batchResult;
+static UA_Boolean batchSkipFirst;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+static UA_UInt32 subscriptionId;
+static UA_UInt32 replaceItemId; /* Replace the MonitoredItem during the batch */
+static void replaceMonitoredItem(void);
+#endif
+
+static UA_StatusCode
+readNodeId(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+           const UA_NodeId *nodeId, void *nodeContext,
+           UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+           UA_DataValue *value) {
+    readCount++;
+    UA_Variant_setScalarCopy(&value->value, &nodeId->identifier.numeric,
+                             &UA_TYPES[UA_TYPES_UINT32]);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+readOther(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+          const UA_NodeId *nodeId, void *nodeContext,
+          UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+          UA_DataValue *value) {
+    return readNodeId(s, sessionId, sessionContext, nodeId, nodeContext,
+                      includeSourceTimeStamp, range, value);
+}
+
+/* Returns the NodeId plus 1000 so that batched reads can be distinguished */
+static UA_StatusCode
+readBatch(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+          const UA_DataSource *dataSource, UA_Boolean includeSourceTimeStamp,
+          size_t itemsSize, UA_DataSourceReadItem *items) {
+    if(dataSource->read != readNodeId)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    batchCount++;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    if(replaceItemId != 0)
+        replaceMonitoredItem();
+#endif
+    if(batchResult != UA_STATUSCODE_GOOD)
+        return batchResult;
+    for(size_t i = batchSkipFirst ? 1 : 0; i < itemsSize; i++) {
+        UA_UInt32 v = items[i].nodeId->identifier.numeric + 1000;
+        UA_Variant_setScalarCopy(&items[i].value.value, &v, &UA_TYPES[UA_TYPES_UINT32]);
+        items[i].value.hasValue = true;
+        batchItemCount++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addDataSourceVariable(UA_UInt32 id, UA_DataSource dataSource) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.valueRank = UA_VALUERANK_ANY;
+    UA_StatusCode retval =
+        UA_Server_addDataSourceVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "Variable"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, dataSource, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_DataSource ds;
+    ds.read = readNodeId;
+    ds.write = NULL;
+    for(UA_UInt32 i = 1; i <= NODES; i++)
+        addDataSourceVariable(i, ds);
+    ds.read = readOther;
+    addDataSourceVariable(NODES + 1, ds);
+
+    UA_Server_getConfig(server)->readDataSourceBatch = readBatch;
+    UA_Server_run_startup(server);
+
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    request.requestedSessionTimeout = UA_UINT32_MAX;
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode retval = UA_Server_createSession(server, NULL, &request, &session);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    readCount = 0;
+    batchCount = 0;
+    batchItemCount = 0;
+    batchResult = UA_STATUSCODE_GOOD;
+    batchSkipFirst = false;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    subscriptionId = 0;
+    replaceItemId = 0;
+#endif
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* Read all DataSource variables, one index range, and a node attribute */
+static void
+readAll(UA_UInt32 *values) {
+    UA_ReadValueId rvi[NODES + 3];
+    for(size_t i = 0; i < NODES + 3; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_NUMERIC(1, (UA_UInt32)i + 1);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    rvi[NODES + 1].nodeId = UA_NODEID_NUMERIC(1, 1);
+    rvi[NODES + 1].indexRange = UA_STRING("0");
+    rvi[NODES + 2].nodeId = UA_NODEID_NUMERIC(1, 1);
+    rvi[NODES + 2].attributeId = UA_ATTRIBUTEID_NODEID;
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToReadSize = NODES + 3;
+    request.nodesToRead = rvi;
+
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Read(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, NODES + 3);
+    for(size_t i = 0; i < NODES + 2; i++) {
+        ck_assert(response.results[i].hasValue);
+        ck_assert(UA_Variant_hasScalarType(&response.results[i].value,
+                                           &UA_TYPES[UA_TYPES_UINT32]));
+        values[i] = *(UA_UInt32*)response.results[i].value.data;
+    }
+    ck_assert(UA_Variant_hasScalarType(&response.results[NODES + 2].value,
+                                       &UA_TYPES[UA_TYPES_NODEID]));
+    UA_ReadResponse_clear(&response);
+}
+
+START_TEST(readBatched) {
+    UA_UInt32 values[NODES + 2];
+    readAll(values);
+
+    /* One batch for the DataSources with the same read callback. Individual
+     * reads for the other DataSource and for the index range. */
+    ck_assert_uint_eq(batchCount, 1);
+    ck_assert_uint_eq(batchItemCount, NODES);
+    ck_assert_uint_eq(readCount, 2);
+    for(UA_UInt32 i = 0; i < NODES; i++)
+        ck_assert_uint_eq(values[i], i + 1 + 1000);
+    ck_assert_uint_eq(values[NODES], NODES + 1);
+    ck_assert_uint_eq(values[NODES + 1], 1);
+} END_TEST
+
+START_TEST(readBatchIncomplete) {
+    /* The first item of the batch is not set and read individually */
+    batchSkipFirst = true;
+    UA_UInt32 values[NODES + 2];
+    readAll(values);
+    ck_assert_uint_eq(batchCount, 1);
+    ck_assert_uint_eq(batchItemCount, NODES - 1);
+    ck_assert_uint_eq(readCount, 3);
+    ck_assert_uint_eq(values[0], 1);
+    for(UA_UInt32 i = 1; i < NODES; i++)
+        ck_assert_uint_eq(values[i], i + 1 + 1000);
+} END_TEST
+
+START_TEST(readBatchFailed) {
+    /* All items are read individually */
+    batchResult = UA_STATUSCODE_BADINTERNALERROR;
+    UA_UInt32 values[NODES + 2];
+    readAll(values);
+    ck_assert_uint_eq(batchCount, 1);
+    ck_assert_uint_eq(readCount, NODES + 2);
+    for(UA_UInt32 i = 0; i < NODES; i++)
+        ck_assert_uint_eq(values[i], i + 1);
+} END_TEST
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+static UA_UInt32
+createMonitoredItem(UA_UInt32 nodeIdNumeric) {
+    /* Sample in the publishing interval of the subscription */
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = UA_NODEID_NUMERIC(1, nodeIdNumeric);
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item.requestedParameters.samplingInterval = -1.0;
+    item.requestedParameters.queueSize = 1;
+    item.requestedParameters.clientHandle = nodeIdNumeric;
+
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    request.itemsToCreateSize = 1;
+    request.itemsToCreate = &item;
+    UA_CreateMonitoredItemsResponse response;
+    UA_CreateMonitoredItemsResponse_init(&response);
+    Service_CreateMonitoredItems(server, session, &request, &response);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    UA_UInt32 monitoredItemId = response.results[0].monitoredItemId;
+    UA_CreateMonitoredItemsResponse_clear(&response);
+    return monitoredItemId;
+}
+
+/* Called from the batch callback where the service lock is released. Delete a
+ * MonitoredItem and create a new one for a node that is not batched. The new
+ * MonitoredItem likely reuses the memory of the deleted one. */
+static void
+replaceMonitoredItem(void) {
+    UA_DeleteMonitoredItemsRequest request;
+    UA_DeleteMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.monitoredItemIdsSize = 1;
+    request.monitoredItemIds = &replaceItemId;
+    UA_DeleteMonitoredItemsResponse response;
+    UA_DeleteMonitoredItemsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_DeleteMonitoredItems(server, session, &request, &response);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0], UA_STATUSCODE_GOOD);
+    createMonitoredItem(NODES + 1);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_DeleteMonitoredItemsResponse_clear(&response);
+    replaceItemId = 0;
+}
+
+static UA_Subscription *
+createSubscriptionWithItems(void) {
+    UA_CreateSubscriptionRequest subRequest;
+    UA_CreateSubscriptionRequest_init(&subRequest);
+    subRequest.publishingEnabled = true;
+    UA_CreateSubscriptionResponse subResponse;
+    UA_CreateSubscriptionResponse_init(&subResponse);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateSubscription(server, session, &subRequest, &subResponse);
+    ck_assert_uint_eq(subResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    subscriptionId = subResponse.subscriptionId;
+    for(UA_UInt32 i = 1; i <= NODES; i++)
+        createMonitoredItem(i);
+    UA_Subscription *sub = UA_Session_getSubscriptionById(session, subscriptionId);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_ptr_ne(sub, NULL);
+    UA_CreateSubscriptionResponse_clear(&subResponse);
+
+    readCount = 0;
+    batchCount = 0;
+    batchItemCount = 0;
+    return sub;
+}
+
+START_TEST(sampleBatched) {
+    UA_Subscription *sub = createSubscriptionWithItems();
+
+    /* All MonitoredItems are sampled in one batch */
+    UA_LOCK(&server->serviceMutex);
+    UA_Subscription_sampleAndPublish(server, sub);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(batchCount, 1);
+    ck_assert_uint_eq(batchItemCount, NODES);
+    ck_assert_uint_eq(readCount, 0);
+
+    /* The batched values were sampled with the timestamps of the
+     * MonitoredItem */
+    UA_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->samplingMonitoredItems, sampling.samplingListEntry) {
+        ck_assert(UA_Variant_hasScalarType(&mon->lastValue.value,
+                                           &UA_TYPES[UA_TYPES_UINT32]));
+        ck_assert_uint_eq(*(UA_UInt32*)mon->lastValue.value.data,
+                          mon->itemToMonitor.nodeId.identifier.numeric + 1000);
+        ck_assert(mon->lastValue.hasServerTimestamp);
+        ck_assert(!mon->lastValue.hasSourceTimestamp);
+    }
+} END_TEST
+
+START_TEST(sampleBatchedReplaced) {
+    UA_Subscription *sub = createSubscriptionWithItems();
+
+    /* Replace the MonitoredItem of the first node during the batch */
+    UA_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->samplingMonitoredItems, sampling.samplingListEntry) {
+        if(mon->itemToMonitor.nodeId.identifier.numeric == 1)
+            replaceItemId = mon->monitoredItemId;
+    }
+    ck_assert_uint_ne(replaceItemId, 0);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_Subscription_sampleAndPublish(server, sub);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(batchCount, 1);
+    ck_assert_uint_eq(replaceItemId, 0);
+
+    /* No MonitoredItem received the value of another node */
+    size_t count = 0;
+    LIST_FOREACH(mon, &sub->samplingMonitoredItems, sampling.samplingListEntry) {
+        UA_UInt32 id = mon->itemToMonitor.nodeId.identifier.numeric;
+        ck_assert(UA_Variant_hasScalarType(&mon->lastValue.value,
+                                           &UA_TYPES[UA_TYPES_UINT32]));
+        UA_UInt32 v = *(UA_UInt32*)mon->lastValue.value.data;
+        if(id == NODES + 1)
+            ck_assert_uint_eq(v, NODES + 1);
+        else
+            ck_assert_uint_eq(v, id + 1000);
+        count++;
+    }
+    ck_assert_uint_eq(count, NODES);
+} END_TEST
+#endif
+
+static Suite * testSuite_readBatch(void) {
+    Suite *s = suite_create("Server Batched DataSource Reads");
+    TCase *tc = tcase_create("Batched reads");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, readBatched);
+    tcase_add_test(tc, readBatchIncomplete);
+    tcase_add_test(tc, readBatchFailed);
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    tcase_add_test(tc, sampleBatched);
+    tcase_add_test(tc, sampleBatchedReplaced);
+#endif
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_readBatch();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -190,6 +190,89 @@ START_TEST(readSpeedWithEncoding) {
 }
 END_TEST
 
+#define LARGEREADNODES 10000 /* Number of operations in the large request */
+#define LARGEREADS 20
+
+/* The wall-clock time in seconds. The operations might be processed in
+ * parallel. So the cpu time from clock() does not apply. The UA_DateTime
+ * methods are replaced by the testing clock. */
+static double
+wallTime(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+#endif
+}
+
+/* Read all values in one large request */
+static double
+readLargeRequest(UA_ReadRequest *request) {
+    UA_ReadResponse res;
+    double begin = wallTime();
+    for(size_t i = 0; i < LARGEREADS; i++) {
+        UA_ReadResponse_init(&res);
+        UA_LOCK(&server->serviceMutex);
+        Service_Read(server, &server->adminSession, request, &res);
+        UA_UNLOCK(&server->serviceMutex);
+        ck_assert_uint_eq(res.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(res.resultsSize, LARGEREADNODES);
+        for(size_t j = 0; j < res.resultsSize; j++) {
+            ck_assert(res.results[j].hasValue);
+            ck_assert_int_eq(*(UA_Int32*)res.results[j].value.data, 42);
+        }
+        UA_ReadResponse_clear(&res);
+    }
+    return wallTime() - begin;
+}
+
+START_TEST(readSpeedLargeRequest) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_NodeId parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    UA_NodeId parentReferenceNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+
+    UA_ReadValueId *rvi = (UA_ReadValueId*)
+        UA_Array_new(LARGEREADNODES, &UA_TYPES[UA_TYPES_READVALUEID]);
+    ck_assert(rvi != NULL);
+    for(size_t i = 0; i < LARGEREADNODES; i++) {
+        char varName[20];
+        snprintf(varName, 20, "Variable %u", (UA_UInt32)i);
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, UA_NODEID_STRING(1, varName),
+                                      parentNodeId, parentReferenceNodeId,
+                                      UA_QUALIFIEDNAME(1, varName), UA_NODEID_NULL,
+                                      attr, NULL, &rvi[i].nodeId);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToReadSize = LARGEREADNODES;
+    request.nodesToRead = rvi;
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->maxNodesPerRead = 0;
+    printf("duration was %f s\n", readLargeRequest(&request));
+
+#if UA_MULTITHREADING >= 100
+    config->maxParallelOperationThreads = 4;
+    config->minParallelOperations = 1000;
+    UA_StatusCode res = UA_Server_run_startup(server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    printf("duration with 4 threads was %f s\n", readLargeRequest(&request));
+    UA_Server_run_shutdown(server);
+#endif
+
+    UA_Array_delete(rvi, LARGEREADNODES, &UA_TYPES[UA_TYPES_READVALUEID]);
+}
+END_TEST
+
 static Suite * service_speed_suite (void) {
     Suite *s = suite_create ("Service Speed");
 
@@ -197,6 +280,7 @@ static Suite * service_speed_suite (void) {
     tcase_add_checked_fixture(tc_read, setup, teardown);
     tcase_add_test (tc_read, readSpeed);
     tcase_add_test (tc_read, readSpeedWithEncoding);
+    tcase_add_test (tc_read, readSpeedLargeRequest);
     suite_add_tcase (s, tc_read);
 
     return s;
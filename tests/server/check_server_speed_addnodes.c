@@ -52,6 +52,104 @@ START_TEST(addVariable) {
 }
 END_TEST
 
+/* Compare adding a hierarchy of folders and variables node by node with
+ * adding the same nodes in a single batch */
+#define FOLDERS 200
+#define VARIABLES 100
+
+static UA_ObjectAttributes oattr;
+static UA_VariableAttributes vattr;
+static UA_AddNodesItem *items;
+static UA_AddNodesResult *results;
+static char (*names)[20];
+
+static void setupBatch(void) {
+    setup();
+    oattr = UA_ObjectAttributes_default;
+    vattr = UA_VariableAttributes_default;
+    static UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&vattr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+
+    size_t itemsSize = FOLDERS * (VARIABLES + 1);
+    items = (UA_AddNodesItem*)UA_calloc(itemsSize, sizeof(UA_AddNodesItem));
+    results = (UA_AddNodesResult*)UA_calloc(itemsSize, sizeof(UA_AddNodesResult));
+    names = (char (*)[20])UA_calloc(itemsSize, 20);
+    ck_assert(items && results && names);
+
+    size_t pos = 0;
+    for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+        UA_AddNodesItem *item = &items[pos];
+        snprintf(names[pos], 20, "Folder %u", i);
+        item->nodeClass = UA_NODECLASS_OBJECT;
+        item->requestedNewNodeId.nodeId = UA_NODEID_NUMERIC(1, 100000 + i);
+        item->parentNodeId.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        item->referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+        item->browseName = UA_QUALIFIEDNAME(1, names[pos]);
+        item->typeDefinition.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE);
+        UA_ExtensionObject_setValueNoDelete(&item->nodeAttributes, &oattr,
+                                            &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+        pos++;
+        for(UA_UInt32 j = 0; j < VARIABLES; j++) {
+            item = &items[pos];
+            snprintf(names[pos], 20, "Variable %u", j);
+            item->nodeClass = UA_NODECLASS_VARIABLE;
+            item->requestedNewNodeId.nodeId =
+                UA_NODEID_NUMERIC(1, 200000 + (i * VARIABLES) + j);
+            item->parentNodeId.nodeId = UA_NODEID_NUMERIC(1, 100000 + i);
+            item->referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+            item->browseName = UA_QUALIFIEDNAME(1, names[pos]);
+            UA_ExtensionObject_setValueNoDelete(&item->nodeAttributes, &vattr,
+                                                &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES]);
+            pos++;
+        }
+    }
+}
+
+static void teardownBatch(void) {
+    for(size_t i = 0; i < FOLDERS * (VARIABLES + 1); i++)
+        UA_AddNodesResult_clear(&results[i]);
+    UA_free(items);
+    UA_free(results);
+    UA_free(names);
+    teardown();
+}
+
+START_TEST(addNodesOneByOne) {
+    clock_t begin = clock();
+    for(size_t i = 0; i < FOLDERS * (VARIABLES + 1); i++) {
+        const UA_AddNodesItem *item = &items[i];
+        UA_StatusCode retval =
+            UA_Server_addNode_begin(server, item->nodeClass,
+                                    item->requestedNewNodeId.nodeId,
+                                    item->parentNodeId.nodeId, item->referenceTypeId,
+                                    item->browseName, item->typeDefinition.nodeId,
+                                    item->nodeAttributes.content.decoded.data,
+                                    item->nodeAttributes.content.decoded.type,
+                                    NULL, NULL);
+        retval |= UA_Server_addNode_finish(server, item->requestedNewNodeId.nodeId);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    clock_t finish = clock();
+    printf("%u nodes one by one:\t Duration was %f s\n",
+           (unsigned)(FOLDERS * (VARIABLES + 1)),
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+}
+END_TEST
+
+START_TEST(addNodesBulk) {
+    clock_t begin = clock();
+    UA_StatusCode retval =
+        UA_Server_addNodes(server, FOLDERS * (VARIABLES + 1), items, NULL, results);
+    clock_t finish = clock();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < FOLDERS * (VARIABLES + 1); i++)
+        ck_assert_uint_eq(results[i].statusCode, UA_STATUSCODE_GOOD);
+    printf("%u nodes in bulk:\t Duration was %f s\n",
+           (unsigned)(FOLDERS * (VARIABLES + 1)),
+           (double)(finish - begin) / CLOCKS_PER_SEC);
+}
+END_TEST
+
 static Suite * service_speed_suite (void) {
     Suite *s = suite_create ("Service Speed");
 
@@ -60,6 +158,13 @@ static Suite * service_speed_suite (void) {
     tcase_add_test(tc_addnodes, addVariable);
     suite_add_tcase(s, tc_addnodes);
 
+    TCase* tc_bulk = tcase_create ("Bulk AddNodes");
+    tcase_add_checked_fixture(tc_bulk, setupBatch, teardownBatch);
+    tcase_set_timeout(tc_bulk, 0);
+    tcase_add_test(tc_bulk, addNodesOneByOne);
+    tcase_add_test(tc_bulk, addNodesBulk);
+    suite_add_tcase(s, tc_bulk);
+
     return s;
 }
 
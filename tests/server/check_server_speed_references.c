@@ -0,0 +1,224 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Memory for the references and Browse/TranslateBrowsePaths speed for a large
+ * and static address space. With the tree representation of the references
+ * and after UA_Server_compactReferences. And the memory saved by the intern
+ * table for the BrowseNames and LocalizedTexts. Set FOLDERS to 1000 for a
+ * model with one million nodes. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define FOLDERS 100 /* Number of folders below the ObjectsFolder */
+#define VARIABLES 1000 /* Number of variables in every folder */
+#define ROUNDS 3 /* How often every folder is browsed */
+#define LOOKUPS 10000 /* Number of TranslateBrowsePaths lookups */
+
+static UA_Server *server;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    /* Add FOLDERS * VARIABLES nodes */
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&vattr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+        char name[20];
+        snprintf(name, 20, "Folder %u", i);
+        UA_NodeId folderId = UA_NODEID_NUMERIC(1, 100000 + i);
+        retval |= UA_Server_addObjectNode(server, folderId,
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                          UA_QUALIFIEDNAME(1, name),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                          oattr, NULL, NULL);
+        for(UA_UInt32 j = 0; j < VARIABLES; j++) {
+            snprintf(name, 20, "Variable %u", j);
+            retval |= UA_Server_addVariableNode(server,
+                                                UA_NODEID_NUMERIC(1, 1000000 + (i * VARIABLES) + j),
+                                                folderId,
+                                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                                UA_QUALIFIEDNAME(1, name),
+                                                UA_NODEID_NULL, vattr, NULL, NULL);
+        }
+    }
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+typedef struct {
+    size_t nodes;
+    size_t bytes;
+} ReferenceMemory;
+
+/* Memory used for the references of the node. Without the allocation overhead
+ * and without the memory of NodeIds that are not stored in the NodePointer
+ * directly. (Both are the same or larger for the tree representation.) */
+static void
+countReferenceMemory(void *context, const UA_Node *node) {
+    ReferenceMemory *rm = (ReferenceMemory*)context;
+    rm->nodes++;
+    rm->bytes += node->head.referencesSize * sizeof(UA_NodeReferenceKind);
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(rk->hasRefTree)
+            rm->bytes += rk->targetsSize * sizeof(UA_ReferenceTargetTreeElem);
+        else if(rk->isCompact)
+            rm->bytes += rk->targetsSize * (sizeof(UA_ReferenceTarget) + sizeof(UA_UInt32));
+        else
+            rm->bytes += rk->targetsSize * sizeof(UA_ReferenceTarget);
+    }
+}
+
+static double
+referenceMemoryPerNode(void) {
+    ReferenceMemory rm = {0, 0};
+    server->config.nodestore.iterate(server->config.nodestore.context,
+                                     countReferenceMemory, &rm);
+    return (double)rm.bytes / (double)rm.nodes;
+}
+
+static double
+browseFolders(void) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.includeSubtypes = true;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.resultMask = UA_BROWSERESULTMASK_NONE;
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowseSize = 1;
+    request.nodesToBrowse = &bd;
+
+    UA_BrowseResponse response;
+    clock_t begin = clock();
+    for(size_t r = 0; r < ROUNDS; r++) {
+        for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+            bd.nodeId = UA_NODEID_NUMERIC(1, 100000 + i);
+            UA_BrowseResponse_init(&response);
+            UA_LOCK(&server->serviceMutex);
+            Service_Browse(server, &server->adminSession, &request, &response);
+            UA_UNLOCK(&server->serviceMutex);
+            ck_assert_uint_eq(response.resultsSize, 1);
+            ck_assert_uint_eq(response.results[0].referencesSize, VARIABLES);
+            UA_BrowseResponse_clear(&response);
+        }
+    }
+    clock_t finish = clock();
+    return (double)(finish - begin) / CLOCKS_PER_SEC;
+}
+
+static double
+translateVariables(void) {
+    clock_t begin = clock();
+    for(UA_UInt32 i = 0; i < LOOKUPS; i++) {
+        char name[20];
+        snprintf(name, 20, "Variable %u", (i * 7919) % VARIABLES);
+        UA_QualifiedName qn = UA_QUALIFIEDNAME(1, name);
+        UA_BrowsePathResult bpr =
+            UA_Server_browseSimplifiedBrowsePath(server,
+                                                 UA_NODEID_NUMERIC(1, 100000 + (i % FOLDERS)),
+                                                 1, &qn);
+        ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(bpr.targetsSize, 1);
+        UA_BrowsePathResult_clear(&bpr);
+    }
+    clock_t finish = clock();
+    return (double)(finish - begin) / CLOCKS_PER_SEC;
+}
+
+static double
+findTargets(void) {
+    clock_t begin = clock();
+    for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+        UA_NodeId folderId = UA_NODEID_NUMERIC(1, 100000 + i);
+        const UA_Node *node = UA_NODESTORE_GET(server, &folderId);
+        ck_assert(node != NULL);
+        for(size_t k = 0; k < node->head.referencesSize; k++) {
+            const UA_NodeReferenceKind *rk = &node->head.references[k];
+            if(rk->referenceTypeIndex != UA_REFERENCETYPEINDEX_HASCOMPONENT)
+                continue;
+            for(UA_UInt32 j = 0; j < VARIABLES; j++) {
+                UA_ExpandedNodeId en;
+                UA_ExpandedNodeId_init(&en);
+                en.nodeId = UA_NODEID_NUMERIC(1, 1000000 + (i * VARIABLES) + j);
+                ck_assert(UA_NodeReferenceKind_findTarget(rk, &en) != NULL);
+            }
+        }
+        UA_NODESTORE_RELEASE(server, node);
+    }
+    clock_t finish = clock();
+    return (double)(finish - begin) / CLOCKS_PER_SEC;
+}
+
+static void
+measure(const char *label) {
+    printf("%s: reference memory per node %.1f bytes\n", label,
+           referenceMemoryPerNode());
+    printf("%s: browse duration was %f s\n", label, browseFolders());
+    printf("%s: translate duration was %f s\n", label, translateVariables());
+    printf("%s: findTarget duration was %f s\n", label, findTargets());
+}
+
+START_TEST(referencesSpeed) {
+    measure("tree");
+
+    clock_t begin = clock();
+    UA_StatusCode res = UA_Server_compactReferences(server);
+    clock_t finish = clock();
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    printf("compaction duration was %f s\n", (double)(finish - begin) / CLOCKS_PER_SEC);
+
+    measure("compact");
+} END_TEST
+
+/* Memory for the strings and NodeIds in the intern table. And the additional
+ * memory that copies would use for every node without interning. */
+START_TEST(internMemory) {
+    UA_InternTableStatistics stats = UA_InternTable_getStatistics();
+    printf("intern table: %u entries, %u references, %u bytes\n",
+           (unsigned)stats.entries, (unsigned)stats.references,
+           (unsigned)stats.bytes);
+    printf("without interning: %u bytes\n",
+           (unsigned)(stats.bytes + stats.savedBytes));
+} END_TEST
+
+static Suite * testSuite_referencesSpeed(void) {
+    Suite *s = suite_create("References Speed");
+    TCase *tc = tcase_create("References");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, referencesSpeed);
+    tcase_add_test(tc, internMemory);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_referencesSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Server startup time for namespace zero and an additional information model.
+ * Regular startup and from a nodestore image. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define FOLDERS 100 /* Number of folders below the ObjectsFolder */
+#define VARIABLES 100 /* Number of variables in every folder */
+#define ROUNDS 5 /* How often the server is started */
+
+static UA_ByteString image;
+
+/* Stands in for the companion specifications that are loaded at startup */
+static void
+addInformationModel(UA_Server *server) {
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&vattr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(UA_UInt32 i = 0; i < FOLDERS; i++) {
+        char name[20];
+        snprintf(name, 20, "Folder %u", i);
+        UA_NodeId folderId = UA_NODEID_NUMERIC(1, 100000 + i);
+        retval |= UA_Server_addObjectNode(server, folderId,
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                          UA_QUALIFIEDNAME(1, name),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                          oattr, NULL, NULL);
+        for(UA_UInt32 j = 0; j < VARIABLES; j++) {
+            snprintf(name, 20, "Variable %u", j);
+            retval |= UA_Server_addVariableNode(server,
+                                                UA_NODEID_NUMERIC(1, 200000 + (i * VARIABLES) + j),
+                                                folderId,
+                                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                                UA_QUALIFIEDNAME(1, name),
+                                                UA_NODEID_NULL, vattr, NULL, NULL);
+        }
+    }
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    addInformationModel(server);
+    UA_StatusCode retval = UA_Server_saveNodestoreImage(server, &image);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_delete(server);
+}
+
+static void teardown(void) {
+    UA_ByteString_clear(&image);
+}
+
+START_TEST(startupSpeed) {
+    clock_t total = 0;
+    for(size_t r = 0; r < ROUNDS; r++) {
+        clock_t begin = clock();
+        UA_Server *server = UA_Server_newForUnitTest();
+        ck_assert(server != NULL);
+        addInformationModel(server);
+        total += clock() - begin;
+        UA_Server_delete(server);
+    }
+    printf("duration was %f s\n", (double)total / CLOCKS_PER_SEC);
+} END_TEST
+
+START_TEST(startupSpeedImage) {
+    clock_t total = 0;
+    for(size_t r = 0; r < ROUNDS; r++) {
+        clock_t begin = clock();
+        UA_ServerConfig config;
+        memset(&config, 0, sizeof(UA_ServerConfig));
+        UA_StatusCode retval = UA_ServerConfig_setDefault(&config);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        config.nodestoreImage = &image;
+        UA_Server *server = UA_Server_newWithConfig(&config);
+        ck_assert(server != NULL);
+        total += clock() - begin;
+        UA_Server_delete(server);
+    }
+    printf("duration with image was %f s (image size %u bytes)\n",
+           (double)total / CLOCKS_PER_SEC, (unsigned)image.length);
+} END_TEST
+
+static Suite * testSuite_startupSpeed(void) {
+    Suite *s = suite_create("Startup Speed");
+    TCase *tc = tcase_create("Startup");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, startupSpeed);
+    tcase_add_test(tc, startupSpeedImage);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_startupSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* TranslateBrowsePathsToNodeIds speed for a deep hierarchy below the
+ * ObjectsFolder. With and without the BrowsePath cache. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define DEPTH 6 /* Depth of the hierarchy */
+#define BRANCHING 5 /* Number of children for every object */
+#define LEAVES 15625 /* BRANCHING^DEPTH */
+#define ROUNDS 3 /* How often all paths are translated */
+
+static UA_Server *server;
+static UA_UInt32 nextId;
+static UA_QualifiedName names[BRANCHING];
+static UA_RelativePathElement *elements;
+static UA_BrowsePath *paths;
+
+static void
+addChildren(const UA_NodeId parent, size_t depth) {
+    if(depth == DEPTH)
+        return;
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    for(size_t i = 0; i < BRANCHING; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(1, nextId++);
+        UA_StatusCode retval =
+            UA_Server_addObjectNode(server, id, parent,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                    names[i], UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                    oattr, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        addChildren(id, depth + 1);
+    }
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    for(size_t i = 0; i < BRANCHING; i++) {
+        char name[20];
+        snprintf(name, 20, "Object %u", (unsigned)i);
+        names[i] = UA_QUALIFIEDNAME_ALLOC(1, name);
+    }
+    nextId = 100000;
+    addChildren(UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), 0);
+
+    /* Create the paths to all leaves. The digits of the leaf index (in base
+     * BRANCHING) select the child on every level. */
+    elements = (UA_RelativePathElement*)
+        UA_calloc(LEAVES * DEPTH, sizeof(UA_RelativePathElement));
+    paths = (UA_BrowsePath*)UA_calloc(LEAVES, sizeof(UA_BrowsePath));
+    ck_assert(elements != NULL && paths != NULL);
+    for(size_t i = 0; i < LEAVES; i++) {
+        paths[i].startingNode = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        paths[i].relativePath.elementsSize = DEPTH;
+        paths[i].relativePath.elements = &elements[i * DEPTH];
+        size_t index = i;
+        for(size_t j = DEPTH; j > 0; j--) {
+            UA_RelativePathElement *e = &elements[(i * DEPTH) + j - 1];
+            e->referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+            e->targetName = names[index % BRANCHING];
+            index /= BRANCHING;
+        }
+    }
+}
+
+static void teardown(void) {
+    UA_free(elements);
+    UA_free(paths);
+    for(size_t i = 0; i < BRANCHING; i++)
+        UA_QualifiedName_clear(&names[i]);
+    UA_Server_delete(server);
+}
+
+static double
+translatePaths(void) {
+    UA_TranslateBrowsePathsToNodeIdsRequest request;
+    UA_TranslateBrowsePathsToNodeIdsRequest_init(&request);
+    request.browsePathsSize = LEAVES;
+    request.browsePaths = paths;
+
+    UA_TranslateBrowsePathsToNodeIdsResponse response;
+    clock_t begin = clock();
+    for(size_t r = 0; r < ROUNDS; r++) {
+        UA_TranslateBrowsePathsToNodeIdsResponse_init(&response);
+        UA_LOCK(&server->serviceMutex);
+        Service_TranslateBrowsePathsToNodeIds(server, &server->adminSession,
+                                              &request, &response);
+        UA_UNLOCK(&server->serviceMutex);
+        ck_assert_uint_eq(response.resultsSize, LEAVES);
+        for(size_t i = 0; i < LEAVES; i++) {
+            ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq(response.results[i].targetsSize, 1);
+        }
+        UA_TranslateBrowsePathsToNodeIdsResponse_clear(&response);
+    }
+    clock_t finish = clock();
+    return (double)(finish - begin) / CLOCKS_PER_SEC;
+}
+
+START_TEST(translateSpeed) {
+    printf("duration was %f s\n", translatePaths());
+} END_TEST
+
+START_TEST(translateSpeedCached) {
+    UA_Server_getConfig(server)->maxBrowsePathCacheSize = 2 * LEAVES;
+    printf("duration with cache was %f s\n", translatePaths());
+
+    /* Every prefix is resolved only once */
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.missCount, stats.bpcs.currentEntryCount);
+} END_TEST
+
+static Suite * testSuite_translateSpeed(void) {
+    Suite *s = suite_create("TranslateBrowsePaths Speed");
+    TCase *tc = tcase_create("TranslateBrowsePaths");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 0);
+    tcase_add_test(tc, translateSpeed);
+    tcase_add_test(tc, translateSpeedCached);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_translateSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
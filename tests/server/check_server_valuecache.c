@@ -0,0 +1,205 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+
+static UA_Server *server;
+static size_t readCount;
+static size_t writeCount;
+
+static UA_StatusCode
+readCounter(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+            const UA_NodeId *nodeId, void *nodeContext,
+            UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+            UA_DataValue *value) {
+    readCount++;
+    UA_UInt32 count = (UA_UInt32)readCount;
+    UA_Variant_setScalarCopy(&value->value, &count, &UA_TYPES[UA_TYPES_UINT32]);
+    value->hasValue = true;
+    if(includeSourceTimeStamp) {
+        value->sourceTimestamp = UA_DateTime_now();
+        value->hasSourceTimestamp = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+writeCounter(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+             const UA_NodeId *nodeId, void *nodeContext,
+             const UA_NumericRange *range, const UA_DataValue *value) {
+    writeCount++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addDataSourceVariable(UA_UInt32 id) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.valueRank = UA_VALUERANK_ANY;
+    UA_DataSource dataSource;
+    dataSource.read = readCounter;
+    dataSource.write = writeCounter;
+    UA_StatusCode retval =
+        UA_Server_addDataSourceVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "Counter"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, dataSource, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    addDataSourceVariable(1);
+    addDataSourceVariable(2);
+    addDataSourceVariable(3);
+    UA_Server_getConfig(server)->maxValueCacheSize = 2;
+    readCount = 0;
+    writeCount = 0;
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+/* Read the counter value of the node with the given maxAge */
+static UA_UInt32
+readWithMaxAge(UA_UInt32 id, UA_Double maxAge, UA_String indexRange) {
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = UA_NODEID_NUMERIC(1, id);
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    rvi.indexRange = indexRange;
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.maxAge = maxAge;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = &rvi;
+
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Read(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert(response.results[0].hasValue);
+    ck_assert(response.results[0].hasSourceTimestamp);
+    ck_assert(response.results[0].hasServerTimestamp);
+    ck_assert(UA_Variant_hasScalarType(&response.results[0].value,
+                                       &UA_TYPES[UA_TYPES_UINT32]));
+    UA_UInt32 count = *(UA_UInt32*)response.results[0].value.data;
+    UA_ReadResponse_clear(&response);
+    return count;
+}
+
+START_TEST(readMaxAge) {
+    /* maxAge zero always reads from the DataSource */
+    ck_assert_uint_eq(readWithMaxAge(1, 0.0, UA_STRING_NULL), 1);
+    ck_assert_uint_eq(readWithMaxAge(1, 0.0, UA_STRING_NULL), 2);
+
+    /* Use the cached value */
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 2);
+    ck_assert_uint_eq(readCount, 2);
+
+    /* The cached value is too old */
+    UA_fakeSleep(1001);
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 3);
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 3);
+
+    /* Reads with an IndexRange bypass the cache */
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING("0")), 4);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.vcs.currentEntryCount, 1);
+    ck_assert_uint_eq(stats.vcs.hitCount, 2);
+    ck_assert_uint_eq(stats.vcs.missCount, 1);
+} END_TEST
+
+START_TEST(writeInvalidates) {
+    ck_assert_uint_eq(readWithMaxAge(1, 0.0, UA_STRING_NULL), 1);
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 1);
+
+    UA_UInt32 value = 42;
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode retval = UA_Server_writeValue(server, UA_NODEID_NUMERIC(1, 1), v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(writeCount, 1);
+
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 2);
+} END_TEST
+
+START_TEST(evictLeastRecentlyUsed) {
+    ck_assert_uint_eq(readWithMaxAge(1, 0.0, UA_STRING_NULL), 1);
+    ck_assert_uint_eq(readWithMaxAge(2, 0.0, UA_STRING_NULL), 2);
+
+    /* Node 1 was used more recently than node 2 */
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 1);
+
+    /* Adding node 3 evicts node 2 */
+    ck_assert_uint_eq(readWithMaxAge(3, 0.0, UA_STRING_NULL), 3);
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 1);
+    ck_assert_uint_eq(readWithMaxAge(2, 1000.0, UA_STRING_NULL), 4);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.vcs.currentEntryCount, 2);
+    ck_assert_uint_eq(stats.vcs.evictionCount, 2);
+} END_TEST
+
+START_TEST(deleteNodeInvalidates) {
+    ck_assert_uint_eq(readWithMaxAge(1, 0.0, UA_STRING_NULL), 1);
+    UA_StatusCode retval = UA_Server_deleteNode(server, UA_NODEID_NUMERIC(1, 1), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.vcs.currentEntryCount, 0);
+} END_TEST
+
+START_TEST(cacheDisabled) {
+    UA_Server_getConfig(server)->maxValueCacheSize = 0;
+    ck_assert_uint_eq(readWithMaxAge(1, 0.0, UA_STRING_NULL), 1);
+    ck_assert_uint_eq(readWithMaxAge(1, 1000.0, UA_STRING_NULL), 2);
+
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.vcs.hitCount, 0);
+    ck_assert_uint_eq(stats.vcs.missCount, 0);
+} END_TEST
+
+static Suite * testSuite_valueCache(void) {
+    Suite *s = suite_create("Server Value Cache");
+    TCase *tc = tcase_create("Read with maxAge");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, readMaxAge);
+    tcase_add_test(tc, writeInvalidates);
+    tcase_add_test(tc, evictLeastRecentlyUsed);
+    tcase_add_test(tc, deleteNodeInvalidates);
+    tcase_add_test(tc, cacheDisabled);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_valueCache();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}